@@ -98,6 +98,26 @@ struct ValdiProjectConfig {
     let externalModulesWorkspace: String?
     let nativeApiMinVersion: Int?
 
+    /**
+     Whether .valdimodule files should be emitted in the seekable archive format,
+     where entries are compressed independently and decompressed on demand at runtime.
+     */
+    let seekableModuleArchives: Bool
+
+    /**
+     Trained zstd dictionary used to compress the entries of seekable module archives.
+     Unless moduleArchiveDictionaryShipped is set, the dictionary is embedded in the module
+     archives it makes smaller once its own size is counted, and is left out of the others.
+     */
+    let moduleArchiveDictionaryURL: URL?
+
+    /**
+     Whether the app ships the module archive dictionary as the 'valdi_module_archive_dictionary'
+     resource, which the runtime registers on startup. Module archives then reference the dictionary
+     without embedding it, so that its size is paid once by the app instead of once per module.
+     */
+    let moduleArchiveDictionaryShipped: Bool
+
     private static func parseOutputConfig(inputConfig: Yams.Node.Mapping?,
                                           ignoredFiles: [NSRegularExpression]?,
                                           baseDirUrl: URL,
@@ -331,6 +351,12 @@ struct ValdiProjectConfig {
             nativeApiMinVersion = nil
         }
 
+        let seekableModuleArchives = config["seekable_module_archives"]?.bool ?? false
+        let moduleArchiveDictionaryURL = try config["module_archive_dictionary_path"]?.string
+            .map { try $0.resolvingVariables(environment) }
+            .flatMap { configDirectoryUrl.resolving(path: $0, isDirectory: false) }
+        let moduleArchiveDictionaryShipped = config["module_archive_dictionary_shipped"]?.bool ?? false
+
         var projectConfig = ValdiProjectConfig(configDirectoryUrl: configDirectoryUrl,
                                                   projectName: projectName,
                                                   baseDir: baseDirUrl,
@@ -371,7 +397,10 @@ struct ValdiProjectConfig {
                                                   nodeModulesWorkspace: nodeModulesWorkspace,
                                                   externalModulesTarget: externalModulesTarget,
                                                   externalModulesWorkspace: externalModulesWorkspace,
-                                                  nativeApiMinVersion: nativeApiMinVersion)
+                                                  nativeApiMinVersion: nativeApiMinVersion,
+                                                  seekableModuleArchives: seekableModuleArchives,
+                                                  moduleArchiveDictionaryURL: moduleArchiveDictionaryURL,
+                                                  moduleArchiveDictionaryShipped: moduleArchiveDictionaryShipped)
 
         projectConfig.shouldEmitDiagnostics = args.emitDiagnostics
         projectConfig.shouldDebugCompilerCompanion = args.debugCompanion
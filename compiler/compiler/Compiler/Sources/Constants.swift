@@ -80,6 +80,15 @@ struct Magic {
         packetData.append(0x01)
         return packetData
     }()
+
+    static let valdiSeekableArchiveMagic: Data = {
+        var packetData = Data()
+        packetData.append(0x33)
+        packetData.append(0xC6)
+        packetData.append(0x00)
+        packetData.append(0x02)
+        return packetData
+    }()
 }
 
 struct DeterministicDate {
@@ -68,6 +68,7 @@ class BundleResourcesProcessor: CompilationProcessor {
     private let companionExecutable: CompanionExecutable
     private let writeDownloadableArtifactsManifest: Bool
     private var pendingPreparedArtifact = Synchronized(data: [String: File]())
+    private let moduleArchiveDictionary = Synchronized<ZstdDictionary?>(data: nil)
 
     init(logger: ILogger, 
          fileManager: ValdiFileManager,
@@ -150,7 +151,22 @@ class BundleResourcesProcessor: CompilationProcessor {
                 return cachedCompressed
             }
 
-            let compressedData = try ValdiModuleBuilder.compress(data: data)
+            let compressedData: Data
+            if projectConfig.seekableModuleArchives {
+                let seekableModuleBuilder = ValdiModuleBuilder(items: zippableItems)
+                seekableModuleBuilder.seekable = true
+                seekableModuleBuilder.dictionary = try getModuleArchiveDictionary()
+                seekableModuleBuilder.dictionaryShipped = projectConfig.moduleArchiveDictionaryShipped
+                compressedData = try seekableModuleBuilder.build()
+
+                if let dictionary = seekableModuleBuilder.dictionary, ValdiModuleBuilder.embedsDictionary(module: compressedData) {
+                    logger.verbose("Module '\(moduleName)' download size: \(compressedData.count) bytes, including the \(dictionary.data.count) bytes dictionary")
+                } else {
+                    logger.verbose("Module '\(moduleName)' download size: \(compressedData.count) bytes")
+                }
+            } else {
+                compressedData = try ValdiModuleBuilder.compress(data: data)
+            }
             try diskCache?.setOutput(item: cacheKey, platform: platform, target: target, inputData: data, outputData: compressedData)
 
             return compressedData
@@ -206,7 +222,33 @@ class BundleResourcesProcessor: CompilationProcessor {
         return ResolveFilesResult(sources: sources, assets: assets, passthroughItems: passthroughItems)
     }
 
+    private func getModuleArchiveDictionary() throws -> ZstdDictionary? {
+        guard let dictionaryURL = projectConfig.moduleArchiveDictionaryURL else {
+            return nil
+        }
+
+        return try moduleArchiveDictionary.data { (dictionary: inout ZstdDictionary?) -> ZstdDictionary in
+            if let dictionary = dictionary {
+                return dictionary
+            }
+            let loadedDictionary = try ZstdDictionary(data: try Data(contentsOf: dictionaryURL))
+            if projectConfig.moduleArchiveDictionaryShipped {
+                logger.info("Module archive dictionary \(loadedDictionary.id) is shipped with the app: \(loadedDictionary.data.count) bytes")
+            }
+            dictionary = loadedDictionary
+            return loadedDictionary
+        }
+    }
+
     private func getCacheKey(_ artifactName: String) -> String {
+        if projectConfig.seekableModuleArchives {
+            // The output depends on the dictionary, which is not part of the cache input
+            if let dictionary = try? getModuleArchiveDictionary() {
+                let dictionaryMode = projectConfig.moduleArchiveDictionaryShipped ? "shipped" : "embedded-if-smaller"
+                return artifactName + ".valdiseekablearchive-dict\(dictionary.id)-\(dictionaryMode)"
+            }
+            return artifactName + ".valdiseekablearchive"
+        }
         return artifactName + ".valdiarchive"
     }
 
@@ -16,6 +16,13 @@ extension Data {
         }
     }
 
+    mutating func append(integer: UInt64) {
+        var value = integer
+        Swift.withUnsafePointer(to: &value) {
+            append(UnsafeBufferPointer(start: $0, count: 1))
+        }
+    }
+
     private static func alignUp(size: UInt32, alignment: UInt32) -> UInt32 {
         // See details here:
         // https://github.com/KabukiStarship/KabukiToolkit/wiki/Fastest-Method-to-Align-Pointers#observations
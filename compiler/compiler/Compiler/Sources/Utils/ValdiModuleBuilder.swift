@@ -29,6 +29,14 @@ extension Parser where T == Data {
         }
     }
 
+    func parseInt64() throws -> UInt64 {
+        let data = try subsequence(length: 8)
+
+        return data.withUnsafePointer { bufferStart in
+            return bufferStart.pointee
+        }
+    }
+
     func parseValdiData() throws -> Data {
         let length = LengthField(raw: try parseInt())
         let data = try subsequence(length: length.size())
@@ -41,18 +49,81 @@ extension Parser where T == Data {
     }
 }
 
+/**
+ Describes one entry of a seekable archive. Must match the layout of
+ SeekableArchiveIndexEntry in the runtime's ValdiModuleArchive.cpp.
+ */
+private struct SeekableArchiveIndexEntry {
+    static let byteSize = 40
+    static let flagCompressed: UInt32 = 1
+
+    var dataOffset: UInt64
+    var dataLength: UInt64
+    var size: UInt64
+    var pathOffset: UInt32
+    var pathLength: UInt32
+    var flags: UInt32
+
+    func serialize(into data: inout Data) {
+        data.append(integer: dataOffset)
+        data.append(integer: dataLength)
+        data.append(integer: size)
+        data.append(integer: pathOffset)
+        data.append(integer: pathLength)
+        data.append(integer: flags)
+        // Reserved
+        data.append(integer: UInt32(0))
+    }
+
+    static func parse(parser: Parser<Data>) throws -> SeekableArchiveIndexEntry {
+        let dataOffset = try parser.parseInt64()
+        let dataLength = try parser.parseInt64()
+        let size = try parser.parseInt64()
+        let pathOffset = try parser.parseInt()
+        let pathLength = try parser.parseInt()
+        let flags = try parser.parseInt()
+        _ = try parser.parseInt()
+
+        return SeekableArchiveIndexEntry(dataOffset: dataOffset,
+                                         dataLength: dataLength,
+                                         size: size,
+                                         pathOffset: pathOffset,
+                                         pathLength: pathLength,
+                                         flags: flags)
+    }
+}
+
 class ValdiModuleBuilder {
 
+    private static let seekableArchiveHeaderSize = 16
+    private static let seekableArchiveDictionaryLocationSize = 16
+    private static let seekableArchiveFlagEmbeddedDictionary: UInt32 = 1
+
     private let items: [ZippableItem]
     var compress = true
+    /**
+     When set, build() outputs an archive in the seekable format: an index of the entries followed by
+     the entries themselves, each one compressed in its own zstd frame when compress is set. The runtime
+     only decompresses the entries that are requested, instead of the whole archive upfront.
+     Archives in the seekable format require a runtime which supports them.
+     */
+    var seekable = false
+    /**
+     Trained dictionary the entries of seekable archives are compressed with.
+     */
+    var dictionary: ZstdDictionary?
+    /**
+     Whether the dictionary is shipped with the app and registered in the runtime. The archive then
+     references the dictionary without storing it. Otherwise the dictionary is stored in the archive
+     only if the archive ends up smaller than without using the dictionary at all.
+     */
+    var dictionaryShipped = false
 
     init(items: [ZippableItem]) {
         self.items = items
     }
 
-    private func pack() throws -> Data {
-        var out = Data()
-
+    private func sortedItems() throws -> [ZippableItem] {
         let sortedItems = items.sorted { (left, right) -> Bool in
             return left.path > right.path
         }
@@ -61,7 +132,15 @@ class ValdiModuleBuilder {
             guard !item.path.hasPrefix("../") else {
                 throw CompilerError("Invalid path for entry '\(item.path)'")
             }
+        }
+
+        return sortedItems
+    }
+
+    private func pack() throws -> Data {
+        var out = Data()
 
+        for item in try sortedItems() {
             let filename = try item.path.utf8Data()
             let fileData = try item.file.readData()
 
@@ -72,7 +151,108 @@ class ValdiModuleBuilder {
         return out
     }
 
+    private func packSeekable() throws -> Data {
+        guard let dictionary = self.dictionary else {
+            return try packSeekable(dictionary: nil, embedDictionary: false)
+        }
+        if self.dictionaryShipped {
+            return try packSeekable(dictionary: dictionary, embedDictionary: false)
+        }
+
+        // Small modules don't compress enough better with the dictionary to make up for its size
+        let withDictionary = try packSeekable(dictionary: dictionary, embedDictionary: true)
+        let withoutDictionary = try packSeekable(dictionary: nil, embedDictionary: false)
+        return withDictionary.count < withoutDictionary.count ? withDictionary : withoutDictionary
+    }
+
+    private func packSeekable(dictionary: ZstdDictionary?, embedDictionary: Bool) throws -> Data {
+        let sortedItems = try sortedItems()
+
+        var paths = Data()
+        var entriesData = Data()
+        var index = [SeekableArchiveIndexEntry]()
+
+        for item in sortedItems {
+            let filename = try item.path.utf8Data()
+            let fileData = try item.file.readData()
+
+            var storedData = fileData
+            var flags: UInt32 = 0
+            if self.compress {
+                let compressedData: Data
+                if let dictionary = dictionary {
+                    compressedData = try ZstdCompressor.compress(data: fileData, dictionary: dictionary)
+                } else {
+                    compressedData = try ZstdCompressor.compress(data: fileData)
+                }
+                // Entries that don't benefit from compression, like images, are stored as is
+                // so that the runtime can use them without copying them.
+                if compressedData.count < fileData.count {
+                    storedData = compressedData
+                    flags |= SeekableArchiveIndexEntry.flagCompressed
+                }
+            }
+
+            let padding = Data.computePadding(size: UInt32(truncatingIfNeeded: entriesData.count))
+            entriesData.append(Data(count: Int(padding)))
+
+            index.append(SeekableArchiveIndexEntry(dataOffset: UInt64(entriesData.count),
+                                                   dataLength: UInt64(storedData.count),
+                                                   size: UInt64(fileData.count),
+                                                   pathOffset: UInt32(paths.count),
+                                                   pathLength: UInt32(filename.count),
+                                                   flags: flags))
+
+            paths.append(filename)
+            entriesData.append(storedData)
+        }
+
+        let pathsLength = UInt32(paths.count)
+        paths.append(Data(count: Int(Data.computePadding(size: pathsLength))))
+
+        var flags: UInt32 = 0
+        var embeddedDictionary = Data()
+        var indexOffset = ValdiModuleBuilder.seekableArchiveHeaderSize
+        if let dictionary = dictionary, embedDictionary {
+            flags |= ValdiModuleBuilder.seekableArchiveFlagEmbeddedDictionary
+            embeddedDictionary = dictionary.data
+            embeddedDictionary.append(Data(count: Int(Data.computePadding(size: UInt32(dictionary.data.count)))))
+            indexOffset += ValdiModuleBuilder.seekableArchiveDictionaryLocationSize
+        }
+
+        // Data offsets are relative to the start of the archive
+        let dictionaryOffset = indexOffset + index.count * SeekableArchiveIndexEntry.byteSize + paths.count
+        let entriesDataOffset = dictionaryOffset + embeddedDictionary.count
+
+        var out = Data()
+        out.reserveCapacity(entriesDataOffset + entriesData.count)
+        out.append(Magic.valdiSeekableArchiveMagic)
+        out.append(integer: flags)
+        out.append(integer: UInt32(index.count))
+        out.append(integer: pathsLength)
+
+        if let dictionary = dictionary, (flags & ValdiModuleBuilder.seekableArchiveFlagEmbeddedDictionary) != 0 {
+            out.append(integer: UInt64(dictionaryOffset))
+            out.append(integer: UInt64(dictionary.data.count))
+        }
+
+        for var entry in index {
+            entry.dataOffset += UInt64(entriesDataOffset)
+            entry.serialize(into: &out)
+        }
+
+        out.append(paths)
+        out.append(embeddedDictionary)
+        out.append(entriesData)
+
+        return out
+    }
+
     func build() throws -> Data {
+        if self.seekable {
+            return try packSeekable()
+        }
+
         let packetData = try pack()
 
         var packed = Data()
@@ -90,7 +270,98 @@ class ValdiModuleBuilder {
         return try ZstdCompressor.compress(data: data)
     }
 
-    static func unpack(module: Data) throws -> [ZippableItem] {
+    static func isSeekable(module: Data) -> Bool {
+        return module.starts(with: Magic.valdiSeekableArchiveMagic)
+    }
+
+    static func embedsDictionary(module: Data) -> Bool {
+        let parser = Parser(sequence: Data(module))
+        guard (try? parser.parse(subsequence: Magic.valdiSeekableArchiveMagic)) == true,
+              let flags = try? parser.parseInt() else {
+            return false
+        }
+        return (flags & seekableArchiveFlagEmbeddedDictionary) != 0
+    }
+
+    private static func unpackSeekable(module: Data, dictionary: ZstdDictionary?) throws -> [ZippableItem] {
+        let moduleData = Data(module)
+        let parser = Parser(sequence: moduleData)
+
+        guard try parser.parse(subsequence: Magic.valdiSeekableArchiveMagic) else {
+            throw CompilerError("Did not find valdi seekable archive magic in module")
+        }
+
+        let flags = try parser.parseInt()
+        guard (flags & ~seekableArchiveFlagEmbeddedDictionary) == 0 else {
+            throw CompilerError("Unsupported seekable archive flags \(flags)")
+        }
+
+        let entriesCount = try parser.parseInt()
+        let pathsLength = try parser.parseInt()
+
+        var dictionary = dictionary
+        if (flags & seekableArchiveFlagEmbeddedDictionary) != 0 {
+            let dictionaryOffset = Int(try parser.parseInt64())
+            let dictionaryLength = Int(try parser.parseInt64())
+            guard dictionaryOffset + dictionaryLength <= moduleData.count else {
+                throw CompilerError("Seekable archive dictionary is out of bounds")
+            }
+            dictionary = try ZstdDictionary(data: Data(moduleData[dictionaryOffset..<dictionaryOffset + dictionaryLength]))
+        }
+
+        var index = [SeekableArchiveIndexEntry]()
+        for _ in 0..<entriesCount {
+            index.append(try SeekableArchiveIndexEntry.parse(parser: parser))
+        }
+
+        let paths = try parser.subsequence(length: Int(pathsLength))
+
+        var out = [ZippableItem]()
+
+        for entry in index {
+            let pathStart = paths.startIndex + Int(entry.pathOffset)
+            let dataStart = Int(entry.dataOffset)
+            guard pathStart + Int(entry.pathLength) <= paths.endIndex,
+                  dataStart + Int(entry.dataLength) <= moduleData.count else {
+                throw CompilerError("Seekable archive entry is out of bounds")
+            }
+
+            guard let filename = String(data: paths[pathStart..<pathStart + Int(entry.pathLength)], encoding: .utf8) else {
+                throw CompilerError("Could not extract file name")
+            }
+
+            var fileData = moduleData[dataStart..<dataStart + Int(entry.dataLength)]
+            if (entry.flags & SeekableArchiveIndexEntry.flagCompressed) != 0 {
+                let dictionaryId = ZstdCompressor.getDictionaryId(compressedData: fileData)
+                if dictionaryId == 0 {
+                    fileData = try ZstdCompressor.decompress(data: Data(fileData))
+                } else if let dictionary = dictionary, dictionary.id == dictionaryId {
+                    fileData = try ZstdCompressor.decompress(data: Data(fileData), decompressedSize: Int(entry.size), dictionary: dictionary)
+                } else {
+                    throw CompilerError("Entry '\(filename)' requires the zstd dictionary with id \(dictionaryId)")
+                }
+            }
+
+            guard fileData.count == Int(entry.size) else {
+                throw CompilerError("Unexpected size \(fileData.count) for entry '\(filename)', expected \(entry.size)")
+            }
+
+            out.append(ZippableItem(file: .data(Data(fileData)), path: filename))
+        }
+
+        return out
+    }
+
+    /**
+     Unpacks the entries of the given module. The dictionary is used to decompress seekable archives
+     whose entries were compressed with a dictionary that is not embedded in the archive, which
+     the runtime cannot read.
+     */
+    static func unpack(module: Data, dictionary: ZstdDictionary? = nil) throws -> [ZippableItem] {
+        if isSeekable(module: module) {
+            return try unpackSeekable(module: module, dictionary: dictionary)
+        }
+
         let moduleData = ZstdCompressor.isZstdCompressed(data: module) ? try ZstdCompressor.decompress(data: module) : module
 
         let parser = Parser(sequence: moduleData)
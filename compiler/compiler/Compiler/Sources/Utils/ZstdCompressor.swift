@@ -8,9 +8,45 @@
 import Foundation
 import Zstd
 
+/**
+ A dictionary trained with `zstd --train` (see tools/zstd/train_dictionary.sh).
+ Frames compressed with it store its id, which the runtime uses to find the dictionary
+ to decompress them with.
+ */
+class ZstdDictionary {
+
+    let data: Data
+    let id: UInt32
+    fileprivate let cdict: OpaquePointer
+
+    init(data: Data) throws {
+        let id = data.withUnsafeBytes { (rawBytes: UnsafeRawBufferPointer) in
+            ZSTD_getDictID_fromDict(rawBytes.baseAddress, rawBytes.count)
+        }
+        guard id != 0 else {
+            throw CompilerError("Not a zstd dictionary")
+        }
+
+        let cdict = data.withUnsafeBytes { (rawBytes: UnsafeRawBufferPointer) in
+            ZSTD_createCDict(rawBytes.baseAddress, rawBytes.count, ZstdCompressor.compressionLevel)
+        }
+        guard let cdict = cdict else {
+            throw CompilerError("Failed to load zstd dictionary")
+        }
+
+        self.data = data
+        self.id = id
+        self.cdict = cdict
+    }
+
+    deinit {
+        ZSTD_freeCDict(cdict)
+    }
+}
+
 class ZstdCompressor {
 
-    private static let compressionLevel: Int32 = 19
+    fileprivate static let compressionLevel: Int32 = 19
 
     class func compress(data: Data) throws -> Data {
         guard let stream = ZSTD_createCStream() else {
@@ -83,6 +119,68 @@ class ZstdCompressor {
         return output
     }
 
+    class func compress(data: Data, dictionary: ZstdDictionary) throws -> Data {
+        guard let cctx = ZSTD_createCCtx() else {
+            throw CompilerError("Failed to create compression context")
+        }
+        defer {
+            ZSTD_freeCCtx(cctx)
+        }
+
+        var output = Data(count: ZSTD_compressBound(data.count))
+
+        let written: Int = try output.withUnsafeMutableBytes { (outputBytes: UnsafeMutableRawBufferPointer) in
+            return try data.withUnsafeBytes { (inputBytes: UnsafeRawBufferPointer) in
+                let result = ZSTD_compress_usingCDict(cctx, outputBytes.baseAddress, outputBytes.count, inputBytes.baseAddress, inputBytes.count, dictionary.cdict)
+                guard ZSTD_isError(result) == 0 else {
+                    throw CompilerError("zstd: \(String(cString: ZSTD_getErrorName(result)))")
+                }
+                return result
+            }
+        }
+
+        output.count = written
+        return output
+    }
+
+    /**
+     Decompress a single frame which was compressed with the given dictionary.
+     */
+    class func decompress(data: Data, decompressedSize: Int, dictionary: ZstdDictionary) throws -> Data {
+        guard let dctx = ZSTD_createDCtx() else {
+            throw CompilerError("Failed to create decompression context")
+        }
+        defer {
+            ZSTD_freeDCtx(dctx)
+        }
+
+        var output = Data(count: decompressedSize)
+
+        let written: Int = try output.withUnsafeMutableBytes { (outputBytes: UnsafeMutableRawBufferPointer) in
+            return try data.withUnsafeBytes { (inputBytes: UnsafeRawBufferPointer) in
+                return try dictionary.data.withUnsafeBytes { (dictionaryBytes: UnsafeRawBufferPointer) in
+                    let result = ZSTD_decompress_usingDict(dctx, outputBytes.baseAddress, outputBytes.count, inputBytes.baseAddress, inputBytes.count, dictionaryBytes.baseAddress, dictionaryBytes.count)
+                    guard ZSTD_isError(result) == 0 else {
+                        throw CompilerError("zstd: \(String(cString: ZSTD_getErrorName(result)))")
+                    }
+                    return result
+                }
+            }
+        }
+
+        guard written == decompressedSize else {
+            throw CompilerError("Decompressed size \(written) does not match expected size \(decompressedSize)")
+        }
+
+        return output
+    }
+
+    class func getDictionaryId(compressedData: Data) -> UInt32 {
+        return compressedData.withUnsafeBytes { (rawBytes: UnsafeRawBufferPointer) in
+            ZSTD_getDictID_fromFrame(rawBytes.baseAddress, rawBytes.count)
+        }
+    }
+
     class func decompress(data: Data) throws -> Data {
         guard let dstream = ZSTD_createDStream() else {
             throw CompilerError("Failed to create decompression stream")
@@ -0,0 +1,57 @@
+import XCTest
+import Foundation
+@testable import Compiler
+
+final class ValdiModuleBuilderTests: XCTestCase {
+
+    private let items = [
+        ZippableItem(file: .data(Data(repeating: 0x61, count: 4096)), path: "main.js"),
+        ZippableItem(file: .data(Data("tiny".utf8)), path: "res/image.png"),
+    ]
+
+    private func unpackedContents(module: Data) throws -> [String: Data] {
+        var out = [String: Data]()
+        for item in try ValdiModuleBuilder.unpack(module: module) {
+            out[item.path] = try item.file.readData()
+        }
+        return out
+    }
+
+    func testLegacyModuleRoundTrip() throws {
+        let module = try ValdiModuleBuilder(items: items).build()
+
+        XCTAssertFalse(ValdiModuleBuilder.isSeekable(module: module))
+        XCTAssertEqual(try unpackedContents(module: module), [
+            "main.js": Data(repeating: 0x61, count: 4096),
+            "res/image.png": Data("tiny".utf8),
+        ])
+    }
+
+    func testSeekableModuleRoundTrip() throws {
+        let builder = ValdiModuleBuilder(items: items)
+        builder.seekable = true
+        let module = try builder.build()
+
+        XCTAssertTrue(ValdiModuleBuilder.isSeekable(module: module))
+        XCTAssertFalse(ZstdCompressor.isZstdCompressed(data: module))
+        XCTAssertLessThan(module.count, 4096, "Compressible entries should be stored compressed")
+        XCTAssertEqual(try unpackedContents(module: module), [
+            "main.js": Data(repeating: 0x61, count: 4096),
+            "res/image.png": Data("tiny".utf8),
+        ])
+    }
+
+    func testSeekableModuleWithoutCompressionRoundTrip() throws {
+        let builder = ValdiModuleBuilder(items: items)
+        builder.seekable = true
+        builder.compress = false
+        let module = try builder.build()
+
+        XCTAssertTrue(ValdiModuleBuilder.isSeekable(module: module))
+        XCTAssertGreaterThan(module.count, 4096)
+        XCTAssertEqual(try unpackedContents(module: module), [
+            "main.js": Data(repeating: 0x61, count: 4096),
+            "res/image.png": Data("tiny".utf8),
+        ])
+    }
+}
@@ -0,0 +1,86 @@
+#include "snap_drawing/cpp/Drawing/Raster/RasterContext.hpp"
+#include "snap_drawing/cpp/Layers/LayerRoot.hpp"
+#include "snap_drawing/cpp/Layers/ScrollLayer.hpp"
+#include "snap_drawing/cpp/Text/FontManager.hpp"
+#include "snap_drawing/cpp/Utils/BitmapFactory.hpp"
+
+#include "valdi_core/cpp/Utils/ConsoleLogger.hpp"
+
+#include "benchmark/benchmark.h"
+
+using namespace snap::drawing;
+
+constexpr int kViewportWidth = 1080;
+constexpr int kViewportHeight = 1920;
+constexpr int kFeedItemHeight = 360;
+constexpr int kFeedItemsCount = 200;
+constexpr Scalar kScrollStep = 16;
+
+static Ref<Layer> makeFeedItem(const Ref<Resources>& resources, int index) {
+    auto itemLayer = makeLayer<Layer>(resources);
+    itemLayer->setFrame(Rect::makeXYWH(
+        0, static_cast<Scalar>(index * kFeedItemHeight), static_cast<Scalar>(kViewportWidth), kFeedItemHeight));
+    itemLayer->setBackgroundColor(Color::white());
+    itemLayer->setBorderWidth(1);
+    itemLayer->setBorderColor(Color::black().withAlphaRatio(0.1f));
+
+    auto avatarLayer = makeLayer<Layer>(resources);
+    avatarLayer->setFrame(Rect::makeXYWH(24, 24, 96, 96));
+    avatarLayer->setBackgroundColor(index % 2 == 0 ? Color::red() : Color::blue());
+    avatarLayer->setBorderRadius(BorderRadius::makeCircle());
+    itemLayer->addChild(avatarLayer);
+
+    auto mediaLayer = makeLayer<Layer>(resources);
+    mediaLayer->setFrame(Rect::makeXYWH(144, 24, static_cast<Scalar>(kViewportWidth - 168), kFeedItemHeight - 48));
+    mediaLayer->setBackgroundColor(Color::green());
+    mediaLayer->setBorderRadius(BorderRadius::makeOval(16, false));
+    mediaLayer->setBoxShadow(0, 4, 8, Color::black().withAlphaRatio(0.3f));
+    itemLayer->addChild(mediaLayer);
+
+    return itemLayer;
+}
+
+// Scrolls a long feed by a few pixels every frame and rasterizes the damaged region.
+// The argument tells whether the raster tile cache is enabled.
+static void ScrollFeed(benchmark::State& state) {
+    auto fontManager = Valdi::makeShared<FontManager>(Valdi::ConsoleLogger::getLogger());
+    auto resources = Valdi::makeShared<Resources>(fontManager, 1.0f, Valdi::ConsoleLogger::getLogger());
+
+    auto layerRoot = makeLayer<LayerRoot>(resources);
+    auto scrollLayer = makeLayer<ScrollLayer>(resources);
+    scrollLayer->setContentSize(Size(kViewportWidth, static_cast<Scalar>(kFeedItemsCount * kFeedItemHeight)));
+    for (int i = 0; i < kFeedItemsCount; i++) {
+        scrollLayer->getChildInsertionLayer().addChild(makeFeedItem(resources, i));
+    }
+
+    layerRoot->setContentLayer(scrollLayer, ContentLayerSizingModeMatchSize);
+    layerRoot->setSize(Size(kViewportWidth, kViewportHeight), 1.0f);
+
+    auto rasterContext = Valdi::makeShared<RasterContext>(
+        Valdi::ConsoleLogger::getLogger(), ExternalSurfaceRasterizationMethod::FAST, false);
+    rasterContext->setRasterTileCacheEnabled(state.range(0) != 0);
+
+    auto bitmap = BitmapFactory::getInstance(Valdi::ColorType::ColorTypeRGBA8888)
+                      ->createBitmap(kViewportWidth, kViewportHeight)
+                      .moveValue();
+
+    auto maxContentOffset = static_cast<Scalar>(kFeedItemsCount * kFeedItemHeight - kViewportHeight);
+    Scalar contentOffset = 0;
+
+    for (auto _ : state) {
+        contentOffset += kScrollStep;
+        if (contentOffset > maxContentOffset) {
+            contentOffset = 0;
+        }
+        scrollLayer->setContentOffset(Point::make(0, contentOffset), Vector(0, 0), false);
+
+        auto displayList = layerRoot->draw();
+        auto result = rasterContext->rasterDelta(displayList, bitmap);
+        benchmark::DoNotOptimize(result);
+    }
+
+    auto stats = rasterContext->getRasterTileCacheStats();
+    state.counters["rasterizedTiles"] = static_cast<double>(stats.rasterizedTiles);
+    state.counters["reusedTiles"] = static_cast<double>(stats.reusedTiles);
+}
+BENCHMARK(ScrollFeed)->ArgName("tileCache")->Arg(0)->Arg(1)->Unit(benchmark::kMillisecond);
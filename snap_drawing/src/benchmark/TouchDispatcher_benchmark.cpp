@@ -0,0 +1,151 @@
+#include "snap_drawing/cpp/Layers/Layer.hpp"
+#include "snap_drawing/cpp/Text/FontManager.hpp"
+#include "snap_drawing/cpp/Touches/SingleTapGestureRecognizer.hpp"
+#include "snap_drawing/cpp/Touches/TouchDispatcher.hpp"
+#include "snap_drawing/cpp/Touches/TouchHitTestIndex.hpp"
+
+#include "valdi_core/cpp/Utils/ConsoleLogger.hpp"
+
+#include "benchmark/benchmark.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+using namespace snap::drawing;
+
+constexpr Scalar kGridCellSize = 40;
+constexpr int kHitLocationsCount = 64;
+
+struct TouchGrid {
+    Ref<Layer> rootLayer;
+    // Holds the cells, like the content layer of a scroll layer
+    Ref<Layer> containerLayer;
+    std::vector<TouchEvent> events;
+};
+
+// Lays out the given number of cells in a square grid, each with a tap gesture and an
+// inner layer, which resembles a photo grid or a long list.
+static TouchGrid makeTouchGrid(int layersCount) {
+    auto fontManager = Valdi::makeShared<FontManager>(Valdi::ConsoleLogger::getLogger());
+    auto resources = Valdi::makeShared<Resources>(fontManager, 1.0f, Valdi::ConsoleLogger::getLogger());
+
+    auto cellsCount = std::max(1, layersCount / 2);
+    auto columnsCount = static_cast<int>(std::ceil(std::sqrt(static_cast<double>(cellsCount))));
+    auto gridSize = static_cast<Scalar>(columnsCount) * kGridCellSize;
+
+    TouchGrid grid;
+    grid.rootLayer = makeLayer<Layer>(resources);
+    grid.rootLayer->setFrame(Rect::makeXYWH(0, 0, gridSize, gridSize));
+    grid.containerLayer = makeLayer<Layer>(resources);
+    grid.containerLayer->setFrame(Rect::makeXYWH(0, 0, gridSize, gridSize));
+    grid.rootLayer->addChild(grid.containerLayer);
+
+    for (int i = 0; i < cellsCount; i++) {
+        auto cellLayer = makeLayer<Layer>(resources);
+        cellLayer->setFrame(Rect::makeXYWH(static_cast<Scalar>(i % columnsCount) * kGridCellSize,
+                                           static_cast<Scalar>(i / columnsCount) * kGridCellSize,
+                                           kGridCellSize,
+                                           kGridCellSize));
+        cellLayer->addGestureRecognizer(
+            Valdi::makeShared<SingleTapGestureRecognizer>(resources->getGesturesConfiguration()));
+
+        auto contentLayer = makeLayer<Layer>(resources);
+        contentLayer->setFrame(Rect::makeXYWH(4, 4, kGridCellSize - 8, kGridCellSize - 8));
+        cellLayer->addChild(contentLayer);
+
+        grid.containerLayer->addChild(cellLayer);
+    }
+
+    for (int i = 0; i < kHitLocationsCount; i++) {
+        auto ratio = static_cast<Scalar>(i) / static_cast<Scalar>(kHitLocationsCount);
+        auto location = Point::make(gridSize * ratio, gridSize * (1.0f - ratio));
+        TouchEvent::PointerLocations pointerLocations;
+        pointerLocations.push_back(location);
+        grid.events.emplace_back(TouchEventTypeDown,
+                                 location,
+                                 location,
+                                 Vector::makeEmpty(),
+                                 1,
+                                 0,
+                                 std::move(pointerLocations),
+                                 TimePoint(0.0),
+                                 Duration(),
+                                 nullptr);
+    }
+
+    return grid;
+}
+
+// Resolves the gesture candidates at a location of a grid with the given number of layers.
+// The second argument tells whether the R-tree hit test index is used.
+static void HitTestGrid(benchmark::State& state) {
+    auto grid = makeTouchGrid(static_cast<int>(state.range(0)));
+    auto useIndex = state.range(1) != 0;
+
+    TouchDispatcher touchDispatcher(Valdi::ConsoleLogger::getLogger(), false);
+    TouchHitTestIndex hitTestIndex;
+    hitTestIndex.update(grid.rootLayer);
+
+    size_t eventIndex = 0;
+    for (auto _ : state) {
+        const auto& event = grid.events[eventIndex++ % grid.events.size()];
+        auto candidates =
+            touchDispatcher.getGestureCandidatesForEvent(event, grid.rootLayer, useIndex ? &hitTestIndex : nullptr);
+        benchmark::DoNotOptimize(candidates);
+    }
+}
+BENCHMARK(HitTestGrid)
+    ->ArgNames({"layers", "index"})
+    ->ArgsProduct({{128, 1024, 8192, 32768}, {0, 1}})
+    ->Unit(benchmark::kMicrosecond);
+
+// Rebuilds the hit test index of a grid with the given number of layers, which happens
+// once after the layer tree changed.
+static void UpdateHitTestIndex(benchmark::State& state) {
+    auto grid = makeTouchGrid(static_cast<int>(state.range(0)));
+    TouchHitTestIndex hitTestIndex;
+
+    for (auto _ : state) {
+        hitTestIndex.update(grid.rootLayer);
+        benchmark::DoNotOptimize(hitTestIndex.size());
+    }
+}
+BENCHMARK(UpdateHitTestIndex)
+    ->ArgName("layers")
+    ->Arg(128)
+    ->Arg(1024)
+    ->Arg(8192)
+    ->Arg(32768)
+    ->Unit(benchmark::kMicrosecond);
+
+// Scrolls the grid and then resolves the gesture candidates at a location, which includes the cost
+// of bringing the hit test index up to date. The second argument tells whether the index is updated
+// incrementally from the moved layer, or rebuilt from scratch.
+static void HitTestGridAfterScroll(benchmark::State& state) {
+    auto grid = makeTouchGrid(static_cast<int>(state.range(0)));
+    auto incremental = state.range(1) != 0;
+
+    TouchDispatcher touchDispatcher(Valdi::ConsoleLogger::getLogger(), false);
+    TouchHitTestIndex hitTestIndex;
+    hitTestIndex.update(grid.rootLayer);
+
+    size_t eventIndex = 0;
+    for (auto _ : state) {
+        auto frame = grid.containerLayer->getFrame();
+        grid.containerLayer->setFrame(frame.makeOffset(0, eventIndex % 2 == 0 ? -1.0f : 1.0f));
+        if (incremental) {
+            hitTestIndex.setLayerNeedsUpdate(*grid.containerLayer);
+        } else {
+            hitTestIndex.setNeedsUpdate();
+        }
+
+        const auto& event = grid.events[eventIndex++ % grid.events.size()];
+        auto candidates = touchDispatcher.getGestureCandidatesForEvent(event, grid.rootLayer, &hitTestIndex);
+        benchmark::DoNotOptimize(candidates);
+    }
+}
+BENCHMARK(HitTestGridAfterScroll)
+    ->ArgNames({"layers", "incremental"})
+    ->ArgsProduct({{128, 1024, 8192, 32768}, {0, 1}})
+    ->Unit(benchmark::kMicrosecond);
@@ -0,0 +1,131 @@
+#include "snap_drawing/cpp/Text/FontManager.hpp"
+#include "snap_drawing/cpp/Text/TextShaperHarfbuzz.hpp"
+#include "snap_drawing/cpp/Text/WordCachingTextShaper.hpp"
+#include "snap_drawing/cpp/Utils/UTFUtils.hpp"
+
+#include "valdi_core/cpp/Utils/ConsoleLogger.hpp"
+
+#include "benchmark/benchmark.h"
+
+using namespace snap::drawing;
+
+// Reproduces the previous behavior of the WordCachingTextShaper, where a single lock
+// was held for the whole duration of the shape call.
+class GloballyLockedTextShaper : public TextShaper {
+public:
+    explicit GloballyLockedTextShaper(const Ref<TextShaper>& innerShaper) : _innerShaper(innerShaper) {}
+
+    TextParagraphList resolveParagraphs(const Character* unicodeText, size_t length, bool isRightToLeft) override {
+        return _innerShaper->resolveParagraphs(unicodeText, length, isRightToLeft);
+    }
+
+    size_t shape(const Character* unicodeText,
+                 size_t length,
+                 Font& font,
+                 bool isRightToLeft,
+                 Scalar letterSpacing,
+                 TextScript script,
+                 std::vector<ShapedGlyph>& out) override {
+        std::lock_guard<Valdi::Mutex> lock(_mutex);
+        return _innerShaper->shape(unicodeText, length, font, isRightToLeft, letterSpacing, script, out);
+    }
+
+private:
+    Valdi::Mutex _mutex;
+    Ref<TextShaper> _innerShaper;
+};
+
+static const std::vector<std::vector<Character>>& getSentences() {
+    static auto* kSentences = new std::vector<std::vector<Character>>{
+        utf8ToUnicode("Hello World! This string might be pretty long"),
+        utf8ToUnicode("and because of that we will have to lay it out on multiple lines"),
+        utf8ToUnicode("The quick brown fox jumps over the lazy dog"),
+        utf8ToUnicode("Measuring text from several threads at the same time"),
+        utf8ToUnicode("Layout happens on the main thread while measurement happens elsewhere"),
+        utf8ToUnicode("Each sentence is made of words that are often repeated across sentences"),
+        utf8ToUnicode("Lorem ipsum dolor sit amet consectetur adipiscing elit"),
+        utf8ToUnicode("Sed do eiusmod tempor incididunt ut labore et dolore magna aliqua"),
+    };
+    return *kSentences;
+}
+
+static Ref<FontManager> gFontManager;
+static Ref<Font> gFont;
+static Ref<TextShaper> gTextShaper;
+
+// Shapes sentences from all the benchmark threads against a single shared shaper, with a warm cache.
+// The argument tells whether the previous globally locked behavior should be reproduced.
+static void ShapeWordsFromThreads(benchmark::State& state) {
+    if (state.thread_index() == 0) {
+        gFontManager = Valdi::makeShared<FontManager>(Valdi::ConsoleLogger::getLogger());
+        gFontManager->load();
+        gFont = gFontManager->getDefaultFont().moveValue();
+
+        auto wordCachingShaper = Valdi::makeShared<WordCachingTextShaper>(
+            Valdi::makeShared<TextShaperHarfbuzz>(), WordCachingTextShaperStrategy::PrioritizeCorrectness);
+        if (state.range(0) != 0) {
+            gTextShaper = Valdi::makeShared<GloballyLockedTextShaper>(wordCachingShaper);
+        } else {
+            gTextShaper = wordCachingShaper;
+        }
+    }
+
+    const auto& sentences = getSentences();
+    std::vector<ShapedGlyph> glyphs;
+    size_t sentenceIndex = static_cast<size_t>(state.thread_index());
+
+    for (auto _ : state) {
+        const auto& sentence = sentences[sentenceIndex % sentences.size()];
+        sentenceIndex++;
+
+        glyphs.clear();
+        gTextShaper->shape(sentence.data(), sentence.size(), *gFont, false, 0.0f, TextScript::common(), glyphs);
+        benchmark::DoNotOptimize(glyphs.data());
+    }
+
+    state.SetItemsProcessed(state.iterations());
+
+    if (state.thread_index() == 0) {
+        gTextShaper = nullptr;
+        gFont = nullptr;
+        gFontManager = nullptr;
+    }
+}
+
+BENCHMARK(ShapeWordsFromThreads)->ArgName("globalLock")->Arg(0)->Arg(1)->ThreadRange(1, 8)->UseRealTime();
+
+// Shapes every sentence once with a new shaper, like the first screens after a cold start.
+// The argument tells whether the shaper is warmed up from a snapshot made by a previous shaper.
+static void ShapeFirstScreen(benchmark::State& state) {
+    auto fontManager = Valdi::makeShared<FontManager>(Valdi::ConsoleLogger::getLogger());
+    fontManager->load();
+    auto font = fontManager->getDefaultFont().moveValue();
+    auto innerShaper = Valdi::makeShared<TextShaperHarfbuzz>();
+    const auto& sentences = getSentences();
+    std::vector<ShapedGlyph> glyphs;
+
+    auto previousShaper =
+        Valdi::makeShared<WordCachingTextShaper>(innerShaper, WordCachingTextShaperStrategy::PrioritizeCorrectness);
+    for (const auto& sentence : sentences) {
+        previousShaper->shape(sentence.data(), sentence.size(), *font, false, 0.0f, TextScript::common(), glyphs);
+    }
+    auto snapshot = previousShaper->makeCacheSnapshot();
+
+    for (auto _ : state) {
+        auto textShaper = Valdi::makeShared<WordCachingTextShaper>(
+            innerShaper, WordCachingTextShaperStrategy::PrioritizeCorrectness);
+        if (state.range(0) != 0) {
+            textShaper->loadCacheSnapshot(snapshot);
+        }
+
+        for (const auto& sentence : sentences) {
+            glyphs.clear();
+            textShaper->shape(sentence.data(), sentence.size(), *font, false, 0.0f, TextScript::common(), glyphs);
+            benchmark::DoNotOptimize(glyphs.data());
+        }
+    }
+
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(sentences.size()));
+}
+
+BENCHMARK(ShapeFirstScreen)->ArgName("warm")->Arg(0)->Arg(1);
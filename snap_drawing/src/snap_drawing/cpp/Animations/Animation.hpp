@@ -45,6 +45,14 @@ public:
      A set of completion handlers to call when the animation completes or is cancelled
      */
     virtual void addCompletion(AnimationCompletion&& completion) = 0;
+
+    /**
+     Whether the animation is currently evaluated by the AnimationEngine of the layer root,
+     in which case the layer does not call run() on it.
+     */
+    virtual bool isRunningInEngine() const {
+        return false;
+    }
 };
 
 class Animation : public IAnimation {
@@ -0,0 +1,205 @@
+//
+//  AnimationEngine.cpp
+//  snap_drawing
+//
+
+#include "snap_drawing/cpp/Animations/AnimationEngine.hpp"
+#include "snap_drawing/cpp/Layers/Interfaces/ILayerRoot.hpp"
+#include "snap_drawing/cpp/Layers/Layer.hpp"
+
+#include "valdi_core/cpp/Utils/SmallVector.hpp"
+#include "valdi_core/cpp/Utils/Trace.hpp"
+
+#include <algorithm>
+
+namespace snap::drawing {
+
+template<typename T>
+static void swapRemove(std::vector<T>& values, size_t index) {
+    if (index + 1 != values.size()) {
+        values[index] = std::move(values.back());
+    }
+    values.pop_back();
+}
+
+struct CompletedPropertyAnimation {
+    Ref<Layer> layer;
+    String key;
+    Ref<PropertyAnimation> animation;
+};
+
+AnimationEngine::AnimationEngine(ILayerRoot& root) : _root(root) {}
+
+AnimationEngine::~AnimationEngine() {
+    for (const auto& animation : _animations) {
+        animation->_engine = nullptr;
+    }
+}
+
+void AnimationEngine::add(Layer& layer, const String& key, const Ref<PropertyAnimation>& animation) {
+    if (animation->_engine == this) {
+        return;
+    }
+    if (animation->_engine != nullptr) {
+        animation->_engine->remove(*animation);
+    }
+
+    animation->_engine = this;
+    animation->_engineIndex = _animations.size();
+
+    const auto& timingCurve = animation->getTimingCurve();
+
+    _layers.emplace_back(Valdi::strongSmallRef(&layer));
+    _keys.emplace_back(key);
+    _animations.emplace_back(animation);
+    _properties.emplace_back(animation->getProperty());
+    _started.emplace_back(animation->_started ? 1 : 0);
+    _elapsedSeconds.emplace_back(animation->_elapsed.seconds());
+    _durationSeconds.emplace_back(animation->getDuration().seconds());
+    _curveP1X.emplace_back(timingCurve.p1x);
+    _curveP1Y.emplace_back(timingCurve.p1y);
+    _curveP2X.emplace_back(timingCurve.p2x);
+    _curveP2Y.emplace_back(timingCurve.p2y);
+    _fromLanes.insert(_fromLanes.end(), animation->getFromLanes().begin(), animation->getFromLanes().end());
+    _toLanes.insert(_toLanes.end(), animation->getToLanes().begin(), animation->getToLanes().end());
+
+    scheduleTick();
+}
+
+void AnimationEngine::remove(PropertyAnimation& animation) {
+    if (animation._engine != this) {
+        return;
+    }
+
+    auto index = animation._engineIndex;
+    // Hand the progress back, so that the animation can continue outside of the engine
+    animation._started = _started[index] != 0;
+    animation._elapsed = Duration(_elapsedSeconds[index]);
+
+    removeAt(index);
+
+    if (empty() && _enqueuedTick) {
+        _root.cancelEvent(_enqueuedTick.value());
+        _enqueuedTick = std::nullopt;
+    }
+}
+
+void AnimationEngine::removeAt(size_t index) {
+    // Keep the animation alive until all the arrays are consistent again
+    auto animation = std::move(_animations[index]);
+    animation->_engine = nullptr;
+
+    swapRemove(_layers, index);
+    swapRemove(_keys, index);
+    swapRemove(_animations, index);
+    swapRemove(_properties, index);
+    swapRemove(_started, index);
+    swapRemove(_elapsedSeconds, index);
+    swapRemove(_durationSeconds, index);
+    swapRemove(_curveP1X, index);
+    swapRemove(_curveP1Y, index);
+    swapRemove(_curveP2X, index);
+    swapRemove(_curveP2Y, index);
+
+    auto lastLanesIndex = _fromLanes.size() - kAnimatedPropertyLanesCount;
+    auto lanesIndex = index * kAnimatedPropertyLanesCount;
+    if (lanesIndex != lastLanesIndex) {
+        std::copy_n(_fromLanes.begin() + lastLanesIndex, kAnimatedPropertyLanesCount, _fromLanes.begin() + lanesIndex);
+        std::copy_n(_toLanes.begin() + lastLanesIndex, kAnimatedPropertyLanesCount, _toLanes.begin() + lanesIndex);
+    }
+    _fromLanes.resize(lastLanesIndex);
+    _toLanes.resize(lastLanesIndex);
+
+    if (index < _animations.size()) {
+        _animations[index]->_engineIndex = index;
+    }
+}
+
+void AnimationEngine::clear() {
+    if (_enqueuedTick) {
+        _root.cancelEvent(_enqueuedTick.value());
+        _enqueuedTick = std::nullopt;
+    }
+
+    while (!_animations.empty()) {
+        remove(*_animations.back());
+    }
+}
+
+size_t AnimationEngine::size() const {
+    return _animations.size();
+}
+
+bool AnimationEngine::empty() const {
+    return _animations.empty();
+}
+
+void AnimationEngine::scheduleTick() {
+    if (_enqueuedTick || _animations.empty()) {
+        return;
+    }
+
+    _enqueuedTick = {_root.enqueueEvent([this](TimePoint /*timePoint*/, Duration delta) { tick(delta); }, Duration(0))};
+}
+
+void AnimationEngine::tick(Duration delta) {
+    _enqueuedTick = std::nullopt;
+
+    auto count = _animations.size();
+    if (count == 0) {
+        return;
+    }
+
+    VALDI_TRACE("SnapDrawing.tickAnimations");
+
+    auto deltaSeconds = delta.seconds();
+    _ratios.resize(count);
+    _completed.resize(count);
+    _values.resize(count * kAnimatedPropertyLanesCount);
+
+    // Advance time. As with Animation, the first tick of an animation applies its initial value
+    // and the animation completes on the first tick after its duration has elapsed.
+    for (size_t i = 0; i < count; i++) {
+        auto wasStarted = _started[i] != 0;
+        auto elapsed = std::min(_elapsedSeconds[i] + (wasStarted ? deltaSeconds : 0.0), _durationSeconds[i]);
+        _elapsedSeconds[i] = elapsed;
+        _completed[i] = static_cast<uint8_t>(wasStarted && elapsed >= _durationSeconds[i]);
+        _started[i] = 1;
+        _ratios[i] = _durationSeconds[i] > 0 ? elapsed / _durationSeconds[i] : (wasStarted ? 1.0 : 0.0);
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        auto mappedX = evaluateTimingCurveAxis(_ratios[i], _curveP1X[i], _curveP2X[i]);
+        _ratios[i] = evaluateTimingCurveAxis(mappedX, _curveP1Y[i], _curveP2Y[i]);
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        auto ratio = static_cast<float>(_ratios[i]);
+        auto offset = i * kAnimatedPropertyLanesCount;
+        for (size_t lane = 0; lane < kAnimatedPropertyLanesCount; lane++) {
+            auto from = _fromLanes[offset + lane];
+            _values[offset + lane] = from + ((_toLanes[offset + lane] - from) * ratio);
+        }
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        applyAnimatedProperty(*_layers[i], _properties[i], &_values[i * kAnimatedPropertyLanesCount]);
+    }
+
+    // Completing animations calls out to arbitrary code which can add or remove animations,
+    // so we collect them before letting the layers complete them.
+    Valdi::SmallVector<CompletedPropertyAnimation, 8> completedAnimations;
+    for (size_t i = 0; i < count; i++) {
+        if (_completed[i] != 0) {
+            completedAnimations.emplace_back(CompletedPropertyAnimation{_layers[i], _keys[i], _animations[i]});
+        }
+    }
+
+    for (const auto& completedAnimation : completedAnimations) {
+        completedAnimation.layer->completeAnimation(completedAnimation.key, completedAnimation.animation);
+    }
+
+    scheduleTick();
+}
+
+} // namespace snap::drawing
@@ -0,0 +1,80 @@
+//
+//  AnimationEngine.hpp
+//  snap_drawing
+//
+
+#pragma once
+
+#include "snap_drawing/cpp/Animations/PropertyAnimation.hpp"
+#include "snap_drawing/cpp/Events/EventId.hpp"
+#include "snap_drawing/cpp/Utils/Aliases.hpp"
+
+#include "valdi_core/cpp/Utils/Shared.hpp"
+
+#include <optional>
+#include <vector>
+
+namespace snap::drawing {
+
+class ILayerRoot;
+
+/**
+ AnimationEngine evaluates all the PropertyAnimation of a layer tree once per frame, instead of
+ each layer scheduling its own frame callback and running its animations one at a time.
+ The animations are stored as parallel arrays, so that advancing time, evaluating the timing
+ curves and interpolating the values are each done as a single tight loop over contiguous values,
+ which the compiler can vectorize. The results are then written back to the layers in one pass.
+ */
+class AnimationEngine {
+public:
+    explicit AnimationEngine(ILayerRoot& root);
+    ~AnimationEngine();
+
+    /**
+     Start driving the given animation of the layer, registered under the given key.
+     */
+    void add(Layer& layer, const String& key, const Ref<PropertyAnimation>& animation);
+
+    /**
+     Stop driving the given animation, without applying or completing it.
+     */
+    void remove(PropertyAnimation& animation);
+
+    /**
+     Stop driving all the animations.
+     */
+    void clear();
+
+    size_t size() const;
+    bool empty() const;
+
+private:
+    ILayerRoot& _root;
+    std::optional<EventId> _enqueuedTick;
+
+    std::vector<Ref<Layer>> _layers;
+    std::vector<String> _keys;
+    std::vector<Ref<PropertyAnimation>> _animations;
+    std::vector<AnimatedProperty> _properties;
+    std::vector<uint8_t> _started;
+    std::vector<double> _elapsedSeconds;
+    std::vector<double> _durationSeconds;
+    std::vector<float> _curveP1X;
+    std::vector<float> _curveP1Y;
+    std::vector<float> _curveP2X;
+    std::vector<float> _curveP2Y;
+    // kAnimatedPropertyLanesCount values per animation
+    std::vector<float> _fromLanes;
+    std::vector<float> _toLanes;
+
+    // Scratch buffers reused across ticks
+    std::vector<double> _ratios;
+    std::vector<uint8_t> _completed;
+    std::vector<float> _values;
+
+    void scheduleTick();
+    void tick(Duration delta);
+    void removeAt(size_t index);
+};
+
+} // namespace snap::drawing
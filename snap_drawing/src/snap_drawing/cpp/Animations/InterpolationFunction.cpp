@@ -13,8 +13,9 @@
 
 namespace snap::drawing {
 
-static Bezier::Bezier<3> makeTimingCurve(float p1x, float p1y, float p2x, float p2y) {
-    Bezier::Bezier<3> curve({{0.0, 0.0}, {p1x, p1y}, {p2x, p2y}, {1.0, 1.0}});
+static Bezier::Bezier<3> makeTimingCurve(const TimingCurve& timingCurve) {
+    Bezier::Bezier<3> curve(
+        {{0.0, 0.0}, {timingCurve.p1x, timingCurve.p1y}, {timingCurve.p2x, timingCurve.p2y}, {1.0, 1.0}});
     return curve;
 }
 
@@ -27,15 +28,24 @@ static InterpolationFunction makeInterpolationFunction(const Bezier::Bezier<3>&
 }
 
 // matches https://developer.apple.com/documentation/quartzcore/camediatimingfunctionname/1521854-default
-Bezier::Bezier<3> defaultBezier = makeTimingCurve(0.25, 0.1, 0.25, 1.0);
+constexpr TimingCurve kDefaultTimingCurve = {0.25, 0.1, 0.25, 1.0};
 // matches https://developer.apple.com/documentation/quartzcore/camediatimingfunctionname/1522173-easeineaseout
-Bezier::Bezier<3> easeInOutBezier = makeTimingCurve(0.42, 0.0, 0.58, 1.0);
+constexpr TimingCurve kEaseInOutTimingCurve = {0.42, 0.0, 0.58, 1.0};
 // matches https://developer.apple.com/documentation/quartzcore/camediatimingfunctionname/1521971-easein
-Bezier::Bezier<3> easeInBezier = makeTimingCurve(0.42, 0.0, 1.0, 1.0);
+constexpr TimingCurve kEaseInTimingCurve = {0.42, 0.0, 1.0, 1.0};
 // matches https://developer.apple.com/documentation/quartzcore/camediatimingfunctionname/1522178-easeout
-Bezier::Bezier<3> easeOutBezier = makeTimingCurve(0.0, 0.0, 0.58, 1.0);
+constexpr TimingCurve kEaseOutTimingCurve = {0.0, 0.0, 0.58, 1.0};
 
-Bezier::Bezier<3> strongEaseOutBezier = makeTimingCurve(0.9, 0.90, 0.95, 1.0);
+constexpr TimingCurve kStrongEaseOutTimingCurve = {0.9, 0.90, 0.95, 1.0};
+
+// A cubic bezier with control points evenly spaced on the diagonal evaluates to its input
+constexpr TimingCurve kLinearTimingCurve = {1.0f / 3.0f, 1.0f / 3.0f, 2.0f / 3.0f, 2.0f / 3.0f};
+
+Bezier::Bezier<3> defaultBezier = makeTimingCurve(kDefaultTimingCurve);
+Bezier::Bezier<3> easeInOutBezier = makeTimingCurve(kEaseInOutTimingCurve);
+Bezier::Bezier<3> easeInBezier = makeTimingCurve(kEaseInTimingCurve);
+Bezier::Bezier<3> easeOutBezier = makeTimingCurve(kEaseOutTimingCurve);
+Bezier::Bezier<3> strongEaseOutBezier = makeTimingCurve(kStrongEaseOutTimingCurve);
 
 static const ViscousFluidInterpolator& getViscousFluidInterpolator() {
     static ViscousFluidInterpolator kInstance;
@@ -70,4 +80,33 @@ InterpolationFunction InterpolationFunctions::viscousFluid() {
     return [](double ratio) -> double { return getViscousFluidInterpolator().interpolate(ratio); };
 }
 
+double TimingCurve::evaluate(double ratio) const {
+    auto mappedX = evaluateTimingCurveAxis(ratio, p1x, p2x);
+    return evaluateTimingCurveAxis(mappedX, p1y, p2y);
+}
+
+TimingCurve TimingCurve::linear() {
+    return kLinearTimingCurve;
+}
+
+TimingCurve TimingCurve::systemDefault() {
+    return kDefaultTimingCurve;
+}
+
+TimingCurve TimingCurve::easeInOut() {
+    return kEaseInOutTimingCurve;
+}
+
+TimingCurve TimingCurve::easeIn() {
+    return kEaseInTimingCurve;
+}
+
+TimingCurve TimingCurve::easeOut() {
+    return kEaseOutTimingCurve;
+}
+
+TimingCurve TimingCurve::strongEaseOut() {
+    return kStrongEaseOutTimingCurve;
+}
+
 } // namespace snap::drawing
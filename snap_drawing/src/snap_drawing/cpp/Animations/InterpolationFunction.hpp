@@ -13,6 +13,35 @@ namespace snap::drawing {
 
 using InterpolationFunction = Valdi::Function<double(double)>;
 
+/**
+ The control points of a cubic bezier timing curve going from (0, 0) to (1, 1).
+ Unlike an InterpolationFunction, a TimingCurve is plain data which can be evaluated
+ for many animations at once.
+ */
+struct TimingCurve {
+    float p1x = 0;
+    float p1y = 0;
+    float p2x = 0;
+    float p2y = 0;
+
+    double evaluate(double ratio) const;
+
+    static TimingCurve linear();
+    static TimingCurve systemDefault();
+    static TimingCurve easeInOut();
+    static TimingCurve easeIn();
+    static TimingCurve easeOut();
+    static TimingCurve strongEaseOut();
+};
+
+/**
+ Evaluate one axis of a cubic bezier curve going from 0 to 1 with the given inner control points.
+ */
+inline double evaluateTimingCurveAxis(double t, double p1, double p2) {
+    auto oneMinusT = 1.0 - t;
+    return (3.0 * oneMinusT * oneMinusT * t * p1) + (3.0 * oneMinusT * t * t * p2) + (t * t * t);
+}
+
 class InterpolationFunctions {
 public:
     static InterpolationFunction linear();
@@ -0,0 +1,152 @@
+//
+//  PropertyAnimation.cpp
+//  snap_drawing
+//
+
+#include "snap_drawing/cpp/Animations/PropertyAnimation.hpp"
+#include "snap_drawing/cpp/Animations/AnimationEngine.hpp"
+#include "snap_drawing/cpp/Layers/Layer.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace snap::drawing {
+
+static AnimatedPropertyLanes toLanes(Scalar value) {
+    return {value, 0, 0, 0};
+}
+
+static AnimatedPropertyLanes toLanes(Color color) {
+    auto red = static_cast<float>(color.getRed());
+    auto green = static_cast<float>(color.getGreen());
+    auto blue = static_cast<float>(color.getBlue());
+    return {static_cast<float>(color.getAlpha()), red * red, green * green, blue * blue};
+}
+
+static ColorComponent toColorComponent(float value) {
+    return static_cast<ColorComponent>(std::clamp(value, 0.0f, 255.0f));
+}
+
+static Color colorFromLanes(const float* lanes) {
+    return Color::makeARGB(toColorComponent(lanes[0]),
+                           toColorComponent(std::sqrt(std::max(lanes[1], 0.0f))),
+                           toColorComponent(std::sqrt(std::max(lanes[2], 0.0f))),
+                           toColorComponent(std::sqrt(std::max(lanes[3], 0.0f))));
+}
+
+void applyAnimatedProperty(Layer& layer, AnimatedProperty property, const float* lanes) {
+    switch (property) {
+        case AnimatedProperty::Opacity:
+            layer.setOpacity(lanes[0]);
+            break;
+        case AnimatedProperty::TranslationX:
+            layer.setTranslationX(lanes[0]);
+            break;
+        case AnimatedProperty::TranslationY:
+            layer.setTranslationY(lanes[0]);
+            break;
+        case AnimatedProperty::ScaleX:
+            layer.setScaleX(lanes[0]);
+            break;
+        case AnimatedProperty::ScaleY:
+            layer.setScaleY(lanes[0]);
+            break;
+        case AnimatedProperty::Rotation:
+            layer.setRotation(lanes[0]);
+            break;
+        case AnimatedProperty::BackgroundColor:
+            layer.setBackgroundColor(colorFromLanes(lanes));
+            break;
+    }
+}
+
+PropertyAnimation::PropertyAnimation(
+    AnimatedProperty property, Duration duration, const TimingCurve& timingCurve, Scalar from, Scalar to)
+    : _property(property), _duration(duration), _timingCurve(timingCurve), _from(toLanes(from)), _to(toLanes(to)) {}
+
+PropertyAnimation::PropertyAnimation(
+    AnimatedProperty property, Duration duration, const TimingCurve& timingCurve, Color from, Color to)
+    : _property(property), _duration(duration), _timingCurve(timingCurve), _from(toLanes(from)), _to(toLanes(to)) {}
+
+PropertyAnimation::~PropertyAnimation() = default;
+
+bool PropertyAnimation::run(Layer& layer, Duration delta) {
+    if (!_started) {
+        apply(layer, 0.0);
+        _started = true;
+        return false;
+    }
+
+    _elapsed += delta;
+
+    if (_elapsed >= _duration) {
+        _elapsed = _duration;
+        apply(layer, 1.0);
+        return true;
+    }
+
+    apply(layer, _timingCurve.evaluate(_elapsed.seconds() / _duration.seconds()));
+    return false;
+}
+
+void PropertyAnimation::apply(Layer& layer, double ratio) const {
+    AnimatedPropertyLanes lanes;
+    for (size_t i = 0; i < kAnimatedPropertyLanesCount; i++) {
+        lanes[i] = _from[i] + ((_to[i] - _from[i]) * static_cast<float>(ratio));
+    }
+    applyAnimatedProperty(layer, _property, lanes.data());
+}
+
+void PropertyAnimation::cancel(Layer& layer) {
+    finish(layer, false);
+}
+
+void PropertyAnimation::complete(Layer& layer) {
+    finish(layer, true);
+}
+
+void PropertyAnimation::finish(Layer& layer, bool didComplete) {
+    if (_engine != nullptr) {
+        _engine->remove(*this);
+    }
+
+    if (!_finished) {
+        _finished = true;
+        apply(layer, 1.0);
+    }
+
+    auto completions = std::move(_completions);
+    for (const auto& completion : completions) {
+        completion(didComplete);
+    }
+}
+
+void PropertyAnimation::addCompletion(AnimationCompletion&& completion) {
+    _completions.emplace_back(std::move(completion));
+}
+
+bool PropertyAnimation::isRunningInEngine() const {
+    return _engine != nullptr;
+}
+
+AnimatedProperty PropertyAnimation::getProperty() const {
+    return _property;
+}
+
+Duration PropertyAnimation::getDuration() const {
+    return _duration;
+}
+
+const TimingCurve& PropertyAnimation::getTimingCurve() const {
+    return _timingCurve;
+}
+
+const AnimatedPropertyLanes& PropertyAnimation::getFromLanes() const {
+    return _from;
+}
+
+const AnimatedPropertyLanes& PropertyAnimation::getToLanes() const {
+    return _to;
+}
+
+} // namespace snap::drawing
@@ -0,0 +1,91 @@
+//
+//  PropertyAnimation.hpp
+//  snap_drawing
+//
+
+#pragma once
+
+#include "snap_drawing/cpp/Animations/Animation.hpp"
+#include "snap_drawing/cpp/Utils/Color.hpp"
+#include "snap_drawing/cpp/Utils/Scalar.hpp"
+
+#include <array>
+#include <cstdint>
+
+namespace snap::drawing {
+
+class AnimationEngine;
+
+enum class AnimatedProperty : uint8_t {
+    Opacity,
+    TranslationX,
+    TranslationY,
+    ScaleX,
+    ScaleY,
+    Rotation,
+    BackgroundColor,
+};
+
+/**
+ The values of an animated property, as a fixed number of lanes which are interpolated linearly.
+ Scalar properties only use the first lane. Colors use one lane per component, where the color
+ components are stored squared, to match the blending of interpolateValue(Color, Color, double).
+ */
+constexpr size_t kAnimatedPropertyLanesCount = 4;
+using AnimatedPropertyLanes = std::array<float, kAnimatedPropertyLanesCount>;
+
+/**
+ Set the value held by the given interpolated lanes on the property of the layer.
+ */
+void applyAnimatedProperty(Layer& layer, AnimatedProperty property, const float* lanes);
+
+/**
+ A timing curve animation of one of the well known properties of a Layer. Unlike an Animation,
+ which goes through an opaque applier, a PropertyAnimation is described by plain data and is
+ evaluated in bulk with the other property animations of the tree by the AnimationEngine of the
+ LayerRoot. It runs itself through run() when the layer has no AnimationEngine.
+ */
+class PropertyAnimation : public IAnimation {
+public:
+    PropertyAnimation(
+        AnimatedProperty property, Duration duration, const TimingCurve& timingCurve, Scalar from, Scalar to);
+    PropertyAnimation(
+        AnimatedProperty property, Duration duration, const TimingCurve& timingCurve, Color from, Color to);
+    ~PropertyAnimation() override;
+
+    bool run(Layer& layer, Duration delta) override;
+
+    void cancel(Layer& layer) override;
+
+    void complete(Layer& layer) override;
+
+    void addCompletion(AnimationCompletion&& completion) override;
+
+    bool isRunningInEngine() const override;
+
+    AnimatedProperty getProperty() const;
+    Duration getDuration() const;
+    const TimingCurve& getTimingCurve() const;
+    const AnimatedPropertyLanes& getFromLanes() const;
+    const AnimatedPropertyLanes& getToLanes() const;
+
+private:
+    friend AnimationEngine;
+
+    AnimatedProperty _property;
+    Duration _duration;
+    Duration _elapsed;
+    TimingCurve _timingCurve;
+    AnimatedPropertyLanes _from;
+    AnimatedPropertyLanes _to;
+    std::vector<AnimationCompletion> _completions;
+    AnimationEngine* _engine = nullptr;
+    size_t _engineIndex = 0;
+    bool _started = false;
+    bool _finished = false;
+
+    void apply(Layer& layer, double ratio) const;
+    void finish(Layer& layer, bool didComplete);
+};
+
+} // namespace snap::drawing
@@ -16,6 +16,9 @@
 #include "include/core/SkCanvas.h"
 #include "include/core/SkPicture.h"
 #include "valdi_core/cpp/Utils/LoggerUtils.hpp"
+
+#include <boost/functional/hash.hpp>
+
 #include <cstdint>
 
 namespace snap::drawing {
@@ -54,16 +57,38 @@ TimePoint DisplayList::getFrameTime() const {
     return _frameTime;
 }
 
-void DisplayList::pushContext(const Matrix& matrix, Scalar opacity, uint64_t layerId, bool hasUpdates) {
+template<typename T>
+void DisplayList::combineContentHash(const T& value) {
+    boost::hash_combine(_currentPlane->contentHash, value);
+}
+
+void DisplayList::combineContentHash(const Matrix& matrix) {
+    Scalar values[9];
+    matrix.getSkValue().get9(values);
+    for (auto value : values) {
+        combineContentHash(value);
+    }
+}
+
+void DisplayList::pushContext(
+    const Matrix& matrix, Scalar opacity, uint64_t layerId, bool hasUpdates, bool cachesRasterTiles) {
     auto* op = appendOperation<Operations::PushContext>();
     op->matrix = matrix;
     op->opacity = opacity;
     op->layerId = layerId;
     op->hasUpdates = hasUpdates;
+    op->cachesRasterTiles = cachesRasterTiles;
+
+    // hasUpdates only drives damage tracking and does not change the drawn content
+    combineContentHash(Operations::PushContext::kId);
+    combineContentHash(matrix);
+    combineContentHash(opacity);
 }
 
 void DisplayList::popContext() {
     appendOperation<Operations::PopContext>();
+
+    combineContentHash(Operations::PopContext::kId);
 }
 
 void DisplayList::appendLayerContent(const LayerContent& layerContent, Scalar opacity) {
@@ -78,6 +103,9 @@ void DisplayList::appendLayerContent(const LayerContent& layerContent, Scalar op
 
         op->externalSurfaceSnapshot->unsafeRetainInner();
         _hasExternalSurfaces = true;
+        // Only the position of the external surface is part of the content hash, it is
+        // presented separately and draws nothing into the plane
+        combineContentHash(Operations::DrawExternalSurface::kId);
     }
 }
 
@@ -87,6 +115,11 @@ void DisplayList::appendPicture(SkPicture* picture, Scalar opacity) {
     op->opacity = opacity;
 
     op->picture->ref();
+
+    // Pictures are immutable, their unique id identifies their content
+    combineContentHash(Operations::DrawPicture::kId);
+    combineContentHash(picture->uniqueID());
+    combineContentHash(opacity);
 }
 
 void DisplayList::appendClipRound(const BorderRadius& borderRadius, Scalar width, Scalar height) {
@@ -97,6 +130,18 @@ void DisplayList::appendClipRound(const BorderRadius& borderRadius, Scalar width
         op->width = width;
         op->height = height;
         op->borderRadius = borderRadius;
+
+        combineContentHash(Operations::ClipRound::kId);
+        combineContentHash(width);
+        combineContentHash(height);
+        combineContentHash(borderRadius.topLeft());
+        combineContentHash(borderRadius.topRight());
+        combineContentHash(borderRadius.bottomRight());
+        combineContentHash(borderRadius.bottomLeft());
+        combineContentHash(borderRadius.topLeftIsPercent());
+        combineContentHash(borderRadius.topRightIsPercent());
+        combineContentHash(borderRadius.bottomRightIsPercent());
+        combineContentHash(borderRadius.bottomLeftIsPercent());
     }
 }
 
@@ -104,6 +149,10 @@ void DisplayList::appendClipRect(Scalar width, Scalar height) {
     auto* op = appendOperation<Operations::ClipRect>();
     op->width = width;
     op->height = height;
+
+    combineContentHash(Operations::ClipRect::kId);
+    combineContentHash(width);
+    combineContentHash(height);
 }
 
 void DisplayList::appendPrepareMask(IMask* mask) {
@@ -112,12 +161,16 @@ void DisplayList::appendPrepareMask(IMask* mask) {
     op->mask->unsafeRetainInner();
 
     _hasMask = true;
+    // Masks draw their own content, which is not captured by the operations
+    _currentPlane->hasUnhashableContent = true;
 }
 
 void DisplayList::appendApplyMask(IMask* mask) {
     auto* op = appendOperation<Operations::ApplyMask>();
     op->mask = mask;
     op->mask->unsafeRetainInner();
+
+    _currentPlane->hasUnhashableContent = true;
 }
 
 size_t DisplayList::getBytesUsed(size_t planeIndex) const {
@@ -126,6 +179,110 @@ size_t DisplayList::getBytesUsed(size_t planeIndex) const {
     return ptrs.second - ptrs.first;
 }
 
+std::optional<size_t> DisplayList::getPlaneContentHash(size_t planeIndex) const {
+    const auto& plane = _planes[planeIndex];
+    if (plane.hasUnhashableContent) {
+        return std::nullopt;
+    }
+
+    auto hash = plane.contentHash;
+    boost::hash_combine(hash, _size.width);
+    boost::hash_combine(hash, _size.height);
+
+    auto viewport = getViewport();
+    boost::hash_combine(hash, viewport.left);
+    boost::hash_combine(hash, viewport.top);
+    boost::hash_combine(hash, viewport.right);
+    boost::hash_combine(hash, viewport.bottom);
+
+    return {hash};
+}
+
+static bool hasSameContent(const Operations::PushContext& pushContext, const Operations::PushContext& other) {
+    return pushContext.matrix == other.matrix && pushContext.opacity == other.opacity;
+}
+
+static bool hasSameContent(const Operations::PopContext& /*popContext*/, const Operations::PopContext& /*other*/) {
+    return true;
+}
+
+static bool hasSameContent(const Operations::DrawPicture& drawPicture, const Operations::DrawPicture& other) {
+    return drawPicture.picture->uniqueID() == other.picture->uniqueID() && drawPicture.opacity == other.opacity;
+}
+
+static bool hasSameContent(const Operations::ClipRect& clipRect, const Operations::ClipRect& other) {
+    return clipRect.width == other.width && clipRect.height == other.height;
+}
+
+static bool hasSameContent(const Operations::ClipRound& clipRound, const Operations::ClipRound& other) {
+    return clipRound.width == other.width && clipRound.height == other.height &&
+           clipRound.borderRadius == other.borderRadius;
+}
+
+static bool hasSameContent(const Operations::DrawExternalSurface& /*drawExternalSurface*/,
+                           const Operations::DrawExternalSurface& /*other*/) {
+    // External surfaces are presented separately and draw nothing into the plane
+    return true;
+}
+
+static bool hasSameContent(const Operations::PrepareMask& /*prepareMask*/, const Operations::PrepareMask& /*other*/) {
+    return false;
+}
+
+static bool hasSameContent(const Operations::ApplyMask& /*applyMask*/, const Operations::ApplyMask& /*other*/) {
+    return false;
+}
+
+/**
+ Visitor which compares the visited operation with the operation of the same type at otherOperation.
+ */
+struct SameContentOperationVisitor {
+    const Valdi::Byte* otherOperation = nullptr;
+    bool hasSameContent = true;
+
+    template<typename Operation>
+    const Valdi::Byte* visit(const Operation& operation) {
+        hasSameContent = snap::drawing::hasSameContent(operation, *reinterpret_cast<const Operation*>(otherOperation));
+        return reinterpret_cast<const Valdi::Byte*>(&operation) + sizeof(Operation);
+    }
+};
+
+bool DisplayList::hasSamePlaneContent(size_t planeIndex, const DisplayList& other, size_t otherPlaneIndex) const {
+    auto contentHash = getPlaneContentHash(planeIndex);
+    if (!contentHash || contentHash != other.getPlaneContentHash(otherPlaneIndex) || _size != other._size ||
+        getViewport() != other.getViewport()) {
+        return false;
+    }
+
+    auto ptrs = getBeginEndPtrs(planeIndex);
+    auto otherPtrs = other.getBeginEndPtrs(otherPlaneIndex);
+    if (ptrs.second - ptrs.first != otherPtrs.second - otherPtrs.first) {
+        return false;
+    }
+
+    SameContentOperationVisitor visitor;
+    const Valdi::Byte* current = ptrs.first;
+    const Valdi::Byte* otherCurrent = otherPtrs.first;
+    while (current != ptrs.second) {
+        const auto& operation = *reinterpret_cast<const Operations::Operation*>(current);
+        if (operation.type != reinterpret_cast<const Operations::Operation*>(otherCurrent)->type) {
+            return false;
+        }
+
+        visitor.otherOperation = otherCurrent;
+        auto* next = Operations::visitOperation(operation, visitor);
+        if (!visitor.hasSameContent) {
+            return false;
+        }
+
+        // Operations of the same type have the same size
+        otherCurrent += next - current;
+        current = next;
+    }
+
+    return true;
+}
+
 size_t DisplayList::getPlanesCount() const {
     return _planes.size();
 }
@@ -215,6 +372,15 @@ static void prepareCanvas(SkCanvas* canvas, Scalar scaleX, Scalar scaleY, bool s
 
 void DisplayList::draw(
     DrawableSurfaceCanvas& canvas, size_t planeIndex, Scalar scaleX, Scalar scaleY, bool shouldClearCanvas) const {
+    doDraw(canvas, planeIndex, scaleX, scaleY, shouldClearCanvas, nullptr);
+}
+
+void DisplayList::doDraw(DrawableSurfaceCanvas& canvas,
+                         size_t planeIndex,
+                         Scalar scaleX,
+                         Scalar scaleY,
+                         bool shouldClearCanvas,
+                         RasterTileCache* rasterTileCache) const {
     auto* skiaCanvas = canvas.getSkiaCanvas();
 
     // A set-but-empty viewport means nothing is visible (e.g. the layer is fully off screen);
@@ -256,13 +422,20 @@ void DisplayList::draw(
         skiaCanvas->saveLayer(nullptr, nullptr);
     }
 
-    DrawDisplayListVisitor visitor(skiaCanvas, scaleX, scaleY);
+    DrawDisplayListVisitor visitor(skiaCanvas, scaleX, scaleY, rasterTileCache);
     visitOperations(planeIndex, visitor);
 
     skiaCanvas->restoreToCount(saveCount);
 }
 
 void DisplayList::draw(DrawableSurfaceCanvas& canvas, size_t planeIndex, bool shouldClearCanvas) const {
+    draw(canvas, planeIndex, shouldClearCanvas, nullptr);
+}
+
+void DisplayList::draw(DrawableSurfaceCanvas& canvas,
+                       size_t planeIndex,
+                       bool shouldClearCanvas,
+                       RasterTileCache* rasterTileCache) const {
     auto canvasWidth = canvas.getWidth();
     auto canvasHeight = canvas.getHeight();
 
@@ -277,7 +450,7 @@ void DisplayList::draw(DrawableSurfaceCanvas& canvas, size_t planeIndex, bool sh
     auto scaleX = static_cast<Scalar>(canvasWidth) / viewport.width();
     auto scaleY = static_cast<Scalar>(canvasHeight) / viewport.height();
 
-    draw(canvas, planeIndex, scaleX, scaleY, shouldClearCanvas);
+    doDraw(canvas, planeIndex, scaleX, scaleY, shouldClearCanvas, rasterTileCache);
 }
 
 } // namespace snap::drawing
@@ -30,6 +30,7 @@ namespace snap::drawing {
 
 class DrawableSurfaceCanvas;
 class IMask;
+class RasterTileCache;
 
 extern size_t kDisplayListAllPlaneIndexes;
 
@@ -37,6 +38,10 @@ using PooledByteBuffer = Valdi::ObjectPoolEntry<Valdi::ByteBuffer, void (*)(Vald
 
 struct DisplayListPlane {
     PooledByteBuffer operations;
+    // Hash of the drawn content of the operations, updated as they are appended
+    size_t contentHash = 0;
+    // Whether the plane contains operations whose drawn content cannot be hashed
+    bool hasUnhashableContent = false;
 
     explicit DisplayListPlane(PooledByteBuffer&& operations);
 };
@@ -64,7 +69,8 @@ public:
     void setViewport(const Rect& viewport);
     Rect getViewport() const;
 
-    void pushContext(const Matrix& matrix, Scalar opacity, uint64_t layerId, bool hasUpdates);
+    void pushContext(
+        const Matrix& matrix, Scalar opacity, uint64_t layerId, bool hasUpdates, bool cachesRasterTiles = false);
     void popContext();
 
     void appendLayerContent(const LayerContent& layerContent, Scalar opacity);
@@ -80,6 +86,22 @@ public:
 
     size_t getBytesUsed(size_t planeIndex) const;
 
+    /**
+     Returns a hash of the content that would be drawn for the given plane, which includes
+     the size and viewport of the DisplayList. Two planes with the same content hash draw the
+     same pixels into a surface of a given size. Returns an empty optional if the plane
+     contains operations whose content cannot be hashed, like masks.
+     */
+    std::optional<size_t> getPlaneContentHash(size_t planeIndex) const;
+
+    /**
+     Returns whether the given plane draws the same content as the plane of another DisplayList.
+     The content hashes are compared first, the operations are then compared one by one to rule
+     out hash collisions. The other DisplayList must be retained by the caller, so that the
+     pictures it references cannot be confused with new pictures allocated at the same address.
+     */
+    bool hasSamePlaneContent(size_t planeIndex, const DisplayList& other, size_t otherPlaneIndex) const;
+
     void appendPlane();
     void removePlane(size_t planeIndex);
 
@@ -95,6 +117,15 @@ public:
 
     void draw(DrawableSurfaceCanvas& canvas, size_t planeIndex, bool shouldClearCanvas = true) const;
 
+    /**
+     Draw the plane using the given RasterTileCache, so that the contexts which were pushed with
+     cachesRasterTiles are drawn from retained tiles instead of being replayed.
+     */
+    void draw(DrawableSurfaceCanvas& canvas,
+              size_t planeIndex,
+              bool shouldClearCanvas,
+              RasterTileCache* rasterTileCache) const;
+
     template<typename Visitor>
     void visitOperations(size_t planeIndex, Visitor& visitor) const {
         if (planeIndex == kDisplayListAllPlaneIndexes) {
@@ -107,6 +138,21 @@ public:
         }
     }
 
+    /**
+     Visit the operations stored between the given pointers, which must be operation boundaries
+     of one of the planes of a DisplayList.
+     */
+    template<typename Visitor>
+    static void visitOperations(const Valdi::Byte* begin, const Valdi::Byte* end, Visitor& visitor) {
+        BytesVisitor<Visitor> bytesVisitor(visitor);
+
+        const auto* current = begin;
+        while (current != end) {
+            current = snap::drawing::Operations::visitOperation(
+                *reinterpret_cast<const Operations::Operation*>(current), bytesVisitor);
+        }
+    }
+
 private:
     Valdi::SmallVector<DisplayListPlane, 1> _planes;
     DisplayListPlane* _currentPlane = nullptr;
@@ -118,6 +164,17 @@ private:
 
     std::pair<Valdi::Byte*, Valdi::Byte*> getBeginEndPtrs(size_t planeIndex) const;
 
+    void doDraw(DrawableSurfaceCanvas& canvas,
+                size_t planeIndex,
+                Scalar scaleX,
+                Scalar scaleY,
+                bool shouldClearCanvas,
+                RasterTileCache* rasterTileCache) const;
+
+    template<typename T>
+    void combineContentHash(const T& value);
+    void combineContentHash(const Matrix& matrix);
+
     template<typename T>
     T* appendOperation() {
         auto* operation =
@@ -143,15 +200,7 @@ private:
     template<typename Visitor>
     void doVisitOperations(size_t planeIndex, Visitor& visitor) const {
         auto ptrs = getBeginEndPtrs(planeIndex);
-        BytesVisitor<Visitor> bytesVisitor(visitor);
-
-        const auto* current = ptrs.first;
-        const auto* end = ptrs.second;
-
-        while (current != end) {
-            current = snap::drawing::Operations::visitOperation(
-                *reinterpret_cast<const Operations::Operation*>(current), bytesVisitor);
-        }
+        visitOperations(ptrs.first, ptrs.second, visitor);
     }
 };
 
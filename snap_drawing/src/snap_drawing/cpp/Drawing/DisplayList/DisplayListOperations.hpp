@@ -31,6 +31,8 @@ struct PushContext : public Operation {
     Scalar opacity;
     uint64_t layerId;
     bool hasUpdates;
+    // Whether the content of this context can be rasterized into retained tiles
+    bool cachesRasterTiles;
 };
 
 struct PopContext : public Operation {
@@ -9,15 +9,30 @@
 
 #include "include/core/SkCanvas.h"
 
+#include "snap_drawing/cpp/Drawing/DisplayList/DisplayList.hpp"
 #include "snap_drawing/cpp/Drawing/Mask/IMask.hpp"
 #include "snap_drawing/cpp/Drawing/Paint.hpp"
+#include "snap_drawing/cpp/Drawing/Raster/RasterTileCache.hpp"
 
 namespace snap::drawing {
 
-DrawDisplayListVisitor::DrawDisplayListVisitor(SkCanvas* canvas, Scalar scaleX, Scalar scaleY)
-    : _canvas(canvas), _scaleX(scaleX), _scaleY(scaleY), _tempRect(Rect::makeEmpty()) {}
+DrawDisplayListVisitor::DrawDisplayListVisitor(SkCanvas* canvas,
+                                               Scalar scaleX,
+                                               Scalar scaleY,
+                                               RasterTileCache* rasterTileCache)
+    : _canvas(canvas),
+      _scaleX(scaleX),
+      _scaleY(scaleY),
+      _tempRect(Rect::makeEmpty()),
+      _rasterTileCache(rasterTileCache) {}
 
 void DrawDisplayListVisitor::visit(const Operations::PushContext& pushContext) {
+    if (_cachedContextDepth > 0) {
+        // Nested in a context which will be drawn through the tile cache
+        _cachedContextDepth++;
+        return;
+    }
+
     if (pushContext.opacity == 1.0f) {
         _canvas->save();
     } else {
@@ -32,13 +47,45 @@ void DrawDisplayListVisitor::visit(const Operations::PushContext& pushContext) {
     matrix.setTranslateY(sanitizeScalarFromScale(matrix.getTranslateY(), _scaleY));
 
     _canvas->concat(matrix.getSkValue());
+
+    if (pushContext.cachesRasterTiles && _rasterTileCache != nullptr) {
+        // The operations of this context are collected until the matching PopContext
+        _cachedContext = &pushContext;
+        _cachedContextDepth = 1;
+    }
 }
 
-void DrawDisplayListVisitor::visit(const Operations::PopContext& /*popContext*/) {
+void DrawDisplayListVisitor::visit(const Operations::PopContext& popContext) {
+    if (_cachedContextDepth > 0) {
+        _cachedContextDepth--;
+        if (_cachedContextDepth > 0) {
+            return;
+        }
+
+        drawCachedContext(popContext);
+    }
+
     _canvas->restore();
 }
 
+void DrawDisplayListVisitor::drawCachedContext(const Operations::PopContext& popContext) {
+    const auto* pushContext = _cachedContext;
+    _cachedContext = nullptr;
+
+    const auto* begin = reinterpret_cast<const Valdi::Byte*>(pushContext) + sizeof(Operations::PushContext);
+    const auto* end = reinterpret_cast<const Valdi::Byte*>(&popContext);
+
+    if (!_rasterTileCache->draw(_canvas, pushContext->layerId, begin, end, _scaleX, _scaleY)) {
+        // The content cannot be cached, replay it directly
+        DisplayList::visitOperations(begin, end, *this);
+    }
+}
+
 void DrawDisplayListVisitor::visit(const Operations::DrawPicture& drawPicture) {
+    if (_cachedContextDepth > 0) {
+        return;
+    }
+
     if (drawPicture.opacity == 1.0f) {
         _canvas->drawPicture(drawPicture.picture);
     } else {
@@ -49,6 +96,10 @@ void DrawDisplayListVisitor::visit(const Operations::DrawPicture& drawPicture) {
 }
 
 void DrawDisplayListVisitor::visit(const Operations::ClipRect& clipRect) {
+    if (_cachedContextDepth > 0) {
+        return;
+    }
+
     _tempRect.right = clipRect.width;
     _tempRect.bottom = clipRect.height;
 
@@ -56,6 +107,10 @@ void DrawDisplayListVisitor::visit(const Operations::ClipRect& clipRect) {
 }
 
 void DrawDisplayListVisitor::visit(const Operations::ClipRound& clipRound) {
+    if (_cachedContextDepth > 0) {
+        return;
+    }
+
     _tempRect.right = clipRound.width;
     _tempRect.bottom = clipRound.height;
 
@@ -69,10 +124,18 @@ void DrawDisplayListVisitor::visit(const Operations::ClipRound& clipRound) {
 void DrawDisplayListVisitor::visit(const Operations::DrawExternalSurface& /*drawExternalSurface*/) {}
 
 void DrawDisplayListVisitor::visit(const Operations::PrepareMask& prepareMask) {
+    if (_cachedContextDepth > 0) {
+        return;
+    }
+
     prepareMask.mask->prepare(_canvas);
 }
 
 void DrawDisplayListVisitor::visit(const Operations::ApplyMask& applyMask) {
+    if (_cachedContextDepth > 0) {
+        return;
+    }
+
     applyMask.mask->apply(_canvas);
 }
 
@@ -13,12 +13,16 @@ class SkCanvas;
 
 namespace snap::drawing {
 
+class RasterTileCache;
+
 /**
- DisplayList visitor which draws into a canvas
+ DisplayList visitor which draws into a canvas.
+ If a RasterTileCache is provided, the operations of the contexts that cache raster tiles
+ are drawn through the cache instead of being replayed directly into the canvas.
  */
 class DrawDisplayListVisitor {
 public:
-    DrawDisplayListVisitor(SkCanvas* canvas, Scalar scaleX, Scalar scaleY);
+    DrawDisplayListVisitor(SkCanvas* canvas, Scalar scaleX, Scalar scaleY, RasterTileCache* rasterTileCache = nullptr);
 
     void visit(const Operations::PushContext& pushContext);
 
@@ -41,6 +45,11 @@ private:
     Scalar _scaleX;
     Scalar _scaleY;
     Rect _tempRect;
+    RasterTileCache* _rasterTileCache;
+    const Operations::PushContext* _cachedContext = nullptr;
+    size_t _cachedContextDepth = 0;
+
+    void drawCachedContext(const Operations::PopContext& popContext);
 };
 
 } // namespace snap::drawing
@@ -19,6 +19,26 @@ DrawLooperEntry::DrawLooperEntry(const Ref<LayerRoot>& layerRoot,
 
 DrawLooperEntry::~DrawLooperEntry() = default;
 
+/**
+ Whether the surface of the presenter already holds the content of its plane in the given
+ DisplayList, in which case drawing the plane again would produce the same pixels.
+ */
+static bool presenterHasDrawnContent(const SurfacePresenter& surfacePresenter, const DisplayList& displayList) {
+    const auto& lastDrawnDisplayList = surfacePresenter.getLastDrawnDisplayList();
+    if (lastDrawnDisplayList == nullptr || !surfacePresenter.getLastDrawnFrameTime().has_value() ||
+        surfacePresenter.needsSynchronousDraw()) {
+        return false;
+    }
+
+    auto planeIndex = surfacePresenter.getDisplayListPlaneIndex();
+    auto lastDrawnPlaneIndex = surfacePresenter.getLastDrawnDisplayListPlaneIndex();
+    if (planeIndex >= displayList.getPlanesCount() || lastDrawnPlaneIndex >= lastDrawnDisplayList->getPlanesCount()) {
+        return false;
+    }
+
+    return displayList.hasSamePlaneContent(planeIndex, *lastDrawnDisplayList, lastDrawnPlaneIndex);
+}
+
 DrawLooperEntryDrawState DrawLooperEntry::getDrawState() const {
     DrawLooperEntryDrawState drawState;
     if (_displayList == nullptr) {
@@ -28,7 +48,8 @@ DrawLooperEntryDrawState DrawLooperEntry::getDrawState() const {
     auto frameTime = _displayList->getFrameTime();
 
     for (const auto& surfacePresenter : _surfacePresenters) {
-        if (surfacePresenter.needsDrawForFrameTime(frameTime)) {
+        if (surfacePresenter.needsDrawForFrameTime(frameTime) &&
+            !presenterHasDrawnContent(surfacePresenter, *_displayList)) {
             drawState.needsDraw = true;
             if (surfacePresenter.needsSynchronousDraw()) {
                 drawState.prefersSynchronousDraw = true;
@@ -56,7 +77,14 @@ Ref<DrawOperation> DrawLooperEntry::makeDrawOperation(bool shouldSwapToNextFrame
             auto frameTime = _displayList->getFrameTime();
             for (auto& presenter : _surfacePresenters) {
                 if (presenter.needsDrawForFrameTime(frameTime)) {
+                    if (presenterHasDrawnContent(presenter, *_displayList)) {
+                        // The plane did not change since it was last drawn, the surface can be left as is
+                        presenter.setLastDrawnFrameTime({frameTime});
+                        continue;
+                    }
+
                     presenter.setLastDrawnFrameTime({frameTime});
+                    presenter.setLastDrawnDisplayList(_displayList, presenter.getDisplayListPlaneIndex());
                     presenter.setNeedsSynchronousDraw(false);
 
                     auto& presenterToDraw = surfacePresenters.append(presenter.getId());
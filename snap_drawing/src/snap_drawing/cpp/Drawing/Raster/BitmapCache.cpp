@@ -1,20 +1,30 @@
 #include "BitmapCache.hpp"
 #include "valdi_core/cpp/Interfaces/IBitmapFactory.hpp"
 
+#include <algorithm>
+
 namespace snap::drawing {
 
+// Size classes are never finer than this, in pixels
+constexpr int kMinSizeClassGranularity = 16;
+// Number of size classes between two powers of two
+constexpr int kSizeClassesPerPowerOfTwo = 16;
+
+static uint64_t makeBucketKey(int width, int height) {
+    return (static_cast<uint64_t>(static_cast<uint32_t>(width)) << 32) |
+           static_cast<uint64_t>(static_cast<uint32_t>(height));
+}
+
 BitmapCache::Entry::Entry(const Ref<Valdi::IBitmapFactory>& bitmapFactory,
                           const Ref<Valdi::IBitmap>& bitmap,
-                          int width,
-                          int height)
-    : _bitmapFactory(bitmapFactory), _bitmap(bitmap), _width(width), _height(height) {}
+                          uint64_t bucketKey,
+                          size_t bytesLength)
+    : _bitmapFactory(bitmapFactory), _bitmap(bitmap), _bucketKey(bucketKey), _bytesLength(bytesLength) {}
 
 BitmapCache::Entry::~Entry() = default;
 
-bool BitmapCache::Entry::isCompatibleWith(const Ref<Valdi::IBitmapFactory>& bitmapFactory,
-                                          int width,
-                                          int height) const {
-    return _bitmapFactory == bitmapFactory && _width == width && _height == height;
+bool BitmapCache::Entry::isCompatibleWith(const Ref<Valdi::IBitmapFactory>& bitmapFactory) const {
+    return _bitmapFactory == bitmapFactory;
 }
 
 bool BitmapCache::Entry::isUsed() const {
@@ -25,30 +35,156 @@ const Ref<Valdi::IBitmap>& BitmapCache::Entry::getBitmap() const {
     return _bitmap;
 }
 
-BitmapCache::BitmapCache() = default;
+uint64_t BitmapCache::Entry::getBucketKey() const {
+    return _bucketKey;
+}
+
+size_t BitmapCache::Entry::getBytesLength() const {
+    return _bytesLength;
+}
+
+BitmapCache::BitmapCache() : BitmapCache(kDefaultMaxBytes) {}
+BitmapCache::BitmapCache(size_t maxBytes) : _maxBytes(maxBytes) {}
 BitmapCache::~BitmapCache() = default;
 
+int BitmapCache::getSizeClass(int dimension) {
+    if (dimension <= kMinSizeClassGranularity) {
+        return dimension <= 0 ? dimension : kMinSizeClassGranularity;
+    }
+
+    int powerOfTwo = 1;
+    while (powerOfTwo < dimension && powerOfTwo < (1 << 30)) {
+        powerOfTwo <<= 1;
+    }
+
+    auto granularity = std::max(kMinSizeClassGranularity, powerOfTwo / kSizeClassesPerPowerOfTwo);
+    return ((dimension + granularity - 1) / granularity) * granularity;
+}
+
 Valdi::Result<Ref<Valdi::IBitmap>> BitmapCache::allocateBitmap(const Ref<Valdi::IBitmapFactory>& bitmapFactory,
                                                                int width,
                                                                int height) {
-    for (const auto& entry : _entries) {
-        if (!entry.isUsed() && entry.isCompatibleWith(bitmapFactory, width, height)) {
-            return entry.getBitmap();
+    auto classWidth = getSizeClass(width);
+    auto classHeight = getSizeClass(height);
+
+    // Look in the size class of the request first, then in the ones immediately above it
+    auto nextClassWidth = getSizeClass(classWidth + 1);
+    auto nextClassHeight = getSizeClass(classHeight + 1);
+    const uint64_t candidateKeys[] = {
+        makeBucketKey(classWidth, classHeight),
+        makeBucketKey(nextClassWidth, classHeight),
+        makeBucketKey(classWidth, nextClassHeight),
+        makeBucketKey(nextClassWidth, nextClassHeight),
+    };
+
+    for (auto candidateKey : candidateKeys) {
+        auto bitmap = findUnusedBitmap(candidateKey, bitmapFactory);
+        if (bitmap != nullptr) {
+            return bitmap;
         }
     }
 
+    return createBitmap(bitmapFactory, classWidth, classHeight);
+}
+
+Valdi::Result<Ref<Valdi::IBitmap>> BitmapCache::allocateExactBitmap(const Ref<Valdi::IBitmapFactory>& bitmapFactory,
+                                                                    int width,
+                                                                    int height) {
+    auto bitmap = findUnusedBitmap(makeBucketKey(width, height), bitmapFactory);
+    if (bitmap != nullptr) {
+        return bitmap;
+    }
+
+    return createBitmap(bitmapFactory, width, height);
+}
+
+Ref<Valdi::IBitmap> BitmapCache::findUnusedBitmap(uint64_t bucketKey,
+                                                  const Ref<Valdi::IBitmapFactory>& bitmapFactory) {
+    const auto& it = _buckets.find(bucketKey);
+    if (it == _buckets.end()) {
+        return nullptr;
+    }
+
+    for (auto entryIt : it->second) {
+        if (!entryIt->isUsed() && entryIt->isCompatibleWith(bitmapFactory)) {
+            // Move the entry to the most recently used end of the list
+            _entries.splice(_entries.end(), _entries, entryIt);
+            _stats.hits++;
+            return entryIt->getBitmap();
+        }
+    }
+
+    return nullptr;
+}
+
+Valdi::Result<Ref<Valdi::IBitmap>> BitmapCache::createBitmap(const Ref<Valdi::IBitmapFactory>& bitmapFactory,
+                                                             int width,
+                                                             int height) {
+    _stats.misses++;
+
     auto bitmap = bitmapFactory->createBitmap(width, height);
     if (!bitmap) {
         return bitmap;
     }
 
-    _entries.emplace_back(bitmapFactory, bitmap.value(), width, height);
+    auto bucketKey = makeBucketKey(width, height);
+    auto bytesLength = bitmap.value()->getInfo().bytesLength();
+    auto entryIt = _entries.emplace(_entries.end(), bitmapFactory, bitmap.value(), bucketKey, bytesLength);
+    _buckets[bucketKey].emplace_back(entryIt);
+
+    _stats.bitmapsCount++;
+    _stats.bytesUsed += bytesLength;
+
+    evictIfNeeded();
 
     return bitmap;
 }
 
+BitmapCache::EntryList::iterator BitmapCache::removeEntry(EntryList::iterator it) {
+    const auto& bucketIt = _buckets.find(it->getBucketKey());
+    auto& bucket = bucketIt->second;
+    bucket.erase(std::find(bucket.begin(), bucket.end(), it));
+    if (bucket.empty()) {
+        _buckets.erase(bucketIt);
+    }
+
+    _stats.bitmapsCount--;
+    _stats.bytesUsed -= it->getBytesLength();
+
+    return _entries.erase(it);
+}
+
 void BitmapCache::clearUnused() {
-    _entries.erase(std::remove_if(_entries.begin(), _entries.end(), [](const auto& entry) { return !entry.isUsed(); }),
-                   _entries.end());
+    auto it = _entries.begin();
+    while (it != _entries.end()) {
+        if (it->isUsed()) {
+            it++;
+        } else {
+            it = removeEntry(it);
+        }
+    }
+}
+
+void BitmapCache::setMaxBytes(size_t maxBytes) {
+    _maxBytes = maxBytes;
+    evictIfNeeded();
+}
+
+BitmapCacheStats BitmapCache::getStats() const {
+    return _stats;
+}
+
+void BitmapCache::evictIfNeeded() {
+    auto it = _entries.begin();
+    while (_stats.bytesUsed > _maxBytes && it != _entries.end()) {
+        // Bitmaps that are in-use cannot be evicted
+        if (it->isUsed()) {
+            it++;
+        } else {
+            it = removeEntry(it);
+            _stats.evictions++;
+        }
+    }
 }
-} // namespace snap::drawing
\ No newline at end of file
+
+} // namespace snap::drawing
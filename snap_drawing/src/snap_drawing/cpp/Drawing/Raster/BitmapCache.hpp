@@ -3,7 +3,9 @@
 #include "snap_drawing/cpp/Utils/Aliases.hpp"
 #include "valdi_core/cpp/Interfaces/IBitmap.hpp"
 #include "valdi_core/cpp/Interfaces/IBitmapFactory.hpp"
+#include "valdi_core/cpp/Utils/FlatMap.hpp"
 #include "valdi_core/cpp/Utils/Result.hpp"
+#include <list>
 #include <vector>
 
 namespace Valdi {
@@ -12,43 +14,97 @@ class IBitmapFactory;
 
 namespace snap::drawing {
 
+struct BitmapCacheStats {
+    size_t hits = 0;
+    size_t misses = 0;
+    size_t evictions = 0;
+    size_t bitmapsCount = 0;
+    size_t bytesUsed = 0;
+};
+
 /**
 BitmapCache helps with creating bitmaps and re-using them when they are not already in-use.
+Bitmaps are grouped by bitmap factory and size class, where the size class of a dimension is
+the dimension rounded up to a granularity that grows with the dimension. Bitmaps returned by
+allocateBitmap() are created with the dimensions of their size class, which means that they
+can be slightly larger than requested: callers should draw into its top-left width x height
+sub-rect. This lets bitmaps be re-used when the requested sizes change slightly, for instance
+during an animation. Callers which cannot draw into a sub-rect should use allocateExactBitmap().
+Bitmaps that are not in-use are evicted least recently used first once the cached bitmaps
+exceed the byte budget.
  */
 class BitmapCache {
 public:
+    static constexpr size_t kDefaultMaxBytes = 64 * 1024 * 1024;
+
     BitmapCache();
+    explicit BitmapCache(size_t maxBytes);
     ~BitmapCache();
 
     Valdi::Result<Ref<Valdi::IBitmap>> allocateBitmap(const Ref<Valdi::IBitmapFactory>& bitmapFactory,
                                                       int width,
                                                       int height);
 
+    /**
+     Returns a bitmap with exactly the requested dimensions.
+     */
+    Valdi::Result<Ref<Valdi::IBitmap>> allocateExactBitmap(const Ref<Valdi::IBitmapFactory>& bitmapFactory,
+                                                           int width,
+                                                           int height);
+
     void clearUnused();
 
+    void setMaxBytes(size_t maxBytes);
+
+    BitmapCacheStats getStats() const;
+
+    /**
+     Returns the dimension with which a bitmap would be created for the given requested dimension.
+     */
+    static int getSizeClass(int dimension);
+
 private:
     class Entry {
     public:
         Entry(const Ref<Valdi::IBitmapFactory>& bitmapFactory,
               const Ref<Valdi::IBitmap>& bitmap,
-              int width,
-              int height);
+              uint64_t bucketKey,
+              size_t bytesLength);
         ~Entry();
 
-        bool isCompatibleWith(const Ref<Valdi::IBitmapFactory>& bitmapFactory, int width, int height) const;
+        bool isCompatibleWith(const Ref<Valdi::IBitmapFactory>& bitmapFactory) const;
 
         bool isUsed() const;
 
         const Ref<Valdi::IBitmap>& getBitmap() const;
 
+        uint64_t getBucketKey() const;
+
+        size_t getBytesLength() const;
+
     private:
         Ref<Valdi::IBitmapFactory> _bitmapFactory;
         Ref<Valdi::IBitmap> _bitmap;
-        int _width;
-        int _height;
+        uint64_t _bucketKey;
+        size_t _bytesLength;
     };
 
-    std::vector<Entry> _entries;
+    using EntryList = std::list<Entry>;
+
+    // Entries ordered from the least recently used to the most recently used
+    EntryList _entries;
+    // Entries keyed by their dimensions
+    Valdi::FlatMap<uint64_t, std::vector<EntryList::iterator>> _buckets;
+    BitmapCacheStats _stats;
+    size_t _maxBytes;
+
+    Ref<Valdi::IBitmap> findUnusedBitmap(uint64_t bucketKey, const Ref<Valdi::IBitmapFactory>& bitmapFactory);
+    Valdi::Result<Ref<Valdi::IBitmap>> createBitmap(const Ref<Valdi::IBitmapFactory>& bitmapFactory,
+                                                    int width,
+                                                    int height);
+    EntryList::iterator removeEntry(EntryList::iterator it);
+
+    void evictIfNeeded();
 };
 
-} // namespace snap::drawing
\ No newline at end of file
+} // namespace snap::drawing
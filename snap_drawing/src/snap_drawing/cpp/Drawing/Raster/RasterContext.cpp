@@ -13,11 +13,16 @@
 #include "valdi_core/cpp/Interfaces/IBitmap.hpp"
 #include "valdi_core/cpp/Interfaces/IBitmapFactory.hpp"
 #include "valdi_core/cpp/Interfaces/ILogger.hpp"
+#include "valdi_core/cpp/Threading/WorkStealingExecutor.hpp"
+#include "valdi_core/cpp/Utils/Defer.hpp"
+#include "valdi_core/cpp/Utils/Mutex.hpp"
 #include "valdi_core/cpp/Utils/Trace.hpp"
 #include <algorithm>
+#include <atomic>
 #include <cmath>
 #include <cstddef>
 #include <cstdint>
+#include <optional>
 
 // These come from Skia SkBlitRow.h .
 // We use them for blending rows. They are highly optimized under the hood,
@@ -41,6 +46,122 @@ struct RasterContext::CompositionResult {
     Ref<DisplayList> displayList;
 };
 
+// Tiles smaller than this are not worth the cost of dispatching them to another thread.
+static constexpr int64_t kMinParallelRasterTileArea = 128 * 128;
+// Regions are split into horizontal bands which are at least this tall.
+static constexpr int kMinParallelRasterTileHeight = 16;
+
+/**
+ Splits the given regions into disjoint pixel aligned tiles that can be rasterized concurrently
+ into the same bitmap. Returns an empty list when the regions should be rasterized sequentially:
+ when the plane list references external surfaces, when the regions overlap once rounded to
+ whole pixels, or when there is not enough work to be split.
+ */
+static std::vector<Rect> computeParallelRasterTiles(const CompositorPlaneList& planeList,
+                                                    const Valdi::BitmapInfo& bitmapInfo,
+                                                    const std::vector<Rect>& regions,
+                                                    size_t maxTilesCount) {
+    for (const auto& plane : planeList) {
+        if (plane.getType() != CompositorPlaneTypeDrawable) {
+            // External surfaces are rasterized through caches that are shared between tiles
+            return {};
+        }
+    }
+
+    auto bounds =
+        Rect::makeXYWH(0, 0, static_cast<Scalar>(bitmapInfo.width), static_cast<Scalar>(bitmapInfo.height));
+
+    std::vector<Rect> pixelRegions;
+    int64_t totalArea = 0;
+    for (const auto& region : regions) {
+        auto pixelRegion = Rect::makeLTRB(std::floor(region.left),
+                                          std::floor(region.top),
+                                          std::ceil(region.right),
+                                          std::ceil(region.bottom))
+                               .intersection(bounds);
+        if (pixelRegion.isEmpty()) {
+            continue;
+        }
+
+        for (const auto& otherRegion : pixelRegions) {
+            if (otherRegion.intersects(pixelRegion)) {
+                return {};
+            }
+        }
+
+        totalArea += static_cast<int64_t>(pixelRegion.width()) * static_cast<int64_t>(pixelRegion.height());
+        pixelRegions.emplace_back(pixelRegion);
+    }
+
+    if (maxTilesCount < 2 || totalArea < 2 * kMinParallelRasterTileArea) {
+        return {};
+    }
+
+    auto tileArea = std::max(totalArea / static_cast<int64_t>(maxTilesCount), kMinParallelRasterTileArea);
+
+    std::vector<Rect> tiles;
+    for (const auto& region : pixelRegions) {
+        auto regionHeight = static_cast<int64_t>(region.height());
+        auto regionArea = static_cast<int64_t>(region.width()) * regionHeight;
+        auto maxBandsCount = std::max(regionHeight / kMinParallelRasterTileHeight, static_cast<int64_t>(1));
+        auto bandsCount = std::clamp(regionArea / tileArea, static_cast<int64_t>(1), maxBandsCount);
+        auto bandHeight = static_cast<Scalar>((regionHeight + bandsCount - 1) / bandsCount);
+
+        for (auto top = region.top; top < region.bottom; top += bandHeight) {
+            tiles.emplace_back(
+                Rect::makeLTRB(region.left, top, region.right, std::min(top + bandHeight, region.bottom)));
+        }
+    }
+
+    if (tiles.size() < 2) {
+        return {};
+    }
+
+    return tiles;
+}
+
+/**
+ Tracks the tiles of a parallel raster pass. Tiles are claimed by the workers and by the thread
+ which started the pass, so that the pass makes progress even when the executor is busy.
+ */
+struct ParallelRasterPass : public Valdi::SimpleRefCountable {
+    Valdi::Function<Valdi::Result<Valdi::Void>(const Rect&)> rasterTile;
+    std::vector<Rect> tiles;
+    std::atomic<size_t> nextTileIndex = 0;
+    Valdi::Mutex mutex;
+    Valdi::ConditionVariable condition;
+    size_t completedTilesCount = 0;
+    std::optional<Valdi::Error> error;
+
+    void run() {
+        for (;;) {
+            auto tileIndex = nextTileIndex.fetch_add(1);
+            if (tileIndex >= tiles.size()) {
+                return;
+            }
+
+            VALDI_TRACE("SnapDrawing.rasterContext.rasterTile");
+            auto result = rasterTile(tiles[tileIndex]);
+
+            std::lock_guard<Valdi::Mutex> lock(mutex);
+            if (!result && !error) {
+                error = result.moveError();
+            }
+            completedTilesCount++;
+            if (completedTilesCount == tiles.size()) {
+                condition.notifyAll();
+            }
+        }
+    }
+
+    void wait() {
+        std::unique_lock<Valdi::Mutex> lock(mutex);
+        while (completedTilesCount != tiles.size()) {
+            condition.wait(lock);
+        }
+    }
+};
+
 RasterContext::RasterContext(Valdi::ILogger& logger,
                              ExternalSurfaceRasterizationMethod externalSurfaceRasterizationMethod,
                              bool enableDeltaRasterization)
@@ -49,6 +170,29 @@ RasterContext::RasterContext(Valdi::ILogger& logger,
       _deltaRasterizationEnabled(enableDeltaRasterization) {}
 RasterContext::~RasterContext() = default;
 
+void RasterContext::setParallelRasterExecutor(const Ref<Valdi::WorkStealingExecutor>& executor) {
+    std::lock_guard<std::recursive_mutex> lock(_mutex);
+    _parallelRasterExecutor = executor;
+}
+
+Ref<Valdi::WorkStealingExecutor> RasterContext::getParallelRasterExecutor() const {
+    std::lock_guard<std::recursive_mutex> lock(_mutex);
+    return _parallelRasterExecutor;
+}
+
+void RasterContext::setRasterTileCacheEnabled(bool rasterTileCacheEnabled) {
+    _rasterTileCacheEnabled = rasterTileCacheEnabled;
+}
+
+RasterTileCacheStats RasterContext::getRasterTileCacheStats() const {
+    return _rasterTileCache.getStats();
+}
+
+BitmapCacheStats RasterContext::getBitmapCacheStats() const {
+    std::lock_guard<std::recursive_mutex> lock(_mutex);
+    return _bitmapCache.getStats();
+}
+
 RasterContext::CompositionResult RasterContext::performCompositionIfNeeded(const Ref<DisplayList>& displayList) const {
     CompositionResult result;
 
@@ -242,6 +386,42 @@ Valdi::Result<RasterContext::RasterResult> RasterContext::doRasterDelta(const Co
                                                                         const Valdi::BitmapInfo& bitmapInfo,
                                                                         const std::vector<Rect>& damageRects,
                                                                         size_t rasterId) {
+    RasterResult output;
+    output.renderedPixelsCount = 0;
+
+    for (const auto& damageRect : damageRects) {
+        output.renderedPixelsCount +=
+            static_cast<size_t>(damageRect.width()) * static_cast<size_t>(damageRect.height());
+    }
+
+    if (damageRects.empty()) {
+        return output;
+    }
+
+    _rasterTileCache.beginPass();
+    Valdi::Defer endRasterTilePass([&]() { _rasterTileCache.endPass(); });
+
+    auto executor = getParallelRasterExecutor();
+    if (executor != nullptr) {
+        auto tiles = computeParallelRasterTiles(
+            compositionResult.planeList, bitmapInfo, damageRects, executor->getWorkersCount() + 1);
+        if (!tiles.empty()) {
+            auto result = rasterTilesInParallel(*executor,
+                                                bitmap,
+                                                *compositionResult.displayList,
+                                                compositionResult.planeList,
+                                                bitmapInfo,
+                                                tiles,
+                                                true,
+                                                rasterId);
+            if (!result) {
+                return result.moveError();
+            }
+
+            return output;
+        }
+    }
+
     BitmapGraphicsContext graphicsContext;
     auto surface = graphicsContext.createBitmapSurface(bitmap);
 
@@ -250,9 +430,6 @@ Valdi::Result<RasterContext::RasterResult> RasterContext::doRasterDelta(const Co
         return canvas.moveError();
     }
 
-    RasterResult output;
-    output.renderedPixelsCount = 0;
-
     for (const auto& damageRect : damageRects) {
         VALDI_TRACE("SnapDrawing.rasterContext.rasterDeltaInRect");
         auto* skiaCanvas = canvas.value().getSkiaCanvas();
@@ -267,9 +444,6 @@ Valdi::Result<RasterContext::RasterResult> RasterContext::doRasterDelta(const Co
         if (!doRasterResult) {
             return doRasterResult.moveError();
         }
-
-        output.renderedPixelsCount +=
-            static_cast<size_t>(damageRect.width()) * static_cast<size_t>(damageRect.height());
     }
 
     surface->flush();
@@ -284,6 +458,22 @@ Valdi::Result<Valdi::Void> RasterContext::rasterNonDelta(const Ref<Valdi::IBitma
                                                          bool shouldClearBitmapBeforeDrawing,
                                                          size_t rasterId) {
     VALDI_TRACE("SnapDrawing.rasterContext.rasterNonDelta");
+    _rasterTileCache.beginPass();
+    Valdi::Defer endRasterTilePass([&]() { _rasterTileCache.endPass(); });
+
+    auto executor = getParallelRasterExecutor();
+    if (executor != nullptr) {
+        auto tiles = computeParallelRasterTiles(
+            planeList,
+            bitmapInfo,
+            {Rect::makeXYWH(0, 0, static_cast<Scalar>(bitmapInfo.width), static_cast<Scalar>(bitmapInfo.height))},
+            executor->getWorkersCount() + 1);
+        if (!tiles.empty()) {
+            return rasterTilesInParallel(
+                *executor, bitmap, displayList, planeList, bitmapInfo, tiles, shouldClearBitmapBeforeDrawing, rasterId);
+        }
+    }
+
     BitmapGraphicsContext graphicsContext;
     auto surface = graphicsContext.createBitmapSurface(bitmap);
 
@@ -300,6 +490,59 @@ Valdi::Result<Valdi::Void> RasterContext::rasterNonDelta(const Ref<Valdi::IBitma
     return doRasterResult;
 }
 
+Valdi::Result<Valdi::Void> RasterContext::rasterTilesInParallel(Valdi::WorkStealingExecutor& executor,
+                                                                const Ref<Valdi::IBitmap>& bitmap,
+                                                                const DisplayList& displayList,
+                                                                const CompositorPlaneList& planeList,
+                                                                const Valdi::BitmapInfo& bitmapInfo,
+                                                                const std::vector<Rect>& tiles,
+                                                                bool shouldClearBitmapBeforeDrawing,
+                                                                size_t rasterId) {
+    VALDI_TRACE("SnapDrawing.rasterContext.rasterTilesInParallel");
+    auto* bytes = bitmap->lockBytes();
+    if (bytes == nullptr) {
+        return Valdi::Error("Failed to lock bytes");
+    }
+
+    auto pass = Valdi::makeShared<ParallelRasterPass>();
+    pass->tiles = tiles;
+    // The captured references are only used while the pass has unclaimed tiles,
+    // which is before wait() returns.
+    pass->rasterTile = [&](const Rect& tile) -> Valdi::Result<Valdi::Void> {
+        // Every tile draws into the same pixels through its own surface, the clips
+        // guarantee that the tiles never write to the same pixels.
+        BitmapGraphicsContext graphicsContext;
+        auto surface = graphicsContext.createBitmapSurface(bitmapInfo, bytes);
+        auto canvas = surface->prepareCanvas();
+        if (!canvas) {
+            return canvas.moveError();
+        }
+
+        canvas.value().getSkiaCanvas()->clipRect(tile.getSkValue());
+        auto result =
+            doRaster(canvas.value(), displayList, planeList, bitmapInfo, shouldClearBitmapBeforeDrawing, rasterId);
+        surface->flush();
+
+        return result;
+    };
+
+    auto workersCount = std::min(executor.getWorkersCount(), tiles.size() - 1);
+    for (size_t i = 0; i < workersCount; i++) {
+        executor.submit([pass]() { pass->run(); }, Valdi::ThreadQoSClassHigh);
+    }
+
+    pass->run();
+    pass->wait();
+
+    bitmap->unlockBytes();
+
+    if (pass->error) {
+        return std::move(pass->error.value());
+    }
+
+    return Valdi::Void();
+}
+
 // Bound on how large an external surface may be rasterized, as a per-axis multiple of the output for
 // a square surface -- the actual bound is this value squared times the output's pixel count.
 //
@@ -349,7 +592,8 @@ Valdi::Result<Valdi::Void> RasterContext::doRaster(DrawableSurfaceCanvas& canvas
     for (const auto& plane : planeList) {
         switch (plane.getType()) {
             case CompositorPlaneTypeDrawable:
-                displayList.draw(canvas, drawablePlaneIndex, false);
+                displayList.draw(
+                    canvas, drawablePlaneIndex, false, _rasterTileCacheEnabled ? &_rasterTileCache : nullptr);
                 drawablePlaneIndex++;
                 break;
             case CompositorPlaneTypeExternal: {
@@ -455,7 +699,8 @@ Valdi::Result<Ref<Image>> RasterContext::getOrCreateRasterImageForExternalSurfac
         return Valdi::Error("Cannot rasterize external surface without a bitmap factory");
     }
 
-    auto bitmap = _bitmapCache.allocateBitmap(bitmapFactory, bitmapWidth, bitmapHeight);
+    // Platform views rasterize into the whole bitmap, it must have the exact requested dimensions
+    auto bitmap = _bitmapCache.allocateExactBitmap(bitmapFactory, bitmapWidth, bitmapHeight);
     if (!bitmap) {
         return bitmap.moveError();
     }
@@ -2,9 +2,11 @@
 
 #include "snap_drawing/cpp/Drawing/Raster/BitmapCache.hpp"
 #include "snap_drawing/cpp/Drawing/Raster/RasterDamageResolver.hpp"
+#include "snap_drawing/cpp/Drawing/Raster/RasterTileCache.hpp"
 #include "snap_drawing/cpp/Drawing/Surface/ExternalSurfacePresenterState.hpp"
 #include "snap_drawing/cpp/Utils/Aliases.hpp"
 #include "valdi_core/cpp/Utils/Result.hpp"
+#include <atomic>
 #include <mutex>
 #include <vector>
 
@@ -13,6 +15,7 @@ namespace Valdi {
 class IBitmap;
 class IBitmapFactory;
 class ILogger;
+class WorkStealingExecutor;
 struct BitmapInfo;
 } // namespace Valdi
 
@@ -53,6 +56,13 @@ avoid re-rasterizing external surfaces for each frame if they don't change.
 
 If "enableDeltaRasterization" is true, all the raster operations will be delta rasterized, with the
 RasterContext keeping a bitmap cache of the last raster pass.
+
+If the raster tile cache is enabled, the content of the layers that cache raster tiles, like the
+content of scroll layers, is retained into tiles which are re-used when the content moves.
+
+If a parallel raster executor is set, the regions to raster are split into disjoint pixel aligned
+tiles which are rasterized concurrently into the bitmap, each tile replaying the display list with
+its own clip.
  */
 class RasterContext : public Valdi::SimpleRefCountable {
 public:
@@ -75,6 +85,26 @@ public:
      */
     Valdi::Result<RasterResult> rasterDelta(const Ref<DisplayList>& displayList, const Ref<Valdi::IBitmap>& bitmap);
 
+    /**
+    Set the executor on which tiles of the bitmap will be rasterized in parallel. Only display lists
+    without external surface planes are rasterized in parallel, the other ones fall back to a sequential
+    raster on the calling thread. Passing null disables parallel rasterization, which is the default.
+     */
+    void setParallelRasterExecutor(const Ref<Valdi::WorkStealingExecutor>& executor);
+
+    /**
+    Enable or disable the RasterTileCache, which retains the rasterized content of the layers
+    that cache raster tiles across raster passes. Disabled by default.
+     */
+    void setRasterTileCacheEnabled(bool rasterTileCacheEnabled);
+
+    RasterTileCacheStats getRasterTileCacheStats() const;
+
+    /**
+    Returns the statistics of the cache holding the bitmaps into which external surfaces are rasterized.
+     */
+    BitmapCacheStats getBitmapCacheStats() const;
+
 private:
     struct CachedRasterizedExternalSurface {
         Ref<Image> image;
@@ -97,6 +127,9 @@ private:
     Ref<Valdi::IBitmap> _lastBitmap;
     RasterDamageResolver _rasterDamageResolver;
     bool _deltaRasterizationEnabled;
+    Ref<Valdi::WorkStealingExecutor> _parallelRasterExecutor;
+    RasterTileCache _rasterTileCache;
+    std::atomic_bool _rasterTileCacheEnabled = false;
 
     CompositionResult performCompositionIfNeeded(const Ref<DisplayList>& displayList) const;
 
@@ -120,6 +153,17 @@ private:
                                               bool shouldClearBitmapBeforeDrawing,
                                               size_t rasterId);
 
+    Valdi::Result<Valdi::Void> rasterTilesInParallel(Valdi::WorkStealingExecutor& executor,
+                                                     const Ref<Valdi::IBitmap>& bitmap,
+                                                     const DisplayList& displayList,
+                                                     const CompositorPlaneList& planeList,
+                                                     const Valdi::BitmapInfo& bitmapInfo,
+                                                     const std::vector<Rect>& tiles,
+                                                     bool shouldClearBitmapBeforeDrawing,
+                                                     size_t rasterId);
+
+    Ref<Valdi::WorkStealingExecutor> getParallelRasterExecutor() const;
+
     Valdi::Result<Ref<Image>> getOrCreateRasterImageForExternalSurfaceSnapshot(
         ExternalSurfaceSnapshot* externalSurfaceSnapshot,
         const Rect& frame,
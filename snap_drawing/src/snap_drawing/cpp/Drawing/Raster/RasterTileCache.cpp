@@ -0,0 +1,468 @@
+#include "snap_drawing/cpp/Drawing/Raster/RasterTileCache.hpp"
+#include "include/core/SkCanvas.h"
+#include "include/core/SkPicture.h"
+#include "snap_drawing/cpp/Drawing/DisplayList/DisplayList.hpp"
+#include "snap_drawing/cpp/Drawing/DisplayList/DrawDisplayListVisitor.hpp"
+#include "snap_drawing/cpp/Drawing/GraphicsContext/BitmapGraphicsContext.hpp"
+#include "snap_drawing/cpp/Utils/BitmapFactory.hpp"
+#include "snap_drawing/cpp/Utils/BitmapUtils.hpp"
+#include "snap_drawing/cpp/Utils/Image.hpp"
+#include "valdi_core/cpp/Utils/Trace.hpp"
+
+#include <boost/functional/hash.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace snap::drawing {
+
+/**
+ An operation of a context which draws something, with the bounds it can draw into
+ in the coordinate space of the context.
+ */
+struct RasterTileContentItem {
+    SkRect bounds;
+    size_t version;
+};
+
+/**
+ Collects the drawing operations of a context along with their bounds, so that the content
+ version of each tile only depends on the operations which can draw into it. The version of an
+ item combines the picture with the matrices, opacities and clips of the contexts it is nested
+ in. Pictures are identified by their unique id, so that re-recorded layers produce a new version.
+ */
+struct RasterTileContentVisitor {
+    struct State {
+        SkMatrix matrix;
+        SkRect clipBounds;
+        size_t version;
+    };
+
+    std::vector<RasterTileContentItem>& items;
+    std::vector<State> states;
+    bool cacheable = true;
+
+    explicit RasterTileContentVisitor(std::vector<RasterTileContentItem>& items) : items(items) {
+        states.emplace_back(State{SkMatrix::I(), SkRect::MakeLargest(), 0});
+    }
+
+    template<typename T>
+    static void combine(size_t& version, const T& value) {
+        boost::hash_combine(version, value);
+    }
+
+    static void combine(size_t& version, const Matrix& matrix) {
+        Scalar values[9];
+        matrix.getSkValue().get9(values);
+        for (auto value : values) {
+            combine(version, value);
+        }
+    }
+
+    void clip(const Operations::ClipOperation& clipOperation) {
+        auto& state = states.back();
+        auto clipBounds = state.matrix.mapRect(SkRect::MakeWH(clipOperation.width, clipOperation.height));
+        if (!state.clipBounds.intersect(clipBounds)) {
+            state.clipBounds.setEmpty();
+        }
+        combine(state.version, clipOperation.type);
+        combine(state.version, clipOperation.width);
+        combine(state.version, clipOperation.height);
+    }
+
+    void visit(const Operations::PushContext& pushContext) {
+        auto state = states.back();
+        state.matrix.preConcat(pushContext.matrix.getSkValue());
+        combine(state.version, pushContext.type);
+        combine(state.version, pushContext.matrix);
+        combine(state.version, pushContext.opacity);
+        combine(state.version, pushContext.layerId);
+        states.emplace_back(state);
+    }
+
+    void visit(const Operations::PopContext& /*popContext*/) {
+        if (states.size() > 1) {
+            states.pop_back();
+        }
+    }
+
+    void visit(const Operations::DrawPicture& drawPicture) {
+        const auto& state = states.back();
+        // Skia culls pictures by their cull rect as well, the outset accounts for anti-aliasing
+        auto bounds = state.matrix.mapRect(drawPicture.picture->cullRect()).makeOutset(1, 1);
+        if (!bounds.intersect(state.clipBounds)) {
+            return;
+        }
+
+        auto version = state.version;
+        combine(version, drawPicture.type);
+        combine(version, drawPicture.picture->uniqueID());
+        combine(version, drawPicture.opacity);
+        items.emplace_back(RasterTileContentItem{bounds, version});
+    }
+
+    void visit(const Operations::ClipRect& clipRect) {
+        clip(clipRect);
+    }
+
+    void visit(const Operations::ClipRound& clipRound) {
+        clip(clipRound);
+        auto& state = states.back();
+        combine(state.version, clipRound.borderRadius.topLeft());
+        combine(state.version, clipRound.borderRadius.topRight());
+        combine(state.version, clipRound.borderRadius.bottomRight());
+        combine(state.version, clipRound.borderRadius.bottomLeft());
+        combine(state.version, clipRound.borderRadius.topLeftIsPercent());
+        combine(state.version, clipRound.borderRadius.topRightIsPercent());
+        combine(state.version, clipRound.borderRadius.bottomRightIsPercent());
+        combine(state.version, clipRound.borderRadius.bottomLeftIsPercent());
+    }
+
+    void visit(const Operations::DrawExternalSurface& /*drawExternalSurface*/) {
+        // External surfaces are composited separately by the RasterContext
+        cacheable = false;
+    }
+
+    void visit(const Operations::PrepareMask& /*prepareMask*/) {
+        // Masks are re-created on every draw and cannot be versioned
+        cacheable = false;
+    }
+
+    void visit(const Operations::ApplyMask& /*applyMask*/) {
+        cacheable = false;
+    }
+};
+
+static uint64_t makeTileKey(int column, int row) {
+    return (static_cast<uint64_t>(static_cast<uint32_t>(column)) << 32) |
+           static_cast<uint64_t>(static_cast<uint32_t>(row));
+}
+
+static int tileIndexForPosition(int position) {
+    return static_cast<int>(std::floor(static_cast<double>(position) / RasterTileCache::kTileSize));
+}
+
+static size_t bytesPerTile() {
+    return static_cast<size_t>(RasterTileCache::kTileSize) * static_cast<size_t>(RasterTileCache::kTileSize) * 4;
+}
+
+RasterTileCache::RasterTileCache() : _bitmapCache(kDefaultMaxBytes) {}
+RasterTileCache::~RasterTileCache() = default;
+
+void RasterTileCache::setMaxBytes(size_t maxBytes) {
+    std::lock_guard<Valdi::Mutex> lock(_mutex);
+    _maxBytes = maxBytes;
+    _bitmapCache.setMaxBytes(maxBytes);
+}
+
+void RasterTileCache::beginPass() {
+    std::lock_guard<Valdi::Mutex> lock(_mutex);
+    _pass++;
+}
+
+void RasterTileCache::endPass() {
+    std::lock_guard<Valdi::Mutex> lock(_mutex);
+
+    auto removedEntries = false;
+    auto it = _entries.begin();
+    while (it != _entries.end()) {
+        if (it->second.lastUsedPass != _pass) {
+            clearEntry(it->second);
+            it = _entries.erase(it);
+            removedEntries = true;
+        } else {
+            it++;
+        }
+    }
+
+    evictTiles();
+
+    if (removedEntries) {
+        _bitmapCache.clearUnused();
+    }
+}
+
+bool RasterTileCache::Rasterization::operator==(const Rasterization& other) const {
+    return matrixScaleX == other.matrixScaleX && matrixScaleY == other.matrixScaleY &&
+           subpixelOffsetX == other.subpixelOffsetX && subpixelOffsetY == other.subpixelOffsetY &&
+           colorType == other.colorType;
+}
+
+bool RasterTileCache::Rasterization::operator!=(const Rasterization& other) const {
+    return !(*this == other);
+}
+
+bool RasterTileCache::draw(SkCanvas* canvas,
+                           uint64_t layerId,
+                           const Valdi::Byte* begin,
+                           const Valdi::Byte* end,
+                           Scalar displayListScaleX,
+                           Scalar displayListScaleY) {
+    const auto& matrix = canvas->getTotalMatrix();
+    if (!matrix.isScaleTranslate() || matrix.getScaleX() <= 0 || matrix.getScaleY() <= 0) {
+        return false;
+    }
+
+    Rasterization rasterization;
+    rasterization.colorType = toBitmapInfo(canvas->imageInfo()).colorType;
+    if (rasterization.colorType != Valdi::ColorType::ColorTypeRGBA8888 &&
+        rasterization.colorType != Valdi::ColorType::ColorTypeBGRA8888) {
+        return false;
+    }
+
+    std::vector<RasterTileContentItem> items;
+    RasterTileContentVisitor contentVisitor(items);
+    DisplayList::visitOperations(begin, end, contentVisitor);
+    if (!contentVisitor.cacheable) {
+        return false;
+    }
+
+    // Tiles are placed on whole pixels, the fractional part of the translation is rasterized into them
+    auto originX = static_cast<int>(std::floor(matrix.getTranslateX()));
+    auto originY = static_cast<int>(std::floor(matrix.getTranslateY()));
+    rasterization.matrixScaleX = matrix.getScaleX();
+    rasterization.matrixScaleY = matrix.getScaleY();
+    rasterization.subpixelOffsetX = matrix.getTranslateX() - static_cast<Scalar>(originX);
+    rasterization.subpixelOffsetY = matrix.getTranslateY() - static_cast<Scalar>(originY);
+
+    auto clipBounds = canvas->getDeviceClipBounds();
+    if (clipBounds.isEmpty()) {
+        std::lock_guard<Valdi::Mutex> lock(_mutex);
+        auto& entry = _entries[layerId];
+        if (entry.rasterization != rasterization) {
+            clearEntry(entry);
+            entry.rasterization = rasterization;
+        }
+        entry.lastUsedPass = _pass;
+        return true;
+    }
+
+    auto firstColumn = tileIndexForPosition(clipBounds.left() - originX);
+    auto lastColumn = tileIndexForPosition(clipBounds.right() - 1 - originX);
+    auto firstRow = tileIndexForPosition(clipBounds.top() - originY);
+    auto lastRow = tileIndexForPosition(clipBounds.bottom() - 1 - originY);
+    auto columnsCount = static_cast<size_t>(lastColumn - firstColumn + 1);
+    auto rowsCount = static_cast<size_t>(lastRow - firstRow + 1);
+
+    struct VisibleTile {
+        int column;
+        int row;
+        uint64_t contentVersion = 0;
+        Ref<Image> image;
+        Ref<Valdi::IBitmap> bitmap;
+    };
+    std::vector<VisibleTile> visibleTiles(columnsCount * rowsCount);
+    for (size_t i = 0; i < visibleTiles.size(); i++) {
+        visibleTiles[i].column = firstColumn + static_cast<int>(i % columnsCount);
+        visibleTiles[i].row = firstRow + static_cast<int>(i / columnsCount);
+    }
+
+    // Combine the version of each item into the visible tiles it covers
+    auto visibleRect = SkRect::MakeLTRB(static_cast<SkScalar>(firstColumn * kTileSize),
+                                        static_cast<SkScalar>(firstRow * kTileSize),
+                                        static_cast<SkScalar>((lastColumn + 1) * kTileSize),
+                                        static_cast<SkScalar>((lastRow + 1) * kTileSize));
+    for (const auto& item : items) {
+        auto itemRect = SkRect::MakeLTRB(item.bounds.left() * rasterization.matrixScaleX,
+                                         item.bounds.top() * rasterization.matrixScaleY,
+                                         item.bounds.right() * rasterization.matrixScaleX,
+                                         item.bounds.bottom() * rasterization.matrixScaleY)
+                            .makeOffset(rasterization.subpixelOffsetX, rasterization.subpixelOffsetY);
+        if (!itemRect.intersect(visibleRect)) {
+            continue;
+        }
+
+        auto bounds = itemRect.roundOut();
+        auto itemFirstColumn = std::max(firstColumn, tileIndexForPosition(bounds.left()));
+        auto itemLastColumn = std::min(lastColumn, tileIndexForPosition(bounds.right() - 1));
+        auto itemFirstRow = std::max(firstRow, tileIndexForPosition(bounds.top()));
+        auto itemLastRow = std::min(lastRow, tileIndexForPosition(bounds.bottom() - 1));
+
+        for (auto row = itemFirstRow; row <= itemLastRow; row++) {
+            for (auto column = itemFirstColumn; column <= itemLastColumn; column++) {
+                auto& visibleTile =
+                    visibleTiles[static_cast<size_t>(row - firstRow) * columnsCount +
+                                 static_cast<size_t>(column - firstColumn)];
+                size_t version = static_cast<size_t>(visibleTile.contentVersion);
+                boost::hash_combine(version, item.version);
+                visibleTile.contentVersion = static_cast<uint64_t>(version);
+            }
+        }
+    }
+
+    auto hasTilesToRaster = false;
+    {
+        std::lock_guard<Valdi::Mutex> lock(_mutex);
+
+        auto& entry = _entries[layerId];
+        if (entry.rasterization != rasterization) {
+            clearEntry(entry);
+            entry.rasterization = rasterization;
+        }
+        entry.lastUsedPass = _pass;
+
+        for (auto& visibleTile : visibleTiles) {
+            const auto& it = entry.tiles.find(makeTileKey(visibleTile.column, visibleTile.row));
+            if (it != entry.tiles.end() && it->second.contentVersion == visibleTile.contentVersion) {
+                if (it->second.lastUsedPass != _pass) {
+                    _stats.reusedTiles++;
+                }
+                it->second.lastUsedPass = _pass;
+                visibleTile.image = it->second.image;
+                continue;
+            }
+
+            // The bitmap is in use until the tile is released, it won't be handed out to another tile
+            auto bitmap = _bitmapCache.allocateBitmap(
+                BitmapFactory::getInstance(rasterization.colorType), kTileSize, kTileSize);
+            if (!bitmap) {
+                // Nothing was drawn yet, the caller can fall back to drawing directly
+                return false;
+            }
+            visibleTile.bitmap = bitmap.moveValue();
+            hasTilesToRaster = true;
+        }
+    }
+
+    if (hasTilesToRaster) {
+        // Rasterize outside of the lock, so that the other bands of a parallel raster are not blocked
+        for (auto& visibleTile : visibleTiles) {
+            if (visibleTile.bitmap == nullptr) {
+                continue;
+            }
+
+            auto image = rasterTile(rasterization,
+                                    visibleTile.bitmap,
+                                    visibleTile.column,
+                                    visibleTile.row,
+                                    begin,
+                                    end,
+                                    displayListScaleX,
+                                    displayListScaleY);
+            if (!image) {
+                return false;
+            }
+            visibleTile.image = image.moveValue();
+        }
+
+        std::lock_guard<Valdi::Mutex> lock(_mutex);
+        auto& entry = _entries[layerId];
+        // The entry might have been rasterized differently by another thread in the meantime
+        if (entry.rasterization == rasterization) {
+            entry.lastUsedPass = _pass;
+            for (const auto& visibleTile : visibleTiles) {
+                if (visibleTile.bitmap == nullptr) {
+                    continue;
+                }
+
+                auto& tile = entry.tiles[makeTileKey(visibleTile.column, visibleTile.row)];
+                if (tile.image == nullptr) {
+                    _tilesCount++;
+                }
+                tile.image = visibleTile.image;
+                tile.contentVersion = visibleTile.contentVersion;
+                tile.lastUsedPass = _pass;
+                _stats.rasterizedTiles++;
+            }
+        }
+    }
+
+    canvas->save();
+    canvas->resetMatrix();
+    for (const auto& visibleTile : visibleTiles) {
+        canvas->drawImage(visibleTile.image->getSkValue(),
+                          static_cast<SkScalar>(originX + visibleTile.column * kTileSize),
+                          static_cast<SkScalar>(originY + visibleTile.row * kTileSize));
+    }
+    canvas->restore();
+
+    return true;
+}
+
+Valdi::Result<Ref<Image>> RasterTileCache::rasterTile(const Rasterization& rasterization,
+                                                      const Ref<Valdi::IBitmap>& bitmap,
+                                                      int column,
+                                                      int row,
+                                                      const Valdi::Byte* begin,
+                                                      const Valdi::Byte* end,
+                                                      Scalar displayListScaleX,
+                                                      Scalar displayListScaleY) {
+    VALDI_TRACE("SnapDrawing.rasterTileCache.rasterTile");
+
+    BitmapGraphicsContext graphicsContext;
+    auto surface = graphicsContext.createBitmapSurface(bitmap);
+    auto canvas = surface->prepareCanvas();
+    if (!canvas) {
+        return canvas.moveError();
+    }
+
+    auto* skiaCanvas = canvas.value().getSkiaCanvas();
+    // Bitmaps are re-used from evicted tiles
+    skiaCanvas->clear(SK_ColorTRANSPARENT);
+    skiaCanvas->translate(static_cast<SkScalar>(-column * kTileSize) + rasterization.subpixelOffsetX,
+                          static_cast<SkScalar>(-row * kTileSize) + rasterization.subpixelOffsetY);
+    skiaCanvas->scale(rasterization.matrixScaleX, rasterization.matrixScaleY);
+
+    DrawDisplayListVisitor visitor(skiaCanvas, displayListScaleX, displayListScaleY);
+    DisplayList::visitOperations(begin, end, visitor);
+
+    surface->flush();
+
+    return Image::makeFromBitmap(bitmap, false);
+}
+
+void RasterTileCache::evictTiles() {
+    auto maxTilesCount = _maxBytes / bytesPerTile();
+    if (_tilesCount <= maxTilesCount) {
+        return;
+    }
+
+    struct EvictionCandidate {
+        size_t lastUsedPass;
+        uint64_t layerId;
+        uint64_t tileKey;
+    };
+    std::vector<EvictionCandidate> candidates;
+
+    for (const auto& [layerId, entry] : _entries) {
+        for (const auto& [tileKey, tile] : entry.tiles) {
+            // Tiles drawn during the current pass are always kept
+            if (tile.lastUsedPass != _pass) {
+                candidates.push_back(EvictionCandidate{tile.lastUsedPass, layerId, tileKey});
+            }
+        }
+    }
+
+    std::sort(candidates.begin(), candidates.end(), [](const auto& lhs, const auto& rhs) {
+        return lhs.lastUsedPass < rhs.lastUsedPass;
+    });
+
+    for (const auto& candidate : candidates) {
+        if (_tilesCount <= maxTilesCount) {
+            break;
+        }
+
+        _entries[candidate.layerId].tiles.erase(candidate.tileKey);
+        _tilesCount--;
+        _stats.evictedTiles++;
+    }
+}
+
+void RasterTileCache::clearEntry(Entry& entry) {
+    _tilesCount -= entry.tiles.size();
+    _stats.evictedTiles += entry.tiles.size();
+    entry.tiles.clear();
+}
+
+RasterTileCacheStats RasterTileCache::getStats() const {
+    std::lock_guard<Valdi::Mutex> lock(_mutex);
+    return _stats;
+}
+
+size_t RasterTileCache::getBytesUsed() const {
+    std::lock_guard<Valdi::Mutex> lock(_mutex);
+    return _tilesCount * bytesPerTile();
+}
+
+} // namespace snap::drawing
@@ -0,0 +1,119 @@
+#pragma once
+
+#include "snap_drawing/cpp/Drawing/Raster/BitmapCache.hpp"
+#include "snap_drawing/cpp/Utils/Aliases.hpp"
+#include "snap_drawing/cpp/Utils/Scalar.hpp"
+#include "valdi_core/cpp/Interfaces/IBitmap.hpp"
+#include "valdi_core/cpp/Utils/Byte.hpp"
+#include "valdi_core/cpp/Utils/FlatMap.hpp"
+#include "valdi_core/cpp/Utils/Mutex.hpp"
+#include <cstdint>
+
+class SkCanvas;
+
+namespace snap::drawing {
+
+class Image;
+
+struct RasterTileCacheStats {
+    size_t rasterizedTiles = 0;
+    size_t reusedTiles = 0;
+    size_t evictedTiles = 0;
+};
+
+/**
+RasterTileCache retains the rasterized content of the display list contexts which were pushed
+with cachesRasterTiles, like the content layer of a ScrollLayer. The content is split into square
+tiles in device space, keyed by the layer id of the context. Each tile has a content version
+computed from the operations of the context whose bounds intersect the tile, excluding the matrix
+of the context itself. When only the position of the context changes, as it does when scrolling,
+the retained tiles are drawn at the new position and only the tiles which were never visible
+before are rasterized. When a child changes, only the tiles it covers are rasterized again.
+
+Tiles are drawn on whole device pixels, the fractional part of the context position is kept
+within the tiles. Contexts whose matrix is not a scale and translate, or which contain external
+surfaces or masks, are not cached and should be drawn directly.
+Tiles are rasterized outside of the cache lock, so that multiple threads can draw through the
+cache concurrently. Tiles that are not used during a pass are evicted least recently used first
+once the retained tiles exceed the byte budget.
+ */
+class RasterTileCache {
+public:
+    static constexpr int kTileSize = 256;
+    static constexpr size_t kDefaultMaxBytes = 32 * 1024 * 1024;
+
+    RasterTileCache();
+    ~RasterTileCache();
+
+    void setMaxBytes(size_t maxBytes);
+
+    /**
+     Starts a raster pass. Contexts which are not drawn until the matching endPass()
+     call have their tiles evicted.
+     */
+    void beginPass();
+    void endPass();
+
+    /**
+     Draw the operations between begin and end, which are the operations of the context
+     with the given layer id, into the canvas. The canvas matrix must be the one of the
+     context. Returns false if the operations cannot be cached, in which case nothing
+     was drawn.
+     */
+    bool draw(SkCanvas* canvas,
+              uint64_t layerId,
+              const Valdi::Byte* begin,
+              const Valdi::Byte* end,
+              Scalar displayListScaleX,
+              Scalar displayListScaleY);
+
+    RasterTileCacheStats getStats() const;
+    size_t getBytesUsed() const;
+
+private:
+    struct Tile {
+        Ref<Image> image;
+        uint64_t contentVersion = 0;
+        size_t lastUsedPass = 0;
+    };
+
+    // How the tiles of a context are rasterized, tiles are discarded when it changes
+    struct Rasterization {
+        Scalar matrixScaleX = 0;
+        Scalar matrixScaleY = 0;
+        Scalar subpixelOffsetX = 0;
+        Scalar subpixelOffsetY = 0;
+        Valdi::ColorType colorType = Valdi::ColorType::ColorTypeUnknown;
+
+        bool operator==(const Rasterization& other) const;
+        bool operator!=(const Rasterization& other) const;
+    };
+
+    struct Entry {
+        Rasterization rasterization;
+        size_t lastUsedPass = 0;
+        Valdi::FlatMap<uint64_t, Tile> tiles;
+    };
+
+    mutable Valdi::Mutex _mutex;
+    Valdi::FlatMap<uint64_t, Entry> _entries;
+    BitmapCache _bitmapCache;
+    RasterTileCacheStats _stats;
+    size_t _maxBytes = kDefaultMaxBytes;
+    size_t _tilesCount = 0;
+    size_t _pass = 0;
+
+    static Valdi::Result<Ref<Image>> rasterTile(const Rasterization& rasterization,
+                                                const Ref<Valdi::IBitmap>& bitmap,
+                                                int column,
+                                                int row,
+                                                const Valdi::Byte* begin,
+                                                const Valdi::Byte* end,
+                                                Scalar displayListScaleX,
+                                                Scalar displayListScaleY);
+
+    void evictTiles();
+    void clearEntry(Entry& entry);
+};
+
+} // namespace snap::drawing
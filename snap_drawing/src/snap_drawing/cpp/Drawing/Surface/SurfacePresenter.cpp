@@ -74,6 +74,19 @@ bool SurfacePresenter::needsDrawForFrameTime(const TimePoint& time) const {
     return getDrawableSurface() != nullptr && (!_lastDrawnFrameTime || _lastDrawnFrameTime.value() != time);
 }
 
+const Ref<DisplayList>& SurfacePresenter::getLastDrawnDisplayList() const {
+    return _lastDrawnDisplayList;
+}
+
+size_t SurfacePresenter::getLastDrawnDisplayListPlaneIndex() const {
+    return _lastDrawnDisplayListPlaneIndex;
+}
+
+void SurfacePresenter::setLastDrawnDisplayList(const Ref<DisplayList>& lastDrawnDisplayList, size_t planeIndex) {
+    _lastDrawnDisplayList = lastDrawnDisplayList;
+    _lastDrawnDisplayListPlaneIndex = planeIndex;
+}
+
 bool SurfacePresenter::needsSynchronousDraw() const {
     return _needsSynchronousDraw;
 }
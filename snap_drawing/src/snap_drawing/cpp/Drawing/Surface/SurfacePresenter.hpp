@@ -7,6 +7,7 @@
 
 #pragma once
 
+#include "snap_drawing/cpp/Drawing/DisplayList/DisplayList.hpp"
 #include "snap_drawing/cpp/Drawing/Surface/DrawableSurface.hpp"
 #include "snap_drawing/cpp/Drawing/Surface/ExternalSurface.hpp"
 #include "snap_drawing/cpp/Drawing/Surface/ExternalSurfacePresenterState.hpp"
@@ -43,6 +44,14 @@ public:
 
     bool needsDrawForFrameTime(const TimePoint& time) const;
 
+    /**
+     The DisplayList and plane index that were last drawn into the drawable surface. The DisplayList
+     is retained so that the next one can be compared against it.
+     */
+    const Ref<DisplayList>& getLastDrawnDisplayList() const;
+    size_t getLastDrawnDisplayListPlaneIndex() const;
+    void setLastDrawnDisplayList(const Ref<DisplayList>& lastDrawnDisplayList, size_t planeIndex);
+
     void setAsExternal(ExternalSurface& externalSurface, const ExternalSurfacePresenterState& presenterState);
     void setAsDrawable();
 
@@ -62,6 +71,8 @@ private:
     Ref<Surface> _surface;
     size_t _displayListPlaneIndex = 0;
     std::optional<TimePoint> _lastDrawnFrameTime;
+    Ref<DisplayList> _lastDrawnDisplayList;
+    size_t _lastDrawnDisplayListPlaneIndex = 0;
     std::optional<ExternalSurfacePresenterState> _externalSurfacePresenterState;
     bool _needsSynchronousDraw = false;
 };
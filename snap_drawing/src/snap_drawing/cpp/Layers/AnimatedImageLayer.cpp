@@ -55,7 +55,11 @@ void AnimatedImageLayer::onDraw(DrawingContext& drawingContext) {
         drawingContext.concat(Matrix::makeScaleTranslate(-1, 1, imageDrawBounds.width(), 0));
     }
 
-    _image->draw(drawingContext.canvas(), imageDrawBounds, _currentTime, _fittingSizeMode);
+    _image->draw(drawingContext.canvas(),
+                 imageDrawBounds,
+                 _currentTime,
+                 _fittingSizeMode,
+                 getResources()->getAnimatedImageFrameCache().get());
 }
 
 void AnimatedImageLayer::onLoadedAssetChanged(const Ref<Valdi::LoadedAsset>& loadedAsset, bool shouldDrawFlipped) {
@@ -14,6 +14,8 @@
 
 namespace snap::drawing {
 
+class AnimationEngine;
+
 // The resolution the current frame will ultimately be presented/encoded at, in the root's
 // coordinate space. May be smaller than a descendant layer's own frame (e.g. a pinch-zoomed
 // sticker), which is what lets ExternalLayer avoid rasterizing its external content at a
@@ -36,6 +38,22 @@ public:
 
     virtual bool shouldRasterizeExternalSurface() const = 0;
 
+    /**
+     Called whenever a change of the given layer may change the result of hit-testing.
+     hierarchyChanged is true when the change may change which layers can be hit, such as a
+     children or touch enabled change, and false when only the frame, transform or touch area
+     of the layer changed.
+     */
+    virtual void setHitTestGeometryDirty(ILayer& /*layer*/, bool /*hierarchyChanged*/) {}
+
+    /**
+     Returns the engine evaluating the PropertyAnimation of the tree in bulk, or nullptr
+     if each layer should run its animations itself.
+     */
+    virtual AnimationEngine* getAnimationEngine() {
+        return nullptr;
+    }
+
     // Defaults to {0, 0} (unknown), in which case callers should treat output size as
     // unconstrained. Roots that draw straight to a fixed-resolution target (e.g. transcoding)
     // should override this so it always reflects the size of the frame currently being drawn.
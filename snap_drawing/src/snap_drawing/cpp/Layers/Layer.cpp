@@ -15,6 +15,7 @@
 #include "valdi_core/cpp/Utils/StringCache.hpp"
 
 #include "snap_drawing/cpp/Animations/Animation.hpp"
+#include "snap_drawing/cpp/Animations/AnimationEngine.hpp"
 
 #include "snap_drawing/cpp/Drawing/BoxShadow.hpp"
 #include "snap_drawing/cpp/Drawing/DisplayList/DisplayList.hpp"
@@ -76,7 +77,7 @@ void Layer::draw(DisplayList& displayList, DrawMetrics& metrics) {
         _layerId = _root->allocateLayerId();
     }
 
-    displayList.pushContext(_matrix, resolvedContextOpacity, _layerId, _needsDisplay);
+    displayList.pushContext(_matrix, resolvedContextOpacity, _layerId, _needsDisplay, _cachesRasterTiles);
 
     if (_needsDisplay) {
         drawBackground(width, height);
@@ -236,6 +237,7 @@ void Layer::insertChild(const Valdi::Ref<Layer>& childLayer, size_t index) {
     childLayer->onParentChanged(Valdi::strongSmallRef(this));
 
     setChildNeedsDisplay();
+    setHitTestGeometryDirty(true);
 
     onChildInserted(childLayer.get(), index);
 
@@ -269,6 +271,7 @@ void Layer::removeChild(Layer* childLayer, bool shouldNotify) {
             onChildRemoved(childLayer);
         }
         setChildNeedsDisplay();
+        setHitTestGeometryDirty(true);
     }
 }
 
@@ -321,6 +324,17 @@ bool Layer::hitTest(const Point& point) const {
     return true;
 }
 
+Rect Layer::getHitTestBounds() const {
+    return Rect::makeLTRB(-_touchAreaExtensionLeft,
+                          -_touchAreaExtensionTop,
+                          _frame.width() + _touchAreaExtensionRight,
+                          _frame.height() + _touchAreaExtensionBottom);
+}
+
+bool Layer::hasCustomHitTest() const {
+    return false;
+}
+
 Ref<Layer> Layer::getLayerAtPoint(const Point& point) {
     if (!hitTest(point)) {
         return nullptr;
@@ -382,6 +396,7 @@ void Layer::setTouchAreaExtension(Scalar left, Scalar right, Scalar top, Scalar
     _touchAreaExtensionRight = right;
     _touchAreaExtensionTop = top;
     _touchAreaExtensionBottom = bottom;
+    setHitTestGeometryDirty(false);
 }
 
 void Layer::setBackgroundColor(Color backgroundColor) {
@@ -476,7 +491,10 @@ Color Layer::getBackgroundColor() const {
 }
 
 void Layer::setTouchEnabled(bool touchEnabled) {
-    _touchEnabled = touchEnabled;
+    if (_touchEnabled != touchEnabled) {
+        _touchEnabled = touchEnabled;
+        setHitTestGeometryDirty(true);
+    }
 }
 
 bool Layer::isTouchEnabled() const {
@@ -500,6 +518,7 @@ void Layer::setOpacity(Scalar opacity) {
         _opacity = opacity;
 
         if (isVisible() != wasVisible) {
+            setHitTestGeometryDirty(true);
             // If we are switching from visible to non-visible or vice versa,
             // we need to redraw completely as the visibility state is used
             // to determine whether we should even emit the draw operations
@@ -566,6 +585,14 @@ bool Layer::clipsToBounds() const {
     return _clipsToBounds;
 }
 
+void Layer::setCachesRasterTiles(bool cachesRasterTiles) {
+    _cachesRasterTiles = cachesRasterTiles;
+}
+
+bool Layer::cachesRasterTiles() const {
+    return _cachesRasterTiles;
+}
+
 void Layer::onBoundsChanged() {}
 
 void Layer::onLayout() {}
@@ -670,7 +697,28 @@ void Layer::addAnimation(const String& key, const Ref<IAnimation>& animation) {
     {
         (*_animations.writeAccess())[key] = animation;
     }
-    scheduleProcessAnimationsIfNeeded();
+    if (!startAnimationInEngine(key, animation)) {
+        scheduleProcessAnimationsIfNeeded();
+    }
+}
+
+bool Layer::startAnimationInEngine(const String& key, const Ref<IAnimation>& animation) {
+    if (_root == nullptr) {
+        return false;
+    }
+
+    auto* engine = _root->getAnimationEngine();
+    if (engine == nullptr) {
+        return false;
+    }
+
+    auto propertyAnimation = Valdi::castOrNull<PropertyAnimation>(animation);
+    if (propertyAnimation == nullptr) {
+        return false;
+    }
+
+    engine->add(*this, key, propertyAnimation);
+    return true;
 }
 
 void Layer::removeAnimation(const String& key) {
@@ -731,8 +779,17 @@ bool Layer::needsProcessAnimations() const {
     return _enqueuedFrame.has_value();
 }
 
+bool Layer::hasAnimationsToProcess() const {
+    for (const auto& it : _animations.readAccess()) {
+        if (!it.second->isRunningInEngine()) {
+            return true;
+        }
+    }
+    return false;
+}
+
 void Layer::scheduleProcessAnimationsIfNeeded() {
-    if (_enqueuedFrame || _animations.empty() || _root == nullptr) {
+    if (_enqueuedFrame || _animations.empty() || _root == nullptr || !hasAnimationsToProcess()) {
         return;
     }
 
@@ -784,7 +841,9 @@ void Layer::processAnimations(Duration delta) {
     {
         auto animations = _animations.readAccess();
         for (const auto& it : animations) {
-            collectedAnimations.emplace_back(it.first, it.second);
+            if (!it.second->isRunningInEngine()) {
+                collectedAnimations.emplace_back(it.first, it.second);
+            }
         }
     }
 
@@ -793,20 +852,24 @@ void Layer::processAnimations(Duration delta) {
     for (const auto& animationToProcess : collectedAnimations) {
         auto completed = animationToProcess.animation->run(*this, delta);
         if (completed) {
-            {
-                auto animations = _animations.writeAccess();
-                const auto& it = animations->find(animationToProcess.key);
-                if (it != animations->end() && it->second == animationToProcess.animation) {
-                    animations->erase(it);
-                }
-            }
-            animationToProcess.animation->complete(*this);
+            completeAnimation(animationToProcess.key, animationToProcess.animation);
         }
     }
 
     scheduleProcessAnimationsIfNeeded();
 }
 
+void Layer::completeAnimation(const String& key, const Ref<IAnimation>& animation) {
+    {
+        auto animations = _animations.writeAccess();
+        const auto& it = animations->find(key);
+        if (it != animations->end() && it->second == animation) {
+            animations->erase(it);
+        }
+    }
+    animation->complete(*this);
+}
+
 std::optional<Point> Layer::convertPointToLayer(Point point, const Valdi::Ref<Layer>& childLayer) const {
     thread_local std::vector<Ref<Layer>> kDescendants;
 
@@ -914,6 +977,13 @@ Point Layer::convertPointToParent(const Point& point) {
 void Layer::setVisualFrameDirty() {
     _visualFrameDirty = true;
     _matrixDirty = true;
+    setHitTestGeometryDirty(false);
+}
+
+void Layer::setHitTestGeometryDirty(bool hierarchyChanged) {
+    if (_root != nullptr) {
+        _root->setHitTestGeometryDirty(*this, hierarchyChanged);
+    }
 }
 
 Rect Layer::getAbsoluteVisualFrame() {
@@ -1054,6 +1124,10 @@ void Layer::onRootChanged(ILayerRoot* root) {
     }
 
     if (_root != nullptr) {
+        // Animations added while detached can now be driven by the engine of the new root
+        for (const auto& key : getAnimationKeys()) {
+            startAnimationInEngine(key, getAnimation(key));
+        }
         scheduleProcessAnimationsIfNeeded();
     } else {
         removeAllAnimations();
@@ -120,6 +120,14 @@ public:
 
     void setClipsToBounds(bool clipToBounds);
     bool clipsToBounds() const;
+
+    /**
+     Set whether the rasterized content of this layer and its children should be retained
+     into tiles by the RasterContext, so that moving the layer does not require rasterizing
+     its content again.
+     */
+    void setCachesRasterTiles(bool cachesRasterTiles);
+    bool cachesRasterTiles() const;
     bool isVisible() const;
 
     virtual bool getClipsToBoundsDefaultValue() const;
@@ -149,6 +157,18 @@ public:
     virtual bool hitTest(const Point& point) const;
     Ref<Layer> getLayerAtPoint(const Point& point);
 
+    /**
+     Returns the rect in this layer's coordinates outside of which the default hitTest() implementation
+     never succeeds, which includes the touch area extensions.
+     */
+    Rect getHitTestBounds() const;
+
+    /**
+     Whether hitTest() is overridden in a way that can succeed outside of getHitTestBounds(),
+     or regardless of whether the layer is touch enabled or visible.
+     */
+    virtual bool hasCustomHitTest() const;
+
     void layoutIfNeeded();
 
     bool needsDisplay() const;
@@ -212,6 +232,12 @@ public:
     Ref<IAnimation> getAnimation(const String& key) const;
     std::vector<String> getAnimationKeys() const;
 
+    /**
+     Remove the given animation registered under the given key and notify it that it completed.
+     Called when an animation driven outside of the layer, like by the AnimationEngine, has completed.
+     */
+    void completeAnimation(const String& key, const Ref<IAnimation>& animation);
+
     void addGestureRecognizer(const Valdi::Ref<GestureRecognizer>& gestureRecognizer);
     void removeGestureRecognizer(const Valdi::Ref<GestureRecognizer>& gestureRecognizer);
     size_t getGestureRecognizersSize() const;
@@ -282,6 +308,7 @@ private:
     bool _childNeedsDisplay = true;
     bool _touchEnabled = true;
     bool _clipsToBounds = false;
+    bool _cachesRasterTiles = false;
     bool _hasParent = false;
     bool _needsLayout = false;
     bool _hasScale = false;
@@ -304,12 +331,15 @@ private:
     void drawForeground(Scalar width, Scalar height);
 
     void setVisualFrameDirty();
+    void setHitTestGeometryDirty(bool hierarchyChanged);
 
     void notifyParentSetChildNeedsDisplay();
 
     void updateMatrix(Scalar width, Scalar height);
 
     void scheduleProcessAnimationsIfNeeded();
+    bool startAnimationInEngine(const String& key, const Ref<IAnimation>& animation);
+    bool hasAnimationsToProcess() const;
     bool cancelProcessAnimations();
     void processAnimations(Duration delta);
 
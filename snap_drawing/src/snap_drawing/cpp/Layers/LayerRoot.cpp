@@ -30,7 +30,8 @@ constexpr double kTouchRefreshMs = 10;
 LayerRoot::LayerRoot(const Ref<Resources>& resources)
     : _resources(resources),
       _touchDispatcher(resources->getLogger(), resources->getGesturesConfiguration().debugGestures),
-      _eventQueue(TimePoint(0.0)) {}
+      _eventQueue(TimePoint(0.0)),
+      _animationEngine(*this) {}
 
 LayerRoot::~LayerRoot() = default;
 
@@ -54,6 +55,7 @@ void LayerRoot::setContentLayer(const Valdi::Ref<Layer>& contentLayer, ContentLa
 
         _contentLayer = contentLayer;
         _sizingMode = sizingMode;
+        _touchHitTestIndex.setNeedsUpdate();
 
         if (_contentLayer != nullptr) {
             _contentLayer->onParentChanged(Valdi::strongSmallRef(this));
@@ -72,6 +74,7 @@ void LayerRoot::destroy() {
     _listener = nullptr;
     _destroyed = true;
     setContentLayer(nullptr, _sizingMode);
+    _animationEngine.clear();
     _eventQueue.clear();
 }
 
@@ -182,6 +185,14 @@ void LayerRoot::requestLayout(ILayer* /*layer*/) {
     }
 }
 
+void LayerRoot::setHitTestGeometryDirty(ILayer& layer, bool hierarchyChanged) {
+    if (hierarchyChanged) {
+        _touchHitTestIndex.setNeedsUpdate();
+    } else {
+        _touchHitTestIndex.setLayerNeedsUpdate(layer);
+    }
+}
+
 void LayerRoot::requestFocus(ILayer* /*layer*/) {
     // no-op by default
 }
@@ -191,7 +202,7 @@ bool LayerRoot::dispatchTouchEvent(const TouchEvent& event) {
         return false;
     }
 
-    auto processed = _touchDispatcher.dispatchEvent(event, _contentLayer);
+    auto processed = _touchDispatcher.dispatchEvent(event, _contentLayer, &_touchHitTestIndex);
 
     if (!_touchDispatcher.isEmpty()) {
         enqueueFrame();
@@ -205,7 +216,7 @@ GestureTypes LayerRoot::getGesturesTypesForTouchEvent(const TouchEvent& event) c
         return GestureTypes();
     }
 
-    auto gestureCandidates = _touchDispatcher.getGestureCandidatesForEvent(event, _contentLayer);
+    auto gestureCandidates = _touchDispatcher.getGestureCandidatesForEvent(event, _contentLayer, &_touchHitTestIndex);
 
     GestureTypes types;
 
@@ -268,6 +279,10 @@ bool LayerRoot::cancelEvent(EventId eventId) {
     return _eventQueue.cancel(eventId);
 }
 
+AnimationEngine* LayerRoot::getAnimationEngine() {
+    return &_animationEngine;
+}
+
 void LayerRoot::enqueueFrame() {
     if (canEnqueueFrame() && _listener != nullptr) {
         _didEnqueueFrame = true;
@@ -12,6 +12,7 @@
 #include "valdi_core/cpp/Interfaces/IBitmap.hpp"
 #include "valdi_core/cpp/Interfaces/IMainThreadDispatcher.hpp"
 
+#include "snap_drawing/cpp/Animations/AnimationEngine.hpp"
 #include "snap_drawing/cpp/Events/EventQueue.hpp"
 #include "snap_drawing/cpp/Layers/Interfaces/ILayerRoot.hpp"
 #include "snap_drawing/cpp/Layers/Layer.hpp"
@@ -93,8 +94,10 @@ public:
     bool needsDisplay() const;
 
     void requestLayout(ILayer* layer) override;
+    void setHitTestGeometryDirty(ILayer& layer, bool hierarchyChanged) override;
     EventId enqueueEvent(EventCallback&& eventCallback, Duration after) override;
     bool cancelEvent(EventId eventId) override;
+    AnimationEngine* getAnimationEngine() override;
 
     void requestFocus(ILayer* layer) override;
 
@@ -131,8 +134,11 @@ private:
     Ref<Resources> _resources;
     LayerRootListener* _listener = nullptr;
     TouchDispatcher _touchDispatcher;
+    // Updated lazily when dispatching touches, including from const queries
+    mutable TouchHitTestIndex _touchHitTestIndex;
     Valdi::Ref<Layer> _contentLayer;
     EventQueue _eventQueue;
+    AnimationEngine _animationEngine;
     Size _size = Size::makeEmpty();
     // Unset -> render the full content. Set (possibly empty) -> only that region is rasterized;
     // an empty value means nothing is on screen. See DisplayList::setViewport.
@@ -35,6 +35,8 @@ ScrollLayer::~ScrollLayer() = default;
 void ScrollLayer::onInitialize() {
     Layer::onInitialize();
     _contentLayer = makeLayer<Layer>(getResources());
+    // The content only moves while scrolling, its rasterized tiles can be re-used
+    _contentLayer->setCachesRasterTiles(true);
 
     addChild(_contentLayer);
 
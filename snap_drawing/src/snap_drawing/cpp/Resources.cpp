@@ -7,6 +7,7 @@
 
 #include "snap_drawing/cpp/Resources.hpp"
 #include "include/core/SkGraphics.h"
+#include "snap_drawing/cpp/Utils/AnimatedImageFrameCache.hpp"
 #include "snap_drawing/cpp/Utils/Image.hpp"
 #include "valdi_core/cpp/Interfaces/ILogger.hpp"
 
@@ -69,4 +70,12 @@ Valdi::ILogger& Resources::getLogger() const {
     return *_logger;
 }
 
+const Ref<AnimatedImageFrameCache>& Resources::getAnimatedImageFrameCache() const {
+    return _animatedImageFrameCache;
+}
+
+void Resources::setAnimatedImageFrameCache(const Ref<AnimatedImageFrameCache>& animatedImageFrameCache) {
+    _animatedImageFrameCache = animatedImageFrameCache;
+}
+
 } // namespace snap::drawing
@@ -22,6 +22,8 @@ class ILogger;
 
 namespace snap::drawing {
 
+class AnimatedImageFrameCache;
+
 class Resources : public Valdi::SimpleRefCountable {
 public:
     Resources(const Ref<FontManager>& fontManager,
@@ -47,6 +49,13 @@ public:
 
     const GesturesConfiguration& getGesturesConfiguration() const;
 
+    /**
+     The frame cache shared by the animated images drawn with these resources, or null if
+     animated images should render every frame themselves. Opt-in, null by default.
+     */
+    const Ref<AnimatedImageFrameCache>& getAnimatedImageFrameCache() const;
+    void setAnimatedImageFrameCache(const Ref<AnimatedImageFrameCache>& animatedImageFrameCache);
+
 private:
     Ref<FontManager> _fontManager;
     bool _respectDynamicType;
@@ -54,6 +63,7 @@ private:
     Scalar _dynamicTypeScale;
     GesturesConfiguration _gesturesConfiguration;
     Ref<Valdi::ILogger> _logger;
+    Ref<AnimatedImageFrameCache> _animatedImageFrameCache;
 };
 
 } // namespace snap::drawing
@@ -102,10 +102,8 @@ const FontMetrics& Font::metrics() {
 }
 
 const HBFont& Font::getHBFont() {
-    if (!_hasHBFont) {
-        _hasHBFont = true;
-        _hbFont = Harfbuzz::createSubFont(_typeface->getHBFont(), &_font);
-    }
+    // Fonts are shared between the threads shaping text
+    std::call_once(_hbFontOnce, [&]() { _hbFont = Harfbuzz::createSubFont(_typeface->getHBFont(), &_font); });
 
     return _hbFont;
 }
@@ -19,6 +19,8 @@
 
 #include "include/core/SkFont.h"
 
+#include <mutex>
+
 namespace snap::drawing {
 
 class Font;
@@ -75,7 +77,7 @@ private:
     bool _respectDynamicType;
     FontMetrics _metrics;
     bool _loadedMetrics = false;
-    bool _hasHBFont = false;
+    std::once_flag _hbFontOnce;
 };
 
 } // namespace snap::drawing
@@ -432,6 +432,16 @@ const Ref<TextShaper>& FontManager::getTextShaper() const {
     return _textShaper;
 }
 
+Valdi::Result<Valdi::Void> FontManager::loadTextShaperCacheSnapshot(const Valdi::BytesView& snapshot) {
+    VALDI_TRACE("SnapDrawing.loadTextShaperCacheSnapshot");
+    return _textShaper->loadCacheSnapshot(snapshot);
+}
+
+Valdi::BytesView FontManager::makeTextShaperCacheSnapshot() const {
+    VALDI_TRACE("SnapDrawing.makeTextShaperCacheSnapshot");
+    return _textShaper->makeCacheSnapshot();
+}
+
 const sk_sp<SkFontMgr>& FontManager::getSkValue() {
     auto guard = lock();
     return _fontManager;
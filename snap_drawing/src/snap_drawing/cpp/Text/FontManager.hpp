@@ -19,6 +19,7 @@
 #include "valdi_core/cpp/Utils/Mutex.hpp"
 #include "valdi_core/cpp/Utils/Result.hpp"
 #include "valdi_core/cpp/Utils/StringBox.hpp"
+#include "valdi_core/cpp/Utils/Void.hpp"
 
 #include "include/core/SkFontMgr.h"
 
@@ -111,6 +112,19 @@ public:
 
     const Ref<TextShaper>& getTextShaper() const;
 
+    /**
+     * Warms up the text shaper cache from a snapshot previously returned by makeTextShaperCacheSnapshot().
+     * Entries are restored lazily as their typeface gets used. Entries for typefaces that are not
+     * available anymore, or whose font file changed since the snapshot was made, are never restored.
+     */
+    Valdi::Result<Valdi::Void> loadTextShaperCacheSnapshot(const Valdi::BytesView& snapshot);
+
+    /**
+     * Serializes the most recently used entries of the text shaper cache, so that they can be
+     * persisted and restored in a later process.
+     */
+    Valdi::BytesView makeTextShaperCacheSnapshot() const;
+
     const sk_sp<SkFontMgr>& getSkValue();
 
     void setListener(const Ref<IFontManagerListener>& listener);
@@ -11,7 +11,10 @@
 #include "snap_drawing/cpp/Text/Font.hpp"
 #include "snap_drawing/cpp/Text/Unicode.hpp"
 #include "snap_drawing/cpp/Utils/Aliases.hpp"
+#include "valdi_core/cpp/Utils/Bytes.hpp"
+#include "valdi_core/cpp/Utils/Result.hpp"
 #include "valdi_core/cpp/Utils/SmallVector.hpp"
+#include "valdi_core/cpp/Utils/Void.hpp"
 
 namespace snap::drawing {
 
@@ -71,6 +74,22 @@ class TextShaper : public Valdi::SimpleRefCountable {
 public:
     virtual void clearCache() {}
 
+    /**
+     * Warms up the cache from a snapshot previously returned by makeCacheSnapshot(),
+     * possibly from a previous process. Does nothing if the shaper has no cache.
+     */
+    virtual Valdi::Result<Valdi::Void> loadCacheSnapshot(const Valdi::BytesView& snapshot) {
+        return Valdi::Void();
+    }
+
+    /**
+     * Serializes the most recently used entries of the cache. Returns an empty
+     * BytesView if the shaper has no cache.
+     */
+    virtual Valdi::BytesView makeCacheSnapshot() {
+        return Valdi::BytesView();
+    }
+
     virtual TextParagraphList resolveParagraphs(const Character* unicodeText, size_t length, bool isRightToLeft) = 0;
 
     virtual size_t shape(const Character* unicodeText,
@@ -115,6 +115,10 @@ void TextShaperCache::clear() {
     _cache.clear();
 }
 
+size_t TextShaperCache::size() const {
+    return _cache.size();
+}
+
 bool TextShaperCache::contains(const TextShaperCacheKey& key) const {
     return _cache.contains(key);
 }
@@ -141,6 +145,14 @@ void TextShaperCache::insert(const TextShaperCacheKey& key, const ShapedGlyph* g
     _cache.insert(node);
 }
 
+TextShaperCache::Iterator TextShaperCache::begin() const {
+    return _cache.begin();
+}
+
+TextShaperCache::Iterator TextShaperCache::end() const {
+    return _cache.end();
+}
+
 } // namespace snap::drawing
 
 namespace std {
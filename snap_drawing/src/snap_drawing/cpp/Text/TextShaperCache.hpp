@@ -90,15 +90,26 @@ public:
  */
 class TextShaperCache {
 public:
+    using Node = Valdi::LRUCacheNode<TextShaperCacheKey, TextShaperCacheValue>;
+    using Iterator = Valdi::LRUCache<TextShaperCacheKey, TextShaperCacheValue>::Iterator;
+
     explicit TextShaperCache(size_t capacity);
     ~TextShaperCache();
 
     void clear();
 
+    size_t size() const;
+
     bool contains(const TextShaperCacheKey& key) const;
     std::optional<TextShaperCacheValue> find(const TextShaperCacheKey& key);
     void insert(const TextShaperCacheKey& key, const ShapedGlyph* glyphs, size_t glyphsLength);
 
+    /**
+     * Iterates over the entries, from the most recently used to the least recently used.
+     */
+    Iterator begin() const;
+    Iterator end() const;
+
 private:
     Valdi::LRUCache<TextShaperCacheKey, TextShaperCacheValue> _cache;
 };
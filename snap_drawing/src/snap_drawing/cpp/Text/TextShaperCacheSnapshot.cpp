@@ -0,0 +1,245 @@
+//
+//  TextShaperCacheSnapshot.cpp
+//  snap_drawing
+//
+
+#include "snap_drawing/cpp/Text/TextShaperCacheSnapshot.hpp"
+
+#include <cstring>
+#include <vector>
+
+namespace snap::drawing {
+
+/**
+ Layout of a snapshot, all fields are 32 bits in the native byte order unless noted otherwise:
+ - Header: magic, format version, typefaces count, reserved
+ - Typeface table, one record per typeface: persistent id (64 bits), offset, length, entries count, reserved
+ - Typeface sections, each containing a list of entries:
+   font size bits, letter spacing, script, flags, characters count, glyphs count,
+   the characters, and the glyphs as (offsetX, offsetY, advanceX, glyph id, character and flags).
+ */
+constexpr uint32_t kSnapshotMagic = 0x56545343; // VTSC
+constexpr uint32_t kSnapshotFormatVersion = 1;
+constexpr size_t kHeaderSize = 4 * sizeof(uint32_t);
+constexpr size_t kTypefaceRecordSize = sizeof(uint64_t) + 4 * sizeof(uint32_t);
+constexpr size_t kEntryHeaderSize = 6 * sizeof(uint32_t);
+constexpr size_t kGlyphRecordSize = 5 * sizeof(uint32_t);
+constexpr uint32_t kEntryFlagRightToLeft = 1;
+constexpr uint32_t kUnsafeToBreakFlag = 1u << 31;
+
+template<typename T>
+static void write(Valdi::ByteBuffer& buffer, T value) {
+    auto* data = buffer.appendWritable(sizeof(T));
+    std::memcpy(data, &value, sizeof(T));
+}
+
+template<typename T>
+static void writeAt(Valdi::Byte* data, size_t& offset, T value) {
+    std::memcpy(&data[offset], &value, sizeof(T));
+    offset += sizeof(T);
+}
+
+template<typename T>
+static T readAt(const Valdi::Byte* data, size_t& offset) {
+    T value;
+    std::memcpy(&value, &data[offset], sizeof(T));
+    offset += sizeof(T);
+    return value;
+}
+
+TextShaperCacheSnapshotBuilder::TextShaperCacheSnapshotBuilder() = default;
+TextShaperCacheSnapshotBuilder::~TextShaperCacheSnapshotBuilder() = default;
+
+void TextShaperCacheSnapshotBuilder::append(uint64_t typefacePersistentId,
+                                            const TextShaperCacheKey& key,
+                                            const TextShaperCacheValue& value) {
+    auto& section = _sections[typefacePersistentId];
+    if (section.data == nullptr) {
+        section.data = Valdi::makeShared<Valdi::ByteBuffer>();
+    }
+
+    auto& buffer = *section.data;
+    write(buffer, static_cast<uint32_t>(key.fontId >> 32));
+    write(buffer, key.letterSpacing);
+    write(buffer, key.script.code);
+    write(buffer, key.isRightToLeft ? kEntryFlagRightToLeft : 0u);
+    write(buffer, static_cast<uint32_t>(key.length));
+    write(buffer, static_cast<uint32_t>(value.length));
+
+    for (size_t i = 0; i < key.length; i++) {
+        write(buffer, static_cast<uint32_t>(key.characters[i]));
+    }
+
+    for (size_t i = 0; i < value.length; i++) {
+        const auto& glyph = value.glyphs[i];
+        write(buffer, glyph.offsetX);
+        write(buffer, glyph.offsetY);
+        write(buffer, glyph.advanceX);
+        write(buffer, static_cast<uint32_t>(glyph.glyphID));
+        write(buffer, glyph.character() | (glyph.unsafeToBreak() ? kUnsafeToBreakFlag : 0u));
+    }
+
+    section.entriesCount++;
+    _entriesCount++;
+}
+
+size_t TextShaperCacheSnapshotBuilder::size() const {
+    return _entriesCount;
+}
+
+Valdi::BytesView TextShaperCacheSnapshotBuilder::build() const {
+    auto totalSize = kHeaderSize + _sections.size() * kTypefaceRecordSize;
+    for (const auto& it : _sections) {
+        totalSize += it.second.data->size();
+    }
+
+    auto output = Valdi::makeShared<Valdi::ByteBuffer>();
+    auto* data = output->appendWritable(totalSize);
+
+    size_t offset = 0;
+    writeAt(data, offset, kSnapshotMagic);
+    writeAt(data, offset, kSnapshotFormatVersion);
+    writeAt(data, offset, static_cast<uint32_t>(_sections.size()));
+    writeAt(data, offset, static_cast<uint32_t>(0));
+
+    auto sectionOffset = offset + _sections.size() * kTypefaceRecordSize;
+    for (const auto& it : _sections) {
+        const auto& sectionData = *it.second.data;
+
+        writeAt(data, offset, it.first);
+        writeAt(data, offset, static_cast<uint32_t>(sectionOffset));
+        writeAt(data, offset, static_cast<uint32_t>(sectionData.size()));
+        writeAt(data, offset, it.second.entriesCount);
+        writeAt(data, offset, static_cast<uint32_t>(0));
+
+        std::memcpy(&data[sectionOffset], sectionData.data(), sectionData.size());
+        sectionOffset += sectionData.size();
+    }
+
+    return output->toBytesView();
+}
+
+TextShaperCacheSnapshot::TextShaperCacheSnapshot() = default;
+TextShaperCacheSnapshot::~TextShaperCacheSnapshot() = default;
+
+Valdi::Result<TextShaperCacheSnapshot> TextShaperCacheSnapshot::parse(const Valdi::BytesView& bytes) {
+    const auto* data = bytes.data();
+    auto size = bytes.size();
+
+    if (size < kHeaderSize) {
+        return Valdi::Error("Text shaper cache snapshot is truncated");
+    }
+
+    size_t offset = 0;
+    if (readAt<uint32_t>(data, offset) != kSnapshotMagic) {
+        return Valdi::Error("Invalid text shaper cache snapshot");
+    }
+    if (readAt<uint32_t>(data, offset) != kSnapshotFormatVersion) {
+        return Valdi::Error("Unsupported text shaper cache snapshot version");
+    }
+
+    auto typefacesCount = static_cast<size_t>(readAt<uint32_t>(data, offset));
+    readAt<uint32_t>(data, offset);
+
+    if (typefacesCount > (size - kHeaderSize) / kTypefaceRecordSize) {
+        return Valdi::Error("Text shaper cache snapshot is truncated");
+    }
+
+    TextShaperCacheSnapshot snapshot;
+    snapshot._bytes = bytes;
+
+    for (size_t i = 0; i < typefacesCount; i++) {
+        auto persistentId = readAt<uint64_t>(data, offset);
+        Section section;
+        section.offset = static_cast<size_t>(readAt<uint32_t>(data, offset));
+        section.length = static_cast<size_t>(readAt<uint32_t>(data, offset));
+        section.entriesCount = readAt<uint32_t>(data, offset);
+        readAt<uint32_t>(data, offset);
+
+        if (section.offset > size || section.length > size - section.offset) {
+            return Valdi::Error("Text shaper cache snapshot has an out of bounds section");
+        }
+
+        snapshot._sections[persistentId] = section;
+    }
+
+    return snapshot;
+}
+
+bool TextShaperCacheSnapshot::empty() const {
+    return _sections.empty();
+}
+
+size_t TextShaperCacheSnapshot::consumeTypeface(uint64_t typefacePersistentId,
+                                                uint32_t typefaceId,
+                                                const Visitor& visitor) {
+    const auto& it = _sections.find(typefacePersistentId);
+    if (it == _sections.end()) {
+        return 0;
+    }
+
+    auto section = it->second;
+    _sections.erase(it);
+
+    const auto* data = _bytes.data() + section.offset;
+    auto end = section.length;
+    size_t offset = 0;
+    size_t visitedEntries = 0;
+
+    std::vector<Character> characters;
+    std::vector<ShapedGlyph> glyphs;
+
+    for (uint32_t i = 0; i < section.entriesCount; i++) {
+        if (end - offset < kEntryHeaderSize) {
+            break;
+        }
+
+        auto fontSizeBits = readAt<uint32_t>(data, offset);
+        auto letterSpacing = readAt<Scalar>(data, offset);
+        auto script = TextScript(readAt<uint32_t>(data, offset));
+        auto flags = readAt<uint32_t>(data, offset);
+        auto charactersLength = static_cast<size_t>(readAt<uint32_t>(data, offset));
+        auto glyphsLength = static_cast<size_t>(readAt<uint32_t>(data, offset));
+
+        auto remaining = end - offset;
+        if (charactersLength > remaining / sizeof(uint32_t) ||
+            glyphsLength > (remaining - charactersLength * sizeof(uint32_t)) / kGlyphRecordSize) {
+            break;
+        }
+
+        characters.resize(charactersLength);
+        for (size_t j = 0; j < charactersLength; j++) {
+            characters[j] = static_cast<Character>(readAt<uint32_t>(data, offset));
+        }
+
+        glyphs.resize(glyphsLength);
+        for (size_t j = 0; j < glyphsLength; j++) {
+            auto& glyph = glyphs[j];
+            glyph.offsetX = readAt<Scalar>(data, offset);
+            glyph.offsetY = readAt<Scalar>(data, offset);
+            glyph.advanceX = readAt<Scalar>(data, offset);
+            glyph.glyphID = static_cast<SkGlyphID>(readAt<uint32_t>(data, offset));
+            auto characterAndFlags = readAt<uint32_t>(data, offset);
+            glyph.setCharacter(characterAndFlags & ~kUnsafeToBreakFlag, (characterAndFlags & kUnsafeToBreakFlag) != 0);
+        }
+
+        auto fontId = (static_cast<FontId>(fontSizeBits) << 32) | static_cast<FontId>(typefaceId);
+        auto key = TextShaperCacheKey(fontId,
+                                      letterSpacing,
+                                      script,
+                                      (flags & kEntryFlagRightToLeft) != 0,
+                                      characters.data(),
+                                      characters.size());
+        visitor(key, glyphs.data(), glyphs.size());
+        visitedEntries++;
+    }
+
+    if (_sections.empty()) {
+        // Release the underlying storage once every typeface has been restored
+        _bytes = Valdi::BytesView();
+    }
+
+    return visitedEntries;
+}
+
+} // namespace snap::drawing
@@ -0,0 +1,81 @@
+//
+//  TextShaperCacheSnapshot.hpp
+//  snap_drawing
+//
+
+#pragma once
+
+#include "snap_drawing/cpp/Text/TextShaperCache.hpp"
+
+#include "valdi_core/cpp/Utils/ByteBuffer.hpp"
+#include "valdi_core/cpp/Utils/Bytes.hpp"
+#include "valdi_core/cpp/Utils/FlatMap.hpp"
+#include "valdi_core/cpp/Utils/Function.hpp"
+#include "valdi_core/cpp/Utils/Result.hpp"
+
+namespace snap::drawing {
+
+/**
+ * Builds a serialized TextShaperCacheSnapshot. Entries are grouped by typeface, using
+ * the typeface persistent id so that they can be matched against the typefaces loaded
+ * in a later process.
+ */
+class TextShaperCacheSnapshotBuilder {
+public:
+    TextShaperCacheSnapshotBuilder();
+    ~TextShaperCacheSnapshotBuilder();
+
+    /**
+     * Append a cache entry. Entries of a typeface are restored in the order they were appended,
+     * so the most recently used entries should be appended last.
+     */
+    void append(uint64_t typefacePersistentId, const TextShaperCacheKey& key, const TextShaperCacheValue& value);
+
+    size_t size() const;
+
+    Valdi::BytesView build() const;
+
+private:
+    struct Section {
+        Valdi::Ref<Valdi::ByteBuffer> data;
+        uint32_t entriesCount = 0;
+    };
+
+    Valdi::FlatMap<uint64_t, Section> _sections;
+    size_t _entriesCount = 0;
+};
+
+/**
+ * A read-only view over a serialized snapshot of TextShaperCache entries, typically
+ * backed by a memory mapped file. Entries are decoded lazily, one typeface at a time.
+ */
+class TextShaperCacheSnapshot {
+public:
+    using Visitor = Valdi::Function<void(const TextShaperCacheKey&, const ShapedGlyph*, size_t)>;
+
+    TextShaperCacheSnapshot();
+    ~TextShaperCacheSnapshot();
+
+    [[nodiscard]] static Valdi::Result<TextShaperCacheSnapshot> parse(const Valdi::BytesView& bytes);
+
+    bool empty() const;
+
+    /**
+     * Decodes the entries that were stored for the typeface with the given persistent id and
+     * calls the visitor for each of them, with a key using the given runtime typeface id.
+     * The typeface is then removed from the snapshot. Returns the number of visited entries.
+     */
+    size_t consumeTypeface(uint64_t typefacePersistentId, uint32_t typefaceId, const Visitor& visitor);
+
+private:
+    struct Section {
+        size_t offset = 0;
+        size_t length = 0;
+        uint32_t entriesCount = 0;
+    };
+
+    Valdi::BytesView _bytes;
+    Valdi::FlatMap<uint64_t, Section> _sections;
+};
+
+} // namespace snap::drawing
@@ -12,7 +12,6 @@
 
 #include "valdi_core/cpp/Text/UTF16Utils.hpp"
 #include "valdi_core/cpp/Utils/AutoMalloc.hpp"
-#include "valdi_core/cpp/Utils/Mutex.hpp"
 
 #include "hb-icu.h"
 #include "hb-ot.h"
@@ -31,7 +30,7 @@ enum class TextDirectionResolutionResult {
     RightToLeft,
 };
 
-TextShaperHarfbuzz::TextShaperHarfbuzz() : _buffer(hb_buffer_create()) {}
+TextShaperHarfbuzz::TextShaperHarfbuzz() = default;
 TextShaperHarfbuzz::~TextShaperHarfbuzz() = default;
 
 /**
@@ -46,6 +45,15 @@ static bool isScriptOkForLetterspacing(hb_script_t script) {
              script == HB_SCRIPT_TIRHUTA || script == HB_SCRIPT_OGHAM);
 }
 
+/**
+ * A HarfBuzz buffer holds the state of a single shaping operation, so each thread
+ * shapes into its own buffer instead of serializing on a shared one.
+ */
+static hb_buffer_t* getThreadLocalBuffer() {
+    static thread_local HBBuffer tBuffer(hb_buffer_create());
+    return tBuffer.get();
+}
+
 static bool isBiDiLevelRightToLeft(UBiDiLevel level) {
     return (level & 0x1) != 0;
 }
@@ -281,9 +289,7 @@ size_t TextShaperHarfbuzz::shape(const Character* unicodeText,
                                  Scalar letterSpacing,
                                  TextScript script,
                                  std::vector<ShapedGlyph>& out) {
-    std::lock_guard<Valdi::Mutex> lock(_mutex);
-
-    auto* buffer = _buffer.get();
+    auto* buffer = getThreadLocalBuffer();
     if (buffer == nullptr) {
         return 0;
     }
@@ -325,7 +331,7 @@ size_t TextShaperHarfbuzz::shape(const Character* unicodeText,
     auto fontSize = font.getSkValue().getSize();
     double textSizeY = fontSize / scaleY;
     double textSizeX = fontSize / scaleX * font.getSkValue().getScaleX();
-    Scalar advanceOffset = isScriptOkForLetterspacing(hb_buffer_get_script(_buffer.get())) ? letterSpacing : 0.0f;
+    Scalar advanceOffset = isScriptOkForLetterspacing(hb_buffer_get_script(buffer)) ? letterSpacing : 0.0f;
 
     auto glyphsLength = static_cast<size_t>(glyphCount);
 
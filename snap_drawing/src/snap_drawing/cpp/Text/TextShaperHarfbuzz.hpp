@@ -9,7 +9,6 @@
 
 #include "snap_drawing/cpp/Text/Harfbuzz.hpp"
 #include "snap_drawing/cpp/Text/TextShaper.hpp"
-#include "valdi_core/cpp/Utils/Mutex.hpp"
 
 namespace snap::drawing {
 
@@ -31,9 +30,6 @@ public:
                  std::vector<ShapedGlyph>& out) override;
 
 private:
-    Valdi::Mutex _mutex;
-    HBBuffer _buffer;
-
     static TextParagraphList resolveParagraphsPrimitive(const Character* unicodeText,
                                                         size_t length,
                                                         bool isRightToLeft);
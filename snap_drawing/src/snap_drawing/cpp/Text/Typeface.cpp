@@ -15,6 +15,10 @@
 #include "include/core/SkFontMetrics.h"
 #include "include/core/SkStream.h"
 
+#include "xxhash/xxhash.h"
+
+#include <vector>
+
 namespace snap::drawing {
 
 constexpr Scalar kDefaultLineHeightToUnderlineThicknessRatio = 0.06;
@@ -23,6 +27,43 @@ constexpr Scalar kDefaultDescentUnderlineToPositionRatio = 0.2;
 constexpr Scalar kDefaultLineHeightToStrikethroughThicknessRatio = 0.06;
 constexpr Scalar kDefaultAscentToStrikethroughPositionRatio = 0.3;
 
+static void updatePersistentIdWithInt(XXH64_state_t* state, int value) {
+    // Hash a fixed width little endian representation, so that the id doesn't depend on the platform
+    auto unsignedValue = static_cast<uint32_t>(value);
+    uint8_t bytes[4] = {static_cast<uint8_t>(unsignedValue),
+                        static_cast<uint8_t>(unsignedValue >> 8),
+                        static_cast<uint8_t>(unsignedValue >> 16),
+                        static_cast<uint8_t>(unsignedValue >> 24)};
+    XXH64_update(state, bytes, sizeof(bytes));
+}
+
+static uint64_t computePersistentId(const SkTypeface& typeface) {
+    SkString postScriptName;
+    typeface.getPostScriptName(&postScriptName);
+
+    auto* state = XXH64_createState();
+    XXH64_reset(state, 0);
+
+    updatePersistentIdWithInt(state, static_cast<int>(postScriptName.size()));
+    XXH64_update(state, postScriptName.c_str(), postScriptName.size());
+    updatePersistentIdWithInt(state, typeface.countGlyphs());
+    updatePersistentIdWithInt(state, typeface.getUnitsPerEm());
+
+    // The head table holds the font revision and the checksum of the whole font file
+    auto headTag = SkSetFourByteTag('h', 'e', 'a', 'd');
+    auto headSize = typeface.getTableSize(headTag);
+    if (headSize > 0) {
+        std::vector<uint8_t> head(headSize);
+        typeface.getTableData(headTag, 0, headSize, head.data());
+        XXH64_update(state, head.data(), head.size());
+    }
+
+    auto persistentId = static_cast<uint64_t>(XXH64_digest(state));
+    XXH64_freeState(state);
+
+    return persistentId;
+}
+
 Typeface::Typeface(sk_sp<SkTypeface>&& typeface, const String& familyName, bool isCustom)
     : _typeface(std::move(typeface)), _familyName(familyName), _fontStyle(_typeface->fontStyle()), _isCustom(isCustom) {
     _hbFace = Harfbuzz::createFace(_typeface.get());
@@ -33,6 +74,7 @@ Typeface::Typeface(sk_sp<SkTypeface>&& typeface, const String& familyName, bool
     _characterSet = _hbFace.getCharacters();
     // This seems arbitrary, but I'm not sure if there is a better way
     _isEmoji = supportsCharacter(0x270C);
+    _persistentId = computePersistentId(*_typeface);
 }
 
 Typeface::~Typeface() = default;
@@ -41,6 +83,10 @@ uint32_t Typeface::getId() const {
     return _typeface->uniqueID();
 }
 
+uint64_t Typeface::getPersistentId() const {
+    return _persistentId;
+}
+
 const sk_sp<SkTypeface>& Typeface::getSkValue() const {
     return _typeface;
 }
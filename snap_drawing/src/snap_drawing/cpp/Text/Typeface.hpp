@@ -32,6 +32,13 @@ public:
 
     uint32_t getId() const;
 
+    /**
+     * Returns an identifier for the font file backing this typeface which remains
+     * stable across process launches. It changes whenever the font is updated
+     * to a different revision.
+     */
+    uint64_t getPersistentId() const;
+
     const sk_sp<SkTypeface>& getSkValue() const;
 
     const String& familyName() const;
@@ -60,6 +67,7 @@ private:
     FontStyle _fontStyle;
     bool _isCustom;
     bool _isEmoji;
+    uint64_t _persistentId;
     HBFace _hbFace;
     HBFont _hbFont;
     Valdi::FlatMap<double, FontMetrics> _fontMetricsBySize;
@@ -12,15 +12,35 @@
 namespace snap::drawing {
 
 constexpr size_t kWordCacheSize = 1000;
+constexpr size_t kWordCacheShardsCount = 16;
 constexpr Scalar kUniformFontSize = 12;
 
+WordCachingTextShaper::CacheShard::CacheShard(size_t capacity) : cache(capacity) {}
+
 WordCachingTextShaper::WordCachingTextShaper(const Ref<TextShaper>& innerShaper, WordCachingTextShaperStrategy strategy)
-    : _innerShaper(innerShaper), _cache(kWordCacheSize), _strategy(strategy) {}
+    : _innerShaper(innerShaper), _strategy(strategy) {
+    _shards.reserve(kWordCacheShardsCount);
+    for (size_t i = 0; i < kWordCacheShardsCount; i++) {
+        // Spread the remainder over the first shards, so that the shards hold kWordCacheSize words in total
+        auto capacity = kWordCacheSize / kWordCacheShardsCount + (i < kWordCacheSize % kWordCacheShardsCount ? 1 : 0);
+        _shards.emplace_back(std::make_unique<CacheShard>(capacity));
+    }
+}
 WordCachingTextShaper::~WordCachingTextShaper() = default;
 
 void WordCachingTextShaper::clearCache() {
-    std::lock_guard<Valdi::Mutex> lock(_mutex);
-    _cache.clear();
+    for (const auto& shard : _shards) {
+        std::lock_guard<Valdi::Mutex> lock(shard->mutex);
+        shard->cache.clear();
+    }
+}
+
+WordCachingTextShaperStats WordCachingTextShaper::getStats() const {
+    WordCachingTextShaperStats stats;
+    stats.hits = _hits.load(std::memory_order_relaxed);
+    stats.misses = _misses.load(std::memory_order_relaxed);
+    stats.evictions = _evictions.load(std::memory_order_relaxed);
+    return stats;
 }
 
 TextParagraphList WordCachingTextShaper::resolveParagraphs(const Character* unicodeText,
@@ -36,8 +56,6 @@ size_t WordCachingTextShaper::shape(const Character* unicodeText,
                                     Scalar letterSpacing,
                                     TextScript script,
                                     std::vector<ShapedGlyph>& out) {
-    std::lock_guard<Valdi::Mutex> lock(_mutex);
-
     if (font.typeface()->hasSpaceInLigaturesOrKerning()) {
         return _innerShaper->shape(unicodeText, length, font, isRightToLeft, letterSpacing, script, out);
     }
@@ -152,28 +170,182 @@ void WordCachingTextShaper::shapeWord(const Character* unicodeText,
                                       TextScript script,
                                       std::vector<ShapedGlyph>& out) {
     auto cacheKey = TextShaperCacheKey(fontId, letterSpacing, script, isRightToLeft, unicodeText, length);
-    auto cacheResult = _cache.find(cacheKey);
+    const auto& typeface = *font.typeface();
+    auto lookupResult = findInCache(cacheKey, typeface, out);
+    if (lookupResult == CacheLookupResult::Hit) {
+        _hits.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
 
-    if (cacheResult) {
-        copyGlyphs(cacheResult.value().glyphs, cacheResult.value().length, out);
+    // The first miss of a typeface in a shard might restore its entries from a loaded snapshot
+    if (lookupResult == CacheLookupResult::MissOnNewTypeface && restoreTypefaceFromSnapshot(typeface) &&
+        findInCache(cacheKey, typeface, out) == CacheLookupResult::Hit) {
+        _hits.fetch_add(1, std::memory_order_relaxed);
         return;
     }
 
+    _misses.fetch_add(1, std::memory_order_relaxed);
+
+    // Shape directly at the end of the output so that we don't need an intermediate buffer
+    auto sizeBefore = out.size();
     auto writtenGlyphsLength =
-        _innerShaper->shape(unicodeText, length, font, isRightToLeft, letterSpacing, script, _tmp);
+        _innerShaper->shape(unicodeText, length, font, isRightToLeft, letterSpacing, script, out);
 
-    auto* writtenGlyphs = _tmp.data();
+    auto* writtenGlyphs = out.data() + sizeBefore;
 
     if (isRightToLeft) {
         std::reverse(writtenGlyphs, writtenGlyphs + writtenGlyphsLength);
     }
 
-    _cache.insert(cacheKey, writtenGlyphs, writtenGlyphsLength);
-    copyGlyphs(writtenGlyphs, writtenGlyphsLength, out);
-    _tmp.clear();
+    insertInCache(cacheKey, typeface.getPersistentId(), writtenGlyphs, writtenGlyphsLength);
+}
+
+WordCachingTextShaper::CacheShard& WordCachingTextShaper::getShard(const TextShaperCacheKey& key) {
+    // The low bits of the hash are used by the hash maps within the shards
+    return *_shards[(key.hash() >> 16) % _shards.size()];
+}
+
+WordCachingTextShaper::CacheLookupResult WordCachingTextShaper::findInCache(const TextShaperCacheKey& key,
+                                                                            const Typeface& typeface,
+                                                                            std::vector<ShapedGlyph>& out) {
+    auto& shard = getShard(key);
+    std::lock_guard<Valdi::Mutex> lock(shard.mutex);
+
+    auto cacheResult = shard.cache.find(key);
+    if (!cacheResult) {
+        // Remember the typefaces seen by the shard, so that only their first miss looks into the snapshot
+        auto typefaceId = typeface.getId();
+        if (shard.persistentIdByTypefaceId.find(typefaceId) != shard.persistentIdByTypefaceId.end()) {
+            return CacheLookupResult::Miss;
+        }
+        shard.persistentIdByTypefaceId[typefaceId] = typeface.getPersistentId();
+        return CacheLookupResult::MissOnNewTypeface;
+    }
+
+    // The glyphs are owned by the cache node, they need to be copied before releasing the lock
+    copyGlyphs(cacheResult.value().glyphs, cacheResult.value().length, out);
+    return CacheLookupResult::Hit;
+}
+
+void WordCachingTextShaper::insertInCache(const TextShaperCacheKey& key,
+                                          uint64_t typefacePersistentId,
+                                          const ShapedGlyph* glyphs,
+                                          size_t glyphsLength) {
+    auto& shard = getShard(key);
+    std::lock_guard<Valdi::Mutex> lock(shard.mutex);
+
+    shard.persistentIdByTypefaceId[static_cast<uint32_t>(key.fontId)] = typefacePersistentId;
+
+    // Another thread might have shaped the same word while we were not holding the lock
+    if (shard.cache.contains(key)) {
+        return;
+    }
+
+    auto sizeBefore = shard.cache.size();
+    shard.cache.insert(key, glyphs, glyphsLength);
+    auto evictedCount = sizeBefore + 1 - shard.cache.size();
+    if (evictedCount > 0) {
+        _evictions.fetch_add(evictedCount, std::memory_order_relaxed);
+    }
+}
+
+bool WordCachingTextShaper::restoreTypefaceFromSnapshot(const Typeface& typeface) {
+    // Misses don't take the snapshot lock once the snapshot has been fully consumed, or if none was loaded
+    if (!_hasPendingSnapshot.load(std::memory_order_acquire)) {
+        return false;
+    }
+
+    std::lock_guard<Valdi::Mutex> lock(_snapshotMutex);
+    if (!_pendingSnapshot) {
+        return false;
+    }
+
+    auto restoredEntries =
+        restoreTypefaceFromSnapshot(_pendingSnapshot.value(), typeface.getPersistentId(), typeface.getId());
+
+    if (_pendingSnapshot.value().empty()) {
+        _pendingSnapshot = std::nullopt;
+        _hasPendingSnapshot.store(false, std::memory_order_release);
+    }
+
+    return restoredEntries > 0;
+}
+
+size_t WordCachingTextShaper::restoreTypefaceFromSnapshot(TextShaperCacheSnapshot& snapshot,
+                                                          uint64_t typefacePersistentId,
+                                                          uint32_t typefaceId) {
+    return snapshot.consumeTypeface(
+        typefacePersistentId,
+        typefaceId,
+        [&](const TextShaperCacheKey& key, const ShapedGlyph* glyphs, size_t glyphsLength) {
+            insertInCache(key, typefacePersistentId, glyphs, glyphsLength);
+        });
+}
+
+Valdi::Result<Valdi::Void> WordCachingTextShaper::loadCacheSnapshot(const Valdi::BytesView& snapshot) {
+    if (_strategy == WordCachingTextShaperStrategy::DisableCache) {
+        return Valdi::Void();
+    }
+
+    auto parseResult = TextShaperCacheSnapshot::parse(snapshot);
+    if (!parseResult) {
+        return parseResult.moveError();
+    }
+
+    // Typefaces that were already looked up won't restore their entries on their next miss
+    Valdi::FlatMap<uint32_t, uint64_t> persistentIdByTypefaceId;
+    for (const auto& shard : _shards) {
+        std::lock_guard<Valdi::Mutex> lock(shard->mutex);
+        for (const auto& it : shard->persistentIdByTypefaceId) {
+            persistentIdByTypefaceId[it.first] = it.second;
+        }
+    }
+
+    std::lock_guard<Valdi::Mutex> lock(_snapshotMutex);
+    for (const auto& it : persistentIdByTypefaceId) {
+        restoreTypefaceFromSnapshot(parseResult.value(), it.second, it.first);
+    }
+
+    if (parseResult.value().empty()) {
+        _pendingSnapshot = std::nullopt;
+    } else {
+        _pendingSnapshot = parseResult.moveValue();
+    }
+    _hasPendingSnapshot.store(_pendingSnapshot.has_value(), std::memory_order_release);
+
+    return Valdi::Void();
+}
+
+Valdi::BytesView WordCachingTextShaper::makeCacheSnapshot() {
+    TextShaperCacheSnapshotBuilder builder;
+    std::vector<const TextShaperCache::Node*> nodes;
+
+    for (const auto& shard : _shards) {
+        std::lock_guard<Valdi::Mutex> lock(shard->mutex);
+        nodes.clear();
+        for (const auto& node : shard->cache) {
+            nodes.emplace_back(node.get());
+        }
+
+        // The cache lists the most recently used entries first, the snapshot wants them last
+        for (auto it = nodes.rbegin(); it != nodes.rend(); ++it) {
+            const auto& key = (*it)->key();
+            const auto& persistentId = shard->persistentIdByTypefaceId.find(static_cast<uint32_t>(key.fontId));
+            if (persistentId != shard->persistentIdByTypefaceId.end()) {
+                builder.append(persistentId->second, key, (*it)->value());
+            }
+        }
+    }
+
+    if (builder.size() == 0) {
+        return Valdi::BytesView();
+    }
+
+    return builder.build();
 }
 
 Ref<Font> WordCachingTextShaper::getUniformFont(const Ref<Typeface>& typeface) {
+    std::lock_guard<Valdi::Mutex> lock(_uniformFontsMutex);
     const auto& it = _uniformFonts.find(typeface->getId());
     if (it != _uniformFonts.end()) {
         return it->second;
@@ -199,9 +371,13 @@ ShapedGlyph WordCachingTextShaper::getSpaceGlyphForFont(FontId fontId, Font& fon
     auto text = static_cast<Character>(' ');
     auto cacheKey = TextShaperCacheKey(fontId, 0.0f, TextScript::common(), false, &text, 1);
 
-    auto cacheResult = _cache.find(cacheKey);
-    if (cacheResult && cacheResult.value().length == 1) {
-        return cacheResult.value().glyphs[0];
+    {
+        auto& shard = getShard(cacheKey);
+        std::lock_guard<Valdi::Mutex> lock(shard.mutex);
+        auto cacheResult = shard.cache.find(cacheKey);
+        if (cacheResult && cacheResult.value().length == 1) {
+            return cacheResult.value().glyphs[0];
+        }
     }
 
     auto spaceGlyphId = font.getSkValue().unicharToGlyph(static_cast<SkUnichar>(text));
@@ -215,7 +391,7 @@ ShapedGlyph WordCachingTextShaper::getSpaceGlyphForFont(FontId fontId, Font& fon
     glyph.advanceX = width;
     glyph.setCharacter(text, false);
 
-    _cache.insert(cacheKey, &glyph, 1);
+    insertInCache(cacheKey, font.typeface()->getPersistentId(), &glyph, 1);
 
     return glyph;
 }
@@ -9,15 +9,31 @@
 
 #include "snap_drawing/cpp/Text/TextShaper.hpp"
 #include "snap_drawing/cpp/Text/TextShaperCache.hpp"
+#include "snap_drawing/cpp/Text/TextShaperCacheSnapshot.hpp"
 #include "valdi_core/cpp/Utils/FlatMap.hpp"
+#include "valdi_core/cpp/Utils/Mutex.hpp"
+
+#include <atomic>
+#include <memory>
+#include <optional>
+#include <vector>
 
 namespace snap::drawing {
 
 enum class WordCachingTextShaperStrategy { DisableCache, PrioritizeCacheHit, PrioritizeCorrectness };
 
+struct WordCachingTextShaperStats {
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t evictions = 0;
+};
+
 /**
  * A TextShaper implementation that breaks down shaping by words and use a cache.
  * The given innerShaper will be used to shape the individual words on a cache miss.
+ * The cache is split into shards selected by the key hash, each with its own lock,
+ * so that text can be measured concurrently from multiple threads. Shaping on a miss
+ * happens outside of the shard lock.
  */
 class WordCachingTextShaper : public TextShaper {
 public:
@@ -26,6 +42,9 @@ public:
 
     void clearCache() override;
 
+    Valdi::Result<Valdi::Void> loadCacheSnapshot(const Valdi::BytesView& snapshot) override;
+    Valdi::BytesView makeCacheSnapshot() override;
+
     TextParagraphList resolveParagraphs(const Character* unicodeText, size_t length, bool isRightToLeft) override;
 
     size_t shape(const Character* unicodeText,
@@ -36,13 +55,34 @@ public:
                  TextScript script,
                  std::vector<ShapedGlyph>& out) override;
 
+    /**
+     * Returns the number of cache hits, misses and evictions since this shaper was created.
+     */
+    WordCachingTextShaperStats getStats() const;
+
 private:
-    Valdi::Mutex _mutex;
+    struct CacheShard {
+        Valdi::Mutex mutex;
+        TextShaperCache cache;
+        // Persistent ids of the typefaces which were looked up in this shard
+        Valdi::FlatMap<uint32_t, uint64_t> persistentIdByTypefaceId;
+
+        explicit CacheShard(size_t capacity);
+    };
+
+    enum class CacheLookupResult { Hit, Miss, MissOnNewTypeface };
+
     Ref<TextShaper> _innerShaper;
-    TextShaperCache _cache;
+    std::vector<std::unique_ptr<CacheShard>> _shards;
     WordCachingTextShaperStrategy _strategy;
+    Valdi::Mutex _uniformFontsMutex;
     Valdi::FlatMap<uint32_t, Ref<Font>> _uniformFonts;
-    std::vector<ShapedGlyph> _tmp;
+    Valdi::Mutex _snapshotMutex;
+    std::optional<TextShaperCacheSnapshot> _pendingSnapshot;
+    std::atomic<bool> _hasPendingSnapshot = false;
+    std::atomic<uint64_t> _hits = 0;
+    std::atomic<uint64_t> _misses = 0;
+    std::atomic<uint64_t> _evictions = 0;
 
     size_t shapeUsingUniformFont(const Character* unicodeText,
                                  size_t length,
@@ -71,8 +111,22 @@ private:
 
     ShapedGlyph getSpaceGlyphForFont(FontId fontId, Font& font);
 
+    CacheShard& getShard(const TextShaperCacheKey& key);
+    CacheLookupResult findInCache(const TextShaperCacheKey& key,
+                                  const Typeface& typeface,
+                                  std::vector<ShapedGlyph>& out);
+    void insertInCache(const TextShaperCacheKey& key,
+                       uint64_t typefacePersistentId,
+                       const ShapedGlyph* glyphs,
+                       size_t glyphsLength);
+
     Ref<Font> getUniformFont(const Ref<Typeface>& typeface);
 
+    bool restoreTypefaceFromSnapshot(const Typeface& typeface);
+    size_t restoreTypefaceFromSnapshot(TextShaperCacheSnapshot& snapshot,
+                                       uint64_t typefacePersistentId,
+                                       uint32_t typefaceId);
+
     static void copyGlyphs(const ShapedGlyph* glyphs, size_t length, std::vector<ShapedGlyph>& out);
 };
 
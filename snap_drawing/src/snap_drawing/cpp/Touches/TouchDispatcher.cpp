@@ -9,6 +9,8 @@
 
 #include "valdi_core/cpp/Utils/LoggerUtils.hpp"
 
+#include <algorithm>
+
 namespace snap::drawing {
 
 #define TOUCHDISPATCHER_DEBUG(____format, ...)                                                                         \
@@ -41,7 +43,9 @@ void TouchDispatcher::cancelAllGestures() {
     }
 }
 
-bool TouchDispatcher::dispatchEvent(const TouchEvent& event, const Valdi::Ref<Layer>& rootLayer) {
+bool TouchDispatcher::dispatchEvent(const TouchEvent& event,
+                                    const Valdi::Ref<Layer>& rootLayer,
+                                    TouchHitTestIndex* hitTestIndex) {
     _dispatchingEvent = true;
     _lastEvent = event;
     TOUCHDISPATCHER_DEBUG("Dispatching event '{}'", event);
@@ -50,7 +54,7 @@ bool TouchDispatcher::dispatchEvent(const TouchEvent& event, const Valdi::Ref<La
         // Step 1, we capture all the layers and their gesture recognizers which are within the event's target.
         // We only do this on touch down.
         [[maybe_unused]] auto sizeBefore = _candidateGestureRecognizers.size();
-        captureCandidates(event, rootLayer, _candidateGestureRecognizers);
+        captureCandidates(event, rootLayer, hitTestIndex, _candidateGestureRecognizers);
 
         if (_enableLogging) {
             TOUCHDISPATCHER_DEBUG("Captured {} new gestures candidates (total {})",
@@ -68,10 +72,10 @@ bool TouchDispatcher::dispatchEvent(const TouchEvent& event, const Valdi::Ref<La
 }
 
 std::vector<Valdi::Ref<GestureRecognizer>> TouchDispatcher::getGestureCandidatesForEvent(
-    const TouchEvent& event, const Valdi::Ref<Layer>& rootLayer) const {
+    const TouchEvent& event, const Valdi::Ref<Layer>& rootLayer, TouchHitTestIndex* hitTestIndex) const {
     std::vector<Valdi::Ref<GestureRecognizer>> candidateGestures;
 
-    captureCandidates(event, rootLayer, candidateGestures);
+    captureCandidates(event, rootLayer, hitTestIndex, candidateGestures);
 
     return candidateGestures;
 }
@@ -82,6 +86,30 @@ bool TouchDispatcher::containsGestureRecognizer(const Valdi::Ref<GestureRecogniz
            gestureRecognizers.end();
 }
 
+void TouchDispatcher::captureCandidates(const TouchEvent& event,
+                                        const Valdi::Ref<Layer>& rootLayer,
+                                        TouchHitTestIndex* hitTestIndex,
+                                        std::vector<Valdi::Ref<GestureRecognizer>>& candidateGestureRecognizers) const {
+    if (hitTestIndex == nullptr) {
+        captureCandidates(event, rootLayer, candidateGestureRecognizers);
+        return;
+    }
+
+    if (hitTestIndex->needsUpdate(rootLayer)) {
+        hitTestIndex->update(rootLayer);
+    }
+
+    if (hitTestIndex->isEmpty()) {
+        return;
+    }
+
+    std::vector<size_t> hitEntries;
+    hitTestIndex->search(event.getLocation(), hitEntries);
+
+    // The root layer is always the first entry
+    captureIndexedCandidates(event, *hitTestIndex, hitEntries, 0, candidateGestureRecognizers);
+}
+
 bool TouchDispatcher::captureCandidates(const TouchEvent& event,
                                         const Valdi::Ref<Layer>& layer,
                                         std::vector<Valdi::Ref<GestureRecognizer>>& candidateGestureRecognizers) const {
@@ -89,23 +117,7 @@ bool TouchDispatcher::captureCandidates(const TouchEvent& event,
         return false;
     }
 
-    size_t gestureRecognizerSize = layer->getGestureRecognizersSize();
-    for (size_t i = 0; i < gestureRecognizerSize; i++) {
-        auto gestureRecognizer = layer->getGestureRecognizer(i);
-        if (!containsGestureRecognizer(gestureRecognizer, candidateGestureRecognizers)) {
-            if (gestureRecognizer->shouldProcessBeforeOtherGestures()) {
-                size_t insertionIndex = 0;
-                while (insertionIndex < candidateGestureRecognizers.size() &&
-                       candidateGestureRecognizers[i]->shouldProcessBeforeOtherGestures()) {
-                    insertionIndex++;
-                }
-                candidateGestureRecognizers.emplace(candidateGestureRecognizers.begin() + insertionIndex,
-                                                    std::move(gestureRecognizer));
-            } else {
-                candidateGestureRecognizers.emplace_back(std::move(gestureRecognizer));
-            }
-        }
-    }
+    captureGestureRecognizers(layer, candidateGestureRecognizers);
 
     // Dispatch touches to children, starting from the last child.
     auto i = layer->getChildrenSize();
@@ -125,6 +137,66 @@ bool TouchDispatcher::captureCandidates(const TouchEvent& event,
     return true;
 }
 
+bool TouchDispatcher::captureIndexedCandidates(
+    const TouchEvent& event,
+    const TouchHitTestIndex& hitTestIndex,
+    const std::vector<size_t>& hitEntries,
+    size_t entryIndex,
+    std::vector<Valdi::Ref<GestureRecognizer>>& candidateGestureRecognizers) const {
+    const auto& layer = hitTestIndex.getEntry(entryIndex).layer;
+    if (!layer->hitTest(event.getLocation())) {
+        return false;
+    }
+
+    captureGestureRecognizers(layer, candidateGestureRecognizers);
+
+    // The hit entries are sorted by parent and from the last child to the first, so that the children
+    // which can be hit are visited in the same order as captureCandidates() would.
+    auto childrenBegin =
+        std::lower_bound(hitEntries.begin(), hitEntries.end(), entryIndex, [&](size_t hitEntry, size_t parentIndex) {
+            return hitTestIndex.getEntry(hitEntry).parentIndex < parentIndex;
+        });
+    auto childrenEnd =
+        std::upper_bound(childrenBegin, hitEntries.end(), entryIndex, [&](size_t parentIndex, size_t hitEntry) {
+            return parentIndex < hitTestIndex.getEntry(hitEntry).parentIndex;
+        });
+
+    for (auto it = childrenBegin; it != childrenEnd; it++) {
+        const auto& child = hitTestIndex.getEntry(*it).layer;
+
+        auto childPoint = child->convertPointFromParent(event.getLocation());
+
+        if (captureIndexedCandidates(
+                event.withLocation(childPoint), hitTestIndex, hitEntries, *it, candidateGestureRecognizers)) {
+            // Among siblings, we only capture the first sibling which is hit.
+            break;
+        }
+    }
+
+    return true;
+}
+
+void TouchDispatcher::captureGestureRecognizers(
+    const Valdi::Ref<Layer>& layer, std::vector<Valdi::Ref<GestureRecognizer>>& candidateGestureRecognizers) {
+    size_t gestureRecognizerSize = layer->getGestureRecognizersSize();
+    for (size_t i = 0; i < gestureRecognizerSize; i++) {
+        auto gestureRecognizer = layer->getGestureRecognizer(i);
+        if (!containsGestureRecognizer(gestureRecognizer, candidateGestureRecognizers)) {
+            if (gestureRecognizer->shouldProcessBeforeOtherGestures()) {
+                size_t insertionIndex = 0;
+                while (insertionIndex < candidateGestureRecognizers.size() &&
+                       candidateGestureRecognizers[i]->shouldProcessBeforeOtherGestures()) {
+                    insertionIndex++;
+                }
+                candidateGestureRecognizers.emplace(candidateGestureRecognizers.begin() + insertionIndex,
+                                                    std::move(gestureRecognizer));
+            } else {
+                candidateGestureRecognizers.emplace_back(std::move(gestureRecognizer));
+            }
+        }
+    }
+}
+
 bool TouchDispatcher::processGestureRecognizers(const Valdi::Ref<Layer>& rootLayer) {
     if (!_lastEvent) {
         return false;
@@ -10,6 +10,7 @@
 #include "snap_drawing/cpp/Layers/Layer.hpp"
 #include "snap_drawing/cpp/Touches/GestureRecognizer.hpp"
 #include "snap_drawing/cpp/Touches/TouchEvent.hpp"
+#include "snap_drawing/cpp/Touches/TouchHitTestIndex.hpp"
 
 #include "valdi_core/cpp/Interfaces/ILogger.hpp"
 
@@ -24,12 +25,19 @@ public:
 
     void cancelAllGestures();
 
-    bool dispatchEvent(const TouchEvent& event, const Valdi::Ref<Layer>& rootLayer);
+    /**
+     Dispatch the event to the gesture recognizers of the given layer tree.
+     When a hit test index is given, it is used to find the layers which are hit by the event
+     instead of visiting every layer of the tree. The index is updated if needed.
+     */
+    bool dispatchEvent(const TouchEvent& event,
+                       const Valdi::Ref<Layer>& rootLayer,
+                       TouchHitTestIndex* hitTestIndex = nullptr);
 
     bool isDispatchingEvent() const;
 
-    std::vector<Valdi::Ref<GestureRecognizer>> getGestureCandidatesForEvent(const TouchEvent& event,
-                                                                            const Valdi::Ref<Layer>& rootLayer) const;
+    std::vector<Valdi::Ref<GestureRecognizer>> getGestureCandidatesForEvent(
+        const TouchEvent& event, const Valdi::Ref<Layer>& rootLayer, TouchHitTestIndex* hitTestIndex = nullptr) const;
 
     bool isEmpty() const;
 
@@ -43,10 +51,24 @@ private:
     bool _dispatchingEvent = false;
     bool _enableLogging = false;
 
+    void captureCandidates(const TouchEvent& event,
+                           const Valdi::Ref<Layer>& rootLayer,
+                           TouchHitTestIndex* hitTestIndex,
+                           std::vector<Valdi::Ref<GestureRecognizer>>& candidateGestureRecognizers) const;
+
     bool captureCandidates(const TouchEvent& event,
                            const Valdi::Ref<Layer>& layer,
                            std::vector<Valdi::Ref<GestureRecognizer>>& candidateGestureRecognizers) const;
 
+    bool captureIndexedCandidates(const TouchEvent& event,
+                                  const TouchHitTestIndex& hitTestIndex,
+                                  const std::vector<size_t>& hitEntries,
+                                  size_t entryIndex,
+                                  std::vector<Valdi::Ref<GestureRecognizer>>& candidateGestureRecognizers) const;
+
+    static void captureGestureRecognizers(const Valdi::Ref<Layer>& layer,
+                                          std::vector<Valdi::Ref<GestureRecognizer>>& candidateGestureRecognizers);
+
     static bool containsGestureRecognizer(const Valdi::Ref<GestureRecognizer>& gestureRecognizer,
                                           const std::vector<Valdi::Ref<GestureRecognizer>>& gestureRecognizers);
 
@@ -0,0 +1,303 @@
+//
+//  TouchHitTestIndex.cpp
+//  snap_drawing
+//
+
+#include "snap_drawing/cpp/Touches/TouchHitTestIndex.hpp"
+#include "valdi_core/cpp/Utils/Trace.hpp"
+
+#include <algorithm>
+
+namespace snap::drawing {
+
+// Hit test bounds are computed by composing the transforms of the ancestors, whereas hitTest()
+// converts the location one layer at a time. Bounds are outset and searched with a small tolerance
+// to account for the rounding differences between the two, as hitTest() is the one deciding in the end.
+// This also keeps empty bounds, which hitTest() accepts on their edges, from being skipped by the R-tree.
+constexpr Scalar kSearchTolerance = 1;
+
+// Every updated layer adds one R-tree search to each hit test, past this number of updated layers
+// the R-tree is rebuilt instead.
+constexpr size_t kMaxUpdatedEntries = 16;
+
+Rect TouchHitTestIndex::Transform::mapRect(const Rect& rect) const {
+    auto left = rect.left * scaleX + translateX;
+    auto right = rect.right * scaleX + translateX;
+    auto top = rect.top * scaleY + translateY;
+    auto bottom = rect.bottom * scaleY + translateY;
+
+    return Rect::makeLTRB(std::min(left, right), std::min(top, bottom), std::max(left, right), std::max(top, bottom));
+}
+
+Point TouchHitTestIndex::Transform::mapPoint(const Point& point) const {
+    return Point::make(point.x * scaleX + translateX, point.y * scaleY + translateY);
+}
+
+TouchHitTestIndex::Transform TouchHitTestIndex::Transform::concat(const Transform& inner) const {
+    Transform transform;
+    transform.scaleX = scaleX * inner.scaleX;
+    transform.scaleY = scaleY * inner.scaleY;
+    transform.translateX = translateX + inner.translateX * scaleX;
+    transform.translateY = translateY + inner.translateY * scaleY;
+    return transform;
+}
+
+TouchHitTestIndex::Transform TouchHitTestIndex::Transform::concat(Layer& child) const {
+    auto origin = child.convertPointToParent(Point::make(0, 0));
+
+    Transform childTransform;
+    childTransform.scaleX = child.getScaleX();
+    childTransform.scaleY = child.getScaleY();
+    childTransform.translateX = origin.x;
+    childTransform.translateY = origin.y;
+
+    return concat(childTransform);
+}
+
+TouchHitTestIndex::Transform TouchHitTestIndex::Transform::invert() const {
+    Transform transform;
+    transform.scaleX = 1 / scaleX;
+    transform.scaleY = 1 / scaleY;
+    transform.translateX = -translateX / scaleX;
+    transform.translateY = -translateY / scaleY;
+    return transform;
+}
+
+bool TouchHitTestIndex::Transform::isInvertible() const {
+    return scaleX != 0 && scaleY != 0;
+}
+
+TouchHitTestIndex::TouchHitTestIndex() = default;
+TouchHitTestIndex::~TouchHitTestIndex() = default;
+
+void TouchHitTestIndex::setNeedsUpdate() {
+    // Layers removed from the tree should not be kept alive until the next update
+    clear();
+    _needsUpdate = true;
+}
+
+void TouchHitTestIndex::setLayerNeedsUpdate(const ILayer& layer) {
+    if (_needsUpdate ||
+        std::find(_pendingUpdatedLayers.begin(), _pendingUpdatedLayers.end(), &layer) != _pendingUpdatedLayers.end()) {
+        return;
+    }
+
+    if (_pendingUpdatedLayers.size() + _updatedEntries.size() >= kMaxUpdatedEntries) {
+        setNeedsUpdate();
+        return;
+    }
+
+    _pendingUpdatedLayers.emplace_back(&layer);
+}
+
+bool TouchHitTestIndex::needsUpdate(const Ref<Layer>& rootLayer) const {
+    return _needsUpdate || _rootLayer != rootLayer || !_pendingUpdatedLayers.empty();
+}
+
+void TouchHitTestIndex::update(const Ref<Layer>& rootLayer) {
+    if (!_needsUpdate && _rootLayer == rootLayer && applyPendingUpdates()) {
+        return;
+    }
+
+    rebuild(rootLayer);
+}
+
+void TouchHitTestIndex::rebuild(const Ref<Layer>& rootLayer) {
+    VALDI_TRACE("SnapDrawing.updateTouchHitTestIndex");
+
+    clear();
+    _needsUpdate = false;
+    _rootLayer = rootLayer;
+
+    if (rootLayer != nullptr) {
+        insertLayer(rootLayer, kNoParent, 0, Transform(), false);
+    }
+}
+
+void TouchHitTestIndex::clear() {
+    _rootLayer = nullptr;
+    _entries.clear();
+    _geometries.clear();
+    _entryIndexByLayer.clear();
+    _boundingBoxes.clear();
+    _boundingBoxEntries.clear();
+    _unboundedEntries.clear();
+    _updatedEntries.clear();
+    _pendingUpdatedLayers.clear();
+}
+
+bool TouchHitTestIndex::applyPendingUpdates() {
+    auto updatedEntriesChanged = false;
+    for (const auto* layer : _pendingUpdatedLayers) {
+        const auto& it = _entryIndexByLayer.find(layer);
+        if (it == _entryIndexByLayer.end()) {
+            // The layer cannot be hit, and neither can its children
+            continue;
+        }
+
+        auto entryIndex = it->second;
+        auto& geometry = _geometries[entryIndex];
+        if (geometry.unbounded) {
+            return false;
+        }
+
+        if (!geometry.updated) {
+            geometry.updated = true;
+            _updatedEntries.emplace_back(UpdatedEntry{entryIndex, Rect(), Transform()});
+            updatedEntriesChanged = true;
+        }
+    }
+    _pendingUpdatedLayers.clear();
+
+    if (_updatedEntries.size() > kMaxUpdatedEntries) {
+        return false;
+    }
+
+    if (updatedEntriesChanged) {
+        std::sort(_updatedEntries.begin(), _updatedEntries.end(), [](const auto& lhs, const auto& rhs) {
+            return lhs.entryIndex < rhs.entryIndex;
+        });
+
+        // Entries are stored in depth first order, so ancestors are visited before their descendants
+        // and the closest updated ancestor is the last one to be assigned.
+        for (size_t i = 0; i < _updatedEntries.size(); i++) {
+            auto entryIndex = _updatedEntries[i].entryIndex;
+            auto endIndex = _geometries[entryIndex].endIndex;
+            for (auto childIndex = entryIndex + 1; childIndex < endIndex; childIndex++) {
+                _geometries[childIndex].updatedAncestor = i;
+            }
+        }
+    }
+
+    // The transforms of all the updated entries are resolved again, since a change of a layer
+    // also changes the transform of its updated descendants.
+    for (auto& updatedEntry : _updatedEntries) {
+        auto transform = computeTransform(updatedEntry.entryIndex);
+        if (!transform.isInvertible()) {
+            return false;
+        }
+
+        const auto& geometry = _geometries[updatedEntry.entryIndex];
+        const auto& layer = _entries[updatedEntry.entryIndex].layer;
+        updatedEntry.bounds =
+            transform.mapRect(layer->getHitTestBounds()).withInsets(-kSearchTolerance, -kSearchTolerance);
+        updatedEntry.toIndexedTransform = geometry.transform.concat(transform.invert());
+    }
+
+    return true;
+}
+
+TouchHitTestIndex::Transform TouchHitTestIndex::computeTransform(size_t entryIndex) const {
+    if (entryIndex == 0) {
+        return Transform();
+    }
+
+    const auto& entry = _entries[entryIndex];
+    return computeTransform(entry.parentIndex).concat(*entry.layer);
+}
+
+void TouchHitTestIndex::insertLayer(const Ref<Layer>& layer,
+                                    size_t parentIndex,
+                                    size_t childIndex,
+                                    const Transform& transform,
+                                    bool unbounded) {
+    auto hasCustomHitTest = layer->hasCustomHitTest();
+    if (!hasCustomHitTest && (!layer->isTouchEnabled() || !layer->isVisible())) {
+        // hitTest() always fails for this layer, which means none of its children can be hit either
+        return;
+    }
+
+    auto entryIndex = _entries.size();
+    _entries.emplace_back(Entry{layer, parentIndex, childIndex});
+    _entryIndexByLayer[layer.get()] = entryIndex;
+
+    auto& geometry = _geometries.emplace_back();
+    geometry.transform = transform;
+    geometry.unbounded = unbounded;
+    geometry.hitAnywhere = unbounded || hasCustomHitTest;
+
+    if (geometry.hitAnywhere) {
+        _unboundedEntries.emplace_back(entryIndex);
+    } else {
+        auto bounds = transform.mapRect(layer->getHitTestBounds());
+        _boundingBoxes.insert(bounds.withInsets(-kSearchTolerance, -kSearchTolerance));
+        _boundingBoxEntries.emplace_back(entryIndex);
+    }
+
+    auto childrenSize = layer->getChildrenSize();
+    for (size_t i = 0; i < childrenSize; i++) {
+        auto child = layer->getChild(i);
+
+        // convertPointFromParent() resolves every location to the origin of a layer with a zero scale,
+        // so the layer and its children can be hit regardless of where the touch is.
+        auto childUnbounded = unbounded || child->getScaleX() == 0 || child->getScaleY() == 0;
+
+        insertLayer(child, entryIndex, i, transform.concat(*child), childUnbounded);
+    }
+
+    _geometries[entryIndex].endIndex = _entries.size();
+}
+
+bool TouchHitTestIndex::isEmpty() const {
+    return _entries.empty();
+}
+
+size_t TouchHitTestIndex::size() const {
+    return _entries.size();
+}
+
+const TouchHitTestIndex::Entry& TouchHitTestIndex::getEntry(size_t index) const {
+    return _entries[index];
+}
+
+void TouchHitTestIndex::searchBoundingBoxes(const Point& location,
+                                            size_t updatedAncestor,
+                                            std::vector<size_t>& output) {
+    _searchOutput.clear();
+    auto searchRect = Rect::makeXYWH(location.x, location.y, 0, 0).withInsets(-kSearchTolerance, -kSearchTolerance);
+    _boundingBoxes.search(searchRect, _searchOutput);
+
+    for (auto boundingBoxIndex : _searchOutput) {
+        auto entryIndex = _boundingBoxEntries[static_cast<size_t>(boundingBoxIndex)];
+        const auto& geometry = _geometries[entryIndex];
+        // Updated entries are matched against their current bounds instead
+        if (!geometry.updated && geometry.updatedAncestor == updatedAncestor) {
+            output.emplace_back(entryIndex);
+        }
+    }
+}
+
+void TouchHitTestIndex::search(const Point& location, std::vector<size_t>& output) {
+    output.clear();
+
+    if (_boundingBoxes.size() > 0) {
+        searchBoundingBoxes(location, kNoUpdatedEntry, output);
+
+        for (size_t i = 0; i < _updatedEntries.size(); i++) {
+            const auto& updatedEntry = _updatedEntries[i];
+            if (_geometries[updatedEntry.entryIndex].endIndex > updatedEntry.entryIndex + 1) {
+                // The children of the updated entry are still indexed with its previous transform
+                searchBoundingBoxes(updatedEntry.toIndexedTransform.mapPoint(location), i, output);
+            }
+        }
+    }
+
+    for (const auto& updatedEntry : _updatedEntries) {
+        if (!_geometries[updatedEntry.entryIndex].hitAnywhere && updatedEntry.bounds.contains(location)) {
+            output.emplace_back(updatedEntry.entryIndex);
+        }
+    }
+
+    output.insert(output.end(), _unboundedEntries.begin(), _unboundedEntries.end());
+
+    std::sort(output.begin(), output.end(), [&](size_t lhs, size_t rhs) {
+        const auto& leftEntry = _entries[lhs];
+        const auto& rightEntry = _entries[rhs];
+        if (leftEntry.parentIndex != rightEntry.parentIndex) {
+            return leftEntry.parentIndex < rightEntry.parentIndex;
+        }
+        return leftEntry.childIndex > rightEntry.childIndex;
+    });
+}
+
+} // namespace snap::drawing
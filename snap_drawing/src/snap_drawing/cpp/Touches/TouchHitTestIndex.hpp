@@ -0,0 +1,148 @@
+//
+//  TouchHitTestIndex.hpp
+//  snap_drawing
+//
+
+#pragma once
+
+#include "snap_drawing/cpp/Layers/Layer.hpp"
+#include "snap_drawing/cpp/Utils/BoundingBoxHierarchy.hpp"
+#include "snap_drawing/cpp/Utils/Geometry.hpp"
+
+#include "valdi_core/cpp/Utils/FlatMap.hpp"
+
+#include <cstddef>
+#include <limits>
+#include <vector>
+
+namespace snap::drawing {
+
+/**
+ TouchHitTestIndex keeps the hit test bounds of the layers of a tree, in the coordinates of the root layer,
+ inside an R-tree. It lets the TouchDispatcher find the few layers which can be hit at a given location
+ without calling hitTest() on every sibling along the way. Layers which cannot be hit, because they are
+ not touch enabled or not visible, are left out along with their children. Layers without gesture
+ recognizers are kept since they prevent their previous siblings from being hit.
+
+ The index is rebuilt lazily after setNeedsUpdate() was called, which the LayerRoot does whenever the set
+ of layers which can be hit changes. When only the geometry of a few layers changed, which the LayerRoot
+ reports through setLayerNeedsUpdate(), the R-tree is kept as is: the bounds of the updated layers are
+ searched separately, and their children are searched in the R-tree with the location mapped back to
+ the transform they were indexed with.
+ */
+class TouchHitTestIndex {
+public:
+    static constexpr size_t kNoParent = std::numeric_limits<size_t>::max();
+
+    struct Entry {
+        Ref<Layer> layer;
+        size_t parentIndex;
+        size_t childIndex;
+    };
+
+    TouchHitTestIndex();
+    ~TouchHitTestIndex();
+
+    /**
+     Mark the index as needing to be rebuilt, which should be called when a change in the tree
+     may change which layers can be hit. Releases the indexed layers until the next update.
+     */
+    void setNeedsUpdate();
+
+    /**
+     Mark the geometry of the given layer as changed, which includes the transform of its children.
+     */
+    void setLayerNeedsUpdate(const ILayer& layer);
+
+    /**
+     Returns whether the index needs to be updated before being used with the given root layer.
+     */
+    bool needsUpdate(const Ref<Layer>& rootLayer) const;
+
+    /**
+     Bring the index up to date with the given root layer, which updates the layers marked through
+     setLayerNeedsUpdate() if possible, or rebuilds the index otherwise.
+     */
+    void update(const Ref<Layer>& rootLayer);
+
+    bool isEmpty() const;
+    size_t size() const;
+
+    const Entry& getEntry(size_t index) const;
+
+    /**
+     Populates the output with the indexes of the entries whose hit test bounds may contain the given
+     location, in the coordinates of the root layer. The output is sorted by parent, and from the last
+     child to the first child within the same parent, which is the order in which touches are dispatched.
+     */
+    void search(const Point& location, std::vector<size_t>& output);
+
+private:
+    static constexpr size_t kNoUpdatedEntry = std::numeric_limits<size_t>::max();
+
+    struct Transform {
+        Scalar scaleX = 1;
+        Scalar scaleY = 1;
+        Scalar translateX = 0;
+        Scalar translateY = 0;
+
+        Rect mapRect(const Rect& rect) const;
+        Point mapPoint(const Point& point) const;
+        Transform concat(const Transform& inner) const;
+        Transform concat(Layer& child) const;
+        Transform invert() const;
+        bool isInvertible() const;
+    };
+
+    struct EntryGeometry {
+        // Transform of the layer when the R-tree was built
+        Transform transform;
+        // One past the index of the last entry of the subtree of this entry
+        size_t endIndex = 0;
+        // Index in _updatedEntries of the closest updated ancestor, whose transform applies to this entry
+        size_t updatedAncestor = kNoUpdatedEntry;
+        // Whether a zero scale of an ancestor makes the layer hit at any location
+        bool unbounded = false;
+        // Whether the layer is returned by every search, which includes layers with a custom hitTest()
+        bool hitAnywhere = false;
+        bool updated = false;
+    };
+
+    struct UpdatedEntry {
+        size_t entryIndex;
+        // Hit test bounds of the updated layer, in the coordinates of the root layer
+        Rect bounds;
+        // Maps the coordinates of the root layer to the ones the children of the updated layer were indexed with
+        Transform toIndexedTransform;
+    };
+
+    Ref<Layer> _rootLayer;
+    std::vector<Entry> _entries;
+    std::vector<EntryGeometry> _geometries;
+    Valdi::FlatMap<const ILayer*, size_t> _entryIndexByLayer;
+    BoundingBoxHierarchy _boundingBoxes;
+    // Index of the entry for each box inserted in _boundingBoxes
+    std::vector<size_t> _boundingBoxEntries;
+    // Entries which can be hit anywhere, they are returned by every search
+    std::vector<size_t> _unboundedEntries;
+    // Entries whose geometry changed since the R-tree was built, sorted by entry index
+    std::vector<UpdatedEntry> _updatedEntries;
+    std::vector<const ILayer*> _pendingUpdatedLayers;
+    std::vector<int> _searchOutput;
+    bool _needsUpdate = true;
+
+    void clear();
+    void rebuild(const Ref<Layer>& rootLayer);
+    bool applyPendingUpdates();
+    Transform computeTransform(size_t entryIndex) const;
+
+    void insertLayer(const Ref<Layer>& layer,
+                     size_t parentIndex,
+                     size_t childIndex,
+                     const Transform& transform,
+                     bool unbounded);
+
+    void searchBoundingBoxes(const Point& location, size_t updatedAncestor, std::vector<size_t>& output);
+};
+
+} // namespace snap::drawing
@@ -1,7 +1,9 @@
 #include "snap_drawing/cpp/Utils/AnimatedImage.hpp"
 #include "include/codec/SkCodec.h"
+#include "include/core/SkCanvas.h"
 #include "snap_drawing/cpp/Drawing/DrawingContext.hpp"
 #include "snap_drawing/cpp/Drawing/Surface/DrawableSurfaceCanvas.hpp"
+#include "snap_drawing/cpp/Utils/AnimatedImageFrameCache.hpp"
 #include "snap_drawing/cpp/Utils/BytesUtils.hpp"
 #include "snap_drawing/cpp/Utils/Image.hpp"
 #include "snap_drawing/cpp/Utils/LottieAnimatedImage.hpp"
@@ -9,18 +11,99 @@
 #include "snap_drawing/cpp/Utils/SkCodecAnimatedImage.hpp"
 #include "valdi_core/cpp/Utils/JSONReader.hpp"
 
+#include <atomic>
+#include <cmath>
+
 namespace snap::drawing {
 
-AnimatedImage::AnimatedImage() = default;
+static uint64_t makeFrameCacheId() {
+    static std::atomic<uint64_t> kSequence = 0;
+    return ++kSequence;
+}
+
+AnimatedImage::AnimatedImage() : _frameCacheId(makeFrameCacheId()) {}
 AnimatedImage::~AnimatedImage() = default;
 
 void AnimatedImage::draw(SkCanvas* canvas,
                          const Rect& drawBounds,
                          const Duration& time,
-                         FittingSizeMode fittingSizeMode) {
+                         FittingSizeMode fittingSizeMode,
+                         AnimatedImageFrameCache* frameCache) {
+    if (frameCache != nullptr && drawCachedFrame(canvas, drawBounds, time, fittingSizeMode, *frameCache)) {
+        return;
+    }
     doDraw(canvas, drawBounds, time, fittingSizeMode);
 }
 
+bool AnimatedImage::drawCachedFrame(SkCanvas* canvas,
+                                    const Rect& drawBounds,
+                                    const Duration& time,
+                                    FittingSizeMode fittingSizeMode,
+                                    AnimatedImageFrameCache& frameCache) {
+    if (getFramesCount() == 0) {
+        return false;
+    }
+
+    // Frames are rasterized at the pixel size they are drawn at
+    auto scale = canvas->getTotalMatrix().getMaxScale();
+    if (scale <= 0) {
+        return false;
+    }
+
+    AnimatedImageFrameKey key;
+    key.imageId = _frameCacheId;
+    key.width = static_cast<int32_t>(std::ceil(drawBounds.width() * scale));
+    key.height = static_cast<int32_t>(std::ceil(drawBounds.height() * scale));
+    key.frameIndex = static_cast<uint32_t>(getFrameIndex(time));
+    key.fittingSizeMode = fittingSizeMode;
+
+    if (!frameCache.isCacheable(key.width, key.height)) {
+        return false;
+    }
+
+    auto frame = frameCache.find(key);
+    if (frame == nullptr) {
+        frame = renderFrame(key.frameIndex, key.width, key.height, fittingSizeMode);
+        if (frame == nullptr) {
+            return false;
+        }
+        frameCache.insert(key, frame);
+    }
+
+    canvas->drawImageRect(frame,
+                          drawBounds.getSkValue(),
+                          SkSamplingOptions(SkFilterMode::kLinear, SkMipmapMode::kNone),
+                          nullptr);
+    onDrawCachedFrame(time);
+
+    frameCache.prewarm(Valdi::strongSmallRef(this), key);
+
+    return true;
+}
+
+size_t AnimatedImage::getFramesCount() const {
+    return 0;
+}
+
+size_t AnimatedImage::getFrameIndex(const Duration& time) const {
+    auto framesCount = getFramesCount();
+    if (framesCount == 0) {
+        return 0;
+    }
+
+    auto frameIndex = static_cast<int64_t>(std::floor(time.seconds() * getFrameRate()));
+    return static_cast<size_t>(std::clamp(frameIndex, static_cast<int64_t>(0), static_cast<int64_t>(framesCount - 1)));
+}
+
+sk_sp<SkImage> AnimatedImage::renderFrame(size_t /*frameIndex*/,
+                                          int /*width*/,
+                                          int /*height*/,
+                                          FittingSizeMode /*fittingSizeMode*/) {
+    return nullptr;
+}
+
+void AnimatedImage::onDrawCachedFrame(const Duration& /*time*/) {}
+
 void AnimatedImage::drawInCanvas(const DrawableSurfaceCanvas& canvas,
                                  const Rect& drawBounds,
                                  const Duration& time,
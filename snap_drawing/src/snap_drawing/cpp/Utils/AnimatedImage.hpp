@@ -8,6 +8,8 @@
 
 #include "valdi_core/cpp/Utils/Result.hpp"
 
+#include "include/core/SkImage.h"
+
 class SkCanvas;
 
 namespace snap::drawing {
@@ -22,16 +24,23 @@ class Resources;
 class DrawableSurfaceCanvas;
 class DrawingContext;
 class IFontManager;
+class AnimatedImageFrameCache;
 
 class AnimatedImage : public Valdi::LoadedAsset {
 public:
     AnimatedImage();
     ~AnimatedImage() override;
 
+    /**
+     Draw the frame at the given time. When a frame cache is given and the image supports it,
+     the frame is rasterized once at the drawn pixel size and shared with the other draws
+     of this image that use the same cache.
+     */
     void draw(SkCanvas* canvas,
               const Rect& drawBounds,
               const Duration& time,
-              FittingSizeMode fittingSizeMode = snap::drawing::FittingSizeModeCenterScaleFit);
+              FittingSizeMode fittingSizeMode = snap::drawing::FittingSizeModeCenterScaleFit,
+              AnimatedImageFrameCache* frameCache = nullptr);
     void drawInCanvas(const DrawableSurfaceCanvas& canvas,
                       const Rect& drawBounds,
                       const Duration& time,
@@ -42,6 +51,23 @@ public:
     virtual const Size& getSize() const = 0;
     virtual double getFrameRate() const = 0;
 
+    /**
+     Returns the number of distinct frames of the image, or 0 if the image cannot
+     be drawn from an AnimatedImageFrameCache.
+     */
+    virtual size_t getFramesCount() const;
+
+    /**
+     Returns the index of the frame displayed at the given time.
+     */
+    virtual size_t getFrameIndex(const Duration& time) const;
+
+    /**
+     Rasterize the frame at the given index into an image of the given pixel size.
+     Can be called from any thread.
+     */
+    virtual sk_sp<SkImage> renderFrame(size_t frameIndex, int width, int height, FittingSizeMode fittingSizeMode);
+
     static Valdi::Result<Ref<AnimatedImage>> make(const Ref<IFontManager>& fontManager,
                                                   const Valdi::Byte* data,
                                                   size_t length);
@@ -52,7 +78,20 @@ protected:
                         const Duration& time,
                         FittingSizeMode fittingSizeMode) = 0;
 
+    /**
+     Called when the frame at the given time was drawn from the frame cache instead of doDraw().
+     */
+    virtual void onDrawCachedFrame(const Duration& time);
+
 private:
+    uint64_t _frameCacheId;
+
+    bool drawCachedFrame(SkCanvas* canvas,
+                         const Rect& drawBounds,
+                         const Duration& time,
+                         FittingSizeMode fittingSizeMode,
+                         AnimatedImageFrameCache& frameCache);
+
     static bool isJsonObject(const Valdi::Byte* data, size_t length);
 };
 
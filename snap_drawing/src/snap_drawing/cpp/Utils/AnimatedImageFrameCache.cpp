@@ -0,0 +1,172 @@
+//
+//  AnimatedImageFrameCache.cpp
+//  snap_drawing
+//
+
+#include "snap_drawing/cpp/Utils/AnimatedImageFrameCache.hpp"
+#include "snap_drawing/cpp/Utils/AnimatedImage.hpp"
+#include "valdi_core/cpp/Threading/DispatchQueue.hpp"
+
+#include <algorithm>
+#include <limits>
+#include <vector>
+
+namespace snap::drawing {
+
+// Frames larger than this fraction of the budget are not cached, as they would evict most other frames
+constexpr size_t kMaxFrameBytesDivisor = 8;
+
+static size_t getFrameBytesLength(int32_t width, int32_t height) {
+    return static_cast<size_t>(width) * static_cast<size_t>(height) * 4;
+}
+
+bool AnimatedImageFrameKey::operator==(const AnimatedImageFrameKey& other) const {
+    return imageId == other.imageId && width == other.width && height == other.height &&
+           frameIndex == other.frameIndex && fittingSizeMode == other.fittingSizeMode;
+}
+
+bool AnimatedImageFrameKey::operator!=(const AnimatedImageFrameKey& other) const {
+    return !(*this == other);
+}
+
+AnimatedImageFrameCache::AnimatedImageFrameCache(size_t maxBytes, const Ref<Valdi::DispatchQueue>& prewarmQueue)
+    : _entries(std::numeric_limits<size_t>::max()), _prewarmQueue(prewarmQueue), _maxBytes(maxBytes) {}
+
+AnimatedImageFrameCache::~AnimatedImageFrameCache() = default;
+
+sk_sp<SkImage> AnimatedImageFrameCache::find(const AnimatedImageFrameKey& key) {
+    std::lock_guard<Valdi::Mutex> lock(_mutex);
+    const auto& it = _entries.find(key);
+    if (it == _entries.end()) {
+        _stats.misses++;
+        return nullptr;
+    }
+
+    _stats.hits++;
+    return it->value().frame;
+}
+
+void AnimatedImageFrameCache::insert(const AnimatedImageFrameKey& key, const sk_sp<SkImage>& frame) {
+    if (frame == nullptr) {
+        return;
+    }
+
+    Entry entry;
+    entry.frame = frame;
+    entry.bytesLength = getFrameBytesLength(frame->width(), frame->height());
+
+    std::lock_guard<Valdi::Mutex> lock(_mutex);
+    const auto& it = _entries.find(key);
+    if (it != _entries.end()) {
+        _stats.framesCount--;
+        _stats.bytesUsed -= it->value().bytesLength;
+    }
+
+    _stats.framesCount++;
+    _stats.bytesUsed += entry.bytesLength;
+    _entries.insert(std::make_pair(key, std::move(entry)));
+
+    evictIfNeeded();
+}
+
+bool AnimatedImageFrameCache::isCacheable(int32_t width, int32_t height) const {
+    if (width <= 0 || height <= 0) {
+        return false;
+    }
+
+    std::lock_guard<Valdi::Mutex> lock(_mutex);
+    return getFrameBytesLength(width, height) <= _maxBytes / kMaxFrameBytesDivisor;
+}
+
+void AnimatedImageFrameCache::prewarm(const Ref<AnimatedImage>& image, const AnimatedImageFrameKey& key) {
+    if (_prewarmQueue == nullptr) {
+        return;
+    }
+
+    auto framesCount = image->getFramesCount();
+    if (framesCount <= 1) {
+        return;
+    }
+
+    std::vector<AnimatedImageFrameKey> keysToRender;
+    {
+        std::lock_guard<Valdi::Mutex> lock(_mutex);
+        auto prewarmFramesCount = std::min(_prewarmFramesCount, framesCount - 1);
+        for (size_t i = 1; i <= prewarmFramesCount; i++) {
+            auto nextKey = key;
+            nextKey.frameIndex = static_cast<uint32_t>((key.frameIndex + i) % framesCount);
+            if (_entries.contains(nextKey) || _pendingKeys.find(nextKey) != _pendingKeys.end()) {
+                continue;
+            }
+            _pendingKeys.insert(nextKey);
+            keysToRender.emplace_back(nextKey);
+        }
+    }
+
+    for (const auto& keyToRender : keysToRender) {
+        _prewarmQueue->async([weakSelf = Valdi::weakRef(this), image, keyToRender]() {
+            if (auto strongSelf = weakSelf.lock()) {
+                strongSelf->renderPendingFrame(image, keyToRender);
+            }
+        });
+    }
+}
+
+void AnimatedImageFrameCache::renderPendingFrame(const Ref<AnimatedImage>& image, const AnimatedImageFrameKey& key) {
+    auto frame = image->renderFrame(key.frameIndex, key.width, key.height, key.fittingSizeMode);
+    insert(key, frame);
+
+    std::lock_guard<Valdi::Mutex> lock(_mutex);
+    _pendingKeys.erase(key);
+}
+
+void AnimatedImageFrameCache::setPrewarmFramesCount(size_t prewarmFramesCount) {
+    std::lock_guard<Valdi::Mutex> lock(_mutex);
+    _prewarmFramesCount = prewarmFramesCount;
+}
+
+void AnimatedImageFrameCache::setMaxBytes(size_t maxBytes) {
+    std::lock_guard<Valdi::Mutex> lock(_mutex);
+    _maxBytes = maxBytes;
+    evictIfNeeded();
+}
+
+void AnimatedImageFrameCache::clear() {
+    std::lock_guard<Valdi::Mutex> lock(_mutex);
+    _entries.clear();
+    _stats.framesCount = 0;
+    _stats.bytesUsed = 0;
+}
+
+AnimatedImageFrameCacheStats AnimatedImageFrameCache::getStats() const {
+    std::lock_guard<Valdi::Mutex> lock(_mutex);
+    return _stats;
+}
+
+void AnimatedImageFrameCache::evictIfNeeded() {
+    while (_stats.bytesUsed > _maxBytes && !_entries.empty()) {
+        auto key = _entries.last()->key();
+        _stats.framesCount--;
+        _stats.bytesUsed -= _entries.last()->value().bytesLength;
+        _stats.evictions++;
+        _entries.remove(key);
+    }
+}
+
+} // namespace snap::drawing
+
+namespace std {
+
+std::size_t hash<snap::drawing::AnimatedImageFrameKey>::operator()(
+    const snap::drawing::AnimatedImageFrameKey& k) const noexcept {
+    auto hash = std::hash<uint64_t>()(k.imageId);
+    hash ^= std::hash<uint64_t>()((static_cast<uint64_t>(static_cast<uint32_t>(k.width)) << 32) |
+                                  static_cast<uint64_t>(static_cast<uint32_t>(k.height))) +
+            0x9e3779b9 + (hash << 6) + (hash >> 2);
+    hash ^= std::hash<uint64_t>()((static_cast<uint64_t>(k.frameIndex) << 8) |
+                                  static_cast<uint64_t>(k.fittingSizeMode)) +
+            0x9e3779b9 + (hash << 6) + (hash >> 2);
+    return hash;
+}
+
+} // namespace std
@@ -0,0 +1,117 @@
+//
+//  AnimatedImageFrameCache.hpp
+//  snap_drawing
+//
+
+#pragma once
+
+#include "snap_drawing/cpp/Utils/Aliases.hpp"
+#include "snap_drawing/cpp/Utils/Geometry.hpp"
+
+#include "valdi_core/cpp/Utils/FlatSet.hpp"
+#include "valdi_core/cpp/Utils/LRUCache.hpp"
+#include "valdi_core/cpp/Utils/Mutex.hpp"
+#include "valdi_core/cpp/Utils/Shared.hpp"
+
+#include "include/core/SkImage.h"
+
+#include <cstdint>
+
+namespace Valdi {
+class DispatchQueue;
+}
+
+namespace snap::drawing {
+
+class AnimatedImage;
+
+struct AnimatedImageFrameKey {
+    uint64_t imageId = 0;
+    int32_t width = 0;
+    int32_t height = 0;
+    uint32_t frameIndex = 0;
+    FittingSizeMode fittingSizeMode = FittingSizeModeCenterScaleFit;
+
+    bool operator==(const AnimatedImageFrameKey& other) const;
+    bool operator!=(const AnimatedImageFrameKey& other) const;
+};
+
+struct AnimatedImageFrameCacheStats {
+    size_t hits = 0;
+    size_t misses = 0;
+    size_t evictions = 0;
+    size_t framesCount = 0;
+    size_t bytesUsed = 0;
+};
+
+} // namespace snap::drawing
+
+namespace std {
+
+template<>
+struct hash<snap::drawing::AnimatedImageFrameKey> {
+    std::size_t operator()(const snap::drawing::AnimatedImageFrameKey& k) const noexcept;
+};
+
+} // namespace std
+
+namespace snap::drawing {
+
+/**
+AnimatedImageFrameCache holds rasterized frames of animated images, keyed by image, pixel size and frame
+index. A single cache is shared by all the AnimatedImage instances drawn with it, so that an animated image
+displayed by many layers at the same size is only rendered once per frame. Frames are evicted least
+recently used first once the cached frames exceed the byte budget.
+When given a prewarm queue, the cache renders the few frames following a drawn frame on that queue ahead
+of time, so that drawing the next frames only needs to blit the cached frame.
+ */
+class AnimatedImageFrameCache : public Valdi::SimpleRefCountable {
+public:
+    static constexpr size_t kDefaultMaxBytes = 32 * 1024 * 1024;
+    static constexpr size_t kDefaultPrewarmFramesCount = 3;
+
+    AnimatedImageFrameCache(size_t maxBytes, const Ref<Valdi::DispatchQueue>& prewarmQueue);
+    ~AnimatedImageFrameCache() override;
+
+    sk_sp<SkImage> find(const AnimatedImageFrameKey& key);
+    void insert(const AnimatedImageFrameKey& key, const sk_sp<SkImage>& frame);
+
+    /**
+     Returns whether frames of the given pixel size are small enough to be cached.
+     */
+    bool isCacheable(int32_t width, int32_t height) const;
+
+    /**
+     Schedule the rendering of the frames following the frame of the given key, which are not already cached,
+     on the prewarm queue. Does nothing if the cache has no prewarm queue.
+     */
+    void prewarm(const Ref<AnimatedImage>& image, const AnimatedImageFrameKey& key);
+
+    void setPrewarmFramesCount(size_t prewarmFramesCount);
+
+    void setMaxBytes(size_t maxBytes);
+
+    void clear();
+
+    AnimatedImageFrameCacheStats getStats() const;
+
+private:
+    struct Entry {
+        sk_sp<SkImage> frame;
+        size_t bytesLength = 0;
+    };
+
+    mutable Valdi::Mutex _mutex;
+    // Bounded by _maxBytes rather than by the number of entries
+    Valdi::LRUCache<AnimatedImageFrameKey, Entry> _entries;
+    Valdi::FlatSet<AnimatedImageFrameKey> _pendingKeys;
+    Ref<Valdi::DispatchQueue> _prewarmQueue;
+    AnimatedImageFrameCacheStats _stats;
+    size_t _maxBytes;
+    size_t _prewarmFramesCount = kDefaultPrewarmFramesCount;
+
+    void renderPendingFrame(const Ref<AnimatedImage>& image, const AnimatedImageFrameKey& key);
+    void evictIfNeeded();
+};
+
+} // namespace snap::drawing
@@ -18,14 +18,18 @@ void BoundingBoxHierarchy::insert(const Rect& box) {
     _rTree = nullptr;
 }
 
-bool BoundingBoxHierarchy::contains(const Rect& box) {
+SkBBoxHierarchy& BoundingBoxHierarchy::getRTree() {
     if (_rTree == nullptr) {
         SkRTreeFactory factory;
         _rTree = factory();
         _rTree->insert(_frames.data(), static_cast<int>(_frames.size()));
     }
 
-    _rTree->search(box.getSkValue(), &_rTreeOutput);
+    return *_rTree;
+}
+
+bool BoundingBoxHierarchy::contains(const Rect& box) {
+    getRTree().search(box.getSkValue(), &_rTreeOutput);
     if (_rTreeOutput.empty()) {
         return false;
     } else {
@@ -34,4 +38,17 @@ bool BoundingBoxHierarchy::contains(const Rect& box) {
     }
 }
 
+void BoundingBoxHierarchy::search(const Rect& box, std::vector<int>& output) {
+    getRTree().search(box.getSkValue(), &output);
+}
+
+void BoundingBoxHierarchy::clear() {
+    _frames.clear();
+    _rTree = nullptr;
+}
+
+size_t BoundingBoxHierarchy::size() const {
+    return _frames.size();
+}
+
 } // namespace snap::drawing
@@ -26,10 +26,21 @@ public:
     void insert(const Rect& box);
     bool contains(const Rect& box);
 
+    /**
+     Appends to the output the insertion indexes of the boxes which intersect the given box.
+     */
+    void search(const Rect& box, std::vector<int>& output);
+
+    void clear();
+
+    size_t size() const;
+
 private:
     std::vector<SkRect> _frames;
     std::vector<int> _rTreeOutput;
     sk_sp<SkBBoxHierarchy> _rTree;
+
+    SkBBoxHierarchy& getRTree();
 };
 
 } // namespace snap::drawing
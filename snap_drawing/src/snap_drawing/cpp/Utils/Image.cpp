@@ -13,10 +13,13 @@
 #include "snap_drawing/cpp/Utils/SVGUtils.hpp"
 
 #include "valdi_core/cpp/Interfaces/IBitmap.hpp"
+#include "valdi_core/cpp/Utils/StringCache.hpp"
 #include "valdi_core/cpp/Utils/ValueTypedArray.hpp"
 
 #include "snap_drawing/cpp/Utils/BitmapUtils.hpp"
 
+#include "include/codec/SkAndroidCodec.h"
+#include "include/codec/SkCodec.h"
 #include "include/codec/SkEncodedImageFormat.h"
 #include "include/codec/SkGifDecoder.h"
 #include "include/codec/SkJpegDecoder.h"
@@ -186,6 +189,78 @@ Valdi::Result<Ref<Image>> Image::make(const Valdi::BytesView& data) {
     return Ref<Image>(Valdi::makeShared<Image>(skImage));
 }
 
+Valdi::Result<SubsampledImage> Image::makeSubsampled(const Valdi::BytesView& data,
+                                                     int preferredWidth,
+                                                     int preferredHeight) {
+    auto makeFullImage = [&]() -> Valdi::Result<SubsampledImage> {
+        auto image = make(data);
+        if (!image) {
+            return image.moveError();
+        }
+        auto width = image.value()->width();
+        auto height = image.value()->height();
+        return SubsampledImage{image.moveValue(), 1, width, height};
+    };
+
+    if (isSVG(data)) {
+        return makeFullImage();
+    }
+
+    Image::initializeCodecs();
+    auto skData = skDataFromBytes(data, DataConversionModeNeverCopy);
+    auto codec = SkAndroidCodec::MakeFromCodec(SkCodec::MakeFromData(skData));
+    if (codec == nullptr) {
+        return Valdi::Error("Unable to decode image");
+    }
+
+    auto sourceWidth = codec->getInfo().width();
+    auto sourceHeight = codec->getInfo().height();
+    auto sampleSize = computeSampleSize(sourceWidth, sourceHeight, preferredWidth, preferredHeight);
+
+    // Rotated images go through the regular decode, which applies the encoded origin
+    if (sampleSize == 1 || codec->codec()->getOrigin() != kTopLeft_SkEncodedOrigin) {
+        return makeFullImage();
+    }
+
+    auto imageInfo = codec->getInfo()
+                         .makeDimensions(codec->getSampledDimensions(sampleSize))
+                         .makeColorType(codec->computeOutputColorType(kN32_SkColorType))
+                         .makeAlphaType(codec->computeOutputAlphaType(false));
+
+    SkBitmap bitmap;
+    if (!bitmap.tryAllocPixels(imageInfo)) {
+        return Valdi::Error("Unable to allocate image");
+    }
+
+    SkAndroidCodec::AndroidOptions options;
+    options.fSampleSize = sampleSize;
+    auto result = codec->getAndroidPixels(imageInfo, bitmap.getPixels(), bitmap.rowBytes(), &options);
+    if (result != SkCodec::kSuccess && result != SkCodec::kIncompleteInput) {
+        return Valdi::Error(STRING_FORMAT("Unable to decode image: {}", SkCodec::ResultToString(result)));
+    }
+
+    bitmap.setImmutable();
+
+    auto image = Ref<Image>(Valdi::makeShared<Image>(SkImages::RasterFromBitmap(bitmap)));
+    return SubsampledImage{std::move(image), sampleSize, sourceWidth, sourceHeight};
+}
+
+int Image::computeSampleSize(int width, int height, int targetWidth, int targetHeight) {
+    const bool scaleOnWidth = targetWidth >= targetHeight;
+    const int referenceImageSize = scaleOnWidth ? width : height;
+    const int referenceTargetSize = scaleOnWidth ? targetWidth : targetHeight;
+
+    if (referenceTargetSize <= 0 || referenceTargetSize >= referenceImageSize) {
+        return 1;
+    }
+
+    int sampleSize = 1;
+    while (referenceImageSize / (sampleSize * 2) >= referenceTargetSize) {
+        sampleSize *= 2;
+    }
+    return sampleSize;
+}
+
 bool Image::isSVG(const Valdi::BytesView& data) {
     return snap::drawing::isSVG(data);
 }
@@ -22,6 +22,8 @@ namespace snap::drawing {
 
 enum EncodedImageFormat { EncodedImageFormatJPG, EncodedImageFormatPNG, EncodedImageFormatWebP };
 
+struct SubsampledImage;
+
 class Image : public Valdi::LoadedAsset {
 public:
     explicit Image(const sk_sp<SkImage>& skImage);
@@ -68,6 +70,23 @@ public:
      */
     static Valdi::Result<Ref<Image>> make(const Valdi::BytesView& data);
 
+    /**
+     Make an Image from bytes representing an encoded image, decoded at the reduced size given by
+     computeSampleSize() when the codec supports it. Large images displayed at a small size are
+     then never decoded at their full size. The image is decoded eagerly.
+     */
+    static Valdi::Result<SubsampledImage> makeSubsampled(const Valdi::BytesView& data,
+                                                         int preferredWidth,
+                                                         int preferredHeight);
+
+    /**
+     Returns the largest power of two by which an image of the given size can be downsampled
+     while staying at least as large as the target size on the reference axis. The reference
+     axis is the width when targetWidth >= targetHeight, the height otherwise.
+     Returns 1 when the target size is empty or not smaller than the image.
+     */
+    static int computeSampleSize(int width, int height, int targetWidth, int targetHeight);
+
     static bool isSVG(const Valdi::BytesView& data);
 
     static Valdi::Result<Ref<Image>> makeFromSVG(const Valdi::BytesView& data,
@@ -104,4 +123,13 @@ private:
                                                         const sk_sp<SkData>& pixelsData);
 };
 
+struct SubsampledImage {
+    Ref<Image> image;
+    // Factor by which the image was downsampled from the encoded image
+    int sampleSize = 1;
+    // Size of the encoded image
+    int sourceWidth = 0;
+    int sourceHeight = 0;
+};
+
 } // namespace snap::drawing
@@ -11,6 +11,10 @@
 #include "snap_drawing/cpp/Resources.hpp"
 #include "snap_drawing/cpp/Utils/AnimatedImage.hpp"
 
+#include "include/core/SkSurface.h"
+
+#include <cmath>
+
 namespace skresources {
 class DelegatedTypefaceResourceProvider : public ResourceProvider {
 public:
@@ -59,6 +63,15 @@ double LottieAnimatedImage::getFrameRate() const {
     return _frameRate;
 }
 
+size_t LottieAnimatedImage::getFramesCount() const {
+    return static_cast<size_t>(std::max(1.0, std::ceil(_duration.seconds() * _frameRate)));
+}
+
+void LottieAnimatedImage::onDrawCachedFrame(const Duration& time) {
+    std::lock_guard<Valdi::Mutex> lock(_mutex);
+    _currentTime = std::clamp(time, Duration(), _duration);
+}
+
 Valdi::Value LottieAnimatedImage::getMetadata() const {
     return Valdi::Value()
         .setMapValue("type", Valdi::Value(Valdi::StringBox::fromCString("lottie")))
@@ -89,6 +102,29 @@ void LottieAnimatedImage::doDraw(SkCanvas* canvas,
     _currentTime = std::clamp(time, Duration(), _duration);
     _animation->seekFrameTime(_currentTime.seconds());
 
+    render(canvas, drawBounds, fittingSizeMode);
+}
+
+sk_sp<SkImage> LottieAnimatedImage::renderFrame(size_t frameIndex,
+                                                int width,
+                                                int height,
+                                                FittingSizeMode fittingSizeMode) {
+    auto surface = SkSurfaces::Raster(SkImageInfo::MakeN32Premul(width, height));
+    if (surface == nullptr) {
+        return nullptr;
+    }
+    surface->getCanvas()->clear(SK_ColorTRANSPARENT);
+
+    std::lock_guard<Valdi::Mutex> lock(_mutex);
+    _animation->seekFrameTime(static_cast<double>(frameIndex) / _frameRate);
+    render(surface->getCanvas(),
+           Rect::makeXYWH(0, 0, static_cast<Scalar>(width), static_cast<Scalar>(height)),
+           fittingSizeMode);
+
+    return surface->makeImageSnapshot();
+}
+
+void LottieAnimatedImage::render(SkCanvas* canvas, const Rect& drawBounds, FittingSizeMode fittingSizeMode) {
     // If fittingSizeMode is fill need to apply transform since
     // Skottie does not render with 'fill' mode by default
     if (fittingSizeMode == FittingSizeModeFill) {
@@ -37,6 +37,9 @@ public:
     double getFrameRate() const override;
     Valdi::Value getMetadata() const override;
 
+    size_t getFramesCount() const override;
+    sk_sp<SkImage> renderFrame(size_t frameIndex, int width, int height, FittingSizeMode fittingSizeMode) override;
+
     static Valdi::Result<Ref<LottieAnimatedImage>> make(const Ref<Resources>& resources,
                                                         const Valdi::Byte* data,
                                                         size_t length);
@@ -53,6 +56,8 @@ protected:
                 const Duration& time,
                 FittingSizeMode fittingSizeMode) override;
 
+    void onDrawCachedFrame(const Duration& time) override;
+
 private:
     mutable Valdi::Mutex _mutex;
 #ifdef SNAP_DRAWING_LOTTIE_ENABLED
@@ -62,6 +67,10 @@ private:
     Duration _currentTime;
     Size _size;
     double _frameRate;
+
+#ifdef SNAP_DRAWING_LOTTIE_ENABLED
+    void render(SkCanvas* canvas, const Rect& drawBounds, FittingSizeMode fittingSizeMode);
+#endif
 };
 
 } // namespace snap::drawing
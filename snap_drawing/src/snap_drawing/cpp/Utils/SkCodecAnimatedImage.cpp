@@ -7,9 +7,12 @@
 
 #include "snap_drawing/cpp/Utils/SkCodecAnimatedImage.hpp"
 #include "include/core/SkCanvas.h"
+#include "include/core/SkSurface.h"
 #include "snap_drawing/cpp/Drawing/DrawingContext.hpp"
 #include "snap_drawing/cpp/Drawing/Surface/DrawableSurfaceCanvas.hpp"
 
+#include <algorithm>
+
 namespace snap::drawing {
 
 SkCodecAnimatedImage::~SkCodecAnimatedImage() = default;
@@ -33,17 +36,105 @@ double SkCodecAnimatedImage::getFrameRate() const {
 
 SkCodecAnimatedImage::SkCodecAnimatedImage(std::unique_ptr<SkCodec> codec)
     : _size(Size(codec->dimensions().width(), codec->dimensions().height())) {
-    SkImageInfo imageInfo = codec->getInfo().makeColorType(kN32_SkColorType);
+    _decodeInfo = codec->getInfo().makeColorType(kN32_SkColorType);
+    if (_decodeInfo.alphaType() == kUnpremul_SkAlphaType) {
+        _decodeInfo = _decodeInfo.makeAlphaType(kPremul_SkAlphaType);
+    }
     std::vector<SkCodec::FrameInfo> frameInfos = codec->getFrameInfo();
     const auto totalFrames = frameInfos.size();
     long totalAnimationDurationMs = 0u;
+    _frameStartTimesMs.reserve(totalFrames);
+    _requiredFrames.reserve(totalFrames);
     for (size_t i = 0; i < totalFrames; i++) {
+        _frameStartTimesMs.emplace_back(totalAnimationDurationMs);
+        _requiredFrames.emplace_back(frameInfos[i].fRequiredFrame);
         totalAnimationDurationMs += frameInfos[i].fDuration;
     }
     _numberOfFrames = totalFrames;
     _duration = Duration::fromMilliseconds(totalAnimationDurationMs);
     _frameRate = _frameRate = codec->getFrameCount() / _duration.seconds();
-    _player = std::make_unique<SkAnimCodecPlayer>(std::move(codec));
+    _codec = std::move(codec);
+}
+
+size_t SkCodecAnimatedImage::getFramesCount() const {
+    return _numberOfFrames;
+}
+
+size_t SkCodecAnimatedImage::getFrameIndex(const Duration& time) const {
+    if (_frameStartTimesMs.empty()) {
+        return 0;
+    }
+
+    auto timeMs = static_cast<int64_t>(std::clamp(time, Duration(), _duration).milliseconds());
+    auto it = std::upper_bound(_frameStartTimesMs.begin(), _frameStartTimesMs.end(), timeMs);
+    return it == _frameStartTimesMs.begin() ? 0 : static_cast<size_t>(it - _frameStartTimesMs.begin() - 1);
+}
+
+sk_sp<SkImage> SkCodecAnimatedImage::renderFrame(size_t frameIndex,
+                                                 int width,
+                                                 int height,
+                                                 FittingSizeMode /*fittingSizeMode*/) {
+    if (frameIndex >= _frameStartTimesMs.size()) {
+        return nullptr;
+    }
+
+    auto surface = SkSurfaces::Raster(SkImageInfo::MakeN32Premul(width, height));
+    if (surface == nullptr) {
+        return nullptr;
+    }
+    surface->getCanvas()->clear(SK_ColorTRANSPARENT);
+
+    std::lock_guard<Valdi::Mutex> lock(_mutex);
+    auto image = _player != nullptr ? getFrameFromPlayer(frameIndex) : decodeFrame(frameIndex);
+    if (image == nullptr) {
+        return nullptr;
+    }
+    surface->getCanvas()->drawImageRect(image,
+                                        SkRect::MakeWH(_size.width, _size.height),
+                                        SkRect::MakeIWH(width, height),
+                                        SkSamplingOptions(SkFilterMode::kLinear, SkMipmapMode::kNone),
+                                        nullptr,
+                                        SkCanvas::kStrict_SrcRectConstraint);
+
+    return surface->makeImageSnapshot();
+}
+
+sk_sp<SkImage> SkCodecAnimatedImage::getFrameFromPlayer(size_t frameIndex) {
+    _player->seek(static_cast<uint32_t>(_frameStartTimesMs[frameIndex]));
+    return _player->getFrame();
+}
+
+sk_sp<SkImage> SkCodecAnimatedImage::decodeFrame(size_t frameIndex) {
+    auto index = static_cast<int>(frameIndex);
+    if (_decodedFrameIndex != index) {
+        if (_decodeBitmap.isNull() && !_decodeBitmap.tryAllocPixels(_decodeInfo)) {
+            return nullptr;
+        }
+
+        SkCodec::Options options;
+        options.fFrameIndex = index;
+        // The bitmap can be decoded on top of the frame it holds if that frame leads to this one,
+        // otherwise the codec decodes the required frames first.
+        auto requiredFrame = _requiredFrames[frameIndex];
+        if (requiredFrame != SkCodec::kNoFrame && _decodedFrameIndex >= requiredFrame && _decodedFrameIndex < index) {
+            options.fPriorFrame = _decodedFrameIndex;
+        }
+
+        auto result = _codec->getPixels(_decodeBitmap.pixmap(), &options);
+        if (result != SkCodec::kSuccess && result != SkCodec::kIncompleteInput && result != SkCodec::kErrorInInput) {
+            _decodedFrameIndex = SkCodec::kNoFrame;
+            return nullptr;
+        }
+        _decodedFrameIndex = index;
+    }
+
+    // Only drawn while the lock is held, the pixels don't need to be copied
+    return SkImages::RasterFromPixmap(_decodeBitmap.pixmap(), nullptr, nullptr);
+}
+
+void SkCodecAnimatedImage::onDrawCachedFrame(const Duration& time) {
+    std::lock_guard<Valdi::Mutex> lock(_mutex);
+    _currentTime = std::clamp(time, Duration(), _duration);
 }
 
 Valdi::Value SkCodecAnimatedImage::getMetadata() const {
@@ -62,6 +153,12 @@ void SkCodecAnimatedImage::doDraw(SkCanvas* canvas,
     std::lock_guard<Valdi::Mutex> lock(_mutex);
     _currentTime = std::clamp(time, Duration(), _duration);
 
+    if (_player == nullptr) {
+        _player = std::make_unique<SkAnimCodecPlayer>(std::move(_codec));
+        _decodeBitmap.reset();
+        _decodedFrameIndex = SkCodec::kNoFrame;
+    }
+
     _player->seek(_currentTime.milliseconds());
     const auto& image = _player->getFrame();
     const SkRect srcR = SkRect::MakeWH(_size.width, _size.height);
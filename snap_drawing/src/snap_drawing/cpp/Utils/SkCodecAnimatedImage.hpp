@@ -19,9 +19,12 @@
 #include "valdi_core/cpp/Utils/Result.hpp"
 
 #include "include/codec/SkCodec.h"
+#include "include/core/SkBitmap.h"
 #include "modules/skottie/include/Skottie.h"
 #include "modules/skresources/src/SkAnimCodecPlayer.h"
 
+#include <vector>
+
 namespace snap::drawing {
 
 class Resources;
@@ -39,6 +42,10 @@ public:
     double getFrameRate() const override;
     Valdi::Value getMetadata() const override;
 
+    size_t getFramesCount() const override;
+    size_t getFrameIndex(const Duration& time) const override;
+    sk_sp<SkImage> renderFrame(size_t frameIndex, int width, int height, FittingSizeMode fittingSizeMode) override;
+
     static Valdi::Result<Ref<SkCodecAnimatedImage>> make(std::unique_ptr<SkCodec> codec);
 
     VALDI_CLASS_HEADER(SkCodecAnimatedImage)
@@ -49,14 +56,30 @@ protected:
                 const Duration& time,
                 FittingSizeMode fittingSizeMode) override;
 
+    void onDrawCachedFrame(const Duration& time) override;
+
 private:
     mutable Valdi::Mutex _mutex;
+    // Frames rendered for an AnimatedImageFrameCache are decoded from _codec one at a time, the cache keeps
+    // the rendered frames. The player, which keeps every decoded frame, takes over the codec the first time
+    // the image is drawn without the cache.
+    std::unique_ptr<SkCodec> _codec;
     std::unique_ptr<SkAnimCodecPlayer> _player;
+    SkImageInfo _decodeInfo;
+    SkBitmap _decodeBitmap;
+    int _decodedFrameIndex = SkCodec::kNoFrame;
+    // Frame that must be decoded before each frame, or SkCodec::kNoFrame
+    std::vector<int> _requiredFrames;
     Duration _duration;
     Duration _currentTime;
     Size _size;
     size_t _numberOfFrames = 0;
+    // Time at which each frame starts, in milliseconds
+    std::vector<int64_t> _frameStartTimesMs;
     double _frameRate;
+
+    sk_sp<SkImage> getFrameFromPlayer(size_t frameIndex);
+    sk_sp<SkImage> decodeFrame(size_t frameIndex);
 };
 
 } // namespace snap::drawing
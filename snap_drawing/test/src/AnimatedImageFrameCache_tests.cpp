@@ -0,0 +1,188 @@
+#include <gtest/gtest.h>
+
+#include "include/core/SkCanvas.h"
+#include "include/core/SkSurface.h"
+#include "snap_drawing/cpp/Utils/AnimatedImage.hpp"
+#include "snap_drawing/cpp/Utils/AnimatedImageFrameCache.hpp"
+#include "valdi_core/cpp/Threading/DispatchQueue.hpp"
+
+using namespace Valdi;
+
+namespace snap::drawing {
+
+class CountingAnimatedImage : public AnimatedImage {
+public:
+    std::atomic<size_t> renderedFramesCount = 0;
+    size_t drawCount = 0;
+
+    CountingAnimatedImage() = default;
+    ~CountingAnimatedImage() override = default;
+
+    Duration getCurrentTime() const override {
+        return Duration();
+    }
+
+    const Duration& getDuration() const override {
+        return _duration;
+    }
+
+    const Size& getSize() const override {
+        return _size;
+    }
+
+    double getFrameRate() const override {
+        return 10.0;
+    }
+
+    size_t getFramesCount() const override {
+        return 10;
+    }
+
+    sk_sp<SkImage> renderFrame(size_t /*frameIndex*/,
+                               int width,
+                               int height,
+                               FittingSizeMode /*fittingSizeMode*/) override {
+        renderedFramesCount++;
+        auto surface = SkSurfaces::Raster(SkImageInfo::MakeN32Premul(width, height));
+        return surface->makeImageSnapshot();
+    }
+
+    VALDI_CLASS_HEADER_IMPL(CountingAnimatedImage)
+
+protected:
+    void doDraw(SkCanvas* /*canvas*/,
+                const Rect& /*drawBounds*/,
+                const Duration& /*time*/,
+                FittingSizeMode /*fittingSizeMode*/) override {
+        drawCount++;
+    }
+
+private:
+    Duration _duration = Duration::fromSeconds(1.0);
+    Size _size = Size(20, 20);
+};
+
+static sk_sp<SkImage> makeFrame(int width, int height) {
+    return SkSurfaces::Raster(SkImageInfo::MakeN32Premul(width, height))->makeImageSnapshot();
+}
+
+static AnimatedImageFrameKey makeKey(uint64_t imageId, uint32_t frameIndex) {
+    AnimatedImageFrameKey key;
+    key.imageId = imageId;
+    key.width = 16;
+    key.height = 16;
+    key.frameIndex = frameIndex;
+    return key;
+}
+
+TEST(AnimatedImageFrameCache, evictsLeastRecentlyUsedFramesOverBudget) {
+    auto frameBytes = static_cast<size_t>(16 * 16 * 4);
+    auto cache = makeShared<AnimatedImageFrameCache>(frameBytes * 2, nullptr);
+
+    cache->insert(makeKey(1, 0), makeFrame(16, 16));
+    cache->insert(makeKey(1, 1), makeFrame(16, 16));
+    ASSERT_NE(nullptr, cache->find(makeKey(1, 0)));
+
+    cache->insert(makeKey(1, 2), makeFrame(16, 16));
+
+    ASSERT_NE(nullptr, cache->find(makeKey(1, 0)));
+    ASSERT_EQ(nullptr, cache->find(makeKey(1, 1)));
+    ASSERT_NE(nullptr, cache->find(makeKey(1, 2)));
+    // Frames of other images do not collide
+    ASSERT_EQ(nullptr, cache->find(makeKey(2, 0)));
+
+    auto stats = cache->getStats();
+    ASSERT_EQ(static_cast<size_t>(2), stats.framesCount);
+    ASSERT_EQ(frameBytes * 2, stats.bytesUsed);
+    ASSERT_EQ(static_cast<size_t>(1), stats.evictions);
+}
+
+TEST(AnimatedImageFrameCache, shrinkingBudgetKeepsMostRecentlyUsedFrames) {
+    auto frameBytes = static_cast<size_t>(16 * 16 * 4);
+    auto cache = makeShared<AnimatedImageFrameCache>(frameBytes * 3, nullptr);
+
+    cache->insert(makeKey(1, 0), makeFrame(16, 16));
+    cache->insert(makeKey(1, 1), makeFrame(16, 16));
+    cache->insert(makeKey(1, 2), makeFrame(16, 16));
+    ASSERT_NE(nullptr, cache->find(makeKey(1, 0)));
+    // Replacing a frame makes it the most recently used one
+    cache->insert(makeKey(1, 1), makeFrame(16, 16));
+
+    cache->setMaxBytes(frameBytes * 2);
+
+    ASSERT_NE(nullptr, cache->find(makeKey(1, 0)));
+    ASSERT_NE(nullptr, cache->find(makeKey(1, 1)));
+    ASSERT_EQ(nullptr, cache->find(makeKey(1, 2)));
+
+    auto stats = cache->getStats();
+    ASSERT_EQ(static_cast<size_t>(2), stats.framesCount);
+    ASSERT_EQ(frameBytes * 2, stats.bytesUsed);
+    ASSERT_EQ(static_cast<size_t>(1), stats.evictions);
+}
+
+TEST(AnimatedImageFrameCache, sharesRenderedFramesAcrossDraws) {
+    auto image = makeShared<CountingAnimatedImage>();
+    auto cache = makeShared<AnimatedImageFrameCache>(AnimatedImageFrameCache::kDefaultMaxBytes, nullptr);
+    auto surface = SkSurfaces::Raster(SkImageInfo::MakeN32Premul(100, 100));
+
+    for (size_t i = 0; i < 20; i++) {
+        image->draw(surface->getCanvas(),
+                    Rect::makeXYWH(0, 0, 20, 20),
+                    Duration::fromSeconds(0.25),
+                    FittingSizeModeCenterScaleFit,
+                    cache.get());
+    }
+
+    ASSERT_EQ(static_cast<size_t>(1), image->renderedFramesCount.load());
+    ASSERT_EQ(static_cast<size_t>(0), image->drawCount);
+
+    // Drawing at a different size renders the frame again
+    image->draw(surface->getCanvas(),
+                Rect::makeXYWH(0, 0, 40, 40),
+                Duration::fromSeconds(0.25),
+                FittingSizeModeCenterScaleFit,
+                cache.get());
+    ASSERT_EQ(static_cast<size_t>(2), image->renderedFramesCount.load());
+
+    // Without a cache, the image draws itself
+    image->draw(surface->getCanvas(), Rect::makeXYWH(0, 0, 20, 20), Duration::fromSeconds(0.25));
+    ASSERT_EQ(static_cast<size_t>(1), image->drawCount);
+}
+
+TEST(AnimatedImageFrameCache, prewarmsNextFrames) {
+    auto image = makeShared<CountingAnimatedImage>();
+    auto queue = DispatchQueue::create(STRING_LITERAL("AnimatedImageFrameCacheTest"), ThreadQoSClassNormal);
+    auto cache = makeShared<AnimatedImageFrameCache>(AnimatedImageFrameCache::kDefaultMaxBytes, queue);
+    auto surface = SkSurfaces::Raster(SkImageInfo::MakeN32Premul(100, 100));
+
+    image->draw(surface->getCanvas(),
+                Rect::makeXYWH(0, 0, 20, 20),
+                Duration::fromSeconds(0.95),
+                FittingSizeModeCenterScaleFit,
+                cache.get());
+    queue->sync([]() {});
+
+    // The drawn frame 9, and the next 3 frames, wrapping around
+    ASSERT_EQ(static_cast<size_t>(1 + AnimatedImageFrameCache::kDefaultPrewarmFramesCount),
+              image->renderedFramesCount.load());
+    ASSERT_EQ(static_cast<size_t>(4), cache->getStats().framesCount);
+
+    auto hitsBefore = cache->getStats().hits;
+
+    // Frame 0 was prewarmed
+    image->draw(surface->getCanvas(),
+                Rect::makeXYWH(0, 0, 20, 20),
+                Duration::fromSeconds(0.05),
+                FittingSizeModeCenterScaleFit,
+                cache.get());
+    queue->sync([]() {});
+
+    ASSERT_EQ(hitsBefore + 1, cache->getStats().hits);
+    // Only frame 3 was rendered, as frames 1 and 2 were already cached
+    ASSERT_EQ(static_cast<size_t>(2 + AnimatedImageFrameCache::kDefaultPrewarmFramesCount),
+              image->renderedFramesCount.load());
+
+    queue->flushAndTeardown();
+}
+
+} // namespace snap::drawing
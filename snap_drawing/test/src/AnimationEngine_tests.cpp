@@ -0,0 +1,207 @@
+#include <gtest/gtest.h>
+
+#include "snap_drawing/cpp/Animations/AnimationEngine.hpp"
+#include "snap_drawing/cpp/Animations/ValueInterpolators.hpp"
+#include "snap_drawing/cpp/Layers/LayerRoot.hpp"
+#include "valdi_core/cpp/Utils/ConsoleLogger.hpp"
+
+using namespace Valdi;
+
+namespace snap::drawing {
+
+class AnimationEngineTests : public ::testing::Test {
+protected:
+    void SetUp() override {
+        _resources = makeShared<Resources>(nullptr, 1.0f, ConsoleLogger::getLogger());
+
+        _layerRoot = makeLayer<LayerRoot>(_resources);
+        _contentLayer = makeLayer<Layer>(_resources);
+        _layerRoot->setContentLayer(_contentLayer, ContentLayerSizingModeMatchSize);
+        _layerRoot->setSize(Size(10.0f, 10.0f), 1.0f);
+    }
+
+    void TearDown() override {
+        _contentLayer = nullptr;
+        _layerRoot = nullptr;
+        _resources = nullptr;
+    }
+
+    void processFrame(TimeInterval time) {
+        _layerRoot->processFrame(TimePoint::fromSeconds(time));
+    }
+
+    Ref<Layer> addChild() {
+        auto layer = makeLayer<Layer>(_resources);
+        _contentLayer->addChild(layer);
+        return layer;
+    }
+
+    size_t getEngineSize() const {
+        return _layerRoot->getAnimationEngine()->size();
+    }
+
+    Ref<Resources> _resources;
+    Ref<LayerRoot> _layerRoot;
+    Ref<Layer> _contentLayer;
+};
+
+TEST_F(AnimationEngineTests, evaluatesPropertyAnimationsOfAllLayers) {
+    auto child1 = addChild();
+    auto child2 = addChild();
+
+    std::vector<bool> completions;
+    auto animation1 = makeShared<PropertyAnimation>(
+        AnimatedProperty::Opacity, Duration(1.0), TimingCurve::linear(), 1.0f, 0.0f);
+    animation1->addCompletion([&](bool completed) { completions.emplace_back(completed); });
+    auto animation2 = makeShared<PropertyAnimation>(
+        AnimatedProperty::TranslationX, Duration(2.0), TimingCurve::linear(), 0.0f, 100.0f);
+    animation2->addCompletion([&](bool completed) { completions.emplace_back(completed); });
+
+    child1->addAnimation(STRING_LITERAL("opacity"), animation1);
+    child2->addAnimation(STRING_LITERAL("translationX"), animation2);
+
+    ASSERT_TRUE(animation1->isRunningInEngine());
+    ASSERT_TRUE(animation2->isRunningInEngine());
+    ASSERT_EQ(static_cast<size_t>(2), getEngineSize());
+    // The layers don't process the animations themselves
+    ASSERT_FALSE(child1->needsProcessAnimations());
+    ASSERT_FALSE(child2->needsProcessAnimations());
+
+    processFrame(0.0);
+
+    ASSERT_FLOAT_EQ(1.0f, child1->getOpacity());
+    ASSERT_FLOAT_EQ(0.0f, child2->getTranslationX());
+
+    processFrame(0.5);
+
+    ASSERT_NEAR(0.5f, child1->getOpacity(), 0.0001f);
+    ASSERT_NEAR(25.0f, child2->getTranslationX(), 0.01f);
+
+    processFrame(1.0);
+
+    ASSERT_EQ(0.0f, child1->getOpacity());
+    ASSERT_NEAR(50.0f, child2->getTranslationX(), 0.01f);
+    ASSERT_FALSE(child1->hasAnimation(STRING_LITERAL("opacity")));
+    ASSERT_TRUE(child2->hasAnimation(STRING_LITERAL("translationX")));
+    ASSERT_EQ(std::vector<bool>({true}), completions);
+    ASSERT_EQ(static_cast<size_t>(1), getEngineSize());
+
+    processFrame(2.0);
+
+    ASSERT_EQ(100.0f, child2->getTranslationX());
+    ASSERT_FALSE(child2->hasAnimation(STRING_LITERAL("translationX")));
+    ASSERT_EQ(std::vector<bool>({true, true}), completions);
+    ASSERT_EQ(static_cast<size_t>(0), getEngineSize());
+
+    processFrame(3.0);
+    ASSERT_FALSE(_layerRoot->needsProcessFrame());
+}
+
+TEST_F(AnimationEngineTests, appliesFinalValueWhenCancelled) {
+    auto child = addChild();
+
+    std::vector<bool> completions;
+    auto animation =
+        makeShared<PropertyAnimation>(AnimatedProperty::ScaleX, Duration(1.0), TimingCurve::easeIn(), 1.0f, 2.0f);
+    animation->addCompletion([&](bool completed) { completions.emplace_back(completed); });
+
+    child->addAnimation(STRING_LITERAL("scaleX"), animation);
+    processFrame(0.0);
+    processFrame(0.25);
+
+    child->removeAnimation(STRING_LITERAL("scaleX"));
+
+    ASSERT_FALSE(animation->isRunningInEngine());
+    ASSERT_EQ(static_cast<size_t>(0), getEngineSize());
+    ASSERT_EQ(2.0f, child->getScaleX());
+    ASSERT_EQ(std::vector<bool>({false}), completions);
+}
+
+TEST_F(AnimationEngineTests, replacesAnimationWithSameKey) {
+    auto child = addChild();
+
+    auto animation1 = makeShared<PropertyAnimation>(
+        AnimatedProperty::Rotation, Duration(1.0), TimingCurve::linear(), 0.0f, 90.0f);
+    auto animation2 = makeShared<PropertyAnimation>(
+        AnimatedProperty::Rotation, Duration(1.0), TimingCurve::linear(), 90.0f, 180.0f);
+
+    child->addAnimation(STRING_LITERAL("rotation"), animation1);
+    processFrame(0.0);
+    child->addAnimation(STRING_LITERAL("rotation"), animation2);
+
+    ASSERT_FALSE(animation1->isRunningInEngine());
+    ASSERT_TRUE(animation2->isRunningInEngine());
+    ASSERT_EQ(static_cast<size_t>(1), getEngineSize());
+
+    processFrame(0.5);
+    ASSERT_EQ(90.0f, child->getRotation());
+
+    processFrame(1.0);
+    ASSERT_NEAR(135.0f, child->getRotation(), 0.01f);
+}
+
+TEST_F(AnimationEngineTests, interpolatesColorsLikeValueInterpolators) {
+    auto child = addChild();
+
+    auto from = Color::makeARGB(255, 200, 0, 50);
+    auto to = Color::makeARGB(0, 0, 100, 250);
+    auto animation = makeShared<PropertyAnimation>(
+        AnimatedProperty::BackgroundColor, Duration(1.0), TimingCurve::linear(), from, to);
+
+    child->addAnimation(STRING_LITERAL("backgroundColor"), animation);
+    processFrame(0.0);
+    ASSERT_EQ(from, child->getBackgroundColor());
+
+    processFrame(0.5);
+    auto expectedColor = interpolateValue(from, to, 0.5);
+    auto color = child->getBackgroundColor();
+    ASSERT_NEAR(expectedColor.getAlpha(), color.getAlpha(), 1);
+    ASSERT_NEAR(expectedColor.getRed(), color.getRed(), 1);
+    ASSERT_NEAR(expectedColor.getGreen(), color.getGreen(), 1);
+    ASSERT_NEAR(expectedColor.getBlue(), color.getBlue(), 1);
+
+    processFrame(1.0);
+    ASSERT_EQ(to, child->getBackgroundColor());
+}
+
+TEST_F(AnimationEngineTests, startsAnimationsAddedWhileDetached) {
+    auto layer = makeLayer<Layer>(_resources);
+    auto animation = makeShared<PropertyAnimation>(
+        AnimatedProperty::TranslationY, Duration(1.0), TimingCurve::linear(), 0.0f, 10.0f);
+
+    layer->addAnimation(STRING_LITERAL("translationY"), animation);
+    ASSERT_FALSE(animation->isRunningInEngine());
+
+    _contentLayer->addChild(layer);
+
+    ASSERT_TRUE(animation->isRunningInEngine());
+    ASSERT_EQ(static_cast<size_t>(1), getEngineSize());
+
+    layer->removeFromParent();
+
+    ASSERT_FALSE(animation->isRunningInEngine());
+    ASSERT_EQ(static_cast<size_t>(0), getEngineSize());
+    ASSERT_FALSE(layer->hasAnimation(STRING_LITERAL("translationY")));
+}
+
+TEST(TimingCurve, matchesInterpolationFunctions) {
+    std::vector<std::pair<TimingCurve, InterpolationFunction>> curves;
+    curves.emplace_back(TimingCurve::linear(), InterpolationFunctions::linear());
+    curves.emplace_back(TimingCurve::systemDefault(), InterpolationFunctions::systemDefault());
+    curves.emplace_back(TimingCurve::easeIn(), InterpolationFunctions::easeIn());
+    curves.emplace_back(TimingCurve::easeOut(), InterpolationFunctions::easeOut());
+    curves.emplace_back(TimingCurve::easeInOut(), InterpolationFunctions::easeInOut());
+    curves.emplace_back(TimingCurve::strongEaseOut(), InterpolationFunctions::strongEaseOut());
+
+    for (const auto& [timingCurve, interpolationFunction] : curves) {
+        ASSERT_EQ(0.0, timingCurve.evaluate(0.0));
+        ASSERT_EQ(1.0, timingCurve.evaluate(1.0));
+
+        for (size_t i = 1; i < 20; i++) {
+            auto ratio = static_cast<double>(i) / 20.0;
+            ASSERT_NEAR(interpolationFunction(ratio), timingCurve.evaluate(ratio), 0.0001);
+        }
+    }
+}
+
+} // namespace snap::drawing
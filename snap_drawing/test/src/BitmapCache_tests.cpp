@@ -0,0 +1,159 @@
+#include <gtest/gtest.h>
+
+#include "TestBitmap.hpp"
+#include "snap_drawing/cpp/Drawing/Raster/BitmapCache.hpp"
+
+using namespace Valdi;
+
+namespace snap::drawing {
+
+class CountingBitmapFactory : public IBitmapFactory {
+public:
+    size_t createdBitmapCount = 0;
+
+    CountingBitmapFactory() = default;
+    ~CountingBitmapFactory() override = default;
+
+    Result<Ref<IBitmap>> createBitmap(int width, int height) override {
+        createdBitmapCount++;
+
+        Ref<IBitmap> bitmap = makeShared<TestBitmap>(width, height);
+        return bitmap;
+    }
+};
+
+TEST(BitmapCache, roundsDimensionsUpToSizeClass) {
+    ASSERT_EQ(16, BitmapCache::getSizeClass(1));
+    ASSERT_EQ(16, BitmapCache::getSizeClass(16));
+    ASSERT_EQ(32, BitmapCache::getSizeClass(17));
+    ASSERT_EQ(256, BitmapCache::getSizeClass(256));
+    ASSERT_EQ(1024, BitmapCache::getSizeClass(1000));
+    ASSERT_EQ(1152, BitmapCache::getSizeClass(1080));
+}
+
+TEST(BitmapCache, reusesUnusedBitmapsOfSameSizeClass) {
+    auto factory = makeShared<CountingBitmapFactory>();
+    BitmapCache cache;
+
+    auto bitmap = cache.allocateBitmap(factory, 1000, 1000);
+    ASSERT_TRUE(bitmap) << bitmap.description();
+    ASSERT_EQ(1024, bitmap.value()->getInfo().width);
+    ASSERT_EQ(1024, bitmap.value()->getInfo().height);
+
+    // In-use bitmaps are not returned twice
+    auto otherBitmap = cache.allocateBitmap(factory, 1000, 1000);
+    ASSERT_TRUE(otherBitmap) << otherBitmap.description();
+    ASSERT_NE(bitmap.value(), otherBitmap.value());
+    ASSERT_EQ(static_cast<size_t>(2), factory->createdBitmapCount);
+
+    auto* bitmapPtr = bitmap.value().get();
+    bitmap = Ref<IBitmap>();
+    otherBitmap = Ref<IBitmap>();
+
+    // A slightly different size should hit the same bitmap
+    auto reusedBitmap = cache.allocateBitmap(factory, 990, 1010);
+    ASSERT_TRUE(reusedBitmap) << reusedBitmap.description();
+    ASSERT_EQ(bitmapPtr, reusedBitmap.value().get());
+    ASSERT_EQ(static_cast<size_t>(2), factory->createdBitmapCount);
+
+    auto stats = cache.getStats();
+    ASSERT_EQ(static_cast<size_t>(1), stats.hits);
+    ASSERT_EQ(static_cast<size_t>(2), stats.misses);
+    ASSERT_EQ(static_cast<size_t>(2), stats.bitmapsCount);
+    ASSERT_EQ(static_cast<size_t>(2 * 1024 * 1024 * 4), stats.bytesUsed);
+}
+
+TEST(BitmapCache, reusesBitmapsOfNextSizeClass) {
+    auto factory = makeShared<CountingBitmapFactory>();
+    BitmapCache cache;
+
+    auto* bitmapPtr = cache.allocateBitmap(factory, 256, 300).value().get();
+
+    auto reusedBitmap = cache.allocateBitmap(factory, 250, 280);
+    ASSERT_TRUE(reusedBitmap) << reusedBitmap.description();
+    ASSERT_EQ(bitmapPtr, reusedBitmap.value().get());
+    ASSERT_EQ(static_cast<size_t>(1), factory->createdBitmapCount);
+}
+
+TEST(BitmapCache, allocatesExactBitmaps) {
+    auto factory = makeShared<CountingBitmapFactory>();
+    BitmapCache cache;
+
+    auto bitmap = cache.allocateExactBitmap(factory, 1000, 1010);
+    ASSERT_TRUE(bitmap) << bitmap.description();
+    ASSERT_EQ(1000, bitmap.value()->getInfo().width);
+    ASSERT_EQ(1010, bitmap.value()->getInfo().height);
+
+    auto* bitmapPtr = bitmap.value().get();
+    bitmap = Ref<IBitmap>();
+
+    // Bitmaps of a size class are not returned for a different exact size
+    auto classBitmap = cache.allocateBitmap(factory, 1024, 1024).value();
+    auto otherBitmap = cache.allocateExactBitmap(factory, 1000, 1000).value();
+    ASSERT_EQ(1000, otherBitmap->getInfo().height);
+    ASSERT_EQ(static_cast<size_t>(3), factory->createdBitmapCount);
+
+    auto reusedBitmap = cache.allocateExactBitmap(factory, 1000, 1010);
+    ASSERT_TRUE(reusedBitmap) << reusedBitmap.description();
+    ASSERT_EQ(bitmapPtr, reusedBitmap.value().get());
+    ASSERT_EQ(static_cast<size_t>(3), factory->createdBitmapCount);
+}
+
+TEST(BitmapCache, doesNotShareBitmapsAcrossFactories) {
+    auto factory = makeShared<CountingBitmapFactory>();
+    auto otherFactory = makeShared<CountingBitmapFactory>();
+    BitmapCache cache;
+
+    auto bitmap = cache.allocateBitmap(factory, 64, 64);
+    ASSERT_TRUE(bitmap) << bitmap.description();
+    bitmap = Ref<IBitmap>();
+
+    bitmap = cache.allocateBitmap(otherFactory, 64, 64);
+    ASSERT_TRUE(bitmap) << bitmap.description();
+
+    ASSERT_EQ(static_cast<size_t>(1), factory->createdBitmapCount);
+    ASSERT_EQ(static_cast<size_t>(1), otherFactory->createdBitmapCount);
+}
+
+TEST(BitmapCache, evictsLeastRecentlyUsedUnusedBitmapsOverBudget) {
+    auto factory = makeShared<CountingBitmapFactory>();
+    // Fits exactly two 64x64 bitmaps
+    BitmapCache cache(2 * 64 * 64 * 4);
+
+    auto firstBitmap = cache.allocateBitmap(factory, 64, 64).value();
+    auto secondBitmap = cache.allocateBitmap(factory, 64, 64).value();
+    auto* firstBitmapPtr = firstBitmap.get();
+    ASSERT_NE(firstBitmapPtr, secondBitmap.get());
+    firstBitmap = Ref<IBitmap>();
+    secondBitmap = Ref<IBitmap>();
+
+    // Mark the first bitmap as the most recently used one
+    ASSERT_EQ(firstBitmapPtr, cache.allocateBitmap(factory, 64, 64).value().get());
+
+    // Going over budget should evict the second bitmap
+    auto smallBitmap = cache.allocateBitmap(factory, 32, 32).value();
+
+    auto stats = cache.getStats();
+    ASSERT_EQ(static_cast<size_t>(1), stats.evictions);
+    ASSERT_EQ(static_cast<size_t>(2), stats.bitmapsCount);
+    ASSERT_EQ(static_cast<size_t>(3), factory->createdBitmapCount);
+
+    auto inUseBitmap = cache.allocateBitmap(factory, 64, 64).value();
+    ASSERT_EQ(firstBitmapPtr, inUseBitmap.get());
+    ASSERT_EQ(static_cast<size_t>(3), factory->createdBitmapCount);
+
+    // In-use bitmaps are kept even when over budget
+    cache.setMaxBytes(0);
+    stats = cache.getStats();
+    ASSERT_EQ(static_cast<size_t>(2), stats.bitmapsCount);
+
+    inUseBitmap = Ref<IBitmap>();
+    smallBitmap = Ref<IBitmap>();
+    cache.clearUnused();
+
+    stats = cache.getStats();
+    ASSERT_EQ(static_cast<size_t>(0), stats.bitmapsCount);
+    ASSERT_EQ(static_cast<size_t>(0), stats.bytesUsed);
+}
+
+} // namespace snap::drawing
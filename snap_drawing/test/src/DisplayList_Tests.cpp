@@ -227,4 +227,33 @@ TEST(DisplayList, canRemoveEmptySurfaces) {
     ASSERT_EQ(70, clipRect->height);
 }
 
+TEST(DisplayList, comparesPlaneContent) {
+    auto layerContent = makeRectangle(Size(50, 50));
+    auto otherLayerContent = makeRectangle(Size(50, 50));
+
+    Matrix matrix;
+    matrix.setTranslateX(10);
+
+    auto makeDisplayList = [&](const LayerContent& content, uint64_t layerId, bool hasUpdates, Scalar clipWidth) {
+        auto displayList = makeShared<DisplayList>(Size(100, 100), TimePoint(0));
+        displayList->pushContext(matrix, 1.0, layerId, hasUpdates);
+        displayList->appendClipRect(clipWidth, 50);
+        displayList->appendLayerContent(content, 1.0);
+        displayList->popContext();
+        return displayList;
+    };
+
+    auto displayList = makeDisplayList(layerContent, 1, true, 50);
+
+    // Layer ids and update flags do not change the drawn content
+    ASSERT_TRUE(displayList->hasSamePlaneContent(0, *makeDisplayList(layerContent, 2, false, 50), 0));
+
+    ASSERT_FALSE(displayList->hasSamePlaneContent(0, *makeDisplayList(otherLayerContent, 1, true, 50), 0));
+    ASSERT_FALSE(displayList->hasSamePlaneContent(0, *makeDisplayList(layerContent, 1, true, 40), 0));
+
+    auto longerDisplayList = makeDisplayList(layerContent, 1, true, 50);
+    longerDisplayList->popContext();
+    ASSERT_FALSE(displayList->hasSamePlaneContent(0, *longerDisplayList, 0));
+}
+
 } // namespace snap::drawing
@@ -1138,6 +1138,60 @@ void updateSurfacePresenters(const Ref<DrawLooperEntry>& entry, const Compositor
     }
 }
 
+TEST(DrawLooper, skipsDrawingUnchangedPlanes) {
+    DrawLooperTestContainer container;
+
+    auto surfacePresenterManager = makeShared<Test4PixelsBitmapSurfacePresenterManager>();
+    container.drawLooper->addLayerRoot(container.layerRoot, surfacePresenterManager, false);
+    container.layerRoot->getContentLayer()->setBackgroundColor(Color::blue());
+
+    auto externalLayer = makeLayer<ExternalLayer>(container.resources);
+    externalLayer->setFrame(Rect::makeXYWH(1, 1, 2, 2));
+    externalLayer->setExternalSurface(makeShared<TestExternalSurface>());
+
+    auto afterSiblingLayer = makeLayer<Layer>(container.resources);
+    afterSiblingLayer->setBackgroundColor(Color::red());
+    afterSiblingLayer->setFrame(Rect::makeXYWH(2, 2, 1, 1));
+
+    container.layerRoot->getContentLayer()->addChild(externalLayer);
+    container.layerRoot->getContentLayer()->addChild(afterSiblingLayer);
+
+    container.layerRoot->setSize(Size::make(4, 4), 1);
+
+    ASSERT_TRUE(container.frameScheduler->runNextMainThreadCallback());
+    container.frameScheduler->runNextVSyncCallback();
+
+    ASSERT_EQ(static_cast<size_t>(3), surfacePresenterManager->getSurfaces().size());
+    auto backgroundBitmap = surfacePresenterManager->getSurfaceBitmap(0);
+    auto foregroundBitmap = surfacePresenterManager->getSurfaceBitmap(2);
+    ASSERT_TRUE(backgroundBitmap != nullptr);
+    ASSERT_TRUE(foregroundBitmap != nullptr);
+
+    ASSERT_EQ(Color::blue(), backgroundBitmap->getPixel(0, 0));
+    ASSERT_EQ(Color::red(), foregroundBitmap->getPixel(2, 2));
+
+    // Tag the background so that we can tell whether it was drawn again
+    backgroundBitmap->setPixel(0, 0, Color::green());
+
+    container.frameScheduler->advanceTime(1.0);
+    afterSiblingLayer->setBackgroundColor(Color::black());
+
+    ASSERT_TRUE(container.frameScheduler->runNextMainThreadCallback());
+    ASSERT_TRUE(container.frameScheduler->runNextVSyncCallback());
+
+    // Only the plane that changed should have been drawn
+    ASSERT_EQ(Color::black(), foregroundBitmap->getPixel(2, 2));
+    ASSERT_EQ(Color::green(), backgroundBitmap->getPixel(0, 0));
+
+    // An explicit redraw request should still draw the plane, the background presenter was created first
+    container.drawLooper->setPresenterOfLayerRootNeedsRedraw(*container.layerRoot, 1);
+
+    ASSERT_TRUE(container.frameScheduler->runNextVSyncCallback());
+
+    ASSERT_EQ(Color::blue(), backgroundBitmap->getPixel(0, 0));
+    ASSERT_FALSE(container.frameScheduler->runNextVSyncCallback());
+}
+
 TEST(DrawLooperEntry, canCreateDrawableSurfaces) {
     DrawLooperTestContainer container;
     auto surfacePresenterManager = makeShared<TestSurfacePresenterManager>();
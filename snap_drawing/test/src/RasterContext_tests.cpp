@@ -9,9 +9,11 @@
 #include "snap_drawing/cpp/Layers/ExternalLayer.hpp"
 #include "snap_drawing/cpp/Layers/Interfaces/ILayerRoot.hpp"
 #include "snap_drawing/cpp/Layers/Layer.hpp"
+#include "snap_drawing/cpp/Layers/ScrollLayer.hpp"
 #include "snap_drawing/cpp/Layers/ShapeLayer.hpp"
 #include "snap_drawing/cpp/Utils/Bitmap.hpp"
 #include "valdi_core/cpp/Interfaces/IBitmapFactory.hpp"
+#include "valdi_core/cpp/Threading/WorkStealingExecutor.hpp"
 #include "valdi_core/cpp/Utils/ConsoleLogger.hpp"
 
 using namespace Valdi;
@@ -127,21 +129,21 @@ protected:
         return outputBitmap;
     }
 
-    Result<RasterContext::RasterResult> rasterInto(const Ref<Valdi::IBitmap>& outputBitmap,
-                                                   bool shouldClearBitmapBeforeDrawing = true) {
+    Ref<DisplayList> drawDisplayList() {
         auto displayList = Valdi::makeShared<DisplayList>(_contentLayer->getFrame().size(), TimePoint(0.0));
         DrawMetrics metrics;
         _contentLayer->draw(*displayList, metrics);
 
-        return _rasterContext->raster(displayList, outputBitmap, shouldClearBitmapBeforeDrawing);
+        return displayList;
     }
 
-    Result<RasterContext::RasterResult> rasterDelta(const Ref<TestBitmap>& inputBitmap) {
-        auto displayList = Valdi::makeShared<DisplayList>(_contentLayer->getFrame().size(), TimePoint(0.0));
-        DrawMetrics metrics;
-        _contentLayer->draw(*displayList, metrics);
+    Result<RasterContext::RasterResult> rasterInto(const Ref<Valdi::IBitmap>& outputBitmap,
+                                                   bool shouldClearBitmapBeforeDrawing = true) {
+        return _rasterContext->raster(drawDisplayList(), outputBitmap, shouldClearBitmapBeforeDrawing);
+    }
 
-        return _rasterContext->rasterDelta(displayList, inputBitmap);
+    Result<RasterContext::RasterResult> rasterDelta(const Ref<TestBitmap>& inputBitmap) {
+        return _rasterContext->rasterDelta(drawDisplayList(), inputBitmap);
     }
 
     Ref<Resources> _resources;
@@ -701,4 +703,197 @@ TEST_F(RasterContextTests, canRasterWithInternalDeltaModeAndNoClear) {
     ASSERT_EQ(25, result.value().renderedPixelsCount);
 }
 
+static void populateParallelRasterScene(const Ref<Resources>& resources, const Ref<Layer>& contentLayer) {
+    contentLayer->setBackgroundColor(Color::red());
+    contentLayer->setFrame(Rect::makeXYWH(0, 0, 512, 512));
+
+    for (int i = 0; i < 8; i++) {
+        auto childLayer = makeLayer<Layer>(resources);
+        childLayer->setBackgroundColor(i % 2 == 0 ? Color::blue() : Color::green());
+        childLayer->setBorderRadius(BorderRadius::makeOval(25, true));
+        childLayer->setBorderWidth(3);
+        childLayer->setBorderColor(Color::black());
+        childLayer->setOpacity(0.75f);
+        // Fractional frames so that anti-aliased edges cross the tile boundaries
+        auto offset = static_cast<Scalar>(i);
+        childLayer->setFrame(Rect::makeXYWH(10.5f + offset * 60.0f, 7.25f + offset * 55.0f, 90.3f, 120.7f));
+        contentLayer->addChild(childLayer);
+    }
+}
+
+TEST_F(RasterContextTests, parallelRasterMatchesSequentialRaster) {
+    populateParallelRasterScene(_resources, _contentLayer);
+
+    auto sequentialBitmap = makeShared<TestBitmap>(512, 512);
+    auto result = rasterInto(sequentialBitmap);
+    ASSERT_TRUE(result) << result.description();
+
+    auto executor = makeShared<WorkStealingExecutor>(3);
+    _rasterContext->setParallelRasterExecutor(executor);
+
+    auto parallelBitmap = makeShared<TestBitmap>(512, 512);
+    result = rasterInto(parallelBitmap);
+    ASSERT_TRUE(result) << result.description();
+
+    ASSERT_TRUE(*sequentialBitmap == *parallelBitmap);
+
+    executor->teardown();
+}
+
+TEST_F(RasterContextTests, parallelRasterDeltaMatchesSequentialRaster) {
+    populateParallelRasterScene(_resources, _contentLayer);
+
+    auto executor = makeShared<WorkStealingExecutor>(3);
+    _rasterContext->setParallelRasterExecutor(executor);
+
+    auto parallelBitmap = makeShared<TestBitmap>(512, 512);
+    auto result = rasterDelta(parallelBitmap);
+    ASSERT_TRUE(result) << result.description();
+
+    auto movedLayer = _contentLayer->getChild(0);
+    movedLayer->setFrame(Rect::makeXYWH(300.5f, 20.25f, 150.0f, 200.0f));
+
+    result = rasterDelta(parallelBitmap);
+    ASSERT_TRUE(result) << result.description();
+
+    _rasterContext->setParallelRasterExecutor(nullptr);
+    auto sequentialBitmap = makeShared<TestBitmap>(512, 512);
+    result = rasterInto(sequentialBitmap);
+    ASSERT_TRUE(result) << result.description();
+
+    ASSERT_TRUE(*sequentialBitmap == *parallelBitmap);
+
+    executor->teardown();
+}
+
+static Ref<ScrollLayer> populateFeedScene(const Ref<Resources>& resources, const Ref<Layer>& contentLayer) {
+    contentLayer->setBackgroundColor(Color::white());
+    contentLayer->setFrame(Rect::makeXYWH(0, 0, 512, 512));
+
+    auto scrollLayer = makeLayer<ScrollLayer>(resources);
+    scrollLayer->setFrame(Rect::makeXYWH(0, 0, 512, 512));
+    scrollLayer->setContentSize(Size(512, 4096));
+    contentLayer->addChild(scrollLayer);
+
+    for (int i = 0; i < 40; i++) {
+        auto itemLayer = makeLayer<Layer>(resources);
+        itemLayer->setBackgroundColor(i % 2 == 0 ? Color::red() : Color::blue());
+        itemLayer->setFrame(Rect::makeXYWH(0, static_cast<Scalar>(i * 100), 512, 100));
+
+        auto thumbnailLayer = makeLayer<Layer>(resources);
+        thumbnailLayer->setBackgroundColor(Color::green());
+        thumbnailLayer->setFrame(Rect::makeXYWH(static_cast<Scalar>(16 + (i % 5) * 40), 20, 60, 60));
+        itemLayer->addChild(thumbnailLayer);
+
+        scrollLayer->getChildInsertionLayer().addChild(itemLayer);
+    }
+
+    return scrollLayer;
+}
+
+TEST_F(RasterContextTests, rasterTileCacheReusesTilesWhenScrolling) {
+    auto scrollLayer = populateFeedScene(_resources, _contentLayer);
+    _rasterContext->setRasterTileCacheEnabled(true);
+    auto referenceRasterContext =
+        makeShared<RasterContext>(_resources->getLogger(), ExternalSurfaceRasterizationMethod::ACCURATE, false);
+
+    auto outputBitmap = makeShared<TestBitmap>(512, 512);
+    auto referenceBitmap = makeShared<TestBitmap>(512, 512);
+
+    auto displayList = drawDisplayList();
+    auto result = _rasterContext->rasterDelta(displayList, outputBitmap);
+    ASSERT_TRUE(result) << result.description();
+    result = referenceRasterContext->raster(displayList, referenceBitmap, true);
+    ASSERT_TRUE(result) << result.description();
+
+    ASSERT_TRUE(*outputBitmap == *referenceBitmap);
+
+    // The viewport is covered by 2x2 tiles
+    auto stats = _rasterContext->getRasterTileCacheStats();
+    ASSERT_EQ(static_cast<size_t>(4), stats.rasterizedTiles);
+    ASSERT_EQ(static_cast<size_t>(0), stats.reusedTiles);
+
+    scrollLayer->setContentOffset(Point::make(0, 64), Vector(0, 0), false);
+
+    displayList = drawDisplayList();
+    result = _rasterContext->rasterDelta(displayList, outputBitmap);
+    ASSERT_TRUE(result) << result.description();
+    result = referenceRasterContext->raster(displayList, referenceBitmap, true);
+    ASSERT_TRUE(result) << result.description();
+
+    ASSERT_TRUE(*outputBitmap == *referenceBitmap);
+
+    // Only the row of tiles exposed at the bottom should have been rasterized
+    stats = _rasterContext->getRasterTileCacheStats();
+    ASSERT_EQ(static_cast<size_t>(6), stats.rasterizedTiles);
+    ASSERT_EQ(static_cast<size_t>(4), stats.reusedTiles);
+
+    scrollLayer->setContentOffset(Point::make(0, 0), Vector(0, 0), false);
+
+    displayList = drawDisplayList();
+    result = _rasterContext->rasterDelta(displayList, outputBitmap);
+    ASSERT_TRUE(result) << result.description();
+    result = referenceRasterContext->raster(displayList, referenceBitmap, true);
+    ASSERT_TRUE(result) << result.description();
+
+    ASSERT_TRUE(*outputBitmap == *referenceBitmap);
+
+    // Scrolling back should not rasterize anything
+    stats = _rasterContext->getRasterTileCacheStats();
+    ASSERT_EQ(static_cast<size_t>(6), stats.rasterizedTiles);
+}
+
+TEST_F(RasterContextTests, rasterTileCacheInvalidatesTilesWhenContentChanges) {
+    auto scrollLayer = populateFeedScene(_resources, _contentLayer);
+    _rasterContext->setRasterTileCacheEnabled(true);
+    auto referenceRasterContext =
+        makeShared<RasterContext>(_resources->getLogger(), ExternalSurfaceRasterizationMethod::ACCURATE, false);
+
+    auto outputBitmap = makeShared<TestBitmap>(512, 512);
+    auto referenceBitmap = makeShared<TestBitmap>(512, 512);
+
+    auto result = _rasterContext->rasterDelta(drawDisplayList(), outputBitmap);
+    ASSERT_TRUE(result) << result.description();
+
+    scrollLayer->getContentLayer()->getChild(1)->setBackgroundColor(Color::black());
+
+    auto displayList = drawDisplayList();
+    result = _rasterContext->raster(displayList, outputBitmap, true);
+    ASSERT_TRUE(result) << result.description();
+    result = referenceRasterContext->raster(displayList, referenceBitmap, true);
+    ASSERT_TRUE(result) << result.description();
+
+    ASSERT_TRUE(*outputBitmap == *referenceBitmap);
+    ASSERT_EQ(Color::black(), outputBitmap->getPixel(500, 150));
+
+    // Only the top row of tiles covers the changed item and should have been rasterized again
+    auto stats = _rasterContext->getRasterTileCacheStats();
+    ASSERT_EQ(static_cast<size_t>(0), stats.evictedTiles);
+    ASSERT_EQ(static_cast<size_t>(6), stats.rasterizedTiles);
+    ASSERT_EQ(static_cast<size_t>(2), stats.reusedTiles);
+}
+
+TEST_F(RasterContextTests, rasterTileCacheKeepsSubpixelOffset) {
+    auto scrollLayer = populateFeedScene(_resources, _contentLayer);
+    _rasterContext->setRasterTileCacheEnabled(true);
+    auto referenceRasterContext =
+        makeShared<RasterContext>(_resources->getLogger(), ExternalSurfaceRasterizationMethod::ACCURATE, false);
+
+    // The content ends up translated by half a pixel
+    scrollLayer->setScaleY(0.5f);
+    scrollLayer->setContentOffset(Point::make(0, 1), Vector(0, 0), false);
+
+    auto outputBitmap = makeShared<TestBitmap>(512, 512);
+    auto referenceBitmap = makeShared<TestBitmap>(512, 512);
+
+    auto displayList = drawDisplayList();
+    auto result = _rasterContext->raster(displayList, outputBitmap, true);
+    ASSERT_TRUE(result) << result.description();
+    result = referenceRasterContext->raster(displayList, referenceBitmap, true);
+    ASSERT_TRUE(result) << result.description();
+
+    ASSERT_TRUE(*outputBitmap == *referenceBitmap);
+    ASSERT_NE(static_cast<size_t>(0), _rasterContext->getRasterTileCacheStats().rasterizedTiles);
+}
+
 } // namespace snap::drawing
@@ -1,6 +1,7 @@
 #include <gtest/gtest.h>
 
 #include "snap_drawing/cpp/Text/TextShaperCache.hpp"
+#include "snap_drawing/cpp/Text/TextShaperCacheSnapshot.hpp"
 #include "snap_drawing/cpp/Utils/UTFUtils.hpp"
 
 namespace snap::drawing {
@@ -193,4 +194,72 @@ TEST(TextShaperCache, removesLeastRecentlyUsedWhenFull) {
     ASSERT_TRUE(cache.contains(makeCacheKey(1, characters4)));
 }
 
+TEST(TextShaperCache, canRestoreFromSnapshot) {
+    auto characters = utf8ToUnicode("Hello World what is going on!");
+    auto characters2 = utf8ToUnicode("I'm way different.");
+
+    auto shapedGlyphs = generateGlyphVec(characters.data(), characters.size());
+    auto shapedGlyphs2 = generateGlyphVec(characters2.data(), characters2.size());
+
+    FontId fontSizeBits = 42;
+    TextShaperCacheSnapshotBuilder builder;
+    builder.append(100,
+                   makeCacheKey((fontSizeBits << 32) | 1, characters),
+                   TextShaperCacheValue(shapedGlyphs.data(), shapedGlyphs.size()));
+    builder.append(200,
+                   makeCacheKey((fontSizeBits << 32) | 2, characters2),
+                   TextShaperCacheValue(shapedGlyphs2.data(), shapedGlyphs2.size()));
+
+    ASSERT_EQ(static_cast<size_t>(2), builder.size());
+
+    auto snapshot = TextShaperCacheSnapshot::parse(builder.build());
+    ASSERT_TRUE(snapshot) << snapshot.description();
+
+    TextShaperCache cache(8);
+    auto visitor = [&](const TextShaperCacheKey& key, const ShapedGlyph* glyphs, size_t glyphsLength) {
+        cache.insert(key, glyphs, glyphsLength);
+    };
+
+    // Unknown typefaces are ignored
+    ASSERT_EQ(static_cast<size_t>(0), snapshot.value().consumeTypeface(300, 7, visitor));
+
+    // Entries are restored with the runtime typeface id
+    ASSERT_EQ(static_cast<size_t>(1), snapshot.value().consumeTypeface(100, 7, visitor));
+    ASSERT_FALSE(snapshot.value().empty());
+
+    auto result = cache.find(makeCacheKey((fontSizeBits << 32) | 7, characters));
+    ASSERT_TRUE(result);
+    ASSERT_EQ(shapedGlyphs, toGlyphVec(result.value().glyphs, result.value().length));
+    ASSERT_FALSE(cache.contains(makeCacheKey((fontSizeBits << 32) | 1, characters)));
+
+    // A typeface can only be consumed once
+    ASSERT_EQ(static_cast<size_t>(0), snapshot.value().consumeTypeface(100, 7, visitor));
+
+    ASSERT_EQ(static_cast<size_t>(1), snapshot.value().consumeTypeface(200, 8, visitor));
+    ASSERT_TRUE(snapshot.value().empty());
+
+    result = cache.find(makeCacheKey((fontSizeBits << 32) | 8, characters2));
+    ASSERT_TRUE(result);
+    ASSERT_EQ(shapedGlyphs2, toGlyphVec(result.value().glyphs, result.value().length));
+}
+
+TEST(TextShaperCache, rejectsInvalidSnapshots) {
+    auto characters = utf8ToUnicode("Hello");
+    auto shapedGlyphs = generateGlyphVec(characters.data(), characters.size());
+
+    TextShaperCacheSnapshotBuilder builder;
+    builder.append(
+        100, makeCacheKey(1, characters), TextShaperCacheValue(shapedGlyphs.data(), shapedGlyphs.size()));
+    auto bytes = builder.build();
+
+    ASSERT_FALSE(TextShaperCacheSnapshot::parse(Valdi::BytesView()));
+    ASSERT_FALSE(TextShaperCacheSnapshot::parse(Valdi::BytesView(nullptr, bytes.data(), 12)));
+    ASSERT_FALSE(TextShaperCacheSnapshot::parse(Valdi::BytesView(nullptr, bytes.data(), 20)));
+
+    auto corrupted = Valdi::makeShared<Valdi::ByteBuffer>();
+    corrupted->append(bytes.data(), bytes.data() + bytes.size());
+    corrupted->data()[0] ^= 0xFF;
+    ASSERT_FALSE(TextShaperCacheSnapshot::parse(corrupted->toBytesView()));
+}
+
 } // namespace snap::drawing
@@ -527,4 +527,172 @@ TEST(TouchDispatcher, canRefreshTouchGestures) {
     ASSERT_EQ(2, snapshot->counter);
 }
 
+TEST(TouchDispatcher, indexedHitTestMatchesRecursiveHitTest) {
+    auto root = makeRoot();
+    auto rootView = createView(0, 0, 400, 400);
+    root->setContentLayer(rootView, ContentLayerSizingModeMatchSize);
+
+    std::vector<Ref<GestureRecognizerSnapshot>> snapshots;
+    for (int row = 0; row < 8; row++) {
+        for (int column = 0; column < 8; column++) {
+            auto cell = createView(static_cast<Scalar>(column * 50), static_cast<Scalar>(row * 50), 50, 50);
+            auto cellContent = createView(10, 10, 30, 30);
+            cell->addChild(cellContent);
+            rootView->addChild(cell);
+
+            // Exercise the transforms and touch areas which the index needs to account for
+            if ((row + column) % 3 == 0) {
+                cellContent->setScaleX(1.5f);
+                cellContent->setScaleY(0.5f);
+            }
+            if ((row + column) % 4 == 0) {
+                cell->setTranslationX(12);
+            }
+            if (row % 2 == 0) {
+                cellContent->setTouchAreaExtension(8, 8, 8, 8);
+            }
+            if (column == 5) {
+                cell->setTouchEnabled(false);
+            }
+
+            snapshots.emplace_back(addCustomTouchGesture(cell));
+            snapshots.emplace_back(addCustomTouchGesture(cellContent));
+        }
+    }
+
+    const auto& touchDispatcher = root->getTouchDispatcher();
+    TouchHitTestIndex hitTestIndex;
+
+    for (Scalar y = -10; y <= 410; y += 7) {
+        for (Scalar x = -10; x <= 410; x += 7) {
+            auto event = createTouchEvent(TouchEventTypeDown, x, y);
+
+            auto expectedCandidates = touchDispatcher.getGestureCandidatesForEvent(event, rootView);
+            auto candidates = touchDispatcher.getGestureCandidatesForEvent(event, rootView, &hitTestIndex);
+
+            ASSERT_EQ(expectedCandidates, candidates) << "at " << x << ", " << y;
+        }
+    }
+}
+
+TEST(TouchDispatcher, updatesHitTestIndexIncrementallyWhenGeometryChanges) {
+    auto root = makeRoot();
+    auto rootView = createView(0, 0, 400, 400);
+    auto container = createView(0, 0, 400, 400);
+    rootView->addChild(container);
+    root->setContentLayer(rootView, ContentLayerSizingModeMatchSize);
+
+    std::vector<Ref<Layer>> cells;
+    std::vector<Ref<GestureRecognizerSnapshot>> snapshots;
+    for (int i = 0; i < 16; i++) {
+        auto cell = createView(static_cast<Scalar>((i % 4) * 100), static_cast<Scalar>((i / 4) * 100), 100, 100);
+        auto cellContent = createView(20, 20, 60, 60);
+        cell->addChild(cellContent);
+        container->addChild(cell);
+        cells.emplace_back(cell);
+
+        snapshots.emplace_back(addCustomTouchGesture(cell));
+        snapshots.emplace_back(addCustomTouchGesture(cellContent));
+    }
+
+    const auto& touchDispatcher = root->getTouchDispatcher();
+    TouchHitTestIndex hitTestIndex;
+    hitTestIndex.update(rootView);
+
+    auto assertMatchesRecursiveHitTest = [&]() {
+        if (hitTestIndex.needsUpdate(rootView)) {
+            hitTestIndex.update(rootView);
+        }
+
+        for (Scalar y = -10; y <= 410; y += 9) {
+            for (Scalar x = -10; x <= 410; x += 9) {
+                auto event = createTouchEvent(TouchEventTypeDown, x, y);
+
+                auto expectedCandidates = touchDispatcher.getGestureCandidatesForEvent(event, rootView);
+                auto candidates = touchDispatcher.getGestureCandidatesForEvent(event, rootView, &hitTestIndex);
+
+                ASSERT_EQ(expectedCandidates, candidates) << "at " << x << ", " << y;
+            }
+        }
+    };
+
+    // Scrolling moves every cell through the container
+    container->setFrame(Rect::makeXYWH(-30, -50, 400, 400));
+    hitTestIndex.setLayerNeedsUpdate(*container);
+    assertMatchesRecursiveHitTest();
+
+    // Nested updates, which need to be resolved relative to the updated container
+    cells[5]->setScaleX(0.5f);
+    cells[5]->setTranslationY(20);
+    hitTestIndex.setLayerNeedsUpdate(*cells[5]);
+    cells[6]->setTouchAreaExtension(30, 30, 30, 30);
+    hitTestIndex.setLayerNeedsUpdate(*cells[6]);
+    assertMatchesRecursiveHitTest();
+
+    container->setScaleY(2);
+    hitTestIndex.setLayerNeedsUpdate(*container);
+    assertMatchesRecursiveHitTest();
+
+    // Updating more layers than the index keeps track of rebuilds it
+    for (const auto& cell : cells) {
+        cell->setTranslationX(10);
+        hitTestIndex.setLayerNeedsUpdate(*cell);
+    }
+    assertMatchesRecursiveHitTest();
+}
+
+TEST(TouchDispatcher, updatesHitTestIndexWhenLayersChange) {
+    auto root = makeRoot();
+    auto rootView = createView(0, 0, 100, 100);
+    auto childView = createView(0, 0, 20, 20);
+    auto childView2 = createView(50, 50, 20, 20);
+
+    rootView->addChild(childView);
+    root->setContentLayer(rootView, ContentLayerSizingModeMatchSize);
+
+    auto snapshot = addCustomTouchGesture(childView);
+
+    root->dispatchTouchEvent(createTouchEvent(TouchEventTypeDown, 60, 60));
+    root->dispatchTouchEvent(createTouchEvent(TouchEventTypeUp, 60, 60));
+    ASSERT_EQ(0, snapshot->counter);
+
+    childView->setFrame(Rect::makeXYWH(55, 55, 20, 20));
+
+    root->dispatchTouchEvent(createTouchEvent(TouchEventTypeDown, 60, 60));
+    ASSERT_EQ(GestureRecognizerStateBegan, snapshot->state);
+    root->dispatchTouchEvent(createTouchEvent(TouchEventTypeUp, 60, 60));
+
+    // The new sibling covers the child
+    rootView->addChild(childView2);
+    auto counter = snapshot->counter;
+
+    root->dispatchTouchEvent(createTouchEvent(TouchEventTypeDown, 60, 60));
+    root->dispatchTouchEvent(createTouchEvent(TouchEventTypeUp, 60, 60));
+    ASSERT_EQ(counter, snapshot->counter);
+
+    childView2->setTouchEnabled(false);
+
+    root->dispatchTouchEvent(createTouchEvent(TouchEventTypeDown, 60, 60));
+    ASSERT_EQ(GestureRecognizerStateBegan, snapshot->state);
+    ASSERT_EQ(counter + 1, snapshot->counter);
+}
+
+TEST(TouchDispatcher, hitTestIndexReleasesRemovedLayers) {
+    auto root = makeRoot();
+    auto rootView = createView(0, 0, 100, 100);
+    auto childView = createView(0, 0, 20, 20);
+
+    rootView->addChild(childView);
+    root->setContentLayer(rootView, ContentLayerSizingModeMatchSize);
+
+    root->dispatchTouchEvent(createTouchEvent(TouchEventTypeDown, 10, 10));
+    root->dispatchTouchEvent(createTouchEvent(TouchEventTypeUp, 10, 10));
+
+    childView->removeFromParent();
+    ASSERT_EQ(1, childView.use_count());
+
+    root->setContentLayer(nullptr, ContentLayerSizingModeMatchSize);
+    ASSERT_EQ(1, rootView.use_count());
+}
+
 } // namespace snap::drawing
@@ -2,10 +2,13 @@
 
 #include "TestDataUtils.hpp"
 #include "snap_drawing/cpp/Text/FontManager.hpp"
+#include "snap_drawing/cpp/Text/TextShaperHarfbuzz.hpp"
 #include "snap_drawing/cpp/Text/WordCachingTextShaper.hpp"
 #include "snap_drawing/cpp/Utils/UTFUtils.hpp"
 #include "valdi_core/cpp/Utils/ConsoleLogger.hpp"
 
+#include <thread>
+
 namespace snap::drawing {
 
 struct TextShaperRequest {
@@ -17,6 +20,7 @@ struct TextShaperRequest {
 };
 
 struct TestTextShaper : public TextShaper {
+    Valdi::Mutex mutex;
     std::vector<TextShaperRequest> shapeRequests;
 
     TextParagraphList resolveParagraphs(const Character* unicodeText, size_t length, bool isRightToLeft) override {
@@ -37,6 +41,7 @@ struct TestTextShaper : public TextShaper {
         request.letterSpacing = letterSpacing;
         request.script = script;
 
+        std::lock_guard<Valdi::Mutex> lock(mutex);
         shapeRequests.emplace_back(request);
 
         auto glyphsStart = out.size();
@@ -271,4 +276,180 @@ TEST_F(WordCachingTextShaperTest, canPrioritizeCacheHit) {
     glyphs.clear();
 }
 
+TEST_F(WordCachingTextShaperTest, tracksCacheHitsAndMisses) {
+    WordCachingTextShaper textShaper(testTextShaper, WordCachingTextShaperStrategy::PrioritizeCorrectness);
+
+    auto unicode = utf8ToUnicode("word other word");
+
+    std::vector<ShapedGlyph> glyphs;
+
+    textShaper.shape(unicode.data(), unicode.size(), *avenirNext, false, 1.0f, TextScript::invalid(), glyphs);
+
+    auto stats = textShaper.getStats();
+    ASSERT_EQ(static_cast<uint64_t>(1), stats.hits);
+    ASSERT_EQ(static_cast<uint64_t>(2), stats.misses);
+    ASSERT_EQ(static_cast<uint64_t>(0), stats.evictions);
+
+    glyphs.clear();
+    textShaper.shape(unicode.data(), unicode.size(), *avenirNext, false, 1.0f, TextScript::invalid(), glyphs);
+
+    stats = textShaper.getStats();
+    ASSERT_EQ(static_cast<uint64_t>(4), stats.hits);
+    ASSERT_EQ(static_cast<uint64_t>(2), stats.misses);
+}
+
+TEST_F(WordCachingTextShaperTest, canShapeFromMultipleThreads) {
+    WordCachingTextShaper textShaper(testTextShaper, WordCachingTextShaperStrategy::PrioritizeCorrectness);
+
+    auto unicode = utf8ToUnicode("This is a sentence that is shaped from many threads");
+
+    std::vector<ShapedGlyph> expectedGlyphs;
+    testTextShaper->shape(
+        unicode.data(), unicode.size(), *avenirNext, false, 1.0f, TextScript::invalid(), expectedGlyphs);
+    testTextShaper->shapeRequests.clear();
+
+    constexpr size_t kThreadsCount = 4;
+    std::vector<std::thread> threads;
+    std::vector<std::vector<ShapedGlyph>> glyphsByThread(kThreadsCount);
+
+    for (size_t i = 0; i < kThreadsCount; i++) {
+        threads.emplace_back([&, i]() {
+            for (size_t j = 0; j < 100; j++) {
+                auto& glyphs = glyphsByThread[i];
+                glyphs.clear();
+                textShaper.shape(
+                    unicode.data(), unicode.size(), *avenirNext, false, 1.0f, TextScript::invalid(), glyphs);
+            }
+        });
+    }
+
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    for (const auto& glyphs : glyphsByThread) {
+        ASSERT_EQ(expectedGlyphs.size(), glyphs.size());
+        for (size_t i = 0; i < glyphs.size(); i++) {
+            ASSERT_EQ(expectedGlyphs[i].character(), glyphs[i].character());
+            ASSERT_EQ(expectedGlyphs[i].advanceX, glyphs[i].advanceX);
+        }
+    }
+
+    auto stats = textShaper.getStats();
+    // Each shape call looks up 10 words
+    ASSERT_EQ(static_cast<uint64_t>(kThreadsCount * 100 * 10), stats.hits + stats.misses);
+}
+
+TEST_F(WordCachingTextShaperTest, harfbuzzShaperCanShapeFromMultipleThreads) {
+    auto harfbuzzShaper = Valdi::makeShared<TextShaperHarfbuzz>();
+
+    auto unicode = utf8ToUnicode("Shaping misses should not wait for the other threads");
+
+    std::vector<ShapedGlyph> expectedGlyphs;
+    harfbuzzShaper->shape(
+        unicode.data(), unicode.size(), *avenirNext, false, 0.0f, TextScript::invalid(), expectedGlyphs);
+    ASSERT_FALSE(expectedGlyphs.empty());
+
+    constexpr size_t kThreadsCount = 4;
+    std::vector<std::thread> threads;
+    std::vector<std::vector<ShapedGlyph>> glyphsByThread(kThreadsCount);
+
+    for (size_t i = 0; i < kThreadsCount; i++) {
+        threads.emplace_back([&, i]() {
+            for (size_t j = 0; j < 100; j++) {
+                auto& glyphs = glyphsByThread[i];
+                glyphs.clear();
+                harfbuzzShaper->shape(
+                    unicode.data(), unicode.size(), *avenirNext, false, 0.0f, TextScript::invalid(), glyphs);
+            }
+        });
+    }
+
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    for (const auto& glyphs : glyphsByThread) {
+        ASSERT_EQ(expectedGlyphs.size(), glyphs.size());
+        for (size_t i = 0; i < glyphs.size(); i++) {
+            ASSERT_EQ(expectedGlyphs[i].glyphID, glyphs[i].glyphID);
+            ASSERT_EQ(expectedGlyphs[i].advanceX, glyphs[i].advanceX);
+        }
+    }
+}
+
+TEST_F(WordCachingTextShaperTest, canWarmUpFromSnapshot) {
+    auto unicode = utf8ToUnicode("This is a sentence");
+
+    WordCachingTextShaper textShaper(testTextShaper, WordCachingTextShaperStrategy::PrioritizeCorrectness);
+    ASSERT_TRUE(textShaper.makeCacheSnapshot().empty());
+
+    std::vector<ShapedGlyph> expectedGlyphs;
+    textShaper.shape(unicode.data(), unicode.size(), *avenirNext, false, 1.0f, TextScript::invalid(), expectedGlyphs);
+    ASSERT_EQ(static_cast<size_t>(4), testTextShaper->shapeRequests.size());
+    testTextShaper->shapeRequests.clear();
+
+    auto snapshot = textShaper.makeCacheSnapshot();
+    ASSERT_FALSE(snapshot.empty());
+
+    WordCachingTextShaper warmTextShaper(testTextShaper, WordCachingTextShaperStrategy::PrioritizeCorrectness);
+    auto result = warmTextShaper.loadCacheSnapshot(snapshot);
+    ASSERT_TRUE(result) << result.description();
+
+    std::vector<ShapedGlyph> glyphs;
+    warmTextShaper.shape(unicode.data(), unicode.size(), *avenirNext, false, 1.0f, TextScript::invalid(), glyphs);
+
+    ASSERT_EQ(static_cast<size_t>(0), testTextShaper->shapeRequests.size());
+    ASSERT_EQ(expectedGlyphs, glyphs);
+
+    // Entries of other font sizes are not part of the snapshot
+    glyphs.clear();
+    warmTextShaper.shape(unicode.data(),
+                         unicode.size(),
+                         *avenirNext->withSize(12.0f).value(),
+                         false,
+                         1.0f,
+                         TextScript::invalid(),
+                         glyphs);
+    ASSERT_EQ(static_cast<size_t>(4), testTextShaper->shapeRequests.size());
+}
+
+TEST_F(WordCachingTextShaperTest, restoresSnapshotOfTypefacesUsedBeforeLoading) {
+    auto unicode = utf8ToUnicode("This is a sentence");
+
+    WordCachingTextShaper textShaper(testTextShaper, WordCachingTextShaperStrategy::PrioritizeCorrectness);
+    std::vector<ShapedGlyph> expectedGlyphs;
+    textShaper.shape(unicode.data(), unicode.size(), *avenirNext, false, 1.0f, TextScript::invalid(), expectedGlyphs);
+    auto snapshot = textShaper.makeCacheSnapshot();
+    testTextShaper->shapeRequests.clear();
+
+    // The typeface is already known to the shards when the snapshot gets loaded
+    WordCachingTextShaper warmTextShaper(testTextShaper, WordCachingTextShaperStrategy::PrioritizeCorrectness);
+    auto otherUnicode = utf8ToUnicode("Other words");
+    std::vector<ShapedGlyph> glyphs;
+    warmTextShaper.shape(
+        otherUnicode.data(), otherUnicode.size(), *avenirNext, false, 1.0f, TextScript::invalid(), glyphs);
+    ASSERT_EQ(static_cast<size_t>(2), testTextShaper->shapeRequests.size());
+    testTextShaper->shapeRequests.clear();
+
+    auto result = warmTextShaper.loadCacheSnapshot(snapshot);
+    ASSERT_TRUE(result) << result.description();
+
+    glyphs.clear();
+    warmTextShaper.shape(unicode.data(), unicode.size(), *avenirNext, false, 1.0f, TextScript::invalid(), glyphs);
+
+    ASSERT_EQ(static_cast<size_t>(0), testTextShaper->shapeRequests.size());
+    ASSERT_EQ(expectedGlyphs, glyphs);
+}
+
+TEST_F(WordCachingTextShaperTest, rejectsInvalidSnapshot) {
+    WordCachingTextShaper textShaper(testTextShaper, WordCachingTextShaperStrategy::PrioritizeCorrectness);
+
+    std::string_view invalidSnapshot = "not a snapshot";
+    auto result = textShaper.loadCacheSnapshot(Valdi::BytesView(
+        nullptr, reinterpret_cast<const Valdi::Byte*>(invalidSnapshot.data()), invalidSnapshot.size()));
+
+    ASSERT_FALSE(result);
+}
+
 } // namespace snap::drawing
@@ -35,15 +35,21 @@ export interface NativeMessageEvent<T = unknown> {
 
 export type OnMessageFunc<T> = (msg: NativeMessageEvent<T>) => void;
 
+/**
+ * Values which can be transferred through postMessage(). Transferred ArrayBuffers are
+ * detached from the sender and their contents are moved to the receiver without copying.
+ */
+export type NativeTransferable = NativeMessagePort | ArrayBuffer | ArrayBufferView;
+
 export interface NativeMessagePort {
   onmessage: OnMessageFunc<unknown> | null;
-  postMessage<T>(data: T, transfer?: readonly NativeMessagePort[]): void;
+  postMessage<T>(data: T, transfer?: readonly NativeTransferable[]): void;
   start(): void;
   close(): void;
 }
 
 export interface NativeWorker {
-  postMessage<T>(data: T, transfer?: readonly NativeMessagePort[]): void;
+  postMessage<T>(data: T, transfer?: readonly NativeTransferable[]): void;
   setOnMessage<T>(f: OnMessageFunc<T>): void;
   terminate(): void;
 }
@@ -1,4 +1,4 @@
-import type { NativeMessageEvent, NativeMessagePort, NativeWorker, ValdiRuntime } from 'valdi_core/src/ValdiRuntime';
+import type { NativeMessageEvent, NativeTransferable, NativeWorker, ValdiRuntime } from 'valdi_core/src/ValdiRuntime';
 
 declare const runtime: ValdiRuntime;
 
@@ -19,9 +19,9 @@ export class Worker {
     }
   }
 
-  public postMessage<T>(data: T, transfer?: readonly MessagePort[]): void {
+  public postMessage<T>(data: T, transfer?: readonly (MessagePort | ArrayBuffer | ArrayBufferView)[]): void {
     if (this.nativeWorker) {
-      this.nativeWorker.postMessage(data, transfer as readonly NativeMessagePort[] | undefined);
+      this.nativeWorker.postMessage(data, transfer as readonly NativeTransferable[] | undefined);
     }
   }
 
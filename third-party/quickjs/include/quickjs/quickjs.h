@@ -787,6 +787,8 @@ JSValue JS_NewArrayBuffer(
     JSContext* ctx, uint8_t* buf, size_t len, JSFreeArrayBufferDataFunc* free_func, void* opaque, JS_BOOL is_shared);
 JSValue JS_NewArrayBufferCopy(JSContext* ctx, const uint8_t* buf, size_t len);
 void JS_DetachArrayBuffer(JSContext* ctx, JSValueConst obj);
+uint8_t* JS_TransferArrayBuffer(
+    JSContext* ctx, size_t* psize, JSFreeArrayBufferDataFunc** pfree_func, void** popaque, JSValueConst obj);
 uint8_t* JS_GetArrayBuffer(JSContext* ctx, size_t* psize, JSValueConst obj);
 JSValue JS_GetTypedArrayBuffer(
     JSContext* ctx, JSValueConst obj, size_t* pbyte_offset, size_t* pbyte_length, size_t* pbytes_per_element);
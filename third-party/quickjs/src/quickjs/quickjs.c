@@ -50213,6 +50213,40 @@ void JS_DetachArrayBuffer(JSContext* ctx, JSValueConst obj) {
     }
 }
 
+/* Detach the array buffer like JS_DetachArrayBuffer() but hand its data over to the caller instead of
+   freeing it. On success, *pfree_func and *popaque are set to what the data must be freed with. Data
+   allocated by the runtime is handed over with a NULL free function and must be freed with free().
+   Return NULL if the array buffer cannot be transferred. */
+uint8_t* JS_TransferArrayBuffer(JSContext* ctx,
+                                size_t* psize,
+                                JSFreeArrayBufferDataFunc** pfree_func,
+                                void** popaque,
+                                JSValueConst obj) {
+    JSArrayBuffer* abuf = JS_GetOpaque(obj, JS_CLASS_ARRAY_BUFFER);
+    JSRuntime* rt = ctx->rt;
+    uint8_t* data;
+
+    if (!abuf || abuf->detached || abuf->shared || !abuf->data)
+        return NULL;
+    if (abuf->free_func == js_array_buffer_free) {
+        /* only the default allocator is known to allocate with malloc() */
+        if (rt->mf.js_free != js_def_free)
+            return NULL;
+        rt->malloc_state.malloc_count--;
+        rt->malloc_state.malloc_size -= js_def_malloc_usable_size(abuf->data) + MALLOC_OVERHEAD;
+        *pfree_func = NULL;
+        *popaque = NULL;
+    } else {
+        *pfree_func = abuf->free_func;
+        *popaque = abuf->opaque;
+    }
+    data = abuf->data;
+    *psize = abuf->byte_length;
+    abuf->free_func = NULL;
+    JS_DetachArrayBuffer(ctx, obj);
+    return data;
+}
+
 /* get an ArrayBuffer or SharedArrayBuffer */
 static JSArrayBuffer* js_get_array_buffer(JSContext* ctx, JSValueConst obj) {
     JSObject* p;
@@ -14,6 +14,8 @@
 #include <yoga/event/event.h>
 #include <yoga/node/Node.h>
 
+#include <new>
+
 using namespace facebook;
 using namespace facebook::yoga;
 
@@ -30,6 +32,22 @@ YGNodeRef YGNodeNewWithConfig(const YGConfigConstRef config) {
   return node;
 }
 
+YGNodeRef YGNodeNewWithConfigInPlace(
+    void* storage,
+    const YGConfigConstRef config) {
+  auto* node = new (storage) yoga::Node{resolveRef(config)};
+  yoga::assertFatal(
+      config != nullptr, "Tried to construct YGNode with null config");
+  Event::publish<Event::NodeAllocation>(node, {config});
+
+  return node;
+}
+
+size_t YGNodeGetStorageSize(void) {
+  static_assert(alignof(yoga::Node) <= 16);
+  return sizeof(yoga::Node);
+}
+
 YGNodeRef YGNodeClone(YGNodeConstRef oldNodeRef) {
   auto oldNode = resolveRef(oldNodeRef);
   const auto node = new yoga::Node(*oldNode);
@@ -38,9 +56,7 @@ YGNodeRef YGNodeClone(YGNodeConstRef oldNodeRef) {
   return node;
 }
 
-void YGNodeFree(const YGNodeRef nodeRef) {
-  const auto node = resolveRef(nodeRef);
-
+static void detachNodeForFree(yoga::Node* node) {
   if (auto owner = node->getOwner()) {
     owner->removeChild(node);
     node->setOwner(nullptr);
@@ -55,7 +71,18 @@ void YGNodeFree(const YGNodeRef nodeRef) {
   node->clearChildren();
 
   Event::publish<Event::NodeDeallocation>(node, {YGNodeGetConfig(node)});
-  delete resolveRef(node);
+}
+
+void YGNodeFree(const YGNodeRef nodeRef) {
+  const auto node = resolveRef(nodeRef);
+  detachNodeForFree(node);
+  delete node;
+}
+
+void YGNodeFreeInPlace(const YGNodeRef nodeRef) {
+  const auto node = resolveRef(nodeRef);
+  detachNodeForFree(node);
+  node->~Node();
 }
 
 void YGNodeFreeRecursive(YGNodeRef rootRef) {
@@ -48,6 +48,24 @@ YG_EXPORT YGNodeRef YGNodeClone(YGNodeConstRef node);
  */
 YG_EXPORT void YGNodeFree(YGNodeRef node);
 
+/**
+ * Returns the size of the storage needed by YGNodeNewWithConfigInPlace().
+ */
+YG_EXPORT size_t YGNodeGetStorageSize(void);
+
+/**
+ * Constructs a new Yoga node, with customized settings, in storage owned by the
+ * caller. The storage must be at least YGNodeGetStorageSize() bytes and aligned
+ * on 16 bytes. The node must be freed with YGNodeFreeInPlace().
+ */
+YG_EXPORT YGNodeRef
+YGNodeNewWithConfigInPlace(void* storage, YGConfigConstRef config);
+
+/**
+ * Same as YGNodeFree(), but leaves the storage of the node to the caller.
+ */
+YG_EXPORT void YGNodeFreeInPlace(YGNodeRef node);
+
 /**
  * Frees the subtree of Yoga nodes rooted at the given node.
  */
@@ -0,0 +1,57 @@
+#!/bin/bash
+
+# Trains a zstd dictionary for the entries of seekable module archives.
+#
+# Usage: train_dictionary.sh <output_dictionary> <dictionary_id> <sample_dir>...
+#
+# The samples should be the files that end up in the modules, like the compiled JS and JSON
+# files from the compiler's build directory. Every file is used as a separate sample, since
+# seekable archives compress their entries separately.
+# The dictionary is either shipped with the app, so its size is paid once, or embedded in the
+# module archives it makes smaller, so its size is paid once per module. The reported sizes
+# include the dictionary, which is what a module embedding it costs to download.
+# MAX_DICT_SIZE can be set to change the dictionary size, which defaults to 16KB.
+
+set -euo pipefail
+
+if [[ $# -lt 3 ]]; then
+    echo "Usage: $0 <output_dictionary> <dictionary_id> <sample_dir>..."
+    exit 1
+fi
+
+DIR=$(cd $(dirname "${BASH_SOURCE[0]}"); pwd -P)
+ZSTD="${DIR}/zstdw"
+
+OUTPUT=$1
+DICT_ID=$2
+shift 2
+
+SAMPLES_LIST=$(mktemp)
+trap "rm -f ${SAMPLES_LIST}" EXIT
+
+find "$@" -type f \( -name "*.js" -o -name "*.json" \) -not -path "*/node_modules/*" > "${SAMPLES_LIST}"
+
+SAMPLES_COUNT=$(wc -l < "${SAMPLES_LIST}" | tr -d ' ')
+if [[ "${SAMPLES_COUNT}" == "0" ]]; then
+    echo "No .js or .json samples found in $*"
+    exit 1
+fi
+
+echo "Training dictionary ${DICT_ID} from ${SAMPLES_COUNT} samples"
+xargs "${ZSTD}" --train --maxdict="${MAX_DICT_SIZE:-16384}" --dictID="${DICT_ID}" -f -o "${OUTPUT}" < "${SAMPLES_LIST}"
+
+# Compares the compression of the samples, compressed separately, with and without the dictionary
+compressed_size() {
+    xargs "${ZSTD}" -b19 -i1 "$@" < "${SAMPLES_LIST}" 2>&1 | tr '\r' '\n' | grep 'MB/s' | tail -n 1 \
+        | sed -E 's/.*-> *([0-9]+).*/\1/'
+}
+
+DICT_SIZE=$(wc -c < "${OUTPUT}" | tr -d ' ')
+SIZE_WITHOUT_DICT=$(compressed_size)
+SIZE_WITH_DICT=$(compressed_size -D "${OUTPUT}")
+
+echo "Without dictionary: ${SIZE_WITHOUT_DICT} bytes"
+echo "With dictionary: ${SIZE_WITH_DICT} bytes + ${DICT_SIZE} bytes of dictionary = $((SIZE_WITH_DICT + DICT_SIZE)) bytes"
+if [[ $((SIZE_WITH_DICT + DICT_SIZE)) -ge ${SIZE_WITHOUT_DICT} ]]; then
+    echo "The dictionary only pays for itself when shipped with the app rather than embedded"
+fi
@@ -16,6 +16,7 @@
 #include "valdi_core/jni/JavaUtils.hpp"
 
 #include "valdi/runtime/JavaScript/JavaScriptANRDetector.hpp"
+#include "valdi/runtime/Metrics/Metrics.hpp"
 #include "valdi/runtime/Resources/AssetLoader.hpp"
 #include "valdi/runtime/Resources/AssetLoaderManager.hpp"
 #include "valdi/runtime/Resources/DiskCacheImpl.hpp"
@@ -146,6 +147,8 @@ RuntimeManagerWrapper::RuntimeManagerWrapper(JavaEnv env,
                                                                            maxCacheSizeInBytes);
 
             snapDrawingRuntime->registerAssetLoaders(*_runtimeManager->getAssetLoaderManager());
+            snapDrawingRuntime->setMetrics(_runtimeManager->getMetrics());
+            snapDrawingRuntime->setRuntimeTweaks(_runtimeManager->getRuntimeTweaks());
             snapDrawingRuntime->getFontManager()->setListener(
                 Valdi::makeShared<snap::drawing::FontResolverWithRuntimeManager>(_runtimeManager));
             applyDynamicTypeScale(snapDrawingRuntime);
@@ -230,6 +233,7 @@ void RuntimeManagerWrapper::applicationWillPause() {
     auto snapDrawingRuntime = _snapDrawingRuntime.getIfCreated();
     if (snapDrawingRuntime) {
         snapDrawingRuntime.value()->getDrawLooper()->onApplicationEnteringBackground();
+        snapDrawingRuntime.value()->savePersistentTextShaperCache();
     }
 #endif
 }
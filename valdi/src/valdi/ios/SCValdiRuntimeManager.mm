@@ -590,6 +590,8 @@ static void updateRuntimeManagersArray(void (^callback)(NSMutableArray<NSValue *
                                    workerQueue:_cppInstance->getWorkerQueue().get()
                                    assetLoaderManager:_cppInstance->getAssetLoaderManager().get()
                                    maxCacheSizeInBytes:maxCacheSizeInBytes];
+            Valdi::unsafeBridgeUnretained<snap::drawing::Runtime>([_snapDrawingRuntime handle])
+                ->setRuntimeTweaks(_cppInstance->getRuntimeTweaks());
         }
 
         return _snapDrawingRuntime;
@@ -86,6 +86,7 @@ private:
 - (void)onApplicationEnteringBackground
 {
     _instance->getDrawLooper()->onApplicationEnteringBackground();
+    _instance->savePersistentTextShaperCache();
 }
 
 - (void)onApplicationEnteringForeground
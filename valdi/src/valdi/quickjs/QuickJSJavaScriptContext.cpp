@@ -64,6 +64,18 @@ void freeByteBuffer(JSRuntime* rt, void* opaque, void* /*ptr*/) {
     Valdi::unsafeBridgeRelease(opaque);
 }
 
+// Owns the data of an ArrayBuffer which was allocated by the QuickJS runtime and transferred out of it
+class TransferredArrayBufferData : public Valdi::SimpleRefCountable {
+public:
+    explicit TransferredArrayBufferData(uint8_t* data) : _data(data) {}
+    ~TransferredArrayBufferData() override {
+        free(_data);
+    }
+
+private:
+    uint8_t* _data;
+};
+
 static void handleRejectedPromise(
     JSContext* ctx, JSValueConst promise, JSValueConst reason, JS_BOOL is_handled, void* opaque) {
     auto& jsContext = *reinterpret_cast<QuickJSJavaScriptContext*>(opaque);
@@ -1138,6 +1150,49 @@ Valdi::JSTypedArray QuickJSJavaScriptContext::valueToTypedArray(const Valdi::JSV
     }
 }
 
+Valdi::BytesView QuickJSJavaScriptContext::detachArrayBuffer(const Valdi::JSValue& value,
+                                                             Valdi::JSExceptionTracker& exceptionTracker) {
+    auto guard = _threadAccessChecker.guard();
+    auto jsValue = fromValdiJSValue(value);
+
+    Valdi::JSValueRef arrayBuffer;
+    if (JS_IsArrayBuffer(_context, jsValue) == 0) {
+        arrayBuffer = checkCallAndGetValue(exceptionTracker,
+                                           JS_GetTypedArrayBuffer(_context, jsValue, nullptr, nullptr, nullptr));
+        if (!exceptionTracker) {
+            return Valdi::BytesView();
+        }
+        jsValue = fromValdiJSValue(arrayBuffer.get());
+    }
+
+    size_t size = 0;
+    JSFreeArrayBufferDataFunc* freeFunction = nullptr;
+    void* opaque = nullptr;
+    auto* data = JS_TransferArrayBuffer(_context, &size, &freeFunction, &opaque, jsValue);
+    if (data == nullptr) {
+        return Valdi::BytesView();
+    }
+
+    Valdi::Ref<Valdi::RefCountable> source;
+    if (freeFunction == nullptr) {
+        source = Valdi::makeShared<TransferredArrayBufferData>(data);
+    } else if (freeFunction == &freeArrayBuffer || freeFunction == &freeByteBuffer) {
+        // ArrayBuffers created from native bytes in newArrayBuffer() retain their source as opaque
+        source = Valdi::unsafeBridgeTransfer<Valdi::RefCountable>(opaque);
+        if (freeFunction == &freeByteBuffer) {
+            JS_DecreaseExternallyAllocatedMemory(
+                _runtime, dynamic_cast<Valdi::ByteBuffer*>(source.get())->capacity());
+        }
+    } else {
+        // The data can only be released through the runtime, hand over a copy of it instead
+        auto copy = Valdi::makeShared<Valdi::ByteBuffer>(data, data + size);
+        freeFunction(_runtime, opaque, data);
+        return copy->toBytesView();
+    }
+
+    return Valdi::BytesView(source, data, size);
+}
+
 Valdi::ValueType QuickJSJavaScriptContext::getValueType(const Valdi::JSValue& value) {
     auto guard = _threadAccessChecker.guard();
     auto jsValue = fromValdiJSValue(value);
@@ -166,6 +166,9 @@ public:
     Valdi::JSTypedArray valueToTypedArray(const Valdi::JSValue& value,
                                           Valdi::JSExceptionTracker& exceptionTracker) override;
 
+    Valdi::BytesView detachArrayBuffer(const Valdi::JSValue& value,
+                                       Valdi::JSExceptionTracker& exceptionTracker) override;
+
     Valdi::ValueType getValueType(const Valdi::JSValue& value) override;
 
     bool isValueUndefined(const Valdi::JSValue& value) override;
@@ -32,6 +32,26 @@ ViewNodeAttribute::~ViewNodeAttribute() {
     }
 }
 
+Ref<ViewNodeAttribute> ViewNodeAttribute::make(SlabAllocator* allocator, const AttributeHandler* handler) {
+    return Ref<ViewNodeAttribute>(new (allocator) ViewNodeAttribute(handler), AdoptRef());
+}
+
+void* ViewNodeAttribute::operator new(size_t size) {
+    return SlabAllocator::allocateTagged(nullptr, size);
+}
+
+void* ViewNodeAttribute::operator new(size_t size, SlabAllocator* allocator) {
+    return SlabAllocator::allocateTagged(allocator, size);
+}
+
+void ViewNodeAttribute::operator delete(void* ptr) {
+    SlabAllocator::deallocateTagged(ptr);
+}
+
+void ViewNodeAttribute::operator delete(void* ptr, SlabAllocator* /*allocator*/) {
+    SlabAllocator::deallocateTagged(ptr);
+}
+
 Value ViewNodeAttribute::getValue(const AttributeOwner* owner) const {
     if (_hasSingleAttribute) {
         const auto& attributeValue = getSingleAttributeValue();
@@ -441,8 +461,8 @@ void ViewNodeAttribute::markAppliedValueDirty() {
     _appliedValueDirty = true;
 }
 
-Ref<ViewNodeAttribute> ViewNodeAttribute::copy() {
-    auto copy = makeShared<ViewNodeAttribute>(_handler);
+Ref<ViewNodeAttribute> ViewNodeAttribute::copy(SlabAllocator* allocator) {
+    auto copy = make(allocator, _handler);
 
     if (!empty()) {
         auto result = getResolvedPreprocessedValue();
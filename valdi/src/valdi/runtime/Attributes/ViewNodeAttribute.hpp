@@ -12,6 +12,7 @@
 #include "valdi/runtime/Attributes/PreprocessorCache.hpp"
 #include "valdi_core/cpp/Utils/Result.hpp"
 #include "valdi_core/cpp/Utils/Shared.hpp"
+#include "valdi_core/cpp/Utils/SlabAllocator.hpp"
 #include "valdi_core/cpp/Utils/SmallVector.hpp"
 #include "valdi_core/cpp/Utils/Value.hpp"
 
@@ -30,6 +31,18 @@ public:
     explicit ViewNodeAttribute(const AttributeHandler* handler);
     ~ViewNodeAttribute() override;
 
+    /**
+     Create an attribute allocated from the given allocator, or from the system allocator if null.
+     */
+    static Ref<ViewNodeAttribute> make(SlabAllocator* allocator, const AttributeHandler* handler);
+
+    // Attributes remember the allocator they were allocated from, so that they can be released
+    // through their ref count like any other attribute.
+    static void* operator new(size_t size);
+    static void* operator new(size_t size, SlabAllocator* allocator);
+    static void operator delete(void* ptr);
+    static void operator delete(void* ptr, SlabAllocator* allocator);
+
     /**
      Update the attribute to the given ViewNode.
      This function will be a no-op if no updates need to be done.
@@ -49,9 +62,9 @@ public:
     void willAnimate();
 
     /**
-     Copy this attribute with its resolved value
+     Copy this attribute with its resolved value, allocating the copy from the given allocator
      */
-    Ref<ViewNodeAttribute> copy();
+    Ref<ViewNodeAttribute> copy(SlabAllocator* allocator);
 
     /**
      Returns the value for the given owner.
@@ -430,7 +430,7 @@ Ref<ViewNodeAttribute> ViewNodeAttributesApplier::emplaceAttribute(AttributeId i
         return nullptr;
     }
 
-    auto attribute = makeShared<ViewNodeAttribute>(attributeHandler);
+    auto attribute = ViewNodeAttribute::make(_viewNode->getAllocator(), attributeHandler);
 
     _attributes.mutate([&](auto& container) { container[id] = attribute; });
 
@@ -443,7 +443,9 @@ void ViewNodeAttributesApplier::copyViewLayoutAttributes(ViewNodeAttributesAppli
             auto name = it.first;
             auto attribute = it.second;
 
-            attributesApplier._attributes.mutate([&](auto& container) { container[name] = attribute->copy(); });
+            auto copy = attribute->copy(attributesApplier._viewNode->getAllocator());
+
+            attributesApplier._attributes.mutate([&](auto& container) { container[name] = std::move(copy); });
         }
     }
 }
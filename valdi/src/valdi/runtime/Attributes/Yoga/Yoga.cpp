@@ -6,6 +6,7 @@
 //
 
 #include "valdi/runtime/Attributes/Yoga/Yoga.hpp"
+#include "valdi_core/cpp/Utils/SlabAllocator.hpp"
 #include "valdi_core/cpp/Views/Frame.hpp"
 #include <yoga/Yoga.h>
 #include <yoga/node/Node.h>
@@ -28,6 +29,24 @@ void Yoga::destroyNode(YGNode* node) {
     YGNodeFree(node);
 }
 
+YGNode* Yoga::createNode(YGConfig* config, SlabAllocator* allocator) {
+    if (allocator == nullptr) {
+        return createNode(config);
+    }
+
+    return YGNodeNewWithConfigInPlace(allocator->allocate(YGNodeGetStorageSize()), config);
+}
+
+void Yoga::destroyNode(YGNode* node, SlabAllocator* allocator) {
+    if (allocator == nullptr) {
+        destroyNode(node);
+        return;
+    }
+
+    YGNodeFreeInPlace(node);
+    SlabAllocator::deallocate(node, YGNodeGetStorageSize());
+}
+
 void Yoga::attachViewNode(YGNode* node, ViewNode* viewNode) {
     facebook::yoga::resolveRef(node)->setContext(viewNode);
 }
@@ -14,6 +14,7 @@ struct YGConfig;
 
 namespace Valdi {
 class ViewNode;
+class SlabAllocator;
 
 using YGNodeSharedPtr = std::shared_ptr<YGNode>;
 
@@ -24,6 +25,13 @@ public:
     static YGNode* createNode(YGConfig* config);
     static void destroyNode(YGNode* node);
 
+    /**
+     Create a node allocated from the given allocator, or from the system allocator
+     if null. The node must be destroyed with the same allocator.
+     */
+    static YGNode* createNode(YGConfig* config, SlabAllocator* allocator);
+    static void destroyNode(YGNode* node, SlabAllocator* allocator);
+
     static void attachViewNode(YGNode* node, ViewNode* viewNode);
     static void detachViewNode(YGNode* node);
     static ViewNode* getAttachedViewNode(YGNode* node);
@@ -28,6 +28,7 @@
 #include "valdi/runtime/Views/MeasureDelegate.hpp"
 #include "valdi/runtime/Views/ViewTransactionScope.hpp"
 #include "valdi_core/cpp/Constants.hpp"
+#include "valdi_core/cpp/Threading/WorkStealingExecutor.hpp"
 #include "valdi_core/cpp/Utils/LoggerUtils.hpp"
 #include "valdi_core/cpp/Utils/ObjectPool.hpp"
 #include "valdi_core/cpp/Utils/StringCache.hpp"
@@ -55,7 +56,7 @@ namespace Valdi {
 YGSize ygMeasureYoga(YGNodeConstRef node, float width, YGMeasureMode widthMode, float height, YGMeasureMode heightMode);
 void ygDirtiedCallback(YGNodeConstRef node);
 
-void destroyYogaNode(YGNode* yogaNode) {
+void destroyYogaNode(YGNode* yogaNode, SlabAllocator* allocator) {
     if (yogaNode == nullptr) {
         return;
     }
@@ -63,7 +64,7 @@ void destroyYogaNode(YGNode* yogaNode) {
     node->setContext(nullptr);
     node->setDirtiedFunc(nullptr);
     node->setMeasureFunc(nullptr);
-    YGNodeFree(yogaNode);
+    Yoga::destroyNode(yogaNode, allocator);
 }
 
 void setupYogaNode(YGNode* yogaNode, ViewNode* viewNode) {
@@ -122,7 +123,7 @@ void LazyLayoutData::destroyNode() {
         while (YGNodeGetChildCount(yogaNode) > 0) {
             YGNodeRemoveChild(yogaNode, YGNodeGetChild(yogaNode, 0));
         }
-        destroyYogaNode(yogaNode);
+        destroyYogaNode(yogaNode, yogaNodeAllocator);
         yogaNode = nullptr;
     }
 }
@@ -179,8 +180,10 @@ constexpr size_t kHasOveriddenColorPalette = 36;
 ViewNode::ViewNode(YGConfig* yogaConfig,
                    AttributeIds& attributeIds,
                    const Ref<ColorPalette>& colorPalette,
-                   ILogger& logger)
-    : _yogaNode(yogaConfig != nullptr ? Yoga::createNode(yogaConfig) : nullptr),
+                   ILogger& logger,
+                   const Ref<SlabAllocator>& allocator)
+    : _allocator(allocator),
+      _yogaNode(yogaConfig != nullptr ? Yoga::createNode(yogaConfig, allocator.get()) : nullptr),
       _attributeIds(attributeIds),
       _logger(logger),
       _attributesApplier(this),
@@ -197,7 +200,7 @@ ViewNode::ViewNode(YGConfig* yogaConfig,
 
 ViewNode::~ViewNode() {
     _attributesApplier.destroy();
-    destroyYogaNode(_yogaNode);
+    destroyYogaNode(_yogaNode, _allocator.get());
     _lazyLayoutData = nullptr;
 }
 
@@ -1588,6 +1591,13 @@ void ViewNode::setChildrenIndexerNeedsUpdate() {
     }
 }
 
+void ViewNode::setChildrenIndexerChildNeedsUpdate(ViewNode* child) {
+    if (_childrenIndexer != nullptr) {
+        _childrenIndexer->setChildNeedsUpdate(child);
+        setCalculatedViewportHasChildNeedsUpdate();
+    }
+}
+
 void ViewNode::removeFromParent(ViewTransactionScope& viewTransactionScope) {
     if (!hasParent()) {
         return;
@@ -1792,7 +1802,8 @@ Size ViewNode::onMeasure(float width, MeasureMode widthMode, float height, Measu
 
 Ref<ViewNode> ViewNode::makePlaceholderViewNode(ViewTransactionScope& viewTransactionScope,
                                                 const Ref<View>& placeholderView) {
-    auto viewNode = Valdi::makeShared<ViewNode>(nullptr, _attributeIds, _colorPalette, _logger);
+    auto viewNode =
+        Valdi::allocateShared<ViewNode>(_allocator.get(), nullptr, _attributeIds, _colorPalette, _logger, _allocator);
     viewNode->setViewNodeTree(_viewNodeTree);
     viewNode->setViewFactory(viewTransactionScope, _viewFactory);
     viewNode->_emittingViewNode = strongSmallRef(this);
@@ -1993,8 +2004,9 @@ LazyLayoutData& ViewNode::getOrCreateLazyLayoutData() {
 YGNode* ViewNode::getOrCreateDetachedYogaNode() {
     auto& lazyLayoutData = getOrCreateLazyLayoutData();
     if (lazyLayoutData.yogaNode == nullptr) {
-        lazyLayoutData.yogaNode =
-            Yoga::createNode(const_cast<facebook::yoga::Config*>(facebook::yoga::resolveRef(_yogaNode)->getConfig()));
+        lazyLayoutData.yogaNode = Yoga::createNode(
+            const_cast<facebook::yoga::Config*>(facebook::yoga::resolveRef(_yogaNode)->getConfig()), _allocator.get());
+        lazyLayoutData.yogaNodeAllocator = _allocator.get();
         setupYogaNode(lazyLayoutData.yogaNode, this);
     }
     return lazyLayoutData.yogaNode;
@@ -2178,6 +2190,10 @@ YGNode* ViewNode::getYogaNode() const {
     return _yogaNode;
 }
 
+SlabAllocator* ViewNode::getAllocator() const {
+    return _allocator.get();
+}
+
 SharedViewNode ViewNode::getParent() const {
     return _parent.lock();
 }
@@ -2606,6 +2622,10 @@ bool ViewNode::layoutFinished(ViewTransactionScope& viewTransactionScope, bool d
         parentChildrenIndexer = parent->_childrenIndexer.get();
     }
 
+    if (_viewNodeTree != nullptr && _viewNodeTree->getLazyLayoutExecutor() != nullptr) {
+        calculateLazyLayoutsConcurrently(*_viewNodeTree->getLazyLayoutExecutor(), didPerformLayout);
+    }
+
     VALDI_TRACE("Valdi.updateCalculatedFrames");
     auto calculatedFrameDidChange = layoutFinished(viewTransactionScope,
                                                    didPerformLayout,
@@ -2678,14 +2698,26 @@ bool ViewNode::updateCalculatedFrame(float viewOffsetX,
     return true;
 }
 
-bool ViewNode::updateLazyLayout() {
+bool ViewNode::syncLazyLayoutDirection() {
     // Using lazy-layout creates a new "detached" yoga subtree, so the device-level RTL/LTR style that
     // we set on the root node doesn't propagate to that detached subtree.
     // Need to manually set the Direction style on the detached subtree.
     auto direction = facebook::yoga::resolveRef(_yogaNode)->getLayout().direction();
     auto previousDirection = facebook::yoga::resolveRef(_lazyLayoutData->yogaNode)->getLayout().direction();
-    auto directionHasChanged = direction != previousDirection;
     getYogaStyle(_lazyLayoutData->yogaNode).setDirection(direction);
+    return direction != previousDirection;
+}
+
+bool ViewNode::updateLazyLayout() {
+    if (_lazyLayoutData->calculatedConcurrently) {
+        _lazyLayoutData->calculatedConcurrently = false;
+        if (_lazyLayoutData->availableWidth == _calculatedFrame.width &&
+            _lazyLayoutData->availableHeight == _calculatedFrame.height) {
+            return true;
+        }
+    }
+
+    auto directionHasChanged = syncLazyLayoutDirection();
 
     auto sizeHasChanged = _lazyLayoutData->availableWidth != _calculatedFrame.width ||
                           _lazyLayoutData->availableHeight != _calculatedFrame.height;
@@ -2707,6 +2739,104 @@ bool ViewNode::updateLazyLayout() {
     return updated;
 }
 
+void ViewNode::calculateLazyLayoutsConcurrently(WorkStealingExecutor& executor, bool didPerformLayout) {
+    std::vector<ViewNode*> lazyLayoutNodes;
+    collectConcurrentLazyLayouts(lazyLayoutNodes, didPerformLayout);
+
+    if (lazyLayoutNodes.size() < 2) {
+        // Nothing to gain, the layoutFinished() pass will calculate it
+        return;
+    }
+
+    VALDI_TRACE("Valdi.calculateLazyLayoutsConcurrently");
+    ScopedMetrics metrics = Metrics::scopedCalculateLazyLayoutLatency(
+        getMetrics(), getModuleName(), getBackendString(getBackend(_viewNodeTree)));
+
+    executor.parallelFor(lazyLayoutNodes.size(), ThreadQoSClassHigh, [&](size_t index) {
+        lazyLayoutNodes[index]->calculateLazyLayoutConcurrently();
+    });
+}
+
+void ViewNode::collectConcurrentLazyLayouts(std::vector<ViewNode*>& output, bool didPerformLayout) {
+    for (auto* childViewNode : *this) {
+        // Mirrors how layoutFinished() visits the tree: without a layout pass, only the branches
+        // leading to a dirty lazy layout are visited.
+        if (!didPerformLayout && !childViewNode->_flags[kHasLazyLayoutNeedingCalculationFlag]) {
+            continue;
+        }
+
+        if (childViewNode->_flags[kIsLazyLayoutFlag]) {
+            auto* lazyLayoutYogaNode = childViewNode->getLazyLayoutYogaNode();
+            if (lazyLayoutYogaNode == nullptr || !childViewNode->_flags[kVisibleInViewportFlag]) {
+                continue;
+            }
+
+            auto availableSize = ygNodeGetFrame(childViewNode->_yogaNode, 0).size();
+            auto directionHasChanged = childViewNode->syncLazyLayoutDirection();
+            auto sizeHasChanged = childViewNode->_lazyLayoutData->availableWidth != availableSize.width ||
+                                  childViewNode->_lazyLayoutData->availableHeight != availableSize.height;
+
+            if ((sizeHasChanged || directionHasChanged || resolveYogaNode(lazyLayoutYogaNode)->isDirty()) &&
+                childViewNode->canCalculateLayoutConcurrently()) {
+                output.emplace_back(childViewNode);
+            }
+
+            // Nested lazy layouts depend on the layout of this one, they are calculated
+            // serially in layoutFinished()
+            continue;
+        }
+
+        if (childViewNode->managesChildFrames()) {
+            continue;
+        }
+
+        childViewNode->collectConcurrentLazyLayouts(output, didPerformLayout);
+    }
+}
+
+bool ViewNode::canCalculateLayoutConcurrently() {
+    for (auto* childViewNode : *this) {
+        if (childViewNode->_lazyLayoutData != nullptr && childViewNode->_lazyLayoutData->onMeasureCallback != nullptr) {
+            // Measured by calling into JS
+            return false;
+        }
+
+        const auto& boundAttributes = childViewNode->_attributesApplier.getBoundAttributes();
+        if (boundAttributes != nullptr && boundAttributes->getMeasureDelegate() != nullptr &&
+            !boundAttributes->getMeasureDelegate()->isThreadSafe()) {
+            return false;
+        }
+
+        if (childViewNode->managesChildFrames() && childViewNode->getDetachedYogaNode() != nullptr) {
+            return false;
+        }
+
+        if (!childViewNode->_flags[kIsLazyLayoutFlag] && !childViewNode->canCalculateLayoutConcurrently()) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void ViewNode::calculateLazyLayoutConcurrently() {
+    // Called from a worker thread, this should only touch the detached yoga subtree of this node.
+    auto availableSize = ygNodeGetFrame(_yogaNode, 0).size();
+
+    MeasureMetrics measureCount;
+    doCalculateLayoutOnNode(_lazyLayoutData->yogaNode,
+                            availableSize.width,
+                            MeasureModeExactly,
+                            availableSize.height,
+                            MeasureModeExactly,
+                            LayoutDirectionLTR,
+                            measureCount);
+
+    _lazyLayoutData->availableWidth = availableSize.width;
+    _lazyLayoutData->availableHeight = availableSize.height;
+    _lazyLayoutData->calculatedConcurrently = true;
+}
+
 void ViewNode::updateStickyHeaders(bool refreshCache) {
     if (_scrollState == nullptr || !_scrollState->getNativeStickyEnabled()) {
         return;
@@ -3132,7 +3262,7 @@ bool ViewNode::layoutFinished(ViewTransactionScope& viewTransactionScope,
         }
 
         if (parentChildrenIndexer != nullptr) {
-            parentChildrenIndexer->setNeedsUpdate();
+            parentChildrenIndexer->setChildNeedsUpdate(this);
         }
 
         if (frameObserver != nullptr) {
@@ -4195,7 +4325,7 @@ void ViewNode::updateTranslation(float translation,
 
         auto parent = getParent();
         if (parent != nullptr) {
-            parent->setChildrenIndexerNeedsUpdate();
+            parent->setChildrenIndexerChildNeedsUpdate(this);
         }
     }
 }
@@ -23,6 +23,7 @@
 #include "valdi_core/cpp/Utils/Function.hpp"
 #include "valdi_core/cpp/Utils/ObjectPool.hpp"
 #include "valdi_core/cpp/Utils/Shared.hpp"
+#include "valdi_core/cpp/Utils/SlabAllocator.hpp"
 #include "valdi_core/cpp/Utils/Value.hpp"
 #include "valdi_core/cpp/Utils/ValueMap.hpp"
 #include <bitset>
@@ -37,6 +38,7 @@ namespace Valdi {
 class CSSDocument;
 class ViewNode;
 class ViewNodeChildrenIndexer;
+class WorkStealingExecutor;
 class ViewFactory;
 class View;
 class IViewNodeAssetHandler;
@@ -81,11 +83,16 @@ private:
 
 struct LazyLayoutData {
     YGNode* yogaNode = nullptr;
+    // Allocator of yogaNode, or null if it was allocated from the system allocator
+    SlabAllocator* yogaNodeAllocator = nullptr;
     float availableWidth = 0;
     float availableHeight = 0;
     float estimatedWidth = 0;
     float estimatedHeight = 0;
     Ref<ValueFunction> onMeasureCallback;
+    // Whether the layout was calculated ahead of the layoutFinished() pass by a worker,
+    // for the current availableWidth and availableHeight.
+    bool calculatedConcurrently = false;
 
     ~LazyLayoutData();
 
@@ -160,7 +167,16 @@ enum SimplifiedScrollDirection {
 
 class ViewNode : public SharedPtrRefCountable {
 public:
-    ViewNode(YGConfig* yogaConfig, AttributeIds& attributeIds, const Ref<ColorPalette>& colorPalette, ILogger& logger);
+    /**
+     Create a ViewNode. When an allocator is given, the yoga node and the attributes of the ViewNode
+     are allocated from it. The ViewNode itself should then be created with allocateShared() from
+     the same allocator, which is what ViewNodeTree::createViewNode() does.
+     */
+    ViewNode(YGConfig* yogaConfig,
+             AttributeIds& attributeIds,
+             const Ref<ColorPalette>& colorPalette,
+             ILogger& logger,
+             const Ref<SlabAllocator>& allocator = nullptr);
 
     ~ViewNode() override;
 
@@ -350,6 +366,12 @@ public:
 
     AttributesApplier& getAttributesApplier();
 
+    /**
+     Returns the allocator from which the yoga node and the attributes of this ViewNode
+     are allocated, or null if they are allocated from the system allocator.
+     */
+    SlabAllocator* getAllocator() const;
+
     std::optional<Point> onScroll(const Point& directionDependentContentOffset,
                                   const Point& directionDependentUnclampedContentOffset,
                                   const Point& directionDependentVelocity);
@@ -641,6 +663,8 @@ public:
     void setAssetHandler(const Ref<IViewNodeAssetHandler>& assetHandler);
 
 private:
+    // Allocator of the yoga nodes and attributes of this ViewNode, shared with its tree.
+    Ref<SlabAllocator> _allocator;
     YGNode* _yogaNode = nullptr;
     Weak<ViewNode> _parent;
     AttributeIds& _attributeIds;
@@ -716,6 +740,12 @@ private:
         float width, MeasureMode widthMode, float height, MeasureMode heightMode, bool forceLayout);
 
     bool updateLazyLayout();
+    bool syncLazyLayoutDirection();
+
+    void calculateLazyLayoutsConcurrently(WorkStealingExecutor& executor, bool didPerformLayout);
+    void collectConcurrentLazyLayouts(std::vector<ViewNode*>& output, bool didPerformLayout);
+    bool canCalculateLayoutConcurrently();
+    void calculateLazyLayoutConcurrently();
     void doUpdateViewTree(ViewTransactionScope& viewTransactionScope,
                           const Ref<View>& currentParentView,
                           bool parentVisibleInViewport,
@@ -831,6 +861,7 @@ private:
 
     void onChildrenChanged();
     void setChildrenIndexerNeedsUpdate();
+    void setChildrenIndexerChildNeedsUpdate(ViewNode* child);
 
     void updateTranslation(float translation, bool isPercent, ViewNodeTranslation* outTranslation, size_t percentFlag);
 
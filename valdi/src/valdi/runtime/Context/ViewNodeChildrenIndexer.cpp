@@ -10,21 +10,39 @@
 #include "valdi_core/cpp/Utils/LoggerUtils.hpp"
 #include "valdi_core/cpp/Utils/SmallVector.hpp"
 
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <tuple>
+
 namespace Valdi {
 
 ChildrenVisibilityResult::ChildrenVisibilityResult()
     : visibleChildren(makeReusableArray<ViewNode*>()), invisibleChildren(makeReusableArray<ViewNode*>()) {}
 
+// When the children extents along the scroll axis sum up to more than this ratio of their
+// bounds, the children are laid out along both axes and we index them as a grid.
+constexpr float kTwoDimensionalExtentRatio = 1.5f;
+
+bool ViewNodeChildrenIndexer::CellsRange::contains(size_t column, size_t row) const {
+    return column >= columnStart && column < columnEnd && row >= rowStart && row < rowEnd;
+}
+
 ViewNodeChildrenIndexer::ViewNodeChildrenIndexer(ViewNode* viewNode) : _viewNode(viewNode) {}
 
 void ViewNodeChildrenIndexer::setNeedsUpdate() {
     _needUpdate = true;
+    _dirtyChildren.clear();
 }
 
 bool ViewNodeChildrenIndexer::needsUpdate() const {
     return _needUpdate;
 }
 
+bool ViewNodeChildrenIndexer::isTwoDimensional() const {
+    return _twoDimensional;
+}
+
 void ViewNodeChildrenIndexer::setHorizontal(bool horizontal) {
     if (_horizontal != horizontal) {
         _horizontal = horizontal;
@@ -32,25 +50,64 @@ void ViewNodeChildrenIndexer::setHorizontal(bool horizontal) {
     }
 }
 
-void ViewNodeChildrenIndexer::updateVisibleBounds(const Frame& viewport) {
-    if (_cellSize == 0.0f) {
-        _visibleLowerBound = 0;
-        _visibleUpperBound = 0;
+void ViewNodeChildrenIndexer::setChildNeedsUpdate(ViewNode* child) {
+    if (_needUpdate) {
+        // Will be handled by the full rebuild
         return;
     }
 
-    float start;
-    float end;
-    if (_horizontal) {
-        start = viewport.getLeft();
-        end = viewport.getRight();
+    if (_viewNode->getChildrenSpaceWidth() != _childrenSpaceWidth ||
+        _viewNode->getChildrenSpaceHeight() != _childrenSpaceHeight) {
+        // The cells no longer match the children space
+        setNeedsUpdate();
+        return;
+    }
+
+    auto it = _childrenCells.find(child);
+    if (it == _childrenCells.end() || _dirtyChildren.size() >= std::max(_childrenCells.size() / 4, size_t(1))) {
+        // Past a certain amount of moved children, rebuilding is cheaper than moving them one by one
+        setNeedsUpdate();
+        return;
+    }
+
+    auto previousRange = it->second;
+    removeNodeFromCells(child, previousRange);
+    insertNodeInCells(child);
+
+    _dirtyChildren.emplace_back(child);
+}
+
+static std::pair<size_t, size_t> getVisibleCells(float start, float end, size_t cellsCount, float cellSize) {
+    if (cellSize == 0.0f || end <= 0.0f) {
+        return std::make_pair(0, 0);
+    }
+
+    auto upperBound = std::min(static_cast<size_t>(std::ceil(end / cellSize)), cellsCount);
+    if (upperBound == 0) {
+        return std::make_pair(0, 0);
+    }
+    // The last cell also holds the nodes outside the range of our container
+    auto lowerBound = std::min(static_cast<size_t>(std::max(start / cellSize, 0.0f)), upperBound - 1);
+
+    return std::make_pair(lowerBound, upperBound);
+}
+
+void ViewNodeChildrenIndexer::updateVisibleRange(const Frame& viewport) {
+    if (_columns.indexed) {
+        std::tie(_visibleRange.columnStart, _visibleRange.columnEnd) =
+            getVisibleCells(viewport.getLeft(), viewport.getRight(), _columns.cellsCount, _columns.cellSize);
     } else {
-        start = viewport.getTop();
-        end = viewport.getBottom();
+        _visibleRange.columnStart = 0;
+        _visibleRange.columnEnd = _columns.cellsCount;
     }
 
-    _visibleUpperBound = std::min(static_cast<size_t>(std::ceil(end / _cellSize)), _cells.size());
-    _visibleLowerBound = std::min(static_cast<size_t>(std::max(start / _cellSize, 0.0f)), _visibleUpperBound);
+    if (_rows.indexed) {
+        std::tie(_visibleRange.rowStart, _visibleRange.rowEnd) =
+            getVisibleCells(viewport.getTop(), viewport.getBottom(), _rows.cellsCount, _rows.cellSize);
+    } else {
+        _visibleRange.rowStart = 0;
+        _visibleRange.rowEnd = _rows.cellsCount;
+    }
 }
 
 void appendNodeIfNeeded(std::vector<ViewNode*>& output, ViewNode* viewNode, int updateId) {
@@ -61,16 +118,32 @@ void appendNodeIfNeeded(std::vector<ViewNode*>& output, ViewNode* viewNode, int
 }
 
 void ViewNodeChildrenIndexer::appendNodesIfNeeded(std::vector<ViewNode*>& output,
-                                                  size_t from,
-                                                  size_t to,
+                                                  const CellsRange& range,
                                                   int updateId) {
-    auto begin = _cells.begin() + from;
-    auto end = _cells.begin() + to;
-    while (begin != end) {
-        for (auto* node : *begin) {
-            appendNodeIfNeeded(output, node, updateId);
+    for (auto row = range.rowStart; row < range.rowEnd; row++) {
+        auto rowOffset = row * _columns.cellsCount;
+        for (auto column = range.columnStart; column < range.columnEnd; column++) {
+            for (auto* node : _cells[rowOffset + column]) {
+                appendNodeIfNeeded(output, node, updateId);
+            }
+        }
+    }
+}
+
+void ViewNodeChildrenIndexer::appendNodesIfNeeded(std::vector<ViewNode*>& output,
+                                                  const CellsRange& range,
+                                                  const CellsRange& excludedRange,
+                                                  int updateId) {
+    for (auto row = range.rowStart; row < range.rowEnd; row++) {
+        auto rowOffset = row * _columns.cellsCount;
+        for (auto column = range.columnStart; column < range.columnEnd; column++) {
+            if (excludedRange.contains(column, row)) {
+                continue;
+            }
+            for (auto* node : _cells[rowOffset + column]) {
+                appendNodeIfNeeded(output, node, updateId);
+            }
         }
-        ++begin;
     }
 }
 
@@ -83,91 +156,166 @@ ChildrenVisibilityResult ViewNodeChildrenIndexer::findChildrenVisibility(const F
         rebuild();
     }
 
-    auto lastVisibleLowerBound = _visibleLowerBound;
-    auto lastVisibleUpperBound = _visibleUpperBound;
+    auto lastVisibleRange = _visibleRange;
 
-    updateVisibleBounds(viewport);
+    updateVisibleRange(viewport);
 
     ChildrenVisibilityResult result;
 
-    appendNodesIfNeeded(*result.visibleChildren, _visibleLowerBound, _visibleUpperBound, updateId);
+    appendNodesIfNeeded(*result.visibleChildren, _visibleRange, updateId);
 
     if (didFullUpdate) {
         // On full update, we append all the invisible nodes in the output since the nodes
         // may have moved or been inserted since the last findChildrenVisibility() call.
 
-        appendNodesIfNeeded(*result.invisibleChildren, 0, _visibleLowerBound, updateId);
-        appendNodesIfNeeded(*result.invisibleChildren, _visibleUpperBound, _cells.size(), updateId);
+        CellsRange allCells;
+        allCells.columnEnd = _columns.cellsCount;
+        allCells.rowEnd = _rows.cellsCount;
+        appendNodesIfNeeded(*result.invisibleChildren, allCells, _visibleRange, updateId);
     } else {
-        // On partial update, we figure out which nodes have become invisible.
+        // On partial update, we figure out which nodes have become invisible, which are the ones
+        // in the cells that were visible and no longer are, and the ones that moved outside of the
+        // visible cells. Nodes which were already appended as visible will be skipped.
 
-        if (_visibleLowerBound > lastVisibleLowerBound) {
-            // elements at top became invisible
-            appendNodesIfNeeded(*result.invisibleChildren, lastVisibleLowerBound, _visibleLowerBound, updateId);
-        }
+        appendNodesIfNeeded(*result.invisibleChildren, lastVisibleRange, _visibleRange, updateId);
 
-        if (lastVisibleUpperBound > _visibleUpperBound) {
-            // elements at become became invisible
-            appendNodesIfNeeded(*result.invisibleChildren, _visibleUpperBound, lastVisibleUpperBound, updateId);
+        for (auto* child : _dirtyChildren) {
+            appendNodeIfNeeded(*result.invisibleChildren, child, updateId);
         }
     }
 
+    _dirtyChildren.clear();
+
     return result;
 }
 
-void ViewNodeChildrenIndexer::insertNodeInCells(ViewNode* viewNode, float start, float end) {
-    auto cellStart = static_cast<size_t>(start / _cellSize);
-    auto cellEnd = static_cast<size_t>(std::ceil(end / _cellSize));
+static std::pair<size_t, size_t> getNodeCells(float start, float end, size_t cellsCount, float cellSize) {
+    if (cellsCount == 0 || cellSize == 0.0f) {
+        return std::make_pair(0, 0);
+    }
+
+    auto cellStart = static_cast<size_t>(std::max(start / cellSize, 0.0f));
+    auto cellEnd = static_cast<size_t>(std::ceil(std::max(end / cellSize, 0.0f)));
 
     // Insert in the last cell if the node is outside the range of our container
-    cellStart = std::min(cellStart, _cells.size() - 1);
+    cellStart = std::min(cellStart, cellsCount - 1);
 
     // Make sure we insert into at least one cell if the node consumes no space
-    cellEnd = std::max(cellStart + 1, cellEnd);
+    cellEnd = std::min(std::max(cellStart + 1, cellEnd), cellsCount);
+
+    return std::make_pair(cellStart, cellEnd);
+}
+
+void ViewNodeChildrenIndexer::insertNodeInCells(ViewNode* viewNode) {
+    CellsRange range;
+
+    if (_columns.indexed) {
+        auto calculatedOffsetX = viewNode->getDirectionDependentTranslationX();
+        std::tie(range.columnStart, range.columnEnd) =
+            getNodeCells(viewNode->getCalculatedFrame().getLeft() + calculatedOffsetX,
+                         viewNode->getCalculatedFrame().getRight() + calculatedOffsetX,
+                         _columns.cellsCount,
+                         _columns.cellSize);
+    } else {
+        range.columnEnd = _columns.cellsCount;
+    }
 
-    while (cellStart != cellEnd && cellStart < _cells.size()) {
-        _cells[cellStart++].emplace_back(viewNode);
+    if (_rows.indexed) {
+        auto translationY = viewNode->getTranslationY();
+        std::tie(range.rowStart, range.rowEnd) = getNodeCells(viewNode->getCalculatedFrame().getTop() + translationY,
+                                                              viewNode->getCalculatedFrame().getBottom() + translationY,
+                                                              _rows.cellsCount,
+                                                              _rows.cellSize);
+    } else {
+        range.rowEnd = _rows.cellsCount;
+    }
+
+    for (auto row = range.rowStart; row < range.rowEnd; row++) {
+        auto rowOffset = row * _columns.cellsCount;
+        for (auto column = range.columnStart; column < range.columnEnd; column++) {
+            _cells[rowOffset + column].emplace_back(viewNode);
+        }
+    }
+
+    _childrenCells[viewNode] = range;
+}
+
+void ViewNodeChildrenIndexer::removeNodeFromCells(ViewNode* viewNode, const CellsRange& range) {
+    for (auto row = range.rowStart; row < range.rowEnd; row++) {
+        auto rowOffset = row * _columns.cellsCount;
+        for (auto column = range.columnStart; column < range.columnEnd; column++) {
+            auto& cell = _cells[rowOffset + column];
+            auto it = std::find(cell.begin(), cell.end(), viewNode);
+            if (it != cell.end()) {
+                cell.erase(it);
+            }
+        }
     }
 }
 
 void ViewNodeChildrenIndexer::rebuild() {
     auto childCount = _viewNode->getChildCount();
+    auto width = _viewNode->getChildrenSpaceWidth();
+    auto height = _viewNode->getChildrenSpaceHeight();
 
-    _cells.resize(childCount);
-    for (auto& objects : _cells) {
-        objects.clear();
+    _childrenSpaceWidth = width;
+    _childrenSpaceHeight = height;
+
+    _childrenCells.clear();
+    _dirtyChildren.clear();
+    _twoDimensional = false;
+
+    if (childCount == 0) {
+        _columns = Axis();
+        _rows = Axis();
+        _cells.clear();
+        return;
     }
 
-    if (_horizontal) {
-        if (childCount == 0) {
-            _cellSize = _viewNode->getChildrenSpaceWidth();
-            return;
-        }
-        _cellSize = _viewNode->getChildrenSpaceWidth() / static_cast<float>(childCount);
-
-        if (_cellSize != 0.0f) {
-            for (auto* child : *_viewNode) {
-                auto calculatedOffsetX = child->getDirectionDependentTranslationX();
-                insertNodeInCells(child,
-                                  child->getCalculatedFrame().getLeft() + calculatedOffsetX,
-                                  child->getCalculatedFrame().getRight() + calculatedOffsetX);
-            }
+    if (width > 0.0f && height > 0.0f) {
+        // Children of a list are laid out one after the other, so their extents add up to the
+        // extent of their bounds along the scroll axis. Children that share rows or columns
+        // overlap along that axis instead.
+        float childrenExtent = 0;
+        float boundsStart = std::numeric_limits<float>::max();
+        float boundsEnd = std::numeric_limits<float>::lowest();
+        for (auto* child : *_viewNode) {
+            const auto& frame = child->getCalculatedFrame();
+            auto start = _horizontal ? frame.getLeft() : frame.getTop();
+            auto end = _horizontal ? frame.getRight() : frame.getBottom();
+            childrenExtent += end - start;
+            boundsStart = std::min(boundsStart, start);
+            boundsEnd = std::max(boundsEnd, end);
         }
+
+        _twoDimensional = childrenExtent > (boundsEnd - boundsStart) * kTwoDimensionalExtentRatio;
+    }
+
+    auto floatChildCount = static_cast<float>(childCount);
+
+    if (_twoDimensional) {
+        // Aim for roughly square cells, with about as many cells as there are children
+        auto columnsCount = std::clamp(
+            static_cast<size_t>(std::round(std::sqrt(floatChildCount * width / height))), size_t(1), childCount);
+        auto rowsCount = std::clamp((childCount + columnsCount - 1) / columnsCount, size_t(1), childCount);
+
+        _columns = Axis{columnsCount, width / static_cast<float>(columnsCount), true};
+        _rows = Axis{rowsCount, height / static_cast<float>(rowsCount), true};
+    } else if (_horizontal) {
+        _columns = Axis{childCount, width / floatChildCount, true};
+        _rows = Axis{1, height, false};
     } else {
-        if (childCount == 0) {
-            _cellSize = _viewNode->getChildrenSpaceHeight();
-            return;
-        }
-        _cellSize = _viewNode->getChildrenSpaceHeight() / static_cast<float>(childCount);
-
-        if (_cellSize != 0.0f) {
-            for (auto* child : *_viewNode) {
-                auto translationY = child->getTranslationY();
-                insertNodeInCells(child,
-                                  child->getCalculatedFrame().getTop() + translationY,
-                                  child->getCalculatedFrame().getBottom() + translationY);
-            }
-        }
+        _columns = Axis{1, width, false};
+        _rows = Axis{childCount, height / floatChildCount, true};
+    }
+
+    _cells.resize(_columns.cellsCount * _rows.cellsCount);
+    for (auto& objects : _cells) {
+        objects.clear();
+    }
+
+    for (auto* child : *_viewNode) {
+        insertNodeInCells(child);
     }
 }
 
@@ -31,34 +31,83 @@ struct ChildrenVisibilityResult {
     ChildrenVisibilityResult();
 };
 
+/**
+ Spatial index over the children of a ViewNode, used to efficiently find which children
+ intersect with the viewport. The children space is split into a uniform grid of cells.
+ For lists, the grid has a single row or column and one cell per child along the scroll axis.
+ When the children span both axes, like in a wrapping grid or a 2D canvas, the grid is split
+ along both axes so that only the cells intersecting with the viewport are visited.
+ */
 class ViewNodeChildrenIndexer {
 public:
     explicit ViewNodeChildrenIndexer(ViewNode* viewNode);
 
     void setHorizontal(bool horizontal);
 
+    /**
+     Mark the whole index as dirty, it will be rebuilt on the next findChildrenVisibility() call.
+     */
     void setNeedsUpdate();
     bool needsUpdate() const;
 
+    /**
+     Notify that the frame of the given child has changed. The child is moved to its new cells
+     without rebuilding the whole index.
+     */
+    void setChildNeedsUpdate(ViewNode* child);
+
+    /**
+     Whether the children are indexed along both axes.
+     */
+    bool isTwoDimensional() const;
+
     ChildrenVisibilityResult findChildrenVisibility(const Frame& viewport);
 
 private:
+    struct Axis {
+        size_t cellsCount = 0;
+        float cellSize = 0;
+        // Whether the axis is used to cull children. When false, the axis has a single cell
+        // which is always considered visible.
+        bool indexed = false;
+    };
+
+    struct CellsRange {
+        size_t columnStart = 0;
+        size_t columnEnd = 0;
+        size_t rowStart = 0;
+        size_t rowEnd = 0;
+
+        bool contains(size_t column, size_t row) const;
+    };
+
     ViewNode* _viewNode;
+    // Cells ordered by rows
     std::vector<SmallVector<ViewNode*, 2>> _cells;
-    size_t _visibleLowerBound = 0;
-    size_t _visibleUpperBound = 0;
-    float _cellSize = 0;
+    FlatMap<ViewNode*, CellsRange> _childrenCells;
+    std::vector<ViewNode*> _dirtyChildren;
+    Axis _columns;
+    Axis _rows;
+    CellsRange _visibleRange;
+    float _childrenSpaceWidth = 0;
+    float _childrenSpaceHeight = 0;
     int _updateId = 0;
     bool _horizontal = false;
+    bool _twoDimensional = false;
     bool _needUpdate = true;
 
     void rebuild();
 
-    void updateVisibleBounds(const Frame& viewport);
+    void updateVisibleRange(const Frame& viewport);
 
-    void insertNodeInCells(ViewNode* viewNode, float start, float end);
+    void insertNodeInCells(ViewNode* viewNode);
+    void removeNodeFromCells(ViewNode* viewNode, const CellsRange& range);
 
-    void appendNodesIfNeeded(std::vector<ViewNode*>& output, size_t from, size_t to, int updateId);
+    void appendNodesIfNeeded(std::vector<ViewNode*>& output, const CellsRange& range, int updateId);
+    void appendNodesIfNeeded(std::vector<ViewNode*>& output,
+                             const CellsRange& range,
+                             const CellsRange& excludedRange,
+                             int updateId);
 };
 
 } // namespace Valdi
@@ -25,6 +25,7 @@
 #include "valdi/runtime/Views/GlobalViewFactories.hpp"
 #include "valdi/runtime/Views/MeasureDelegate.hpp"
 #include "valdi/runtime/Views/ViewTransactionScope.hpp"
+#include "valdi_core/cpp/Threading/WorkStealingExecutor.hpp"
 #include "valdi_core/cpp/Utils/SmallVector.hpp"
 
 #include "valdi_core/cpp/Utils/LoggerUtils.hpp"
@@ -67,6 +68,7 @@ ViewNodeTree::ViewNodeTree(const SharedContext& context,
       _viewManagerContext(viewManagerContext),
       _viewManager(viewManager),
       _runtime(std::move(runtime)),
+      _viewNodesAllocator(makeShared<SlabAllocator>()),
       _mainThreadManager(mainThreadManager),
       _shouldRenderInMainThread(shouldRenderInMainThread) {}
 
@@ -832,6 +834,8 @@ void ViewNodeTree::runUpdatesInner() {
 
     endViewTransaction(viewTransactionScope, layoutDidBecomeDirty);
 
+    _viewNodesAllocator->releaseEmptySlabs();
+
     _runUpdatesInnerSessionStop = std::chrono::steady_clock::now();
     _runUpdatesInnerAccumulatedTime += *_runUpdatesInnerSessionStop - runUpdatesStart;
 
@@ -869,6 +873,26 @@ bool ViewNodeTree::isViewInflationEnabled() const {
     return _viewInflationEnabled && _rootView != nullptr;
 }
 
+void ViewNodeTree::setLazyLayoutExecutor(const Ref<WorkStealingExecutor>& lazyLayoutExecutor) {
+    _lazyLayoutExecutor = lazyLayoutExecutor;
+}
+
+const Ref<WorkStealingExecutor>& ViewNodeTree::getLazyLayoutExecutor() const {
+    return _lazyLayoutExecutor;
+}
+
+Ref<ViewNode> ViewNodeTree::createViewNode(YGConfig* yogaConfig,
+                                           AttributeIds& attributeIds,
+                                           const Ref<ColorPalette>& colorPalette,
+                                           ILogger& logger) {
+    return Valdi::allocateShared<ViewNode>(
+        _viewNodesAllocator.get(), yogaConfig, attributeIds, colorPalette, logger, _viewNodesAllocator);
+}
+
+const Ref<SlabAllocator>& ViewNodeTree::getViewNodesAllocator() const {
+    return _viewNodesAllocator;
+}
+
 void ViewNodeTree::setViewInflationEnabled(bool viewInflationEnabled) {
     if (_viewInflationEnabled != viewInflationEnabled) {
         _viewInflationEnabled = viewInflationEnabled;
@@ -38,6 +38,7 @@ using SharedViewNodeTree = Ref<ViewNodeTree>;
 class ViewNodesVisibilityObserver;
 class ViewNodesFrameObserver;
 class IViewNodesAssetTracker;
+class WorkStealingExecutor;
 class MainThreadManager;
 class AttributesManager;
 class Metrics;
@@ -217,6 +218,28 @@ public:
     bool isViewInflationEnabled() const;
     void setViewInflationEnabled(bool viewInflationEnabled);
 
+    /**
+     Set the executor on which the lazy layouts of the tree can be calculated. When set, the visible
+     lazy layouts which need to be calculated are dispatched to the executor's workers and joined before
+     the frames are applied, instead of being calculated one after another on the calling thread.
+     Lazy layouts containing nodes measured by JS or by a measure delegate that is not thread safe
+     are still calculated on the calling thread.
+     */
+    void setLazyLayoutExecutor(const Ref<WorkStealingExecutor>& lazyLayoutExecutor);
+    const Ref<WorkStealingExecutor>& getLazyLayoutExecutor() const;
+
+    /**
+     Create a ViewNode for this tree. The ViewNode, its yoga node and its attributes are allocated
+     from the tree's slab allocator, which avoids a system allocation per object when building the
+     tree and keeps the nodes of the tree close together in memory. Slabs left empty by destroyed
+     ViewNodes are given back after each batch of updates. Must be called with the tree lock held.
+     */
+    Ref<ViewNode> createViewNode(YGConfig* yogaConfig,
+                                 AttributeIds& attributeIds,
+                                 const Ref<ColorPalette>& colorPalette,
+                                 ILogger& logger);
+    const Ref<SlabAllocator>& getViewNodesAllocator() const;
+
     void registerViewNodesVisibilityObserverCallback(const Ref<ValueFunction>& callback);
     void registerViewNodesFrameObserverCallback(const Ref<ValueFunction>& callback);
 
@@ -272,6 +295,8 @@ private:
     Ref<ViewNodesVisibilityObserver> _visibilityObserver;
     Ref<ViewNodesFrameObserver> _framesObserver;
     Ref<IViewNodesAssetTracker> _assetTracker;
+    Ref<WorkStealingExecutor> _lazyLayoutExecutor;
+    Ref<SlabAllocator> _viewNodesAllocator;
     SharedAnimator _animator;
     Ref<View> _rootView;
     Ref<MainThreadManager> _mainThreadManager;
@@ -7,6 +7,9 @@
 
 #include "valdi/runtime/Context/ViewNodeTreeManager.hpp"
 #include "valdi/runtime/Context/ViewManagerContext.hpp"
+#include "valdi/runtime/Runtime.hpp"
+#include "valdi/runtime/ValdiRuntimeTweaks.hpp"
+#include "valdi_core/cpp/Threading/WorkStealingExecutor.hpp"
 
 namespace Valdi {
 
@@ -37,12 +40,16 @@ SharedViewNodeTree ViewNodeTreeManager::lockFreeCreateViewNodeTreeForContext(
     if (viewManagerContext != nullptr) {
         viewManager = &viewManagerContext->getViewManager();
     }
+    auto runtimeTweaks = runtime->getRuntimeTweaks();
     auto viewNodeTree = Valdi::makeShared<ViewNodeTree>(context,
                                                         viewManagerContext,
                                                         viewManager,
                                                         std::move(runtime),
                                                         &_mainThreadManager,
                                                         threadAffinity == ViewNodeTreeThreadAffinity::MAIN_THREAD);
+    if (runtimeTweaks != nullptr && runtimeTweaks->enableConcurrentLazyLayout()) {
+        viewNodeTree->setLazyLayoutExecutor(WorkStealingExecutor::getShared());
+    }
 
     auto emplaced = _trees.try_emplace(context->getContextId(), viewNodeTree).second;
     SC_ASSERT(emplaced, "ViewNodeTree was already registered");
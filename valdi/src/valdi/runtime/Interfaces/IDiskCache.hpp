@@ -28,6 +28,15 @@ public:
      */
     [[nodiscard]] virtual Result<BytesView> load(const Path& path) = 0;
 
+    /**
+     Load the content of the item at the given path, like load(), but let the implementation
+     back the returned bytes with a read-only memory mapping of the item when it can.
+     Pages are then only read from disk once they are accessed. Items which are loaded mapped
+     must be written with storeAtomically(), so that the returned bytes remain valid after the item
+     is stored again.
+     */
+    [[nodiscard]] virtual Result<BytesView> loadMapped(const Path& path) = 0;
+
     /**
      Load the content of the item at the given absolute URL and return the result
      as bytes.
@@ -39,6 +48,19 @@ public:
      */
     [[nodiscard]] virtual Result<Void> store(const Path& path, const BytesView& bytes) = 0;
 
+    /**
+     Store the item at the given path with the given bytes, replacing the previous item
+     in a single step. Readers never observe a partially written item, and bytes previously
+     returned by loadMapped() for the item are left untouched.
+     */
+    [[nodiscard]] virtual Result<Void> storeAtomically(const Path& path, const BytesView& bytes) = 0;
+
+    /**
+     Append the given bytes at the end of the item at the given path,
+     creating the item if it does not exist.
+     */
+    [[nodiscard]] virtual Result<Void> append(const Path& path, const BytesView& bytes) = 0;
+
     /**
      Creates a new IDiskCache that will operate relative to the given path.
      */
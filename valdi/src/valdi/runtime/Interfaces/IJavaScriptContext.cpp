@@ -269,6 +269,10 @@ JSValueRef IJavaScriptContext::newArrayBufferCopy(const Byte* data, size_t size,
     return newArrayBuffer(makeShared<ByteBuffer>(data, data + size)->toBytesView(), exceptionTracker);
 }
 
+BytesView IJavaScriptContext::detachArrayBuffer(const JSValue& /*value*/, JSExceptionTracker& /*exceptionTracker*/) {
+    return BytesView();
+}
+
 JavaScriptLong IJavaScriptContext::valueToLong(const JSValue& value, JSExceptionTracker& exceptionTracker) {
     static auto kLow = STRING_LITERAL("low");
     static auto kHigh = STRING_LITERAL("high");
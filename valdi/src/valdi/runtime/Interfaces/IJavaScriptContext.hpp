@@ -257,6 +257,13 @@ public:
     virtual int32_t valueToInt(const JSValue& value, JSExceptionTracker& exceptionTracker) = 0;
     virtual Ref<RefCountable> valueToWrappedObject(const JSValue& value, JSExceptionTracker& exceptionTracker) = 0;
     virtual JSTypedArray valueToTypedArray(const JSValue& value, JSExceptionTracker& exceptionTracker) = 0;
+    /**
+     * Detaches the ArrayBuffer of the given ArrayBuffer or typed array, and hands its contents over
+     * without copying them. The returned bytes are at the address the ArrayBuffer was using.
+     * Returns empty bytes and leaves the ArrayBuffer untouched if the engine cannot detach it,
+     * callers should then copy the contents instead.
+     */
+    virtual BytesView detachArrayBuffer(const JSValue& value, JSExceptionTracker& exceptionTracker);
     virtual Ref<JSFunction> valueToFunction(const JSValue& value, JSExceptionTracker& exceptionTracker) = 0;
     JavaScriptLong valueToLong(const JSValue& value, JSExceptionTracker& exceptionTracker);
 
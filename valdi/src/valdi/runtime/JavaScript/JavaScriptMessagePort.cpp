@@ -5,12 +5,23 @@
 #include "valdi/runtime/JavaScript/JavaScriptFunctionCallContext.hpp"
 #include "valdi/runtime/JavaScript/JavaScriptRuntime.hpp"
 #include "valdi/runtime/JavaScript/JavaScriptUtils.hpp"
+#include "valdi/runtime/JavaScript/WrappedJSValueRef.hpp"
+#include "valdi_core/cpp/Utils/ByteBuffer.hpp"
 #include "valdi_core/cpp/Utils/ValueArray.hpp"
+#include "valdi_core/cpp/Utils/ValueMap.hpp"
+#include "valdi_core/cpp/Utils/ValueTypedArray.hpp"
 
+#include "utils/time/StopWatch.hpp"
+
+#include <chrono>
 #include <unordered_set>
 
 namespace Valdi {
 
+// Time after which a batch of queued messages yields the JavaScript thread, the remaining
+// messages are then delivered by a subsequent task.
+constexpr auto kMaxMessageBatchDuration = std::chrono::milliseconds(4);
+
 class ContextAttachedMessagePort final : public ContextAttachedValdiObject {
 public:
     ContextAttachedMessagePort(Ref<Context>&& context, const Ref<JavaScriptMessagePort>& handle)
@@ -217,31 +228,45 @@ void JavaScriptMessagePortEndpoint::scheduleNextMessage(std::unique_lock<Mutex>&
     lock.unlock();
     runtime->dispatchOnJsThread(
         nullptr, JavaScriptTaskScheduleTypeAlwaysAsync, 0, [self, generation](JavaScriptEntryParameters& entry) {
-            self->dispatchNextMessage(entry, generation);
+            self->dispatchQueuedMessages(entry, generation);
         });
 }
 
-void JavaScriptMessagePortEndpoint::dispatchNextMessage(JavaScriptEntryParameters& entry, uint64_t generation) {
-    Ref<JavaScriptMessagePort> handle;
-    Ref<JavaScriptMessage> message;
-    {
-        std::lock_guard<Mutex> lock(_mutex);
+void JavaScriptMessagePortEndpoint::dispatchQueuedMessages(JavaScriptEntryParameters& entry, uint64_t generation) {
+    snap::utils::time::StopWatch stopWatch(snap::utils::time::StopWatch::STARTED);
+    std::unique_lock<Mutex> lock(_mutex);
+    if (_scheduledGeneration != generation) {
+        return;
+    }
+
+    // The scheduled generation stays set while the batch runs, so that messages enqueued by the
+    // handlers are picked up by this batch instead of scheduling another task.
+    for (;;) {
         if (_closed || generation != _generation || _scheduledGeneration != generation || !_started ||
             _messages.empty()) {
-            return;
+            break;
         }
-        _scheduledGeneration.reset();
-        handle = Ref<JavaScriptMessagePort>(_handle.lock());
+        auto handle = Ref<JavaScriptMessagePort>(_handle.lock());
         if (handle == nullptr) {
-            return;
+            break;
         }
-        message = std::move(_messages.front());
+        auto message = std::move(_messages.front());
         _messages.pop_front();
-    }
+        lock.unlock();
 
-    handle->dispatchMessage(entry, message);
+        handle->dispatchMessage(entry, message);
 
-    std::unique_lock<Mutex> lock(_mutex);
+        lock.lock();
+        // An exception thrown by a handler is reported when the task completes, the next messages
+        // are delivered by a new task.
+        if (!entry.exceptionTracker || stopWatch.elapsed().chrono() >= kMaxMessageBatchDuration) {
+            break;
+        }
+    }
+
+    if (_scheduledGeneration == generation) {
+        _scheduledGeneration.reset();
+    }
     scheduleNextMessage(lock);
 }
 
@@ -349,10 +374,98 @@ void JavaScriptMessagePort::dispatchMessage(JavaScriptEntryParameters& entry, co
     message->callHandler(entry, handler);
 }
 
+// Contents of a transferred ArrayBuffer, along with the address range it had in the source runtime.
+struct TransferredBuffer {
+    const Byte* sourceBegin = nullptr;
+    const Byte* sourceEnd = nullptr;
+    BytesView contents;
+};
+
+// Detaches the JS ArrayBuffer backing the given typed array, so that its contents can be moved into the message.
+// When the engine cannot detach it, the contents are copied instead so that the receiver never shares memory
+// with the sender. Typed arrays backed by native memory, or by an ArrayBuffer of another runtime, are sent
+// without being detached, in which case the returned contents are empty.
+static Result<TransferredBuffer> detachTransferredBuffer(const ValueTypedArray& typedArray) {
+    const auto& bytes = typedArray.getBuffer();
+    auto arrayBufferRef = castOrNull<WrappedJSValueRef>(bytes.getSource());
+    if (arrayBufferRef == nullptr) {
+        return TransferredBuffer();
+    }
+    auto taskScheduler = arrayBufferRef->getTaskScheduler();
+    if (taskScheduler == nullptr || !taskScheduler->isInJsThread()) {
+        return TransferredBuffer();
+    }
+
+    Result<TransferredBuffer> result;
+    taskScheduler->dispatchOnJsThreadSync(nullptr, [&](JavaScriptEntryParameters& entry) {
+        auto arrayBuffer = arrayBufferRef->getJsValue(entry.jsContext, entry.exceptionTracker);
+        if (!entry.exceptionTracker) {
+            result = entry.exceptionTracker.extractError();
+            return;
+        }
+        auto contents = entry.jsContext.detachArrayBuffer(arrayBuffer, entry.exceptionTracker);
+        if (!entry.exceptionTracker) {
+            result = entry.exceptionTracker.extractError();
+            return;
+        }
+
+        if (!contents.empty()) {
+            // Detached contents stay at the address the ArrayBuffer was using
+            result = TransferredBuffer{contents.begin(), contents.end(), std::move(contents)};
+        } else {
+            result = TransferredBuffer{
+                bytes.begin(), bytes.end(), makeShared<ByteBuffer>(bytes.begin(), bytes.end())->toBytesView()};
+        }
+    });
+    return result;
+}
+
+// Rebuilds the given value so that its typed arrays which were backed by a transferred ArrayBuffer
+// reference the moved contents instead.
+static Value moveTransferredBuffers(const Value& value, const std::vector<TransferredBuffer>& transferredBuffers) {
+    if (value.isTypedArray()) {
+        const auto& typedArray = *value.getTypedArray();
+        const auto& bytes = typedArray.getBuffer();
+        if (bytes.empty()) {
+            return value;
+        }
+        for (const auto& transferredBuffer : transferredBuffers) {
+            if (bytes.begin() >= transferredBuffer.sourceBegin && bytes.end() <= transferredBuffer.sourceEnd) {
+                const auto& contents = transferredBuffer.contents;
+                auto offset = static_cast<size_t>(bytes.begin() - transferredBuffer.sourceBegin);
+                return Value(makeShared<ValueTypedArray>(
+                    typedArray.getType(), BytesView(contents.getSource(), contents.data() + offset, bytes.size())));
+            }
+        }
+        return value;
+    }
+
+    if (value.isArray()) {
+        const auto& array = *value.getArray();
+        auto movedArray = ValueArray::make(array.size());
+        for (size_t i = 0; i < array.size(); i++) {
+            movedArray->emplace(i, moveTransferredBuffers(array[i], transferredBuffers));
+        }
+        return Value(movedArray);
+    }
+
+    if (value.isMap()) {
+        auto movedMap = makeShared<ValueMap>();
+        movedMap->reserve(value.getMap()->size());
+        for (const auto& it : *value.getMap()) {
+            (*movedMap)[it.first] = moveTransferredBuffers(it.second, transferredBuffers);
+        }
+        return Value(movedMap);
+    }
+
+    return value;
+}
+
 Result<Ref<JavaScriptMessage>> JavaScriptMessage::make(const Value& data,
                                                        const Value& transfer,
                                                        const JavaScriptMessagePort* sourcePort) {
     std::vector<Ref<JavaScriptMessagePort>> ports;
+    std::vector<Ref<ValueTypedArray>> buffers;
     if (!transfer.isUndefined()) {
         if (!transfer.isArray()) {
             return Error("MessagePort transfer list must be an array");
@@ -360,13 +473,22 @@ Result<Ref<JavaScriptMessage>> JavaScriptMessage::make(const Value& data,
         const auto* values = transfer.getArray();
         ports.reserve(values->size());
         std::unordered_set<const JavaScriptMessagePort*> uniquePorts;
+        std::unordered_set<const Byte*> uniqueBuffers;
         for (const auto& value : *values) {
+            if (value.isTypedArray()) {
+                auto buffer = value.getTypedArrayRef();
+                if (!buffer->getBuffer().empty() && !uniqueBuffers.insert(buffer->getBuffer().data()).second) {
+                    return Error("Transfer list contains duplicate ArrayBuffer");
+                }
+                buffers.emplace_back(std::move(buffer));
+                continue;
+            }
             if (!value.isValdiObject()) {
                 return Error("Transfer list contains an unsupported value");
             }
             auto port = castOrNull<JavaScriptMessagePort>(value.getValdiObject());
             if (port == nullptr) {
-                return Error("Only MessagePort values can be transferred");
+                return Error("Only MessagePort and ArrayBuffer values can be transferred");
             }
             if (!uniquePorts.insert(port.get()).second) {
                 return Error("Transfer list contains duplicate MessagePort");
@@ -391,6 +513,23 @@ Result<Ref<JavaScriptMessage>> JavaScriptMessage::make(const Value& data,
         transferredPortSources.emplace_back(port);
         transferredPorts.emplace_back(transferResult.moveValue());
     }
+
+    std::vector<TransferredBuffer> transferredBuffers;
+    for (const auto& buffer : buffers) {
+        auto detachResult = detachTransferredBuffer(*buffer);
+        if (!detachResult) {
+            return detachResult.moveError();
+        }
+        if (!detachResult.value().contents.empty()) {
+            transferredBuffers.emplace_back(detachResult.moveValue());
+        }
+    }
+    if (!transferredBuffers.empty()) {
+        return makeShared<JavaScriptMessage>(moveTransferredBuffers(data, transferredBuffers),
+                                             std::move(transferredPortSources),
+                                             std::move(transferredPorts));
+    }
+
     return makeShared<JavaScriptMessage>(data, std::move(transferredPortSources), std::move(transferredPorts));
 }
 
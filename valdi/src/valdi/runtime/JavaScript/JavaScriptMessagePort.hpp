@@ -21,6 +21,9 @@ class JavaScriptMessagePortEndpoint;
 class JavaScriptMessage final : public SharedPtrRefCountable {
 public:
     // Transfer validation and mutation must run without yielding on the source runtime's JavaScript thread.
+    // The transfer list can contain MessagePorts and ArrayBuffers or typed arrays. The ArrayBuffers owned by
+    // the source runtime are detached, and their contents are moved into the message without copying. Their
+    // contents are copied instead when the engine cannot detach them.
     static Result<Ref<JavaScriptMessage>> make(const Value& data,
                                                const Value& transfer,
                                                const JavaScriptMessagePort* sourcePort);
@@ -78,7 +81,9 @@ private:
     void onPeerClosed();
 
     void scheduleNextMessage(std::unique_lock<Mutex>& lock);
-    void dispatchNextMessage(JavaScriptEntryParameters& entry, uint64_t generation);
+    // Delivers the queued messages in a single JavaScript task, until the queue is empty or the
+    // batch exceeds its time budget.
+    void dispatchQueuedMessages(JavaScriptEntryParameters& entry, uint64_t generation);
 };
 
 class JavaScriptMessagePort final : public ValdiObject {
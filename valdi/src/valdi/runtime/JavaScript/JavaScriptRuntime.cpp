@@ -348,6 +348,10 @@ void JavaScriptRuntime::postInit() {
     }
 }
 
+void JavaScriptRuntime::setBytecodeDiskCache(const Ref<IDiskCache>& diskCache) {
+    _diskCache = diskCache;
+}
+
 JavaScriptRuntime::~JavaScriptRuntime() {
     VALDI_DEBUG(*_logger, "Destroying JavaScriptRuntime (instance ptr {})", static_cast<void*>(this));
     fullTeardown();
@@ -555,6 +559,9 @@ Result<Void> JavaScriptRuntime::initializeContext() {
     jsContext->initialize(config, exceptionTracker);
 
     if (exceptionTracker) {
+        if (_diskCache != nullptr) {
+            jsContext->setBytecodeDiskCache(_diskCache);
+        }
         jsContext->startDebugger(_isWorker);
 
         runtimeDeserializers =
@@ -2288,6 +2295,7 @@ JSValueRef JavaScriptRuntime::runtimeCreateWorker(JSFunctionNativeCallContext& c
         std::lock_guard<Mutex> guard(_listenerMutex);
         workerRuntime->setListener(_listener, _listenerOwner);
     }
+    workerRuntime->setBytecodeDiskCache(_diskCache);
     workerRuntime->postInit();
     for (const auto& moduleFactory : _moduleFactories) {
         workerRuntime->registerJavaScriptModuleFactory(moduleFactory);
@@ -2362,7 +2370,7 @@ JSValueRef JavaScriptRuntime::workerSetOnMessage(JSFunctionNativeCallContext& ca
     return callContext.getContext().newUndefined();
 }
 
-// worker.postMessage(any, MessagePort[] | undefined)
+// worker.postMessage(any, (MessagePort | ArrayBuffer)[] | undefined)
 JSValueRef JavaScriptRuntime::workerPostMessage(JSFunctionNativeCallContext& callContext) {
     auto worker = thisFromCallContext<JavaScriptWorker>(callContext);
     if (worker != nullptr) {
@@ -3575,6 +3583,7 @@ std::shared_ptr<snap::valdi_core::JSRuntime> JavaScriptRuntime::createWorker() {
         std::lock_guard<Mutex> guard(_listenerMutex);
         workerRuntime->setListener(_listener, _listenerOwner);
     }
+    workerRuntime->setBytecodeDiskCache(_diskCache);
     workerRuntime->postInit();
     for (const auto& moduleFactory : _moduleFactories) {
         workerRuntime->registerJavaScriptModuleFactory(moduleFactory);
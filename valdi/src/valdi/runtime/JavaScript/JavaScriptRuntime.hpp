@@ -186,6 +186,12 @@ public:
 
     void postInit();
 
+    /**
+     Set the disk cache into which the JS engine can persist the bytecode it compiles
+     from module sources. Must be called before postInit().
+     */
+    void setBytecodeDiskCache(const Ref<IDiskCache>& diskCache);
+
     /**
      A listener reference that retains the listener's owner while held, so a caller can safely
      invoke the listener even if the owning runtime is concurrently being torn down on another
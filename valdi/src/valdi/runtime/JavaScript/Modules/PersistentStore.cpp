@@ -12,10 +12,43 @@
 #include "valdi_core/cpp/Utils/Format.hpp"
 #include "valdi_core/cpp/Utils/LoggerUtils.hpp"
 
+#include <boost/crc.hpp>
+
+#include <algorithm>
+
 namespace Valdi {
 
 constexpr int64_t kPersistentStoreSaveDelayMs = 50;
 
+// The journal is compacted once it grows larger than the snapshot, or than this size for small stores
+constexpr size_t kPersistentStoreMinJournalSizeForCompaction = 64 * 1024;
+
+constexpr uint32_t kPersistentStoreJournalFrameMagic = 0x4a535056; // "VPSJ"
+constexpr size_t kPersistentStoreJournalFrameAlignment = 8;
+
+/**
+ Header of a frame in the journal, followed by the journal records of the KeyValueStore
+ that were flushed in a single save. The checksum lets populate() detect frames which were
+ only partially written.
+ */
+struct PersistentStoreJournalFrame {
+    uint32_t magic;
+    uint32_t length;
+    uint32_t checksum;
+    uint32_t reserved;
+};
+
+static uint32_t computeJournalChecksum(const Byte* data, size_t length) {
+    boost::crc_32_type crc;
+    crc.process_bytes(data, length);
+    return crc.checksum();
+}
+
+static size_t journalFramePaddingForLength(size_t length) {
+    return (kPersistentStoreJournalFrameAlignment - (length % kPersistentStoreJournalFrameAlignment)) %
+           kPersistentStoreJournalFrameAlignment;
+}
+
 PersistentStore::PersistentStore(const StringBox& diskCachePath,
                                  const Ref<IDiskCache>& diskCache,
                                  const Ref<UserSession>& userSession,
@@ -31,7 +64,10 @@ PersistentStore::PersistentStore(const StringBox& diskCachePath,
       _dispatchQueue(dispatchQueue),
       _logger(logger),
       _disableBatchWrites(disableBatchWrites) {
+    _journalPath = _diskCachePath;
+    _journalPath.appendFileExtension("journal");
     _store.setMaxWeight(maxWeight);
+    _store.setJournalEnabled(true);
     updateActiveDiskStore();
 }
 
@@ -88,6 +124,8 @@ void PersistentStore::updateUserSession(const Ref<UserSession>& userSession) {
 
     _userSession = userSession;
     _store.removeAll();
+    // The mutations of the previous user should not be replayed into the store of the new one
+    _store.takeJournal();
 
     updateActiveDiskStore();
 
@@ -97,9 +135,12 @@ void PersistentStore::updateUserSession(const Ref<UserSession>& userSession) {
 void PersistentStore::updateActiveDiskStore() {
     Path directoryPath(_userSession == nullptr ? STRING_LITERAL("global") : _userSession->getUserId());
     auto activeDiskCache = _diskCache->scopedCache(directoryPath, false);
+    _journalDiskCache = activeDiskCache;
+    _encryptedDiskCache = nullptr;
     if (_keychain != nullptr) {
         // Encrypt when we have a keychain
-        activeDiskCache = makeShared<EncryptedDiskCache>(activeDiskCache, _keychain);
+        _encryptedDiskCache = makeShared<EncryptedDiskCache>(activeDiskCache, _keychain);
+        activeDiskCache = _encryptedDiskCache;
     }
 
     _activeDiskCache = std::move(activeDiskCache);
@@ -161,12 +202,17 @@ void PersistentStore::scheduleSave(Function<void(Result<Void>)> completion) {
 
 void PersistentStore::doSave() {
     Result<Void> result;
-    auto serializeResult = _store.serialize();
-
-    if (serializeResult) {
-        result = _activeDiskCache->store(_diskCachePath, serializeResult.value());
+    if (shouldCompact()) {
+        result = compact();
     } else {
-        result = serializeResult.moveError();
+        result = appendJournal();
+        if (!result) {
+            VALDI_WARN(_logger,
+                       "Failed to append to journal at '{}', compacting instead: {}",
+                       _journalDiskCache->getAbsoluteURL(_journalPath),
+                       result.error());
+            result = compact();
+        }
     }
 
     auto pendingSaves = std::move(_pendingSaves);
@@ -175,6 +221,157 @@ void PersistentStore::doSave() {
     }
 }
 
+bool PersistentStore::shouldCompact() const {
+    return _needsCompaction ||
+           _journalSize > std::max(_snapshotSize, kPersistentStoreMinJournalSizeForCompaction);
+}
+
+Result<Void> PersistentStore::compact() {
+    auto serializeResult = _store.serialize();
+    // All the pending records are part of the new snapshot
+    _store.takeJournal();
+
+    if (!serializeResult) {
+        _needsCompaction = true;
+        return serializeResult.moveError();
+    }
+
+    // The previous snapshot may still be mapped by the store
+    auto result = _activeDiskCache->storeAtomically(_diskCachePath, serializeResult.value());
+    if (!result) {
+        _needsCompaction = true;
+        return result;
+    }
+
+    // If we crash before the journal is removed, it will be replayed on top of the new snapshot
+    // on the next populate(), which restores the same state.
+    _journalDiskCache->remove(_journalPath);
+
+    _snapshotSize = serializeResult.value().size();
+    _journalSize = 0;
+    _needsCompaction = false;
+
+    return Void();
+}
+
+Result<Void> PersistentStore::appendJournal() {
+    // Evictions are journaled as removals, they need to be part of the frame written below
+    _store.evictEntriesIfNeeded();
+
+    if (!_store.hasJournal()) {
+        return Void();
+    }
+
+    auto payload = _store.takeJournal();
+    if (_encryptedDiskCache != nullptr) {
+        auto encryptResult = _encryptedDiskCache->encrypt(payload);
+        if (!encryptResult) {
+            return encryptResult.moveError();
+        }
+        payload = encryptResult.moveValue();
+    }
+
+    PersistentStoreJournalFrame frameHeader;
+    frameHeader.magic = kPersistentStoreJournalFrameMagic;
+    frameHeader.length = static_cast<uint32_t>(payload.size());
+    frameHeader.checksum = computeJournalChecksum(payload.data(), payload.size());
+    frameHeader.reserved = 0;
+
+    auto frame = makeShared<ByteBuffer>();
+    frame->reserve(sizeof(frameHeader) + payload.size() + kPersistentStoreJournalFrameAlignment);
+    frame->append(reinterpret_cast<const Byte*>(&frameHeader),
+                  reinterpret_cast<const Byte*>(&frameHeader) + sizeof(frameHeader));
+    frame->append(payload.begin(), payload.end());
+    for (size_t i = journalFramePaddingForLength(payload.size()); i > 0; i--) {
+        frame->append(static_cast<Byte>(0));
+    }
+
+    auto result = _journalDiskCache->append(_journalPath, frame->toBytesView());
+    if (!result) {
+        // The journal might now end with a partial frame, a new snapshot needs to be written
+        _needsCompaction = true;
+        return result;
+    }
+
+    _journalSize += frame->size();
+
+    return Void();
+}
+
+Result<BytesView> PersistentStore::readJournalFrame(Parser<Byte>& parser, const Ref<RefCountable>& source) {
+    auto frameHeaderResult = parser.parseStruct<PersistentStoreJournalFrame>();
+    if (!frameHeaderResult) {
+        return frameHeaderResult.moveError();
+    }
+
+    const auto* frameHeader = frameHeaderResult.value();
+    if (frameHeader->magic != kPersistentStoreJournalFrameMagic) {
+        return Error("Invalid journal frame");
+    }
+
+    auto payloadLength = static_cast<size_t>(frameHeader->length);
+    auto payloadResult = parser.parse<Byte>(payloadLength);
+    if (!payloadResult) {
+        return payloadResult.moveError();
+    }
+
+    if (computeJournalChecksum(payloadResult.value(), payloadLength) != frameHeader->checksum) {
+        return Error("Journal frame checksum mismatch");
+    }
+
+    // The last frame might be missing its padding if the write was interrupted, which is harmless
+    auto padding = std::min(journalFramePaddingForLength(payloadLength), parser.getDistanceToEnd());
+    static_cast<void>(parser.parse<Byte>(padding));
+
+    auto payload = BytesView(source, payloadResult.value(), payloadLength);
+    if (_encryptedDiskCache != nullptr) {
+        return _encryptedDiskCache->decrypt(payload);
+    }
+
+    return payload;
+}
+
+void PersistentStore::replayJournal() {
+    auto loadResult = _journalDiskCache->load(_journalPath);
+    if (!loadResult) {
+        VALDI_WARN(_logger,
+                   "Failed to load journal at '{}': {}",
+                   _journalDiskCache->getAbsoluteURL(_journalPath),
+                   loadResult.error());
+        _needsCompaction = true;
+        return;
+    }
+
+    const auto& journal = loadResult.value();
+    _journalSize = journal.size();
+
+    auto parser = Parser<Byte>(journal.begin(), journal.end());
+    while (!parser.isAtEnd()) {
+        auto frameOffset = parser.getDistanceToBegin();
+
+        Result<Void> result;
+        auto frameResult = readJournalFrame(parser, journal.getSource());
+        if (frameResult) {
+            result = _store.replayJournal(frameResult.value());
+        } else {
+            result = frameResult.moveError();
+        }
+
+        if (!result) {
+            // Frames are only ever appended, so a frame which cannot be read is the result of a save
+            // which was interrupted. Mutations after it are dropped, and the next save writes a new snapshot
+            // so that the journal does not keep growing after an unreadable frame.
+            VALDI_WARN(_logger,
+                       "Dropping {} bytes at the end of journal '{}': {}",
+                       journal.size() - frameOffset,
+                       _journalDiskCache->getAbsoluteURL(_journalPath),
+                       result.error());
+            _needsCompaction = true;
+            break;
+        }
+    }
+}
+
 void PersistentStore::populate() {
     _dispatchQueue->async([self = strongRef(this)]() { self->doPopulate(); });
 }
@@ -183,11 +380,16 @@ void PersistentStore::onPopulateFailure(const Error& error) {
     VALDI_ERROR(
         _logger, "Failed to populate cache at '{}': {}", _activeDiskCache->getAbsoluteURL(_diskCachePath), error);
     _store.removeAll();
+    _needsCompaction = true;
 }
 
 void PersistentStore::doPopulate() {
+    _snapshotSize = 0;
+    _journalSize = 0;
+    _needsCompaction = true;
+
     if (_activeDiskCache->exists(_diskCachePath)) {
-        auto result = _activeDiskCache->load(_diskCachePath);
+        auto result = _activeDiskCache->loadMapped(_diskCachePath);
         if (!result) {
             onPopulateFailure(result.error());
             return;
@@ -198,6 +400,13 @@ void PersistentStore::doPopulate() {
             onPopulateFailure(populateResult.error());
             return;
         }
+
+        _snapshotSize = result.value().size();
+        _needsCompaction = false;
+    }
+
+    if (_journalDiskCache->exists(_journalPath)) {
+        replayJournal();
     }
 }
 
@@ -14,6 +14,7 @@
 #include "valdi_core/cpp/Utils/ByteBuffer.hpp"
 #include "valdi_core/cpp/Utils/Bytes.hpp"
 #include "valdi_core/cpp/Utils/FlatMap.hpp"
+#include "valdi_core/cpp/Utils/Parser.hpp"
 #include "valdi_core/cpp/Utils/PathUtils.hpp"
 #include "valdi_core/cpp/Utils/Result.hpp"
 #include "valdi_core/cpp/Utils/StringBox.hpp"
@@ -30,7 +31,16 @@ class Keychain;
 namespace Valdi {
 
 class UserSession;
-
+class EncryptedDiskCache;
+
+/**
+ PersistentStore keeps a KeyValueStore in memory and persists it into a disk cache.
+ The store is persisted as a snapshot, which contains the whole serialized KeyValueStore,
+ followed by a journal of the mutations that were made after the snapshot was written.
+ Saves only append the new mutations to the journal. The journal is compacted into a new
+ snapshot once it grows larger than the snapshot itself. Fetches are not journaled: the recency
+ they update for eviction is persisted at the next compaction, and is lost if the process exits before it.
+ */
 class PersistentStore : public ValdiObject {
 public:
     PersistentStore(const StringBox& diskCachePath,
@@ -73,19 +83,32 @@ public:
 private:
     KeyValueStore _store;
     Path _diskCachePath;
+    Path _journalPath;
     Ref<IDiskCache> _diskCache;
     Ref<IDiskCache> _activeDiskCache;
+    // The journal is appended to without encryption, frames are encrypted individually instead
+    Ref<IDiskCache> _journalDiskCache;
+    Ref<EncryptedDiskCache> _encryptedDiskCache;
     Ref<UserSession> _userSession;
     Shared<snap::valdi::Keychain> _keychain;
     Ref<DispatchQueue> _dispatchQueue;
     [[maybe_unused]] ILogger& _logger;
     bool _disableBatchWrites;
     std::vector<Function<void(Result<Void>)>> _pendingSaves;
+    size_t _snapshotSize = 0;
+    size_t _journalSize = 0;
+    bool _needsCompaction = true;
 
     void scheduleSave(Function<void(Result<Void>)> completion);
     void doSave();
     void doPopulate();
 
+    bool shouldCompact() const;
+    Result<Void> compact();
+    Result<Void> appendJournal();
+    void replayJournal();
+    Result<BytesView> readJournalFrame(Parser<Byte>& parser, const Ref<RefCountable>& source);
+
     void updateUserSession(const Ref<UserSession>& userSession);
     void updateActiveDiskStore();
 
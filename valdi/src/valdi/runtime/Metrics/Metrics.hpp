@@ -80,6 +80,8 @@ public:
     virtual void emitModuleArchiveMmapSuccess(const StringBox& module) {};
     virtual void emitModuleArchiveMmapFallback(const StringBox& module) {};
     virtual void emitModuleArchiveHeap(const StringBox& module) {};
+    // The archive uses the seekable format, whose entries are decompressed on demand.
+    virtual void emitModuleArchiveSeekable(const StringBox& module) {};
     // Wall-clock time spent decompressing a module archive (either backing).
     virtual void emitModuleDecompressLatency(const StringBox& module, const MetricsDuration& duration) {};
     // Mmap region created and decompressed successfully, but std::rename of the
@@ -88,6 +90,14 @@ public:
     // counter exists so the A/B can observe and alert on the publish failure.
     virtual void emitModuleArchiveMmapPublishFail(const StringBox& module) {};
 
+    // Decoded image cache of the snap_drawing image loader. A hit means that no decode was needed,
+    // even if a resized variant had to be created from the cached original.
+    virtual void emitImageCacheHit() {};
+    virtual void emitImageCacheMiss() {};
+    // Emitted once per eviction pass that released memory, with the bytes released from the
+    // originals and from the resized variants.
+    virtual void emitImageCacheEviction(int64_t originalsBytes, int64_t variantsBytes) {};
+
     // Wall time of one synchronous view-tree inflation pass (ViewNode::updateViewTree),
     // with the node/view counts the pass already computes. The counts let a slow pass be
     // attributed to one expensive platform view (low createdViews) vs a wide inflation
@@ -121,10 +121,10 @@ Result<Void> Bundle::lockFreeLoadEntriesIfNeeded() {
 
     _loadedEntries = true;
 
+    // Entries are resolved lazily in getEntry(), so that archives in the seekable format
+    // only decompress the entries that are actually used.
     for (const auto& entryPath : _decompressedBundle->getAllEntryPaths()) {
         if (_entryByPath.find(entryPath) == _entryByPath.end()) {
-            auto entry = _decompressedBundle->getEntry(entryPath);
-            _entryByPath[entryPath] = BytesView(_decompressedBundle, entry->data, entry->size);
             _allEntryPaths.emplace_back(entryPath);
         }
     }
@@ -132,47 +132,78 @@ Result<Void> Bundle::lockFreeLoadEntriesIfNeeded() {
     return Void();
 }
 
+bool Bundle::lockFreeArchiveContainsEntry(const StringBox& path) const {
+    return _loadedEntries && _decompressedBundle != nullptr && _decompressedBundle->containsEntry(path);
+}
+
 Result<BytesView> Bundle::getEntry(const StringBox& path) {
-    std::lock_guard<std::recursive_mutex> guard(_mutex);
+    Ref<ValdiModuleArchive> archive;
+    {
+        std::lock_guard<std::recursive_mutex> guard(_mutex);
+
+        auto archiveResult = lockFreeLoadEntriesIfNeeded();
+        if (!archiveResult) {
+            return archiveResult.moveError();
+        }
+
+        const auto& it = _entryByPath.find(path);
+        if (it != _entryByPath.end()) {
+            return it->second;
+        }
+
+        if (!lockFreeArchiveContainsEntry(path)) {
+            return Error(STRING_FORMAT("No item named '{}' in module '{}', available items are: {}",
+                                       path,
+                                       _name,
+                                       StringBox::join(_allEntryPaths, ", ")));
+        }
 
-    auto archiveResult = lockFreeLoadEntriesIfNeeded();
-    if (!archiveResult) {
-        return archiveResult.moveError();
+        archive = _decompressedBundle;
     }
 
+    // Entries of seekable archives are decompressed on first access. This is done outside of the lock,
+    // so that other entries of the bundle can be resolved in the meantime.
+    auto entry = archive->getEntryBytes(path);
+    if (!entry) {
+        return entry.error().rethrow(STRING_FORMAT("Failed to load item '{}' in module '{}'", path, _name));
+    }
+
+    std::lock_guard<std::recursive_mutex> guard(_mutex);
+    // The entry might have been set while it was being decompressed
     const auto& it = _entryByPath.find(path);
-    if (it == _entryByPath.end()) {
-        return Error(STRING_FORMAT("No item named '{}' in module '{}', available items are: {}",
-                                   path,
-                                   _name,
-                                   StringBox::join(_allEntryPaths, ", ")));
+    if (it != _entryByPath.end()) {
+        return it->second;
     }
 
-    return it->second;
+    _entryByPath[path] = entry.value();
+
+    return entry;
 }
 
 bool Bundle::hasEntry(const StringBox& path) {
     std::lock_guard<std::recursive_mutex> guard(_mutex);
     lockFreeLoadEntriesIfNeeded();
 
-    return _entryByPath.find(path) != _entryByPath.end();
+    return _entryByPath.find(path) != _entryByPath.end() || lockFreeArchiveContainsEntry(path);
 }
 
 void Bundle::setEntry(const StringBox& path, const BytesView& data) {
     std::lock_guard<std::recursive_mutex> guard(_mutex);
 
     const auto& it = _entryByPath.find(path);
-    if (it == _entryByPath.end()) {
+    if (it == _entryByPath.end() && !lockFreeArchiveContainsEntry(path)) {
         _allEntryPaths.emplace_back(path);
     }
     _entryByPath[path] = data;
 }
 
 Result<JavaScriptFile> Bundle::getJs(const StringBox& jsPath) {
-    std::lock_guard<std::recursive_mutex> guard(_mutex);
-    const auto& it = _jsFilesByPath.find(jsPath);
-    if (it != _jsFilesByPath.end()) {
-        return it->second;
+    {
+        std::lock_guard<std::recursive_mutex> guard(_mutex);
+        const auto& it = _jsFilesByPath.find(jsPath);
+        if (it != _jsFilesByPath.end()) {
+            return it->second;
+        }
     }
 
     auto key = jsPath.append(".js");
@@ -181,10 +212,14 @@ Result<JavaScriptFile> Bundle::getJs(const StringBox& jsPath) {
         return entryResult.moveError();
     }
 
-    auto entry = entryResult.moveValue();
-
     auto jsFile = JavaScriptFile(entryResult.value(), StringBox::emptyString());
 
+    std::lock_guard<std::recursive_mutex> guard(_mutex);
+    const auto& it = _jsFilesByPath.find(jsPath);
+    if (it != _jsFilesByPath.end()) {
+        return it->second;
+    }
+
     _jsFilesByPath[jsPath] = jsFile;
 
     return jsFile;
@@ -217,10 +252,12 @@ void Bundle::setJs(const StringBox& jsPath, const JavaScriptFile& jsFile) {
 }
 
 Result<BundleResourceContent> Bundle::getResourceContent(const StringBox& path) {
-    std::lock_guard<std::recursive_mutex> guard(_mutex);
-    const auto& it = _resourceContentByPath.find(path);
-    if (it != _resourceContentByPath.end()) {
-        return it->second;
+    {
+        std::lock_guard<std::recursive_mutex> guard(_mutex);
+        const auto& it = _resourceContentByPath.find(path);
+        if (it != _resourceContentByPath.end()) {
+            return it->second;
+        }
     }
 
     auto entryResult = getEntry(path);
@@ -238,11 +275,13 @@ void Bundle::setResourceContent(const StringBox& path, const BundleResourceConte
 }
 
 Result<Ref<CSSDocument>> Bundle::getCSSDocument(const StringBox& path, AttributeIds& attributeIds) {
-    std::lock_guard<std::recursive_mutex> guard(_mutex);
+    {
+        std::lock_guard<std::recursive_mutex> guard(_mutex);
 
-    const auto& it = _cssDocumentByPath.find(path);
-    if (it != _cssDocumentByPath.end()) {
-        return it->second;
+        const auto& it = _cssDocumentByPath.find(path);
+        if (it != _cssDocumentByPath.end()) {
+            return it->second;
+        }
     }
 
     auto entryResult = getEntry(path);
@@ -253,10 +292,19 @@ Result<Ref<CSSDocument>> Bundle::getCSSDocument(const StringBox& path, Attribute
     auto entry = entryResult.moveValue();
 
     auto documentResult = CSSDocument::parse(ResourceId(_name, path), entry.data(), entry.size(), attributeIds);
-    if (documentResult) {
-        _cssDocumentByPath[path] = documentResult.value();
+    if (!documentResult) {
+        return documentResult;
     }
 
+    std::lock_guard<std::recursive_mutex> guard(_mutex);
+    // Another thread might have parsed the same document in the meantime, the first one is kept
+    const auto& it = _cssDocumentByPath.find(path);
+    if (it != _cssDocumentByPath.end()) {
+        return it->second;
+    }
+
+    _cssDocumentByPath[path] = documentResult.value();
+
     return documentResult;
 }
 
@@ -270,7 +318,6 @@ bool Bundle::hasModuleLoadStrategy() {
 }
 
 Result<Ref<ModuleLoadStrategy>> Bundle::getModuleLoadStrategy() {
-    std::lock_guard<std::recursive_mutex> guard(_mutex);
     auto resourceContent = getResourceContent(loadStrategyFilePath());
     if (!resourceContent) {
         return resourceContent.moveError();
@@ -309,20 +356,12 @@ void Bundle::unloadUnusedResources() {
 }
 
 Result<Ref<AssetCatalog>> Bundle::getAssetCatalog(const StringBox& assetCatalogPath) {
-    std::lock_guard<std::recursive_mutex> guard(_mutex);
-
-    return lockFreeGetAssetCatalog(assetCatalogPath);
-}
-
-void Bundle::setAssetCatalog(const StringBox& assetCatalogPath, const Ref<AssetCatalog>& assetCatalog) {
-    std::lock_guard<std::recursive_mutex> guard(_mutex);
-    _assetCatalogByPath[assetCatalogPath] = assetCatalog;
-}
-
-Result<Ref<AssetCatalog>> Bundle::lockFreeGetAssetCatalog(const StringBox& assetCatalogPath) {
-    const auto& it = _assetCatalogByPath.find(assetCatalogPath);
-    if (it != _assetCatalogByPath.end()) {
-        return it->second;
+    {
+        std::lock_guard<std::recursive_mutex> guard(_mutex);
+        const auto& it = _assetCatalogByPath.find(assetCatalogPath);
+        if (it != _assetCatalogByPath.end()) {
+            return it->second;
+        }
     }
 
     auto entry = getEntry(assetCatalogPath.append(".assetcatalog"));
@@ -335,6 +374,12 @@ Result<Ref<AssetCatalog>> Bundle::lockFreeGetAssetCatalog(const StringBox& asset
         return catalogResult.moveError();
     }
 
+    std::lock_guard<std::recursive_mutex> guard(_mutex);
+    const auto& it = _assetCatalogByPath.find(assetCatalogPath);
+    if (it != _assetCatalogByPath.end()) {
+        return it->second;
+    }
+
     auto catalog = catalogResult.moveValue();
 
     _assetCatalogByPath[assetCatalogPath] = catalog;
@@ -342,6 +387,11 @@ Result<Ref<AssetCatalog>> Bundle::lockFreeGetAssetCatalog(const StringBox& asset
     return catalog;
 }
 
+void Bundle::setAssetCatalog(const StringBox& assetCatalogPath, const Ref<AssetCatalog>& assetCatalog) {
+    std::lock_guard<std::recursive_mutex> guard(_mutex);
+    _assetCatalogByPath[assetCatalogPath] = assetCatalog;
+}
+
 const StringBox& Bundle::getName() const {
     return _name;
 }
@@ -352,12 +402,11 @@ const StringBox& Bundle::getName() const {
  * Returns:
  * - A Result<StringBox> containing the 'hash' entry if it exists. Error if it does not.
  * Notes:
- * - Thread-safe. Using a recursive mutex to guard access.
+ * - Thread-safe.
  * - See BundleResourcesProcessor.swift for how the 'hash' file is generated.
  */
 Result<StringBox> Bundle::getHash() {
     static auto kHashName = STRING_LITERAL("hash");
-    std::lock_guard<std::recursive_mutex> guard(_mutex);
 
     auto entryResult = getResourceContent(kHashName);
     if (!entryResult) {
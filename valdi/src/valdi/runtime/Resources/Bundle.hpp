@@ -162,8 +162,7 @@ private:
     std::vector<StringBox> _allEntryPaths;
 
     Result<Void> lockFreeLoadEntriesIfNeeded();
-
-    Result<Ref<AssetCatalog>> lockFreeGetAssetCatalog(const StringBox& assetCatalogPath);
+    bool lockFreeArchiveContainsEntry(const StringBox& path) const;
 };
 
 } // namespace Valdi
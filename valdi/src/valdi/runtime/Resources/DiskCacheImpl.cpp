@@ -6,6 +6,7 @@
 //
 
 #include "valdi/runtime/Resources/DiskCacheImpl.hpp"
+#include "valdi/runtime/Resources/MmapBuffer.hpp"
 #include "valdi_core/cpp/Utils/DiskUtils.hpp"
 #include "valdi_core/cpp/Utils/Format.hpp"
 #include "valdi_core/cpp/Utils/PathUtils.hpp"
@@ -46,6 +47,25 @@ Result<BytesView> DiskCacheImpl::load(const Path& path) {
     return DiskUtils::load(resolvedPath.value());
 }
 
+Result<BytesView> DiskCacheImpl::loadMapped(const Path& path) {
+    auto resolvedPath = resolveAbsolutePath(path, true);
+    if (!resolvedPath) {
+        return resolvedPath.moveError();
+    }
+
+    if (DiskUtils::stat(resolvedPath.value()).size() == 0) {
+        // Empty files cannot be mapped
+        return DiskUtils::load(resolvedPath.value());
+    }
+
+    auto buffer = MmapBuffer::openReadOnly(resolvedPath.value());
+    if (!buffer) {
+        return buffer.moveError();
+    }
+
+    return buffer.value()->toBytesView();
+}
+
 Result<BytesView> DiskCacheImpl::loadForAbsoluteURL(const StringBox& url) {
     URL parsedURL(url);
     if (parsedURL.getScheme() != "file") {
@@ -56,7 +76,7 @@ Result<BytesView> DiskCacheImpl::loadForAbsoluteURL(const StringBox& url) {
     return load(path);
 }
 
-Result<Void> DiskCacheImpl::store(const Path& path, const BytesView& bytes) {
+Result<Path> DiskCacheImpl::resolveAbsolutePathForWrite(const Path& path, std::string_view operation) const {
     auto resolvedPath = resolveAbsolutePath(path, false);
     if (!resolvedPath) {
         return resolvedPath.moveError();
@@ -67,11 +87,39 @@ Result<Void> DiskCacheImpl::store(const Path& path, const BytesView& bytes) {
     if (filePath.getComponents().size() > 1) {
         auto directoryPath = filePath.removingLastComponent();
         if (!DiskUtils::isDirectory(directoryPath) && !DiskUtils::makeDirectory(directoryPath, true)) {
-            return Error(STRING_FORMAT("Failed to create directories to store file at {}", filePath.toString()));
+            return Error(
+                STRING_FORMAT("Failed to create directories to {} file at {}", operation, filePath.toString()));
         }
     }
 
-    return DiskUtils::store(filePath, bytes);
+    return filePath;
+}
+
+Result<Void> DiskCacheImpl::store(const Path& path, const BytesView& bytes) {
+    auto filePath = resolveAbsolutePathForWrite(path, "store");
+    if (!filePath) {
+        return filePath.moveError();
+    }
+
+    return DiskUtils::store(filePath.value(), bytes);
+}
+
+Result<Void> DiskCacheImpl::storeAtomically(const Path& path, const BytesView& bytes) {
+    auto filePath = resolveAbsolutePathForWrite(path, "store");
+    if (!filePath) {
+        return filePath.moveError();
+    }
+
+    return DiskUtils::storeAtomically(filePath.value(), bytes);
+}
+
+Result<Void> DiskCacheImpl::append(const Path& path, const BytesView& bytes) {
+    auto filePath = resolveAbsolutePathForWrite(path, "append");
+    if (!filePath) {
+        return filePath.moveError();
+    }
+
+    return DiskUtils::append(filePath.value(), bytes);
 }
 
 Ref<IDiskCache> DiskCacheImpl::scopedCache(const Path& subfolder, bool allowsReadOutsideOfScope) const {
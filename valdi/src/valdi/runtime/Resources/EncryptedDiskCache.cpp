@@ -38,6 +38,17 @@ Result<BytesView> EncryptedDiskCache::load(const Path& path) {
     return decrypt(data.value());
 }
 
+Result<BytesView> EncryptedDiskCache::loadMapped(const Path& path) {
+    // The content is decrypted into memory, it is still worth mapping the encrypted file
+    // so that it does not need to be copied into a buffer first.
+    auto data = _diskCache->loadMapped(path);
+    if (!data) {
+        return data.moveError();
+    }
+
+    return decrypt(data.value());
+}
+
 Result<BytesView> EncryptedDiskCache::loadForAbsoluteURL(const StringBox& url) {
     auto data = _diskCache->loadForAbsoluteURL(url);
     if (!data) {
@@ -55,6 +66,20 @@ Result<Void> EncryptedDiskCache::store(const Path& path, const BytesView& bytes)
     return _diskCache->store(path, encrypted.value());
 }
 
+Result<Void> EncryptedDiskCache::storeAtomically(const Path& path, const BytesView& bytes) {
+    auto encrypted = encrypt(bytes);
+    if (!encrypted) {
+        return encrypted.moveError();
+    }
+    return _diskCache->storeAtomically(path, encrypted.value());
+}
+
+Result<Void> EncryptedDiskCache::append(const Path& /*path*/, const BytesView& /*bytes*/) {
+    // Each encrypted payload carries its own IV, so they cannot be concatenated into a single file.
+    // Callers which need to append should use encrypt() on the individual chunks instead.
+    return Error("EncryptedDiskCache does not support appending");
+}
+
 bool EncryptedDiskCache::remove(const Path& path) {
     return _diskCache->remove(path);
 }
@@ -34,10 +34,16 @@ public:
 
     Result<BytesView> load(const Path& path) final;
 
+    Result<BytesView> loadMapped(const Path& path) final;
+
     Result<BytesView> loadForAbsoluteURL(const StringBox& url) final;
 
     Result<Void> store(const Path& path, const BytesView& bytes) final;
 
+    Result<Void> storeAtomically(const Path& path, const BytesView& bytes) final;
+
+    Result<Void> append(const Path& path, const BytesView& bytes) final;
+
     bool remove(const Path& path) final;
 
     StringBox getAbsoluteURL(const Path& path) const final;
@@ -52,6 +58,9 @@ public:
 
     static StringBox getKeychainKey();
 
+    Result<BytesView> decrypt(const BytesView& input);
+    Result<BytesView> encrypt(const BytesView& input);
+
 private:
     Mutex _mutex;
     Ref<IDiskCache> _diskCache;
@@ -62,9 +71,6 @@ private:
                        const Shared<snap::valdi::Keychain>& keychain,
                        const std::optional<snap::utils::crypto::AesEncryptor::Key>& cryptoKey);
 
-    Result<BytesView> decrypt(const BytesView& input);
-    Result<BytesView> encrypt(const BytesView& input);
-
     DataEncryptor getDataEncryptor();
     bool restoreCryptoKey(const StringBox& path);
     void generateCryptoKey(const StringBox& path);
@@ -11,8 +11,12 @@
 #include "valdi_core/cpp/Utils/Parser.hpp"
 #include "valdi_core/cpp/Utils/StringCache.hpp"
 
+#include <algorithm>
+
 namespace Valdi {
 
+// Manifest of the snapshots written before the indexed format was introduced,
+// they are stored as a ValdiArchive and can still be populated.
 struct KeyValueStoreEntryManifest {
     uint64_t mutationId;
     uint64_t expirationDate;
@@ -25,7 +29,59 @@ struct KeyValueStoreManifest {
     KeyValueStoreEntryManifest manifest[0];
 };
 
-constexpr uint64_t kKeyValueStoreVersion = 2;
+constexpr uint64_t kKeyValueStoreLegacyVersion = 2;
+
+constexpr uint32_t kKeyValueStoreSnapshotMagic = 0x53564b56; // "VKVS"
+constexpr uint32_t kKeyValueStoreSnapshotVersion = 3;
+constexpr size_t kKeyValueStoreSnapshotAlignment = 8;
+
+/**
+ A snapshot starts with this header, followed by the index of the entries sorted by key,
+ followed by the keys and the data of the entries. Offsets are relative to the start of the snapshot.
+ */
+struct KeyValueStoreSnapshotHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t mutationIdSequence;
+    uint64_t entriesCount;
+};
+
+struct KeyValueStoreSnapshotIndexEntry {
+    uint64_t mutationId;
+    uint64_t expirationDate;
+    uint64_t weight;
+    uint64_t keyOffset;
+    uint64_t dataOffset;
+    uint64_t dataLength;
+    uint32_t keyLength;
+    uint32_t reserved;
+};
+
+enum KeyValueStoreJournalRecordType : uint32_t {
+    KeyValueStoreJournalRecordTypeStore = 1,
+    KeyValueStoreJournalRecordTypeRemove = 2,
+    KeyValueStoreJournalRecordTypeRemoveAll = 3,
+};
+
+/**
+ Header of a journal record, followed by the key and the data of the entry.
+ Records are padded to 8 bytes so that headers can be read in place.
+ */
+struct KeyValueStoreJournalRecord {
+    uint32_t type;
+    uint32_t keyLength;
+    uint64_t mutationId;
+    uint64_t expirationDate;
+    uint64_t weight;
+    uint64_t dataLength;
+};
+
+constexpr size_t kKeyValueStoreJournalAlignment = 8;
+
+static size_t journalPaddingForLength(size_t length) {
+    return (kKeyValueStoreJournalAlignment - (length % kKeyValueStoreJournalAlignment)) %
+           kKeyValueStoreJournalAlignment;
+}
 
 STRING_CONST(manifestEntryName, "__manifest__")
 
@@ -45,25 +101,46 @@ void KeyValueStore::store(const StringBox& key, const BytesView& blob, uint64_t
         expirationDateSeconds = currentTimeSeconds() + ttlSeconds;
     }
 
-    _entries[key] = KeyValueStoreEntry(++_mutationId, expirationDateSeconds, weight, blob);
+    setEntry(key, KeyValueStoreEntry(++_mutationId, expirationDateSeconds, weight, blob));
+    appendJournalRecord(KeyValueStoreJournalRecordTypeStore, key, _entries[key]);
 }
 
 std::optional<BytesView> KeyValueStore::fetch(const StringBox& key, bool updateSequence) {
     auto it = _entries.find(key);
-    if (it == _entries.end()) {
+    if (it != _entries.end()) {
+        if (isEntryExpired(it->second)) {
+            removeExpiredEntry(key);
+            return std::nullopt;
+        }
+
+        if (updateSequence) {
+            it->second.mutationId = ++_mutationId;
+        }
+
+        return {it->second.data};
+    }
+
+    const auto* indexEntry = findSnapshotEntry(key);
+    if (indexEntry == nullptr) {
         return std::nullopt;
     }
 
-    if (isEntryExpired(it->second)) {
-        _entries.erase(it);
+    auto entry = makeSnapshotEntry(*indexEntry);
+    if (isEntryExpired(entry)) {
+        removeExpiredEntry(key);
         return std::nullopt;
     }
 
     if (updateSequence) {
-        it->second.mutationId = ++_mutationId;
+        // The entry is kept in the store so that its new mutation id is used for eviction
+        // and written in the next snapshot
+        entry.mutationId = ++_mutationId;
+        auto& materializedEntry = _entries[key];
+        materializedEntry = std::move(entry);
+        return {materializedEntry.data};
     }
 
-    return {it->second.data};
+    return {entry.data};
 }
 
 std::optional<BytesView> KeyValueStore::fetch(const StringBox& key) {
@@ -79,17 +156,66 @@ bool KeyValueStore::exists(const StringBox& key) {
 }
 
 bool KeyValueStore::remove(const StringBox& key) {
-    const auto& it = _entries.find(key);
-    if (it == _entries.end()) {
+    if (_entries.find(key) == _entries.end() && findSnapshotEntry(key) == nullptr) {
         return false;
     }
 
-    _entries.erase(it);
+    eraseEntry(key);
+    appendJournalRecord(KeyValueStoreJournalRecordTypeRemove, key, KeyValueStoreEntry());
     return true;
 }
 
 void KeyValueStore::removeAll() {
+    clearEntries();
+    appendJournalRecord(KeyValueStoreJournalRecordTypeRemoveAll, StringBox(), KeyValueStoreEntry());
+}
+
+uint64_t KeyValueStore::getEntryWeight(const StringBox& key) const {
+    const auto& it = _entries.find(key);
+    if (it != _entries.end()) {
+        return it->second.weight;
+    }
+
+    const auto* indexEntry = findSnapshotEntry(key);
+    return indexEntry != nullptr ? indexEntry->weight : 0;
+}
+
+void KeyValueStore::setEntry(const StringBox& key, KeyValueStoreEntry&& entry) {
+    _totalWeight = _totalWeight - getEntryWeight(key) + entry.weight;
+    _entries[key] = std::move(entry);
+}
+
+void KeyValueStore::eraseEntry(const StringBox& key) {
+    _totalWeight -= getEntryWeight(key);
+
+    const auto& it = _entries.find(key);
+    if (it != _entries.end()) {
+        _entries.erase(it);
+    }
+
+    // The entry would otherwise be visible again from the snapshot
+    if (findSnapshotEntry(key) != nullptr) {
+        _removedSnapshotKeys.insert(key);
+    }
+}
+
+void KeyValueStore::removeExpiredEntry(const StringBox& key) {
+    // Expired entries are removed like any other entry, so that the removal is persisted with the next save
+    eraseEntry(key);
+    appendJournalRecord(KeyValueStoreJournalRecordTypeRemove, key, KeyValueStoreEntry());
+}
+
+void KeyValueStore::clearEntries() {
     _entries.clear();
+    clearSnapshot();
+    _totalWeight = 0;
+}
+
+void KeyValueStore::clearSnapshot() {
+    _snapshot = BytesView();
+    _snapshotIndex = nullptr;
+    _snapshotEntriesCount = 0;
+    _removedSnapshotKeys.clear();
 }
 
 void KeyValueStore::setMaxWeight(uint64_t maxWeight) {
@@ -100,34 +226,63 @@ uint64_t KeyValueStore::getMaxWeight() const {
     return _maxWeight;
 }
 
+void KeyValueStore::evictEntriesIfNeeded() {
+    if (_maxWeight > 0 && _totalWeight > _maxWeight) {
+        collectEntries();
+    }
+}
+
 std::vector<std::pair<StringBox, KeyValueStoreEntry>> KeyValueStore::collectEntries() {
     std::vector<std::pair<StringBox, KeyValueStoreEntry>> entries;
-    entries.reserve(_entries.size());
+    entries.reserve(_entries.size() + _snapshotEntriesCount);
 
     auto it = _entries.begin();
     while (it != _entries.end()) {
         if (!isEntryExpired(it->second)) {
-            auto pair = std::make_pair(it->first, it->second);
-            auto insertionIt = std::upper_bound(entries.begin(),
-                                                entries.end(),
-                                                pair,
-                                                [](const std::pair<StringBox, KeyValueStoreEntry>& left,
-                                                   const std::pair<StringBox, KeyValueStoreEntry>& right) {
-                                                    return left.second.mutationId < right.second.mutationId;
-                                                });
-
-            entries.emplace(insertionIt, std::move(pair));
-
+            entries.emplace_back(it->first, it->second);
             it++;
         } else {
+            if (findSnapshotEntry(it->first) != nullptr) {
+                _removedSnapshotKeys.insert(it->first);
+            }
             it = _entries.erase(it);
         }
     }
 
+    for (size_t i = 0; i < _snapshotEntriesCount; i++) {
+        const auto& indexEntry = _snapshotIndex[i];
+        auto entry = makeSnapshotEntry(indexEntry);
+        auto key = StringCache::getGlobal().makeString(getSnapshotKey(indexEntry));
+        if (_entries.find(key) != _entries.end() ||
+            _removedSnapshotKeys.find(key) != _removedSnapshotKeys.end()) {
+            continue;
+        }
+
+        if (isEntryExpired(entry)) {
+            removeExpiredEntry(key);
+            continue;
+        }
+
+        entries.emplace_back(std::move(key), std::move(entry));
+    }
+
+    std::sort(entries.begin(),
+              entries.end(),
+              [](const std::pair<StringBox, KeyValueStoreEntry>& left,
+                 const std::pair<StringBox, KeyValueStoreEntry>& right) {
+                  return left.second.mutationId < right.second.mutationId;
+              });
+
     if (_maxWeight > 0) {
         evictEntriesIfNeeded(entries);
     }
 
+    // The collected entries are now the only entries of the store
+    _totalWeight = 0;
+    for (const auto& it : entries) {
+        _totalWeight += it.second.weight;
+    }
+
     return entries;
 }
 
@@ -146,12 +301,11 @@ void KeyValueStore::evictEntriesIfNeeded(std::vector<std::pair<StringBox, KeyVal
     }
 
     if (i > 0) {
-        // Remove all evicted entries from the entries map
+        // Remove all evicted entries from the store
         for (size_t j = 0; j < i; j++) {
-            const auto& it = _entries.find(collectedEntries[j].first);
-            if (it != _entries.end()) {
-                _entries.erase(it);
-            }
+            eraseEntry(collectedEntries[j].first);
+            appendJournalRecord(
+                KeyValueStoreJournalRecordTypeRemove, collectedEntries[j].first, KeyValueStoreEntry());
         }
 
         // Also remove them from the collected entries
@@ -159,38 +313,77 @@ void KeyValueStore::evictEntriesIfNeeded(std::vector<std::pair<StringBox, KeyVal
     }
 }
 
-void KeyValueStore::buildManifest(const std::vector<std::pair<StringBox, KeyValueStoreEntry>>& entries,
-                                  ByteBuffer& output) const {
-    KeyValueStoreManifest manifest;
-    manifest.version = kKeyValueStoreVersion;
-    manifest.mutationIdSequence = _mutationId;
+static size_t snapshotPaddingForLength(size_t length) {
+    return (kKeyValueStoreSnapshotAlignment - (length % kKeyValueStoreSnapshotAlignment)) %
+           kKeyValueStoreSnapshotAlignment;
+}
 
-    output.append(reinterpret_cast<const Byte*>(&manifest),
-                  reinterpret_cast<const Byte*>(&manifest) + sizeof(manifest));
+Result<BytesView> KeyValueStore::serialize() {
+    auto entries = collectEntries();
 
+    std::sort(entries.begin(),
+              entries.end(),
+              [](const std::pair<StringBox, KeyValueStoreEntry>& left,
+                 const std::pair<StringBox, KeyValueStoreEntry>& right) {
+                  return left.first.toStringView() < right.first.toStringView();
+              });
+
+    size_t payloadOffset =
+        sizeof(KeyValueStoreSnapshotHeader) + entries.size() * sizeof(KeyValueStoreSnapshotIndexEntry);
+    size_t payloadSize = 0;
     for (const auto& it : entries) {
-        KeyValueStoreEntryManifest entry;
-        entry.mutationId = it.second.mutationId;
-        entry.expirationDate = it.second.expirationDate;
-        entry.weight = it.second.weight;
+        payloadSize += it.first.length();
+        payloadSize += it.second.data.size();
+        payloadSize += snapshotPaddingForLength(it.second.data.size());
+    }
+
+    auto output = makeShared<ByteBuffer>();
+    output->reserve(payloadOffset + payloadSize + kKeyValueStoreSnapshotAlignment);
 
-        output.append(reinterpret_cast<const Byte*>(&entry), reinterpret_cast<const Byte*>(&entry) + sizeof(entry));
+    KeyValueStoreSnapshotHeader header;
+    header.magic = kKeyValueStoreSnapshotMagic;
+    header.version = kKeyValueStoreSnapshotVersion;
+    header.mutationIdSequence = _mutationId;
+    header.entriesCount = static_cast<uint64_t>(entries.size());
+    output->append(reinterpret_cast<const Byte*>(&header), reinterpret_cast<const Byte*>(&header) + sizeof(header));
+
+    // Data is placed first and kept aligned, keys are placed at the end
+    auto dataOffset = payloadOffset;
+    auto keyOffset = payloadOffset;
+    for (const auto& it : entries) {
+        keyOffset += it.second.data.size() + snapshotPaddingForLength(it.second.data.size());
     }
-}
 
-Result<BytesView> KeyValueStore::serialize() {
-    ValdiArchiveBuilder builder;
+    for (const auto& it : entries) {
+        KeyValueStoreSnapshotIndexEntry indexEntry;
+        indexEntry.mutationId = it.second.mutationId;
+        indexEntry.expirationDate = it.second.expirationDate;
+        indexEntry.weight = it.second.weight;
+        indexEntry.keyOffset = static_cast<uint64_t>(keyOffset);
+        indexEntry.dataOffset = static_cast<uint64_t>(dataOffset);
+        indexEntry.dataLength = static_cast<uint64_t>(it.second.data.size());
+        indexEntry.keyLength = static_cast<uint32_t>(it.first.length());
+        indexEntry.reserved = 0;
+
+        output->append(reinterpret_cast<const Byte*>(&indexEntry),
+                       reinterpret_cast<const Byte*>(&indexEntry) + sizeof(indexEntry));
+
+        keyOffset += it.first.length();
+        dataOffset += it.second.data.size() + snapshotPaddingForLength(it.second.data.size());
+    }
 
-    auto entries = collectEntries();
-    ByteBuffer manifest;
-    buildManifest(entries, manifest);
-    builder.addEntry(ValdiArchiveEntry(manifestEntryName(), manifest.data(), manifest.size()));
+    for (const auto& it : entries) {
+        output->append(it.second.data.begin(), it.second.data.end());
+        for (size_t i = snapshotPaddingForLength(it.second.data.size()); i > 0; i--) {
+            output->append(static_cast<Byte>(0));
+        }
+    }
 
     for (const auto& it : entries) {
-        builder.addEntry(ValdiArchiveEntry(it.first, it.second.data.data(), it.second.data.size()));
+        output->append(it.first.toStringView());
     }
 
-    return builder.build()->toBytesView();
+    return output->toBytesView();
 }
 
 bool KeyValueStore::isEntryExpired(const KeyValueStoreEntry& entry) const {
@@ -212,7 +405,7 @@ Result<Parser<Byte>> parseManifest(const ValdiArchiveEntry& entry, uint64_t* idS
         return manifestHeaderResult.moveError();
     }
 
-    if (manifestHeaderResult.value()->version != kKeyValueStoreVersion) {
+    if (manifestHeaderResult.value()->version != kKeyValueStoreLegacyVersion) {
         return Error("Incompatible KeyValueStore version");
     }
 
@@ -238,6 +431,78 @@ Result<KeyValueStoreEntry> parseEntry(Parser<Byte>& manifestParser,
 }
 
 Result<Void> KeyValueStore::populate(const BytesView& data) {
+    if (data.size() >= sizeof(KeyValueStoreSnapshotHeader) &&
+        reinterpret_cast<const KeyValueStoreSnapshotHeader*>(data.data())->magic == kKeyValueStoreSnapshotMagic) {
+        return populateSnapshot(data);
+    }
+
+    return populateLegacyArchive(data);
+}
+
+Result<Void> KeyValueStore::populateSnapshot(const BytesView& data) {
+    auto parser = Parser<Byte>(data.begin(), data.end());
+    auto headerResult = parser.parseStruct<KeyValueStoreSnapshotHeader>();
+    if (!headerResult) {
+        return headerResult.moveError();
+    }
+
+    const auto* header = headerResult.value();
+    if (header->version != kKeyValueStoreSnapshotVersion) {
+        return Error("Incompatible KeyValueStore version");
+    }
+
+    if (header->entriesCount > parser.getDistanceToEnd() / sizeof(KeyValueStoreSnapshotIndexEntry)) {
+        return Error("Truncated KeyValueStore index");
+    }
+
+    auto entriesCount = static_cast<size_t>(header->entriesCount);
+    auto indexResult =
+        parser.parse<KeyValueStoreSnapshotIndexEntry>(entriesCount * sizeof(KeyValueStoreSnapshotIndexEntry));
+    if (!indexResult) {
+        return indexResult.moveError();
+    }
+
+    // Only the index is validated here, keys and data are not touched until they are used
+    const auto* index = indexResult.value();
+    auto size = static_cast<uint64_t>(data.size());
+    for (size_t i = 0; i < entriesCount; i++) {
+        const auto& indexEntry = index[i];
+        if (indexEntry.keyOffset > size || indexEntry.keyLength > size - indexEntry.keyOffset ||
+            indexEntry.dataOffset > size || indexEntry.dataLength > size - indexEntry.dataOffset) {
+            return Error("Invalid KeyValueStore index entry");
+        }
+    }
+
+    if (_snapshot.data() != nullptr) {
+        materializeSnapshot();
+    }
+
+    _snapshot = data;
+    _snapshotIndex = index;
+    _snapshotEntriesCount = entriesCount;
+
+    // Entries from the snapshot replace the ones that were already in the store
+    _totalWeight = 0;
+    if (!_entries.empty()) {
+        auto it = _entries.begin();
+        while (it != _entries.end()) {
+            if (findSnapshotEntry(it->first) != nullptr) {
+                it = _entries.erase(it);
+            } else {
+                _totalWeight += it->second.weight;
+                it++;
+            }
+        }
+    }
+    for (size_t i = 0; i < entriesCount; i++) {
+        _totalWeight += index[i].weight;
+    }
+
+    _mutationId = header->mutationIdSequence;
+    return Void();
+}
+
+Result<Void> KeyValueStore::populateLegacyArchive(const BytesView& data) {
     auto manifestParser = Parser<Byte>(nullptr, nullptr);
 
     uint64_t idSequence = 0;
@@ -263,7 +528,7 @@ Result<Void> KeyValueStore::populate(const BytesView& data) {
             }
 
             if (!isEntryExpired(entryResult.value())) {
-                _entries[entry.filePath] = entryResult.moveValue();
+                setEntry(entry.filePath, entryResult.moveValue());
             }
         }
     }
@@ -272,6 +537,152 @@ Result<Void> KeyValueStore::populate(const BytesView& data) {
     return Void();
 }
 
+const KeyValueStoreSnapshotIndexEntry* KeyValueStore::findSnapshotEntry(const StringBox& key) const {
+    if (_snapshotEntriesCount == 0) {
+        return nullptr;
+    }
+
+    auto keyView = key.toStringView();
+    const auto* begin = _snapshotIndex;
+    const auto* end = _snapshotIndex + _snapshotEntriesCount;
+    const auto* it = std::lower_bound(begin, end, keyView, [&](const auto& indexEntry, std::string_view value) {
+        return getSnapshotKey(indexEntry) < value;
+    });
+
+    if (it == end || getSnapshotKey(*it) != keyView) {
+        return nullptr;
+    }
+
+    if (!_removedSnapshotKeys.empty() && _removedSnapshotKeys.find(key) != _removedSnapshotKeys.end()) {
+        return nullptr;
+    }
+
+    return it;
+}
+
+std::string_view KeyValueStore::getSnapshotKey(const KeyValueStoreSnapshotIndexEntry& indexEntry) const {
+    return std::string_view(reinterpret_cast<const char*>(_snapshot.data() + indexEntry.keyOffset),
+                            static_cast<size_t>(indexEntry.keyLength));
+}
+
+KeyValueStoreEntry KeyValueStore::makeSnapshotEntry(const KeyValueStoreSnapshotIndexEntry& indexEntry) const {
+    return KeyValueStoreEntry(indexEntry.mutationId,
+                              indexEntry.expirationDate,
+                              indexEntry.weight,
+                              BytesView(_snapshot.getSource(),
+                                        _snapshot.data() + indexEntry.dataOffset,
+                                        static_cast<size_t>(indexEntry.dataLength)));
+}
+
+void KeyValueStore::materializeSnapshot() {
+    for (size_t i = 0; i < _snapshotEntriesCount; i++) {
+        const auto& indexEntry = _snapshotIndex[i];
+        auto key = StringCache::getGlobal().makeString(getSnapshotKey(indexEntry));
+        if (_entries.find(key) == _entries.end() && _removedSnapshotKeys.find(key) == _removedSnapshotKeys.end()) {
+            _entries[key] = makeSnapshotEntry(indexEntry);
+        }
+    }
+
+    clearSnapshot();
+}
+
+void KeyValueStore::setJournalEnabled(bool journalEnabled) {
+    _journalEnabled = journalEnabled;
+    if (!journalEnabled) {
+        _journal.clear();
+    }
+}
+
+bool KeyValueStore::hasJournal() const {
+    return _journal.size() > 0;
+}
+
+BytesView KeyValueStore::takeJournal() {
+    auto journal = makeShared<ByteBuffer>(std::move(_journal));
+    _journal = ByteBuffer();
+    return journal->toBytesView();
+}
+
+void KeyValueStore::appendJournalRecord(uint32_t type, const StringBox& key, const KeyValueStoreEntry& entry) {
+    if (!_journalEnabled) {
+        return;
+    }
+
+    auto keyView = key.toStringView();
+
+    KeyValueStoreJournalRecord record;
+    record.type = type;
+    record.keyLength = static_cast<uint32_t>(keyView.size());
+    record.mutationId = type == KeyValueStoreJournalRecordTypeStore ? entry.mutationId : _mutationId;
+    record.expirationDate = entry.expirationDate;
+    record.weight = entry.weight;
+    record.dataLength = type == KeyValueStoreJournalRecordTypeStore ? entry.data.size() : 0;
+
+    _journal.append(reinterpret_cast<const Byte*>(&record), reinterpret_cast<const Byte*>(&record) + sizeof(record));
+
+    auto payloadLength = keyView.size() + static_cast<size_t>(record.dataLength);
+    _journal.append(keyView);
+    if (record.dataLength > 0) {
+        _journal.append(entry.data.begin(), entry.data.end());
+    }
+    for (size_t i = journalPaddingForLength(payloadLength); i > 0; i--) {
+        _journal.append(static_cast<Byte>(0));
+    }
+}
+
+Result<Void> KeyValueStore::replayJournal(const BytesView& data) {
+    Parser<Byte> parser(data.begin(), data.end());
+
+    while (!parser.isAtEnd()) {
+        auto recordResult = parser.parseStruct<KeyValueStoreJournalRecord>();
+        if (!recordResult) {
+            return recordResult.moveError();
+        }
+        const auto* record = recordResult.value();
+
+        if (record->dataLength > parser.getDistanceToEnd()) {
+            return Error("Truncated journal record");
+        }
+        auto payloadLength = static_cast<size_t>(record->keyLength) + static_cast<size_t>(record->dataLength);
+        auto payloadResult = parser.parse<Byte>(payloadLength + journalPaddingForLength(payloadLength));
+        if (!payloadResult) {
+            return payloadResult.moveError();
+        }
+
+        const auto* keyBegin = payloadResult.value();
+        auto key = StringCache::getGlobal().makeString(
+            std::string_view(reinterpret_cast<const char*>(keyBegin), static_cast<size_t>(record->keyLength)));
+
+        switch (record->type) {
+            case KeyValueStoreJournalRecordTypeStore: {
+                KeyValueStoreEntry entry(record->mutationId,
+                                         record->expirationDate,
+                                         record->weight,
+                                         BytesView(data.getSource(),
+                                                   keyBegin + record->keyLength,
+                                                   static_cast<size_t>(record->dataLength)));
+                if (isEntryExpired(entry)) {
+                    eraseEntry(key);
+                } else {
+                    setEntry(key, std::move(entry));
+                }
+            } break;
+            case KeyValueStoreJournalRecordTypeRemove:
+                eraseEntry(key);
+                break;
+            case KeyValueStoreJournalRecordTypeRemoveAll:
+                clearEntries();
+                break;
+            default:
+                return Error("Invalid journal record type");
+        }
+
+        _mutationId = std::max(_mutationId, record->mutationId);
+    }
+
+    return Void();
+}
+
 uint64_t KeyValueStore::getMutationId() const {
     return _mutationId;
 }
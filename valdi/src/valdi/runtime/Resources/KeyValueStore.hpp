@@ -7,8 +7,10 @@
 
 #pragma once
 
+#include "valdi_core/cpp/Utils/ByteBuffer.hpp"
 #include "valdi_core/cpp/Utils/Bytes.hpp"
 #include "valdi_core/cpp/Utils/FlatMap.hpp"
+#include "valdi_core/cpp/Utils/FlatSet.hpp"
 #include "valdi_core/cpp/Utils/Result.hpp"
 #include "valdi_core/cpp/Utils/StringBox.hpp"
 
@@ -16,7 +18,7 @@
 
 namespace Valdi {
 
-class ByteBuffer;
+struct KeyValueStoreSnapshotIndexEntry;
 
 struct KeyValueStoreEntry {
     uint64_t mutationId;
@@ -28,12 +30,24 @@ struct KeyValueStoreEntry {
     KeyValueStoreEntry();
 };
 
+/**
+ KeyValueStore is an in-memory key value store with LRU eviction by weight, which can be
+ serialized into a snapshot. Snapshots hold an index sorted by key, which lets populate() use
+ the snapshot in place: fetches binary search the index and return views into the snapshot data,
+ which can be backed by a memory mapped file. Entries are only copied into the store when they
+ are mutated.
+ */
 class KeyValueStore {
 public:
     KeyValueStore();
     ~KeyValueStore();
 
     Result<BytesView> serialize();
+
+    /**
+     Populates the store from the given snapshot. The snapshot is retained by the store and
+     must not be modified for as long as the store uses it.
+     */
     Result<Void> populate(const BytesView& data);
 
     void store(const StringBox& key, const BytesView& blob, uint64_t ttlSeconds, uint64_t weight);
@@ -48,18 +62,73 @@ public:
     uint64_t getMaxWeight() const;
     void setMaxWeight(uint64_t maxWeight);
 
+    /**
+     Evicts the least recently used entries if the total weight of the store exceeds the max weight.
+     Evictions are recorded in the journal like any other removal.
+     */
+    void evictEntriesIfNeeded();
+
     uint64_t getMutationId() const;
 
+    /**
+     When enabled, every mutation made to the store is also recorded as a journal record.
+     Fetches are not recorded: the recency they update is only kept in memory, and is persisted
+     with the next snapshot returned by serialize().
+     The recorded records can be retrieved with takeJournal(), and applied on top of a
+     populated store with replayJournal() to restore the state the store had when they were recorded.
+     */
+    void setJournalEnabled(bool journalEnabled);
+
+    /**
+     Returns whether records were recorded since the last call to takeJournal().
+     */
+    bool hasJournal() const;
+
+    /**
+     Returns the records recorded since the last call and resets the journal.
+     */
+    BytesView takeJournal();
+
+    /**
+     Applies the records previously returned by takeJournal(). Replaying records which were already
+     applied is harmless, as the last record for a given key always decides of its state.
+     */
+    Result<Void> replayJournal(const BytesView& data);
+
     // For unit tests
     void setCurrentTimeSeconds(uint64_t timeSeconds);
 
 private:
     uint64_t _currentTimeSeconds = 0;
     uint64_t _mutationId = 0;
-    uint64_t _maxWeight;
+    uint64_t _maxWeight = 0;
+    // Sum of the weights of the entries of the store, including the ones only held by the snapshot
+    uint64_t _totalWeight = 0;
+    // Entries which were mutated since the snapshot was populated, they take precedence over the snapshot
     FlatMap<StringBox, KeyValueStoreEntry> _entries;
+    // Keys of the snapshot which were removed
+    FlatSet<StringBox> _removedSnapshotKeys;
+    BytesView _snapshot;
+    const KeyValueStoreSnapshotIndexEntry* _snapshotIndex = nullptr;
+    size_t _snapshotEntriesCount = 0;
+    ByteBuffer _journal;
+    bool _journalEnabled = false;
+
+    Result<Void> populateSnapshot(const BytesView& data);
+    Result<Void> populateLegacyArchive(const BytesView& data);
+
+    const KeyValueStoreSnapshotIndexEntry* findSnapshotEntry(const StringBox& key) const;
+    std::string_view getSnapshotKey(const KeyValueStoreSnapshotIndexEntry& indexEntry) const;
+    KeyValueStoreEntry makeSnapshotEntry(const KeyValueStoreSnapshotIndexEntry& indexEntry) const;
+    void materializeSnapshot();
+    void clearSnapshot();
+
+    uint64_t getEntryWeight(const StringBox& key) const;
+    void setEntry(const StringBox& key, KeyValueStoreEntry&& entry);
+    void eraseEntry(const StringBox& key);
+    void removeExpiredEntry(const StringBox& key);
+    void clearEntries();
 
-    void buildManifest(const std::vector<std::pair<StringBox, KeyValueStoreEntry>>& entries, ByteBuffer& output) const;
     std::vector<std::pair<StringBox, KeyValueStoreEntry>> collectEntries();
     void evictEntriesIfNeeded(std::vector<std::pair<StringBox, KeyValueStoreEntry>>& collectedEntries);
 
@@ -68,6 +137,8 @@ private:
     uint64_t currentTimeSeconds() const;
 
     std::optional<BytesView> fetch(const StringBox& key, bool updateSequence);
+
+    void appendJournalRecord(uint32_t type, const StringBox& key, const KeyValueStoreEntry& entry);
 };
 
 } // namespace Valdi
@@ -50,7 +50,7 @@ Result<Value> ModuleBundleResultTransformer::transform(const StringBox& /*localF
     if (_decompressionDisabled) {
         decompressedBundleResult = ValdiModuleArchive::deserialize(data);
     } else {
-        decompressedBundleResult = ValdiModuleArchive::decompress(data.data(), data.size());
+        decompressedBundleResult = ValdiModuleArchive::decompress(data);
     }
 
     if (!decompressedBundleResult) {
@@ -87,7 +87,7 @@ Result<BytesView> ResourcesBundleResultTransformer::preprocess(const StringBox&
     if (_decompressionDisabled) {
         decompressedBundleResult = ValdiModuleArchive::deserialize(remoteData);
     } else {
-        decompressedBundleResult = ValdiModuleArchive::decompress(remoteData.data(), remoteData.size());
+        decompressedBundleResult = ValdiModuleArchive::decompress(remoteData);
     }
 
     if (!decompressedBundleResult) {
@@ -103,14 +103,14 @@ Result<BytesView> ResourcesBundleResultTransformer::preprocess(const StringBox&
     cacheDirectoryPath.appendFileExtension("dir");
 
     for (const auto& path : decompressedBundle->getAllEntryPaths()) {
-        auto entry = decompressedBundle->getEntry(path);
-        SC_ASSERT(entry.has_value(), "Unable to retrieve module entry");
-
-        auto bytesView = BytesView(decompressedBundle, entry->data, entry->size);
+        auto bytesView = decompressedBundle->getEntryBytes(path);
+        if (!bytesView) {
+            return bytesView.moveError();
+        }
 
         auto cachePath = cacheDirectoryPath.appending(path.toStringView());
 
-        auto storeSuccess = _diskCache->store(cachePath, bytesView);
+        auto storeSuccess = _diskCache->store(cachePath, bytesView.value());
         if (!storeSuccess) {
             return storeSuccess.error().rethrow(
                 STRING_FORMAT("Failed to store resource item '{}' in disk cache", path));
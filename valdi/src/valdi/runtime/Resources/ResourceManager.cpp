@@ -14,6 +14,7 @@
 #include "valdi/runtime/Resources/Remote/RemoteModulePrefetchTask.hpp"
 #include "valdi/runtime/Resources/Remote/RemoteModuleResources.hpp"
 #include "valdi/runtime/Resources/ValdiModuleArchive.hpp"
+#include "valdi/runtime/Resources/ZStdUtils.hpp"
 #include "valdi_core/cpp/Resources/ValdiArchive.hpp"
 
 #include "valdi_core/cpp/Constants.hpp"
@@ -26,6 +27,7 @@
 
 #include "valdi/runtime/Utils/BytesUtils.hpp"
 #include "valdi_core/cpp/Threading/DispatchQueue.hpp"
+#include "valdi_core/cpp/Threading/WorkStealingExecutor.hpp"
 
 #include "utils/time/StopWatch.hpp"
 #include "valdi_core/cpp/Context/ComponentPath.hpp"
@@ -41,6 +43,7 @@
 #include "valdi_core/cpp/Utils/ValueMap.hpp"
 #include "valdi_core/cpp/Utils/ValueUtils.hpp"
 
+#include <algorithm>
 #include <chrono>
 #include <cstdint>
 #include <fmt/format.h>
@@ -50,6 +53,10 @@
 
 namespace Valdi {
 
+// Maximum number of module archives that are loaded and decompressed at the same time when
+// warming up or preloading several bundles.
+constexpr size_t kMaxConcurrentBundleLoads = 4;
+
 ResourceManager::ResourceManager(const Shared<IResourceLoader>& resourceLoader,
                                  const Ref<IDiskCache>& diskCache,
                                  const Ref<AssetLoaderManager>& assetLoaderManager,
@@ -112,6 +119,21 @@ int32_t ResourceManager::getApiVersion() {
     return _apiVersion.value();
 }
 
+void ResourceManager::registerBundledModuleArchiveDictionary() {
+    auto content = _resourceLoader->loadModuleContent(STRING_LITERAL("valdi_module_archive_dictionary"));
+    if (!content) {
+        return;
+    }
+
+    auto dictionary = ZStdUtils::loadDictionary(content.value().data(), content.value().size());
+    if (!dictionary) {
+        VALDI_ERROR(_logger, "Unable to load module archive dictionary: {}", dictionary.error());
+        return;
+    }
+
+    ZStdUtils::registerDictionary(dictionary.value());
+}
+
 Result<Ref<ValdiModuleArchive>> ResourceManager::getArchiveForModule(const StringBox& modulePath,
                                                                      bool useMmap,
                                                                      const Path& mmapCacheDir,
@@ -136,8 +158,11 @@ Result<Ref<ValdiModuleArchive>> ResourceManager::getArchiveForModule(const Strin
     // _mutex and then a Bundle mutex, so taking _mutex here inverts that order and can deadlock.
     // The mmap/metrics settings are snapshotted by getBundle under _mutex and passed in.
 
+    std::call_once(_moduleArchiveDictionaryOnce, [this]() { registerBundledModuleArchiveDictionary(); });
+
     bool usedMmap = false;
     bool mmapPublishFailed = false;
+    VALDI_TRACE_META("Valdi.decompressModuleArchive", modulePath);
     MetricsStopWatch decompressStopWatch;
     Result<ValdiModuleArchive> result = [&]() {
         if (useMmap) {
@@ -151,9 +176,9 @@ Result<Ref<ValdiModuleArchive>> ResourceManager::getArchiveForModule(const Strin
             auto flatName =
                 BytesUtils::sha256String(reinterpret_cast<const Byte*>(modulePathView.data()), modulePathView.size());
             auto mmapPath = mmapCacheDir.appending(std::string_view(flatName));
-            return ValdiModuleArchive::decompress(data.data(), data.size(), mmapPath, &usedMmap, &mmapPublishFailed);
+            return ValdiModuleArchive::decompress(data, mmapPath, &usedMmap, &mmapPublishFailed);
         }
-        return ValdiModuleArchive::decompress(data.data(), data.size());
+        return ValdiModuleArchive::decompress(data);
     }();
     auto decompressDuration = decompressStopWatch.elapsed();
 
@@ -161,7 +186,9 @@ Result<Ref<ValdiModuleArchive>> ResourceManager::getArchiveForModule(const Strin
     // Failures don't get a path counter — they wouldn't tell us anything useful
     // about realized mmap rate.
     if (result && metrics != nullptr) {
-        if (useMmap) {
+        if (result.value().isSeekable()) {
+            metrics->emitModuleArchiveSeekable(modulePath);
+        } else if (useMmap) {
             if (usedMmap) {
                 metrics->emitModuleArchiveMmapSuccess(modulePath);
                 // Emitted alongside Mmap_Success when the rename-into-cache step
@@ -200,11 +227,15 @@ void ResourceManager::initializeBundle(BundleInitializer& bundleInitializer, Ref
 
     if (moduleArchive->containsEntry(kDownloadManifestName)) {
         // This is a downlodable module
-        auto entry = moduleArchive->getEntry(kDownloadManifestName);
-        SC_ASSERT(entry.has_value(), "Unable to retrieve module entry");
+        auto entry = moduleArchive->getEntryBytes(kDownloadManifestName);
+        if (!entry) {
+            VALDI_ERROR(_logger, "Unable to read download manifest in module '{}': {}", bundleName, entry.error());
+            initializeBundle(bundleInitializer, makeShared<ValdiModuleArchive>());
+            return;
+        }
         auto manifest = makeShared<DownloadableModuleManifestWrapper>();
 
-        if (!manifest->pb.ParseFromArray(entry->data, static_cast<int>(entry->size))) {
+        if (!manifest->pb.ParseFromArray(entry.value().data(), static_cast<int>(entry.value().size()))) {
             VALDI_ERROR(_logger, "Invalid download manifest in module '{}'", bundleName);
             initializeBundle(bundleInitializer, makeShared<ValdiModuleArchive>());
             return;
@@ -265,7 +296,7 @@ void ResourceManager::insertImageAssetInBundle(const Ref<Bundle>& bundle,
 
 void ResourceManager::insertAssetPackageInBundle(const Ref<Bundle>& bundle, const BytesView& assetPackageData) {
     _workerQueue->async([self = strongSmallRef(this), bundle, assetPackageData]() {
-        auto result = ValdiModuleArchive::decompress(assetPackageData.data(), assetPackageData.size());
+        auto result = ValdiModuleArchive::decompress(assetPackageData);
         if (!result) {
             VALDI_ERROR(self->_logger,
                         "Failed to decompress asset bundle in bundle '{}': {}",
@@ -287,9 +318,17 @@ void ResourceManager::insertAssetPackageInBundle(const Ref<Bundle>& bundle, cons
             return;
         }
 
-        auto assetsEntry = assetPackage.getEntryForIndex(bestIndex.value());
+        auto assetsEntry = assetPackage.getEntryBytesForIndex(bestIndex.value());
+        if (!assetsEntry) {
+            VALDI_ERROR(self->_logger,
+                        "Failed to load archive of asset bundle '{}' at index '{}': {}",
+                        bundle->getName(),
+                        bestIndex.value(),
+                        assetsEntry.error());
+            return;
+        }
 
-        ValdiArchive archive(assetsEntry.data, assetsEntry.data + assetsEntry.size);
+        ValdiArchive archive(assetsEntry.value().begin(), assetsEntry.value().end());
         auto allFiles = archive.getEntries();
         if (!allFiles) {
             VALDI_ERROR(self->_logger,
@@ -301,7 +340,7 @@ void ResourceManager::insertAssetPackageInBundle(const Ref<Bundle>& bundle, cons
         }
 
         for (const auto& asset : allFiles.value()) {
-            auto bytes = BytesView(result.value().getDecompressedContent().getSource(), asset.data, asset.dataLength);
+            auto bytes = BytesView(assetsEntry.value().getSource(), asset.data, asset.dataLength);
             self->doInsertImageAssetInBundle(bundle, asset.filePath, bytes);
         }
     });
@@ -388,8 +427,12 @@ Ref<Bundle> ResourceManager::getBundle(const StringBox& bundleName) {
     populateSourceMap(bundleName, *bundleInitializer.getBundle());
 
     if (hasAssetPackage) {
-        insertAssetPackageInBundle(bundleInitializer.getBundle(),
-                                   bundleInitializer.getBundle()->getEntry(assetPackageKey).value());
+        auto assetPackage = bundleInitializer.getBundle()->getEntry(assetPackageKey);
+        if (assetPackage) {
+            insertAssetPackageInBundle(bundleInitializer.getBundle(), assetPackage.value());
+        } else {
+            VALDI_ERROR(_logger, "Unable to read asset package in module '{}': {}", bundleName, assetPackage.error());
+        }
     }
 
     if (Valdi::traceLoadModules) {
@@ -488,9 +531,7 @@ void ResourceManager::preloadForComponentPath(const ComponentPath& componentPath
         }
 
         // Load each modules
-        for (const auto& moduleName : strategy->valdiModules) {
-            self->getBundle(moduleName);
-        }
+        self->loadBundlesConcurrently(strategy->valdiModules);
     });
 }
 
@@ -510,12 +551,22 @@ void ResourceManager::warmUpBundles(const std::vector<StringBox>& modulePaths) {
 
     _workerQueue->async([self = strongSmallRef(this), bundles = std::move(bundles)]() {
         VALDI_TRACE("Valdi.warmUpBundles");
-        for (const auto& bundleName : bundles) {
-            self->getBundle(bundleName);
-        }
+        self->loadBundlesConcurrently(bundles);
     });
 }
 
+void ResourceManager::loadBundlesConcurrently(const std::vector<StringBox>& bundleNames) {
+    // Bundles are claimed in the given order, so that the bundles which are needed first by the
+    // JS evaluation start loading first. A require() on a bundle that is still being loaded by
+    // another thread waits on the Bundle's lock, which keeps the evaluation order intact.
+    // The calling thread loads bundles as well, which lets this complete even when the workers
+    // of the executor are all busy.
+    WorkStealingExecutor::getShared()->parallelFor(
+        bundleNames.size(), kMaxConcurrentBundleLoads, ThreadQoSClassNormal, [&](size_t index) {
+            getBundle(bundleNames[index]);
+        });
+}
+
 void ResourceManager::loadModuleAsync(const StringBox& bundleName,
                                       ResourceManagerLoadModuleType loadType,
                                       Function<void(Result<Void>)> onComplete) {
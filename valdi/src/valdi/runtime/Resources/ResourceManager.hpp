@@ -137,6 +137,7 @@ private:
     bool _inlineAssetsEnabled = true;
     bool _hotReloaderEnabled;
     std::optional<int32_t> _apiVersion;
+    std::once_flag _moduleArchiveDictionaryOnce;
     std::atomic_bool _lazyModulePreloadingEnabled = true;
     Path _mmapCacheDirectory;
 
@@ -154,10 +155,17 @@ private:
                                                                       bool useMmap,
                                                                       const Path& mmapCacheDir,
                                                                       const Ref<Metrics>& metrics);
+    // Registers the ZStd dictionary shipped with the app, which seekable module archives can be
+    // compressed with without embedding it.
+    void registerBundledModuleArchiveDictionary();
     void initializeBundle(BundleInitializer& bundleInitializer, Ref<ValdiModuleArchive> moduleArchive);
 
     BundleInitializer registerBundle(const StringBox& bundleName);
 
+    // Loads the given bundles using a bounded number of threads, in the given order, and returns
+    // once all of them are loaded.
+    void loadBundlesConcurrently(const std::vector<StringBox>& bundleNames);
+
     Ref<Bundle> lockFreeGetBundle(const StringBox& bundleName, std::unique_lock<Mutex>& lock);
 
     void populateSourceMap(const StringBox& bundleName, Bundle& bundle);
@@ -11,38 +11,204 @@
 #include "valdi_core/cpp/Resources/ValdiArchive.hpp"
 
 #include "valdi_core/cpp/Utils/DiskUtils.hpp"
+#include "valdi_core/cpp/Utils/Mutex.hpp"
 #include "valdi_core/cpp/Utils/Parser.hpp"
 #include "valdi_core/cpp/Utils/Shared.hpp"
 #include "valdi_core/cpp/Utils/StringCache.hpp"
 
+#include <cstring>
 #include <fmt/format.h>
 #include <fmt/ostream.h>
 #include <iostream>
+#include <memory>
 
 namespace Valdi {
 
+// Seekable archives start with the Valdi packet magic, with the last byte bumped to 0x02
+static constexpr uint32_t kSeekableArchiveMagic = 0x0200C633;
+static constexpr uint32_t kSeekableArchiveFlagEmbeddedDictionary = 1;
+static constexpr uint32_t kSeekableArchiveEntryFlagCompressed = 1;
+
+struct SeekableArchiveHeader {
+    uint32_t magic;
+    uint32_t flags;
+    uint32_t entriesCount;
+    uint32_t pathsLength;
+};
+
+/**
+ * Follows the header when the archive embeds the ZStd dictionary its entries were compressed with.
+ */
+struct SeekableArchiveDictionary {
+    uint64_t offset;
+    uint64_t length;
+};
+
+/**
+ * Describes one entry of a seekable archive. The index is followed by the paths of all the
+ * entries, then by the data of the entries. Offsets are relative to the start of the archive.
+ */
+struct SeekableArchiveIndexEntry {
+    uint64_t dataOffset;
+    uint64_t dataLength;
+    uint64_t size;
+    uint32_t pathOffset;
+    uint32_t pathLength;
+    uint32_t flags;
+    uint32_t reserved;
+};
+
+static_assert(sizeof(SeekableArchiveHeader) == 16);
+static_assert(sizeof(SeekableArchiveDictionary) == 16);
+static_assert(sizeof(SeekableArchiveIndexEntry) == 40);
+
+/**
+ * Holds the frames of a seekable archive, along with the entries which were decompressed so far.
+ * The dictionary is digested once for the archive, and a decompression context is kept for
+ * the next entry until all the compressed entries were decompressed.
+ */
+class ValdiModuleArchiveFrames : public SimpleRefCountable {
+public:
+    ValdiModuleArchiveFrames(BytesView content,
+                             std::vector<SeekableArchiveIndexEntry> index,
+                             Ref<ZStdDictionary> dictionary)
+        : _content(std::move(content)),
+          _index(std::move(index)),
+          _dictionary(std::move(dictionary)),
+          _decompressedEntries(_index.size()) {
+        for (const auto& entry : _index) {
+            if ((entry.flags & kSeekableArchiveEntryFlagCompressed) != 0) {
+                _remainingCompressedEntries++;
+            }
+        }
+    }
+
+    ~ValdiModuleArchiveFrames() override = default;
+
+    Result<BytesView> getEntry(size_t index) {
+        const auto& frame = _index[index];
+        const auto* frameData = _content.data() + frame.dataOffset;
+
+        if ((frame.flags & kSeekableArchiveEntryFlagCompressed) == 0) {
+            return BytesView(_content.getSource(), frameData, static_cast<size_t>(frame.size));
+        }
+
+        std::unique_ptr<ZStdDecompressionContext> context;
+        {
+            std::lock_guard<Mutex> lock(_mutex);
+            const auto& decompressedEntry = _decompressedEntries[index];
+            if (decompressedEntry != nullptr) {
+                return decompressedEntry->toBytesView();
+            }
+            context = std::move(_idleContext);
+        }
+
+        if (context == nullptr) {
+            context = std::make_unique<ZStdDecompressionContext>();
+        }
+
+        // Decompressing outside of the lock lets different entries be decompressed in parallel.
+        // If two threads race on the same entry, the first one to finish wins.
+        auto decompressed = ZStdUtils::decompressFrame(frameData,
+                                                       static_cast<size_t>(frame.dataLength),
+                                                       static_cast<size_t>(frame.size),
+                                                       _dictionary,
+                                                       context.get());
+
+        std::lock_guard<Mutex> lock(_mutex);
+        auto& decompressedEntry = _decompressedEntries[index];
+        if (decompressed && decompressedEntry == nullptr) {
+            decompressedEntry = decompressed.moveValue();
+            _remainingCompressedEntries--;
+        }
+
+        // The context is released with the last compressed entry, as it won't be needed anymore
+        if (_idleContext == nullptr && _remainingCompressedEntries > 0) {
+            _idleContext = std::move(context);
+        }
+
+        if (!decompressed && decompressedEntry == nullptr) {
+            return decompressed.moveError();
+        }
+
+        return decompressedEntry->toBytesView();
+    }
+
+private:
+    BytesView _content;
+    std::vector<SeekableArchiveIndexEntry> _index;
+    Ref<ZStdDictionary> _dictionary;
+    Mutex _mutex;
+    std::vector<Ref<ByteBuffer>> _decompressedEntries;
+    std::unique_ptr<ZStdDecompressionContext> _idleContext;
+    size_t _remainingCompressedEntries = 0;
+};
+
 ValdiModuleArchive::ValdiModuleArchive() = default;
+ValdiModuleArchive::ValdiModuleArchive(const ValdiModuleArchive& other) = default;
+ValdiModuleArchive::ValdiModuleArchive(ValdiModuleArchive&& other) noexcept = default;
 
 ValdiModuleArchive::ValdiModuleArchive(BytesView decompressedContent,
-                                       FlatMap<StringBox, ValdiModuleArchiveEntry> entries,
-                                       std::vector<StringBox> orderedEntryPaths)
+                                       FlatMap<StringBox, size_t> entryIndexByPath,
+                                       std::vector<StringBox> orderedEntryPaths,
+                                       std::vector<ValdiModuleArchiveEntry> entries,
+                                       Ref<ValdiModuleArchiveFrames> frames)
     : _decompressedContent(std::move(decompressedContent)),
+      _entryIndexByPath(std::move(entryIndexByPath)),
+      _orderedEntryPaths(std::move(orderedEntryPaths)),
       _entries(std::move(entries)),
-      _orderedEntryPaths(std::move(orderedEntryPaths)) {}
+      _frames(std::move(frames)) {}
 
 ValdiModuleArchive::~ValdiModuleArchive() = default;
 
+ValdiModuleArchive& ValdiModuleArchive::operator=(const ValdiModuleArchive& other) = default;
+ValdiModuleArchive& ValdiModuleArchive::operator=(ValdiModuleArchive&& other) noexcept = default;
+
 bool ValdiModuleArchive::containsEntry(const Valdi::StringBox& path) const {
-    return _entries.find(path) != _entries.end();
+    return _entryIndexByPath.find(path) != _entryIndexByPath.end();
 }
 
 std::optional<ValdiModuleArchiveEntry> ValdiModuleArchive::getEntry(const Valdi::StringBox& path) const {
-    const auto& it = _entries.find(path);
-    if (it == _entries.end()) {
+    const auto& it = _entryIndexByPath.find(path);
+    if (it == _entryIndexByPath.end()) {
+        return std::nullopt;
+    }
+
+    if (_frames == nullptr) {
+        return {_entries[it->second]};
+    }
+
+    auto bytes = _frames->getEntry(it->second);
+    if (!bytes) {
         return std::nullopt;
     }
 
-    return {it->second};
+    return {(ValdiModuleArchiveEntry){.data = bytes.value().data(), .size = bytes.value().size()}};
+}
+
+Result<BytesView> ValdiModuleArchive::getEntryBytes(const Valdi::StringBox& path) const {
+    const auto& it = _entryIndexByPath.find(path);
+    if (it == _entryIndexByPath.end()) {
+        return Error(STRING_FORMAT("No entry named '{}' in archive", path));
+    }
+
+    return getEntryBytesForIndex(it->second);
+}
+
+Result<BytesView> ValdiModuleArchive::getEntryBytesForIndex(size_t index) const {
+    SC_ASSERT(index < _orderedEntryPaths.size());
+
+    if (_frames == nullptr) {
+        const auto& entry = _entries[index];
+        return BytesView(_decompressedContent.getSource(), entry.data, entry.size);
+    }
+
+    auto bytes = _frames->getEntry(index);
+    if (!bytes) {
+        return bytes.error().rethrow(STRING_FORMAT("Failed to decompress entry '{}'", _orderedEntryPaths[index]));
+    }
+
+    return bytes;
 }
 
 const std::vector<StringBox>& ValdiModuleArchive::getAllEntryPaths() const {
@@ -51,9 +217,13 @@ const std::vector<StringBox>& ValdiModuleArchive::getAllEntryPaths() const {
 
 ValdiModuleArchiveEntry ValdiModuleArchive::getEntryForIndex(size_t index) const {
     SC_ASSERT(index < _orderedEntryPaths.size());
-    auto entry = getEntry(_orderedEntryPaths[index]);
-    SC_ASSERT(entry);
-    return entry.value();
+    if (_frames == nullptr) {
+        return _entries[index];
+    }
+
+    auto bytes = _frames->getEntry(index);
+    SC_ASSERT(bytes, bytes.description());
+    return (ValdiModuleArchiveEntry){.data = bytes.value().data(), .size = bytes.value().size()};
 }
 
 bool ValdiModuleArchive::operator==(const ValdiModuleArchive& other) const {
@@ -68,8 +238,33 @@ const BytesView& ValdiModuleArchive::getDecompressedContent() const {
     return _decompressedContent;
 }
 
+bool ValdiModuleArchive::isSeekable() const {
+    return _frames != nullptr;
+}
+
+bool ValdiModuleArchive::isSeekableArchive(const Byte* data, size_t len) {
+    if (len < sizeof(uint32_t)) {
+        return false;
+    }
+    uint32_t magic;
+    std::memcpy(&magic, data, sizeof(uint32_t));
+    return magic == kSeekableArchiveMagic;
+}
+
+Result<ValdiModuleArchive> ValdiModuleArchive::decompress(const BytesView& data) {
+    if (isSeekableArchive(data.data(), data.size())) {
+        return ValdiModuleArchive::deserializeSeekable(data);
+    }
+
+    return ValdiModuleArchive::decompress(data.data(), data.size());
+}
+
 Result<ValdiModuleArchive> ValdiModuleArchive::decompress(const Byte* data, size_t len) {
-    if (ZStdUtils::isZstdFile(data, len)) {
+    if (isSeekableArchive(data, len)) {
+        // Entries are decompressed lazily from the archive, which needs to outlive the caller's buffer
+        auto copy = makeShared<ByteBuffer>(data, data + len);
+        return ValdiModuleArchive::deserializeSeekable(copy->toBytesView());
+    } else if (ZStdUtils::isZstdFile(data, len)) {
         auto decompressed = ZStdUtils::decompress(data, len);
         if (!decompressed) {
             return decompressed.moveError();
@@ -81,6 +276,20 @@ Result<ValdiModuleArchive> ValdiModuleArchive::decompress(const Byte* data, size
     }
 }
 
+Result<ValdiModuleArchive> ValdiModuleArchive::decompress(const BytesView& data,
+                                                          const Path& mmapFilePath,
+                                                          bool* outUsedMmap,
+                                                          bool* outMmapPublishFailed) {
+    if (isSeekableArchive(data.data(), data.size())) {
+        if (outUsedMmap != nullptr) {
+            *outUsedMmap = false;
+        }
+        return ValdiModuleArchive::deserializeSeekable(data);
+    }
+
+    return ValdiModuleArchive::decompress(data.data(), data.size(), mmapFilePath, outUsedMmap, outMmapPublishFailed);
+}
+
 // Future optimization: reuse cached mmap files across launches.
 // The compiler can append a ZStd skippable frame (magic 0x184D2A50, 8-byte header + 32-byte
 // SHA-256) to the end of each .valdimodule file. The runtime reads the last 40 bytes to extract
@@ -90,15 +299,14 @@ Result<ValdiModuleArchive> ValdiModuleArchive::decompress(const Byte* data, size
 Result<ValdiModuleArchive> ValdiModuleArchive::decompress(
     const Byte* data, size_t len, const Path& mmapFilePath, bool* outUsedMmap, bool* outMmapPublishFailed) {
     if (!ZStdUtils::isZstdFile(data, len)) {
-        // Plain (uncompressed) archives don't touch either decompress backend.
+        // Plain (uncompressed) and seekable archives don't touch either decompress backend.
         // Treat as "heap" for the purposes of the mmap A/B since no mmap region
         // is created.
         if (outUsedMmap != nullptr) {
             *outUsedMmap = false;
         }
-        return ValdiModuleArchive::deserialize(BytesView(nullptr, data, len));
+        return ValdiModuleArchive::decompress(data, len);
     }
-
     auto parentDir = mmapFilePath.removingLastComponent();
     DiskUtils::makeDirectory(parentDir, true);
 
@@ -122,23 +330,117 @@ Result<ValdiModuleArchive> ValdiModuleArchive::decompress(
 }
 
 Result<ValdiModuleArchive> ValdiModuleArchive::deserialize(BytesView decompressedContent) {
+    // Seekable archives are never compressed as a whole, so they can be given here
+    // by callers which disabled decompression.
+    if (isSeekableArchive(decompressedContent.data(), decompressedContent.size())) {
+        return ValdiModuleArchive::deserializeSeekable(std::move(decompressedContent));
+    }
+
     auto module = ValdiArchive(decompressedContent.data(), decompressedContent.data() + decompressedContent.size());
 
-    FlatMap<StringBox, ValdiModuleArchiveEntry> entries;
+    FlatMap<StringBox, size_t> entryIndexByPath;
     std::vector<StringBox> orderedEntryPaths;
+    std::vector<ValdiModuleArchiveEntry> entries;
 
     auto allEntries = module.getEntries();
     if (!allEntries) {
         return allEntries.moveError();
     }
 
+    entries.reserve(allEntries.value().size());
+    orderedEntryPaths.reserve(allEntries.value().size());
+
     for (const auto& moduleEntry : allEntries.value()) {
-        entries[moduleEntry.filePath] =
-            (ValdiModuleArchiveEntry){.data = moduleEntry.data, .size = moduleEntry.dataLength};
+        entryIndexByPath[moduleEntry.filePath] = entries.size();
+        entries.emplace_back((ValdiModuleArchiveEntry){.data = moduleEntry.data, .size = moduleEntry.dataLength});
         orderedEntryPaths.emplace_back(moduleEntry.filePath);
     }
 
-    return ValdiModuleArchive(std::move(decompressedContent), std::move(entries), std::move(orderedEntryPaths));
+    return ValdiModuleArchive(std::move(decompressedContent),
+                              std::move(entryIndexByPath),
+                              std::move(orderedEntryPaths),
+                              std::move(entries),
+                              nullptr);
+}
+
+Result<ValdiModuleArchive> ValdiModuleArchive::deserializeSeekable(BytesView content) {
+    auto contentSize = static_cast<uint64_t>(content.size());
+
+    SeekableArchiveHeader header;
+    if (contentSize < sizeof(SeekableArchiveHeader)) {
+        return Error("Seekable archive is too small to contain its header");
+    }
+    std::memcpy(&header, content.data(), sizeof(SeekableArchiveHeader));
+
+    if (header.magic != kSeekableArchiveMagic) {
+        return Error("Invalid seekable archive magic");
+    }
+    if ((header.flags & ~kSeekableArchiveFlagEmbeddedDictionary) != 0) {
+        return Error(STRING_FORMAT("Unsupported seekable archive flags {}", header.flags));
+    }
+
+    auto indexOffset = static_cast<uint64_t>(sizeof(SeekableArchiveHeader));
+
+    Ref<ZStdDictionary> dictionary;
+    if ((header.flags & kSeekableArchiveFlagEmbeddedDictionary) != 0) {
+        SeekableArchiveDictionary dictionaryLocation;
+        if (contentSize < indexOffset + sizeof(SeekableArchiveDictionary)) {
+            return Error("Seekable archive is too small to contain its dictionary location");
+        }
+        std::memcpy(&dictionaryLocation, content.data() + indexOffset, sizeof(SeekableArchiveDictionary));
+        indexOffset += sizeof(SeekableArchiveDictionary);
+
+        if (dictionaryLocation.offset > contentSize ||
+            dictionaryLocation.length > contentSize - dictionaryLocation.offset) {
+            return Error("Seekable archive dictionary is out of bounds");
+        }
+
+        auto dictionaryResult = ZStdUtils::loadDictionary(content.data() + dictionaryLocation.offset,
+                                                          static_cast<size_t>(dictionaryLocation.length));
+        if (!dictionaryResult) {
+            return dictionaryResult.error().rethrow("Failed to load seekable archive dictionary");
+        }
+        dictionary = dictionaryResult.moveValue();
+    }
+
+    auto pathsOffset =
+        indexOffset + static_cast<uint64_t>(header.entriesCount) * sizeof(SeekableArchiveIndexEntry);
+    if (pathsOffset + header.pathsLength > contentSize) {
+        return Error("Seekable archive index is out of bounds");
+    }
+
+    std::vector<SeekableArchiveIndexEntry> index(header.entriesCount);
+    std::memcpy(index.data(), content.data() + indexOffset, index.size() * sizeof(SeekableArchiveIndexEntry));
+
+    const auto* paths = reinterpret_cast<const char*>(content.data() + pathsOffset);
+
+    FlatMap<StringBox, size_t> entryIndexByPath;
+    std::vector<StringBox> orderedEntryPaths;
+    orderedEntryPaths.reserve(index.size());
+
+    for (const auto& entry : index) {
+        if (static_cast<uint64_t>(entry.pathOffset) + entry.pathLength > header.pathsLength) {
+            return Error("Seekable archive entry path is out of bounds");
+        }
+        if (entry.dataOffset > contentSize || entry.dataLength > contentSize - entry.dataOffset) {
+            return Error("Seekable archive entry data is out of bounds");
+        }
+        if ((entry.flags & kSeekableArchiveEntryFlagCompressed) == 0 && entry.dataLength != entry.size) {
+            return Error("Seekable archive uncompressed entry has an inconsistent size");
+        }
+
+        auto path = StringCache::getGlobal().makeString(std::string_view(paths + entry.pathOffset, entry.pathLength));
+        entryIndexByPath[path] = orderedEntryPaths.size();
+        orderedEntryPaths.emplace_back(std::move(path));
+    }
+
+    auto frames = makeShared<ValdiModuleArchiveFrames>(content, std::move(index), std::move(dictionary));
+
+    return ValdiModuleArchive(std::move(content),
+                              std::move(entryIndexByPath),
+                              std::move(orderedEntryPaths),
+                              {},
+                              std::move(frames));
 }
 
 } // namespace Valdi
@@ -21,20 +21,69 @@ struct ValdiModuleArchiveEntry {
     size_t size;
 };
 
+class ValdiModuleArchiveFrames;
+
+/**
+ * A ValdiModuleArchive holds the files of a .valdimodule. Two formats are supported:
+ * - The legacy format, a ValdiArchive optionally compressed as a whole in a single zstd frame,
+ *   which is decompressed entirely when the archive is opened.
+ * - The seekable format, which starts with an index of the entries followed by the entries
+ *   themselves, each one stored in its own zstd frame or left uncompressed. Only the index is
+ *   read when the archive is opened, entries are decompressed the first time they are requested.
+ *   Frames can be compressed with a trained dictionary, which is either embedded once in the
+ *   archive or shipped with the app and registered through ZStdUtils::registerDictionary().
+ */
 class ValdiModuleArchive : public SharedPtrRefCountable {
 public:
     ValdiModuleArchive();
+    ValdiModuleArchive(const ValdiModuleArchive& other);
+    ValdiModuleArchive(ValdiModuleArchive&& other) noexcept;
     ~ValdiModuleArchive() override;
 
+    ValdiModuleArchive& operator=(const ValdiModuleArchive& other);
+    ValdiModuleArchive& operator=(ValdiModuleArchive&& other) noexcept;
+
+    /**
+     * Returns the entry at the given path. The returned pointer remains valid for as long
+     * as the archive is alive. Returns std::nullopt if the entry does not exist or, for seekable
+     * archives, if its frame could not be decompressed. Use getEntryBytes() to get the error.
+     */
     std::optional<ValdiModuleArchiveEntry> getEntry(const Valdi::StringBox& path) const;
     ValdiModuleArchiveEntry getEntryForIndex(size_t index) const;
 
+    /**
+     * Returns the entry at the given path as a BytesView which retains its backing storage,
+     * decompressing it if needed. Thread-safe.
+     */
+    Result<BytesView> getEntryBytes(const Valdi::StringBox& path) const;
+    Result<BytesView> getEntryBytesForIndex(size_t index) const;
+
     bool containsEntry(const Valdi::StringBox& path) const;
 
     const std::vector<StringBox>& getAllEntryPaths() const;
 
+    /**
+     * Returns the decompressed ValdiArchive for archives in the legacy format, or the archive
+     * as it was given for seekable archives, whose entries are decompressed separately.
+     */
     const BytesView& getDecompressedContent() const;
 
+    /**
+     * Returns whether the archive uses the seekable format.
+     */
+    bool isSeekable() const;
+
+    /**
+     * Returns whether the given data starts with the header of a seekable archive.
+     */
+    static bool isSeekableArchive(const Byte* data, size_t len);
+
+    /**
+     * Opens the given archive. Seekable archives are opened without being copied, and keep
+     * the source of the given BytesView alive, as their entries are decompressed lazily.
+     * The overload taking a raw pointer copies seekable archives, since it cannot retain them.
+     */
+    [[nodiscard]] static Result<ValdiModuleArchive> decompress(const BytesView& data);
     [[nodiscard]] static Result<ValdiModuleArchive> decompress(const Byte* data, size_t len);
 
     /**
@@ -49,13 +98,24 @@ public:
      * If outMmapPublishFailed is non-null, it is set to true iff the mmap path
      * succeeded in-memory but failed to publish the cache file to disk (the
      * returned archive is still valid). Untouched on the heap path or on error.
+     *
+     * Seekable archives are never decompressed as a whole, so they do not use the mmap
+     * path and outUsedMmap is set to false.
      */
+    [[nodiscard]] static Result<ValdiModuleArchive> decompress(const BytesView& data,
+                                                               const Path& mmapFilePath,
+                                                               bool* outUsedMmap = nullptr,
+                                                               bool* outMmapPublishFailed = nullptr);
     [[nodiscard]] static Result<ValdiModuleArchive> decompress(const Byte* data,
                                                                size_t len,
                                                                const Path& mmapFilePath,
                                                                bool* outUsedMmap = nullptr,
                                                                bool* outMmapPublishFailed = nullptr);
 
+    /**
+     * Opens an archive which is not compressed as a whole, either a decompressed archive
+     * in the legacy format or a seekable archive.
+     */
     [[nodiscard]] static Result<ValdiModuleArchive> deserialize(BytesView decompressedContent);
 
     bool operator==(const ValdiModuleArchive& other) const;
@@ -63,12 +123,20 @@ public:
 
 private:
     BytesView _decompressedContent;
-    FlatMap<StringBox, ValdiModuleArchiveEntry> _entries;
+    FlatMap<StringBox, size_t> _entryIndexByPath;
     std::vector<StringBox> _orderedEntryPaths;
+    // Entries of archives in the legacy format, in the same order as _orderedEntryPaths
+    std::vector<ValdiModuleArchiveEntry> _entries;
+    // Frames of archives in the seekable format
+    Ref<ValdiModuleArchiveFrames> _frames;
 
     ValdiModuleArchive(BytesView decompressedContent,
-                       FlatMap<StringBox, ValdiModuleArchiveEntry> entries,
-                       std::vector<StringBox> orderedEntryPaths);
+                       FlatMap<StringBox, size_t> entryIndexByPath,
+                       std::vector<StringBox> orderedEntryPaths,
+                       std::vector<ValdiModuleArchiveEntry> entries,
+                       Ref<ValdiModuleArchiveFrames> frames);
+
+    [[nodiscard]] static Result<ValdiModuleArchive> deserializeSeekable(BytesView content);
 };
 
 } // namespace Valdi
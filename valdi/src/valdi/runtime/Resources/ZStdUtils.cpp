@@ -7,6 +7,8 @@
 
 #include "valdi/runtime/Resources/ZStdUtils.hpp"
 #include "valdi/runtime/Resources/MmapBuffer.hpp"
+#include "valdi_core/cpp/Utils/FlatMap.hpp"
+#include "valdi_core/cpp/Utils/Mutex.hpp"
 #include "valdi_core/cpp/Utils/StringCache.hpp"
 #include "zstd.h"
 #include <cstdio>
@@ -19,6 +21,71 @@ namespace Valdi {
 
 static constexpr size_t kMaxSinglePassDecompressSize = 128 * 1024 * 1024;
 
+ZStdDictionary::ZStdDictionary(ZSTD_DDict* ddict, uint32_t id) : _ddict(ddict), _id(id) {}
+
+ZStdDictionary::~ZStdDictionary() {
+    ZSTD_freeDDict(_ddict);
+}
+
+uint32_t ZStdDictionary::getId() const {
+    return _id;
+}
+
+const ZSTD_DDict* ZStdDictionary::getDDict() const {
+    return _ddict;
+}
+
+ZStdDecompressionContext::ZStdDecompressionContext() : _dctx(ZSTD_createDCtx()) {}
+
+ZStdDecompressionContext::~ZStdDecompressionContext() {
+    ZSTD_freeDCtx(_dctx);
+}
+
+ZSTD_DCtx* ZStdDecompressionContext::get() const {
+    return _dctx;
+}
+
+struct ZStdDictionaryRegistry {
+    Mutex mutex;
+    FlatMap<uint32_t, Ref<ZStdDictionary>> dictionaries;
+};
+
+static ZStdDictionaryRegistry& getDictionaryRegistry() {
+    static auto* kRegistry = new ZStdDictionaryRegistry();
+    return *kRegistry;
+}
+
+static Result<size_t> decompressSinglePass(Byte* output,
+                                           size_t outputSize,
+                                           const Byte* input,
+                                           size_t len,
+                                           const ZStdDictionary* dictionary,
+                                           ZStdDecompressionContext* context) {
+    size_t result;
+    if (context != nullptr && context->get() != nullptr) {
+        if (dictionary == nullptr) {
+            result = ZSTD_decompressDCtx(context->get(), output, outputSize, input, len);
+        } else {
+            result = ZSTD_decompress_usingDDict(context->get(), output, outputSize, input, len, dictionary->getDDict());
+        }
+    } else if (dictionary == nullptr) {
+        result = ZSTD_decompress(output, outputSize, input, len);
+    } else {
+        ZStdDecompressionContext temporaryContext;
+        if (temporaryContext.get() == nullptr) {
+            return Error("Could not create ZSTD context");
+        }
+        result =
+            ZSTD_decompress_usingDDict(temporaryContext.get(), output, outputSize, input, len, dictionary->getDDict());
+    }
+
+    if (ZSTD_isError(result) != 0) {
+        return Error(ZSTD_getErrorName(result));
+    }
+
+    return result;
+}
+
 bool ZStdUtils::isZstdFile(const Byte* input, size_t length) {
     if (length < 4) {
         return false;
@@ -28,6 +95,46 @@ bool ZStdUtils::isZstdFile(const Byte* input, size_t length) {
     return output == ZSTD_MAGICNUMBER;
 }
 
+uint32_t ZStdUtils::getFrameDictionaryId(const Byte* input, size_t len) {
+    return ZSTD_getDictID_fromFrame(input, len);
+}
+
+Result<Ref<ZStdDictionary>> ZStdUtils::loadDictionary(const Byte* data, size_t len) {
+    auto dictionaryId = ZSTD_getDictID_fromDict(data, len);
+    if (dictionaryId == 0) {
+        return Error("Not a ZStd dictionary");
+    }
+
+    auto* ddict = ZSTD_createDDict(data, len);
+    if (ddict == nullptr) {
+        return Error("Could not load ZStd dictionary");
+    }
+
+    return makeShared<ZStdDictionary>(ddict, dictionaryId);
+}
+
+void ZStdUtils::registerDictionary(const Ref<ZStdDictionary>& dictionary) {
+    auto& registry = getDictionaryRegistry();
+    std::lock_guard<Mutex> lock(registry.mutex);
+    registry.dictionaries[dictionary->getId()] = dictionary;
+}
+
+void ZStdUtils::unregisterDictionary(uint32_t dictionaryId) {
+    auto& registry = getDictionaryRegistry();
+    std::lock_guard<Mutex> lock(registry.mutex);
+    registry.dictionaries.erase(dictionaryId);
+}
+
+Ref<ZStdDictionary> ZStdUtils::getRegisteredDictionary(uint32_t dictionaryId) {
+    auto& registry = getDictionaryRegistry();
+    std::lock_guard<Mutex> lock(registry.mutex);
+    const auto& it = registry.dictionaries.find(dictionaryId);
+    if (it == registry.dictionaries.end()) {
+        return nullptr;
+    }
+    return it->second;
+}
+
 Result<Ref<ByteBuffer>> ZStdUtils::decompress(const Byte* input, size_t len) {
     auto firstFrameSize = ZSTD_findFrameCompressedSize(input, len);
     bool isSingleFrame = !ZSTD_isError(firstFrameSize) && firstFrameSize == len;
@@ -39,9 +146,9 @@ Result<Ref<ByteBuffer>> ZStdUtils::decompress(const Byte* input, size_t len) {
             auto output = makeShared<ByteBuffer>();
             output->resize(static_cast<size_t>(contentSize));
 
-            auto result = ZSTD_decompress(output->data(), output->size(), input, len);
-            if (ZSTD_isError(result) != 0) {
-                return Error(STRING_FORMAT("Could not decompress: {}", ZSTD_getErrorName(result)));
+            auto result = decompressSinglePass(output->data(), output->size(), input, len, nullptr, nullptr);
+            if (!result) {
+                return result.error().rethrow("Could not decompress");
             }
 
             return output;
@@ -91,6 +198,46 @@ Result<Ref<ByteBuffer>> ZStdUtils::decompress(const Byte* input, size_t len) {
 
     return output;
 }
+
+Result<Ref<ByteBuffer>> ZStdUtils::decompressFrame(const Byte* input,
+                                                   size_t len,
+                                                   size_t decompressedSize,
+                                                   const Ref<ZStdDictionary>& dictionary,
+                                                   ZStdDecompressionContext* context) {
+    if (decompressedSize > kMaxSinglePassDecompressSize) {
+        return Error(
+            STRING_FORMAT("Decompressed size {} exceeds maximum {}", decompressedSize, kMaxSinglePassDecompressSize));
+    }
+
+    Ref<ZStdDictionary> frameDictionary;
+    auto dictionaryId = getFrameDictionaryId(input, len);
+    if (dictionaryId != 0) {
+        if (dictionary != nullptr && dictionary->getId() == dictionaryId) {
+            frameDictionary = dictionary;
+        } else {
+            frameDictionary = getRegisteredDictionary(dictionaryId);
+        }
+        if (frameDictionary == nullptr) {
+            return Error(STRING_FORMAT("No ZStd dictionary registered with id {}", dictionaryId));
+        }
+    }
+
+    auto output = makeShared<ByteBuffer>();
+    output->resize(decompressedSize);
+
+    auto result = decompressSinglePass(output->data(), output->size(), input, len, frameDictionary.get(), context);
+    if (!result) {
+        return result.error().rethrow("Could not decompress frame");
+    }
+
+    if (result.value() != decompressedSize) {
+        return Error(STRING_FORMAT(
+            "Decompressed frame size {} does not match expected size {}", result.value(), decompressedSize));
+    }
+
+    return output;
+}
+
 Result<Ref<MmapBuffer>> ZStdUtils::decompressToMmap(const Byte* input,
                                                     size_t len,
                                                     const Path& filePath,
@@ -13,15 +13,89 @@
 #include "valdi_core/cpp/Utils/Result.hpp"
 #include <vector>
 
+struct ZSTD_DCtx_s;
+struct ZSTD_DDict_s;
+
 namespace Valdi {
 
 class MmapBuffer;
 
+/**
+ * A trained ZStd dictionary, digested for decompression. Frames compressed with a dictionary
+ * reference it by its id, which is stored in the dictionary itself.
+ */
+class ZStdDictionary : public SimpleRefCountable {
+public:
+    ZStdDictionary(ZSTD_DDict_s* ddict, uint32_t id);
+    ~ZStdDictionary() override;
+
+    uint32_t getId() const;
+    const ZSTD_DDict_s* getDDict() const;
+
+private:
+    ZSTD_DDict_s* _ddict;
+    uint32_t _id;
+};
+
+/**
+ * A ZStd decompression context, which can be reused across frames to avoid allocating
+ * a new context for each of them. A context can only be used by one thread at a time.
+ */
+class ZStdDecompressionContext {
+public:
+    ZStdDecompressionContext();
+    ~ZStdDecompressionContext();
+
+    ZStdDecompressionContext(const ZStdDecompressionContext&) = delete;
+    ZStdDecompressionContext& operator=(const ZStdDecompressionContext&) = delete;
+
+    ZSTD_DCtx_s* get() const;
+
+private:
+    ZSTD_DCtx_s* _dctx;
+};
+
 class ZStdUtils {
 public:
+    /**
+     * Decompress the given ZStd frames, which must have been compressed without a dictionary.
+     */
     [[nodiscard]] static Result<Ref<ByteBuffer>> decompress(const Byte* input, size_t len);
     static bool isZstdFile(const Byte* input, size_t length);
 
+    /**
+     * Decompress a single ZStd frame whose decompressed size is known ahead of time,
+     * in one pass. Returns an error if the frame does not decompress to exactly
+     * decompressedSize bytes.
+     * If the frame was compressed with a dictionary, the given dictionary is used when
+     * its id matches, otherwise the dictionary registered for that id is used.
+     * The given context is used when non null, a temporary one is created otherwise.
+     */
+    [[nodiscard]] static Result<Ref<ByteBuffer>> decompressFrame(const Byte* input,
+                                                                 size_t len,
+                                                                 size_t decompressedSize,
+                                                                 const Ref<ZStdDictionary>& dictionary = nullptr,
+                                                                 ZStdDecompressionContext* context = nullptr);
+
+    /**
+     * Load a dictionary trained with `zstd --train`.
+     */
+    [[nodiscard]] static Result<Ref<ZStdDictionary>> loadDictionary(const Byte* data, size_t len);
+
+    /**
+     * Register a dictionary shipped with the app, so that frames referencing its id can be
+     * decompressed without the dictionary being embedded in their archive.
+     */
+    static void registerDictionary(const Ref<ZStdDictionary>& dictionary);
+    static void unregisterDictionary(uint32_t dictionaryId);
+    static Ref<ZStdDictionary> getRegisteredDictionary(uint32_t dictionaryId);
+
+    /**
+     * Returns the id of the dictionary the given frame was compressed with,
+     * or 0 if it was compressed without a dictionary.
+     */
+    static uint32_t getFrameDictionaryId(const Byte* input, size_t len);
+
     /**
      * Decompress directly into a file-backed mmap region.
      * Requires that the ZStd frame encodes the content size.
@@ -169,6 +169,9 @@ Runtime::Runtime(AttributeIds& attributeIds,
                                                                   jsRuntimeThreadQoS,
                                                                   anrDetector,
                                                                   logger);
+        if (diskCache != nullptr) {
+            _javaScriptRuntime->setBytecodeDiskCache(diskCache->scopedCache(Path("js_bytecode"), false));
+        }
     }
 
     // Uncomment to print the internal Valdi object sizes
@@ -554,6 +554,11 @@ void RuntimeManager::setMetrics(const Ref<Metrics>& metrics) {
     _anrDetector->setMetrics(metrics);
 }
 
+Ref<Metrics> RuntimeManager::getMetrics() const {
+    std::lock_guard<Mutex> guard(_mutex);
+    return _metrics;
+}
+
 void RuntimeManager::setTweakValueProvider(const Shared<ITweakValueProvider>& tweakValueProvider) {
     std::vector<SharedRuntime> runtimes;
     Ref<ValdiRuntimeTweaks> runtimeTweaks;
@@ -595,6 +600,11 @@ void RuntimeManager::setTweakValueProvider(const Shared<ITweakValueProvider>& tw
     }
 }
 
+Ref<ValdiRuntimeTweaks> RuntimeManager::getRuntimeTweaks() const {
+    std::lock_guard<Mutex> guard(_mutex);
+    return _runtimeTweaks;
+}
+
 void RuntimeManager::cancelDeferredGCTask() {
     const auto previousTaskID = swapDeferredGCTask(DispatchQueue::TaskIDNull);
     if (previousTaskID != DispatchQueue::TaskIDNull) {
@@ -132,6 +132,7 @@ public:
     const Holder<Ref<UserSession>>& getUserSession() const;
 
     void setTweakValueProvider(const Shared<ITweakValueProvider>& tweakValueProvider);
+    Ref<ValdiRuntimeTweaks> getRuntimeTweaks() const;
 
     void setMmapCacheDirectory(const Path& path);
 
@@ -156,6 +157,7 @@ public:
     void emitUserSessionReadyMetrics();
 
     void setMetrics(const Ref<Metrics>& metrics);
+    Ref<Metrics> getMetrics() const;
 
     PlatformType getPlatformType() const;
 
@@ -176,4 +176,24 @@ int32_t ValdiRuntimeTweaks::preloadYieldChunkSize() const {
     return _tweakValueProvider->getInt(configKey, 0);
 }
 
+bool ValdiRuntimeTweaks::enableAnimatedImageFrameCache() const {
+    return getConfigKey("VALDI_ENABLE_ANIMATED_IMAGE_FRAME_CACHE");
+}
+
+bool ValdiRuntimeTweaks::enableConcurrentLazyLayout() const {
+    return getConfigKey("VALDI_ENABLE_CONCURRENT_LAZY_LAYOUT");
+}
+
+bool ValdiRuntimeTweaks::enablePersistentTextShaperCache() const {
+    return getConfigKey("VALDI_ENABLE_PERSISTENT_TEXT_SHAPER_CACHE");
+}
+
+bool ValdiRuntimeTweaks::enableRasterTileCache() const {
+    return getConfigKey("VALDI_ENABLE_RASTER_TILE_CACHE");
+}
+
+bool ValdiRuntimeTweaks::enableParallelRaster() const {
+    return getConfigKey("VALDI_ENABLE_PARALLEL_RASTER");
+}
+
 } // namespace Valdi
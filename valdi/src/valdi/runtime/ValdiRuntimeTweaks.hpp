@@ -50,6 +50,16 @@ public:
     // 0 (default) keeps preload as a single uninterrupted task. > 0 bounds the max contiguous JS
     // occupancy during capture-start preload so the 5s Composer watchdog ack can run. Read via getInt.
     int32_t preloadYieldChunkSize() const;
+    // Shares the rasterized frames of animated images across the SnapDrawing layers drawing them.
+    bool enableAnimatedImageFrameCache() const;
+    // Calculates the independent lazy layouts of a ViewNodeTree concurrently on the shared WorkStealingExecutor.
+    bool enableConcurrentLazyLayout() const;
+    // Saves the text shaper cache into the disk cache when the app goes to the background, and restores it on launch.
+    bool enablePersistentTextShaperCache() const;
+    // Retains the rasterized content of the layers caching raster tiles across the raster passes of a RasterContext.
+    bool enableRasterTileCache() const;
+    // Rasterizes the disjoint tiles of a RasterContext in parallel on the shared WorkStealingExecutor.
+    bool enableParallelRaster() const;
 
 private:
     Shared<ITweakValueProvider> _tweakValueProvider;
@@ -20,6 +20,15 @@ class MeasureDelegate : public SimpleRefCountable {
 public:
     virtual Size measure(
         ViewNode& viewNode, float width, MeasureMode widthMode, float height, MeasureMode heightMode) = 0;
+
+    /**
+     Whether measure() can be called from any thread, concurrently with other measurements.
+     Layouts which measure nodes using a delegate that is not thread safe are always calculated
+     on the calling thread.
+     */
+    virtual bool isThreadSafe() const {
+        return false;
+    }
 };
 
 } // namespace Valdi
@@ -18,11 +18,13 @@ namespace snap::drawing {
 
 ValdiAnimator::ValdiAnimator(Duration duration,
                              InterpolationFunction&& interpolationFunction,
+                             std::optional<TimingCurve> timingCurve,
                              bool beginFromCurrentState,
                              double stiffness,
                              double damping)
     : _duration(duration),
       _interpolationFunction(std::move(interpolationFunction)),
+      _timingCurve(timingCurve),
       _beginFromCurrentState(beginFromCurrentState),
       _stiffness(stiffness),
       _damping(damping) {
@@ -90,6 +92,24 @@ void ValdiAnimator::createAndAppendAnimation(Layer& view,
     appendAnimation(ref, animation, key);
 }
 
+bool ValdiAnimator::supportsPropertyAnimations() const {
+    return !_isSpringAnimation && _timingCurve.has_value();
+}
+
+void ValdiAnimator::createAndAppendPropertyAnimation(
+    Layer& view, const String& key, AnimatedProperty property, Scalar from, Scalar to) {
+    appendAnimation(Valdi::strongSmallRef(&view),
+                    Valdi::makeShared<PropertyAnimation>(property, _duration, _timingCurve.value(), from, to),
+                    key);
+}
+
+void ValdiAnimator::createAndAppendPropertyAnimation(
+    Layer& view, const String& key, AnimatedProperty property, Color from, Color to) {
+    appendAnimation(Valdi::strongSmallRef(&view),
+                    Valdi::makeShared<PropertyAnimation>(property, _duration, _timingCurve.value(), from, to),
+                    key);
+}
+
 Duration ValdiAnimator::getDuration() const {
     return _duration;
 }
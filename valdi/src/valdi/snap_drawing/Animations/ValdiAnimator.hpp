@@ -8,11 +8,14 @@
 #pragma once
 
 #include "snap_drawing/cpp/Animations/Animation.hpp"
+#include "snap_drawing/cpp/Animations/PropertyAnimation.hpp"
 #include "snap_drawing/cpp/Utils/Aliases.hpp"
 #include "snap_drawing/cpp/Utils/TimePoint.hpp"
 #include "valdi_core/Animator.hpp"
 #include "valdi_core/cpp/Utils/Shared.hpp"
 
+#include <optional>
+
 namespace snap::drawing {
 
 // These are pulled from the ValdiValueAnimatorConfig
@@ -37,6 +40,7 @@ class ValdiAnimator : public snap::valdi_core::Animator, public Valdi::SharedPtr
 public:
     ValdiAnimator(Duration duration,
                   InterpolationFunction&& interpolationFunction,
+                  std::optional<TimingCurve> timingCurve,
                   bool beginFromCurrentState,
                   double stiffness,
                   double damping);
@@ -50,6 +54,17 @@ public:
 
     void createAndAppendAnimation(Layer& view, const String& key, double minVisibleChange, AnimationApplier&& applier);
 
+    /**
+     Whether the animations of this animator can be created as PropertyAnimation, which requires
+     a timing curve animation.
+     */
+    bool supportsPropertyAnimations() const;
+
+    void createAndAppendPropertyAnimation(
+        Layer& view, const String& key, AnimatedProperty property, Scalar from, Scalar to);
+    void createAndAppendPropertyAnimation(
+        Layer& view, const String& key, AnimatedProperty property, Color from, Color to);
+
     void appendAnimation(const Ref<Layer>& view, const Ref<IAnimation>& animation, const String& key);
 
     void flushAnimations(const Valdi::Value& completion) override;
@@ -61,6 +76,7 @@ public:
 private:
     Duration _duration;
     InterpolationFunction _interpolationFunction;
+    std::optional<TimingCurve> _timingCurve;
     bool _beginFromCurrentState;
     double _stiffness;
     double _damping;
@@ -9,6 +9,7 @@
 
 #include "snap_drawing/cpp/Utils/Image.hpp"
 
+#include "valdi/runtime/Metrics/Metrics.hpp"
 #include "valdi/snap_drawing/ImageLoading/ImageCacheItem.hpp"
 #include "valdi_core/cpp/Constants.hpp"
 #include "valdi_core/cpp/Utils/LoggerUtils.hpp"
@@ -31,28 +32,12 @@ struct ScalingResult {
 static ScalingResult findScaledDimensions(int imageWidth, int imageHeight, int targetWidth, int targetHeight) {
     SC_ASSERT(imageWidth != 0 && imageHeight != 0);
 
-    bool targetMatchesOriginal = imageWidth == targetWidth && imageHeight == targetHeight;
-    bool targetDimensionsAreZero = targetWidth == 0 && targetHeight == 0;
-
-    if (targetMatchesOriginal || targetDimensionsAreZero) {
+    const int scalingFactor = Image::computeSampleSize(imageWidth, imageHeight, targetWidth, targetHeight);
+    if (scalingFactor == 1) {
         return ScalingResult(imageWidth, imageHeight);
     }
 
     const bool scaleOnWidth = targetWidth >= targetHeight;
-
-    const int referenceImageSize = scaleOnWidth ? imageWidth : imageHeight;
-    const int referenceTargetSize = scaleOnWidth ? targetWidth : targetHeight;
-
-    if (referenceTargetSize > referenceImageSize) {
-        return ScalingResult(imageWidth, imageHeight);
-    }
-
-    int scalingFactor = 1;
-    const int binningFactor = 2;
-    while (referenceImageSize / (scalingFactor * binningFactor) >= referenceTargetSize) {
-        scalingFactor *= binningFactor;
-    }
-
     const auto scalingFactorFloat = static_cast<double>(scalingFactor);
     const auto ratio = static_cast<double>(imageWidth) / static_cast<double>(imageHeight);
     int newWidth = 0;
@@ -69,59 +54,122 @@ static ScalingResult findScaledDimensions(int imageWidth, int imageHeight, int t
     return ScalingResult(newWidth, newHeight, scalingFactorFloat);
 }
 
+static void emitEviction(const Ref<Valdi::Metrics>& metrics, size_t originalsBytes, size_t variantsBytes) {
+    if (metrics != nullptr && (originalsBytes != 0 || variantsBytes != 0)) {
+        metrics->emitImageCacheEviction(static_cast<int64_t>(originalsBytes), static_cast<int64_t>(variantsBytes));
+    }
+}
+
 ImageCache::ImageCache(Valdi::ILogger& logger, size_t maxSizeInBytes)
     : _maxSizeInBytes(maxSizeInBytes),
-      _currentSize(0),
+      _maxOriginalsSizeInBytes(maxSizeInBytes),
+      _maxVariantsSizeInBytes(maxSizeInBytes),
       _maxAgeMicroSeconds(std::chrono::microseconds(0)),
-      _logger(logger),
-      _cacheListStart(Valdi::makeShared<ImageCacheItem>(STRING_LITERAL("SENTINAL-START"), nullptr, nullptr)),
-      _cacheListEnd(Valdi::makeShared<ImageCacheItem>(STRING_LITERAL("SENTINAL-END"), nullptr, nullptr)) {
-    _cacheListStart->insertAfter(_cacheListEnd);
-}
+      _logger(logger) {}
+
+ImageCache::ImageCache(Valdi::ILogger& logger, size_t maxOriginalsSizeInBytes, size_t maxVariantsSizeInBytes)
+    : _maxSizeInBytes(maxOriginalsSizeInBytes + maxVariantsSizeInBytes),
+      _maxOriginalsSizeInBytes(maxOriginalsSizeInBytes),
+      _maxVariantsSizeInBytes(maxVariantsSizeInBytes),
+      _maxAgeMicroSeconds(std::chrono::microseconds(0)),
+      _logger(logger) {}
 
 ImageCache::~ImageCache() = default;
 
 Valdi::Result<CachedImage> ImageCache::getResizedCachedImage(const String& url,
                                                              int preferredWidth,
                                                              int preferredHeight) {
-    Valdi::Result<CachedImage> result;
+    std::unique_lock<Valdi::Mutex> lock(_mutex);
+    auto metrics = _metrics;
     auto it = _cache.find(url);
     if (it == _cache.end()) {
-        result = Valdi::Error("not found");
-    } else {
-        result = getResizedImage(url, it->second, preferredWidth, preferredHeight);
+        lock.unlock();
+        if (metrics != nullptr) {
+            metrics->emitImageCacheMiss();
+        }
+        return Valdi::Error("not found");
+    }
+
+    auto cachedItem = it->second;
+    EvictionStats stats;
+    auto cachedImage = getResizedImage(lock, cachedItem, preferredWidth, preferredHeight, stats);
+    lock.unlock();
+
+    if (metrics != nullptr) {
+        if (cachedImage) {
+            metrics->emitImageCacheHit();
+        } else {
+            metrics->emitImageCacheMiss();
+        }
+        emitEviction(metrics, stats.originalsBytes, stats.variantsBytes);
     }
-    return result;
+
+    return cachedImage;
 }
 
 size_t ImageCache::getCurrentSize() const {
-    return _currentSize;
+    std::lock_guard<Valdi::Mutex> guard(_mutex);
+    return _originalsSize + _variantsSize;
+}
+
+size_t ImageCache::getOriginalsSize() const {
+    std::lock_guard<Valdi::Mutex> guard(_mutex);
+    return _originalsSize;
 }
 
-CachedImage ImageCache::getResizedImage(const String& url,
-                                        Ref<ImageCacheItem>& cachedItem,
-                                        int preferredWidth,
-                                        int preferredHeight) {
+size_t ImageCache::getVariantsSize() const {
+    std::lock_guard<Valdi::Mutex> guard(_mutex);
+    return _variantsSize;
+}
+
+Valdi::Result<CachedImage> ImageCache::getResizedImage(std::unique_lock<Valdi::Mutex>& lock,
+                                                       const Ref<ImageCacheItem>& cachedItem,
+                                                       int preferredWidth,
+                                                       int preferredHeight,
+                                                       EvictionStats& stats) {
     Ref<Image> returnImage;
-    auto scalingResult =
-        findScaledDimensions(cachedItem->getWidth(), cachedItem->getHeight(), preferredWidth, preferredHeight);
-    auto newWidth = scalingResult.width;
-    auto newHeight = scalingResult.height;
+    auto scalingResult = findScaledDimensions(
+        cachedItem->getSourceWidth(), cachedItem->getSourceHeight(), preferredWidth, preferredHeight);
+    auto sampleSize = cachedItem->getSampleSize();
+    if (static_cast<int>(scalingResult.scaling) < sampleSize) {
+        return Valdi::Error("Cached image was decoded at a smaller size than requested");
+    }
+
+    // The scaled dimensions are computed from the encoded image, which can be off by one pixel from
+    // the dimensions that the codec produced when subsampling.
+    auto newWidth = static_cast<int>(scalingResult.scaling) == sampleSize ? cachedItem->getWidth() : scalingResult.width;
+    auto newHeight =
+        static_cast<int>(scalingResult.scaling) == sampleSize ? cachedItem->getHeight() : scalingResult.height;
     auto scalingFactor = scalingResult.scaling;
 
     if ((cachedItem->getWidth() != newWidth || cachedItem->getHeight() != newHeight)) {
         // NOTE(rjaber): This generates a new key, which may not be a valid URL.
         //              case1 (valid)  : https://placecats.com/200/300?foo=bar&com.valdi.dimension=100,150
         //              case2 (invalid): https://placecats.com/200/300&com.valdi.dimension=100,150
+        const auto& url = cachedItem->getUrl();
         auto new_url = url.append(STRING_FORMAT("&com.valdi.dimensions={},{};", newWidth, newHeight));
 
         auto it = _cache.find(new_url);
         if (it == _cache.end()) {
-            auto resizedCachedItem = cachedItem->getResized(new_url, newWidth, newHeight);
-            _cacheListStart->insertAfter(resizedCachedItem);
-            returnImage = resizedCachedItem->updateLastAccessAndGetImage();
-            _cache[new_url] = resizedCachedItem;
-            _currentSize += resizedCachedItem->getImageSizeInBytes();
+            // Resize without holding the lock, so that lookups from other threads are not blocked.
+            // Retaining the source image marks the original as in use, which prevents its eviction.
+            auto sourceImage = cachedItem->getImage();
+            lock.unlock();
+            auto resizedImage = sourceImage->resized(newWidth, newHeight);
+            lock.lock();
+
+            it = _cache.find(new_url);
+            if (it != _cache.end()) {
+                // Another thread created the same variant in the meantime
+                returnImage = retrieveImage(it->second);
+            } else {
+                // The variant is not cached if its original was replaced while resizing
+                auto originalIt = _cache.find(url);
+                if (originalIt != _cache.end() && originalIt->second == cachedItem) {
+                    insertItem(Valdi::makeShared<ImageCacheItem>(new_url, cachedItem, resizedImage));
+                }
+                returnImage = std::move(resizedImage);
+            }
         } else {
             returnImage = retrieveImage(it->second);
         }
@@ -129,114 +177,203 @@ CachedImage ImageCache::getResizedImage(const String& url,
         returnImage = retrieveImage(cachedItem);
     }
 
-    if (_currentSize > _maxSizeInBytes) {
-        invalidateCachedItems(EvictionPolicy::Memory);
+    if (isOverBudget()) {
+        lockFreeInvalidateCachedItems(EvictionPolicy::Memory, stats);
     }
 
     return CachedImage(returnImage, scalingFactor);
 }
 
 void ImageCache::setMaxAge(uint64_t maxAgeSeconds) {
+    std::lock_guard<Valdi::Mutex> guard(_mutex);
     _maxAgeMicroSeconds = snap::utils::time::Duration<std::chrono::steady_clock>(std::chrono::seconds(maxAgeSeconds));
 }
 
-Ref<Image> ImageCache::retrieveImage(Ref<ImageCacheItem>& cachedItem) {
+void ImageCache::setMetrics(const Ref<Valdi::Metrics>& metrics) {
+    std::lock_guard<Valdi::Mutex> guard(_mutex);
+    _metrics = metrics;
+}
+
+Ref<Image> ImageCache::retrieveImage(const Ref<ImageCacheItem>& cachedItem) {
     auto returnImage = cachedItem->updateLastAccessAndGetImage();
-    cachedItem->disconnectAndReturnPrevious();
-    _cacheListStart->insertAfter(cachedItem);
+    if (cachedItem->isOriginal()) {
+        _originals.pushFront(cachedItem);
+    } else {
+        _variants.pushFront(cachedItem);
+    }
     return returnImage;
 }
 
-Ref<ImageCacheItem> ImageCache::tryRemoveOriginalImage(Ref<ImageCacheItem>& cachedItem,
-                                                       snap::utils::time::Duration<std::chrono::steady_clock> pastTime,
-                                                       bool enableTimeExit) {
-    const auto& url = cachedItem->getUrl();
+void ImageCache::insertItem(const Ref<ImageCacheItem>& cachedItem) {
+    _cache[cachedItem->getUrl()] = cachedItem;
+    if (cachedItem->isOriginal()) {
+        _originals.pushFront(cachedItem);
+        _originalsSize += cachedItem->getImageSizeInBytes();
+    } else {
+        cachedItem->getParent()->addVariant();
+        _variants.pushFront(cachedItem);
+        _variantsSize += cachedItem->getImageSizeInBytes();
+    }
+}
 
-    if (cachedItem->isUnused() && !cachedItem->hasVariants() && (!enableTimeExit || cachedItem->isExpired(pastTime))) {
-        _currentSize -= cachedItem->getImageSizeInBytes();
-        _cache.erase(url);
-        return cachedItem->disconnectAndReturnPrevious();
+void ImageCache::removeItem(const Ref<ImageCacheItem>& cachedItem) {
+    _cache.erase(cachedItem->getUrl());
+    if (cachedItem->isOriginal()) {
+        _originals.remove(_originals.iterator(cachedItem));
+        _originalsSize -= cachedItem->getImageSizeInBytes();
     } else {
-        return cachedItem->getPrevious();
+        cachedItem->getParent()->removeVariant();
+        _variants.remove(_variants.iterator(cachedItem));
+        _variantsSize -= cachedItem->getImageSizeInBytes();
     }
 }
 
-void ImageCache::invalidateCachedItems(EvictionPolicy policy) {
-    VALDI_TRACE("Valdi.invalidateCachedItems");
-    const bool enableTimeExit = (policy == EvictionPolicy::Time) || (policy == EvictionPolicy::Both);
-    const bool enableSizeExit = (policy == EvictionPolicy::Memory) || (policy == EvictionPolicy::Both);
+bool ImageCache::isOverBudget() const {
+    return shouldEvict(true) || shouldEvict(false);
+}
 
-    auto pastTime = ImageCacheItem::getCurrentTime();
-    pastTime = (pastTime > _maxAgeMicroSeconds) ? (pastTime - _maxAgeMicroSeconds) :
-                                                  snap::utils::time::Duration<std::chrono::steady_clock>();
+bool ImageCache::shouldEvict(bool original) const {
+    if (_originalsSize + _variantsSize > _maxSizeInBytes) {
+        return true;
+    }
+    if (original) {
+        return _originalsSize > _maxOriginalsSizeInBytes;
+    }
+    // Evicting a variant can also release its original
+    return _variantsSize > _maxVariantsSizeInBytes || _originalsSize > _maxOriginalsSizeInBytes;
+}
 
-    auto it = _cacheListEnd->getPrevious();
-    while (it != _cacheListStart) {
-        if (enableTimeExit && !it->isExpired(pastTime)) {
+bool ImageCache::tryRemoveOriginalImage(const Ref<ImageCacheItem>& cachedItem,
+                                        snap::utils::time::Duration<std::chrono::steady_clock> pastTime,
+                                        bool enableTimeExit,
+                                        EvictionStats& stats) {
+    if (cachedItem->isUnused() && !cachedItem->hasVariants() && (!enableTimeExit || cachedItem->isExpired(pastTime))) {
+        stats.originalsBytes += cachedItem->getImageSizeInBytes();
+        removeItem(cachedItem);
+        return true;
+    }
+    return false;
+}
+
+void ImageCache::evictFromList(Valdi::LinkedList<ImageCacheItem>& list,
+                               snap::utils::time::Duration<std::chrono::steady_clock> pastTime,
+                               bool enableTimeExit,
+                               bool enableSizeExit,
+                               EvictionStats& stats) {
+    auto it = list.rbegin();
+    while (it != list.rend()) {
+        auto cachedItem = *it;
+        if (enableTimeExit && !cachedItem->isExpired(pastTime)) {
             break;
         }
-        if (enableSizeExit && (_currentSize <= _maxSizeInBytes)) {
+        if (enableSizeExit && !shouldEvict(cachedItem->isOriginal())) {
             break;
         }
 
-        if (it->isOriginal()) {
-            it = tryRemoveOriginalImage(it, pastTime, enableTimeExit);
-        } else if (it->isUnused() && (!enableTimeExit || it->isExpired(pastTime))) {
-            _currentSize -= it->getImageSizeInBytes();
-            _cache.erase(it->getUrl());
+        // Move to the previous item before the current one is potentially removed from the list
+        ++it;
 
-            const auto parent = it->getParent();
-            auto previous = it->disconnectAndReturnPrevious();
-            it = nullptr;
+        if (cachedItem->isOriginal()) {
+            tryRemoveOriginalImage(cachedItem, pastTime, enableTimeExit, stats);
+        } else if (cachedItem->isUnused() && (!enableTimeExit || cachedItem->isExpired(pastTime))) {
+            auto parent = cachedItem->getParent();
+            stats.variantsBytes += cachedItem->getImageSizeInBytes();
+            removeItem(cachedItem);
 
             if (!parent->hasVariants()) {
-                auto it_original = _cache.find(parent->getUrl());
-                SC_ASSERT(it_original != _cache.end());
-
-                bool parentAndPreviousAreSame = parent == previous;
-                auto candidatePrevious = tryRemoveOriginalImage(it_original->second, pastTime, enableTimeExit);
-                if (parentAndPreviousAreSame) {
-                    previous = candidatePrevious;
-                }
+                tryRemoveOriginalImage(parent, pastTime, enableTimeExit, stats);
             }
-            it = previous;
-        } else {
-            it = it->getPrevious();
         }
     }
 }
 
+void ImageCache::lockFreeInvalidateCachedItems(EvictionPolicy policy, EvictionStats& stats) {
+    VALDI_TRACE("Valdi.invalidateCachedItems");
+    const bool enableTimeExit = (policy == EvictionPolicy::Time) || (policy == EvictionPolicy::Both);
+    const bool enableSizeExit = (policy == EvictionPolicy::Memory) || (policy == EvictionPolicy::Both);
+
+    auto pastTime = ImageCacheItem::getCurrentTime();
+    pastTime = (pastTime > _maxAgeMicroSeconds) ? (pastTime - _maxAgeMicroSeconds) :
+                                                  snap::utils::time::Duration<std::chrono::steady_clock>();
+
+    // Variants go first: they are cheaper to recreate than originals, which cannot be evicted
+    // as long as they have variants.
+    evictFromList(_variants, pastTime, enableTimeExit, enableSizeExit, stats);
+    evictFromList(_originals, pastTime, enableTimeExit, enableSizeExit, stats);
+}
+
+void ImageCache::invalidateCachedItems(EvictionPolicy policy) {
+    std::unique_lock<Valdi::Mutex> lock(_mutex);
+    EvictionStats stats;
+    lockFreeInvalidateCachedItems(policy, stats);
+    auto metrics = _metrics;
+    lock.unlock();
+
+    emitEviction(metrics, stats.originalsBytes, stats.variantsBytes);
+}
+
 Valdi::Result<CachedImage> ImageCache::setCachedItemAndGetResizedImage(const String& url,
                                                                        const Ref<Image>& image,
                                                                        int preferredWidth,
                                                                        int preferredHeight) {
+    return setCachedItemAndGetResizedImage(
+        url, Valdi::makeShared<ImageCacheItem>(url, nullptr, image), preferredWidth, preferredHeight);
+}
+
+Valdi::Result<CachedImage> ImageCache::setSubsampledCachedItemAndGetResizedImage(const String& url,
+                                                                                 const SubsampledImage& image,
+                                                                                 int preferredWidth,
+                                                                                 int preferredHeight) {
+    return setCachedItemAndGetResizedImage(
+        url,
+        Valdi::makeShared<ImageCacheItem>(
+            url, image.image, image.sampleSize, image.sourceWidth, image.sourceHeight),
+        preferredWidth,
+        preferredHeight);
+}
+
+Valdi::Result<CachedImage> ImageCache::setCachedItemAndGetResizedImage(const String& url,
+                                                                       const Ref<ImageCacheItem>& cacheItem,
+                                                                       int preferredWidth,
+                                                                       int preferredHeight) {
+    std::unique_lock<Valdi::Mutex> lock(_mutex);
+    EvictionStats stats;
+    Valdi::Result<CachedImage> cachedImage;
+
     auto cache_itr = _cache.find(url);
-    if (VALDI_UNLIKELY(cache_itr != _cache.end())) {
-        auto it = _cacheListEnd->getPrevious();
-        Ref<ImageCacheItem> parent = cache_itr->second; // NOTE(rjaber): This is meant to extend the life of the parent
-        while (it != _cacheListStart) {
-            const auto& cacheItem = it;
-            const bool shouldErase = cacheItem->getOriginalUrl() == url;
-            if (shouldErase) {
-                _currentSize -= cacheItem->getImageSizeInBytes();
-                _cache.erase(cacheItem->getUrl());
-                it = cacheItem->disconnectAndReturnPrevious();
-            } else {
-                it = cacheItem->getPrevious();
+    if (cache_itr != _cache.end() && cache_itr->second->getSampleSize() < cacheItem->getSampleSize()) {
+        // A concurrent load already cached a larger decode of the same image, which we keep
+        Ref<ImageCacheItem> existingItem = cache_itr->second;
+        cachedImage = getResizedImage(lock, existingItem, preferredWidth, preferredHeight, stats);
+    } else {
+        if (VALDI_UNLIKELY(cache_itr != _cache.end())) {
+            Ref<ImageCacheItem> previousItem = cache_itr->second;
+            auto it = _variants.begin();
+            while (it != _variants.end()) {
+                auto variant = *it;
+                ++it;
+                if (variant->getParent() == previousItem) {
+                    removeItem(variant);
+                }
             }
+            removeItem(previousItem);
+            VALDI_DEBUG(_logger, "Evicting previous instances of image with {}", url);
         }
-        VALDI_DEBUG(_logger, "Evicting previous instances of image with {}", url);
+
+        insertItem(cacheItem);
+        cachedImage = getResizedImage(lock, cacheItem, preferredWidth, preferredHeight, stats);
     }
 
-    auto cacheItem = Valdi::makeShared<ImageCacheItem>(url, nullptr, image);
-    _cacheListStart->insertAfter(cacheItem);
-    _cache[url] = cacheItem;
-    _currentSize += cacheItem->getImageSizeInBytes();
+    auto metrics = _metrics;
+    lock.unlock();
+
+    emitEviction(metrics, stats.originalsBytes, stats.variantsBytes);
 
-    return getResizedImage(url, cacheItem, preferredWidth, preferredHeight);
+    return cachedImage;
 }
 
 int ImageCache::getVariantCount(const String& url) const {
+    std::lock_guard<Valdi::Mutex> guard(_mutex);
     const auto& it = _cache.find(url);
     if (it != _cache.end()) {
         return (it->second)->getVariantCount();
@@ -13,11 +13,20 @@
 #include "valdi/snap_drawing/ImageLoading/ImageCacheItem.hpp"
 #include "valdi_core/cpp/Interfaces/ILogger.hpp"
 #include "valdi_core/cpp/Utils/FlatMap.hpp"
+#include "valdi_core/cpp/Utils/LinkedList.hpp"
+#include "valdi_core/cpp/Utils/Mutex.hpp"
 #include "valdi_core/cpp/Utils/Result.hpp"
 
+#include <mutex>
+
+namespace Valdi {
+class Metrics;
+}
+
 namespace snap::drawing {
 
 class Image;
+struct SubsampledImage;
 
 struct CachedImage {
     Ref<Image> image;
@@ -26,6 +35,12 @@ struct CachedImage {
     inline CachedImage(Ref<Image> image, float scale);
 };
 
+/**
+ Memory cache of decoded images and of their resized variants, bounded by bytes.
+ Originals and resized variants are two size classes, each with its own LRU list and budget.
+ An original is kept as long as it has variants, and images that are still in use outside
+ of the cache are never evicted. The cache is thread safe.
+ */
 class ImageCache {
 public:
     enum class EvictionPolicy { //  Determines when invalidateCachedItems can terminate.
@@ -34,7 +49,9 @@ public:
         Both,                   // Termination occurs when either of the above conditions is satisfied.
     };
 
-    explicit ImageCache(Valdi::ILogger& logger, size_t maxSizeInBytes);
+    // Originals and resized variants share a single budget
+    ImageCache(Valdi::ILogger& logger, size_t maxSizeInBytes);
+    ImageCache(Valdi::ILogger& logger, size_t maxOriginalsSizeInBytes, size_t maxVariantsSizeInBytes);
     ~ImageCache();
 
     Valdi::Result<CachedImage> getResizedCachedImage(const String& url, int preferredWidth, int preferredHeight);
@@ -44,31 +61,76 @@ public:
                                                                int preferredWidth,
                                                                int preferredHeight);
 
+    /**
+     Caches an image that was decoded at a reduced size as the original of the given url.
+     Lookups that need a larger image than the subsampled one are reported as not found, so that
+     the image gets decoded again at a larger size.
+     */
+    Valdi::Result<CachedImage> setSubsampledCachedItemAndGetResizedImage(const String& url,
+                                                                         const SubsampledImage& image,
+                                                                         int preferredWidth,
+                                                                         int preferredHeight);
+
     void invalidateCachedItems(EvictionPolicy policy);
 
     void setMaxAge(uint64_t maxAgeSeconds);
+    void setMetrics(const Ref<Valdi::Metrics>& metrics);
+
     int getVariantCount(const String& url) const;
     size_t getCurrentSize() const;
+    size_t getOriginalsSize() const;
+    size_t getVariantsSize() const;
 
 private:
+    struct EvictionStats {
+        size_t originalsBytes = 0;
+        size_t variantsBytes = 0;
+    };
+
+    mutable Valdi::Mutex _mutex;
     const size_t _maxSizeInBytes;
-    size_t _currentSize;
+    const size_t _maxOriginalsSizeInBytes;
+    const size_t _maxVariantsSizeInBytes;
+    size_t _originalsSize = 0;
+    size_t _variantsSize = 0;
     snap::utils::time::Duration<std::chrono::steady_clock> _maxAgeMicroSeconds;
     [[maybe_unused]] Valdi::ILogger& _logger;
+    Ref<Valdi::Metrics> _metrics;
 
-    Ref<ImageCacheItem> _cacheListStart;
-    Ref<ImageCacheItem> _cacheListEnd;
+    // Most recently used first
+    Valdi::LinkedList<ImageCacheItem> _originals;
+    Valdi::LinkedList<ImageCacheItem> _variants;
     Valdi::FlatMap<String, Ref<ImageCacheItem>> _cache;
 
-    Ref<ImageCacheItem> tryRemoveOriginalImage(Ref<ImageCacheItem>& cachedItem,
-                                               snap::utils::time::Duration<std::chrono::steady_clock> pastTime,
-                                               bool enableTimeExit);
-    Ref<Image> retrieveImage(Ref<ImageCacheItem>& cachedItem);
+    Valdi::Result<CachedImage> setCachedItemAndGetResizedImage(const String& url,
+                                                               const Ref<ImageCacheItem>& cacheItem,
+                                                               int preferredWidth,
+                                                               int preferredHeight);
 
-    CachedImage getResizedImage(const String& url,
-                                Ref<ImageCacheItem>& cachedItem,
-                                int preferredWidth,
-                                int preferredHeight);
+    Valdi::Result<CachedImage> getResizedImage(std::unique_lock<Valdi::Mutex>& lock,
+                                               const Ref<ImageCacheItem>& cachedItem,
+                                               int preferredWidth,
+                                               int preferredHeight,
+                                               EvictionStats& stats);
+
+    Ref<Image> retrieveImage(const Ref<ImageCacheItem>& cachedItem);
+
+    void insertItem(const Ref<ImageCacheItem>& cachedItem);
+    void removeItem(const Ref<ImageCacheItem>& cachedItem);
+
+    bool isOverBudget() const;
+    bool shouldEvict(bool original) const;
+
+    void lockFreeInvalidateCachedItems(EvictionPolicy policy, EvictionStats& stats);
+    void evictFromList(Valdi::LinkedList<ImageCacheItem>& list,
+                       snap::utils::time::Duration<std::chrono::steady_clock> pastTime,
+                       bool enableTimeExit,
+                       bool enableSizeExit,
+                       EvictionStats& stats);
+    bool tryRemoveOriginalImage(const Ref<ImageCacheItem>& cachedItem,
+                                snap::utils::time::Duration<std::chrono::steady_clock> pastTime,
+                                bool enableTimeExit,
+                                EvictionStats& stats);
 };
 
 } // namespace snap::drawing
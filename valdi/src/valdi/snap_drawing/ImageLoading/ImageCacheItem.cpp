@@ -25,25 +25,41 @@ size_t ImageCacheItem::imageSize(const Valdi::Ref<Image>& image) {
 ImageCacheItem::ImageCacheItem(const String& url,
                                const Valdi::Ref<ImageCacheItem>& parent,
                                const Valdi::Ref<Image>& img)
-    : _variants(0), _url(url), _parent(parent.get()), _image(img) {
+    : _variants(0),
+      _url(url),
+      _parent(parent),
+      _image(img),
+      _imageSizeInBytes(imageSize(img)),
+      _sampleSize(1),
+      _sourceWidth(img->width()),
+      _sourceHeight(img->height()) {
     updateLastAccess();
-    _previous = nullptr;
-    _next = nullptr;
 };
 
-ImageCacheItem::~ImageCacheItem() {
-    if (_parent != nullptr) {
-        _parent->decrementVariants();
-        _parent = nullptr;
-    }
+ImageCacheItem::ImageCacheItem(
+    const String& url, const Valdi::Ref<Image>& img, int sampleSize, int sourceWidth, int sourceHeight)
+    : _variants(0),
+      _url(url),
+      _image(img),
+      _imageSizeInBytes(imageSize(img)),
+      _sampleSize(sampleSize),
+      _sourceWidth(sourceWidth),
+      _sourceHeight(sourceHeight) {
+    updateLastAccess();
 }
 
+ImageCacheItem::~ImageCacheItem() = default;
+
 bool ImageCacheItem::isUnused() const {
     return _image->retainCount() == 1;
 }
 
-long ImageCacheItem::getImageSizeInBytes() const {
-    return imageSize(_image);
+size_t ImageCacheItem::getImageSizeInBytes() const {
+    return _imageSizeInBytes;
+}
+
+const Valdi::Ref<Image>& ImageCacheItem::getImage() const {
+    return _image;
 }
 
 const Valdi::Ref<Image>& ImageCacheItem::updateLastAccessAndGetImage() {
@@ -55,8 +71,8 @@ const String& ImageCacheItem::getUrl() const {
     return _url;
 }
 
-Valdi::Ref<ImageCacheItem> ImageCacheItem::getParent() const {
-    return Valdi::strongSmallRef(_parent);
+const Valdi::Ref<ImageCacheItem>& ImageCacheItem::getParent() const {
+    return _parent;
 }
 
 const String& ImageCacheItem::getOriginalUrl() const {
@@ -79,62 +95,41 @@ int ImageCacheItem::getVariantCount() const {
     return static_cast<int>(_variants);
 }
 
-int ImageCacheItem::getWidth() const {
-    return _image->width();
+void ImageCacheItem::addVariant() {
+    _variants++;
 }
 
-int ImageCacheItem::getHeight() const {
-    return _image->height();
+void ImageCacheItem::removeVariant() {
+    SC_ASSERT(_variants > 0);
+    _variants--;
 }
 
-Valdi::Ref<ImageCacheItem> ImageCacheItem::getResized(const String& url, int width, int height) {
-    _variants++;
-    auto strongRef = Valdi::strongSmallRef(this);
-    return Valdi::makeShared<ImageCacheItem>(url, strongRef, _image->resized(width, height));
+int ImageCacheItem::getWidth() const {
+    return _image->width();
 }
 
-bool ImageCacheItem::isExpired(snap::utils::time::Duration<std::chrono::steady_clock> time) const {
-    return time >= _lastAccessed;
+int ImageCacheItem::getHeight() const {
+    return _image->height();
 }
 
-void ImageCacheItem::updateLastAccess() {
-    _lastAccessed = getCurrentTime();
+int ImageCacheItem::getSampleSize() const {
+    return _sampleSize;
 }
 
-void ImageCacheItem::decrementVariants() {
-    _variants--;
+int ImageCacheItem::getSourceWidth() const {
+    return _sourceWidth;
 }
 
-Valdi::Ref<ImageCacheItem> ImageCacheItem::getPrevious() const {
-    return Valdi::strongSmallRef(_previous);
+int ImageCacheItem::getSourceHeight() const {
+    return _sourceHeight;
 }
 
-void ImageCacheItem::insertAfter(const Valdi::Ref<ImageCacheItem>& imageCacheItem) {
-    SC_ASSERT(imageCacheItem->_previous == nullptr && imageCacheItem->_next == nullptr);
-    imageCacheItem->_next = _next;
-    _next = imageCacheItem;
-
-    imageCacheItem->_previous = this;
-    if (imageCacheItem->_next != nullptr) {
-        imageCacheItem->_next->_previous = imageCacheItem.get();
-    }
+bool ImageCacheItem::isExpired(snap::utils::time::Duration<std::chrono::steady_clock> time) const {
+    return time >= _lastAccessed;
 }
 
-Valdi::Ref<ImageCacheItem> ImageCacheItem::disconnectAndReturnPrevious() {
-    auto retval = _previous;
-
-    if (_next != nullptr) {
-        _next->_previous = _previous;
-    }
-
-    if (_previous != nullptr) {
-        _previous->_next = _next;
-    }
-
-    _previous = nullptr;
-    _next = nullptr;
-
-    return Valdi::strongSmallRef(retval);
+void ImageCacheItem::updateLastAccess() {
+    _lastAccessed = getCurrentTime();
 }
 
 } // namespace snap::drawing
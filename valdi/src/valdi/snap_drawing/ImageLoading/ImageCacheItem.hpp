@@ -9,58 +9,68 @@
 
 #include "snap_drawing/cpp/Utils/Aliases.hpp"
 #include "utils/time/Duration.hpp"
+#include "valdi_core/cpp/Utils/LinkedList.hpp"
 
 namespace snap::drawing {
 
 class Image;
 
-class ImageCacheItem : public Valdi::SharedPtrRefCountable {
+/**
+ An entry of the ImageCache, which is either an original decoded image or a resized variant
+ of one. Items are linked in the LRU list of their size class. They are not thread safe and
+ are only accessed while holding the lock of the ImageCache.
+ */
+class ImageCacheItem : public Valdi::LinkedListNode {
 public:
     ImageCacheItem(const String& url, const Ref<ImageCacheItem>& parent, const Ref<Image>& img);
+    // An original that was decoded with the given sample size from an encoded image of sourceWidth x sourceHeight
+    ImageCacheItem(const String& url, const Ref<Image>& img, int sampleSize, int sourceWidth, int sourceHeight);
     ~ImageCacheItem() override;
 
     bool isUnused() const;
 
-    long getImageSizeInBytes() const;
+    size_t getImageSizeInBytes() const;
 
+    const Ref<Image>& getImage() const;
     const Ref<Image>& updateLastAccessAndGetImage();
 
     const String& getUrl() const;
     const String& getOriginalUrl() const;
 
-    Ref<ImageCacheItem> getParent() const;
+    const Ref<ImageCacheItem>& getParent() const;
 
     bool isOriginal() const;
     bool hasVariants() const;
     int getVariantCount() const;
 
+    void addVariant();
+    void removeVariant();
+
     int getWidth() const;
 
     int getHeight() const;
 
-    Ref<ImageCacheItem> getResized(const String& url, int width, int height);
+    int getSampleSize() const;
+    int getSourceWidth() const;
+    int getSourceHeight() const;
 
     bool isExpired(snap::utils::time::Duration<std::chrono::steady_clock> time) const;
 
-    Ref<ImageCacheItem> getPrevious() const;
-    void insertAfter(const Ref<ImageCacheItem>& imageCacheItem);
-    Ref<ImageCacheItem> disconnectAndReturnPrevious();
-
     static snap::utils::time::Duration<std::chrono::steady_clock> getCurrentTime();
     static size_t imageSize(const Ref<Image>& image);
 
 private:
     void updateLastAccess();
-    void decrementVariants();
 
     uint64_t _variants;
     String _url;
-    ImageCacheItem* _parent;
+    Ref<ImageCacheItem> _parent;
     Ref<Image> _image;
+    size_t _imageSizeInBytes;
+    int _sampleSize;
+    int _sourceWidth;
+    int _sourceHeight;
     snap::utils::time::Duration<std::chrono::steady_clock> _lastAccessed;
-
-    ImageCacheItem* _previous;
-    Ref<ImageCacheItem> _next;
 };
 
 } // namespace snap::drawing
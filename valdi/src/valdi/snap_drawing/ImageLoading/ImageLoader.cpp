@@ -19,10 +19,15 @@
 
 #include "valdi_core/cpp/Constants.hpp"
 
+#include <algorithm>
 #include <utility>
 
 namespace snap::drawing {
 
+// Resized variants are typically the thumbnails of feeds. Giving them their own half of the
+// budget prevents a few large originals from evicting all of them.
+constexpr size_t kVariantsBudgetDivisor = 2;
+
 class ImageLoaderTaskCancelable : public snap::valdi_core::Cancelable {
 public:
     explicit ImageLoaderTaskCancelable(const Valdi::Ref<ImageLoaderTask>& task) : _task(task.toWeak()) {}
@@ -39,7 +44,11 @@ private:
 };
 
 ImageLoader::ImageLoader(const Valdi::Ref<Valdi::DispatchQueue>& queue, Valdi::ILogger& logger, size_t maxSize)
-    : _queue(queue), _logger(logger), _cache(logger, maxSize), _reclamationInterval(0) {}
+    : _queue(queue),
+      _decodeExecutor(Valdi::WorkStealingExecutor::getShared()),
+      _logger(logger),
+      _cache(logger, maxSize - maxSize / kVariantsBudgetDivisor, maxSize / kVariantsBudgetDivisor),
+      _reclamationInterval(0) {}
 
 ImageLoader::~ImageLoader() = default;
 
@@ -141,16 +150,123 @@ void ImageLoader::loadImageFromBytes(const Ref<ImageLoaderTask>& task, const Val
         return;
     }
 
-    auto result = Image::make(bytes);
-    if (!result) {
-        handleImageLoadResult(task, result.error());
-        return;
+    {
+        std::lock_guard<Valdi::Mutex> guard(_mutex);
+        auto& pendingTasks = _pendingDecodes[task->getUrl()];
+        pendingTasks.emplace_back(task);
+        if (pendingTasks.size() > 1) {
+            // The same image is already being decoded
+            return;
+        }
+    }
+
+    _decodeExecutor->submit(
+        [weakThis = Valdi::weakRef(this), url = task->getUrl(), bytes]() {
+            auto strongThis = weakThis.lock();
+            int preferredWidth = 0;
+            int preferredHeight = 0;
+            if (strongThis == nullptr || !strongThis->getPendingDecodeSize(url, preferredWidth, preferredHeight)) {
+                return;
+            }
+
+            auto result = Image::makeSubsampled(bytes, preferredWidth, preferredHeight);
+            strongThis->_queue->async([weakThis, url, bytes, result]() {
+                if (auto strongThis = weakThis.lock()) {
+                    strongThis->handleDecodedImage(url, bytes, result);
+                }
+            });
+        },
+        Valdi::ThreadQoSClassNormal);
+}
+
+bool ImageLoader::getPendingDecodeSize(const Valdi::StringBox& url, int& preferredWidth, int& preferredHeight) {
+    std::lock_guard<Valdi::Mutex> guard(_mutex);
+    const auto& it = _pendingDecodes.find(url);
+    if (it == _pendingDecodes.end()) {
+        return false;
+    }
+
+    bool hasTasks = false;
+    bool needsFullSize = false;
+    bool scalesOnWidth = false;
+    bool scalesOnHeight = false;
+    for (const auto& task : it->second) {
+        if (task->wasCanceled()) {
+            continue;
+        }
+        hasTasks = true;
+
+        auto taskWidth = task->getPreferredWidth();
+        auto taskHeight = task->getPreferredHeight();
+        if (taskWidth <= 0 && taskHeight <= 0) {
+            needsFullSize = true;
+        } else if (taskWidth >= taskHeight) {
+            scalesOnWidth = true;
+        } else {
+            scalesOnHeight = true;
+        }
+        preferredWidth = std::max(preferredWidth, static_cast<int>(taskWidth));
+        preferredHeight = std::max(preferredHeight, static_cast<int>(taskHeight));
+    }
+
+    if (!hasTasks) {
+        _pendingDecodes.erase(it);
+        return false;
     }
 
-    imgResult = _cache.setCachedItemAndGetResizedImage(
-        task->getUrl(), result.value(), task->getPreferredWidth(), task->getPreferredHeight());
+    // The sample size is computed from a single axis, a size that satisfies every task
+    // only exists when they all scale on the same one.
+    if (needsFullSize || (scalesOnWidth && scalesOnHeight)) {
+        preferredWidth = 0;
+        preferredHeight = 0;
+    }
 
-    handleImageLoadResult(task, imgResult);
+    return true;
+}
+
+void ImageLoader::handleDecodedImage(const Valdi::StringBox& url,
+                                     const Valdi::BytesView& bytes,
+                                     const Valdi::Result<SubsampledImage>& result) {
+    std::vector<Ref<ImageLoaderTask>> tasks;
+    {
+        std::lock_guard<Valdi::Mutex> guard(_mutex);
+        const auto& it = _pendingDecodes.find(url);
+        if (it == _pendingDecodes.end()) {
+            return;
+        }
+        tasks = std::move(it->second);
+        _pendingDecodes.erase(it);
+    }
+
+    bool didCacheImage = false;
+    for (const auto& task : tasks) {
+        if (task->wasCanceled()) {
+            continue;
+        }
+
+        if (!result) {
+            handleImageLoadResult(task, result.error());
+            continue;
+        }
+
+        Valdi::Result<CachedImage> imgResult;
+        if (didCacheImage) {
+            imgResult = _cache.getResizedCachedImage(url, task->getPreferredWidth(), task->getPreferredHeight());
+        } else {
+            imgResult = _cache.setSubsampledCachedItemAndGetResizedImage(
+                url, result.value(), task->getPreferredWidth(), task->getPreferredHeight());
+            didCacheImage = true;
+        }
+
+        if (!imgResult) {
+            // The task was enqueued after the decode started and needs a larger image,
+            // or the image was evicted in the meantime.
+            loadImageFromBytes(task, bytes);
+            continue;
+        }
+
+        handleImageLoadResult(task, imgResult);
+    }
 }
 
 void ImageLoader::setReclamationInterval(size_t expirationTime) {
@@ -164,6 +280,10 @@ void ImageLoader::setReclamationInterval(size_t expirationTime) {
     }
 }
 
+void ImageLoader::setMetrics(const Valdi::Ref<Valdi::Metrics>& metrics) {
+    _cache.setMetrics(metrics);
+}
+
 void ImageLoader::scheduleReclamation() {
     if (VALDI_LIKELY(_reclamationInterval)) {
         _queue->asyncAfter(
@@ -13,11 +13,20 @@
 #include "valdi/runtime/Resources/AssetLoaderFactory.hpp"
 #include "valdi/snap_drawing/ImageLoading/ImageCache.hpp"
 #include "valdi_core/cpp/Threading/DispatchQueue.hpp"
+#include "valdi_core/cpp/Threading/WorkStealingExecutor.hpp"
+#include "valdi_core/cpp/Utils/FlatMap.hpp"
 #include "valdi_core/cpp/Utils/Mutex.hpp"
 
+#include <vector>
+
+namespace Valdi {
+class Metrics;
+}
+
 namespace snap::drawing {
 
 class Image;
+struct SubsampledImage;
 
 class ImageLoaderTask;
 
@@ -33,6 +42,8 @@ public:
 
     void setReclamationInterval(size_t expirationTime);
 
+    void setMetrics(const Valdi::Ref<Valdi::Metrics>& metrics);
+
     Valdi::Shared<snap::valdi_core::Cancelable> loadAsset(const Valdi::StringBox& url,
                                                           int32_t preferredWidth,
                                                           int32_t preferredHeight,
@@ -43,8 +54,13 @@ public:
 private:
     mutable Valdi::Mutex _mutex;
     Valdi::Ref<Valdi::DispatchQueue> _queue;
+    // Decoding runs concurrently on the executor, while tasks are processed on _queue.
+    Valdi::Ref<Valdi::WorkStealingExecutor> _decodeExecutor;
     [[maybe_unused]] Valdi::ILogger& _logger;
     ImageCache _cache;
+    // Tasks waiting for the decode of a URL, guarded by _mutex. Only the first task of a URL
+    // submits a decode, the others wait for its result.
+    Valdi::FlatMap<Valdi::StringBox, std::vector<Ref<ImageLoaderTask>>> _pendingDecodes;
 
     size_t _reclamationInterval;
 
@@ -56,6 +72,14 @@ private:
 
     void loadImageFromBytes(const Ref<ImageLoaderTask>& task, const Valdi::BytesView& bytes);
 
+    void handleDecodedImage(const Valdi::StringBox& url,
+                            const Valdi::BytesView& bytes,
+                            const Valdi::Result<SubsampledImage>& result);
+
+    // Returns the size at which the image should be decoded to satisfy all the pending tasks of the url,
+    // or false if none of them are still pending.
+    bool getPendingDecodeSize(const Valdi::StringBox& url, int& preferredWidth, int& preferredHeight);
+
     void scheduleReclamation();
 };
 
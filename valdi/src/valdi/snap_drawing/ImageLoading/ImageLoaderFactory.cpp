@@ -23,15 +23,17 @@ Valdi::Ref<ImageLoader> createImageLoader(const Valdi::Ref<Valdi::DispatchQueue>
     return imageLoader;
 }
 
-void registerAssetLoaders(Valdi::AssetLoaderManager& assetLoaderManager,
-                          const Ref<Resources>& resources,
-                          const Valdi::Ref<Valdi::DispatchQueue>& queue,
-                          Valdi::ILogger& logger,
-                          uint64_t maxCacheSizeInBytes) {
+Valdi::Ref<ImageLoader> registerAssetLoaders(Valdi::AssetLoaderManager& assetLoaderManager,
+                                             const Ref<Resources>& resources,
+                                             const Valdi::Ref<Valdi::DispatchQueue>& queue,
+                                             Valdi::ILogger& logger,
+                                             uint64_t maxCacheSizeInBytes) {
     auto imageLoader = createImageLoader(queue, logger, maxCacheSizeInBytes);
 
     assetLoaderManager.registerAssetLoaderFactory(imageLoader);
     assetLoaderManager.registerAssetLoaderFactory(Valdi::makeShared<AnimatedImageLoaderFactory>(resources));
+
+    return imageLoader;
 }
 
 } // namespace snap::drawing
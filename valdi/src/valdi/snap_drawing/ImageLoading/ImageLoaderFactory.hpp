@@ -26,10 +26,10 @@ Ref<ImageLoader> createImageLoader(const Valdi::Ref<Valdi::DispatchQueue>& queue
                                    Valdi::ILogger& logger,
                                    uint64_t maxCacheSizeInBytes);
 
-void registerAssetLoaders(Valdi::AssetLoaderManager& assetLoaderManager,
-                          const Ref<Resources>& resources,
-                          const Valdi::Ref<Valdi::DispatchQueue>& queue,
-                          Valdi::ILogger& logger,
-                          uint64_t maxCacheSizeInBytes);
+Ref<ImageLoader> registerAssetLoaders(Valdi::AssetLoaderManager& assetLoaderManager,
+                                      const Ref<Resources>& resources,
+                                      const Valdi::Ref<Valdi::DispatchQueue>& queue,
+                                      Valdi::ILogger& logger,
+                                      uint64_t maxCacheSizeInBytes);
 
 } // namespace snap::drawing
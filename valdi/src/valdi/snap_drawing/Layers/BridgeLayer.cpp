@@ -194,4 +194,9 @@ bool BridgeLayer::hitTest(const Point& point) const {
     }
 }
 
+bool BridgeLayer::hasCustomHitTest() const {
+    // The bridged view decides whether it is hit
+    return true;
+}
+
 } // namespace snap::drawing
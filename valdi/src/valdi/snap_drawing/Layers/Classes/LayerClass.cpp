@@ -192,18 +192,23 @@ void LayerClass::bindAttributes(Valdi::AttributesBindingContext& binder) {
 Valdi::Result<Valdi::Void> LayerClass::apply_backgroundColor(Layer& view,
                                                              int64_t value,
                                                              const AttributeContext& context) {
-    context.setAnimatableAttribute(view,
-                                   &Layer::getBackgroundColor,
-                                   &Layer::setBackgroundColor,
-                                   MIN_VISIBLE_CHANGE_COLOR,
-                                   snapDrawingColorFromValdiColor(value));
+    context.setAnimatableProperty(view,
+                                  AnimatedProperty::BackgroundColor,
+                                  &Layer::getBackgroundColor,
+                                  &Layer::setBackgroundColor,
+                                  MIN_VISIBLE_CHANGE_COLOR,
+                                  snapDrawingColorFromValdiColor(value));
     return Valdi::Void();
 }
 
 // NOLINTNEXTLINE(readability-identifier-naming, readability-convert-member-functions-to-static)
 void LayerClass::reset_backgroundColor(Layer& view, const AttributeContext& context) {
-    context.setAnimatableAttribute(
-        view, &Layer::getBackgroundColor, &Layer::setBackgroundColor, MIN_VISIBLE_CHANGE_COLOR, Color::transparent());
+    context.setAnimatableProperty(view,
+                                  AnimatedProperty::BackgroundColor,
+                                  &Layer::getBackgroundColor,
+                                  &Layer::setBackgroundColor,
+                                  MIN_VISIBLE_CHANGE_COLOR,
+                                  Color::transparent());
 }
 
 // NOLINTNEXTLINE(readability-identifier-naming, readability-convert-member-functions-to-static)
@@ -234,26 +239,31 @@ void LayerClass::reset_borderRadius(Layer& view, const AttributeContext& context
 
 // NOLINTNEXTLINE(readability-identifier-naming, readability-convert-member-functions-to-static)
 Valdi::Result<Valdi::Void> LayerClass::apply_opacity(Layer& view, double opacity, const AttributeContext& context) {
-    context.setAnimatableAttribute(
-        view, &Layer::getOpacity, &Layer::setOpacity, MIN_VISIBLE_CHANGE_COLOR, static_cast<Scalar>(opacity));
+    context.setAnimatableProperty(view,
+                                  AnimatedProperty::Opacity,
+                                  &Layer::getOpacity,
+                                  &Layer::setOpacity,
+                                  MIN_VISIBLE_CHANGE_COLOR,
+                                  static_cast<Scalar>(opacity));
     return Valdi::Void();
 }
 
 // NOLINTNEXTLINE(readability-identifier-naming, readability-convert-member-functions-to-static)
 void LayerClass::reset_opacity(Layer& view, const AttributeContext& context) {
-    context.setAnimatableAttribute(view, &Layer::getOpacity, &Layer::setOpacity, MIN_VISIBLE_CHANGE_COLOR, 1.0f);
+    context.setAnimatableProperty(
+        view, AnimatedProperty::Opacity, &Layer::getOpacity, &Layer::setOpacity, MIN_VISIBLE_CHANGE_COLOR, 1.0f);
 }
 
 namespace {
 
-template<typename T, typename V>
-void setAnimatableTransformAttribute(T& view,
+void setAnimatableTransformAttribute(Layer& view,
                                      const AttributeContext& context,
-                                     V (T::*getter)() const,
-                                     void (T::*setter)(V),
+                                     AnimatedProperty property,
+                                     Scalar (Layer::*getter)() const,
+                                     void (Layer::*setter)(Scalar),
                                      double minVisibleChange,
-                                     V value) {
-    context.setAnimatableAttribute(view, getter, setter, minVisibleChange, value);
+                                     Scalar value) {
+    context.setAnimatableProperty(view, property, getter, setter, minVisibleChange, value);
 }
 
 void setTransformAttributes(Layer& view,
@@ -271,6 +281,7 @@ void setTransformAttributes(Layer& view,
 
     setAnimatableTransformAttribute(view,
                                     context.withAttributeName(kTranslationXName),
+                                    AnimatedProperty::TranslationX,
                                     &Layer::getTranslationX,
                                     &Layer::setTranslationX,
                                     MIN_VISIBLE_CHANGE_PIXEL,
@@ -278,6 +289,7 @@ void setTransformAttributes(Layer& view,
 
     setAnimatableTransformAttribute(view,
                                     context.withAttributeName(kTranslationYName),
+                                    AnimatedProperty::TranslationY,
                                     &Layer::getTranslationY,
                                     &Layer::setTranslationY,
                                     MIN_VISIBLE_CHANGE_PIXEL,
@@ -285,6 +297,7 @@ void setTransformAttributes(Layer& view,
 
     setAnimatableTransformAttribute(view,
                                     context.withAttributeName(kScaleXName),
+                                    AnimatedProperty::ScaleX,
                                     &Layer::getScaleX,
                                     &Layer::setScaleX,
                                     MIN_VISIBLE_CHANGE_SCALE_RATIO,
@@ -292,6 +305,7 @@ void setTransformAttributes(Layer& view,
 
     setAnimatableTransformAttribute(view,
                                     context.withAttributeName(kScaleYName),
+                                    AnimatedProperty::ScaleY,
                                     &Layer::getScaleY,
                                     &Layer::setScaleY,
                                     MIN_VISIBLE_CHANGE_SCALE_RATIO,
@@ -299,6 +313,7 @@ void setTransformAttributes(Layer& view,
 
     setAnimatableTransformAttribute(view,
                                     context.withAttributeName(kRotationName),
+                                    AnimatedProperty::Rotation,
                                     &Layer::getRotation,
                                     &Layer::setRotation,
                                     MIN_VISIBLE_CHANGE_ROTATION_DEGREES_ANGLE,
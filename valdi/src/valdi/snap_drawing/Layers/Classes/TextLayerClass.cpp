@@ -162,6 +162,11 @@ Size TextLayerClass::onMeasure(const Valdi::Value& attributes, Size maxSize, boo
     return Size::make(textSize.width / displayScale, textSize.height / displayScale);
 }
 
+bool TextLayerClass::isThreadSafe() const {
+    // Text layouts only share the FontManager and the shapers, which are synchronized
+    return true;
+}
+
 void TextLayerClass::bindAttributes(Valdi::AttributesBindingContext& binder) {
     std::vector<snap::valdi_core::CompositeAttributePart> parts;
     parts.emplace_back(STRING_LITERAL("fontSize"), snap::valdi_core::AttributeType::Double, true, true);
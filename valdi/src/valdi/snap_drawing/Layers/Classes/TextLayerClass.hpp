@@ -23,6 +23,7 @@ public:
     bool managesChildFrames() const override;
 
     Size onMeasure(const Valdi::Value& attributes, Size maxSize, bool isRightToLeft) override;
+    bool isThreadSafe() const override;
 
     void bindAttributes(Valdi::AttributesBindingContext& binder) override;
 
@@ -20,8 +20,10 @@
 #include "valdi/runtime/Context/IViewNodesAssetTracker.hpp"
 #include "valdi/runtime/Context/ViewManagerContext.hpp"
 #include "valdi/runtime/Runtime.hpp"
+#include "valdi/runtime/ValdiRuntimeTweaks.hpp"
 #include "valdi/snap_drawing/Utils/ValdiUtils.hpp"
 #include "valdi_core/cpp/Interfaces/IBitmap.hpp"
+#include "valdi_core/cpp/Threading/WorkStealingExecutor.hpp"
 #include "valdi_core/cpp/Utils/StringCache.hpp"
 #include "valdi_core/cpp/Utils/ValueArrayBuilder.hpp"
 #include "valdi_core/cpp/Utils/ValueFunctionWithMethod.hpp"
@@ -102,6 +104,14 @@ public:
                                                               ExternalSurfaceRasterizationMethod::FAST,
                                                           enableDeltaRasterization)),
           _useNewExternalSurfaceRasterMethod(useNewExternalSurfaceRasterMethod) {
+        auto runtimeTweaks = runtime->getRuntimeTweaks();
+        if (runtimeTweaks != nullptr) {
+            _rasterContext->setRasterTileCacheEnabled(runtimeTweaks->enableRasterTileCache());
+            if (runtimeTweaks->enableParallelRaster()) {
+                _rasterContext->setParallelRasterExecutor(Valdi::WorkStealingExecutor::getShared());
+            }
+        }
+
         auto rootLayer = valdiViewToLayer(_viewNodeTree->getRootView());
         if (rootLayer != nullptr) {
             rootLayer->onParentChanged(_layerRoot);
@@ -6,12 +6,18 @@
 //
 
 #include "valdi/snap_drawing/Runtime.hpp"
+#include "valdi/runtime/Interfaces/IDiskCache.hpp"
+#include "valdi/runtime/Metrics/Metrics.hpp"
+#include "valdi/runtime/ValdiRuntimeTweaks.hpp"
 #include "valdi/snap_drawing/Graphics/ShaderCache.hpp"
+#include "valdi/snap_drawing/ImageLoading/ImageLoader.hpp"
 #include "valdi/snap_drawing/ImageLoading/ImageLoaderFactory.hpp"
 #include "valdi/snap_drawing/SnapDrawingViewManager.hpp"
+#include "valdi/snap_drawing/Text/TextShaperCacheStore.hpp"
 
 #include "snap_drawing/cpp/Drawing/DrawLooper.hpp"
 #include "snap_drawing/cpp/Text/FontManager.hpp"
+#include "snap_drawing/cpp/Utils/AnimatedImageFrameCache.hpp"
 
 namespace snap::drawing {
 
@@ -24,6 +30,7 @@ Runtime::Runtime(const Ref<IFrameScheduler>& frameScheduler,
                  uint64_t maxCacheSizeInBytes)
     : _frameScheduler(frameScheduler),
       _workerQueue(workerQueue),
+      _diskCache(diskCache),
       _hostViewManager(hostViewManager),
       _maxCacheSizeInBytes(maxCacheSizeInBytes) {
     _drawLooper = Valdi::makeShared<snap::drawing::DrawLooper>(_frameScheduler, logger);
@@ -35,6 +42,7 @@ Runtime::Runtime(const Ref<IFrameScheduler>& frameScheduler,
     }
 
     _fontManager = Valdi::makeShared<snap::drawing::FontManager>(logger);
+
     _resources = Valdi::makeShared<Resources>(_fontManager,
                                               hostViewManager != nullptr ? hostViewManager->getPointScale() : 1.0f,
                                               gesturesConfiguration,
@@ -61,9 +69,66 @@ void Runtime::initializeViewManager(Valdi::PlatformType platformType) {
 void Runtime::registerAssetLoaders(Valdi::AssetLoaderManager& assetLoaderManager) {
     auto& logger = _resources->getLogger();
     auto queue =
-        Valdi::DispatchQueue::create(STRING_LITERAL("com.snap.valdi.ImageLoader"), Valdi::ThreadQoSClassNormal);
+        Valdi::DispatchQueue::createStrand(STRING_LITERAL("com.snap.valdi.ImageLoader"), Valdi::ThreadQoSClassNormal);
+
+    _imageLoader =
+        snap::drawing::registerAssetLoaders(assetLoaderManager, _resources, queue, logger, _maxCacheSizeInBytes);
+}
+
+void Runtime::setMetrics(const Valdi::Ref<Valdi::Metrics>& metrics) {
+    if (_imageLoader != nullptr) {
+        _imageLoader->setMetrics(metrics);
+    }
+}
+
+void Runtime::enablePersistentTextShaperCache() {
+    if (_diskCache == nullptr || _textShaperCacheStore != nullptr) {
+        return;
+    }
+
+    // Warm up the text shaper cache with the snapshot saved by the previous session
+    auto filePath = _diskCache->getRootPath().appending("text_shaper").appending("snapshot.bin");
+    _textShaperCacheStore = Valdi::makeShared<TextShaperCacheStore>(filePath, _resources->getLogger());
+
+    auto load = [store = _textShaperCacheStore, fontManager = _fontManager]() { store->load(*fontManager); };
+    if (_workerQueue != nullptr) {
+        _workerQueue->async(std::move(load));
+    } else {
+        load();
+    }
+}
 
-    snap::drawing::registerAssetLoaders(assetLoaderManager, _resources, queue, logger, _maxCacheSizeInBytes);
+void Runtime::savePersistentTextShaperCache() const {
+    if (_textShaperCacheStore == nullptr) {
+        return;
+    }
+
+    auto save = [store = _textShaperCacheStore, fontManager = _fontManager]() { store->save(*fontManager); };
+    if (_workerQueue != nullptr) {
+        _workerQueue->async(std::move(save));
+    } else {
+        save();
+    }
+}
+
+void Runtime::enableAnimatedImageFrameCache(size_t maxBytes) {
+    if (_resources->getAnimatedImageFrameCache() != nullptr) {
+        _resources->getAnimatedImageFrameCache()->setMaxBytes(maxBytes);
+        return;
+    }
+
+    auto prewarmQueue = Valdi::DispatchQueue::createStrand(STRING_LITERAL("com.snap.valdi.AnimatedImageFrameCache"),
+                                                           Valdi::ThreadQoSClassLow);
+    _resources->setAnimatedImageFrameCache(Valdi::makeShared<AnimatedImageFrameCache>(maxBytes, prewarmQueue));
+}
+
+void Runtime::setRuntimeTweaks(const Valdi::Ref<Valdi::ValdiRuntimeTweaks>& runtimeTweaks) {
+    if (runtimeTweaks != nullptr && runtimeTweaks->enableAnimatedImageFrameCache()) {
+        enableAnimatedImageFrameCache(AnimatedImageFrameCache::kDefaultMaxBytes);
+    }
+    if (runtimeTweaks != nullptr && runtimeTweaks->enablePersistentTextShaperCache()) {
+        enablePersistentTextShaperCache();
+    }
 }
 
 const Ref<IFrameScheduler>& Runtime::getFrameScheduler() const {
@@ -20,6 +20,8 @@ class IViewManager;
 class ILogger;
 class DispatchQueue;
 class AssetLoaderManager;
+class Metrics;
+class ValdiRuntimeTweaks;
 } // namespace Valdi
 
 namespace snap::drawing {
@@ -31,6 +33,8 @@ class ShaderCache;
 class DrawLooper;
 class Resources;
 class GraphicsContext;
+class TextShaperCacheStore;
+class ImageLoader;
 struct GesturesConfiguration;
 
 class Runtime : public Valdi::SimpleRefCountable {
@@ -50,6 +54,37 @@ public:
 
     void registerAssetLoaders(Valdi::AssetLoaderManager& assetLoaderManager);
 
+    /**
+     * Sets the metrics that receive the hit, miss and eviction counters of the image cache.
+     * Must be called after registerAssetLoaders().
+     */
+    void setMetrics(const Valdi::Ref<Valdi::Metrics>& metrics);
+
+    /**
+     * Opt-in persistence of the text shaper cache into the disk cache. Restores the snapshot
+     * that was saved by a previous session on the worker queue. Does nothing if there is no disk cache.
+     */
+    void enablePersistentTextShaperCache();
+
+    /**
+     * Saves a snapshot of the text shaper cache on the worker queue, if the persistent
+     * text shaper cache was enabled. Called when the app goes to the background.
+     */
+    void savePersistentTextShaperCache() const;
+
+    /**
+     * Opt-in rasterized frame cache shared by all the animated images, like Lottie animations and
+     * animated GIF/WebP images. Frames are rendered once per size and reused across layers, and the
+     * next frames are pre-rendered on a background queue.
+     */
+    void enableAnimatedImageFrameCache(size_t maxBytes);
+
+    /**
+     * Applies the tweaks which configure the SnapDrawing runtime, like the animated image frame cache
+     * and the persistent text shaper cache.
+     */
+    void setRuntimeTweaks(const Valdi::Ref<Valdi::ValdiRuntimeTweaks>& runtimeTweaks);
+
     const Ref<IFrameScheduler>& getFrameScheduler() const;
 
     const Ref<SnapDrawingViewManager>& getViewManager() const;
@@ -75,6 +110,9 @@ private:
     Valdi::Ref<Valdi::DispatchQueue> _workerQueue;
     Valdi::Ref<GraphicsContext> _graphicsContext;
     Valdi::Ref<Resources> _resources;
+    Valdi::Ref<Valdi::IDiskCache> _diskCache;
+    Valdi::Ref<TextShaperCacheStore> _textShaperCacheStore;
+    Valdi::Ref<ImageLoader> _imageLoader;
     Valdi::IViewManager* _hostViewManager;
     uint64_t _maxCacheSizeInBytes;
 };
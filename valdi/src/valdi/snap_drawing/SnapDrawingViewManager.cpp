@@ -461,23 +461,32 @@ Valdi::NativeAnimator SnapDrawingViewManager::createAnimator(snap::valdi_core::A
                                                              double stiffness,
                                                              double damping) {
     InterpolationFunction interpolationFunction;
+    std::optional<TimingCurve> timingCurve;
     switch (type) {
         case snap::valdi_core::AnimationType::Linear:
             interpolationFunction = InterpolationFunctions::linear();
+            timingCurve = TimingCurve::linear();
             break;
         case snap::valdi_core::AnimationType::EaseIn:
             interpolationFunction = InterpolationFunctions::easeIn();
+            timingCurve = TimingCurve::easeIn();
             break;
         case snap::valdi_core::AnimationType::EaseOut:
             interpolationFunction = InterpolationFunctions::easeOut();
+            timingCurve = TimingCurve::easeOut();
             break;
         case snap::valdi_core::AnimationType::EaseInOut:
             interpolationFunction = InterpolationFunctions::easeInOut();
+            timingCurve = TimingCurve::easeInOut();
             break;
     }
 
-    return Valdi::makeShared<ValdiAnimator>(
-               Duration(duration), std::move(interpolationFunction), beginFromCurrentState, stiffness, damping)
+    return Valdi::makeShared<ValdiAnimator>(Duration(duration),
+                                            std::move(interpolationFunction),
+                                            timingCurve,
+                                            beginFromCurrentState,
+                                            stiffness,
+                                            damping)
         .toShared();
 }
 
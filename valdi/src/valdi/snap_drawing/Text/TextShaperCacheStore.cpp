@@ -0,0 +1,59 @@
+//
+//  TextShaperCacheStore.cpp
+//  valdi-snap_drawing
+//
+
+#include "valdi/snap_drawing/Text/TextShaperCacheStore.hpp"
+#include "valdi/runtime/Resources/MmapBuffer.hpp"
+
+#include "snap_drawing/cpp/Text/FontManager.hpp"
+
+#include "valdi_core/cpp/Utils/DiskUtils.hpp"
+#include "valdi_core/cpp/Utils/LoggerUtils.hpp"
+#include "valdi_core/cpp/Utils/Trace.hpp"
+
+namespace snap::drawing {
+
+TextShaperCacheStore::TextShaperCacheStore(const Valdi::Path& filePath, Valdi::ILogger& logger)
+    : _filePath(filePath), _logger(logger) {}
+
+TextShaperCacheStore::~TextShaperCacheStore() = default;
+
+void TextShaperCacheStore::load(FontManager& fontManager) const {
+    VALDI_TRACE("SnapDrawing.loadTextShaperCacheStore");
+
+    if (!Valdi::DiskUtils::isFile(_filePath)) {
+        return;
+    }
+
+    auto buffer = Valdi::MmapBuffer::openReadOnly(_filePath);
+    if (!buffer) {
+        VALDI_WARN(_logger, "Failed to open text shaper cache snapshot: {}", buffer.error());
+        return;
+    }
+
+    auto result = fontManager.loadTextShaperCacheSnapshot(buffer.value()->toBytesView());
+    if (!result) {
+        VALDI_WARN(_logger, "Discarding text shaper cache snapshot: {}", result.error());
+        Valdi::DiskUtils::remove(_filePath);
+    }
+}
+
+void TextShaperCacheStore::save(const FontManager& fontManager) const {
+    VALDI_TRACE("SnapDrawing.saveTextShaperCacheStore");
+
+    auto snapshot = fontManager.makeTextShaperCacheSnapshot();
+    if (snapshot.empty()) {
+        return;
+    }
+
+    Valdi::DiskUtils::makeDirectory(_filePath.removingLastComponent(), true);
+
+    // The snapshot is replaced atomically, a process mapping the previous snapshot never observes a partial write.
+    auto result = Valdi::DiskUtils::storeAtomically(_filePath, snapshot);
+    if (!result) {
+        VALDI_WARN(_logger, "Failed to write text shaper cache snapshot: {}", result.error());
+    }
+}
+
+} // namespace snap::drawing
@@ -0,0 +1,45 @@
+//
+//  TextShaperCacheStore.hpp
+//  valdi-snap_drawing
+//
+
+#pragma once
+
+#include "valdi_core/cpp/Utils/PathUtils.hpp"
+#include "valdi_core/cpp/Utils/Shared.hpp"
+
+namespace Valdi {
+class ILogger;
+}
+
+namespace snap::drawing {
+
+class FontManager;
+
+/**
+ * Persists snapshots of the FontManager's text shaper cache in a memory mapped file,
+ * so that the shaping results of the most commonly used words survive a cold start.
+ */
+class TextShaperCacheStore : public Valdi::SimpleRefCountable {
+public:
+    TextShaperCacheStore(const Valdi::Path& filePath, Valdi::ILogger& logger);
+    ~TextShaperCacheStore() override;
+
+    /**
+     * Maps the snapshot file, if it exists, and loads it into the given FontManager.
+     * A snapshot that cannot be parsed is removed.
+     */
+    void load(FontManager& fontManager) const;
+
+    /**
+     * Writes a snapshot of the current text shaper cache of the given FontManager,
+     * replacing the previous snapshot.
+     */
+    void save(const FontManager& fontManager) const;
+
+private:
+    Valdi::Path _filePath;
+    [[maybe_unused]] Valdi::ILogger& _logger;
+};
+
+} // namespace snap::drawing
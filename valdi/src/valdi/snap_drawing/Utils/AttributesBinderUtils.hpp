@@ -78,6 +78,27 @@ public:
                                });
     }
 
+    /**
+     Set an attribute backed by one of the well known AnimatedProperty of the layer. When animated with a
+     timing curve, the animation is created as a PropertyAnimation which is evaluated in bulk by the
+     AnimationEngine of the layer root.
+     */
+    template<typename T, typename V>
+    void setAnimatableProperty(T& view,
+                               AnimatedProperty property,
+                               V (T::*getter)() const,
+                               void (T::*setter)(V),
+                               double minVisibleChange,
+                               V value) const {
+        if (animator == nullptr || !animator->supportsPropertyAnimations()) {
+            setAnimatableAttribute(view, getter, setter, minVisibleChange, value);
+            return;
+        }
+
+        view.removeAnimation(attributeName);
+        animator->createAndAppendPropertyAnimation(view, attributeName, property, (view.*getter)(), value);
+    }
+
 private:
     AttributeContext(const Valdi::Shared<ValdiAnimator>& animator, const Valdi::StringBox& attributeName);
 };
@@ -6,6 +6,7 @@
 //
 
 #include "valdi/standalone_runtime/InMemoryDiskCache.hpp"
+#include "valdi_core/cpp/Utils/ByteBuffer.hpp"
 #include "valdi_core/cpp/Utils/FlatSet.hpp"
 #include "valdi_core/cpp/Utils/Format.hpp"
 #include "valdi_core/cpp/Utils/Shared.hpp"
@@ -30,6 +31,10 @@ Result<BytesView> InMemoryDiskCache::load(const Path& path) {
     return getForAbsolutePath(resolveFileKey(path));
 }
 
+Result<BytesView> InMemoryDiskCache::loadMapped(const Path& path) {
+    return load(path);
+}
+
 Path InMemoryDiskCache::getRootPath() const {
     return _rootPath;
 }
@@ -95,6 +100,26 @@ Result<Void> InMemoryDiskCache::store(const Path& path, const BytesView& bytes)
     return Void();
 }
 
+Result<Void> InMemoryDiskCache::storeAtomically(const Path& path, const BytesView& bytes) {
+    // Entries are always replaced as a whole
+    return store(path, bytes);
+}
+
+Result<Void> InMemoryDiskCache::append(const Path& path, const BytesView& bytes) {
+    auto fileKey = resolveFileKey(path);
+
+    std::lock_guard<Mutex> guard(_cache->mutex);
+    auto& entry = _cache->entries[fileKey];
+
+    auto output = makeShared<ByteBuffer>();
+    output->reserve(entry.size() + bytes.size());
+    output->append(entry.begin(), entry.end());
+    output->append(bytes.begin(), bytes.end());
+    entry = output->toBytesView();
+
+    return Void();
+}
+
 bool InMemoryDiskCache::exists(const Path& path) {
     auto fileKey = resolveFileKey(path);
     std::lock_guard<Mutex> guard(_cache->mutex);
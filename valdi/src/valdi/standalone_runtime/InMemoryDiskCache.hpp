@@ -33,10 +33,16 @@ public:
 
     Result<BytesView> load(const Path& path) override;
 
+    Result<BytesView> loadMapped(const Path& path) override;
+
     Result<BytesView> loadForAbsoluteURL(const StringBox& url) override;
 
     Result<Void> store(const Path& path, const BytesView& bytes) override;
 
+    Result<Void> storeAtomically(const Path& path, const BytesView& bytes) override;
+
+    Result<Void> append(const Path& path, const BytesView& bytes) override;
+
     bool remove(const Path& path) override;
 
     StringBox getAbsoluteURL(const Path& path) const override;
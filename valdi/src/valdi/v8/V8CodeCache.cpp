@@ -0,0 +1,66 @@
+//
+//  V8CodeCache.cpp
+//  valdi-v8
+//
+
+#include "valdi/v8/V8CodeCache.hpp"
+#include "valdi/runtime/Utils/BytesUtils.hpp"
+#include "valdi_core/cpp/Utils/ByteBuffer.hpp"
+#include "valdi_core/cpp/Utils/Format.hpp"
+
+namespace Valdi::V8 {
+
+V8CodeCache::V8CodeCache(const Ref<IDiskCache>& diskCache)
+    : _diskCache(diskCache->scopedCache(
+          Path(fmt::format("v8_{}", v8::ScriptCompiler::CachedDataVersionTag())), false)) {
+    // Caches produced by a different V8 version or configuration would always be rejected
+    auto rootPath = diskCache->getRootPath();
+    auto currentRootPath = _diskCache->getRootPath();
+    for (const auto& folder : diskCache->list(rootPath)) {
+        if (folder != currentRootPath) {
+            diskCache->remove(folder);
+        }
+    }
+}
+
+V8CodeCache::~V8CodeCache() = default;
+
+Path V8CodeCache::getCachePath(const std::string_view& source) const {
+    return Path(BytesUtils::sha256String(reinterpret_cast<const Byte*>(source.data()), source.size()));
+}
+
+std::unique_ptr<v8::ScriptCompiler::CachedData> V8CodeCache::load(const Path& cachePath, BytesView& outBytes) const {
+    if (!_diskCache->exists(cachePath)) {
+        return nullptr;
+    }
+
+    auto loadResult = _diskCache->loadMapped(cachePath);
+    if (!loadResult || loadResult.value().empty()) {
+        return nullptr;
+    }
+
+    outBytes = loadResult.moveValue();
+    return std::make_unique<v8::ScriptCompiler::CachedData>(
+        outBytes.data(), static_cast<int>(outBytes.size()), v8::ScriptCompiler::CachedData::BufferNotOwned);
+}
+
+void V8CodeCache::store(const Path& cachePath, const v8::Local<v8::UnboundScript>& script) const {
+    std::unique_ptr<v8::ScriptCompiler::CachedData> cachedData(v8::ScriptCompiler::CreateCodeCache(script));
+    if (cachedData == nullptr || cachedData->length <= 0) {
+        return;
+    }
+
+    auto bytes = makeShared<ByteBuffer>(cachedData->data, cachedData->data + cachedData->length);
+    // The previous cache entry may still be mapped by load(), it is replaced instead of being overwritten.
+    // Failing to store only means that the script will be compiled again next time
+    auto storeResult = _diskCache->storeAtomically(cachePath, bytes->toBytesView());
+    if (!storeResult) {
+        _diskCache->remove(cachePath);
+    }
+}
+
+void V8CodeCache::remove(const Path& cachePath) const {
+    _diskCache->remove(cachePath);
+}
+
+} // namespace Valdi::V8
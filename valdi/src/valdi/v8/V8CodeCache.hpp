@@ -0,0 +1,56 @@
+//
+//  V8CodeCache.hpp
+//  valdi-v8
+//
+
+#pragma once
+
+#include "valdi/runtime/Interfaces/IDiskCache.hpp"
+#include "valdi_core/cpp/Utils/Bytes.hpp"
+#include "valdi_core/cpp/Utils/PathUtils.hpp"
+#include "valdi_core/cpp/Utils/Shared.hpp"
+
+#include "v8/v8.h"
+
+#include <memory>
+#include <string_view>
+
+namespace Valdi::V8 {
+
+/**
+ Persists the code caches produced by V8 for evaluated scripts into a disk cache, so that
+ scripts evaluated again in a later session can skip parsing and compilation.
+ Entries are keyed by the hash of the script source, and are scoped to the cached data version
+ tag of V8, which changes with the V8 version and the flags that affect code generation.
+ */
+class V8CodeCache : public SimpleRefCountable {
+public:
+    explicit V8CodeCache(const Ref<IDiskCache>& diskCache);
+    ~V8CodeCache() override;
+
+    /**
+     Returns the path of the cache entry for the given script source.
+     */
+    Path getCachePath(const std::string_view& source) const;
+
+    /**
+     Load the cached data stored at the given path. The returned CachedData does not own
+     its buffer, which is retained by the given outBytes. Returns nullptr if there is no entry.
+     */
+    std::unique_ptr<v8::ScriptCompiler::CachedData> load(const Path& cachePath, BytesView& outBytes) const;
+
+    /**
+     Create the code cache for the given compiled script and store it at the given path.
+     */
+    void store(const Path& cachePath, const v8::Local<v8::UnboundScript>& script) const;
+
+    /**
+     Remove the entry at the given path, typically because V8 rejected it.
+     */
+    void remove(const Path& cachePath) const;
+
+private:
+    Ref<IDiskCache> _diskCache;
+};
+
+} // namespace Valdi::V8
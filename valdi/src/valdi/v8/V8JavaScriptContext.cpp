@@ -10,6 +10,7 @@
 #include "valdi/runtime/Utils/RefCountableAutoreleasePool.hpp"
 #include "valdi/v8/HeapDumpOutputStream.hpp"
 #include "valdi/v8/IndirectV8Persistent.hpp"
+#include "valdi/v8/V8CodeCache.hpp"
 
 #include "valdi_core/cpp/Text/UTF16Utils.hpp"
 #include "valdi_core/cpp/Utils/ReferenceInfo.hpp"
@@ -26,6 +27,8 @@
 #include <iostream>
 
 namespace {
+constexpr size_t kMinCodeCacheScriptLength = 1024;
+
 void initializeV8Engine() {
     static std::once_flag flag;
     static std::unique_ptr<v8::Platform> platform;
@@ -77,6 +80,16 @@ void freeWrappedPointer(void* opaque) {
     RefCountableAutoreleasePool::release(opaque);
 }
 
+// Keeps the contents of a detached ArrayBuffer alive
+class DetachedBackingStore : public SimpleRefCountable {
+public:
+    explicit DetachedBackingStore(std::shared_ptr<v8::BackingStore> backingStore)
+        : _backingStore(std::move(backingStore)) {}
+
+private:
+    std::shared_ptr<v8::BackingStore> _backingStore;
+};
+
 inline JSValue toValdiJSValue(const IndirectV8Persistent& value) {
     static_assert(sizeof(IndirectV8Persistent) < 128);
     return JSValue(value);
@@ -215,8 +228,33 @@ JSValueRef V8JavaScriptContext::evaluate(const std::string& script,
         return JSValueRef();
     }
 
+    v8::Local<v8::String> filename;
+    if (!v8::String::NewFromUtf8(_isolate,
+                                 sourceFilename.data(),
+                                 v8::NewStringType::kNormal,
+                                 static_cast<int32_t>(sourceFilename.length()))
+             .ToLocal(&filename)) {
+        filename = v8::String::Empty(_isolate);
+    }
+
+    // Small scripts are compiled faster than their code cache can be loaded from disk
+    auto useCodeCache = _codeCache != nullptr && script.length() >= kMinCodeCacheScriptLength;
+    Path cachePath;
+    BytesView cachedBytes;
+    std::unique_ptr<v8::ScriptCompiler::CachedData> cachedData;
+    if (useCodeCache) {
+        cachePath = _codeCache->getCachePath(script);
+        cachedData = _codeCache->load(cachePath, cachedBytes);
+    }
+
+    auto compileOptions =
+        cachedData != nullptr ? v8::ScriptCompiler::kConsumeCodeCache : v8::ScriptCompiler::kNoCompileOptions;
+    v8::ScriptOrigin origin(_isolate, filename);
+    // The source takes ownership of the cached data
+    v8::ScriptCompiler::Source compilerSource(source, origin, cachedData.release());
+
     v8::Local<v8::Script> compiledSource;
-    if (!v8::Script::Compile(context, source).ToLocal(&compiledSource)) {
+    if (!v8::ScriptCompiler::Compile(context, &compilerSource, compileOptions).ToLocal(&compiledSource)) {
         if (catcher.HasCaught()) {
             auto excep = catcher.Exception();
             exceptionTracker.storeException(toRetainedJSValueRef(IndirectV8Persistent::make(_isolate, excep)));
@@ -226,6 +264,16 @@ JSValueRef V8JavaScriptContext::evaluate(const std::string& script,
         return JSValueRef();
     }
 
+    // V8 rejects caches produced from a different source or by a different V8 configuration,
+    // in which case the script was compiled from source and the cache entry must be replaced.
+    auto codeCacheRejected =
+        compileOptions == v8::ScriptCompiler::kConsumeCodeCache && compilerSource.GetCachedData()->rejected;
+    if (codeCacheRejected) {
+        _codeCache->remove(cachePath);
+    }
+    auto shouldStoreCodeCache =
+        useCodeCache && (compileOptions == v8::ScriptCompiler::kNoCompileOptions || codeCacheRejected);
+
     v8::Local<v8::Value> result;
     if (!compiledSource->Run(context).ToLocal(&result)) {
         if (catcher.HasCaught()) {
@@ -237,6 +285,11 @@ JSValueRef V8JavaScriptContext::evaluate(const std::string& script,
         return JSValueRef();
     }
 
+    if (shouldStoreCodeCache) {
+        // Created after running the script so that the functions compiled while running it are included
+        _codeCache->store(cachePath, compiledSource->GetUnboundScript());
+    }
+
     return toRetainedJSValueRef(IndirectV8Persistent::make(_isolate, result));
 }
 
@@ -252,6 +305,14 @@ BytesView V8JavaScriptContext::preCompile(const std::string_view& /*script*/,
     return BytesView();
 }
 
+void V8JavaScriptContext::setBytecodeDiskCache(const Ref<IDiskCache>& diskCache) {
+    if (diskCache != nullptr) {
+        _codeCache = makeShared<V8CodeCache>(diskCache);
+    } else {
+        _codeCache = nullptr;
+    }
+}
+
 JSPropertyNameRef V8JavaScriptContext::newPropertyName(const std::string_view& str) {
     v8::HandleScope handleScope(_isolate);
 
@@ -916,6 +977,13 @@ JSTypedArray V8JavaScriptContext::valueToTypedArray(const JSValue& value, JSExce
     v8::HandleScope handleScope(_isolate);
 
     v8::Local<v8::Value> val = fromValdiJSValue(_isolate, value, exceptionTracker);
+    if (val->IsArrayBuffer()) {
+        auto arrayBuffer = v8::Local<v8::ArrayBuffer>::Cast(val);
+        return JSTypedArray(TypedArrayType::ArrayBuffer,
+                            arrayBuffer->Data(),
+                            arrayBuffer->ByteLength(),
+                            toRetainedJSValueRef(IndirectV8Persistent::make(_isolate, val)));
+    }
     if (!val->IsTypedArray()) {
         exceptionTracker.onError("Value is not TypedArray");
         return JSTypedArray();
@@ -927,6 +995,35 @@ JSTypedArray V8JavaScriptContext::valueToTypedArray(const JSValue& value, JSExce
     return JSTypedArray(type, data, length, toRetainedJSValueRef(IndirectV8Persistent::make(_isolate, val)));
 }
 
+BytesView V8JavaScriptContext::detachArrayBuffer(const JSValue& value, JSExceptionTracker& exceptionTracker) {
+    v8::HandleScope handleScope(_isolate);
+
+    v8::Local<v8::Value> val = fromValdiJSValue(_isolate, value, exceptionTracker);
+    v8::Local<v8::ArrayBuffer> arrayBuffer;
+    if (val->IsArrayBuffer()) {
+        arrayBuffer = v8::Local<v8::ArrayBuffer>::Cast(val);
+    } else if (val->IsArrayBufferView()) {
+        arrayBuffer = v8::Local<v8::ArrayBufferView>::Cast(val)->Buffer();
+    } else {
+        exceptionTracker.onError("Value is not an ArrayBuffer");
+        return BytesView();
+    }
+
+    if (!arrayBuffer->IsDetachable() || arrayBuffer->ByteLength() == 0) {
+        return BytesView();
+    }
+
+    // The backing store keeps the contents alive once the ArrayBuffer is detached
+    auto backingStore = arrayBuffer->GetBackingStore();
+    if (arrayBuffer->Detach(v8::Local<v8::Value>()).IsNothing()) {
+        return BytesView();
+    }
+
+    const auto* data = reinterpret_cast<const Byte*>(backingStore->Data());
+    auto size = backingStore->ByteLength();
+    return BytesView(makeShared<DetachedBackingStore>(std::move(backingStore)), data, size);
+}
+
 Ref<JSFunction> V8JavaScriptContext::valueToFunction(const JSValue& value, JSExceptionTracker& exceptionTracker) {
     v8::HandleScope handleScope(_isolate);
 
@@ -18,6 +18,7 @@
 namespace Valdi::V8 {
 
 class IndirectV8Persistent;
+class V8CodeCache;
 
 class V8JavaScriptContext : public IJavaScriptContext {
 public:
@@ -38,6 +39,12 @@ public:
                          const std::string_view& /*sourceFilename*/,
                          JSExceptionTracker& exceptionTracker) override;
 
+    /**
+     Scripts evaluated from source will have their code cache stored into the given disk cache,
+     and consumed from it when the same scripts are evaluated again.
+     */
+    void setBytecodeDiskCache(const Ref<IDiskCache>& diskCache) override;
+
     JSPropertyNameRef newPropertyName(const std::string_view& str) override;
 
     StringBox propertyNameToString(const JSPropertyName& propertyName) override;
@@ -124,6 +131,7 @@ public:
     int32_t valueToInt(const JSValue& value, JSExceptionTracker& exceptionTracker) override;
     Ref<RefCountable> valueToWrappedObject(const JSValue& value, JSExceptionTracker& exceptionTracker) override;
     JSTypedArray valueToTypedArray(const JSValue& value, JSExceptionTracker& exceptionTracker) override;
+    BytesView detachArrayBuffer(const JSValue& value, JSExceptionTracker& exceptionTracker) override;
     Ref<JSFunction> valueToFunction(const JSValue& value, JSExceptionTracker& exceptionTracker) override;
     int64_t valueToLong(const JSValue& value, JSExceptionTracker& exceptionTracker);
 
@@ -177,6 +185,7 @@ private:
     v8::Global<v8::Context> _context;
     v8::Persistent<v8::ObjectTemplate> _valdiObjectTemplate;
     v8::Persistent<v8::Private> _functionDataProperty;
+    Ref<V8CodeCache> _codeCache;
 };
 
 } // namespace Valdi::V8
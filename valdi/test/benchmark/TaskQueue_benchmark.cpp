@@ -0,0 +1,179 @@
+#include "valdi_core/cpp/Threading/TaskQueue.hpp"
+#include "valdi_core/cpp/Threading/ThreadedDispatchQueue.hpp"
+#include "valdi_core/cpp/Utils/StringCache.hpp"
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <atomic>
+#include <deque>
+#include <random>
+#include <thread>
+
+using namespace Valdi;
+
+// Reproduces the scheduling strategy the TaskQueue used before its timer heap:
+// a single deque kept sorted with upper_bound and a linear scan on cancel.
+class SortedDequeTaskQueue {
+public:
+    EnqueuedTask enqueue(DispatchFunction function, std::chrono::steady_clock::time_point executeTime) {
+        std::lock_guard<Mutex> lockGuard(_mutex);
+        EnqueuedTask enqueuedTask;
+        enqueuedTask.id = ++_taskIdCounter;
+        Task task{enqueuedTask.id, std::move(function), executeTime};
+
+        auto it = std::upper_bound(_tasks.begin(), _tasks.end(), task, [](const Task& a, const Task& b) {
+            if (a.executeTime == b.executeTime) {
+                return a.id < b.id;
+            }
+            return a.executeTime < b.executeTime;
+        });
+        _tasks.emplace(it, std::move(task));
+
+        return enqueuedTask;
+    }
+
+    EnqueuedTask enqueue(DispatchFunction function) {
+        return enqueue(std::move(function), std::chrono::steady_clock::now());
+    }
+
+    EnqueuedTask enqueue(DispatchFunction function, std::chrono::steady_clock::duration delay) {
+        return enqueue(std::move(function), std::chrono::steady_clock::now() + delay);
+    }
+
+    void cancel(task_id_t taskId) {
+        DispatchFunction toDelete;
+        std::lock_guard<Mutex> lockGuard(_mutex);
+        for (auto it = _tasks.begin(); it != _tasks.end(); ++it) {
+            if (it->id == taskId) {
+                toDelete = std::move(it->function);
+                _tasks.erase(it);
+                return;
+            }
+        }
+    }
+
+    size_t flushUpToNow() {
+        auto maxTime = std::chrono::steady_clock::now();
+        size_t ranTasks = 0;
+
+        for (;;) {
+            DispatchFunction function;
+            {
+                std::lock_guard<Mutex> lockGuard(_mutex);
+                if (_tasks.empty() || _tasks.front().executeTime > maxTime) {
+                    return ranTasks;
+                }
+                function = std::move(_tasks.front().function);
+                _tasks.pop_front();
+            }
+            function();
+            ranTasks++;
+        }
+    }
+
+private:
+    struct Task {
+        task_id_t id;
+        DispatchFunction function;
+        std::chrono::steady_clock::time_point executeTime;
+    };
+
+    Mutex _mutex;
+    task_id_t _taskIdCounter = 0;
+    std::deque<Task> _tasks;
+};
+
+static std::vector<std::chrono::steady_clock::duration> makeRandomDelays(size_t count) {
+    std::mt19937 generator(42);
+    std::uniform_int_distribution<int> distribution(1, 10000);
+
+    std::vector<std::chrono::steady_clock::duration> delays;
+    delays.reserve(count);
+    for (size_t i = 0; i < count; i++) {
+        delays.emplace_back(std::chrono::milliseconds(distribution(generator)));
+    }
+    return delays;
+}
+
+// setTimeout storm: schedule many timers with random delays, then cancel all of them.
+template<typename Queue>
+static void ScheduleAndCancelTimers(benchmark::State& state) {
+    auto delays = makeRandomDelays(static_cast<size_t>(state.range(0)));
+    std::vector<task_id_t> taskIds;
+    taskIds.reserve(delays.size());
+
+    for (auto _ : state) {
+        Queue queue;
+        taskIds.clear();
+
+        for (const auto& delay : delays) {
+            taskIds.emplace_back(queue.enqueue([]() {}, delay).id);
+        }
+
+        for (auto taskId : taskIds) {
+            queue.cancel(taskId);
+        }
+    }
+}
+
+// Immediate tasks posted while many timers are pending.
+template<typename Queue>
+static void EnqueueImmediateWithPendingTimers(benchmark::State& state) {
+    auto delays = makeRandomDelays(static_cast<size_t>(state.range(0)));
+    Queue queue;
+
+    for (const auto& delay : delays) {
+        queue.enqueue([]() {}, delay);
+    }
+
+    for (auto _ : state) {
+        for (size_t i = 0; i < 64; i++) {
+            queue.enqueue([]() {});
+        }
+        benchmark::DoNotOptimize(queue.flushUpToNow());
+    }
+}
+
+BENCHMARK_TEMPLATE(ScheduleAndCancelTimers, SortedDequeTaskQueue)->Range(64, 8192);
+BENCHMARK_TEMPLATE(ScheduleAndCancelTimers, TaskQueue)->Range(64, 8192);
+BENCHMARK_TEMPLATE(EnqueueImmediateWithPendingTimers, SortedDequeTaskQueue)->Range(64, 8192);
+BENCHMARK_TEMPLATE(EnqueueImmediateWithPendingTimers, TaskQueue)->Range(64, 8192);
+
+// Several producers posting immediate tasks to the same ThreadedDispatchQueue.
+// Arguments are the number of producers and whether the lock-free async path is enabled.
+static void PostFromProducers(benchmark::State& state) {
+    auto producersCount = static_cast<size_t>(state.range(0));
+    auto dispatchQueue = makeShared<ThreadedDispatchQueue>(STRING_LITERAL("Benchmark Queue"), ThreadQoSClassNormal);
+    dispatchQueue->setLockFreeAsyncEnabled(state.range(1) != 0);
+
+    constexpr size_t kTasksPerProducer = 10000;
+    std::atomic<size_t> ranTasks(0);
+
+    for (auto _ : state) {
+        std::vector<std::thread> producers;
+        producers.reserve(producersCount);
+
+        for (size_t i = 0; i < producersCount; i++) {
+            producers.emplace_back([&]() {
+                for (size_t j = 0; j < kTasksPerProducer; j++) {
+                    dispatchQueue->async([&]() { ranTasks.fetch_add(1, std::memory_order_relaxed); });
+                }
+            });
+        }
+
+        for (auto& producer : producers) {
+            producer.join();
+        }
+        dispatchQueue->sync([]() {});
+    }
+
+    state.SetItemsProcessed(static_cast<int64_t>(ranTasks.load()));
+    dispatchQueue->fullTeardown();
+}
+BENCHMARK(PostFromProducers)
+    ->ArgsProduct({{1, 4, 8}, {0, 1}})
+    ->ArgNames({"producers", "lockFree"})
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
@@ -6,6 +6,7 @@
 #include "valdi/runtime/Context/ViewNodeTree.hpp"
 #include "valdi/runtime/Rendering/ViewNodeRenderer.hpp"
 #include "valdi/runtime/Utils/MainThreadManager.hpp"
+#include "valdi_core/cpp/Threading/WorkStealingExecutor.hpp"
 #include "valdi_core/cpp/Utils/LoggerUtils.hpp"
 
 #include "valdi/standalone_runtime/StandaloneViewManager.hpp"
@@ -14,11 +15,36 @@
 
 #include "valdi/runtime/Attributes/ViewNodeAttribute.hpp"
 
+#include <atomic>
 #include <benchmark/benchmark.h>
+#include <cstdlib>
+#include <new>
+#include <thread>
 
 using namespace ValdiTest;
 using namespace Valdi;
 
+// Counts the allocations going through the global operator new, so that the benchmarks
+// can report how many allocations a ViewNode costs.
+static std::atomic<size_t> gAllocationsCount = 0;
+
+void* operator new(size_t size) {
+    gAllocationsCount.fetch_add(1, std::memory_order_relaxed);
+    auto* ptr = std::malloc(size == 0 ? 1 : size);
+    if (ptr == nullptr) {
+        throw std::bad_alloc();
+    }
+    return ptr;
+}
+
+void operator delete(void* ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, size_t /*size*/) noexcept {
+    std::free(ptr);
+}
+
 struct Dependencies {
     Dependencies() : mainQueue(), mainThreadManager(mainQueue), viewManager(), attributeIds() {
         viewManagerContext = makeShared<ViewManagerContext>(viewManager,
@@ -189,17 +215,27 @@ static void InitialRender(benchmark::State& state) {
     RenderState renderState(deps);
     auto request = makeShared<RenderRequest>();
     populateRenderRequest(*request, renderState, createElementTree());
+    auto viewNodesCount = static_cast<double>(renderState.elementId);
 
+    size_t allocationsCount = 0;
+    size_t slabsSize = 0;
     for (auto _ : state) {
+        auto allocationsCountBefore = gAllocationsCount.load();
         auto tree = deps.createTree();
         ViewNodeRenderer renderer(*tree, ConsoleLogger::getLogger(), false);
 
         renderer.render(*request);
 
         state.PauseTiming();
+        allocationsCount += gAllocationsCount.load() - allocationsCountBefore;
+        slabsSize += tree->getViewNodesAllocator()->getSlabsSize();
         deps.destroyTree(tree);
         state.ResumeTiming();
     }
+
+    auto iterations = static_cast<double>(state.iterations());
+    state.counters["allocsPerNode"] = static_cast<double>(allocationsCount) / iterations / viewNodesCount;
+    state.counters["slabBytesPerNode"] = static_cast<double>(slabsSize) / iterations / viewNodesCount;
 }
 BENCHMARK(InitialRender);
 
@@ -209,6 +245,7 @@ static void DestroyTree(benchmark::State& state) {
     RenderState renderState(deps);
     auto request = makeShared<RenderRequest>();
     populateRenderRequest(*request, renderState, createElementTree());
+    auto viewNodesCount = static_cast<double>(renderState.elementId);
 
     for (auto _ : state) {
         state.PauseTiming();
@@ -221,7 +258,126 @@ static void DestroyTree(benchmark::State& state) {
 
         deps.destroyTree(tree);
     }
+
+    state.counters["nodesPerSecond"] =
+        benchmark::Counter(viewNodesCount * static_cast<double>(state.iterations()), benchmark::Counter::kIsRate);
 }
 BENCHMARK(DestroyTree);
 
+static Element createWrappingGridElementTree() {
+    std::vector<Element> cells;
+    for (size_t i = 0; i < 10000; i++) {
+        cells.emplace_back(Element("view").attribute("width", 40).attribute("height", 40));
+    }
+
+    auto root = Element("view")
+                    .attribute("width", 400)
+                    .attribute("height", 800)
+                    .child(Element("scroll")
+                               .attribute("flexGrow", 1)
+                               .child(Element("view")
+                                          .attribute("flexDirection", "row")
+                                          .attribute("flexWrap", "wrap")
+                                          .setChildren(cells)));
+    return root;
+}
+
+static void ScrollWrappingGrid(benchmark::State& state) {
+    Dependencies deps;
+
+    RenderState renderState(deps);
+    auto request = makeShared<RenderRequest>();
+    populateRenderRequest(*request, renderState, createWrappingGridElementTree());
+
+    auto tree = deps.createTree();
+    auto viewTransactionScope = makeShared<ViewTransactionScope>(&deps.viewManager, nullptr, false);
+    tree->unsafeSetCurrentViewTransactionScope(viewTransactionScope);
+
+    ViewNodeRenderer renderer(*tree, ConsoleLogger::getLogger(), false);
+    renderer.render(*request);
+
+    auto rootViewNode = tree->getRootViewNode();
+    rootViewNode->performLayout(*viewTransactionScope, Size(400, 800), LayoutDirectionLTR);
+    rootViewNode->updateVisibilityAndPerformUpdates(*viewTransactionScope);
+
+    auto* scrollViewNode = rootViewNode->getChildAt(0);
+    auto contentHeight = scrollViewNode->getChildAt(0)->getCalculatedFrame().height;
+
+    float contentOffsetY = 0;
+    for (auto _ : state) {
+        contentOffsetY += 300;
+        if (contentOffsetY + 800 > contentHeight) {
+            contentOffsetY = 0;
+        }
+        scrollViewNode->setScrollContentOffset(*viewTransactionScope, Point(0, contentOffsetY));
+        rootViewNode->updateVisibilityAndPerformUpdates(*viewTransactionScope);
+    }
+
+    deps.destroyTree(tree);
+}
+BENCHMARK(ScrollWrappingGrid);
+
+static Element createLazyLayoutFeedElementTree() {
+    std::vector<Element> items;
+    for (size_t i = 0; i < 5; i++) {
+        items.emplace_back(Element("view").attribute("flexGrow", 1).attribute("margin", 1));
+    }
+
+    std::vector<Element> rows;
+    for (size_t i = 0; i < 10; i++) {
+        rows.emplace_back(Element("view").attribute("flexDirection", "row").attribute("height", 10).setChildren(items));
+    }
+
+    std::vector<Element> cells;
+    for (size_t i = 0; i < 50; i++) {
+        cells.emplace_back(Element("view")
+                               .attribute("lazyLayout", true)
+                               .attribute("width", "100%")
+                               .attribute("height", 120)
+                               .setChildren(rows));
+    }
+
+    return Element("view").setChildren(cells);
+}
+
+// Relayouts a feed of lazy layout cells, serially when the argument is 0,
+// or concurrently on a WorkStealingExecutor when the argument is 1.
+static void LazyLayoutFeed(benchmark::State& state) {
+    Dependencies deps;
+
+    RenderState renderState(deps);
+    auto request = makeShared<RenderRequest>();
+    populateRenderRequest(*request, renderState, createLazyLayoutFeedElementTree());
+
+    auto tree = deps.createTree();
+    auto viewTransactionScope = makeShared<ViewTransactionScope>(&deps.viewManager, nullptr, false);
+    tree->unsafeSetCurrentViewTransactionScope(viewTransactionScope);
+
+    Ref<WorkStealingExecutor> executor;
+    if (state.range(0) != 0) {
+        executor = makeShared<WorkStealingExecutor>(std::thread::hardware_concurrency());
+        tree->setLazyLayoutExecutor(executor);
+    }
+
+    ViewNodeRenderer renderer(*tree, ConsoleLogger::getLogger(), false);
+    renderer.render(*request);
+
+    auto rootViewNode = tree->getRootViewNode();
+    rootViewNode->performLayout(*viewTransactionScope, Size(400, 10000), LayoutDirectionLTR);
+    rootViewNode->updateVisibilityAndPerformUpdates(*viewTransactionScope);
+
+    float width = 400;
+    for (auto _ : state) {
+        // Resizing the feed invalidates the layout of every cell
+        width = width == 400 ? 401 : 400;
+        rootViewNode->performLayout(*viewTransactionScope, Size(width, 10000), LayoutDirectionLTR);
+    }
+
+    deps.destroyTree(tree);
+    if (executor != nullptr) {
+        executor->teardown();
+    }
+}
+BENCHMARK(LazyLayoutFeed)->Arg(0)->Arg(1);
+
 BENCHMARK_MAIN();
@@ -1,4 +1,6 @@
 #include "benchmark_utils.hpp"
+#include "valdi/jsbridge/JavaScriptBridge.hpp"
+#include "valdi/runtime/Interfaces/IJavaScriptBridge.hpp"
 #include "valdi_test_utils.hpp"
 #include <benchmark/benchmark.h>
 
@@ -78,4 +80,71 @@ static void UpdateCSS(benchmark::State& state) {
 }
 BENCHMARK(UpdateCSS);
 
+static std::string makeStartupScript() {
+    std::string script = "(function(exports) {\n";
+    for (size_t i = 0; i < 2000; i++) {
+        script += fmt::format("exports.fn{0} = function(a, b) {{ const items = [a, b, {0}]; "
+                              "return items.map(item => item * 2).filter(item => item > {0}).length; }};\n",
+                              i);
+    }
+    script += "return exports;\n})";
+    return script;
+}
+
+// Compares the evaluation of a large script in a fresh V8 isolate, as done at startup, with and without
+// the code cache of a previous evaluation being available.
+static void doV8StartupBench(benchmark::State& state, bool withCachedCode) {
+    using namespace snap::valdi_core;
+    if (!Valdi::JavaScriptBridge::isAvailable(JavaScriptEngineType::V8)) {
+        state.SkipWithError("V8 is not available in this build");
+        return;
+    }
+
+    auto* jsBridge = Valdi::JavaScriptBridge::get(JavaScriptEngineType::V8);
+    auto script = makeStartupScript();
+    auto diskCache = Valdi::makeShared<Valdi::InMemoryDiskCache>();
+
+    auto evaluate = [&](benchmark::State* timedState) {
+        auto jsContext = jsBridge->createJsContext(nullptr, Valdi::ConsoleLogger::getLogger());
+        Valdi::JSExceptionTracker exceptionTracker(*jsContext);
+        jsContext->initialize(Valdi::IJavaScriptContextConfig(), exceptionTracker);
+        if (withCachedCode) {
+            jsContext->setBytecodeDiskCache(diskCache);
+        }
+
+        if (timedState != nullptr) {
+            timedState->ResumeTiming();
+        }
+        benchmark::DoNotOptimize(jsContext->evaluate(script, "startup.js", exceptionTracker));
+        if (timedState != nullptr) {
+            timedState->PauseTiming();
+        }
+
+        if (!exceptionTracker) {
+            state.SkipWithError(exceptionTracker.extractError().toString().c_str());
+        }
+    };
+
+    if (withCachedCode) {
+        // Populates the code cache
+        evaluate(nullptr);
+    }
+
+    for (auto _ : state) {
+        state.PauseTiming();
+        evaluate(&state);
+        state.ResumeTiming();
+    }
+}
+
+static void V8StartupCold(benchmark::State& state) {
+    doV8StartupBench(state, false);
+}
+BENCHMARK(V8StartupCold);
+
+static void V8StartupWithCodeCache(benchmark::State& state) {
+    doV8StartupBench(state, true);
+}
+BENCHMARK(V8StartupWithCodeCache);
+
 BENCHMARK_MAIN();
@@ -32,6 +32,54 @@ static void StringCacheMakeStringWarm(benchmark::State& state) {
 }
 BENCHMARK(StringCacheMakeStringWarm)->Range(8, 512);
 
+static std::vector<std::string> makeAttributeNames(size_t count) {
+    std::vector<std::string> out;
+    out.reserve(count);
+
+    for (size_t i = 0; i < count; i++) {
+        out.emplace_back("attributeName" + std::to_string(i));
+    }
+
+    return out;
+}
+
+// Interns strings which are already in the cache from several threads at once, like the
+// JS, main and worker threads resolving attribute and property names.
+// Throughput should scale with the threads count.
+static void StringCacheMakeStringWarmMultithreaded(benchmark::State& state) {
+    static auto kStrings = makeAttributeNames(512);
+    static auto kCachedStrings = internStrings(StringCache::getGlobal(), kStrings);
+    auto& stringCache = StringCache::getGlobal();
+
+    for (auto _ : state) {
+        for (const auto& str : kStrings) {
+            benchmark::DoNotOptimize(stringCache.makeString(str));
+        }
+    }
+
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * kStrings.size()));
+}
+BENCHMARK(StringCacheMakeStringWarmMultithreaded)->ThreadRange(1, 16)->UseRealTime();
+
+// Interns strings which are released right away from several threads at once, which
+// exercises the insertion and removal paths.
+static void StringCacheMakeStringColdMultithreaded(benchmark::State& state) {
+    auto strings = makeAttributeNames(512);
+    for (auto& str : strings) {
+        str.append(std::to_string(state.thread_index()));
+    }
+    auto& stringCache = StringCache::getGlobal();
+
+    for (auto _ : state) {
+        for (const auto& str : strings) {
+            benchmark::DoNotOptimize(stringCache.makeString(str));
+        }
+    }
+
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * strings.size()));
+}
+BENCHMARK(StringCacheMakeStringColdMultithreaded)->ThreadRange(1, 16)->UseRealTime();
+
 // How long does it take to compare regular std::strings
 // Used as base
 static void RegularStringComparison(benchmark::State& state) {
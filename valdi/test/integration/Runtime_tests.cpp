@@ -1709,6 +1709,162 @@ TEST_P(RuntimeFixture, messagePortReleasedWhenPeerCloses) {
     EXPECT_EQ(nullptr, receivingPort.lock());
 }
 
+TEST_P(RuntimeFixture, messagePortDeliversQueuedMessagesInOrder) {
+    auto* javaScriptRuntime = wrapper.runtime->getJavaScriptRuntime();
+
+    javaScriptRuntime->dispatchSynchronouslyOnJsThread([&](auto& jsEntry) {
+        jsEntry.jsContext.evaluate(R"""(
+            (() => {
+                const channel = new MessageChannel();
+                globalThis.messagePortSender = channel.port1;
+                globalThis.receivedPortMessages = [];
+                channel.port2.onmessage = event => {
+                    globalThis.receivedPortMessages.push(event.data);
+                    if (event.data === 2) {
+                        // Messages enqueued while delivering are delivered after the queued ones
+                        globalThis.messagePortSender.postMessage(4);
+                    }
+                };
+                for (let i = 1; i <= 3; i++) {
+                    channel.port1.postMessage(i);
+                }
+            })()
+        )""",
+                                   "message-port-burst.js",
+                                   jsEntry.exceptionTracker);
+        ASSERT_TRUE(jsEntry.exceptionTracker);
+    });
+    wrapper.flushQueues();
+
+    javaScriptRuntime->dispatchSynchronouslyOnJsThread([&](auto& jsEntry) {
+        auto messages = jsEntry.jsContext.evaluate(
+            "globalThis.receivedPortMessages.join(',')", "message-port-burst-receive.js", jsEntry.exceptionTracker);
+        ASSERT_TRUE(jsEntry.exceptionTracker);
+        EXPECT_EQ(STRING_LITERAL("1,2,3,4"), jsEntry.jsContext.valueToString(messages.get(), jsEntry.exceptionTracker));
+    });
+}
+
+TEST_P(RuntimeFixture, messagePortDeliversQueuedMessagesInBatches) {
+    auto* javaScriptRuntime = wrapper.runtime->getJavaScriptRuntime();
+
+    auto postMessages = [&](std::string_view firstHandlerBody) {
+        javaScriptRuntime->dispatchSynchronouslyOnJsThread([&](auto& jsEntry) {
+            auto script = fmt::format(R"""(
+                (() => {{
+                    const channel = new MessageChannel();
+                    globalThis.messagePortSender = channel.port1;
+                    globalThis.receivedPortMessages = [];
+                    channel.port2.onmessage = event => {{
+                        globalThis.receivedPortMessages.push(event.data);
+                        if (event.data === 1) {{
+                            {}
+                        }}
+                    }};
+                    for (let i = 1; i <= 3; i++) {{
+                        channel.port1.postMessage(i);
+                    }}
+                }})()
+            )""",
+                                      firstHandlerBody);
+            jsEntry.jsContext.evaluate(script, "message-port-batch.js", jsEntry.exceptionTracker);
+            ASSERT_TRUE(jsEntry.exceptionTracker);
+        });
+
+        // Enqueued after the task delivering the first message
+        javaScriptRuntime->dispatchOnJsThread(
+            nullptr, JavaScriptTaskScheduleTypeAlwaysAsync, 0, [](JavaScriptEntryParameters& entry) {
+                entry.jsContext.evaluate("globalThis.receivedPortMessages.push('task')",
+                                         "message-port-batch-task.js",
+                                         entry.exceptionTracker);
+            });
+        wrapper.flushQueues();
+
+        StringBox receivedMessages;
+        javaScriptRuntime->dispatchSynchronouslyOnJsThread([&](auto& jsEntry) {
+            auto messages = jsEntry.jsContext.evaluate(
+                "globalThis.receivedPortMessages.join(',')", "message-port-batch-receive.js", jsEntry.exceptionTracker);
+            ASSERT_TRUE(jsEntry.exceptionTracker);
+            receivedMessages = jsEntry.jsContext.valueToString(messages.get(), jsEntry.exceptionTracker);
+        });
+        return receivedMessages;
+    };
+
+    // The queued messages are all delivered by the first task
+    EXPECT_EQ(STRING_LITERAL("1,2,3,task"), postMessages(""));
+
+    // A batch which exceeds its time budget lets the other tasks run before delivering the next messages
+    EXPECT_EQ(STRING_LITERAL("1,task,2,3"),
+              postMessages("const start = Date.now(); while (Date.now() - start < 20) {}"));
+}
+
+TEST_P(RuntimeFixture, messagePortTransfersArrayBuffers) {
+    auto* javaScriptRuntime = wrapper.runtime->getJavaScriptRuntime();
+
+    javaScriptRuntime->dispatchSynchronouslyOnJsThread([&](auto& jsEntry) {
+        jsEntry.jsContext.evaluate(R"""(
+            (() => {
+                const channel = new MessageChannel();
+                globalThis.messagePortSender = channel.port1;
+                globalThis.receivedBytes = '';
+                channel.port2.onmessage = event => {
+                    globalThis.receivedBytes = new Uint8Array(event.data.buffer).join(',');
+                };
+                const buffer = new Uint8Array([1, 2, 3, 4]).buffer;
+                channel.port1.postMessage({buffer}, [buffer]);
+                globalThis.senderByteLength = buffer.byteLength;
+                if (buffer.byteLength > 0) {
+                    // Buffers which could not be detached were copied into the message
+                    new Uint8Array(buffer)[0] = 42;
+                }
+            })()
+        )""",
+                                   "message-port-transfer-buffer.js",
+                                   jsEntry.exceptionTracker);
+        ASSERT_TRUE(jsEntry.exceptionTracker);
+    });
+    wrapper.flushQueues();
+
+    javaScriptRuntime->dispatchSynchronouslyOnJsThread([&](auto& jsEntry) {
+        auto receivedBytes = jsEntry.jsContext.evaluate(
+            "globalThis.receivedBytes", "message-port-transfer-buffer-receive.js", jsEntry.exceptionTracker);
+        ASSERT_TRUE(jsEntry.exceptionTracker);
+        EXPECT_EQ(STRING_LITERAL("1,2,3,4"),
+                  jsEntry.jsContext.valueToString(receivedBytes.get(), jsEntry.exceptionTracker));
+
+        if (isQuickJS() || isV8()) {
+            // Only QuickJS and V8 can detach ArrayBuffers, the other engines send a copy of them
+            auto senderByteLength = jsEntry.jsContext.evaluate(
+                "globalThis.senderByteLength", "message-port-transfer-buffer-sender.js", jsEntry.exceptionTracker);
+            ASSERT_TRUE(jsEntry.exceptionTracker);
+            EXPECT_EQ(0, jsEntry.jsContext.valueToInt(senderByteLength.get(), jsEntry.exceptionTracker));
+        }
+    });
+}
+
+TEST_P(RuntimeFixture, messagePortRejectsDuplicateTransferredArrayBuffer) {
+    auto* javaScriptRuntime = wrapper.runtime->getJavaScriptRuntime();
+
+    javaScriptRuntime->dispatchSynchronouslyOnJsThread([&](auto& jsEntry) {
+        auto error = jsEntry.jsContext.evaluate(R"""(
+            (() => {
+                const channel = new MessageChannel();
+                const buffer = new Uint8Array([1, 2, 3, 4]).buffer;
+                try {
+                    channel.port1.postMessage(buffer, [buffer, buffer]);
+                    return '';
+                } catch (error) {
+                    return error.message;
+                }
+            })()
+        )""",
+                                                "message-port-duplicate-buffer.js",
+                                                jsEntry.exceptionTracker);
+        ASSERT_TRUE(jsEntry.exceptionTracker);
+        EXPECT_TRUE(jsEntry.jsContext.valueToString(error.get(), jsEntry.exceptionTracker)
+                        .contains("duplicate ArrayBuffer"));
+    });
+}
+
 TEST_P(RuntimeFixture, canHandleDynamicChildDocument) {
     auto viewModel = makeShared<ValueMap>();
     (*viewModel)[STRING_LITERAL("childDocumentName")] = Valdi::Value(std::string("test:src/BasicViewTree.valdi"));
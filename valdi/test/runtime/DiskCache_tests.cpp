@@ -12,6 +12,7 @@
 #include "valdi_core/cpp/Utils/StringCache.hpp"
 #include "gtest/gtest.h"
 #include <stdlib.h>
+#include <sys/stat.h>
 
 using namespace Valdi;
 
@@ -204,4 +205,45 @@ TEST(DiskCache, scopedInstanceRespectsIsolation) {
     ASSERT_FALSE(result.success()) << result.description();
 }
 
+TEST(DiskCache, mappedContentSurvivesStore) {
+    TemporaryDirectory directory;
+    DiskCacheImpl diskCache(directory.get());
+
+    auto result = diskCache.store(Path("hello"), createContent("world"));
+    ASSERT_TRUE(result.success()) << result.description();
+
+    auto loadResult = diskCache.loadMapped(Path("hello"));
+    ASSERT_TRUE(loadResult.success()) << loadResult.description();
+    ASSERT_EQ(createContent("world"), loadResult.value());
+
+    // The file is replaced, which should leave the mapping of the previous content untouched
+    result = diskCache.storeAtomically(Path("hello"), createContent("nice"));
+    ASSERT_TRUE(result.success()) << result.description();
+
+    ASSERT_EQ(createContent("world"), loadResult.value());
+
+    auto newLoadResult = diskCache.loadMapped(Path("hello"));
+    ASSERT_TRUE(newLoadResult.success()) << newLoadResult.description();
+    ASSERT_EQ(createContent("nice"), newLoadResult.value());
+}
+
+TEST(DiskCache, storeAtomicallyKeepsPermissions) {
+    TemporaryDirectory directory;
+    DiskCacheImpl diskCache(directory.get());
+
+    auto result = diskCache.store(Path("hello"), createContent("world"));
+    ASSERT_TRUE(result.success()) << result.description();
+
+    auto filePath = STRING_FORMAT("{}/hello", directory.get());
+    ASSERT_EQ(0, chmod(filePath.getCStr(), 0640));
+
+    result = diskCache.storeAtomically(Path("hello"), createContent("nice"));
+    ASSERT_TRUE(result.success()) << result.description();
+
+    struct stat fileStat;
+    ASSERT_EQ(0, stat(filePath.getCStr(), &fileStat));
+    ASSERT_EQ(static_cast<mode_t>(0640), fileStat.st_mode & 0777);
+    ASSERT_EQ(createContent("nice"), diskCache.load(Path("hello")).value());
+}
+
 } // namespace ValdiTest
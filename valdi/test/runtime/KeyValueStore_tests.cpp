@@ -0,0 +1,186 @@
+#include <gtest/gtest.h>
+
+#include "valdi/runtime/Resources/KeyValueStore.hpp"
+#include "valdi_core/cpp/Utils/ByteBuffer.hpp"
+#include "valdi_core/cpp/Utils/Format.hpp"
+#include "valdi_core/cpp/Utils/StringCache.hpp"
+
+using namespace Valdi;
+
+namespace ValdiTest {
+
+static BytesView makeValue(std::string_view str) {
+    return makeShared<ByteBuffer>(str)->toBytesView();
+}
+
+static StringBox makeKey(size_t index) {
+    return StringCache::getGlobal().makeString(STRING_FORMAT("key{}", index).toStringView());
+}
+
+static BytesView makeSnapshot(size_t entriesCount) {
+    KeyValueStore store;
+    store.setCurrentTimeSeconds(100);
+    for (size_t i = 0; i < entriesCount; i++) {
+        store.store(makeKey(i), makeValue(STRING_FORMAT("value{}", i).toStringView()), 0, 1);
+    }
+
+    return store.serialize().value();
+}
+
+TEST(KeyValueStore, fetchesFromSnapshotWithoutCopying) {
+    auto snapshot = makeSnapshot(50);
+
+    KeyValueStore store;
+    store.setCurrentTimeSeconds(100);
+    auto result = store.populate(snapshot);
+    ASSERT_TRUE(result) << result.description();
+    ASSERT_EQ(static_cast<uint64_t>(50), store.getMutationId());
+
+    for (size_t i = 0; i < 50; i++) {
+        auto value = store.fetch(makeKey(i));
+        ASSERT_TRUE(value.has_value());
+        ASSERT_EQ(STRING_FORMAT("value{}", i).toStringView(), value.value().asStringView());
+        ASSERT_TRUE(value.value().data() >= snapshot.begin() && value.value().data() < snapshot.end());
+    }
+
+    ASSERT_FALSE(store.fetch(STRING_LITERAL("unknown")).has_value());
+}
+
+TEST(KeyValueStore, mutationsTakePrecedenceOverSnapshot) {
+    KeyValueStore store;
+    store.setCurrentTimeSeconds(100);
+    ASSERT_TRUE(store.populate(makeSnapshot(10)));
+
+    ASSERT_TRUE(store.remove(makeKey(1)));
+    ASSERT_FALSE(store.exists(makeKey(1)));
+    ASSERT_FALSE(store.remove(makeKey(1)));
+
+    store.store(makeKey(2), makeValue("updated"), 0, 1);
+    ASSERT_EQ("updated", store.fetch(makeKey(2)).value().asStringView());
+
+    // Removing the updated entry should not reveal the one from the snapshot
+    ASSERT_TRUE(store.remove(makeKey(2)));
+    ASSERT_FALSE(store.exists(makeKey(2)));
+
+    auto entries = store.fetchAll();
+    ASSERT_EQ(static_cast<size_t>(8), entries.size());
+
+    store.removeAll();
+    ASSERT_FALSE(store.exists(makeKey(3)));
+    ASSERT_TRUE(store.fetchAll().empty());
+}
+
+TEST(KeyValueStore, keepsEvictionOrderOfSnapshot) {
+    KeyValueStore store;
+    store.setCurrentTimeSeconds(100);
+    ASSERT_TRUE(store.populate(makeSnapshot(10)));
+
+    // Fetching marks the entry as the most recently used one
+    ASSERT_TRUE(store.fetch(makeKey(0)).has_value());
+
+    store.setMaxWeight(2);
+    auto entries = store.fetchAll();
+
+    ASSERT_EQ(static_cast<size_t>(2), entries.size());
+    ASSERT_EQ(makeKey(9), entries[0].first);
+    ASSERT_EQ(makeKey(0), entries[1].first);
+    ASSERT_FALSE(store.exists(makeKey(5)));
+}
+
+TEST(KeyValueStore, replaysJournalOnTopOfSnapshot) {
+    auto snapshot = makeSnapshot(10);
+
+    KeyValueStore store;
+    store.setCurrentTimeSeconds(100);
+    store.setJournalEnabled(true);
+    ASSERT_TRUE(store.populate(snapshot));
+
+    store.store(makeKey(20), makeValue("new"), 0, 1);
+    ASSERT_TRUE(store.remove(makeKey(3)));
+    auto journal = store.takeJournal();
+
+    KeyValueStore restoredStore;
+    restoredStore.setCurrentTimeSeconds(100);
+    ASSERT_TRUE(restoredStore.populate(snapshot));
+    auto result = restoredStore.replayJournal(journal);
+    ASSERT_TRUE(result) << result.description();
+
+    auto entries = store.fetchAll();
+    auto restoredEntries = restoredStore.fetchAll();
+    ASSERT_EQ(entries.size(), restoredEntries.size());
+    for (size_t i = 0; i < entries.size(); i++) {
+        ASSERT_EQ(entries[i].first, restoredEntries[i].first);
+        ASSERT_EQ(entries[i].second.mutationId, restoredEntries[i].second.mutationId);
+        ASSERT_EQ(entries[i].second.data, restoredEntries[i].second.data);
+    }
+}
+
+TEST(KeyValueStore, keepsRecencyOfFetchesInMemory) {
+    KeyValueStore store;
+    store.setCurrentTimeSeconds(100);
+    store.setJournalEnabled(true);
+    ASSERT_TRUE(store.populate(makeSnapshot(10)));
+
+    ASSERT_TRUE(store.fetch(makeKey(0)).has_value());
+    ASSERT_FALSE(store.hasJournal());
+
+    // The recency of the fetch should be persisted with the next snapshot
+    auto snapshot = store.serialize().value();
+    KeyValueStore restoredStore;
+    restoredStore.setCurrentTimeSeconds(100);
+    ASSERT_TRUE(restoredStore.populate(snapshot));
+
+    restoredStore.setMaxWeight(2);
+    auto entries = restoredStore.fetchAll();
+
+    ASSERT_EQ(static_cast<size_t>(2), entries.size());
+    ASSERT_EQ(makeKey(9), entries[0].first);
+    ASSERT_EQ(makeKey(0), entries[1].first);
+}
+
+TEST(KeyValueStore, ignoresExpiredSnapshotEntries) {
+    KeyValueStore store;
+    store.setCurrentTimeSeconds(100);
+    store.store(STRING_LITERAL("expiring"), makeValue("value"), 10, 1);
+    store.store(STRING_LITERAL("persistent"), makeValue("value"), 0, 1);
+    auto snapshot = store.serialize().value();
+
+    KeyValueStore restoredStore;
+    restoredStore.setCurrentTimeSeconds(200);
+    ASSERT_TRUE(restoredStore.populate(snapshot));
+
+    ASSERT_FALSE(restoredStore.exists(STRING_LITERAL("expiring")));
+    ASSERT_TRUE(restoredStore.exists(STRING_LITERAL("persistent")));
+    ASSERT_EQ(static_cast<size_t>(1), restoredStore.fetchAll().size());
+}
+
+TEST(KeyValueStore, journalsRemovalOfExpiredEntries) {
+    KeyValueStore store;
+    store.setCurrentTimeSeconds(100);
+    store.store(STRING_LITERAL("expiring"), makeValue("value"), 10, 1);
+    auto snapshot = store.serialize().value();
+
+    KeyValueStore restoredStore;
+    restoredStore.setCurrentTimeSeconds(200);
+    restoredStore.setJournalEnabled(true);
+    ASSERT_TRUE(restoredStore.populate(snapshot));
+
+    ASSERT_FALSE(restoredStore.fetch(STRING_LITERAL("expiring")).has_value());
+    ASSERT_TRUE(restoredStore.hasJournal());
+
+    // Replayed before the expiration date, only the journaled removal hides the entry
+    KeyValueStore replayedStore;
+    replayedStore.setCurrentTimeSeconds(100);
+    ASSERT_TRUE(replayedStore.populate(snapshot));
+    ASSERT_TRUE(replayedStore.replayJournal(restoredStore.takeJournal()));
+    ASSERT_FALSE(replayedStore.exists(STRING_LITERAL("expiring")));
+}
+
+TEST(KeyValueStore, rejectsTruncatedSnapshot) {
+    auto snapshot = makeSnapshot(10);
+
+    KeyValueStore store;
+    ASSERT_FALSE(store.populate(snapshot.subrange(0, 64)));
+}
+
+} // namespace ValdiTest
@@ -453,6 +453,165 @@ TEST(PersistentStore, restoredCacheSupportsEviction) {
     ASSERT_EQ(STRING_LITERAL("item4"), entries[1].first);
 }
 
+static Ref<PersistentStore> makeJournaledStore(PersistentStoreDependencies& dependencies,
+                                               const Shared<snap::valdi::Keychain>& keychain,
+                                               uint64_t maxWeight = 0) {
+    auto store = Valdi::makeShared<PersistentStore>(STRING_LITERAL("somepath"),
+                                                    dependencies.diskCache,
+                                                    nullptr,
+                                                    keychain,
+                                                    dependencies.dispatchQueue,
+                                                    dependencies.logger,
+                                                    maxWeight,
+                                                    true);
+    store->populate();
+    dependencies.dispatchQueue->sync([]() {});
+    return store;
+}
+
+static Result<BytesView> fetchSync(const Ref<PersistentStore>& store, const char* key) {
+    SharedAtomic<Result<BytesView>> fetchResult;
+    AsyncGroup group;
+
+    group.enter();
+    store->fetch(StringCache::getGlobal().makeStringFromLiteral(key), [&](const auto& result) {
+        fetchResult.set(result);
+        group.leave();
+    });
+    group.blockingWaitWithTimeout(std::chrono::seconds(5));
+
+    return fetchResult.get();
+}
+
+TEST(PersistentStore, appendsMutationsToJournalAfterSnapshot) {
+    PersistentStoreDependencies dependencies;
+    auto store = makeJournaledStore(dependencies, nullptr);
+
+    store->store(STRING_LITERAL("item1"), makeShared<ByteBuffer>("Hello")->toBytesView(), 0, 0, [](const auto&) {});
+    dependencies.dispatchQueue->sync([]() {});
+
+    auto snapshot = dependencies.diskCache->load(Path("global/somepath"));
+    ASSERT_TRUE(snapshot) << snapshot.description();
+    ASSERT_FALSE(dependencies.diskCache->exists(Path("global/somepath.journal")));
+
+    store->store(STRING_LITERAL("item2"), makeShared<ByteBuffer>("World")->toBytesView(), 0, 0, [](const auto&) {});
+    store->remove(STRING_LITERAL("item1"), [](const auto&) {});
+    dependencies.dispatchQueue->sync([]() {});
+
+    // The snapshot should be left untouched
+    auto newSnapshot = dependencies.diskCache->load(Path("global/somepath"));
+    ASSERT_TRUE(newSnapshot) << newSnapshot.description();
+    ASSERT_TRUE(snapshot.value().isStrictlyIdenticalTo(newSnapshot.value()));
+
+    auto journal = dependencies.diskCache->load(Path("global/somepath.journal"));
+    ASSERT_TRUE(journal) << journal.description();
+    ASSERT_TRUE(StringCache::getGlobal().makeString(journal.value().asStringView()).contains("World"));
+
+    // Restore the instance from the snapshot and the journal
+    store = makeJournaledStore(dependencies, nullptr);
+
+    ASSERT_FALSE(fetchSync(store, "item1").success());
+    auto item2 = fetchSync(store, "item2");
+    ASSERT_TRUE(item2) << item2.description();
+    ASSERT_EQ("World", item2.value().asStringView());
+}
+
+TEST(PersistentStore, encryptsJournalWhenKeychainSet) {
+    PersistentStoreDependencies dependencies;
+    auto store = makeJournaledStore(dependencies, dependencies.keyChain);
+
+    store->store(STRING_LITERAL("item1"), makeShared<ByteBuffer>("Hello")->toBytesView(), 0, 0, [](const auto&) {});
+    store->store(STRING_LITERAL("item2"), makeShared<ByteBuffer>("World")->toBytesView(), 0, 0, [](const auto&) {});
+    dependencies.dispatchQueue->sync([]() {});
+
+    auto journal = dependencies.diskCache->load(Path("global/somepath.journal"));
+    ASSERT_TRUE(journal) << journal.description();
+    ASSERT_FALSE(StringCache::getGlobal().makeString(journal.value().asStringView()).contains("World"));
+
+    store = makeJournaledStore(dependencies, dependencies.keyChain);
+
+    auto item1 = fetchSync(store, "item1");
+    ASSERT_TRUE(item1) << item1.description();
+    ASSERT_EQ("Hello", item1.value().asStringView());
+    auto item2 = fetchSync(store, "item2");
+    ASSERT_TRUE(item2) << item2.description();
+    ASSERT_EQ("World", item2.value().asStringView());
+}
+
+TEST(PersistentStore, replaysRemoveAllFromJournal) {
+    PersistentStoreDependencies dependencies;
+    auto store = makeJournaledStore(dependencies, nullptr);
+
+    store->store(STRING_LITERAL("item1"), makeShared<ByteBuffer>("Hello")->toBytesView(), 0, 0, [](const auto&) {});
+    store->removeAll([](const auto&) {});
+    store->store(STRING_LITERAL("item2"), makeShared<ByteBuffer>("World")->toBytesView(), 0, 0, [](const auto&) {});
+    dependencies.dispatchQueue->sync([]() {});
+
+    ASSERT_TRUE(dependencies.diskCache->exists(Path("global/somepath.journal")));
+
+    store = makeJournaledStore(dependencies, nullptr);
+
+    ASSERT_FALSE(fetchSync(store, "item1").success());
+    ASSERT_TRUE(fetchSync(store, "item2").success());
+}
+
+TEST(PersistentStore, recoversFromPartiallyWrittenJournal) {
+    PersistentStoreDependencies dependencies;
+    auto store = makeJournaledStore(dependencies, nullptr);
+
+    store->store(STRING_LITERAL("item1"), makeShared<ByteBuffer>("Hello")->toBytesView(), 0, 0, [](const auto&) {});
+    store->store(STRING_LITERAL("item2"), makeShared<ByteBuffer>("World")->toBytesView(), 0, 0, [](const auto&) {});
+    store->store(STRING_LITERAL("item3"), makeShared<ByteBuffer>("Again")->toBytesView(), 0, 0, [](const auto&) {});
+    dependencies.dispatchQueue->sync([]() {});
+
+    // Simulate a crash in the middle of the last append
+    auto journal = dependencies.diskCache->load(Path("global/somepath.journal"));
+    ASSERT_TRUE(journal) << journal.description();
+    auto truncatedJournal = journal.value().subrange(0, journal.value().size() - 4);
+    ASSERT_TRUE(dependencies.diskCache->store(Path("global/somepath.journal"), truncatedJournal));
+
+    store = makeJournaledStore(dependencies, nullptr);
+
+    ASSERT_TRUE(fetchSync(store, "item1").success());
+    ASSERT_TRUE(fetchSync(store, "item2").success());
+    ASSERT_FALSE(fetchSync(store, "item3").success());
+
+    // The next save should write a new snapshot, leaving the damaged journal behind
+    store->store(STRING_LITERAL("item4"), makeShared<ByteBuffer>("Last")->toBytesView(), 0, 0, [](const auto&) {});
+    dependencies.dispatchQueue->sync([]() {});
+
+    ASSERT_FALSE(dependencies.diskCache->exists(Path("global/somepath.journal")));
+
+    store = makeJournaledStore(dependencies, nullptr);
+
+    ASSERT_TRUE(fetchSync(store, "item1").success());
+    ASSERT_TRUE(fetchSync(store, "item2").success());
+    ASSERT_TRUE(fetchSync(store, "item4").success());
+}
+
+TEST(PersistentStore, evictsEntriesOverMaxWeightWhenAppendingToJournal) {
+    PersistentStoreDependencies dependencies;
+    auto store = makeJournaledStore(dependencies, nullptr, 10);
+
+    store->store(STRING_LITERAL("item1"), makeShared<ByteBuffer>("Hello")->toBytesView(), 0, 4, [](const auto&) {});
+    dependencies.dispatchQueue->sync([]() {});
+    ASSERT_FALSE(dependencies.diskCache->exists(Path("global/somepath.journal")));
+
+    store->store(STRING_LITERAL("item2"), makeShared<ByteBuffer>("World")->toBytesView(), 0, 4, [](const auto&) {});
+    store->store(STRING_LITERAL("item3"), makeShared<ByteBuffer>("Again")->toBytesView(), 0, 4, [](const auto&) {});
+    dependencies.dispatchQueue->sync([]() {});
+
+    // The mutations were saved without compacting, the eviction should still have happened
+    ASSERT_TRUE(dependencies.diskCache->exists(Path("global/somepath.journal")));
+    ASSERT_FALSE(fetchSync(store, "item1").success());
+
+    store = makeJournaledStore(dependencies, nullptr, 10);
+
+    ASSERT_FALSE(fetchSync(store, "item1").success());
+    ASSERT_TRUE(fetchSync(store, "item2").success());
+    ASSERT_TRUE(fetchSync(store, "item3").success());
+}
+
 static BytesView makeBytes(std::initializer_list<Byte> data) {
     auto output = makeShared<ByteBuffer>();
     output->set(data);
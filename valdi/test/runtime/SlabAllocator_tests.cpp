@@ -0,0 +1,159 @@
+#include "valdi_core/cpp/Utils/SlabAllocator.hpp"
+#include <gtest/gtest.h>
+
+#include <thread>
+#include <vector>
+
+using namespace Valdi;
+
+namespace ValdiTest {
+
+struct SlabObject : public SharedPtrRefCountable {
+    explicit SlabObject(int value) : value(value) {}
+
+    int value;
+};
+
+TEST(SlabAllocator, reusesReleasedBlocks) {
+    auto allocator = makeShared<SlabAllocator>();
+
+    auto* block1 = allocator->allocate(40);
+    auto* block2 = allocator->allocate(48);
+    ASSERT_NE(block1, block2);
+    ASSERT_EQ(static_cast<size_t>(2), allocator->getLiveBlocksCount());
+    ASSERT_EQ(static_cast<size_t>(1), allocator->getSlabsCount());
+
+    SlabAllocator::deallocate(block1, 40);
+    ASSERT_EQ(static_cast<size_t>(1), allocator->getLiveBlocksCount());
+
+    // Same size class as the released block
+    auto* block3 = allocator->allocate(33);
+    ASSERT_EQ(block1, block3);
+    ASSERT_EQ(static_cast<size_t>(1), allocator->getSlabsCount());
+
+    SlabAllocator::deallocate(block2, 48);
+    SlabAllocator::deallocate(block3, 33);
+    ASSERT_EQ(static_cast<size_t>(0), allocator->getLiveBlocksCount());
+}
+
+TEST(SlabAllocator, forwardsLargeAllocationsToSystemAllocator) {
+    auto allocator = makeShared<SlabAllocator>();
+
+    auto* block = allocator->allocate(SlabAllocator::kMaxBlockSize + 1);
+    ASSERT_NE(nullptr, block);
+    ASSERT_EQ(static_cast<size_t>(0), allocator->getLiveBlocksCount());
+    ASSERT_EQ(static_cast<size_t>(0), allocator->getSlabsCount());
+
+    SlabAllocator::deallocate(block, SlabAllocator::kMaxBlockSize + 1);
+}
+
+TEST(SlabAllocator, growsSlabs) {
+    auto allocator = makeShared<SlabAllocator>();
+
+    std::vector<void*> blocks;
+    for (size_t i = 0; i < 1000; i++) {
+        blocks.emplace_back(allocator->allocate(64));
+    }
+
+    ASSERT_EQ(static_cast<size_t>(1000), allocator->getLiveBlocksCount());
+    ASSERT_GE(allocator->getSlabsSize(), static_cast<size_t>(64 * 1000));
+    ASSERT_LT(allocator->getSlabsSize(), static_cast<size_t>(64 * 1000 * 2));
+
+    for (auto* block : blocks) {
+        SlabAllocator::deallocate(block, 64);
+    }
+    ASSERT_EQ(static_cast<size_t>(0), allocator->getLiveBlocksCount());
+}
+
+TEST(SlabAllocator, releasesEmptySlabs) {
+    auto allocator = makeShared<SlabAllocator>();
+
+    std::vector<void*> blocks;
+    for (size_t i = 0; i < 1000; i++) {
+        blocks.emplace_back(allocator->allocate(64));
+    }
+    auto slabsCount = allocator->getSlabsCount();
+    ASSERT_GT(slabsCount, static_cast<size_t>(2));
+
+    // Keep one block alive in the first slab
+    for (size_t i = 1; i < blocks.size(); i++) {
+        SlabAllocator::deallocate(blocks[i], 64);
+    }
+    ASSERT_EQ(slabsCount, allocator->getSlabsCount());
+
+    allocator->releaseEmptySlabs();
+
+    // The slab with the live block and the slab being allocated from are kept
+    ASSERT_EQ(static_cast<size_t>(2), allocator->getSlabsCount());
+    ASSERT_EQ(static_cast<size_t>(1), allocator->getLiveBlocksCount());
+
+    SlabAllocator::deallocate(blocks[0], 64);
+    allocator->releaseEmptySlabs();
+    ASSERT_EQ(static_cast<size_t>(1), allocator->getSlabsCount());
+}
+
+TEST(SlabAllocator, reusesBlocksReleasedFromOtherThreads) {
+    auto allocator = makeShared<SlabAllocator>();
+
+    std::vector<void*> blocks;
+    for (size_t i = 0; i < 1000; i++) {
+        blocks.emplace_back(allocator->allocate(64));
+    }
+    auto slabsCount = allocator->getSlabsCount();
+
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < 4; i++) {
+        threads.emplace_back([&blocks, i]() {
+            for (size_t j = i; j < blocks.size(); j += 4) {
+                SlabAllocator::deallocate(blocks[j], 64);
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    ASSERT_EQ(static_cast<size_t>(0), allocator->getLiveBlocksCount());
+
+    for (auto& block : blocks) {
+        block = allocator->allocate(64);
+    }
+    ASSERT_EQ(static_cast<size_t>(1000), allocator->getLiveBlocksCount());
+    ASSERT_EQ(slabsCount, allocator->getSlabsCount());
+
+    for (auto* block : blocks) {
+        SlabAllocator::deallocate(block, 64);
+    }
+}
+
+TEST(SlabAllocator, objectsOutliveAllocator) {
+    auto allocator = makeShared<SlabAllocator>();
+
+    auto object = allocateShared<SlabObject>(allocator.get(), 42);
+    auto weakObject = weakRef(object.get());
+    ASSERT_EQ(static_cast<size_t>(1), allocator->getLiveBlocksCount());
+
+    allocator = nullptr;
+
+    ASSERT_EQ(42, object->value);
+
+    // Release the object from another thread, its slab should be freed along with
+    // the ref count once the weak reference is gone.
+    std::thread([&]() { object = nullptr; }).join();
+
+    ASSERT_EQ(nullptr, weakObject.lock());
+}
+
+TEST(SlabAllocator, canAllocateTaggedBlocks) {
+    auto allocator = makeShared<SlabAllocator>();
+
+    auto* slabBlock = SlabAllocator::allocateTagged(allocator.get(), 24);
+    auto* systemBlock = SlabAllocator::allocateTagged(nullptr, 24);
+    ASSERT_EQ(static_cast<size_t>(0), reinterpret_cast<uintptr_t>(slabBlock) % SlabAllocator::kBlockAlignment);
+    ASSERT_EQ(static_cast<size_t>(1), allocator->getLiveBlocksCount());
+
+    SlabAllocator::deallocateTagged(slabBlock);
+    SlabAllocator::deallocateTagged(systemBlock);
+    ASSERT_EQ(static_cast<size_t>(0), allocator->getLiveBlocksCount());
+}
+
+} // namespace ValdiTest
@@ -60,7 +60,7 @@ TEST(StringCache, canDeallocConcurrently) {
         StringBox str2;
         StringBox str3;
 
-        auto lock = cache.lock();
+        auto lock = cache.lock("StringToTest");
 
         queue1->async([&]() {
             // In Thread1, we release the string
@@ -80,4 +80,45 @@ TEST(StringCache, canDeallocConcurrently) {
     }
 }
 
+TEST(StringCache, canInternConcurrently) {
+    auto& cache = StringCache::getGlobal();
+
+    constexpr size_t kQueuesCount = 4;
+    constexpr size_t kStringsCount = 2000;
+
+    std::vector<Ref<DispatchQueue>> queues;
+    std::vector<std::vector<StringBox>> results(kQueuesCount);
+    for (size_t i = 0; i < kQueuesCount; i++) {
+        queues.emplace_back(DispatchQueue::create(STRING_LITERAL("StringCacheThread"), ThreadQoSClassMax));
+    }
+
+    for (size_t i = 0; i < kQueuesCount; i++) {
+        queues[i]->async([&, i]() {
+            for (size_t j = 0; j < kStringsCount; j++) {
+                auto str = "ConcurrentString" + std::to_string(j);
+                // Interleave releases with lookups so that strings are removed while being looked up
+                cache.makeString(str);
+                results[i].emplace_back(cache.makeString(str));
+            }
+        });
+    }
+
+    for (const auto& queue : queues) {
+        queue->sync([]() {});
+    }
+
+    for (size_t j = 0; j < kStringsCount; j++) {
+        auto expected = "ConcurrentString" + std::to_string(j);
+        for (size_t i = 0; i < kQueuesCount; i++) {
+            ASSERT_EQ(expected, results[i][j].toStringView());
+            ASSERT_EQ(results[0][j].getInternedString(), results[i][j].getInternedString());
+        }
+    }
+
+    results.clear();
+
+    ASSERT_FALSE(containsStringInCache(cache, "ConcurrentString0"));
+    ASSERT_FALSE(containsStringInCache(cache, "ConcurrentString1999"));
+}
+
 } // namespace ValdiTest
@@ -5,8 +5,10 @@
 //  Created by Simon Corsin on 03/05/23
 //
 
+#include "valdi_core/cpp/Threading/StrandDispatchQueue.hpp"
 #include "valdi_core/cpp/Threading/TaskQueue.hpp"
 #include "valdi_core/cpp/Threading/ThreadedDispatchQueue.hpp"
+#include "valdi_core/cpp/Threading/WorkStealingExecutor.hpp"
 #include "valdi_core/cpp/Utils/ConsoleLogger.hpp"
 #include "valdi_core/cpp/Utils/StringCache.hpp"
 #include "valdi_core/cpp/Utils/TrackedLock.hpp"
@@ -14,6 +16,7 @@
 
 #include <atomic>
 #include <chrono>
+#include <future>
 #include <thread>
 
 using namespace Valdi;
@@ -92,6 +95,366 @@ TEST(TaskQueue, barrierDoesNotAllowOtherTaskToRun) {
     ASSERT_TRUE(innerTaskRan);
 }
 
+TEST(TaskQueue, runsTasksInExecuteTimeOrder) {
+    auto now = std::chrono::steady_clock::now();
+    TaskQueue taskQueue;
+    std::vector<int> order;
+
+    taskQueue.enqueue([&]() { order.emplace_back(3); }, now - std::chrono::milliseconds(10));
+    taskQueue.enqueue([&]() { order.emplace_back(4); });
+    taskQueue.enqueue([&]() { order.emplace_back(1); }, now - std::chrono::milliseconds(30));
+    taskQueue.enqueue([&]() { order.emplace_back(5); });
+    taskQueue.enqueue([&]() { order.emplace_back(2); }, now - std::chrono::milliseconds(20));
+    taskQueue.enqueue([&]() { order.emplace_back(6); }, std::chrono::milliseconds(1));
+
+    ASSERT_EQ(static_cast<size_t>(5), taskQueue.flushUpToNow());
+    ASSERT_EQ(std::vector<int>({1, 2, 3, 4, 5}), order);
+
+    ASSERT_TRUE(taskQueue.runNextTask(std::chrono::steady_clock::now() + std::chrono::seconds(1)));
+    ASSERT_EQ(std::vector<int>({1, 2, 3, 4, 5, 6}), order);
+}
+
+TEST(TaskQueue, canCancelImmediateAndDelayedTasks) {
+    TaskQueue taskQueue;
+    std::vector<int> order;
+
+    auto id1 = taskQueue.enqueue([&]() { order.emplace_back(1); }).id;
+    taskQueue.enqueue([&]() { order.emplace_back(2); });
+    auto id3 = taskQueue.enqueue([&]() { order.emplace_back(3); }, std::chrono::milliseconds(1)).id;
+    taskQueue.enqueue([&]() { order.emplace_back(4); }, std::chrono::milliseconds(2));
+
+    taskQueue.cancel(id1);
+    taskQueue.cancel(id3);
+    // Cancelling twice should be a no-op
+    taskQueue.cancel(id3);
+
+    while (taskQueue.runNextTask(std::chrono::steady_clock::now() + std::chrono::milliseconds(50))) {
+    }
+
+    ASSERT_EQ(std::vector<int>({2, 4}), order);
+}
+
+TEST(TaskQueue, canCancelManyDelayedTasks) {
+    TaskQueue taskQueue;
+    std::vector<task_id_t> taskIds;
+    size_t ranTasks = 0;
+
+    for (size_t i = 0; i < 1000; i++) {
+        taskIds.emplace_back(
+            taskQueue.enqueue([&]() { ranTasks++; }, std::chrono::milliseconds(static_cast<int>(i % 10))).id);
+    }
+
+    for (size_t i = 0; i < taskIds.size(); i++) {
+        if (i % 4 != 0) {
+            taskQueue.cancel(taskIds[i]);
+        }
+    }
+
+    while (taskQueue.runNextTask(std::chrono::steady_clock::now() + std::chrono::milliseconds(50))) {
+    }
+
+    ASSERT_EQ(static_cast<size_t>(250), ranTasks);
+}
+
+TEST(TaskQueue, lockFreeAsyncPreservesSubmissionOrder) {
+    TaskQueue taskQueue;
+    taskQueue.setLockFreeAsyncEnabled(true);
+    std::vector<int> order;
+
+    ASSERT_TRUE(taskQueue.enqueueAsync([&]() { order.emplace_back(1); }).isFirst);
+    ASSERT_FALSE(taskQueue.enqueueAsync([&]() { order.emplace_back(2); }).isFirst);
+    taskQueue.enqueue([&]() { order.emplace_back(3); });
+    taskQueue.async([&]() { order.emplace_back(4); });
+    taskQueue.sync([&]() { order.emplace_back(5); });
+
+    ASSERT_EQ(std::vector<int>({1, 2, 3, 4, 5}), order);
+}
+
+TEST(ThreadedDispatchQueue, lockFreeAsyncRunsTasksFromManyProducers) {
+    auto dispatchQueue = makeShared<ThreadedDispatchQueue>(STRING_LITERAL("Test Queue"), ThreadQoSClassNormal);
+    dispatchQueue->setLockFreeAsyncEnabled(true);
+
+    constexpr size_t kProducersCount = 4;
+    constexpr size_t kTasksPerProducer = 1000;
+    std::atomic<size_t> ranTasks(0);
+    std::vector<std::thread> producers;
+
+    for (size_t i = 0; i < kProducersCount; i++) {
+        producers.emplace_back([&]() {
+            for (size_t j = 0; j < kTasksPerProducer; j++) {
+                dispatchQueue->async([&]() { ranTasks++; });
+            }
+        });
+    }
+
+    for (auto& producer : producers) {
+        producer.join();
+    }
+    dispatchQueue->sync([]() {});
+
+    ASSERT_EQ(kProducersCount * kTasksPerProducer, ranTasks.load());
+}
+
+TEST(WorkStealingExecutor, runsSubmittedTasks) {
+    auto executor = makeShared<WorkStealingExecutor>(4);
+
+    constexpr size_t kTasksCount = 1000;
+    std::atomic<size_t> ranTasks(0);
+    Mutex mutex;
+    ConditionVariable condition;
+
+    for (size_t i = 0; i < kTasksCount; i++) {
+        executor->submit(
+            [&]() {
+                if (++ranTasks == kTasksCount) {
+                    std::lock_guard<Mutex> lock(mutex);
+                    condition.notifyAll();
+                }
+            },
+            i % 2 == 0 ? ThreadQoSClassHigh : ThreadQoSClassLow);
+    }
+
+    {
+        std::unique_lock<Mutex> lock(mutex);
+        while (ranTasks.load() != kTasksCount) {
+            condition.wait(lock);
+        }
+    }
+
+    executor->teardown();
+    ASSERT_EQ(kTasksCount, ranTasks.load());
+}
+
+TEST(WorkStealingExecutor, parallelForCallsEveryIndexOnce) {
+    auto executor = makeShared<WorkStealingExecutor>(4);
+
+    constexpr size_t kIndexesCount = 1000;
+    std::vector<std::atomic<size_t>> calls(kIndexesCount);
+
+    executor->parallelFor(kIndexesCount, ThreadQoSClassHigh, [&](size_t index) { calls[index]++; });
+
+    for (size_t i = 0; i < kIndexesCount; i++) {
+        ASSERT_EQ(static_cast<size_t>(1), calls[i].load());
+    }
+
+    // Also completes when called from one of the workers
+    std::atomic_bool didComplete(false);
+    executor->submit(
+        [&]() {
+            executor->parallelFor(kIndexesCount, ThreadQoSClassHigh, [&](size_t index) { calls[index]++; });
+            didComplete = true;
+        },
+        ThreadQoSClassHigh);
+
+    while (!didComplete) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    for (size_t i = 0; i < kIndexesCount; i++) {
+        ASSERT_EQ(static_cast<size_t>(2), calls[i].load());
+    }
+
+    executor->teardown();
+}
+
+TEST(WorkStealingExecutor, parallelForCompletesWhenWorkersAreBusy) {
+    auto executor = makeShared<WorkStealingExecutor>(2);
+
+    // Block every worker until the parallelFor has returned
+    std::promise<void> unblockPromise;
+    auto unblockFuture = unblockPromise.get_future().share();
+    std::atomic<size_t> blockedWorkers(0);
+    for (size_t i = 0; i < executor->getWorkersCount(); i++) {
+        executor->submit(
+            [&, unblockFuture]() {
+                blockedWorkers++;
+                unblockFuture.wait();
+            },
+            ThreadQoSClassHigh);
+    }
+    while (blockedWorkers.load() != executor->getWorkersCount()) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    constexpr size_t kIndexesCount = 100;
+    std::vector<size_t> calls(kIndexesCount);
+    std::vector<size_t> order;
+    executor->parallelFor(kIndexesCount, 4, ThreadQoSClassNormal, [&](size_t index) {
+        calls[index]++;
+        order.emplace_back(index);
+    });
+
+    // Every index was called in order from the calling thread
+    ASSERT_EQ(kIndexesCount, order.size());
+    for (size_t i = 0; i < kIndexesCount; i++) {
+        ASSERT_EQ(static_cast<size_t>(1), calls[i]);
+        ASSERT_EQ(i, order[i]);
+    }
+
+    // The helpers which were submitted only find that no index is left once the workers are released
+    unblockPromise.set_value();
+
+    executor->teardown();
+}
+
+TEST(WorkStealingExecutor, parallelForCompletesAfterTeardown) {
+    auto executor = makeShared<WorkStealingExecutor>(4);
+    executor->teardown();
+
+    constexpr size_t kIndexesCount = 100;
+    std::vector<size_t> calls(kIndexesCount);
+    executor->parallelFor(kIndexesCount, ThreadQoSClassHigh, [&](size_t index) { calls[index]++; });
+
+    for (size_t i = 0; i < kIndexesCount; i++) {
+        ASSERT_EQ(static_cast<size_t>(1), calls[i]);
+    }
+}
+
+TEST(WorkStealingExecutor, parallelForLimitsConcurrency) {
+    auto executor = makeShared<WorkStealingExecutor>(8);
+
+    constexpr size_t kIndexesCount = 200;
+    std::atomic<size_t> runningCalls(0);
+    std::atomic<size_t> maxRunningCalls(0);
+    executor->parallelFor(kIndexesCount, 2, ThreadQoSClassHigh, [&](size_t /*index*/) {
+        auto running = ++runningCalls;
+        auto currentMax = maxRunningCalls.load();
+        while (running > currentMax && !maxRunningCalls.compare_exchange_weak(currentMax, running)) {
+        }
+        std::this_thread::sleep_for(std::chrono::microseconds(100));
+        runningCalls--;
+    });
+
+    ASSERT_LE(maxRunningCalls.load(), static_cast<size_t>(2));
+
+    executor->teardown();
+}
+
+TEST(StrandDispatchQueue, runsTasksSeriallyInOrder) {
+    auto executor = makeShared<WorkStealingExecutor>(4);
+    auto strand = makeShared<StrandDispatchQueue>(STRING_LITERAL("Test Strand"), ThreadQoSClassNormal, executor);
+
+    constexpr size_t kTasksCount = 5000;
+    std::vector<size_t> order;
+    std::atomic<size_t> runningTasks(0);
+    std::atomic_bool sawConcurrentTasks(false);
+    std::atomic_bool sawNonCurrent(false);
+
+    for (size_t i = 0; i < kTasksCount; i++) {
+        strand->async([&, i]() {
+            if (++runningTasks != 1) {
+                sawConcurrentTasks = true;
+            }
+            if (!strand->isCurrent() || DispatchQueue::getCurrent() != strand.get()) {
+                sawNonCurrent = true;
+            }
+            order.emplace_back(i);
+            runningTasks--;
+        });
+    }
+
+    strand->sync([]() {});
+
+    ASSERT_FALSE(sawConcurrentTasks);
+    ASSERT_FALSE(sawNonCurrent);
+    ASSERT_EQ(kTasksCount, order.size());
+    for (size_t i = 0; i < kTasksCount; i++) {
+        ASSERT_EQ(i, order[i]);
+    }
+
+    strand->fullTeardown();
+    executor->teardown();
+}
+
+TEST(StrandDispatchQueue, canCancelDelayedTasks) {
+    auto executor = makeShared<WorkStealingExecutor>(2);
+    auto strand = makeShared<StrandDispatchQueue>(STRING_LITERAL("Test Strand"), ThreadQoSClassNormal, executor);
+
+    std::atomic_bool cancelledTaskRan(false);
+    std::atomic_bool delayedTaskRan(false);
+    Mutex mutex;
+    ConditionVariable condition;
+
+    auto taskId = strand->asyncAfter([&]() { cancelledTaskRan = true; }, std::chrono::milliseconds(10));
+    strand->asyncAfter(
+        [&]() {
+            std::lock_guard<Mutex> lock(mutex);
+            delayedTaskRan = true;
+            condition.notifyAll();
+        },
+        std::chrono::milliseconds(20));
+    strand->cancel(taskId);
+
+    {
+        std::unique_lock<Mutex> lock(mutex);
+        while (!delayedTaskRan) {
+            condition.wait(lock);
+        }
+    }
+
+    ASSERT_FALSE(cancelledTaskRan);
+
+    strand->fullTeardown();
+    executor->teardown();
+}
+
+#if !__APPLE__
+TEST(DispatchQueue, createKeepsADedicatedThread) {
+    auto queue = DispatchQueue::create(STRING_LITERAL("Test Queue"), ThreadQoSClassNormal);
+
+    std::promise<std::thread::id> firstThreadId;
+    std::promise<std::thread::id> secondThreadId;
+    queue->async([&]() { firstThreadId.set_value(std::this_thread::get_id()); });
+    queue->async([&]() { secondThreadId.set_value(std::this_thread::get_id()); });
+
+    auto threadId = firstThreadId.get_future().get();
+    ASSERT_NE(std::this_thread::get_id(), threadId);
+    ASSERT_EQ(threadId, secondThreadId.get_future().get());
+    ASSERT_EQ(nullptr, dynamic_cast<StrandDispatchQueue*>(queue.get()));
+
+    queue->fullTeardown();
+}
+
+TEST(DispatchQueue, createStrandRunsOnSharedExecutor) {
+    auto queue = DispatchQueue::createStrand(STRING_LITERAL("Test Strand"), ThreadQoSClassNormal);
+    ASSERT_NE(nullptr, dynamic_cast<StrandDispatchQueue*>(queue.get()));
+
+    bool isCurrent = false;
+    queue->sync([&]() { isCurrent = queue->isCurrent() && DispatchQueue::getCurrent() == queue.get(); });
+
+    ASSERT_TRUE(isCurrent);
+
+    queue->fullTeardown();
+}
+
+TEST(DispatchQueue, getCurrentReturnsInnermostQueue) {
+    auto strand = DispatchQueue::createStrand(STRING_LITERAL("Test Strand"), ThreadQoSClassNormal);
+    auto threadedQueue = DispatchQueue::createThreaded(STRING_LITERAL("Test Queue"), ThreadQoSClassNormal);
+
+    DispatchQueue* currentInThreadedQueue = nullptr;
+    DispatchQueue* currentInNestedStrand = nullptr;
+    DispatchQueue* currentAfterThreadedQueue = nullptr;
+    strand->sync([&]() {
+        threadedQueue->sync([&]() {
+            currentInThreadedQueue = DispatchQueue::getCurrent();
+            auto nestedStrand = DispatchQueue::createStrand(STRING_LITERAL("Nested Strand"), ThreadQoSClassNormal);
+            nestedStrand->sync([&]() { currentInNestedStrand = DispatchQueue::getCurrent(); });
+            nestedStrand->fullTeardown();
+        });
+        currentAfterThreadedQueue = DispatchQueue::getCurrent();
+    });
+
+    ASSERT_EQ(threadedQueue.get(), currentInThreadedQueue);
+    ASSERT_NE(nullptr, currentInNestedStrand);
+    ASSERT_NE(threadedQueue.get(), currentInNestedStrand);
+    ASSERT_NE(strand.get(), currentInNestedStrand);
+    ASSERT_EQ(strand.get(), currentAfterThreadedQueue);
+
+    threadedQueue->fullTeardown();
+    strand->fullTeardown();
+}
+#endif
+
 TEST(TrackedLock, canDropTrackedLocks) {
     auto mutex = makeShared<RecursiveMutex>();
     TrackedLock lock1(*mutex);
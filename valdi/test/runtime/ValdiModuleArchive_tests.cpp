@@ -0,0 +1,333 @@
+#include "valdi/runtime/Resources/ValdiModuleArchive.hpp"
+#include "valdi/runtime/Resources/ZStdUtils.hpp"
+#include "valdi_core/cpp/Resources/ValdiArchive.hpp"
+#include "valdi_core/cpp/Utils/StringCache.hpp"
+#include "zdict.h"
+#include "zstd.h"
+#include <cstring>
+#include <gtest/gtest.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace Valdi;
+
+namespace ValdiTest {
+
+namespace {
+
+struct SeekableEntry {
+    std::string path;
+    std::string data;
+    bool compress;
+};
+
+template<typename T>
+void appendValue(std::vector<Byte>& output, T value) {
+    const auto* bytes = reinterpret_cast<const Byte*>(&value);
+    output.insert(output.end(), bytes, bytes + sizeof(T));
+}
+
+std::string makeSampleContent(size_t index) {
+    return "{\"type\": \"component\", \"name\": \"Component" + std::to_string(index) +
+           "\", \"render\": \"function render() { return <view/>; }\", \"index\": " + std::to_string(index * 7) + "}";
+}
+
+std::vector<Byte> trainDictionary() {
+    std::string samples;
+    std::vector<size_t> sampleSizes;
+    for (size_t i = 0; i < 256; i++) {
+        auto sample = makeSampleContent(i);
+        samples += sample;
+        sampleSizes.emplace_back(sample.size());
+    }
+
+    std::vector<Byte> dictionary(1024);
+    auto dictionarySize = ZDICT_trainFromBuffer(dictionary.data(),
+                                                dictionary.size(),
+                                                samples.data(),
+                                                sampleSizes.data(),
+                                                static_cast<unsigned>(sampleSizes.size()));
+    EXPECT_FALSE(ZDICT_isError(dictionarySize)) << ZDICT_getErrorName(dictionarySize);
+    dictionary.resize(dictionarySize);
+    return dictionary;
+}
+
+// Mirrors the seekable archive writer of the compiler (ValdiModuleBuilder.swift)
+std::vector<Byte> buildSeekableArchive(const std::vector<SeekableEntry>& entries,
+                                       const std::vector<Byte>* dictionary = nullptr,
+                                       bool embedDictionary = false) {
+    std::string paths;
+    std::vector<Byte> entriesData;
+    std::vector<Byte> index;
+
+    auto indexOffset = embedDictionary ? 32 : 16;
+    auto dictionaryOffset = indexOffset + entries.size() * 40;
+    for (const auto& entry : entries) {
+        dictionaryOffset += entry.path.size();
+    }
+    auto entriesDataOffset = dictionaryOffset + (embedDictionary ? dictionary->size() : 0);
+
+    for (const auto& entry : entries) {
+        std::vector<Byte> storedData(entry.data.begin(), entry.data.end());
+        uint32_t flags = 0;
+        if (entry.compress) {
+            std::vector<Byte> compressed(ZSTD_compressBound(entry.data.size()));
+            size_t compressedSize;
+            if (dictionary != nullptr) {
+                auto* cctx = ZSTD_createCCtx();
+                compressedSize = ZSTD_compress_usingDict(cctx,
+                                                         compressed.data(),
+                                                         compressed.size(),
+                                                         entry.data.data(),
+                                                         entry.data.size(),
+                                                         dictionary->data(),
+                                                         dictionary->size(),
+                                                         3);
+                ZSTD_freeCCtx(cctx);
+            } else {
+                compressedSize =
+                    ZSTD_compress(compressed.data(), compressed.size(), entry.data.data(), entry.data.size(), 3);
+            }
+            EXPECT_FALSE(ZSTD_isError(compressedSize));
+            compressed.resize(compressedSize);
+            storedData = std::move(compressed);
+            flags = 1;
+        }
+
+        appendValue<uint64_t>(index, entriesDataOffset + entriesData.size());
+        appendValue<uint64_t>(index, storedData.size());
+        appendValue<uint64_t>(index, entry.data.size());
+        appendValue<uint32_t>(index, static_cast<uint32_t>(paths.size()));
+        appendValue<uint32_t>(index, static_cast<uint32_t>(entry.path.size()));
+        appendValue<uint32_t>(index, flags);
+        appendValue<uint32_t>(index, 0);
+
+        paths += entry.path;
+        entriesData.insert(entriesData.end(), storedData.begin(), storedData.end());
+    }
+
+    std::vector<Byte> output;
+    appendValue<uint32_t>(output, 0x0200C633);
+    appendValue<uint32_t>(output, embedDictionary ? 1 : 0);
+    appendValue<uint32_t>(output, static_cast<uint32_t>(entries.size()));
+    appendValue<uint32_t>(output, static_cast<uint32_t>(paths.size()));
+    if (embedDictionary) {
+        appendValue<uint64_t>(output, dictionaryOffset);
+        appendValue<uint64_t>(output, dictionary->size());
+    }
+    output.insert(output.end(), index.begin(), index.end());
+    output.insert(output.end(), paths.begin(), paths.end());
+    if (embedDictionary) {
+        output.insert(output.end(), dictionary->begin(), dictionary->end());
+    }
+    output.insert(output.end(), entriesData.begin(), entriesData.end());
+
+    return output;
+}
+
+BytesView toBytesView(const std::vector<Byte>& data) {
+    auto buffer = makeShared<ByteBuffer>(data.data(), data.data() + data.size());
+    return buffer->toBytesView();
+}
+
+std::string_view toStringView(const BytesView& bytes) {
+    return std::string_view(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+}
+
+} // namespace
+
+TEST(ValdiModuleArchive, opensLegacyArchive) {
+    ValdiArchiveBuilder builder;
+    builder.addEntry(ValdiArchiveEntry(STRING_LITERAL("file1"), STRING_LITERAL("Hello")));
+    builder.addEntry(ValdiArchiveEntry(STRING_LITERAL("file2"), STRING_LITERAL("World")));
+    auto archiveBytes = builder.build();
+
+    auto result = ValdiModuleArchive::decompress(archiveBytes->toBytesView());
+    ASSERT_TRUE(result) << result.description();
+
+    const auto& archive = result.value();
+    ASSERT_FALSE(archive.isSeekable());
+    ASSERT_EQ(static_cast<size_t>(2), archive.getAllEntryPaths().size());
+
+    auto file2 = archive.getEntryBytes(STRING_LITERAL("file2"));
+    ASSERT_TRUE(file2) << file2.description();
+    ASSERT_EQ("World", toStringView(file2.value()));
+}
+
+TEST(ValdiModuleArchive, opensSeekableArchive) {
+    std::string largeContent(4096, 'a');
+    auto data = buildSeekableArchive({
+        {"main.js", largeContent, true},
+        {"image.png", "not compressed", false},
+    });
+
+    auto result = ValdiModuleArchive::decompress(toBytesView(data));
+    ASSERT_TRUE(result) << result.description();
+
+    const auto& archive = result.value();
+    ASSERT_TRUE(archive.isSeekable());
+    ASSERT_EQ(std::vector<StringBox>({STRING_LITERAL("main.js"), STRING_LITERAL("image.png")}),
+              archive.getAllEntryPaths());
+    ASSERT_TRUE(archive.containsEntry(STRING_LITERAL("main.js")));
+    ASSERT_FALSE(archive.containsEntry(STRING_LITERAL("other.js")));
+
+    auto mainJs = archive.getEntryBytes(STRING_LITERAL("main.js"));
+    ASSERT_TRUE(mainJs) << mainJs.description();
+    ASSERT_EQ(largeContent, toStringView(mainJs.value()));
+
+    auto image = archive.getEntry(STRING_LITERAL("image.png"));
+    ASSERT_TRUE(image.has_value());
+    ASSERT_EQ("not compressed",
+              std::string_view(reinterpret_cast<const char*>(image.value().data), image.value().size));
+
+    ASSERT_FALSE(archive.getEntryBytes(STRING_LITERAL("other.js")));
+}
+
+TEST(ValdiModuleArchive, deserializesSeekableArchive) {
+    // Remote modules are deserialized without decompression when it is disabled
+    auto data = buildSeekableArchive({{"main.js", std::string(1024, 'c'), true}});
+
+    auto result = ValdiModuleArchive::deserialize(toBytesView(data));
+    ASSERT_TRUE(result) << result.description();
+    ASSERT_TRUE(result.value().isSeekable());
+
+    auto mainJs = result.value().getEntryBytes(STRING_LITERAL("main.js"));
+    ASSERT_TRUE(mainJs) << mainJs.description();
+    ASSERT_EQ(std::string(1024, 'c'), toStringView(mainJs.value()));
+}
+
+TEST(ValdiModuleArchive, decompressesSeekableEntriesOnce) {
+    auto data = buildSeekableArchive({{"main.js", std::string(1024, 'b'), true}});
+
+    auto result = ValdiModuleArchive::decompress(toBytesView(data));
+    ASSERT_TRUE(result) << result.description();
+
+    auto first = result.value().getEntryForIndex(0);
+    auto second = result.value().getEntryForIndex(0);
+
+    ASSERT_EQ(first.data, second.data);
+    ASSERT_EQ(static_cast<size_t>(1024), first.size);
+}
+
+TEST(ValdiModuleArchive, decompressesSeekableEntriesConcurrently) {
+    std::vector<SeekableEntry> entries;
+    for (size_t i = 0; i < 16; i++) {
+        entries.push_back({"file" + std::to_string(i), std::string(2048, static_cast<char>('a' + i)), true});
+    }
+    auto data = buildSeekableArchive(entries);
+
+    auto result = ValdiModuleArchive::decompress(toBytesView(data));
+    ASSERT_TRUE(result) << result.description();
+    const auto& archive = result.value();
+
+    std::vector<std::thread> threads;
+    std::vector<const Byte*> pointers(8 * entries.size());
+    for (size_t threadIndex = 0; threadIndex < 8; threadIndex++) {
+        threads.emplace_back([&, threadIndex]() {
+            for (size_t i = 0; i < entries.size(); i++) {
+                auto bytes = archive.getEntryBytesForIndex(i);
+                pointers[threadIndex * entries.size() + i] = bytes ? bytes.value().data() : nullptr;
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    for (size_t i = 0; i < entries.size(); i++) {
+        auto bytes = archive.getEntryBytesForIndex(i);
+        ASSERT_TRUE(bytes) << bytes.description();
+        ASSERT_EQ(entries[i].data, toStringView(bytes.value()));
+        for (size_t threadIndex = 0; threadIndex < 8; threadIndex++) {
+            ASSERT_EQ(bytes.value().data(), pointers[threadIndex * entries.size() + i]);
+        }
+    }
+}
+
+TEST(ValdiModuleArchive, rejectsOutOfBoundsSeekableEntry) {
+    auto data = buildSeekableArchive({{"main.js", "content", false}});
+    // Truncate the data of the entry
+    data.resize(data.size() - 2);
+
+    auto result = ValdiModuleArchive::decompress(toBytesView(data));
+    ASSERT_FALSE(result);
+}
+
+TEST(ValdiModuleArchive, reportsCorruptedSeekableEntry) {
+    auto data = buildSeekableArchive({{"main.js", std::string(512, 'c'), true}});
+    // Corrupt the magic of the zstd frame, which follows the header, the index and the path
+    data[16 + 40 + std::strlen("main.js")] ^= 0xFF;
+
+    auto result = ValdiModuleArchive::decompress(toBytesView(data));
+    ASSERT_TRUE(result) << result.description();
+
+    ASSERT_FALSE(result.value().getEntryBytes(STRING_LITERAL("main.js")));
+    ASSERT_FALSE(result.value().getEntry(STRING_LITERAL("main.js")).has_value());
+}
+
+TEST(ValdiModuleArchive, opensSeekableArchiveWithEmbeddedDictionary) {
+    auto dictionary = trainDictionary();
+    auto content = makeSampleContent(1000);
+    auto data = buildSeekableArchive({{"component.json", content, true}}, &dictionary, true);
+
+    auto result = ValdiModuleArchive::decompress(toBytesView(data));
+    ASSERT_TRUE(result) << result.description();
+
+    auto entry = result.value().getEntryBytes(STRING_LITERAL("component.json"));
+    ASSERT_TRUE(entry) << entry.description();
+    ASSERT_EQ(content, toStringView(entry.value()));
+}
+
+TEST(ValdiModuleArchive, reportsMissingDictionary) {
+    auto dictionary = trainDictionary();
+    auto content = makeSampleContent(1000);
+    auto data = buildSeekableArchive({{"component.json", content, true}}, &dictionary, false);
+
+    auto result = ValdiModuleArchive::decompress(toBytesView(data));
+    ASSERT_TRUE(result) << result.description();
+
+    // Entries compressed with a dictionary which is not embedded in the archive cannot be read
+    ASSERT_FALSE(result.value().getEntryBytes(STRING_LITERAL("component.json")));
+}
+
+TEST(ValdiModuleArchive, opensSeekableArchiveWithRegisteredDictionary) {
+    auto dictionary = trainDictionary();
+    auto content = makeSampleContent(1000);
+    auto data = buildSeekableArchive({{"component.json", content, true}}, &dictionary, false);
+
+    auto result = ValdiModuleArchive::decompress(toBytesView(data));
+    ASSERT_TRUE(result) << result.description();
+    ASSERT_FALSE(result.value().getEntryBytes(STRING_LITERAL("component.json")));
+
+    auto loadedDictionary = ZStdUtils::loadDictionary(dictionary.data(), dictionary.size());
+    ASSERT_TRUE(loadedDictionary) << loadedDictionary.description();
+    ZStdUtils::registerDictionary(loadedDictionary.value());
+
+    auto entry = result.value().getEntryBytes(STRING_LITERAL("component.json"));
+    ZStdUtils::unregisterDictionary(loadedDictionary.value()->getId());
+
+    ASSERT_TRUE(entry) << entry.description();
+    ASSERT_EQ(content, toStringView(entry.value()));
+}
+
+TEST(ValdiModuleArchive, decompressesEntriesWithDictionaryRepeatedly) {
+    auto dictionary = trainDictionary();
+    std::vector<SeekableEntry> entries;
+    for (size_t i = 0; i < 8; i++) {
+        entries.push_back({"component" + std::to_string(i) + ".json", makeSampleContent(1000 + i), true});
+    }
+    auto data = buildSeekableArchive(entries, &dictionary, true);
+
+    auto result = ValdiModuleArchive::decompress(toBytesView(data));
+    ASSERT_TRUE(result) << result.description();
+
+    // The decompression context is reused from one entry to the next
+    for (size_t i = 0; i < entries.size(); i++) {
+        auto entry = result.value().getEntryBytesForIndex(i);
+        ASSERT_TRUE(entry) << entry.description();
+        ASSERT_EQ(entries[i].data, toStringView(entry.value()));
+    }
+}
+
+} // namespace ValdiTest
@@ -1,5 +1,6 @@
 #include "ViewNodeTestsUtils.hpp"
 #include "valdi/runtime/Attributes/ViewNodeTextInlineAttachment.hpp"
+#include "valdi_core/cpp/Threading/WorkStealingExecutor.hpp"
 #include "gtest/gtest.h"
 
 using namespace Valdi;
@@ -1623,6 +1624,51 @@ TEST(ViewNode, canCalculateVisibilityUsingChildrenIndexer) {
     }
 }
 
+TEST(ViewNode, canCalculateVisibilityUsingTwoDimensionalChildrenIndexer) {
+    ViewNodeTestsDependencies utils;
+
+    auto root = utils.createLayout();
+
+    std::vector<Ref<ViewNode>> children;
+
+    // 10x10 wrapping grid of 20x20 cells, of which the top left 5x5 cells fit in the root
+    for (size_t i = 0; i < 100; i++) {
+        auto newChild = utils.createLayout();
+        utils.setViewNodeFrame(newChild, static_cast<double>(i % 10) * 20, static_cast<double>(i / 10) * 20, 20, 20);
+        root->appendChild(utils.getViewTransactionScope(), newChild);
+        children.emplace_back(std::move(newChild));
+    }
+
+    root->performLayout(utils.getViewTransactionScope(), Size(100, 100), LayoutDirectionLTR);
+    root->updateVisibilityAndPerformUpdates(utils.getViewTransactionScope());
+
+    ASSERT_TRUE(root->getChildrenIndexer() != nullptr);
+    ASSERT_TRUE(root->getChildrenIndexer()->isTwoDimensional());
+    ASSERT_FALSE(root->getChildrenIndexer()->needsUpdate());
+
+    for (size_t i = 0; i < children.size(); i++) {
+        auto expectedVisible = (i % 10) < 5 && (i / 10) < 5;
+        ASSERT_EQ(expectedVisible, children[i]->isVisibleInViewport()) << "Child at index " << i;
+    }
+
+    // Moving a child should update the index incrementally
+    auto& bottomRightChild = children[99];
+    bottomRightChild->setTranslationX(-180, false);
+    bottomRightChild->setTranslationY(-180, false);
+
+    auto& topLeftChild = children[0];
+    topLeftChild->setTranslationY(100, false);
+
+    ASSERT_FALSE(root->getChildrenIndexer()->needsUpdate());
+
+    root->updateVisibilityAndPerformUpdates(utils.getViewTransactionScope());
+
+    ASSERT_TRUE(bottomRightChild->isVisibleInViewport());
+    ASSERT_FALSE(topLeftChild->isVisibleInViewport());
+    ASSERT_TRUE(children[1]->isVisibleInViewport());
+    ASSERT_FALSE(children[98]->isVisibleInViewport());
+}
+
 TEST(ViewNode, canUseCustomViewport) {
     ViewNodeTestsDependencies utils;
 
@@ -2766,6 +2812,53 @@ TEST(ViewNode, canHandleLazyLayout) {
     ASSERT_EQ(Frame(8, 8, 8, 8), child->getCalculatedFrame());
 }
 
+TEST(ViewNode, canCalculateLazyLayoutsConcurrently) {
+    ViewNodeTestsDependencies utils;
+    auto executor = makeShared<WorkStealingExecutor>(2);
+    utils.getTree().setLazyLayoutExecutor(executor);
+
+    auto root = utils.createRootView();
+    std::vector<Ref<ViewNode>> containers;
+    std::vector<Ref<ViewNode>> children;
+
+    for (size_t i = 0; i < 4; i++) {
+        auto container = utils.createLayout();
+        auto child = utils.createLayout();
+        container->setPrefersLazyLayout(utils.getViewTransactionScope(), true);
+        root->appendChild(utils.getViewTransactionScope(), container);
+        container->appendChild(utils.getViewTransactionScope(), child);
+
+        utils.setViewNodeFrame(container, 0, static_cast<double>(i) * 25, 50, 25);
+        utils.setViewNodeFrame(child, static_cast<double>(i), 4, 16, 16);
+
+        containers.emplace_back(std::move(container));
+        children.emplace_back(std::move(child));
+    }
+
+    root->performLayout(utils.getViewTransactionScope(), Size(100, 100), LayoutDirectionLTR);
+    root->updateVisibilityAndPerformUpdates(utils.getViewTransactionScope());
+
+    for (size_t i = 0; i < 4; i++) {
+        ASSERT_EQ(Frame(0, static_cast<float>(i) * 25, 50, 25), containers[i]->getCalculatedFrame());
+        ASSERT_EQ(Frame(static_cast<float>(i), 4, 16, 16), children[i]->getCalculatedFrame());
+    }
+
+    utils.setViewNodeFrame(children[1], 8, 8, 8, 8);
+    utils.setViewNodeFrame(children[3], 2, 2, 4, 4);
+
+    ASSERT_TRUE(root->isLazyLayoutDirty());
+
+    root->updateVisibilityAndPerformUpdates(utils.getViewTransactionScope());
+
+    ASSERT_FALSE(root->isLazyLayoutDirty());
+    ASSERT_EQ(Frame(0, 4, 16, 16), children[0]->getCalculatedFrame());
+    ASSERT_EQ(Frame(8, 8, 8, 8), children[1]->getCalculatedFrame());
+    ASSERT_EQ(Frame(2, 4, 16, 16), children[2]->getCalculatedFrame());
+    ASSERT_EQ(Frame(2, 2, 4, 4), children[3]->getCalculatedFrame());
+
+    executor->teardown();
+}
+
 // TODO(simon): This test fails because we are not currently able to recover from switching
 // from non lazyLayout to lazyLayout after layout attributes have been applied.
 TEST(ViewNode, DISABLED_canToggleLazyLayout) {
@@ -4162,4 +4255,47 @@ TEST(ViewNode, canSetStaticScrollContentSize) {
     ASSERT_EQ(Point(0, 225), scrollContainer->getDirectionAgnosticScrollContentOffset());
 }
 
+TEST(ViewNode, allocatesFromViewNodeTreeAllocator) {
+    ViewNodeTestsDependencies utils;
+
+    const auto& allocator = utils.getTree().getViewNodesAllocator();
+    auto liveBlocksCount = allocator->getLiveBlocksCount();
+
+    auto root = utils.createLayout();
+    auto child = utils.createLayout();
+    ASSERT_EQ(allocator.get(), root->getAllocator());
+    ASSERT_EQ(allocator.get(), child->getAllocator());
+    ASSERT_GT(allocator->getLiveBlocksCount(), liveBlocksCount);
+
+    auto liveBlocksCountBeforeAttribute = allocator->getLiveBlocksCount();
+
+    utils.setViewNodeAttribute(child, "height", Value(100.0));
+    child->getAttributesApplier().flush(utils.getViewTransactionScope());
+    root->appendChild(utils.getViewTransactionScope(), child);
+    root->performLayout(utils.getViewTransactionScope(), Size(100, 100), LayoutDirectionLTR);
+
+    ASSERT_EQ(Frame(0, 0, 100, 100), child->getCalculatedFrame());
+    ASSERT_GT(allocator->getLiveBlocksCount(), liveBlocksCountBeforeAttribute);
+
+    child = nullptr;
+    root = nullptr;
+
+    ASSERT_EQ(liveBlocksCount, allocator->getLiveBlocksCount());
+}
+
+TEST(ViewNode, allocatesLazyLayoutYogaNodeFromViewNodeTreeAllocator) {
+    ViewNodeTestsDependencies utils;
+
+    const auto& allocator = utils.getTree().getViewNodesAllocator();
+    auto container = utils.createLayout();
+    auto liveBlocksCount = allocator->getLiveBlocksCount();
+
+    container->setPrefersLazyLayout(utils.getViewTransactionScope(), true);
+    ASSERT_NE(container->getYogaNodeForInsertingChildren(), container->getYogaNode());
+    ASSERT_EQ(liveBlocksCount + 1, allocator->getLiveBlocksCount());
+
+    container->setPrefersLazyLayout(utils.getViewTransactionScope(), false);
+    ASSERT_EQ(liveBlocksCount, allocator->getLiveBlocksCount());
+}
+
 } // namespace ValdiTest
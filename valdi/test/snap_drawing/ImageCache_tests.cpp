@@ -5,6 +5,7 @@
 #include "TestBitmap.hpp"
 #include "TestDataUtils.hpp"
 #include "snap_drawing/cpp/Utils/Image.hpp"
+#include "valdi/runtime/Metrics/Metrics.hpp"
 #include "valdi/snap_drawing/ImageLoading/ImageCache.hpp"
 #include "valdi/snap_drawing/ImageLoading/ImageLoaderFactory.hpp"
 #include "valdi_core/cpp/Utils/Bytes.hpp"
@@ -12,8 +13,10 @@
 #include "valdi_core/cpp/Utils/SimpleAtomicCancelable.hpp"
 #include "valdi_core/cpp/Utils/ValueTypedArray.hpp"
 #include "valdi_test_utils.hpp"
+#include <atomic>
 #include <gtest/gtest.h>
 #include <memory>
+#include <thread>
 
 using namespace Valdi;
 using namespace snap::drawing;
@@ -247,6 +250,158 @@ TEST_F(ImageCacheTests, overwritingImageEvictsHandledMultipleOriginalImagesGrace
     ASSERT_EQ(imgUnpacked.use_count(), 1);
 }
 
+TEST_F(ImageCacheTests, resizedVariantsHaveTheirOwnBudget) {
+    auto img = Image::makeFromBitmap(createTestBitmap(), true).value();
+    auto variantSize = ImageCacheItem::imageSize(img->resized(getWidth() / 2, getHeight() / 2));
+    ImageCache cache(ConsoleLogger::getLogger(), _imgSize, variantSize);
+    cache.setCachedItemAndGetResizedImage(_url, img, getWidth(), getHeight());
+
+    auto half = cache.getResizedCachedImage(_url, getWidth() / 2, getHeight() / 2);
+    ASSERT_TRUE(half);
+    ASSERT_EQ(variantSize, cache.getVariantsSize());
+    half.value().image = nullptr;
+
+    // The previous variant no longer fits in the variants budget, while the original stays
+    auto quarter = cache.getResizedCachedImage(_url, getWidth() / 4, getHeight() / 4);
+    ASSERT_TRUE(quarter);
+    ASSERT_EQ(cache.getVariantCount(_url), 1);
+    ASSERT_EQ(_imgSize, cache.getOriginalsSize());
+    ASSERT_EQ(ImageCacheItem::imageSize(quarter.value().image), cache.getVariantsSize());
+}
+
+TEST_F(ImageCacheTests, subsampledImageOnlyServesSmallerSizes) {
+    auto img = Image::makeFromBitmap(createTestBitmap(), true).value();
+    ImageCache cache(ConsoleLogger::getLogger(), _imgSize * 4);
+    SubsampledImage subsampled{img->resized(getWidth() / 2, getHeight() / 2), 2, getWidth(), getHeight()};
+
+    auto half = cache.setSubsampledCachedItemAndGetResizedImage(_url, subsampled, getWidth() / 2, 0);
+    ASSERT_TRUE(half);
+    ASSERT_EQ(subsampled.image, half.value().image);
+    ASSERT_EQ(2.0f, half.value().scale);
+
+    auto quarter = cache.getResizedCachedImage(_url, getWidth() / 4, 0);
+    ASSERT_TRUE(quarter);
+    ASSERT_EQ(getWidth() / 4, quarter.value().image->width());
+    ASSERT_EQ(cache.getVariantCount(_url), 1);
+
+    // The full size image needs to be decoded again
+    ASSERT_FALSE(cache.getResizedCachedImage(_url, getWidth(), 0));
+
+    auto full = cache.setCachedItemAndGetResizedImage(_url, img, getWidth(), 0);
+    ASSERT_TRUE(full);
+    ASSERT_EQ(img, full.value().image);
+
+    // A smaller decode does not replace the full size image
+    auto otherHalf = cache.setSubsampledCachedItemAndGetResizedImage(_url, subsampled, getWidth() / 2, 0);
+    ASSERT_TRUE(otherHalf);
+    ASSERT_NE(subsampled.image, otherHalf.value().image);
+    ASSERT_TRUE(cache.getResizedCachedImage(_url, getWidth(), 0));
+}
+
+TEST(ImageSampleSize, picksLargestPowerOfTwoAboveTarget) {
+    ASSERT_EQ(1, Image::computeSampleSize(400, 300, 0, 0));
+    ASSERT_EQ(1, Image::computeSampleSize(400, 300, 400, 300));
+    ASSERT_EQ(1, Image::computeSampleSize(400, 300, 800, 600));
+    ASSERT_EQ(2, Image::computeSampleSize(400, 300, 200, 150));
+    ASSERT_EQ(2, Image::computeSampleSize(400, 300, 199, 0));
+    ASSERT_EQ(4, Image::computeSampleSize(400, 300, 0, 50));
+    ASSERT_EQ(8, Image::computeSampleSize(400, 300, 50, 1));
+}
+
+TEST_F(ImageCacheTests, supportsConcurrentLookups) {
+    std::vector<std::thread> threads;
+    std::atomic_int failures = 0;
+    for (int i = 0; i < 8; i++) {
+        threads.emplace_back([&, i]() {
+            for (int j = 0; j < 50; j++) {
+                auto divisor = 1 << ((i + j) % 4);
+                auto result = _cache->getResizedCachedImage(_url, getWidth() / divisor, getHeight() / divisor);
+                if (!result || result.value().image->width() != getWidth() / divisor) {
+                    failures++;
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    ASSERT_EQ(0, failures.load());
+    auto original = getImage(_url, getWidth(), getHeight());
+    _cache->invalidateCachedItems(ImageCache::EvictionPolicy::Memory);
+    ASSERT_EQ(_cache->getVariantCount(_url), 0);
+    ASSERT_EQ(_imgSize, _cache->getCurrentSize());
+}
+
+class ImageCacheRecordingMetrics : public Metrics {
+public:
+    void emitInitialRenderLatency(const StringBox&, const MetricsDuration&) override {}
+    void emitOnViewModelUpdatedLatency(const StringBox&, const MetricsDuration&) override {}
+    void emitOnCreateLatency(const StringBox&, const MetricsDuration&) override {}
+    void emitOnDestroyLatency(const StringBox&, const MetricsDuration&) override {}
+    void emitDestroyContextLatency(const StringBox&, const MetricsDuration&) override {}
+    void emitCalculateLayoutLatency(const StringBox&, const StringBox&, const MetricsDuration&) override {}
+    void emitCalculateLazyLayoutLatency(const StringBox&, const StringBox&, const MetricsDuration&) override {}
+    void emitCalculateLayoutLatencyMeasure(const StringBox&, const StringBox&, const MetricsDuration&) override {}
+    void emitCalculateLazyLayoutLatencyMeasure(const StringBox&, const StringBox&, const MetricsDuration&) override {}
+    void emitProcessRequestLatency(const StringBox&, const MetricsDuration&) override {}
+    void emitSessionTime(const StringBox&, const MetricsDuration&) override {}
+    void emitANR(const StringBox&) override {}
+    void emitANR() override {}
+    void emitRuntimeManagerInitLatency(const MetricsDuration&) override {}
+    void emitRuntimeManagerXpatInitLatency(const MetricsDuration&) override {}
+    void emitRuntimeManagerIosInitLatency(const MetricsDuration&) override {}
+    void emitRuntimePreInitLatency(const MetricsDuration&) override {}
+    void emitRuntimeInitLatency(const MetricsDuration&) override {}
+    void emitUserSessionReadyLatency(const MetricsDuration&) override {}
+    void emitAssetsDownloadSuccess(const StringBox&) override {}
+    void emitAssetsDownloadFailure(const StringBox&) override {}
+    void emitAssetsCacheHit(const StringBox&) override {}
+    void emitAssetsCacheMiss(const StringBox&) override {}
+    void emitUncaughtError(const StringBox&) override {}
+    void emitUncaughtError() override {}
+    void emitOnScrollLatency(const StringBox&, const StringBox&, const MetricsDuration&) override {}
+    void emitSlowAsyncJsCall(const StringBox&, const MetricsDuration&) override {}
+    void emitSlowSyncJsCallThreshold(const StringBox&, const MetricsDuration&) override {}
+
+    void emitImageCacheHit() override {
+        hits++;
+    }
+
+    void emitImageCacheMiss() override {
+        misses++;
+    }
+
+    void emitImageCacheEviction(int64_t originalsBytes, int64_t variantsBytes) override {
+        evictedOriginalsBytes += originalsBytes;
+        evictedVariantsBytes += variantsBytes;
+    }
+
+    int hits = 0;
+    int misses = 0;
+    int64_t evictedOriginalsBytes = 0;
+    int64_t evictedVariantsBytes = 0;
+};
+
+TEST_F(ImageCacheTests, emitsMetrics) {
+    auto metrics = makeShared<ImageCacheRecordingMetrics>();
+    _cache->setMetrics(metrics);
+
+    ASSERT_FALSE(getImage(STRING_LITERAL("asset://module/missing"), 0, 0));
+    auto variant = getImage(_url, getWidth() / 2, getHeight() / 2);
+    ASSERT_TRUE(variant);
+    auto variantSize = ImageCacheItem::imageSize(variant.value());
+
+    ASSERT_EQ(1, metrics->hits);
+    ASSERT_EQ(1, metrics->misses);
+
+    variant = Valdi::Error("released");
+    _cache->invalidateCachedItems(ImageCache::EvictionPolicy::Memory);
+
+    ASSERT_EQ(static_cast<int64_t>(_imgSize), metrics->evictedOriginalsBytes);
+    ASSERT_EQ(static_cast<int64_t>(variantSize), metrics->evictedVariantsBytes);
+}
+
 class ImageCacheEvictionFixture : public ImageCacheTestsBase,
                                   public ::testing::TestWithParam<ImageCache::EvictionPolicy> {
 protected:
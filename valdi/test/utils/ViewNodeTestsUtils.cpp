@@ -52,10 +52,10 @@ ViewTransactionScope& ViewNodeTestsDependencies::getViewTransactionScope() {
 }
 
 Ref<ViewNode> ViewNodeTestsDependencies::createNode(const char* viewClassName) {
-    auto viewNode = Valdi::makeShared<ViewNode>(_attributesManager.getYogaConfig(),
-                                                _attributesManager.getAttributeIds(),
-                                                _attributesManager.getColorPaletteManager()->getActiveColorPalette(),
-                                                _attributesManager.getLogger());
+    auto viewNode = _tree->createViewNode(_attributesManager.getYogaConfig(),
+                                          _attributesManager.getAttributeIds(),
+                                          _attributesManager.getColorPaletteManager()->getActiveColorPalette(),
+                                          _attributesManager.getLogger());
     viewNode->setViewNodeTree(_tree.get());
     viewNode->setViewFactory(*_viewTransactionScope, _viewFactories->getViewFactory(STRING_LITERAL(viewClassName)));
 
@@ -6,6 +6,7 @@
 //
 
 #include "valdi_core/cpp/Threading/DispatchQueue.hpp"
+#include "valdi_core/cpp/Threading/StrandDispatchQueue.hpp"
 #include "valdi_core/cpp/Threading/ThreadedDispatchQueue.hpp"
 #include <future>
 
@@ -61,6 +62,11 @@ Ref<DispatchQueue> DispatchQueue::create(const StringBox& name, ThreadQoSClass q
     return Valdi::makeShared<GCDDispatchQueue>(name, qosClass);
 }
 
+Ref<DispatchQueue> DispatchQueue::createStrand(const StringBox& name, ThreadQoSClass qosClass) {
+    // GCD queues already share the threads of the system pool
+    return create(name, qosClass);
+}
+
 DispatchQueue* DispatchQueue::getCurrent() {
     auto queue = GCDDispatchQueue::getCurrent();
     if (queue != nullptr) {
@@ -76,7 +82,16 @@ Ref<DispatchQueue> DispatchQueue::create(const StringBox& name, ThreadQoSClass q
     return createThreaded(name, qosClass);
 }
 
+Ref<DispatchQueue> DispatchQueue::createStrand(const StringBox& name, ThreadQoSClass qosClass) {
+    return Valdi::makeShared<StrandDispatchQueue>(name, qosClass, WorkStealingExecutor::getShared());
+}
+
 DispatchQueue* DispatchQueue::getCurrent() {
+    auto* strand = StrandDispatchQueue::getCurrent();
+    if (strand != nullptr) {
+        return strand;
+    }
+
     return ThreadedDispatchQueue::getCurrent();
 }
 
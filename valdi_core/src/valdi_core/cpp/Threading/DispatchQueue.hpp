@@ -55,6 +55,10 @@ public:
     static Ref<DispatchQueue> create(const StringBox& name, ThreadQoSClass qosClass);
     // Create a DispatchQueue that is always backed by a single thread.
     static Ref<DispatchQueue> createThreaded(const StringBox& name, ThreadQoSClass qosClass);
+    // Create a serial DispatchQueue which does not own a thread, and runs its tasks on the
+    // threads of a shared pool instead. Tasks submitted to it must not block on other queues
+    // nor rely on running on a particular thread.
+    static Ref<DispatchQueue> createStrand(const StringBox& name, ThreadQoSClass qosClass);
 
     static DispatchQueue* getCurrent();
     static DispatchQueue* getMain();
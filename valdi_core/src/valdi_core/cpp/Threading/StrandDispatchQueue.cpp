@@ -0,0 +1,193 @@
+//
+//  StrandDispatchQueue.cpp
+//  valdi
+//
+
+#include "valdi_core/cpp/Threading/StrandDispatchQueue.hpp"
+#include "valdi_core/cpp/Threading/ThreadedDispatchQueue.hpp"
+
+namespace Valdi {
+
+namespace {
+
+// A drain job gives the worker back after this many tasks, so that a busy queue
+// does not starve the other queues scheduled in the same priority band.
+constexpr size_t kMaxTasksPerDrain = 32;
+
+thread_local StrandDispatchQueue* tCurrent = nullptr;
+// The ThreadedDispatchQueue that was current when tCurrent was entered. When they differ, a sync()
+// onto a ThreadedDispatchQueue was made from the strand, and that queue is the innermost one.
+thread_local ThreadedDispatchQueue* tEnclosingThreadedQueue = nullptr;
+
+class CurrentStrandScope {
+public:
+    explicit CurrentStrandScope(StrandDispatchQueue* strand)
+        : _previousCurrent(tCurrent), _previousEnclosingThreadedQueue(tEnclosingThreadedQueue) {
+        tCurrent = strand;
+        tEnclosingThreadedQueue = ThreadedDispatchQueue::getCurrent();
+    }
+
+    ~CurrentStrandScope() {
+        tCurrent = _previousCurrent;
+        tEnclosingThreadedQueue = _previousEnclosingThreadedQueue;
+    }
+
+private:
+    StrandDispatchQueue* _previousCurrent;
+    ThreadedDispatchQueue* _previousEnclosingThreadedQueue;
+};
+
+} // namespace
+
+StrandDispatchQueue::StrandDispatchQueue(const StringBox& name,
+                                         ThreadQoSClass qosClass,
+                                         const Ref<WorkStealingExecutor>& executor)
+    : _executor(executor),
+      _taskQueue(makeShared<TaskQueue>()),
+      _name(name),
+      _qosClass(qosClass),
+      _drainScheduled(false),
+      _disableSyncCallsInCallingThread(false) {
+    _taskQueue->setLockFreeAsyncEnabled(true);
+}
+
+StrandDispatchQueue::~StrandDispatchQueue() {
+    teardown();
+}
+
+void StrandDispatchQueue::sync(const DispatchFunction& function) {
+    if (_disableSyncCallsInCallingThread) {
+        std::promise<void> promise;
+        auto future = promise.get_future();
+
+        async([&function, &promise, this]() {
+            _runningSync = true;
+            function();
+
+            promise.set_value();
+            _runningSync = false;
+        });
+
+        future.get();
+        return;
+    }
+
+    _taskQueue->barrier([&]() {
+        CurrentStrandScope currentScope(this);
+        _runningSync = true;
+        function();
+        _runningSync = false;
+    });
+
+    // Tasks submitted while the barrier was running could not be drained
+    scheduleDrainIfNeeded();
+}
+
+void StrandDispatchQueue::async(DispatchFunction function) {
+    _taskQueue->enqueueAsync(std::move(function));
+    scheduleDrain();
+}
+
+task_id_t StrandDispatchQueue::asyncAfter(DispatchFunction function, std::chrono::steady_clock::duration delay) {
+    auto task = _taskQueue->enqueue(std::move(function), delay);
+
+    // The task stays in our TaskQueue so that it can be cancelled, the executor
+    // only wakes us up once it is due.
+    _executor->submitAfter(
+        [weakThis = weakRef(this)]() {
+            if (auto strongThis = weakThis.lock()) {
+                strongThis->scheduleDrainIfNeeded();
+            }
+        },
+        _qosClass,
+        delay);
+
+    return task.id;
+}
+
+void StrandDispatchQueue::cancel(task_id_t taskId) {
+    _taskQueue->cancel(taskId);
+}
+
+void StrandDispatchQueue::scheduleDrain() {
+    if (_drainScheduled.exchange(true)) {
+        return;
+    }
+
+    _executor->submit(
+        [weakThis = weakRef(this)]() {
+            if (auto strongThis = weakThis.lock()) {
+                strongThis->drain();
+            }
+        },
+        _qosClass);
+}
+
+void StrandDispatchQueue::scheduleDrainIfNeeded() {
+    if (_taskQueue->hasTaskReady()) {
+        scheduleDrain();
+    }
+}
+
+void StrandDispatchQueue::drain() {
+    {
+        std::lock_guard<Mutex> guard(_drainMutex);
+        CurrentStrandScope currentScope(this);
+
+        size_t ranTasks = 0;
+        while (ranTasks < kMaxTasksPerDrain && _taskQueue->runNextTask(std::chrono::steady_clock::now())) {
+            ranTasks++;
+        }
+    }
+
+    // Tasks enqueued after our last runNextTask() call could not schedule a drain
+    // while the flag was set, so we need to check again after clearing it.
+    _drainScheduled = false;
+    scheduleDrainIfNeeded();
+}
+
+bool StrandDispatchQueue::isCurrent() const {
+    return tCurrent == this;
+}
+
+void StrandDispatchQueue::teardown() {
+    _taskQueue->dispose();
+
+    if (!isCurrent()) {
+        // Wait for a drain job that might currently be running one of our tasks
+        std::lock_guard<Mutex> guard(_drainMutex);
+    }
+}
+
+void StrandDispatchQueue::fullTeardown() {
+    teardown();
+}
+
+void StrandDispatchQueue::setListener(const Shared<IQueueListener>& listener) {
+    _taskQueue->setListener(listener);
+}
+
+Shared<IQueueListener> StrandDispatchQueue::getListener() const {
+    return _taskQueue->getListener();
+}
+
+void StrandDispatchQueue::setQoSClass(ThreadQoSClass qosClass) {
+    _qosClass = qosClass;
+}
+
+void StrandDispatchQueue::setDisableSyncCallsInCallingThread(bool disableSyncCallsInCallingThread) {
+    _disableSyncCallsInCallingThread = disableSyncCallsInCallingThread;
+}
+
+const StringBox& StrandDispatchQueue::getName() const {
+    return _name;
+}
+
+StrandDispatchQueue* StrandDispatchQueue::getCurrent() {
+    if (tCurrent == nullptr || ThreadedDispatchQueue::getCurrent() != tEnclosingThreadedQueue) {
+        return nullptr;
+    }
+    return tCurrent;
+}
+
+} // namespace Valdi
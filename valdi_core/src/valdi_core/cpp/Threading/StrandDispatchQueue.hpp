@@ -0,0 +1,70 @@
+//
+//  StrandDispatchQueue.hpp
+//  valdi
+//
+
+#pragma once
+
+#include "valdi_core/cpp/Threading/DispatchQueue.hpp"
+#include "valdi_core/cpp/Threading/TaskQueue.hpp"
+#include "valdi_core/cpp/Threading/WorkStealingExecutor.hpp"
+#include "valdi_core/cpp/Utils/Mutex.hpp"
+#include <atomic>
+#include <future>
+
+namespace Valdi {
+
+/**
+ * A serial DispatchQueue which does not own a thread. Tasks are kept in a TaskQueue and
+ * drained in batches by jobs scheduled on a WorkStealingExecutor, in the priority band
+ * matching the queue's ThreadQoSClass. At most one drain job is scheduled at any time,
+ * which keeps tasks running one at a time and in FIFO order.
+ */
+class StrandDispatchQueue : public DispatchQueue {
+public:
+    StrandDispatchQueue(const StringBox& name, ThreadQoSClass qosClass, const Ref<WorkStealingExecutor>& executor);
+    ~StrandDispatchQueue() override;
+
+    void sync(const DispatchFunction& function) final;
+    void async(DispatchFunction function) final;
+    task_id_t asyncAfter(DispatchFunction function, std::chrono::steady_clock::duration delay) final;
+    void cancel(task_id_t taskId) final;
+
+    bool isCurrent() const final;
+
+    void fullTeardown() final;
+
+    void setListener(const Shared<IQueueListener>& listener) final;
+
+    void setQoSClass(ThreadQoSClass qosClass) final;
+
+    void setDisableSyncCallsInCallingThread(bool disableSyncCallsInCallingThread) final;
+
+    const StringBox& getName() const;
+
+    /**
+     * Returns the strand running on the calling thread, or null if there is none or if
+     * a ThreadedDispatchQueue was entered through sync() from it since.
+     */
+    static StrandDispatchQueue* getCurrent();
+
+    // For Testing Only
+    Shared<IQueueListener> getListener() const final;
+
+private:
+    Ref<WorkStealingExecutor> _executor;
+    Ref<TaskQueue> _taskQueue;
+    StringBox _name;
+    std::atomic<ThreadQoSClass> _qosClass;
+    std::atomic_bool _drainScheduled;
+    std::atomic_bool _disableSyncCallsInCallingThread;
+    // Held while a drain job runs tasks, so that teardown can wait for it.
+    Mutex _drainMutex;
+
+    void scheduleDrain();
+    void scheduleDrainIfNeeded();
+    void drain();
+    void teardown();
+};
+
+} // namespace Valdi
@@ -12,38 +12,65 @@
 
 #include "utils/debugging/Trace.hpp"
 
+#include <algorithm>
 #include <pthread.h>
 
 namespace Valdi {
 
 namespace {
 constexpr auto kTaskTraceLabel = "Valdi.TaskQueue";
+// Cancelled delayed tasks are only purged from the heap once they reach its top,
+// or once there are enough of them that they represent the majority of the heap.
+constexpr size_t kMinCancelledDelayedTasksBeforeCompaction = 32;
 } // namespace
 
+TaskQueue::Task::Task() = default;
+
 TaskQueue::Task::Task(task_id_t id,
                       DispatchFunction function,
                       std::chrono::steady_clock::time_point executeTime,
                       bool isBarrier,
+                      bool isDelayed,
                       uint64_t parentSpanId)
     : id(id),
       function(std::move(function)),
       executeTime(executeTime),
       isBarrier(isBarrier),
+      isDelayed(isDelayed),
       parentSpanId(parentSpanId) {}
 
-TaskQueue::TaskQueue() : _disposed(false) {}
+TaskQueue::AsyncTask::AsyncTask(DispatchFunction function,
+                                std::chrono::steady_clock::time_point executeTime,
+                                uint64_t parentSpanId)
+    : function(std::move(function)), executeTime(executeTime), parentSpanId(parentSpanId) {}
+
+TaskQueue::TaskQueue()
+    : _disposed(false),
+      _first(true),
+      _lockFreeAsyncAllowed(false),
+      _asyncTasksHead(nullptr),
+      _parkedConsumersCount(0) {}
 
 TaskQueue::~TaskQueue() {
     dispose();
+    // Tasks pushed concurrently with dispose() might not have been collected
+    deleteAsyncTasks(_asyncTasksHead.exchange(nullptr));
 }
 
 void TaskQueue::dispose() {
     if (!_disposed) {
         _disposed = true;
-        std::deque<Task> toDelete;
+        std::vector<Task> toDelete;
         _mutex.lock();
-        toDelete.swap(_tasks);
+        auto* asyncTasksToDelete = _asyncTasksHead.exchange(nullptr);
+        toDelete.swap(_taskSlots);
+        _freeTaskSlots.clear();
+        _taskSlotById.clear();
+        _immediateTasks.clear();
+        _delayedTasks.clear();
+        _cancelledDelayedTasksCount = 0;
         _mutex.unlock();
+        deleteAsyncTasks(asyncTasksToDelete);
         _condition.notifyAll();
     }
 }
@@ -53,7 +80,7 @@ void TaskQueue::sync(const DispatchFunction& function) {
 }
 
 void TaskQueue::async(DispatchFunction function) {
-    enqueue(std::move(function));
+    enqueueAsync(std::move(function));
 }
 
 task_id_t TaskQueue::asyncAfter(DispatchFunction function, std::chrono::steady_clock::duration delay) {
@@ -61,35 +88,214 @@ task_id_t TaskQueue::asyncAfter(DispatchFunction function, std::chrono::steady_c
 }
 
 EnqueuedTask TaskQueue::enqueue(Valdi::DispatchFunction function) {
-    return enqueue(std::move(function), std::chrono::steady_clock::now());
+    return doEnqueue(std::move(function), std::chrono::steady_clock::now(), true);
+}
+
+EnqueuedTask TaskQueue::enqueueAsync(DispatchFunction function) {
+    if (!_lockFreeAsyncAllowed.load(std::memory_order_relaxed)) {
+        return enqueue(std::move(function));
+    }
+
+    EnqueuedTask enqueuedTask;
+    if (_disposed) {
+        return enqueuedTask;
+    }
+
+    auto* asyncTask = new AsyncTask(
+        std::move(function), std::chrono::steady_clock::now(), ::snap::utils::debugging::getCurrentSpanId());
+
+    auto* head = _asyncTasksHead.load(std::memory_order_relaxed);
+    do {
+        asyncTask->next = head;
+    } while (!_asyncTasksHead.compare_exchange_weak(head, asyncTask));
+
+    enqueuedTask.isFirst = _first.load(std::memory_order_relaxed) && _first.exchange(false);
+
+    // Pairs with the increment in parkUntil(): either the consumer sees our task
+    // before parking, or we see that it is parked and wake it up.
+    if (_parkedConsumersCount.load() != 0) {
+        wakeUpParkedConsumers();
+    }
+
+    return enqueuedTask;
 }
 
 EnqueuedTask TaskQueue::enqueue(Valdi::DispatchFunction function, std::chrono::steady_clock::duration delay) {
-    return enqueue(std::move(function), std::chrono::steady_clock::now() + delay);
+    return doEnqueue(std::move(function), std::chrono::steady_clock::now() + delay, false);
+}
+
+EnqueuedTask TaskQueue::enqueue(Valdi::DispatchFunction function, std::chrono::steady_clock::time_point executeTime) {
+    return doEnqueue(std::move(function), executeTime, false);
+}
+
+bool TaskQueue::isTaskAfter(uint32_t leftSlot, uint32_t rightSlot) const {
+    const auto& left = _taskSlots[leftSlot];
+    const auto& right = _taskSlots[rightSlot];
+
+    if (left.executeTime == right.executeTime) {
+        return left.id > right.id;
+    }
+    return left.executeTime > right.executeTime;
+}
+
+uint32_t TaskQueue::lockFreeAllocateTaskSlot(Task&& task) {
+    if (!_freeTaskSlots.empty()) {
+        auto slot = _freeTaskSlots.back();
+        _freeTaskSlots.pop_back();
+        _taskSlots[slot] = std::move(task);
+        return slot;
+    }
+
+    _taskSlots.emplace_back(std::move(task));
+    return static_cast<uint32_t>(_taskSlots.size() - 1);
+}
+
+void TaskQueue::lockFreeReleaseTaskSlot(uint32_t slot) {
+    // The function was already moved out by the caller, so that it can be destroyed outside of the lock
+    _taskSlots[slot] = Task();
+    _freeTaskSlots.emplace_back(slot);
+}
+
+void TaskQueue::lockFreePushDelayedTask(uint32_t slot) {
+    _delayedTasks.emplace_back(slot);
+    std::push_heap(_delayedTasks.begin(), _delayedTasks.end(), [this](uint32_t left, uint32_t right) {
+        return isTaskAfter(left, right);
+    });
+}
+
+void TaskQueue::lockFreePopDelayedTask() {
+    std::pop_heap(_delayedTasks.begin(), _delayedTasks.end(), [this](uint32_t left, uint32_t right) {
+        return isTaskAfter(left, right);
+    });
+    _delayedTasks.pop_back();
+}
+
+void TaskQueue::lockFreeCompactDelayedTasks() {
+    if (_cancelledDelayedTasksCount < kMinCancelledDelayedTasksBeforeCompaction ||
+        _cancelledDelayedTasksCount * 2 < _delayedTasks.size()) {
+        return;
+    }
+
+    size_t liveTasksCount = 0;
+    for (auto slot : _delayedTasks) {
+        if (_taskSlots[slot].isCancelled) {
+            lockFreeReleaseTaskSlot(slot);
+        } else {
+            _delayedTasks[liveTasksCount++] = slot;
+        }
+    }
+    _delayedTasks.resize(liveTasksCount);
+    _cancelledDelayedTasksCount = 0;
+
+    std::make_heap(_delayedTasks.begin(), _delayedTasks.end(), [this](uint32_t left, uint32_t right) {
+        return isTaskAfter(left, right);
+    });
+}
+
+void TaskQueue::wakeUpParkedConsumers() {
+    // Acquiring the lock guarantees that a consumer which registered itself as parked
+    // has started waiting on the condition before we notify it.
+    {
+        std::lock_guard<Mutex> lockGuard(_mutex);
+    }
+    _condition.notifyAll();
+}
+
+std::cv_status TaskQueue::parkUntil(std::unique_lock<Mutex>& lock, std::chrono::steady_clock::time_point time) {
+    _parkedConsumersCount.fetch_add(1);
+
+    auto result = std::cv_status::no_timeout;
+    if (_asyncTasksHead.load() == nullptr) {
+        result = _condition.waitUntil(lock, time);
+    }
+
+    _parkedConsumersCount.fetch_sub(1);
+    return result;
+}
+
+void TaskQueue::deleteAsyncTasks(AsyncTask* head) {
+    while (head != nullptr) {
+        auto* next = head->next;
+        delete head;
+        head = next;
+    }
+}
+
+void TaskQueue::lockFreeDrainAsyncTasks() {
+    if (_asyncTasksHead.load(std::memory_order_relaxed) == nullptr) {
+        return;
+    }
+
+    // Take the whole stack at once and reverse it to get the submission order
+    auto* current = _asyncTasksHead.exchange(nullptr, std::memory_order_acquire);
+    AsyncTask* ordered = nullptr;
+    while (current != nullptr) {
+        auto* next = current->next;
+        current->next = ordered;
+        ordered = current;
+        current = next;
+    }
+
+    if (ordered != nullptr) {
+        lockFreeSetNonEmpty();
+    }
+
+    while (ordered != nullptr) {
+        auto* next = ordered->next;
+        doInsertTask(std::move(ordered->function), ordered->executeTime, false, true, ordered->parentSpanId);
+        delete ordered;
+        ordered = next;
+    }
+}
+
+void TaskQueue::lockFreeSetNonEmpty() {
+    if (_empty) {
+        _empty = false;
+        if (_listener != nullptr) {
+            _listener->onQueueNonEmpty();
+        }
+    }
 }
 
 task_id_t TaskQueue::insertTask(DispatchFunction&& function,
                                 std::chrono::steady_clock::time_point executeTime,
                                 bool isBarrier,
+                                bool isImmediate,
                                 uint64_t parentSpanId) {
+    // Tasks pushed through the lock-free path were submitted before this one
+    lockFreeDrainAsyncTasks();
+    return doInsertTask(std::move(function), executeTime, isBarrier, isImmediate, parentSpanId);
+}
+
+task_id_t TaskQueue::doInsertTask(DispatchFunction&& function,
+                                  std::chrono::steady_clock::time_point executeTime,
+                                  bool isBarrier,
+                                  bool isImmediate,
+                                  uint64_t parentSpanId) {
     auto id = ++_taskIdCounter;
 
-    // Keep the tasks sorted by execute time
-    Task task(id, std::move(function), executeTime, isBarrier, parentSpanId);
+    // Immediate tasks are appended to the FIFO as long as it stays sorted by execute time,
+    // which only fails to be the case when a concurrent enqueue took the lock first.
+    // Everything else goes through the delayed heap.
+    auto isDelayed = !isImmediate ||
+                     (!_immediateTasks.empty() && _taskSlots[_immediateTasks.back()].executeTime > executeTime);
 
-    auto it = std::upper_bound(_tasks.begin(), _tasks.end(), task, [](const Task& a, const Task& b) {
-        if (a.executeTime == b.executeTime) {
-            return a.id < b.id;
-        }
-        return a.executeTime < b.executeTime;
-    });
+    auto slot =
+        lockFreeAllocateTaskSlot(Task(id, std::move(function), executeTime, isBarrier, isDelayed, parentSpanId));
+    _taskSlotById[id] = slot;
 
-    _tasks.emplace(it, std::move(task));
+    if (isDelayed) {
+        lockFreePushDelayedTask(slot);
+    } else {
+        _immediateTasks.emplace_back(slot);
+    }
 
     return id;
 }
 
-EnqueuedTask TaskQueue::enqueue(Valdi::DispatchFunction function, std::chrono::steady_clock::time_point executeTime) {
+EnqueuedTask TaskQueue::doEnqueue(DispatchFunction&& function,
+                                  std::chrono::steady_clock::time_point executeTime,
+                                  bool isImmediate) {
     EnqueuedTask enqueuedTask;
 
     if (_disposed) {
@@ -101,16 +307,10 @@ EnqueuedTask TaskQueue::enqueue(Valdi::DispatchFunction function, std::chrono::s
     {
         std::lock_guard<Mutex> lockGuard(_mutex);
 
-        enqueuedTask.id = insertTask(std::move(function), executeTime, false, parentSpanId);
-        enqueuedTask.isFirst = _first;
-        _first = false;
+        enqueuedTask.id = insertTask(std::move(function), executeTime, false, isImmediate, parentSpanId);
+        enqueuedTask.isFirst = _first.load(std::memory_order_relaxed) && _first.exchange(false);
 
-        if (_empty) {
-            _empty = false;
-            if (_listener != nullptr) {
-                _listener->onQueueNonEmpty();
-            }
-        }
+        lockFreeSetNonEmpty();
     }
 
     _condition.notifyAll();
@@ -128,26 +328,80 @@ void TaskQueue::cancel(Valdi::task_id_t taskId) {
 }
 
 DispatchFunction TaskQueue::lockFreeRemoveTask(task_id_t taskId) {
-    for (auto i = _tasks.begin(); i != _tasks.end(); ++i) {
-        if (i->id == taskId) {
-            auto task = std::move(*i);
-            _tasks.erase(i);
-            return std::move(task.function);
-        }
+    const auto& it = _taskSlotById.find(taskId);
+    if (it == _taskSlotById.end()) {
+        return DispatchFunction();
     }
 
-    return DispatchFunction();
+    auto slot = it->second;
+    _taskSlotById.erase(it);
+
+    // The task is left in its container and will be skipped once it reaches the head
+    auto& task = _taskSlots[slot];
+    task.isCancelled = true;
+    auto function = std::move(task.function);
+
+    if (task.isDelayed) {
+        _cancelledDelayedTasksCount++;
+        lockFreeCompactDelayedTasks();
+    }
+
+    return function;
+}
+
+TaskQueue::Task* TaskQueue::lockFreePeekNextTask() {
+    lockFreeDrainAsyncTasks();
+
+    while (!_immediateTasks.empty() && _taskSlots[_immediateTasks.front()].isCancelled) {
+        auto slot = _immediateTasks.front();
+        _immediateTasks.pop_front();
+        lockFreeReleaseTaskSlot(slot);
+    }
+
+    while (!_delayedTasks.empty() && _taskSlots[_delayedTasks.front()].isCancelled) {
+        auto slot = _delayedTasks.front();
+        lockFreePopDelayedTask();
+        lockFreeReleaseTaskSlot(slot);
+        _cancelledDelayedTasksCount--;
+    }
+
+    if (_immediateTasks.empty()) {
+        return _delayedTasks.empty() ? nullptr : &_taskSlots[_delayedTasks.front()];
+    }
+
+    if (_delayedTasks.empty() || isTaskAfter(_delayedTasks.front(), _immediateTasks.front())) {
+        return &_taskSlots[_immediateTasks.front()];
+    }
+
+    return &_taskSlots[_delayedTasks.front()];
+}
+
+TaskQueue::Task TaskQueue::lockFreePopNextTask() {
+    uint32_t slot;
+    if (lockFreePeekNextTask()->isDelayed) {
+        slot = _delayedTasks.front();
+        lockFreePopDelayedTask();
+    } else {
+        slot = _immediateTasks.front();
+        _immediateTasks.pop_front();
+    }
+
+    auto task = std::move(_taskSlots[slot]);
+    _taskSlotById.erase(task.id);
+    lockFreeReleaseTaskSlot(slot);
+
+    return task;
 }
 
 void TaskQueue::barrier(const DispatchFunction& function) {
     auto executeTime = std::chrono::steady_clock::now();
 
     std::unique_lock<Mutex> lockGuard(_mutex);
-    auto id = insertTask(DispatchFunction(), executeTime, true, 0);
+    auto id = insertTask(DispatchFunction(), executeTime, true, true, 0);
 
-    while (!_tasks.empty()) {
+    for (auto* nextTask = lockFreePeekNextTask(); nextTask != nullptr; nextTask = lockFreePeekNextTask()) {
         // Wait until we have no currently running tasks, and that the task at the front is our barrier task
-        if (_currentRunningTasks != 0 || _tasks.front().id != id) {
+        if (_currentRunningTasks != 0 || nextTask->id != id) {
             _condition.wait(lockGuard);
             continue;
         }
@@ -173,7 +427,8 @@ DispatchFunction TaskQueue::nextTask(std::chrono::steady_clock::time_point maxTi
     bool hasTask = false;
 
     while (!_disposed) {
-        if (_tasks.empty()) {
+        const auto* nextTask = lockFreePeekNextTask();
+        if (nextTask == nullptr) {
             if (!_empty) {
                 _empty = true;
                 if (_listener != nullptr) {
@@ -181,7 +436,7 @@ DispatchFunction TaskQueue::nextTask(std::chrono::steady_clock::time_point maxTi
                 }
             }
             // Wait until there's at least one task
-            auto result = _condition.waitUntil(lockGuard, maxTime);
+            auto result = parkUntil(lockGuard, maxTime);
             if (result == std::cv_status::timeout) {
                 // We timed out waiting for tasks, so we break now
                 break;
@@ -193,7 +448,7 @@ DispatchFunction TaskQueue::nextTask(std::chrono::steady_clock::time_point maxTi
 
         if (_currentRunningTasks >= _maxConcurrentTasks) {
             // Wait until there are no more pending running tasks
-            auto result = _condition.waitUntil(lockGuard, maxTime);
+            auto result = parkUntil(lockGuard, maxTime);
             if (result == std::cv_status::timeout) {
                 // We timed out waiting for tasks, so we break now
                 break;
@@ -204,19 +459,18 @@ DispatchFunction TaskQueue::nextTask(std::chrono::steady_clock::time_point maxTi
         }
 
         // Wait until the next task is ready to run
-        const auto& nextTask = _tasks.front();
-        if (VALDI_UNLIKELY(nextTask.isBarrier)) {
-            auto result = _condition.waitUntil(lockGuard, maxTime);
+        if (VALDI_UNLIKELY(nextTask->isBarrier)) {
+            auto result = parkUntil(lockGuard, maxTime);
 
             if (result == std::cv_status::timeout) {
                 break;
             } else {
                 continue;
             }
-        } else if (nextTask.executeTime > std::chrono::steady_clock::now()) {
-            auto maxTimeToWait = std::min(maxTime, nextTask.executeTime);
+        } else if (nextTask->executeTime > std::chrono::steady_clock::now()) {
+            auto maxTimeToWait = std::min(maxTime, nextTask->executeTime);
 
-            auto result = _condition.waitUntil(lockGuard, maxTimeToWait);
+            auto result = parkUntil(lockGuard, maxTimeToWait);
 
             // If we reached the given maxTime, we should abort.
             if (maxTimeToWait == maxTime && result == std::cv_status::timeout) {
@@ -235,10 +489,10 @@ DispatchFunction TaskQueue::nextTask(std::chrono::steady_clock::time_point maxTi
     if (_disposed || !hasTask) {
         *shouldRun = false;
     } else {
-        nextTaskFunction = std::move(_tasks.front().function);
-        *parentSpanId = _tasks.front().parentSpanId;
+        auto task = lockFreePopNextTask();
+        nextTaskFunction = std::move(task.function);
+        *parentSpanId = task.parentSpanId;
         _currentRunningTasks++;
-        _tasks.pop_front();
     }
     return nextTaskFunction;
 }
@@ -288,6 +542,16 @@ bool TaskQueue::runNextTask(std::chrono::steady_clock::time_point maxTime) {
     return shouldRun;
 }
 
+bool TaskQueue::hasTaskReady() {
+    std::lock_guard<Mutex> lockGuard(_mutex);
+    if (_disposed || _currentRunningTasks >= _maxConcurrentTasks) {
+        return false;
+    }
+
+    const auto* nextTask = lockFreePeekNextTask();
+    return nextTask != nullptr && !nextTask->isBarrier && nextTask->executeTime <= std::chrono::steady_clock::now();
+}
+
 bool TaskQueue::isDisposed() const {
     return _disposed;
 }
@@ -306,6 +570,18 @@ void TaskQueue::setMaxConcurrentTasks(size_t maxConcurrentTasks) {
 void TaskQueue::setListener(const Shared<IQueueListener>& listener) {
     std::lock_guard<Mutex> lockGuard(_mutex);
     _listener = listener;
+    updateLockFreeAsyncAllowed();
+}
+
+void TaskQueue::setLockFreeAsyncEnabled(bool lockFreeAsyncEnabled) {
+    std::lock_guard<Mutex> lockGuard(_mutex);
+    _lockFreeAsyncEnabled = lockFreeAsyncEnabled;
+    updateLockFreeAsyncAllowed();
+}
+
+void TaskQueue::updateLockFreeAsyncAllowed() {
+    // The listener needs to be notified when the queue becomes non empty, which requires the lock
+    _lockFreeAsyncAllowed = _lockFreeAsyncEnabled && _listener == nullptr;
 }
 
 Shared<IQueueListener> TaskQueue::getListener() const {
@@ -11,11 +11,14 @@
 #include "valdi_core/cpp/Threading/IDispatchQueue.hpp"
 #include "valdi_core/cpp/Threading/IQueueListener.hpp"
 #include "valdi_core/cpp/Threading/TaskId.hpp"
+#include "valdi_core/cpp/Utils/FlatMap.hpp"
 #include "valdi_core/cpp/Utils/Function.hpp"
 #include "valdi_core/cpp/Utils/Mutex.hpp"
 #include "valdi_core/cpp/Utils/Shared.hpp"
+#include <atomic>
 #include <chrono>
-#include <queue>
+#include <deque>
+#include <vector>
 
 namespace Valdi {
 
@@ -36,6 +39,13 @@ public:
     EnqueuedTask enqueue(DispatchFunction function, std::chrono::steady_clock::duration delay);
     EnqueuedTask enqueue(DispatchFunction function, std::chrono::steady_clock::time_point executeTime);
 
+    /**
+     * Enqueues an immediate task which cannot be cancelled. When the lock-free async
+     * path is enabled, the task is pushed without taking the queue lock and the returned
+     * id is 0.
+     */
+    EnqueuedTask enqueueAsync(DispatchFunction function);
+
     void barrier(const DispatchFunction& function);
 
     void sync(const DispatchFunction& function) final;
@@ -48,50 +58,126 @@ public:
     size_t flush();
     size_t flushUpToNow();
 
+    /**
+     * Returns whether runNextTask() would immediately run a task right now.
+     */
+    bool hasTaskReady();
+
     bool isDisposed() const;
     void setListener(const Shared<IQueueListener>& listener);
 
     void setMaxConcurrentTasks(size_t maxConcurrentTasks);
 
+    /**
+     * When enabled, tasks submitted through async() and enqueueAsync() are pushed to a
+     * lock-free multi-producer stack which the consumer drains under the lock, and the
+     * consumer is only notified when it is parked. Delayed tasks, barriers and queues
+     * which have a listener keep using the locked path.
+     */
+    void setLockFreeAsyncEnabled(bool lockFreeAsyncEnabled);
+
     // For Testing Only
     Shared<IQueueListener> getListener() const;
 
 private:
     struct Task {
-        task_id_t id;
+        task_id_t id = 0;
         DispatchFunction function;
         std::chrono::steady_clock::time_point executeTime;
-        bool isBarrier;
+        bool isBarrier = false;
+        // Whether the task lives in the delayed heap instead of the immediate FIFO.
+        bool isDelayed = false;
+        // Cancelled tasks are left in place as tombstones and skipped when they reach the head.
+        bool isCancelled = false;
         // Connects the task's execution slice to its submit site (snap::profiling task
         // tracing; 0 when tracing is idle).
-        uint64_t parentSpanId;
+        uint64_t parentSpanId = 0;
 
+        Task();
         Task(task_id_t id,
              DispatchFunction function,
              std::chrono::steady_clock::time_point executeTime,
              bool isBarrier,
+             bool isDelayed,
              uint64_t parentSpanId);
     };
 
+    // Immediate task pushed through the lock-free async path.
+    struct AsyncTask {
+        DispatchFunction function;
+        std::chrono::steady_clock::time_point executeTime;
+        uint64_t parentSpanId;
+        AsyncTask* next = nullptr;
+
+        AsyncTask(DispatchFunction function,
+                  std::chrono::steady_clock::time_point executeTime,
+                  uint64_t parentSpanId);
+    };
+
     std::atomic_bool _disposed;
+    std::atomic_bool _first;
+    std::atomic_bool _lockFreeAsyncAllowed;
+    // Tasks pushed through the lock-free path, most recent first.
+    std::atomic<AsyncTask*> _asyncTasksHead;
+    // Number of consumers currently waiting on the condition.
+    std::atomic<size_t> _parkedConsumersCount;
     mutable Mutex _mutex;
     ConditionVariable _condition;
     task_id_t _taskIdCounter{0};
-    std::deque<Task> _tasks;
+
+    // Tasks are stored in slots which are recycled through a free list. The immediate
+    // FIFO and the delayed min-heap only hold slot indexes, and the id to slot map makes
+    // cancellation constant time. Both containers are kept sorted by (executeTime, id),
+    // the next task to run is the earliest of their two heads.
+    std::vector<Task> _taskSlots;
+    std::vector<uint32_t> _freeTaskSlots;
+    FlatMap<task_id_t, uint32_t> _taskSlotById;
+    std::deque<uint32_t> _immediateTasks;
+    std::vector<uint32_t> _delayedTasks;
+    size_t _cancelledDelayedTasksCount = 0;
+
     bool _empty = true;
-    bool _first = true;
+    bool _lockFreeAsyncEnabled = false;
     size_t _currentRunningTasks = 0;
     size_t _maxConcurrentTasks = 1;
     Shared<IQueueListener> _listener;
 
+    EnqueuedTask doEnqueue(DispatchFunction&& function,
+                           std::chrono::steady_clock::time_point executeTime,
+                           bool isImmediate);
+
     DispatchFunction nextTask(std::chrono::steady_clock::time_point maxTime, bool* shouldRun, uint64_t* parentSpanId);
 
     task_id_t insertTask(DispatchFunction&& function,
                          std::chrono::steady_clock::time_point executeTime,
                          bool isBarrier,
+                         bool isImmediate,
                          uint64_t parentSpanId);
+    task_id_t doInsertTask(DispatchFunction&& function,
+                           std::chrono::steady_clock::time_point executeTime,
+                           bool isBarrier,
+                           bool isImmediate,
+                           uint64_t parentSpanId);
+
+    void lockFreeDrainAsyncTasks();
+    void lockFreeSetNonEmpty();
+    void wakeUpParkedConsumers();
+    void deleteAsyncTasks(AsyncTask* head);
+    void updateLockFreeAsyncAllowed();
+    std::cv_status parkUntil(std::unique_lock<Mutex>& lock, std::chrono::steady_clock::time_point time);
 
     DispatchFunction lockFreeRemoveTask(task_id_t taskId);
+
+    Task* lockFreePeekNextTask();
+    Task lockFreePopNextTask();
+
+    uint32_t lockFreeAllocateTaskSlot(Task&& task);
+    void lockFreeReleaseTaskSlot(uint32_t slot);
+    void lockFreePushDelayedTask(uint32_t slot);
+    void lockFreePopDelayedTask();
+    void lockFreeCompactDelayedTasks();
+
+    bool isTaskAfter(uint32_t leftSlot, uint32_t rightSlot) const;
 };
 
 } // namespace Valdi
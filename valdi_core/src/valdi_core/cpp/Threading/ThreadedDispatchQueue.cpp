@@ -77,7 +77,7 @@ void ThreadedDispatchQueue::sync(const Valdi::DispatchFunction& function) {
 }
 
 void ThreadedDispatchQueue::async(Valdi::DispatchFunction function) {
-    auto task = _taskQueue->enqueue(std::move(function));
+    auto task = _taskQueue->enqueueAsync(std::move(function));
 
     if (VALDI_UNLIKELY(task.isFirst)) {
         startThread();
@@ -197,6 +197,10 @@ void ThreadedDispatchQueue::setQoSClass(ThreadQoSClass qosClass) {
     }
 }
 
+void ThreadedDispatchQueue::setLockFreeAsyncEnabled(bool lockFreeAsyncEnabled) {
+    _taskQueue->setLockFreeAsyncEnabled(lockFreeAsyncEnabled);
+}
+
 void ThreadedDispatchQueue::setDisableSyncCallsInCallingThread(bool disableSyncCallsInCallingThread) {
     _disableSyncCallsInCallingThread = disableSyncCallsInCallingThread;
 }
@@ -42,6 +42,12 @@ public:
 
     void setQoSClass(ThreadQoSClass qosClass) final;
 
+    /**
+     * Submit async() calls through the lock-free path of the underlying TaskQueue,
+     * which avoids contending on the queue lock when several threads post to this queue.
+     */
+    void setLockFreeAsyncEnabled(bool lockFreeAsyncEnabled);
+
     static ThreadedDispatchQueue* getCurrent();
 
     // For Testing Only
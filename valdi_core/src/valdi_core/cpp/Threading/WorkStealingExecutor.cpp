@@ -0,0 +1,278 @@
+//
+//  WorkStealingExecutor.cpp
+//  valdi
+//
+
+#include "valdi_core/cpp/Threading/WorkStealingExecutor.hpp"
+#include "valdi_core/cpp/Threading/Thread.hpp"
+#include "valdi_core/cpp/Utils/StringCache.hpp"
+
+#include <algorithm>
+#include <fmt/format.h>
+#include <thread>
+
+namespace Valdi {
+
+namespace {
+
+// Keep a few workers on devices reporting a single core, so that a task blocking
+// on I/O does not stall every other queue scheduled on the executor.
+constexpr size_t kMinWorkersCount = 4;
+
+thread_local const WorkStealingExecutor* tCurrentExecutor = nullptr;
+thread_local size_t tCurrentWorkerIndex = 0;
+
+size_t toPriorityBand(ThreadQoSClass qosClass) {
+    switch (qosClass) {
+        case ThreadQoSClassMax:
+        case ThreadQoSClassHigh:
+            return 0;
+        case ThreadQoSClassNormal:
+            return 1;
+        case ThreadQoSClassLow:
+        case ThreadQoSClassLowest:
+            return 2;
+    }
+    return 1;
+}
+
+struct ParallelForState : public SimpleRefCountable {
+    std::atomic<size_t> nextIndex;
+    size_t count;
+    const Function<void(size_t)>* function;
+    Mutex mutex;
+    ConditionVariable condition;
+    size_t completedCount = 0;
+
+    ParallelForState(size_t count, const Function<void(size_t)>* function)
+        : nextIndex(0), count(count), function(function) {}
+
+    void run() {
+        size_t completed = 0;
+        while (true) {
+            auto index = nextIndex.fetch_add(1, std::memory_order_relaxed);
+            if (index >= count) {
+                break;
+            }
+            (*function)(index);
+            completed++;
+        }
+
+        if (completed > 0) {
+            std::lock_guard<Mutex> lock(mutex);
+            completedCount += completed;
+            if (completedCount == count) {
+                condition.notifyAll();
+            }
+        }
+    }
+
+    void wait() {
+        std::unique_lock<Mutex> lock(mutex);
+        while (completedCount != count) {
+            condition.wait(lock);
+        }
+    }
+};
+
+} // namespace
+
+WorkStealingExecutor::Worker::Worker() : tasksCount(0) {}
+
+WorkStealingExecutor::WorkStealingExecutor(size_t workersCount)
+    : _timerQueue(makeShared<ThreadedDispatchQueue>(STRING_LITERAL("Valdi Executor Timer"), ThreadQoSClassHigh)),
+      _disposed(false),
+      _nextWorkerIndex(0),
+      _pendingTasksCount(0),
+      _parkedWorkersCount(0) {
+    workersCount = std::max(workersCount, static_cast<size_t>(1));
+    _workers.reserve(workersCount);
+    for (size_t i = 0; i < workersCount; i++) {
+        _workers.emplace_back(std::make_unique<Worker>());
+    }
+
+    for (size_t i = 0; i < workersCount; i++) {
+        auto threadResult =
+            Thread::create(StringCache::getGlobal().makeString(fmt::format("Valdi Worker {}", i)),
+                           ThreadQoSClassNormal,
+                           [this, i]() { runWorker(i); });
+        SC_ASSERT(threadResult.success(), threadResult.description());
+        _workers[i]->thread = threadResult.moveValue();
+    }
+}
+
+WorkStealingExecutor::~WorkStealingExecutor() {
+    teardown();
+}
+
+void WorkStealingExecutor::teardown() {
+    if (_disposed.exchange(true)) {
+        return;
+    }
+
+    _timerQueue->fullTeardown();
+
+    {
+        std::lock_guard<Mutex> guard(_mutex);
+    }
+    _condition.notifyAll();
+
+    for (const auto& worker : _workers) {
+        if (worker->thread != nullptr) {
+            worker->thread->join();
+            worker->thread = nullptr;
+        }
+    }
+}
+
+size_t WorkStealingExecutor::getWorkersCount() const {
+    return _workers.size();
+}
+
+void WorkStealingExecutor::parallelFor(size_t count,
+                                       ThreadQoSClass qosClass,
+                                       const Function<void(size_t)>& function) {
+    parallelFor(count, _workers.size() + 1, qosClass, function);
+}
+
+void WorkStealingExecutor::parallelFor(size_t count,
+                                       size_t maxConcurrency,
+                                       ThreadQoSClass qosClass,
+                                       const Function<void(size_t)>& function) {
+    if (count == 0) {
+        return;
+    }
+
+    // Helpers which start after all the indexes were claimed return immediately, the state
+    // is retained so that they can still safely look at it.
+    auto state = makeShared<ParallelForState>(count, &function);
+    // The calling thread counts as one of the lanes
+    auto lanesCount = std::min({count, maxConcurrency, _workers.size() + 1});
+    auto helpersCount = lanesCount > 0 ? lanesCount - 1 : 0;
+    for (size_t i = 0; i < helpersCount; i++) {
+        submit([state]() { state->run(); }, qosClass);
+    }
+
+    state->run();
+    state->wait();
+}
+
+void WorkStealingExecutor::submit(DispatchFunction function, ThreadQoSClass qosClass) {
+    if (_disposed) {
+        return;
+    }
+
+    // Tasks submitted from a worker stay on that worker, others are spread round robin
+    auto workerIndex = tCurrentExecutor == this ?
+                           tCurrentWorkerIndex :
+                           _nextWorkerIndex.fetch_add(1, std::memory_order_relaxed) % _workers.size();
+    auto& worker = *_workers[workerIndex];
+
+    // Incremented before the push so that a worker which sees the task never observes
+    // a pending count of zero.
+    _pendingTasksCount.fetch_add(1);
+    {
+        std::lock_guard<Mutex> guard(worker.mutex);
+        worker.bands[toPriorityBand(qosClass)].emplace_back(std::move(function));
+        worker.tasksCount.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // Pairs with the increment in runWorker(): either the worker sees the pending
+    // task before parking, or we see that it is parked and wake it up.
+    if (_parkedWorkersCount.load() != 0) {
+        {
+            std::lock_guard<Mutex> guard(_mutex);
+        }
+        _condition.notifyOne();
+    }
+}
+
+void WorkStealingExecutor::submitAfter(DispatchFunction function,
+                                       ThreadQoSClass qosClass,
+                                       std::chrono::steady_clock::duration delay) {
+    _timerQueue->asyncAfter(
+        [weakThis = weakRef(this), function = std::move(function), qosClass]() {
+            if (auto strongThis = weakThis.lock()) {
+                strongThis->submit(function, qosClass);
+            }
+        },
+        delay);
+}
+
+DispatchFunction WorkStealingExecutor::popTask(size_t workerIndex, size_t band, bool fromFront) {
+    auto& worker = *_workers[workerIndex];
+    if (worker.tasksCount.load(std::memory_order_relaxed) == 0) {
+        return DispatchFunction();
+    }
+
+    std::lock_guard<Mutex> guard(worker.mutex);
+    auto& tasks = worker.bands[band];
+    if (tasks.empty()) {
+        return DispatchFunction();
+    }
+
+    DispatchFunction function;
+    if (fromFront) {
+        function = std::move(tasks.front());
+        tasks.pop_front();
+    } else {
+        function = std::move(tasks.back());
+        tasks.pop_back();
+    }
+    worker.tasksCount.fetch_sub(1, std::memory_order_relaxed);
+    _pendingTasksCount.fetch_sub(1);
+
+    return function;
+}
+
+DispatchFunction WorkStealingExecutor::takeNextTask(size_t workerIndex) {
+    auto workersCount = _workers.size();
+
+    for (size_t band = 0; band < kPriorityBandsCount; band++) {
+        // Run our own tasks in submission order
+        auto function = popTask(workerIndex, band, true);
+        if (function) {
+            return function;
+        }
+
+        // Steal the most recent tasks of the other workers
+        for (size_t i = 1; i < workersCount; i++) {
+            function = popTask((workerIndex + i) % workersCount, band, false);
+            if (function) {
+                return function;
+            }
+        }
+    }
+
+    return DispatchFunction();
+}
+
+void WorkStealingExecutor::runWorker(size_t workerIndex) {
+    tCurrentExecutor = this;
+    tCurrentWorkerIndex = workerIndex;
+
+    while (!_disposed) {
+        auto function = takeNextTask(workerIndex);
+        if (function) {
+            function();
+            continue;
+        }
+
+        std::unique_lock<Mutex> guard(_mutex);
+        _parkedWorkersCount.fetch_add(1);
+        if (_pendingTasksCount.load() == 0 && !_disposed) {
+            _condition.wait(guard);
+        }
+        _parkedWorkersCount.fetch_sub(1);
+    }
+
+    tCurrentExecutor = nullptr;
+}
+
+const Ref<WorkStealingExecutor>& WorkStealingExecutor::getShared() {
+    static auto* kShared = new Ref<WorkStealingExecutor>(makeShared<WorkStealingExecutor>(
+        std::max(static_cast<size_t>(std::thread::hardware_concurrency()), kMinWorkersCount)));
+    return *kShared;
+}
+
+} // namespace Valdi
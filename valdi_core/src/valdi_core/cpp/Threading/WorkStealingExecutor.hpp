@@ -0,0 +1,94 @@
+//
+//  WorkStealingExecutor.hpp
+//  valdi
+//
+
+#pragma once
+
+#include "valdi_core/cpp/Threading/ThreadQoSClass.hpp"
+#include "valdi_core/cpp/Threading/ThreadedDispatchQueue.hpp"
+#include "valdi_core/cpp/Utils/Function.hpp"
+#include "valdi_core/cpp/Utils/Mutex.hpp"
+#include "valdi_core/cpp/Utils/Shared.hpp"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <memory>
+#include <vector>
+
+namespace Valdi {
+
+class Thread;
+
+/**
+ * A pool of worker threads with one task deque per worker, where idle workers steal
+ * tasks from the others. Tasks are submitted into a priority band derived from their
+ * ThreadQoSClass, and workers always run tasks from the highest non empty band first.
+ * Tasks submitted from a worker thread are pushed to that worker's deque.
+ */
+class WorkStealingExecutor : public SharedPtrRefCountable {
+public:
+    explicit WorkStealingExecutor(size_t workersCount);
+    ~WorkStealingExecutor() override;
+
+    void submit(DispatchFunction function, ThreadQoSClass qosClass);
+    void submitAfter(DispatchFunction function, ThreadQoSClass qosClass, std::chrono::steady_clock::duration delay);
+
+    size_t getWorkersCount() const;
+
+    /**
+     * Calls the given function once for every index in [0, count), spreading the calls across
+     * the workers and the calling thread. Returns once all the calls have completed.
+     * Indexes are claimed in increasing order, and the calling thread keeps claiming them until
+     * none are left, so the calls complete even if the workers are busy or the executor was torn down.
+     */
+    void parallelFor(size_t count, ThreadQoSClass qosClass, const Function<void(size_t)>& function);
+
+    /**
+     * Same as above, but runs at most maxConcurrency calls at the same time, including the one
+     * made by the calling thread.
+     */
+    void parallelFor(size_t count,
+                     size_t maxConcurrency,
+                     ThreadQoSClass qosClass,
+                     const Function<void(size_t)>& function);
+
+    /**
+     * Stops the workers and waits for them to exit. Pending tasks are dropped.
+     */
+    void teardown();
+
+    /**
+     * Returns the process wide executor, which has one worker per core.
+     */
+    static const Ref<WorkStealingExecutor>& getShared();
+
+private:
+    static constexpr size_t kPriorityBandsCount = 3;
+
+    struct Worker {
+        Mutex mutex;
+        std::array<std::deque<DispatchFunction>, kPriorityBandsCount> bands;
+        std::atomic<size_t> tasksCount;
+        Ref<Thread> thread;
+
+        Worker();
+    };
+
+    std::vector<std::unique_ptr<Worker>> _workers;
+    Ref<ThreadedDispatchQueue> _timerQueue;
+    std::atomic_bool _disposed;
+    std::atomic<size_t> _nextWorkerIndex;
+    std::atomic<size_t> _pendingTasksCount;
+    std::atomic<size_t> _parkedWorkersCount;
+    Mutex _mutex;
+    ConditionVariable _condition;
+
+    void runWorker(size_t workerIndex);
+    DispatchFunction takeNextTask(size_t workerIndex);
+    DispatchFunction popTask(size_t workerIndex, size_t band, bool fromFront);
+};
+
+} // namespace Valdi
@@ -10,8 +10,12 @@
 
 #include "valdi_core/cpp/Utils/Format.hpp"
 #include "valdi_core/cpp/Utils/StringCache.hpp"
+#include <atomic>
+#include <cerrno>
 #include <cstdio>
+#include <cstdlib>
 #include <dirent.h>
+#include <fcntl.h>
 #include <fstream>
 #include <sys/stat.h>
 #include <unistd.h>
@@ -36,6 +40,26 @@ static FileStat statFromFd(int fd) {
     return fileStatFromCStat(fstat(fd, &statStruct) >= 0, statStruct);
 }
 
+// Returns 0 on success, or the errno of the failed write
+static int writeToFd(int fd, const BytesView& bytes) {
+    const auto* data = bytes.data();
+    auto remaining = bytes.size();
+    while (remaining > 0) {
+        auto result = write(fd, data, remaining);
+        if (result < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return errno;
+        }
+
+        data += result;
+        remaining -= static_cast<size_t>(result);
+    }
+
+    return 0;
+}
+
 FileReader::FileReader(const Path& path) : _path(path.toString()) {}
 FileReader::~FileReader() {
     close();
@@ -191,6 +215,83 @@ Result<Void> DiskUtils::store(const Path& path, std::string_view bytes) {
     return Void();
 }
 
+Result<Void> DiskUtils::append(const Path& path, const BytesView& bytes) {
+    auto pathStr = path.toString();
+    auto fd = ::open(pathStr.c_str(), O_WRONLY | O_APPEND | O_CREAT | O_CLOEXEC, 0666);
+    if (fd < 0) {
+        return Error(STRING_FORMAT("Unable to open file for appending at {}: {}", pathStr, strerror(errno)));
+    }
+
+    // Appends are used for journals, which are expected to be durable once this returns
+    auto error = writeToFd(fd, bytes);
+    if (error == 0 && fsync(fd) != 0) {
+        error = errno;
+    }
+    if (close(fd) != 0 && error == 0) {
+        error = errno;
+    }
+
+    if (error != 0) {
+        return Error(STRING_FORMAT("Unable to append to file at {}: {}", pathStr, strerror(error)));
+    }
+
+    return Void();
+}
+
+Result<Void> DiskUtils::storeAtomically(const Path& path, const BytesView& bytes) {
+    auto pathStr = path.toString();
+    std::string tmpPathStr;
+    int fd = -1;
+    // Unlike mkstemp(), which always creates the file as 0600, open() applies the umask to the mode
+    // like store() does
+    for (size_t attempt = 0; attempt < 16 && fd < 0; attempt++) {
+        static std::atomic<uint32_t> kTemporaryFileSequence = 0;
+        tmpPathStr = fmt::format("{}.{}.{}.tmp", pathStr, getpid(), kTemporaryFileSequence.fetch_add(1));
+        fd = ::open(tmpPathStr.c_str(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, 0666);
+        if (fd < 0 && errno != EEXIST) {
+            break;
+        }
+    }
+    if (fd < 0) {
+        return Error(STRING_FORMAT("Unable to create temporary file to write {}: {}", pathStr, strerror(errno)));
+    }
+
+    // The replaced file keeps its permissions
+    struct stat existingStat;
+    if (::stat(pathStr.c_str(), &existingStat) == 0) {
+        fchmod(fd, existingStat.st_mode & 07777);
+    }
+
+    auto writeError = writeToFd(fd, bytes);
+    if (writeError != 0) {
+        close(fd);
+        unlink(tmpPathStr.c_str());
+        return Error(STRING_FORMAT("Unable to write file at {}: {}", tmpPathStr, strerror(writeError)));
+    }
+
+    // Flush the data before the rename is published, so that a crash cannot leave an empty file behind
+    if (fsync(fd) != 0) {
+        auto error = errno;
+        close(fd);
+        unlink(tmpPathStr.c_str());
+        return Error(STRING_FORMAT("Unable to sync file at {}: {}", tmpPathStr, strerror(error)));
+    }
+
+    if (close(fd) != 0) {
+        auto error = errno;
+        unlink(tmpPathStr.c_str());
+        return Error(STRING_FORMAT("Unable to write file at {}: {}", tmpPathStr, strerror(error)));
+    }
+
+    if (std::rename(tmpPathStr.c_str(), pathStr.c_str()) != 0) {
+        auto error = errno;
+        unlink(tmpPathStr.c_str());
+        return Error(STRING_FORMAT("Unable to move file to {}: {}", pathStr, strerror(error)));
+    }
+
+    return Void();
+}
+
 bool DiskUtils::makeDirectory(const Path& path, bool createIntermediates) {
     if (createIntermediates && path.getComponents().size() > 1) {
         auto parentPath = path.removingLastComponent();
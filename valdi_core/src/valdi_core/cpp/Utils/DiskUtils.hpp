@@ -82,6 +82,13 @@ public:
 
     static Result<Void> store(const Path& path, std::string_view bytes);
 
+    // Appends the bytes at the end of the file, creating it if needed, and syncs the file before returning.
+    static Result<Void> append(const Path& path, const BytesView& bytes);
+
+    // Writes the bytes into a temporary file next to the given path, syncs it and renames it over the path,
+    // so that readers never observe a partially written or truncated file.
+    static Result<Void> storeAtomically(const Path& path, const BytesView& bytes);
+
     static bool remove(const Path& path);
 
     static bool makeDirectory(const Path& path, bool createIntermediates);
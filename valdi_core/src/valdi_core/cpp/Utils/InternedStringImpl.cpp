@@ -45,8 +45,8 @@ void InternedStringImpl::unsafeRetainInner() {
 
 void InternedStringImpl::unsafeReleaseInner() {
     if (--_retainCount == 0) {
+        // The StringCache deletes the instance once no lookup can be reading it anymore
         StringCache::getGlobal().removeString(this);
-        delete this;
     }
 }
 
@@ -55,15 +55,16 @@ long InternedStringImpl::retainCount() const {
 }
 
 Ref<InternedStringImpl> InternedStringImpl::lock() {
-    auto retainCount = ++_retainCount;
-    /**
-     If the retainCount is 1, then the InternedStringImpl was at 0 before so it was pending removal
-     from the StringCache instance. In this case we return null.
-    */
-    if (retainCount == 1) {
-        _retainCount = 0;
-        return nullptr;
-    }
+    auto retainCount = _retainCount.load();
+    do {
+        /**
+         If the retainCount is 0, then the InternedStringImpl is pending removal from the StringCache
+         instance and cannot be retained again. In this case we return null.
+        */
+        if (retainCount == 0) {
+            return nullptr;
+        }
+    } while (!_retainCount.compare_exchange_weak(retainCount, retainCount + 1));
 
     return Ref<InternedStringImpl>(this, AdoptRef());
 }
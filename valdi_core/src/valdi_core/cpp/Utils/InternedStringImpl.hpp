@@ -52,7 +52,8 @@ private:
     /**
      Returns a reference to this InternedStringImpl if the
      InternedStringImpl is alive and is not pending removal.
-     This should be called only with the StringCache mutex locked.
+     This can be called concurrently, as long as the StringCache
+     guarantees that the instance was not deleted yet.
     */
     Ref<InternedStringImpl> lock();
 
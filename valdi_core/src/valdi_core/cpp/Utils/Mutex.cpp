@@ -66,6 +66,14 @@ void Mutex::lock() {
     _threadChecker.onLock();
 }
 
+bool Mutex::try_lock() {
+    if (!_innerMutex.try_lock()) {
+        return false;
+    }
+    _threadChecker.onLock();
+    return true;
+}
+
 void Mutex::unlock() {
     _threadChecker.onUnlock();
     _innerMutex.unlock();
@@ -0,0 +1,239 @@
+//
+//  SlabAllocator.cpp
+//  valdi
+//
+
+#include "valdi_core/cpp/Utils/SlabAllocator.hpp"
+
+#include <algorithm>
+#include <new>
+
+namespace Valdi {
+
+namespace {
+
+struct alignas(SlabAllocator::kBlockAlignment) TaggedBlockHeader {
+    size_t size;
+    bool allocatedFromSlab;
+};
+
+static_assert(sizeof(TaggedBlockHeader) == SlabAllocator::kBlockAlignment);
+
+constexpr size_t toBlockSize(size_t size) {
+    return std::max((size + SlabAllocator::kBlockAlignment - 1) & ~(SlabAllocator::kBlockAlignment - 1),
+                    SlabAllocator::kBlockAlignment);
+}
+
+// The slab size only depends on the block size, which is what lets deallocate() find the slab
+// of a block from its address, as slabs are aligned on their size.
+constexpr size_t toSlabSize(size_t blockSize) {
+    auto slabSize = SlabAllocator::kMinSlabSize;
+    while (slabSize < blockSize * SlabAllocator::kMinBlocksPerSlab && slabSize < SlabAllocator::kMaxSlabSize) {
+        slabSize *= 2;
+    }
+    return slabSize;
+}
+
+} // namespace
+
+struct SlabAllocator::Slab {
+    // One per live block, plus one held by the allocator until it is destroyed
+    std::atomic<size_t> refCount{1};
+    // Blocks released through deallocate(), taken back by the allocator once freeBlocks is empty
+    std::atomic<FreeBlock*> releasedBlocks{nullptr};
+    // Only accessed by the allocator
+    FreeBlock* freeBlocks = nullptr;
+    uint8_t* cursor = nullptr;
+    uint8_t* end = nullptr;
+    size_t size;
+
+    explicit Slab(size_t size) : size(size) {}
+
+    static Slab* make(size_t slabSize) {
+        auto* storage = static_cast<uint8_t*>(::operator new(slabSize, std::align_val_t(slabSize)));
+        auto* slab = new (storage) Slab(slabSize);
+        slab->cursor = storage + toBlockSize(sizeof(Slab));
+        slab->end = storage + slabSize;
+        return slab;
+    }
+
+    static Slab* fromBlock(void* block, size_t blockSize) {
+        auto slabSize = toSlabSize(blockSize);
+        return reinterpret_cast<Slab*>(reinterpret_cast<uintptr_t>(block) & ~static_cast<uintptr_t>(slabSize - 1));
+    }
+
+    void* takeBlock(size_t blockSize) {
+        void* block;
+        if (freeBlocks == nullptr && releasedBlocks.load(std::memory_order_relaxed) != nullptr) {
+            freeBlocks = releasedBlocks.exchange(nullptr, std::memory_order_acquire);
+        }
+
+        if (freeBlocks != nullptr) {
+            block = freeBlocks;
+            freeBlocks = freeBlocks->next;
+        } else if (cursor + blockSize <= end) {
+            block = cursor;
+            cursor += blockSize;
+        } else {
+            return nullptr;
+        }
+
+        refCount.fetch_add(1, std::memory_order_relaxed);
+        return block;
+    }
+
+    void releaseBlock(void* ptr) {
+        auto* block = static_cast<FreeBlock*>(ptr);
+        auto* head = releasedBlocks.load(std::memory_order_relaxed);
+        do {
+            block->next = head;
+        } while (!releasedBlocks.compare_exchange_weak(
+            head, block, std::memory_order_release, std::memory_order_relaxed));
+
+        unsafeRelease();
+    }
+
+    void unsafeRelease() {
+        // This might free the slab if the allocator is gone and this was the last block
+        if (refCount.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            auto slabSize = size;
+            this->~Slab();
+            ::operator delete(this, std::align_val_t(slabSize));
+        }
+    }
+
+    bool isEmpty() const {
+        return refCount.load(std::memory_order_acquire) == 1;
+    }
+};
+
+SlabAllocator::SlabAllocator() = default;
+
+SlabAllocator::~SlabAllocator() {
+    for (auto& it : _sizeClasses) {
+        for (auto* slab : it.second.slabs) {
+            // Slabs with live blocks are freed with their last block
+            slab->unsafeRelease();
+        }
+    }
+}
+
+void* SlabAllocator::allocate(size_t size) {
+    auto blockSize = toBlockSize(size);
+    if (blockSize > kMaxBlockSize) {
+        return ::operator new(size);
+    }
+
+    auto& sizeClass = _sizeClasses[blockSize];
+    if (sizeClass.currentSlab != nullptr) {
+        auto* block = sizeClass.currentSlab->takeBlock(blockSize);
+        if (block != nullptr) {
+            return block;
+        }
+    }
+
+    return allocateFromOtherSlab(sizeClass, blockSize);
+}
+
+void* SlabAllocator::allocateFromOtherSlab(SizeClass& sizeClass, size_t blockSize) {
+    // The current slab is full, switch to the first slab which got blocks released since
+    // it was last used, or to a new slab if there are none.
+    for (auto* slab : sizeClass.slabs) {
+        if (slab == sizeClass.currentSlab) {
+            continue;
+        }
+        auto* block = slab->takeBlock(blockSize);
+        if (block != nullptr) {
+            sizeClass.currentSlab = slab;
+            return block;
+        }
+    }
+
+    auto slabSize = toSlabSize(blockSize);
+    auto* slab = Slab::make(slabSize);
+    sizeClass.slabs.emplace_back(slab);
+    sizeClass.currentSlab = slab;
+    _slabsCount++;
+    _slabsSize += slabSize;
+
+    return slab->takeBlock(blockSize);
+}
+
+void SlabAllocator::deallocate(void* ptr, size_t size) {
+    if (ptr == nullptr) {
+        return;
+    }
+
+    auto blockSize = toBlockSize(size);
+    if (blockSize > kMaxBlockSize) {
+        ::operator delete(ptr);
+        return;
+    }
+
+    Slab::fromBlock(ptr, blockSize)->releaseBlock(ptr);
+}
+
+void SlabAllocator::releaseEmptySlabs() {
+    for (auto& it : _sizeClasses) {
+        releaseEmptySlabs(it.second);
+    }
+}
+
+void SlabAllocator::releaseEmptySlabs(SizeClass& sizeClass) {
+    size_t keptCount = 0;
+    for (auto* slab : sizeClass.slabs) {
+        if (slab != sizeClass.currentSlab && slab->isEmpty()) {
+            _slabsCount--;
+            _slabsSize -= slab->size;
+            // No block can be released into the slab anymore, this frees it right away
+            slab->unsafeRelease();
+        } else {
+            sizeClass.slabs[keptCount++] = slab;
+        }
+    }
+    sizeClass.slabs.resize(keptCount);
+}
+
+void* SlabAllocator::allocateTagged(SlabAllocator* allocator, size_t size) {
+    auto totalSize = sizeof(TaggedBlockHeader) + size;
+    void* ptr = allocator != nullptr ? allocator->allocate(totalSize) : ::operator new(totalSize);
+
+    auto* header = new (ptr) TaggedBlockHeader();
+    header->size = totalSize;
+    header->allocatedFromSlab = allocator != nullptr;
+
+    return header + 1;
+}
+
+void SlabAllocator::deallocateTagged(void* ptr) {
+    if (ptr == nullptr) {
+        return;
+    }
+
+    auto* header = static_cast<TaggedBlockHeader*>(ptr) - 1;
+    if (header->allocatedFromSlab) {
+        deallocate(header, header->size);
+    } else {
+        ::operator delete(header);
+    }
+}
+
+size_t SlabAllocator::getSlabsCount() const {
+    return _slabsCount;
+}
+
+size_t SlabAllocator::getSlabsSize() const {
+    return _slabsSize;
+}
+
+size_t SlabAllocator::getLiveBlocksCount() const {
+    size_t liveBlocksCount = 0;
+    for (const auto& it : _sizeClasses) {
+        for (const auto* slab : it.second.slabs) {
+            liveBlocksCount += slab->refCount.load(std::memory_order_relaxed) - 1;
+        }
+    }
+    return liveBlocksCount;
+}
+
+} // namespace Valdi
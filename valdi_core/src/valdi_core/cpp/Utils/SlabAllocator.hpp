@@ -0,0 +1,155 @@
+//
+//  SlabAllocator.hpp
+//  valdi
+//
+
+#pragma once
+
+#include "valdi_core/cpp/Utils/FlatMap.hpp"
+#include "valdi_core/cpp/Utils/Shared.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace Valdi {
+
+/**
+ * An allocator for many small objects of the same owner, like the nodes of a tree.
+ * Allocations are rounded up to a size class and carved out of slabs dedicated to that
+ * size class, so that released blocks are reused without going back to the system allocator.
+ * Allocations larger than kMaxBlockSize are forwarded to the system allocator.
+ *
+ * allocate() is not thread safe and should only be called by the owner of the allocator,
+ * for instance while holding the lock of the tree it belongs to. Blocks can be released
+ * from any thread through the static deallocate(), which pushes them on a lock free list
+ * of their slab that the owner takes back on its next allocations.
+ *
+ * Each slab tracks its own live blocks: empty slabs are given back by releaseEmptySlabs(),
+ * and a slab which still has live blocks when the allocator is destroyed is freed by the
+ * release of its last block. Blocks therefore don't need to keep the allocator alive.
+ */
+class SlabAllocator : public SimpleRefCountable {
+public:
+    static constexpr size_t kBlockAlignment = 16;
+    static constexpr size_t kMaxBlockSize = 4096;
+    static constexpr size_t kMinSlabSize = 4096;
+    static constexpr size_t kMaxSlabSize = 64 * 1024;
+    static constexpr size_t kMinBlocksPerSlab = 16;
+
+    SlabAllocator();
+    ~SlabAllocator() override;
+
+    void* allocate(size_t size);
+
+    /**
+     * Release a block allocated from a SlabAllocator with the same size, which can be
+     * done from any thread and after the allocator was destroyed.
+     */
+    static void deallocate(void* ptr, size_t size);
+
+    /**
+     * Allocate a block which remembers its size and whether it was allocated from a
+     * SlabAllocator, for objects which are released through operator delete.
+     * Allocates from the system allocator when the given allocator is null.
+     */
+    static void* allocateTagged(SlabAllocator* allocator, size_t size);
+    static void deallocateTagged(void* ptr);
+
+    /**
+     * Give back the slabs which don't have any live blocks to the system allocator,
+     * keeping the slab each size class currently allocates from.
+     */
+    void releaseEmptySlabs();
+
+    size_t getSlabsCount() const;
+    size_t getSlabsSize() const;
+    size_t getLiveBlocksCount() const;
+
+private:
+    struct FreeBlock {
+        FreeBlock* next;
+    };
+
+    struct Slab;
+
+    struct SizeClass {
+        Slab* currentSlab = nullptr;
+        std::vector<Slab*> slabs;
+    };
+
+    FlatMap<size_t, SizeClass> _sizeClasses;
+    size_t _slabsCount = 0;
+    size_t _slabsSize = 0;
+
+    void* allocateFromOtherSlab(SizeClass& sizeClass, size_t blockSize);
+    void releaseEmptySlabs(SizeClass& sizeClass);
+};
+
+/**
+ * A standard allocator backed by a SlabAllocator, or by the system allocator when
+ * constructed without one.
+ */
+template<typename T>
+class SlabStdAllocator {
+public:
+    using value_type = T;
+
+    explicit SlabStdAllocator(SlabAllocator* allocator) : _allocator(allocator) {}
+
+    template<typename U>
+    // NOLINTNEXTLINE(google-explicit-constructor)
+    SlabStdAllocator(const SlabStdAllocator<U>& other) : _allocator(other.getSlabAllocator()) {}
+
+    T* allocate(size_t n) {
+        static_assert(alignof(T) <= SlabAllocator::kBlockAlignment);
+        if (_allocator == nullptr) {
+            return std::allocator<T>().allocate(n);
+        }
+        return static_cast<T*>(_allocator->allocate(n * sizeof(T)));
+    }
+
+    void deallocate(T* ptr, size_t n) {
+        if (_allocator == nullptr) {
+            std::allocator<T>().deallocate(ptr, n);
+        } else {
+            // The allocator might be gone at this point, the block only needs its slab
+            SlabAllocator::deallocate(ptr, n * sizeof(T));
+        }
+    }
+
+    SlabAllocator* getSlabAllocator() const {
+        return _allocator;
+    }
+
+    template<typename U>
+    bool operator==(const SlabStdAllocator<U>& other) const {
+        return _allocator == other.getSlabAllocator();
+    }
+
+    template<typename U>
+    bool operator!=(const SlabStdAllocator<U>& other) const {
+        return _allocator != other.getSlabAllocator();
+    }
+
+private:
+    SlabAllocator* _allocator;
+};
+
+/**
+ * Same as makeShared(), but allocates the object and its ref count from the given allocator.
+ */
+template<typename T, typename... Args>
+inline Ref<T> allocateShared(SlabAllocator* allocator, Args&&... args) {
+    assertSharedTypeCompatible<T>();
+
+    typename std::aligned_storage<sizeof(std::shared_ptr<T>), alignof(std::shared_ptr<T>)>::type storage;
+    new (&storage)
+        std::shared_ptr<T>(std::allocate_shared<T>(SlabStdAllocator<T>(allocator), std::forward<Args>(args)...));
+
+    return Ref<T>(reinterpret_cast<std::shared_ptr<T>&>(storage).get(), AdoptRef());
+}
+
+} // namespace Valdi
@@ -9,30 +9,54 @@
 #include "valdi_core/cpp/Text/UTF16Utils.hpp"
 #include <codecvt>
 #include <iostream>
+#include <optional>
 #include <vector>
 
 namespace Valdi {
 
+constexpr size_t kInitialTableCapacity = 64;
+// Number of retired strings in a shard past which lookups try to reclaim them
+constexpr size_t kReclaimThreshold = 16;
+
+// Marks the slot of a removed string, so that probing continues past it
+static char kTombstoneStorage;
+
+static InternedStringImpl* getTombstone() {
+    return reinterpret_cast<InternedStringImpl*>(&kTombstoneStorage);
+}
+
 static size_t makePHMapHash(size_t hash) {
-    // Same function used by phmap internally, so that the find variant
-    // that takes a hash parameter matches what the hasher function does.
+    // Same function used by phmap internally, which spreads the bits of
+    // std::hash implementations that return the input as is.
     return phmap::phmap_mix<sizeof(size_t)>()(hash);
 }
 
-std::size_t StringCacheHash::operator()(const StringCacheEntry& entry) const {
-    return entry.impl->getHash();
+StringCache::Table::Table(size_t capacity)
+    : capacity(capacity), slots(std::make_unique<std::atomic<InternedStringImpl*>[]>(capacity)) {
+    for (size_t i = 0; i < capacity; i++) {
+        slots[i].store(nullptr, std::memory_order_relaxed);
+    }
 }
 
-bool StringCacheEqual::operator()(const Valdi::StringCacheEntry& left, const Valdi::StringCacheEntry& right) const {
-    return left.impl == right.impl;
+StringCache::Shard::Shard() : ownedTable(std::make_unique<Table>(kInitialTableCapacity)) {
+    table.store(ownedTable.get());
 }
 
-bool StringCacheEqual::operator()(const Valdi::StringCacheEntry& left, const std::string_view& right) const {
-    return left.impl->toStringView() == right;
+StringCache::Shard::~Shard() {
+    for (auto* retiredString : retiredStrings) {
+        delete retiredString;
+    }
 }
 
-bool StringCacheEqual::operator()(const Valdi::StringCacheEntry& left, const Valdi::InternedStringImpl* right) const {
-    return left.impl == right;
+thread_local StringCache::ReaderSlot* StringCache::tReaderSlot = nullptr;
+thread_local bool StringCache::tReaderSlotReleased = false;
+
+StringCache::ReaderSlotReleaser::~ReaderSlotReleaser() {
+    if (tReaderSlot != nullptr) {
+        tReaderSlot->inUse.store(false, std::memory_order_release);
+        tReaderSlot = nullptr;
+    }
+    tReaderSlotReleased = true;
 }
 
 StringCache::StringCache() = default;
@@ -57,20 +81,16 @@ StringBox StringCache::makeString(std::string_view strView) noexcept {
     }
 
     auto hash = StringBox::makeHash(strView);
+    auto mixedHash = makePHMapHash(hash);
+    auto& shard = getShard(mixedHash);
 
-    std::lock_guard<Mutex> guard(_mutex);
-
-    const auto& it = findEntry(strView, hash);
-    if (it != _table.end()) {
-        auto locked = it->impl->lock();
-        if (locked != nullptr) {
-            return StringBox(Ref<InternedStringImpl>(std::move(locked)));
-        } else {
-            _table.erase(it);
-        }
+    auto existing = findString(shard, strView, hash, mixedHash);
+    if (existing != nullptr) {
+        return StringBox(std::move(existing));
     }
 
-    return insertString(strView, hash);
+    std::lock_guard<Mutex> guard(shard.mutex);
+    return insertString(shard, strView, hash, mixedHash);
 }
 
 StringBox StringCache::makeStringFromUTF16(const char16_t* utf16String, size_t len) noexcept {
@@ -87,45 +107,283 @@ StringBox StringCache::makeStringFromCLiteral(const char* cStr) noexcept {
     return getGlobal().makeStringFromLiteral(cStr);
 }
 
-StringBox StringCache::insertString(std::string_view str, size_t hash) {
+StringCache::Shard& StringCache::getShard(size_t mixedHash) {
+    return _shards[mixedHash % kShardsCount];
+}
+
+StringCache::ReaderSlot* StringCache::getReaderSlot() {
+    if (tReaderSlot != nullptr || tReaderSlotReleased) {
+        // The slot is null if the thread is exiting and already released it
+        return tReaderSlot;
+    }
+
+    // The StringCache is only used through its global instance, which is never deleted,
+    // so the slot of a thread can be kept in a thread local.
+    for (auto* readerSlot = _readerSlots.load(std::memory_order_acquire); readerSlot != nullptr;
+         readerSlot = readerSlot->next) {
+        auto inUse = false;
+        if (readerSlot->inUse.compare_exchange_strong(inUse, true, std::memory_order_acquire)) {
+            tReaderSlot = readerSlot;
+            break;
+        }
+    }
+
+    if (tReaderSlot == nullptr) {
+        auto* readerSlot = new ReaderSlot();
+        readerSlot->inUse.store(true, std::memory_order_relaxed);
+        readerSlot->next = _readerSlots.load(std::memory_order_relaxed);
+        while (!_readerSlots.compare_exchange_weak(
+            readerSlot->next, readerSlot, std::memory_order_release, std::memory_order_relaxed)) {
+        }
+        tReaderSlot = readerSlot;
+    }
+
+    static thread_local ReaderSlotReleaser kReaderSlotReleaser;
+
+    return tReaderSlot;
+}
+
+bool StringCache::hasReaderStartedBefore(uint64_t epoch) const {
+    for (const auto* readerSlot = _readerSlots.load(std::memory_order_acquire); readerSlot != nullptr;
+         readerSlot = readerSlot->next) {
+        auto readerEpoch = readerSlot->epoch.load(std::memory_order_acquire);
+        if (readerEpoch != 0 && readerEpoch < epoch) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+Ref<InternedStringImpl> StringCache::findString(Shard& shard, std::string_view str, size_t hash, size_t mixedHash) {
+    auto* readerSlot = getReaderSlot();
+    if (readerSlot == nullptr) {
+        std::lock_guard<Mutex> guard(shard.mutex);
+        return probeString(*shard.ownedTable, str, hash, mixedHash);
+    }
+
+    readerSlot->epoch.store(_epoch.load(std::memory_order_acquire), std::memory_order_relaxed);
+    // Pairs with the fence in reclaimRetired(): either the reclaim sees this lookup in progress,
+    // or this lookup sees the slots cleared before the reclaim.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    auto result = probeString(*shard.table.load(std::memory_order_acquire), str, hash, mixedHash);
+
+    readerSlot->epoch.store(0, std::memory_order_release);
+
+    if (shard.needsReclaim.load(std::memory_order_relaxed) && shard.mutex.try_lock()) {
+        reclaimRetired(shard);
+        shard.mutex.unlock();
+    }
+
+    return result;
+}
+
+Ref<InternedStringImpl> StringCache::probeString(const Table& table,
+                                                 std::string_view str,
+                                                 size_t hash,
+                                                 size_t mixedHash) {
+    auto mask = table.capacity - 1;
+    auto index = (mixedHash / kShardsCount) & mask;
+
+    for (size_t probes = 0; probes < table.capacity; probes++) {
+        auto* internedString = table.slots[index].load(std::memory_order_acquire);
+        if (internedString == nullptr) {
+            break;
+        }
+
+        if (internedString != getTombstone() && internedString->getHash() == hash &&
+            internedString->toStringView() == str) {
+            // Will be null if the string is pending removal, in which case the caller
+            // falls back to inserting it again.
+            return internedString->lock();
+        }
+
+        index = (index + 1) & mask;
+    }
+
+    return nullptr;
+}
+
+StringBox StringCache::insertString(Shard& shard, std::string_view str, size_t hash, size_t mixedHash) {
+    growTableIfNeeded(shard);
+
+    auto& table = *shard.ownedTable;
+    auto mask = table.capacity - 1;
+    auto index = (mixedHash / kShardsCount) & mask;
+    std::optional<size_t> insertionIndex;
+    auto insertionSlotWasEmpty = false;
+
+    for (size_t probes = 0; probes < table.capacity; probes++) {
+        auto* internedString = table.slots[index].load(std::memory_order_relaxed);
+        if (internedString == nullptr) {
+            if (!insertionIndex) {
+                insertionIndex = {index};
+                insertionSlotWasEmpty = true;
+            }
+            break;
+        }
+
+        if (internedString == getTombstone()) {
+            if (!insertionIndex) {
+                insertionIndex = {index};
+            }
+        } else if (internedString->getHash() == hash && internedString->toStringView() == str) {
+            // The string was inserted by another thread after our lookup
+            auto locked = internedString->lock();
+            if (locked != nullptr) {
+                return StringBox(std::move(locked));
+            }
+
+            // The string is pending removal, the thread releasing it will delete it
+            table.slots[index].store(getTombstone());
+            shard.stringsCount--;
+            if (!insertionIndex) {
+                insertionIndex = {index};
+            }
+        }
+
+        index = (index + 1) & mask;
+    }
+
     auto internedString = InternedStringImpl::make(str.data(), str.size(), hash);
 
-    _table.emplace(internedString.get());
+    table.slots[insertionIndex.value()].store(internedString.get());
+    shard.stringsCount++;
+    if (insertionSlotWasEmpty) {
+        shard.usedSlotsCount++;
+    }
 
-    return StringBox(Ref<InternedStringImpl>(std::move(internedString)));
+    reclaimRetiredIfNeeded(shard);
+
+    return StringBox(std::move(internedString));
 }
 
-void StringCache::removeString(const InternedStringImpl* internedString) {
-    std::lock_guard<Mutex> guard(_mutex);
+void StringCache::removeString(InternedStringImpl* internedString) {
+    auto mixedHash = makePHMapHash(internedString->getHash());
+    auto& shard = getShard(mixedHash);
+
+    std::lock_guard<Mutex> guard(shard.mutex);
 
-    const auto& it = _table.find(internedString, makePHMapHash(internedString->getHash()));
-    if (it != _table.end()) {
-        _table.erase(it);
+    auto& table = *shard.ownedTable;
+    auto mask = table.capacity - 1;
+    auto index = (mixedHash / kShardsCount) & mask;
+
+    for (size_t probes = 0; probes < table.capacity; probes++) {
+        auto* slotString = table.slots[index].load(std::memory_order_relaxed);
+        if (slotString == nullptr) {
+            // Already replaced by a newer instance of the same string
+            break;
+        }
+        if (slotString == internedString) {
+            table.slots[index].store(getTombstone());
+            shard.stringsCount--;
+            break;
+        }
+
+        index = (index + 1) & mask;
     }
+
+    shard.retiredStrings.emplace_back(internedString);
+    reclaimRetiredIfNeeded(shard);
 }
 
-std::unique_lock<Mutex> StringCache::lock() {
-    return std::unique_lock<Mutex>(_mutex);
+void StringCache::growTableIfNeeded(Shard& shard) {
+    const auto& table = *shard.ownedTable;
+    // Keep the load factor, including tombstones, under 75% so that probing stays short
+    // and always ends on an empty slot.
+    if ((shard.usedSlotsCount + 1) * 4 <= table.capacity * 3) {
+        return;
+    }
+
+    auto capacity = kInitialTableCapacity;
+    while ((shard.stringsCount + 1) * 2 > capacity) {
+        capacity *= 2;
+    }
+
+    auto newTable = std::make_unique<Table>(capacity);
+    auto mask = capacity - 1;
+
+    for (size_t i = 0; i < table.capacity; i++) {
+        auto* internedString = table.slots[i].load(std::memory_order_relaxed);
+        if (internedString == nullptr || internedString == getTombstone()) {
+            continue;
+        }
+
+        auto index = (makePHMapHash(internedString->getHash()) / kShardsCount) & mask;
+        while (newTable->slots[index].load(std::memory_order_relaxed) != nullptr) {
+            index = (index + 1) & mask;
+        }
+        newTable->slots[index].store(internedString, std::memory_order_relaxed);
+    }
+
+    shard.usedSlotsCount = shard.stringsCount;
+    // Readers which loaded the previous table can still be probing it
+    shard.table.store(newTable.get());
+    shard.retiredTables.emplace_back(std::move(shard.ownedTable));
+    shard.ownedTable = std::move(newTable);
+}
+
+void StringCache::reclaimRetiredIfNeeded(Shard& shard) {
+    // Retired tables are large, they are reclaimed right away. Strings are reclaimed in batches,
+    // as each reclaim advances the epoch that every lookup reads.
+    if (shard.retiredTables.empty() && shard.retiredStrings.size() < kReclaimThreshold) {
+        return;
+    }
+
+    reclaimRetired(shard);
+}
+
+void StringCache::reclaimRetired(Shard& shard) {
+    if (shard.retiredStrings.empty() && shard.retiredTables.empty()) {
+        shard.needsReclaim.store(false, std::memory_order_relaxed);
+        return;
+    }
+
+    // Lookups which start from now on read the new epoch, and can only see the slots as they are
+    // now, which no longer reference what was retired.
+    auto epoch = _epoch.fetch_add(1, std::memory_order_acq_rel) + 1;
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    if (hasReaderStartedBefore(epoch)) {
+        // Will be reclaimed by a later lookup, insertion or removal
+        shard.needsReclaim.store(true, std::memory_order_relaxed);
+        return;
+    }
+
+    for (auto* retiredString : shard.retiredStrings) {
+        delete retiredString;
+    }
+    shard.retiredStrings.clear();
+    shard.retiredTables.clear();
+    shard.needsReclaim.store(false, std::memory_order_relaxed);
+}
+
+std::unique_lock<Mutex> StringCache::lock(std::string_view str) {
+    return std::unique_lock<Mutex>(getShard(makePHMapHash(StringBox::makeHash(str))).mutex);
 }
 
 std::vector<StringBox> StringCache::all() const {
     std::vector<StringBox> out;
 
-    std::lock_guard<Mutex> guard(_mutex);
-    out.reserve(_table.size());
+    for (const auto& shard : _shards) {
+        std::lock_guard<Mutex> guard(shard.mutex);
+
+        const auto& table = *shard.ownedTable;
+        for (size_t i = 0; i < table.capacity; i++) {
+            auto* internedString = table.slots[i].load(std::memory_order_relaxed);
+            if (internedString == nullptr || internedString == getTombstone()) {
+                continue;
+            }
 
-    for (const auto& it : _table) {
-        auto locked = it.impl->lock();
-        if (locked != nullptr) {
-            out.emplace_back(Ref<InternedStringImpl>(std::move(locked)));
+            auto locked = internedString->lock();
+            if (locked != nullptr) {
+                out.emplace_back(Ref<InternedStringImpl>(std::move(locked)));
+            }
         }
     }
 
     return out;
 }
 
-StringCache::StringTable::const_iterator StringCache::findEntry(const std::string_view& str, size_t hash) const {
-    return _table.find(str, makePHMapHash(hash));
-}
-
 } // namespace Valdi
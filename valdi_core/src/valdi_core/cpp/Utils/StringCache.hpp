@@ -12,6 +12,12 @@
 #include "valdi_core/cpp/Utils/Mutex.hpp"
 #include "valdi_core/cpp/Utils/StringBox.hpp"
 
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
 #define STRING_LITERAL(str) Valdi::StringCache::makeStringFromCLiteral(str)
 #define STRING_FORMAT(__format, ...) Valdi::StringCache::getGlobal().makeString(fmt::format((__format), __VA_ARGS__))
 
@@ -39,24 +45,6 @@ static inline std::string_view convertInline(const std::string_view& str) {
     return str;
 }
 
-struct StringCacheEntry {
-    InternedStringImpl* impl;
-
-    inline StringCacheEntry(InternedStringImpl* impl) : impl(impl) {}
-};
-
-struct StringCacheHash {
-    using is_transparent = void;
-    std::size_t operator()(const StringCacheEntry& entry) const;
-};
-
-struct StringCacheEqual {
-    using is_transparent = void;
-    bool operator()(const StringCacheEntry& left, const StringCacheEntry& right) const;
-    bool operator()(const StringCacheEntry& left, const std::string_view& right) const;
-    bool operator()(const StringCacheEntry& left, const InternedStringImpl* right) const;
-};
-
 class StringCache {
 public:
     StringCache(const StringCache& other) = delete;
@@ -88,9 +76,10 @@ public:
     StringBox makeStringFromUTF16(const char16_t* utf16String, size_t len) noexcept;
 
     /**
-     Exposed for tests only, DO NOT USE
+     Exposed for tests only, DO NOT USE.
+     Locks the shard in which the given string would be interned.
      */
-    std::unique_lock<Mutex> lock();
+    std::unique_lock<Mutex> lock(std::string_view str);
 
     /**
      Returns all of the strings inside the StringCache
@@ -103,22 +92,92 @@ public:
     static StringBox makeStringFromCLiteral(const char* cStr) noexcept;
 
 private:
-    using StringTable =
-        phmap::flat_hash_set<StringCacheEntry, StringCacheHash, StringCacheEqual, phmap::Allocator<StringCacheEntry>>;
+    static constexpr size_t kShardsCount = 32;
+
+    /**
+     Open addressing table of interned strings, with linear probing.
+     Slots are atomic so that they can be read without holding the shard lock.
+     */
+    struct Table {
+        size_t capacity;
+        std::unique_ptr<std::atomic<InternedStringImpl*>[]> slots;
 
-    StringTable _table;
-    mutable Mutex _mutex;
+        explicit Table(size_t capacity);
+    };
+
+    /**
+     The strings are spread across shards by hash. Looking up a string which is already
+     interned does not take the shard lock, inserting and removing strings do. Removed strings
+     and replaced tables are retired, and deleted once no lookup can still be reading them.
+     */
+    struct alignas(64) Shard {
+        mutable Mutex mutex;
+        std::atomic<Table*> table;
+        std::unique_ptr<Table> ownedTable;
+        // Number of slots holding a string
+        size_t stringsCount = 0;
+        // Number of slots holding a string or a tombstone
+        size_t usedSlotsCount = 0;
+        // Removed strings and replaced tables waiting for the lookups reading them to finish
+        std::vector<InternedStringImpl*> retiredStrings;
+        std::vector<std::unique_ptr<Table>> retiredTables;
+        // Set when reclaiming was prevented by a lookup in progress, so that lookups retry it
+        std::atomic<bool> needsReclaim = false;
+
+        Shard();
+        ~Shard();
+    };
+
+    /**
+     Per thread registration of the lookups in progress. A lookup publishes the epoch it started
+     in to the slot of its thread, which is only written by that thread, so that lookups don't
+     contend on a shared counter. Reclaiming advances the epoch, and deletes what was retired
+     before only if no lookup which started in an earlier epoch is still in progress.
+     */
+    struct alignas(64) ReaderSlot {
+        // Epoch of the lookup in progress, or 0 when the thread is not looking up a string
+        std::atomic<uint64_t> epoch = 0;
+        std::atomic<bool> inUse = false;
+        ReaderSlot* next = nullptr;
+    };
+
+    // Releases the slot of the current thread when it exits
+    struct ReaderSlotReleaser {
+        ~ReaderSlotReleaser();
+    };
+
+    std::array<Shard, kShardsCount> _shards;
+    std::atomic<uint64_t> _epoch = 1;
+    // Slots are never deleted, the slots of exited threads are reused by new threads
+    std::atomic<ReaderSlot*> _readerSlots = nullptr;
+
+    static thread_local ReaderSlot* tReaderSlot;
+    static thread_local bool tReaderSlotReleased;
 
     StringCache();
 
-    // Should be called with a lock already acquired
-    StringBox insertString(std::string_view str, size_t hash);
+    Shard& getShard(size_t mixedHash);
+
+    // Lookup of a string which is already interned, without taking the shard lock
+    Ref<InternedStringImpl> findString(Shard& shard, std::string_view str, size_t hash, size_t mixedHash);
+    static Ref<InternedStringImpl> probeString(const Table& table,
+                                               std::string_view str,
+                                               size_t hash,
+                                               size_t mixedHash);
+    // Should be called with the shard lock already acquired
+    StringBox insertString(Shard& shard, std::string_view str, size_t hash, size_t mixedHash);
     // Should be called without a lock
-    void removeString(const InternedStringImpl* internedString);
+    void removeString(InternedStringImpl* internedString);
 
-    friend InternedStringImpl;
+    // Should be called with the shard lock already acquired
+    static void growTableIfNeeded(Shard& shard);
+    void reclaimRetiredIfNeeded(Shard& shard);
+    void reclaimRetired(Shard& shard);
 
-    StringTable::const_iterator findEntry(const std::string_view& str, size_t hash) const;
+    ReaderSlot* getReaderSlot();
+    bool hasReaderStartedBefore(uint64_t epoch) const;
+
+    friend InternedStringImpl;
 };
 
 } // namespace Valdi